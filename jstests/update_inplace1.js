@@ -0,0 +1,30 @@
+// Layout-changing updates to unindexed fields should not move the record,
+// and the in-place/rewrite counters should show up in serverStatus.
+
+t = db.update_inplace1;
+t.drop();
+
+t.insert( { _id: 1, x: NumberInt( 0 ), pad: new Array( 200 ).join( "a" ) } );
+
+var before = db.serverStatus().metrics.record;
+assert( before.updatesInPlace !== undefined, "updatesInPlace metric missing" );
+assert( before.updatesRewritten !== undefined, "updatesRewritten metric missing" );
+
+var loc = t.find( { _id: 1 } ).showDiskLoc().next().$diskLoc;
+
+// int -> long changes the binary layout, but x is not indexed and the padding
+// guarantees the longer version still fits in the record.
+for ( var i = 0; i < 10; i++ )
+    t.update( { _id: 1 }, { $inc: { x: NumberLong( 1 ) } } );
+
+assert.eq( 10, t.findOne( { _id: 1 } ).x );
+
+var locAfter = t.find( { _id: 1 } ).showDiskLoc().next().$diskLoc;
+assert.eq( loc.file, locAfter.file, "record moved file" );
+assert.eq( loc.offset, locAfter.offset, "record moved offset" );
+
+var after = db.serverStatus().metrics.record;
+assert( after.updatesInPlace - before.updatesInPlace >= 10,
+        "expected in-place updates: " + tojson( before ) + " -> " + tojson( after ) );
+
+t.drop();
@@ -223,7 +223,7 @@ dodouble:
        getOwned() method.  the presumption being that is better.
     */
     inline NOINLINE_DECL BSONObj BSONObj::copy() const {
-        Holder *h = (Holder*) malloc(objsize() + sizeof(unsigned));
+        Holder *h = (Holder*) malloc(objsize() + Holder::HeaderSize);
         h->zero();
         memcpy(h->data, objdata(), objsize());
         return BSONObj(h);
@@ -263,6 +263,15 @@ dodouble:
     }
 
     inline BSONElement BSONObj::getField(const StringData& name) const {
+        if ( _holder ) {
+            // owned objects cache a hash-sorted field index on the holder so repeated
+            // lookups on wide documents are O(log n); see Holder::FieldIndex
+            const Holder::FieldIndex* index = _holder->getFieldIndex();
+            if ( !index )
+                index = _buildFieldIndex();
+            if ( index->nEntries )
+                return _getFieldUsingIndex( name, *index );
+        }
         BSONObjIterator i(*this);
         while ( i.more() ) {
             BSONElement e = i.next();
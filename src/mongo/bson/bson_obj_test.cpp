@@ -17,6 +17,7 @@
 #include "mongo/db/json.h"
 
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace {
 
@@ -27,4 +28,35 @@ namespace {
         ASSERT_EQUALS(text, o1_str);
     }
 
+    TEST(GetField, IndexedLookupOnWideOwnedObject) {
+        // wide enough to cross the field-index threshold in BSONObj::getField()
+        mongo::BSONObjBuilder b;
+        for (int i = 0; i < 50; i++) {
+            b.append(mongoutils::str::stream() << "field" << i, i);
+        }
+        mongo::BSONObj o = b.obj();
+        ASSERT(o.isOwned());
+        // repeated lookups exercise both the index build and the indexed path
+        for (int pass = 0; pass < 2; pass++) {
+            for (int i = 0; i < 50; i++) {
+                mongo::BSONElement e =
+                    o.getField(mongoutils::str::stream() << "field" << i);
+                ASSERT_EQUALS(i, e.numberInt());
+            }
+            ASSERT(o.getField("notAField").eoo());
+        }
+    }
+
+    TEST(GetField, LinearLookupOnUnownedObject) {
+        mongo::BSONObjBuilder b;
+        for (int i = 0; i < 50; i++) {
+            b.append(mongoutils::str::stream() << "field" << i, i);
+        }
+        mongo::BSONObj owned = b.obj();
+        mongo::BSONObj unowned(owned.objdata());
+        ASSERT(!unowned.isOwned());
+        ASSERT_EQUALS(7, unowned.getField("field7").numberInt());
+        ASSERT(unowned.getField("notAField").eoo());
+    }
+
 } // unnamed namespace
@@ -17,6 +17,12 @@
 
 #include <deque>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #include "mongo/bson/bson_validate.h"
 #include "mongo/bson/oid.h"
 
@@ -24,6 +30,42 @@ namespace mongo {
 
     namespace {
 
+        /**
+         * Returns a pointer to the first NUL byte in [p, p + len), or NULL if there is none.
+         * Scans 16 bytes at a time where the platform has vector instructions; equivalent to
+         * memchr( p, 0, len ) but measurably cheaper on the long field names and string
+         * payloads seen during bulk-load validation.
+         */
+        inline const char* scanForNul( const char* p, uint64_t len ) {
+#if defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            while ( len >= 16 ) {
+                const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) );
+                const int mask = _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, zero ) );
+                if ( mask )
+                    return p + __builtin_ctz( mask );
+                p += 16;
+                len -= 16;
+            }
+#elif defined(__ARM_NEON__)
+            while ( len >= 16 ) {
+                const uint8x16_t chunk = vld1q_u8( reinterpret_cast<const uint8_t*>( p ) );
+                const uint8x16_t cmp = vceqq_u8( chunk, vdupq_n_u8( 0 ) );
+                // cheap "any lane set" check; fall back to a byte scan of this chunk on a hit
+                uint64x2_t paired = vreinterpretq_u64_u8( cmp );
+                if ( vgetq_lane_u64( paired, 0 ) || vgetq_lane_u64( paired, 1 ) ) {
+                    for ( int i = 0; i < 16; i++ ) {
+                        if ( p[i] == 0 )
+                            return p + i;
+                    }
+                }
+                p += 16;
+                len -= 16;
+            }
+#endif
+            return static_cast<const char*>( memchr( p, 0, len ) );
+        }
+
         class Buffer {
         public:
             Buffer( const char* buffer, uint64_t maxLength )
@@ -43,7 +85,7 @@ namespace mongo {
             }
 
             Status readCString( StringData* out ) {
-                const void* x = memchr( _buffer + _position, 0, _maxLength - _position );
+                const void* x = scanForNul( _buffer + _position, _maxLength - _position );
                 if ( !x )
                     return Status( ErrorCodes::InvalidBSON, "no end of c-string" );
                 uint64_t len = static_cast<uint64_t>( static_cast<const char*>(x) - ( _buffer + _position ) );
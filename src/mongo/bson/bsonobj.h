@@ -27,6 +27,7 @@
 #include "mongo/bson/bsonelement.h"
 #include "mongo/base/string_data.h"
 #include "mongo/bson/util/atomic_int.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/util/bufreader.h"
 
@@ -85,7 +86,8 @@ namespace mongo {
 
         /** Construct a BSONObj from data in the proper format.
          *  Use this constructor when you want BSONObj to free(holder) when it is no longer needed
-         *  BSONObj::Holder has an extra 4 bytes for a ref-count before the start of the object
+         *  BSONObj::Holder has a header (ref-count and field-index slot, Holder::HeaderSize
+         *  bytes) before the start of the object
         */
         class Holder;
         explicit BSONObj(Holder* holder) {
@@ -496,13 +498,43 @@ namespace mongo {
 
 #pragma pack(1)
         class Holder : boost::noncopyable {
+        public:
+            /**
+             *  A lazily-built lookup index over the field names of an owned object.  Entries
+             *  are sorted by field-name hash, so a lookup is a binary search plus a name
+             *  verification instead of a linear scan.  Built at most once per holder, by
+             *  getField() the first time it walks an object with enough fields for the
+             *  linear scan to matter, and freed along with the holder.
+             */
+            struct FieldIndex {
+                struct Entry {
+                    unsigned hash;
+                    int offset;  // offset of the element from the start of the object
+                };
+                int nEntries;    // 0 means "too few fields to be worth indexing"
+                Entry entries[1]; // over-allocated to hold nEntries of these
+            };
+
         private:
             Holder(); // this class should never be explicitly created
+            AtomicWord<uintptr_t> fieldIndex; // FieldIndex*, installed at most once
             AtomicUInt refCount;
         public:
             char data[4]; // start of object
 
-            void zero() { refCount.zero(); }
+            enum { HeaderSize = sizeof(uintptr_t) + sizeof(unsigned) };
+
+            void zero() { fieldIndex.store( 0 ); refCount.zero(); }
+
+            const FieldIndex* getFieldIndex() const {
+                return reinterpret_cast<const FieldIndex*>( fieldIndex.load() );
+            }
+
+            /** Installs the index unless another thread beat us to it; takes ownership either way. */
+            void setFieldIndex( FieldIndex* index ) {
+                if ( fieldIndex.compareAndSwap( 0, reinterpret_cast<uintptr_t>( index ) ) != 0 )
+                    free( index );
+            }
 
             // these are called automatically by boost::intrusive_ptr
             friend void intrusive_ptr_add_ref(Holder* h) { h->refCount++; }
@@ -516,6 +548,7 @@ namespace mongo {
                     verify(sz < BSONObjMaxInternalSize * 3);
                     memset(h->data, 0xdd, sz);
 #endif
+                    free(reinterpret_cast<void*>(h->fieldIndex.load()));
                     free(h);
                 }
             }
@@ -553,6 +586,16 @@ namespace mongo {
 
         void _assertInvalid() const;
 
+        /**
+         * Builds (or installs the "not worth it" marker for) the holder's field index.
+         * Only called for owned objects; returns the index now cached on the holder.
+         */
+        const Holder::FieldIndex* _buildFieldIndex() const;
+
+        /** Looks up 'name' via a previously built field index. */
+        BSONElement _getFieldUsingIndex( const StringData& name,
+                                         const Holder::FieldIndex& index ) const;
+
         void init(Holder *holder) {
             _holder = holder; // holder is now managed by intrusive_ptr
             init(holder->data);
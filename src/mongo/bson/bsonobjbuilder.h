@@ -51,9 +51,10 @@ namespace mongo {
     class BSONObjBuilder : public BSONBuilderBase, private boost::noncopyable {
     public:
         /** @param initsize this is just a hint as to the final size of the object */
-        BSONObjBuilder(int initsize=512) : _b(_buf), _buf(initsize + sizeof(unsigned)), _offset( sizeof(unsigned) ), _s( this ) , _tracker(0) , _doneCalled(false) {
-            _b.appendNum((unsigned)0); // ref-count
-            _b.skip(4); /*leave room for size field and ref-count*/
+        BSONObjBuilder(int initsize=512) : _b(_buf), _buf(initsize + BSONObj::Holder::HeaderSize), _offset( BSONObj::Holder::HeaderSize ), _s( this ) , _tracker(0) , _doneCalled(false) {
+            _b.skip(BSONObj::Holder::HeaderSize); // ref-count and field-index slot
+            memset(_b.buf(), 0, BSONObj::Holder::HeaderSize);
+            _b.skip(4); /*leave room for size field*/
         }
 
         /** @param baseBuilder construct a BSONObjBuilder using an existing BufBuilder
@@ -63,8 +64,9 @@ namespace mongo {
             _b.skip( 4 );
         }
 
-        BSONObjBuilder( const BSONSizeTracker & tracker ) : _b(_buf) , _buf(tracker.getSize() + sizeof(unsigned) ), _offset( sizeof(unsigned) ), _s( this ) , _tracker( (BSONSizeTracker*)(&tracker) ) , _doneCalled(false) {
-            _b.appendNum((unsigned)0); // ref-count
+        BSONObjBuilder( const BSONSizeTracker & tracker ) : _b(_buf) , _buf(tracker.getSize() + BSONObj::Holder::HeaderSize ), _offset( BSONObj::Holder::HeaderSize ), _s( this ) , _tracker( (BSONSizeTracker*)(&tracker) ) , _doneCalled(false) {
+            _b.skip(BSONObj::Holder::HeaderSize); // ref-count and field-index slot
+            memset(_b.buf(), 0, BSONObj::Holder::HeaderSize);
             _b.skip(4);
         }
 
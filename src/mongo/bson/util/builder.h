@@ -27,6 +27,7 @@
 #include "mongo/bson/inline_decls.h"
 #include "mongo/base/string_data.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/buffer_arena.h"
 
 namespace mongo {
     /* Accessing unaligned doubles on ARM generates an alignment trap and aborts with SIGBUS on Linux.
@@ -69,6 +70,30 @@ namespace mongo {
         void Free(void *p) { free(p); }
     };
 
+    /** allocates from the thread-local buffer arena (see util/buffer_arena.h).
+        blocks are plain malloc blocks, so a decouple()d buffer may still be free()d
+        by whoever ends up owning it.
+    */
+    class PooledAllocator {
+    public:
+        PooledAllocator() : _size(0) { }
+        void* Malloc(size_t sz) { return bufferarena::acquire(sz, &_size); }
+        void* Realloc(void *p, size_t sz) {
+            if( p == 0 )
+                return Malloc(sz);
+            if( sz <= _size )
+                return p;
+            size_t oldSize = _size;
+            void *d = bufferarena::acquire(sz, &_size);
+            memcpy(d, p, oldSize);
+            bufferarena::release(p, oldSize);
+            return d;
+        }
+        void Free(void *p) { bufferarena::release(p, _size); }
+    private:
+        size_t _size; // usable size of the block currently handed out
+    };
+
     class StackAllocator {
     public:
         enum { SZ = 512 };
@@ -234,7 +259,7 @@ namespace mongo {
         friend class StringBuilderImpl<Allocator>;
     };
 
-    typedef _BufBuilder<TrivialAllocator> BufBuilder;
+    typedef _BufBuilder<PooledAllocator> BufBuilder;
 
     /** The StackBufBuilder builds smaller datasets on the stack instead of using malloc.
           this can be significantly faster for small bufs.  However, you can not decouple() the 
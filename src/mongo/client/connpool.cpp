@@ -30,10 +30,15 @@ namespace mongo {
     // ------ PoolForHost ------
 
     PoolForHost::~PoolForHost() {
-        clear();
+        _clear(); // no lock: nobody else can hold a reference while we destruct
     }
 
     void PoolForHost::clear() {
+        SimpleMutex::scoped_lock lk(_m);
+        _clear();
+    }
+
+    void PoolForHost::_clear() {
         while ( ! _pool.empty() ) {
             StoredConnection sc = _pool.top();
             delete sc.conn;
@@ -42,61 +47,84 @@ namespace mongo {
     }
 
     void PoolForHost::done( DBConnectionPool * pool, DBClientBase * c ) {
-        if (c->isFailed()) {
-            reportBadConnectionAt(c->getSockCreationMicroSec());
-            pool->onDestroy(c);
-            delete c;
+        bool destroy = false;
+        {
+            SimpleMutex::scoped_lock lk(_m);
+            if (c->isFailed()) {
+                _reportBadConnectionAt(c->getSockCreationMicroSec());
+                destroy = true;
+            }
+            else if (_pool.size() >= _maxPerHost ||
+                    c->getSockCreationMicroSec() < _minValidCreationTimeMicroSec) {
+                destroy = true;
+            }
+            else {
+                _pool.push(c);
+            }
         }
-        else if (_pool.size() >= _maxPerHost ||
-                c->getSockCreationMicroSec() < _minValidCreationTimeMicroSec) {
+        if (destroy) {
+            // hooks run outside our lock; they can be arbitrarily slow
             pool->onDestroy(c);
             delete c;
         }
-        else {
-            _pool.push(c);
-        }
     }
 
     void PoolForHost::reportBadConnectionAt(uint64_t microSec) {
+        SimpleMutex::scoped_lock lk(_m);
+        _reportBadConnectionAt(microSec);
+    }
+
+    void PoolForHost::_reportBadConnectionAt(uint64_t microSec) {
         if (microSec != DBClientBase::INVALID_SOCK_CREATION_TIME &&
                 microSec > _minValidCreationTimeMicroSec) {
             _minValidCreationTimeMicroSec = microSec;
             log() << "Detected bad connection created at " << _minValidCreationTimeMicroSec
                     << " microSec, clearing pool for " << _hostName
                     << " of " << _pool.size() << " connections" << endl;
-            clear();
+            _clear();
         }
     }
 
     bool PoolForHost::isBadSocketCreationTime(uint64_t microSec) {
+        SimpleMutex::scoped_lock lk(_m);
         return microSec != DBClientBase::INVALID_SOCK_CREATION_TIME &&
                 microSec <= _minValidCreationTimeMicroSec;
     }
 
     DBClientBase * PoolForHost::get( DBConnectionPool * pool , double socketTimeout ) {
 
-        time_t now = time(0);
-        
-        while ( ! _pool.empty() ) {
-            StoredConnection sc = _pool.top();
-            _pool.pop();
-            
-            if ( ! sc.ok( now ) )  {
-                pool->onDestroy( sc.conn );
-                delete sc.conn;
-                continue;
-            }
-            
-            verify( sc.conn->getSoTimeout() == socketTimeout );
+        DBClientBase * ret = NULL;
+        vector<DBClientBase*> dead;
+        {
+            SimpleMutex::scoped_lock lk(_m);
+            time_t now = time(0);
+
+            while ( ! _pool.empty() ) {
+                StoredConnection sc = _pool.top();
+                _pool.pop();
+
+                if ( ! sc.ok( now ) )  {
+                    dead.push_back( sc.conn );
+                    continue;
+                }
 
-            return sc.conn;
+                verify( sc.conn->getSoTimeout() == socketTimeout );
 
+                ret = sc.conn;
+                break;
+            }
         }
 
-        return NULL;
+        for ( size_t i = 0; i < dead.size(); i++ ) {
+            pool->onDestroy( dead[i] );
+            delete dead[i];
+        }
+
+        return ret;
     }
 
     void PoolForHost::flush() {
+        SimpleMutex::scoped_lock lk(_m);
         vector<StoredConnection> all;
         while ( ! _pool.empty() ) {
             StoredConnection c = _pool.top();
@@ -125,6 +153,7 @@ namespace mongo {
     }
 
     void PoolForHost::getStaleConnections( vector<DBClientBase*>& stale ) {
+        SimpleMutex::scoped_lock lk(_m);
         time_t now = time(0);
 
         vector<StoredConnection> all;
@@ -155,12 +184,14 @@ namespace mongo {
     }
 
     void PoolForHost::createdOne( DBClientBase * base) {
+        SimpleMutex::scoped_lock lk(_m);
         if ( _created == 0 )
             _type = base->type();
         _created++;
     }
 
     void PoolForHost::initializeHostName(const std::string& hostName) {
+        SimpleMutex::scoped_lock lk(_m);
         if (_hostName.empty()) {
             _hostName = hostName;
         }
@@ -178,22 +209,27 @@ namespace mongo {
           _hooks( new list<DBConnectionHook*>() ) { 
     }
 
+    PoolForHost& DBConnectionPool::_poolForKey( const string& ident, double socketTimeout ) {
+        // held just long enough to find or create the entry; map entries are
+        // never erased so the reference stays valid after we let go
+        scoped_lock L(_mutex);
+        return _pools[PoolKey(ident,socketTimeout)];
+    }
+
     DBClientBase* DBConnectionPool::_get(const string& ident , double socketTimeout ) {
         verify( ! inShutdown() );
-        scoped_lock L(_mutex);
-        PoolForHost& p = _pools[PoolKey(ident,socketTimeout)];
+        PoolForHost& p = _poolForKey( ident, socketTimeout );
         p.initializeHostName(ident);
         return p.get( this , socketTimeout );
     }
 
     DBClientBase* DBConnectionPool::_finishCreate( const string& host , double socketTimeout , DBClientBase* conn ) {
         {
-            scoped_lock L(_mutex);
-            PoolForHost& p = _pools[PoolKey(host,socketTimeout)];
+            PoolForHost& p = _poolForKey( host, socketTimeout );
             p.initializeHostName(host);
             p.createdOne( conn );
         }
-        
+
         try {
             onCreate( conn );
             onHandedOut( conn );
@@ -250,8 +286,7 @@ namespace mongo {
     }
 
     void DBConnectionPool::release(const string& host, DBClientBase *c) {
-        scoped_lock L(_mutex);
-        _pools[PoolKey(host,c->getSoTimeout())].done(this,c);
+        _poolForKey( host, c->getSoTimeout() ).done(this,c);
     }
 
 
@@ -426,12 +461,9 @@ namespace mongo {
             return false;
         }
 
-        {
-            scoped_lock sl(_mutex);
-            PoolForHost& pool = _pools[PoolKey(hostName, conn->getSoTimeout())];
-            if (pool.isBadSocketCreationTime(conn->getSockCreationMicroSec())) {
-                return false;
-            }
+        PoolForHost& pool = _poolForKey(hostName, conn->getSoTimeout());
+        if (pool.isBadSocketCreationTime(conn->getSockCreationMicroSec())) {
+            return false;
         }
 
         return true;
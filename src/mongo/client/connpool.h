@@ -22,6 +22,7 @@
 #include "mongo/util/background.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/platform/cstdint.h"
+#include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
@@ -29,15 +30,15 @@ namespace mongo {
     class DBConnectionPool;
 
     /**
-     * not thread safe
-     * thread safety is handled by DBConnectionPool
+     * thread safe; each host's pool synchronizes on its own mutex, so checking a
+     * connection in or out for one host never contends with traffic to another
      */
     class PoolForHost {
     public:
         PoolForHost()
-            : _created(0), _minValidCreationTimeMicroSec(0) {}
+            : _m("PoolForHost"), _created(0), _minValidCreationTimeMicroSec(0) {}
 
-        PoolForHost( const PoolForHost& other ) {
+        PoolForHost( const PoolForHost& other ) : _m("PoolForHost") {
             verify(other._pool.size() == 0);
             _created = other._created;
             _minValidCreationTimeMicroSec = other._minValidCreationTimeMicroSec;
@@ -46,12 +47,22 @@ namespace mongo {
 
         ~PoolForHost();
 
-        int numAvailable() const { return (int)_pool.size(); }
+        int numAvailable() const {
+            SimpleMutex::scoped_lock lk(_m);
+            return (int)_pool.size();
+        }
 
         void createdOne( DBClientBase * base );
-        long long numCreated() const { return _created; }
+        long long numCreated() const {
+            SimpleMutex::scoped_lock lk(_m);
+            return _created;
+        }
 
-        ConnectionString::ConnectionType type() const { verify(_created); return _type; }
+        ConnectionString::ConnectionType type() const {
+            SimpleMutex::scoped_lock lk(_m);
+            verify(_created);
+            return _type;
+        }
 
         /**
          * gets a connection or return NULL
@@ -87,6 +98,9 @@ namespace mongo {
         static void setMaxPerHost( unsigned max ) { _maxPerHost = max; }
         static unsigned getMaxPerHost() { return _maxPerHost; }
     private:
+        // unlocked versions for use when _m is already held
+        void _clear();
+        void _reportBadConnectionAt(uint64_t microSec);
 
         struct StoredConnection {
             StoredConnection( DBClientBase * c );
@@ -97,9 +111,14 @@ namespace mongo {
             time_t when;
         };
 
+        // protects everything below.  per-host rather than pool-wide so that a
+        // mongos pounding many shards doesn't serialize all acquisitions on one
+        // lock; DBConnectionPool::_mutex only covers the host -> pool map itself.
+        mutable SimpleMutex _m;
+
         std::string _hostName;
         std::stack<StoredConnection> _pool;
-        
+
         int64_t _created;
         uint64_t _minValidCreationTimeMicroSec;
         ConnectionString::ConnectionType _type;
@@ -184,6 +203,9 @@ namespace mongo {
     private:
         DBConnectionPool( DBConnectionPool& p );
         
+        /** find-or-create the entry for a host; takes _mutex only for the lookup */
+        PoolForHost& _poolForKey( const string& ident, double socketTimeout );
+
         DBClientBase* _get( const string& ident , double socketTimeout );
 
         DBClientBase* _finishCreate( const string& ident , double socketTimeout, DBClientBase* conn );
@@ -200,6 +222,9 @@ namespace mongo {
 
         typedef map<PoolKey,PoolForHost,poolKeyCompare> PoolMap; // servername -> pool
 
+        // guards _pools, the map itself.  each PoolForHost synchronizes its own
+        // state, so this is held only long enough to find or create an entry.
+        // entries are never erased, so a PoolForHost* stays valid once looked up.
         mongo::mutex _mutex;
         string _name;
         
@@ -708,6 +708,62 @@ namespace mongo {
         return runCommand(db.c_str(), b.done(), *info);
     }
 
+    BSONObj DBClientWithCommands::insertWithConcern( const string& ns, const vector<BSONObj>& v,
+                                                     const BSONObj& writeConcern, int flags ) {
+        BSONObjBuilder b;
+        string db = nsToDatabase(ns);
+        b.append("insert", ns.c_str() + db.length() + 1);
+        BSONArrayBuilder docs( b.subarrayStart("documents") );
+        for( vector<BSONObj>::const_iterator i = v.begin(); i != v.end(); ++i )
+            docs.append( *i );
+        docs.done();
+        if( flags & InsertOption_ContinueOnError )
+            b.append("continueOnError", true);
+        if( !writeConcern.isEmpty() )
+            b.append("writeConcern", writeConcern);
+        BSONObj info;
+        runCommand(db.c_str(), b.done(), info);
+        return info;
+    }
+
+    BSONObj DBClientWithCommands::updateWithConcern( const string& ns, Query query, BSONObj obj,
+                                                     const BSONObj& writeConcern, int flags ) {
+        BSONObjBuilder b;
+        string db = nsToDatabase(ns);
+        b.append("update", ns.c_str() + db.length() + 1);
+        BSONArrayBuilder updates( b.subarrayStart("updates") );
+        BSONObjBuilder u( updates.subobjStart() );
+        u.append("q", query.obj);
+        u.append("u", obj);
+        if( flags & UpdateOption_Upsert ) u.append("upsert", true);
+        if( flags & UpdateOption_Multi ) u.append("multi", true);
+        u.done();
+        updates.done();
+        if( !writeConcern.isEmpty() )
+            b.append("writeConcern", writeConcern);
+        BSONObj info;
+        runCommand(db.c_str(), b.done(), info);
+        return info;
+    }
+
+    BSONObj DBClientWithCommands::removeWithConcern( const string& ns, Query query,
+                                                     const BSONObj& writeConcern, int flags ) {
+        BSONObjBuilder b;
+        string db = nsToDatabase(ns);
+        b.append("delete", ns.c_str() + db.length() + 1);
+        BSONArrayBuilder deletes( b.subarrayStart("deletes") );
+        BSONObjBuilder d( deletes.subobjStart() );
+        d.append("q", query.obj);
+        d.append("limit", ( flags & RemoveOption_JustOne ) ? 1 : 0);
+        d.done();
+        deletes.done();
+        if( !writeConcern.isEmpty() )
+            b.append("writeConcern", writeConcern);
+        BSONObj info;
+        runCommand(db.c_str(), b.done(), info);
+        return info;
+    }
+
     bool DBClientWithCommands::copyDatabase(const string &fromdb, const string &todb, const string &fromhost, BSONObj *info) {
         BSONObj o;
         if ( info == 0 ) info = &o;
@@ -26,6 +26,7 @@
 #include "mongo/bson/util/builder.h"
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/client/host_latency_tracker.h"
 #include "mongo/client/sasl_client_authenticate.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/jsobj.h"
@@ -33,6 +34,7 @@
 #include "mongo/util/background.h"
 #include "mongo/util/concurrency/mutex.h" // for StaticObserver
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -258,6 +260,10 @@ namespace mongo {
                             bool* isPrimarySelected) {
         HostAndPort fallbackHost;
 
+        // last resort only: eligible hosts ejected by the latency tracker
+        HostAndPort ejectedFallbackHost;
+        bool ejectedIsPrimary = false;
+
         // Implicit: start from index 0 if lastHost doesn't exist anymore
         size_t nextNodeIndex = 0;
 
@@ -288,11 +294,27 @@ namespace mongo {
             }
 
             if (node.matchesTag(readPreferenceTag)) {
+                const string addrStr = node.addr.toString();
+
+                if (HostLatencyTracker::get().isEjected(addrStr)) {
+                    // recently slow on live traffic; only select if no one else can serve
+                    LOG(2) << "dbclient_rs not preferring " << node
+                                      << ", ejected for slow responses" << endl;
+                    if (ejectedFallbackHost.empty()) {
+                        ejectedFallbackHost = node.addr;
+                        ejectedIsPrimary = node.ismaster;
+                    }
+                    continue;
+                }
+
                 // found an ok candidate; may not be local.
                 fallbackHost = node.addr;
                 *isPrimarySelected = node.ismaster;
 
-                if (node.isLocalSecondary(localThresholdMillis)) {
+                // local by the monitor's ping and by the continuously updated
+                // operation latency average
+                if (node.isLocalSecondary(localThresholdMillis) &&
+                        HostLatencyTracker::get().ewmaMillis(addrStr) < localThresholdMillis) {
                     // found a local node.  return early.
                     LOG(2) << "dbclient_rs selecting local secondary " << fallbackHost
                                       << ", ping time: " << node.pingTimeMillis << endl;
@@ -302,6 +324,11 @@ namespace mongo {
             }
         }
 
+        if (fallbackHost.empty() && !ejectedFallbackHost.empty()) {
+            fallbackHost = ejectedFallbackHost;
+            *isPrimarySelected = ejectedIsPrimary;
+        }
+
         if (!fallbackHost.empty()) {
             *lastHost = fallbackHost;
         }
@@ -1656,9 +1683,12 @@ namespace mongo {
                         break;
                     }
 
+                    Timer opTimer;
                     auto_ptr<DBClientCursor> cursor = conn->query(ns, query,
                             nToReturn, nToSkip, fieldsToReturn, queryOptions,
                             batchSize);
+                    HostLatencyTracker::get().noteLatency(conn->getServerAddress(),
+                                                          opTimer.micros());
 
                     return checkSlaveQueryResult(cursor);
                 }
@@ -1706,7 +1736,11 @@ namespace mongo {
                         break;
                     }
 
-                    return conn->findOne(ns,query,fieldsToReturn,queryOptions);
+                    Timer opTimer;
+                    BSONObj result = conn->findOne(ns,query,fieldsToReturn,queryOptions);
+                    HostLatencyTracker::get().noteLatency(conn->getServerAddress(),
+                                                          opTimer.micros());
+                    return result;
                 }
                 catch ( const DBException &dbExcep ) {
                     LOG(1) << "can't findone replica set node " << _lastSlaveOkHost << ": "
@@ -1878,6 +1912,7 @@ namespace mongo {
                         _lazyState._lastOp = lastOp;
                         _lazyState._slaveOk = slaveOk;
                         _lazyState._lastClient = conn;
+                        _lazyState._sentMicros = curTimeMicros64();
                     }
                     catch ( const DBException& DBExcep ) {
                         LOG(1) << "can't callLazy replica set node " << _lastSlaveOkHost << ": "
@@ -1908,6 +1943,7 @@ namespace mongo {
         _lazyState._lastClient = master;
 
         master->say(toSend);
+        _lazyState._sentMicros = curTimeMicros64();
         return;
     }
 
@@ -1917,10 +1953,18 @@ namespace mongo {
 
         // TODO: It would be nice if we could easily wrap a conn error as a result error
         try {
-            return _lazyState._lastClient->recv( m );
+            bool res = _lazyState._lastClient->recv( m );
+            if ( res && _lazyState._sentMicros > 0 ) {
+                // round trip for the lazy op that say() sent to this host
+                HostLatencyTracker::get().noteLatency( _lazyState._lastClient->getServerAddress(),
+                                                       curTimeMicros64() - _lazyState._sentMicros );
+                _lazyState._sentMicros = 0;
+            }
+            return res;
         }
         catch( DBException& e ){
             log() << "could not receive data from " << _lazyState._lastClient->toString() << causedBy( e ) << endl;
+            HostLatencyTracker::get().noteFailure( _lazyState._lastClient->getServerAddress() );
             return false;
         }
     }
@@ -2077,6 +2121,10 @@ namespace mongo {
          * because there are certain exceptions that will not make the connection be labeled
          * as failed. For example, asserts 13079, 13080, 16386
          */
+        if (!_lastSlaveOkHost.empty()) {
+            HostLatencyTracker::get().noteFailure(_lastSlaveOkHost.toString());
+        }
+
         _getMonitor()->notifySlaveFailure(_lastSlaveOkHost);
         _lastSlaveOkHost = HostAndPort();
         _lastSlaveOkConn.reset();
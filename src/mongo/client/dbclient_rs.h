@@ -611,12 +611,18 @@ namespace mongo {
          */
         class LazyState {
         public:
-            LazyState() : _lastClient( NULL ), _lastOp( -1 ), _slaveOk( false ), _retries( 0 ) {}
+            LazyState() :
+                _lastClient( NULL ), _lastOp( -1 ), _slaveOk( false ), _retries( 0 ),
+                _sentMicros( 0 ) {}
             DBClientConnection* _lastClient;
             int _lastOp;
             bool _slaveOk;
             int _retries;
 
+            // when say() handed the message to _lastClient; lets recv() report the
+            // round trip to the host latency tracker.  0 if nothing is outstanding.
+            unsigned long long _sentMicros;
+
         } _lazyState;
 
     };
@@ -115,9 +115,40 @@ namespace mongo {
         return ok;
     }
 
+    void DBClientCursor::prefetchMore() {
+        if ( _moreInFlight || cursorId == 0 )
+            return;
+        verify( !haveLimit );
+        massert( 17551, "DBClientCursor::prefetchMore called on a client that doesn't support lazy",
+                 _client && _client->lazySupported() );
+
+        BufBuilder b;
+        b.appendNum(opts);
+        b.appendStr(ns);
+        b.appendNum(nextBatchSize());
+        b.appendNum(cursorId);
+
+        Message toSend;
+        toSend.setData(dbGetMore, b.buf(), b.len());
+        _client->say( toSend );
+        _moreInFlight = true;
+    }
+
     void DBClientCursor::requestMore() {
         verify( cursorId && batch.pos == batch.nReturned );
 
+        if ( _moreInFlight ) {
+            // the getMore is already on the wire (see prefetchMore); just take the reply
+            _moreInFlight = false;
+            auto_ptr<Message> response(new Message());
+            verify( _client );
+            uassert( 17552, "recv failed while receiving prefetched batch",
+                     _client->recv(*response) );
+            batch.m = response;
+            dataReceived();
+            return;
+        }
+
         if (haveLimit) {
             nToReturn -= batch.nReturned;
             verify(nToReturn > 0);
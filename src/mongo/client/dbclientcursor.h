@@ -146,7 +146,8 @@ namespace mongo {
             resultFlags(0),
             cursorId(),
             _ownCursor( true ),
-            wasError( false ) {
+            wasError( false ),
+            _moreInFlight( false ) {
             _finishConsInit();
         }
 
@@ -162,7 +163,8 @@ namespace mongo {
             resultFlags(0),
             cursorId(_cursorId),
             _ownCursor(true),
-            wasError(false) {
+            wasError(false),
+            _moreInFlight(false) {
             _finishConsInit();
         }
 
@@ -201,6 +203,17 @@ namespace mongo {
         void initLazy( bool isRetry = false );
         bool initLazyFinish( bool& retry );
 
+        /**
+         * Sends the next getMore now, without waiting for the reply, so the next
+         * batch streams in while the caller drains the current one; the following
+         * more()/requestMore() just receives it.  Until that reply has been read,
+         * nothing else may be sent on the underlying connection, so this is only
+         * for cursors with a dedicated connection (e.g. the oplog reader's).
+         * Requires an attached lazy-capable client and no limit.  No-op if a
+         * prefetch is already outstanding or the cursor is dead.
+         */
+        void prefetchMore();
+
         class Batch : boost::noncopyable { 
             friend class DBClientCursor;
             auto_ptr<Message> m;
@@ -236,6 +249,7 @@ namespace mongo {
         string _scopedHost;
         string _lazyHost;
         bool wasError;
+        bool _moreInFlight; // a prefetched getMore's reply is pending (see prefetchMore)
 
         void dataReceived() { bool retry; string lazyHost; dataReceived( retry, lazyHost ); }
         void dataReceived( bool& retry, string& lazyHost );
@@ -113,7 +113,18 @@ namespace mongo {
      */
     enum InsertOptions {
         /** With muli-insert keep processing inserts if one fails */
-        InsertOption_ContinueOnError = 1 << 0
+        InsertOption_ContinueOnError = 1 << 0,
+
+        /**
+         * Fire-and-forget streaming ingest.  The server takes the whole frame through one
+         * lock/allocation/oplog pass when the collection is eligible and replies -- only
+         * when one is due -- with a durability receipt { ok, n, j } acknowledging every
+         * streamed insert on the connection since the previous receipt.  Clients match
+         * receipts to frames by responseTo instead of sending getLastError per frame.
+         * Bit 1 is skipped: insert options travel in the pre-namespace reserved field,
+         * where bit 1 is WriteOption_FromWriteback.
+         */
+        InsertOption_StreamReceipt = 1 << 2
     };
 
     /**
@@ -132,7 +143,8 @@ namespace mongo {
 
     enum ReservedOptions {
         Reserved_InsertOption_ContinueOnError = 1 << 0 ,
-        Reserved_FromWriteback = 1 << 1
+        Reserved_FromWriteback = 1 << 1 ,
+        Reserved_InsertOption_StreamReceipt = 1 << 2
     };
 
     enum ReadPreference {
@@ -691,6 +703,28 @@ namespace mongo {
         */
         bool createCollection(const string &ns, long long size = 0, bool capped = false, int max = 0, BSONObj *info = 0);
 
+        /** Insert a batch of documents and wait for 'writeConcern', all in one round trip.
+
+            Uses the "insert" write command, so the write and the replication
+            acknowledgment share a single network hop instead of a write message
+            followed by getLastError.  'writeConcern' takes the usual getLastError
+            options, e.g. BSON( "w" << 2 << "j" << true ).
+            @return the command reply: { ok, n, ... } plus per-item errDetails and the
+                    write concern fields getLastError would have reported on failure.
+        */
+        virtual BSONObj insertWithConcern( const string& ns, const vector<BSONObj>& v,
+                                           const BSONObj& writeConcern, int flags = 0 );
+
+        /** Update via the "update" write command; honors UpdateOption_Upsert and
+            UpdateOption_Multi.  See insertWithConcern for semantics of the reply. */
+        virtual BSONObj updateWithConcern( const string& ns, Query query, BSONObj obj,
+                                           const BSONObj& writeConcern, int flags = 0 );
+
+        /** Remove via the "delete" write command; honors RemoveOption_JustOne.
+            See insertWithConcern for semantics of the reply. */
+        virtual BSONObj removeWithConcern( const string& ns, Query query,
+                                           const BSONObj& writeConcern, int flags = 0 );
+
         /** Get error result from the last write operation (insert/update/delete) on this connection.
             db doesn't change the command's behavior - it is just for auth checks.
             @return error message text, or empty string if no error.
@@ -31,6 +31,7 @@ namespace mongo {
 
     LabeledLevel DistributedLock::logLvl( 1 );
     DistributedLock::LastPings DistributedLock::lastPings;
+    DistributedLock::Leases DistributedLock::leases;
 
     ThreadLocalValue<string> distLockIds("");
 
@@ -169,6 +170,16 @@ namespace mongo {
                             << " by distributed lock pinger '" << pingId
                             << "', sleeping for " << sleepTime << "ms" << endl;
 
+                    // Queue lazy unlocks for any lock leases that expired without being
+                    // re-entered by their holders.
+                    vector<OID> expiredLeases;
+                    DistributedLock::leases.removeExpired( addr, process, &expiredLeases );
+                    for( size_t i = 0; i < expiredLeases.size(); i++ ) {
+                        LOG( DistributedLock::logLvl - 1 ) << "lock lease with ts " << expiredLeases[i]
+                                                           << " expired, scheduling unlock" << endl;
+                        addUnlockOID( expiredLeases[i] );
+                    }
+
                     // Remove old locks, if possible
                     // Make sure no one else is adding to this list at the same time
                     scoped_lock lk( _mutex );
@@ -353,6 +364,52 @@ namespace mongo {
         _lastPings[ std::pair< string, string >( conn.toString(), lockName ) ] = pd;
     }
 
+    bool DistributedLock::Leases::take( const ConnectionString& conn, const string& lockName,
+                                        const string& processId, BSONObj* lockObj ) {
+        scoped_lock lock( _mutex );
+        map< std::pair<string, string>, LeaseData >::iterator it =
+                _leases.find( std::pair< string, string >( conn.toString(), lockName ) );
+        if ( it == _leases.end() )
+            return false;
+        if ( it->second.processId != processId )
+            return false;
+        if ( it->second.expires <= jsTime() ) {
+            // Expired leases are left for the ping thread to unlock lazily.
+            return false;
+        }
+        *lockObj = it->second.lockObj;
+        _leases.erase( it );
+        return true;
+    }
+
+    void DistributedLock::Leases::store( const ConnectionString& conn, const string& lockName,
+                                         const string& processId, const BSONObj& lockObj,
+                                         Date_t expires ) {
+        scoped_lock lock( _mutex );
+        LeaseData& data = _leases[ std::pair< string, string >( conn.toString(), lockName ) ];
+        data.processId = processId;
+        data.lockObj = lockObj.getOwned();
+        data.expires = expires;
+    }
+
+    void DistributedLock::Leases::removeExpired( const ConnectionString& conn,
+                                                 const string& processId,
+                                                 vector<OID>* lockIDs ) {
+        scoped_lock lock( _mutex );
+        Date_t now = jsTime();
+        for ( map< std::pair<string, string>, LeaseData >::iterator it = _leases.begin();
+                it != _leases.end(); ) {
+            if ( it->first.first == conn.toString() && it->second.processId == processId &&
+                 it->second.expires <= now ) {
+                lockIDs->push_back( it->second.lockObj[LocksType::lockID()].OID() );
+                _leases.erase( it++ );
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
     Date_t DistributedLock::getRemoteTime() {
         return DistributedLock::remoteTime( _conn, _maxNetSkew );
     }
@@ -566,6 +623,22 @@ namespace mongo {
         // This should always be true, if not, we are using the lock incorrectly.
         verify( _name != "" );
 
+        // Fast path: if we recently released this lock as a lease, re-enter it locally
+        // without any config server round trips.  The lock is still held in the locks
+        // collection with our process and ts, so no other process can have taken it.
+        {
+            BSONObj leased;
+            if ( leases.take( _conn, _name, _processId, &leased ) ) {
+                LOG( logLvl - 1 ) << "re-entered distributed lock '" << _name << "/" << _processId
+                                  << "' via held lease" << endl;
+                if ( other ) {
+                    *other = leased;
+                    other->getOwned();
+                }
+                return true;
+            }
+        }
+
         LOG( logLvl ) << "trying to acquire new distributed lock for " << _name << " on " << _conn
                       << " ( lock timeout : " << _lockTimeout
                       << ", ping interval : " << _lockPing << ", process : " << _processId << " )"
@@ -1100,6 +1173,31 @@ namespace mongo {
                   << " minutes timeout." << endl;
     }
 
+    void DistributedLock::unlockAsLease( BSONObj* oldLockPtr ) {
+
+        verify( _name != "" );
+
+        BSONObj oldLock;
+        if( oldLockPtr ) oldLock = *oldLockPtr;
+
+        // Without a valid finalized lock document there is nothing to lease, so fall back
+        // to a normal unlock attempt.
+        if( oldLock[LocksType::state()].eoo() ||
+            oldLock[LocksType::state()].numberInt() != 2 ||
+            oldLock[LocksType::lockID()].eoo() ) {
+            unlock( oldLockPtr );
+            return;
+        }
+
+        // Keep the lease well below the lock timeout, so an expired lease is lazily
+        // unlocked by the ping thread long before anyone tries to force the lock.
+        Date_t expires = jsTime() + _lockPing;
+        leases.store( _conn, _name, _processId, oldLock, expires );
+
+        LOG( logLvl - 1 ) << "distributed lock '" << _name << "/" << _processId
+                          << "' released as lease, expiring " << expires << endl;
+    }
+
     ScopedDistributedLock::ScopedDistributedLock(const ConnectionString& conn, const string& name) :
             _lock(conn, name), _why(""), _lockTryIntervalMillis(1000), _acquired(false)
     {
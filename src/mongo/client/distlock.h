@@ -99,6 +99,49 @@ namespace mongo {
 
     	static LastPings lastPings;
 
+        /**
+         * Registry of locks that were released locally but are still held on the config
+         * servers as short leases.  A lease allows the same process to re-enter the lock
+         * without any config server round trips; leases that expire without being
+         * re-entered are unlocked lazily by the ping thread.
+         */
+        class Leases {
+        public:
+            Leases() : _mutex( "DistributedLock::Leases" ) {}
+
+            /**
+             * Takes the unexpired lease for 'lockName' held by 'processId', if any,
+             * removing it from the registry and returning the lock document through
+             * 'lockObj'.
+             * @return true if a lease was taken
+             */
+            bool take( const ConnectionString& conn, const string& lockName,
+                       const string& processId, BSONObj* lockObj );
+
+            /** Stores a lease for 'lockName', expiring at 'expires'. */
+            void store( const ConnectionString& conn, const string& lockName,
+                        const string& processId, const BSONObj& lockObj, Date_t expires );
+
+            /**
+             * Removes all expired leases held by 'processId' on 'conn', appending the lock
+             * ids of their lock documents to 'lockIDs' so the locks can be unlocked lazily.
+             */
+            void removeExpired( const ConnectionString& conn, const string& processId,
+                                vector<OID>* lockIDs );
+
+        private:
+            struct LeaseData {
+                string processId;
+                BSONObj lockObj;
+                Date_t expires;
+            };
+
+            mongo::mutex _mutex;
+            map< std::pair<string, string>, LeaseData > _leases;
+        };
+
+        static Leases leases;
+
         /**
          * The constructor does not connect to the configdb yet and constructing does not mean the lock was acquired.
          * Construction does trigger a lock "pinging" mechanism, though.
@@ -138,6 +181,16 @@ namespace mongo {
          */
         void unlock( BSONObj* oldLockPtr = NULL );
 
+        /**
+         * Releases the lock locally but keeps it held on the config servers as a short
+         * lease, so that an immediately following lock_try() by this process re-enters it
+         * without any config server round trips.  Useful for locks that the same process
+         * acquires repeatedly in quick succession (balancer rounds, split batches).  If
+         * the lease expires without being re-entered, the lock is unlocked lazily by the
+         * ping thread.  Like unlock(), must not throw.
+         */
+        void unlockAsLease( BSONObj* oldLockPtr );
+
         Date_t getRemoteTime();
 
         bool isRemoteTimeSkewed();
@@ -199,9 +252,9 @@ namespace mongo {
     class dist_lock_try {
     public:
 
-    	dist_lock_try() : _lock(NULL), _got(false) {}
+    	dist_lock_try() : _lock(NULL), _got(false), _asLease(false) {}
 
-    	dist_lock_try( const dist_lock_try& that ) : _lock(that._lock), _got(that._got), _other(that._other) {
+    	dist_lock_try( const dist_lock_try& that ) : _lock(that._lock), _got(that._got), _other(that._other), _asLease(that._asLease) {
     		_other.getOwned();
 
     		// Make sure the lock ownership passes to this object,
@@ -221,6 +274,7 @@ namespace mongo {
     	    _other = that._other;
     	    _other.getOwned();
     	    _why = that._why;
+    	    _asLease = that._asLease;
 
     	    // Make sure the lock ownership passes to this object,
     	    // so we only unlock once.
@@ -231,15 +285,25 @@ namespace mongo {
     	    return *this;
     	}
 
-        dist_lock_try( DistributedLock * lock , const std::string& why, double timeout = 0.0 )
-            : _lock(lock), _why(why) {
+        /**
+         * If 'asLease' is true, a successfully acquired lock is released as a lease on
+         * destruction instead of being unlocked, allowing this process to re-enter it
+         * cheaply.  See DistributedLock::unlockAsLease().
+         */
+        dist_lock_try( DistributedLock * lock , const std::string& why, double timeout = 0.0, bool asLease = false )
+            : _lock(lock), _why(why), _asLease(asLease) {
             _got = _lock->lock_try( why , false , &_other, timeout );
         }
 
         ~dist_lock_try() {
             if ( _got ) {
                 verify( ! _other.isEmpty() );
-                _lock->unlock( &_other );
+                if ( _asLease ) {
+                    _lock->unlockAsLease( &_other );
+                }
+                else {
+                    _lock->unlock( &_other );
+                }
             }
         }
 
@@ -270,6 +334,7 @@ namespace mongo {
         bool _got;
         BSONObj _other;
         string _why;
+        bool _asLease;
     };
 
     /**
@@ -227,13 +227,37 @@ namespace mongo {
         return GridFSChunk(o);
     }
 
+    GridFileChunkReader::GridFileChunkReader( const GridFile& file )
+        : _numChunks( file.getNumChunks() ), _next( 0 ) {
+        file._exists();
+
+        BSONObjBuilder b;
+        b.appendAs( file._obj["_id"] , "files_id" );
+
+        _cursor = file._grid->_client.query( file._grid->_chunksNS.c_str() ,
+                                             Query( b.obj() ).sort( BSON( "n" << 1 ) ) );
+        uassert( 17513 , "failed to open cursor on chunks" , _cursor.get() );
+    }
+
+    GridFSChunk GridFileChunkReader::next() {
+        verify( more() );
+        uassert( 17514 , str::stream() << "chunk " << _next << " is missing!" , _cursor->more() );
+
+        // own it: the cursor's current batch buffer is replaced on the next getMore
+        BSONObj o = _cursor->next().getOwned();
+        uassert( 17515 , str::stream() << "chunk came back out of order: expected " << _next
+                         << " got " << o["n"].numberInt() ,
+                 o["n"].numberInt() == _next );
+        _next++;
+        return GridFSChunk( o );
+    }
+
     gridfs_offset GridFile::write( ostream & out ) const {
         _exists();
 
-        const int num = getNumChunks();
-
-        for ( int i=0; i<num; i++ ) {
-            GridFSChunk c = getChunk( i );
+        GridFileChunkReader reader( *this );
+        while ( reader.more() ) {
+            GridFSChunk c = reader.next();
 
             int len;
             const char * data = c.data( len );
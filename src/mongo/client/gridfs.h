@@ -132,6 +132,7 @@ namespace mongo {
         BSONObj insertFile(const string& name, const OID& id, gridfs_offset length, const string& contentType);
 
         friend class GridFile;
+        friend class GridFileChunkReader;
     };
 
     /**
@@ -202,5 +203,34 @@ namespace mongo {
         BSONObj        _obj;
 
         friend class GridFS;
+        friend class GridFileChunkReader;
+    };
+
+    /**
+     * Streams a file's chunks in order through a single batched cursor over the
+     * chunks collection, so chunks arrive many per network round trip instead
+     * of one findOne each (getChunk).  Prefer this for reading whole files or
+     * long sequential ranges; round trips drop from one per chunk to one per
+     * cursor batch.
+     */
+    class GridFileChunkReader {
+    public:
+        explicit GridFileChunkReader( const GridFile& file );
+
+        /** @return true while more chunks remain */
+        bool more() const {
+            return _next < _numChunks;
+        }
+
+        /**
+         * the next chunk, in n order, as an owned copy.
+         * asserts if a chunk is missing or arrives out of order.
+         */
+        GridFSChunk next();
+
+    private:
+        int _numChunks;
+        int _next;
+        auto_ptr<DBClientCursor> _cursor;
     };
 }
@@ -0,0 +1,112 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/client/host_latency_tracker.h"
+
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    HostLatencyTracker::HostLatencyTracker() : _lock( "HostLatencyTracker" ) {
+    }
+
+    HostLatencyTracker& HostLatencyTracker::get() {
+        static HostLatencyTracker globalTracker;
+        return globalTracker;
+    }
+
+    void HostLatencyTracker::noteLatency( const std::string& host, long long micros ) {
+        scoped_lock lk( _lock );
+        HostStats& stats = _stats[host];
+
+        const bool outlier =
+            stats.samples >= kMinSamples &&
+            micros > kOutlierMultiplier * stats.ewmaMicros &&
+            micros > kOutlierFloorMicros;
+
+        if ( stats.samples == 0 ) {
+            stats.ewmaMicros = micros;
+        }
+        else {
+            // fold outliers in clamped to the threshold, so a single spike can't drag
+            // the average (and with it the outlier threshold) up in one step; a genuine
+            // regression still raises the average steadily until it stops being an
+            // outlier, which is what lets an ejected host earn its way back in
+            long long sample = micros;
+            const long long cap = kOutlierMultiplier * stats.ewmaMicros;
+            if ( outlier && sample > cap )
+                sample = cap;
+            stats.ewmaMicros += ( sample - stats.ewmaMicros ) / kEwmaWeightInverse;
+        }
+        stats.samples++;
+
+        if ( outlier ) {
+            _noteOutlier_inlock( stats );
+            return;
+        }
+
+        stats.outlierStreak = 0;
+
+        // enough clean operations in a row relax the ejection backoff again
+        if ( stats.ejectionMillis > kMinEjectionMillis &&
+             ++stats.cleanOps >= kCleanOpsToRelax ) {
+            stats.cleanOps = 0;
+            stats.ejectionMillis /= 2;
+            if ( stats.ejectionMillis < kMinEjectionMillis )
+                stats.ejectionMillis = kMinEjectionMillis;
+        }
+    }
+
+    void HostLatencyTracker::noteFailure( const std::string& host ) {
+        scoped_lock lk( _lock );
+        _noteOutlier_inlock( _stats[host] );
+    }
+
+    void HostLatencyTracker::_noteOutlier_inlock( HostStats& stats ) {
+        stats.cleanOps = 0;
+
+        if ( ++stats.outlierStreak < kEjectionStreak )
+            return;
+
+        stats.outlierStreak = 0;
+
+        const unsigned long long now = curTimeMillis64();
+        if ( stats.ejectedUntil > 0 &&
+             now < stats.ejectedUntil + static_cast<unsigned long long>( stats.ejectionMillis ) ) {
+            // re-ejected within a backoff period of the last ejection ending
+            stats.ejectionMillis *= 2;
+            if ( stats.ejectionMillis > kMaxEjectionMillis )
+                stats.ejectionMillis = kMaxEjectionMillis;
+        }
+        stats.ejectedUntil = now + stats.ejectionMillis;
+    }
+
+    int HostLatencyTracker::ewmaMillis( const std::string& host ) const {
+        scoped_lock lk( _lock );
+        StatsMap::const_iterator it = _stats.find( host );
+        if ( it == _stats.end() )
+            return 0;
+        return static_cast<int>( it->second.ewmaMicros / 1000 );
+    }
+
+    bool HostLatencyTracker::isEjected( const std::string& host ) const {
+        scoped_lock lk( _lock );
+        StatsMap::const_iterator it = _stats.find( host );
+        if ( it == _stats.end() )
+            return false;
+        return it->second.ejectedUntil > curTimeMillis64();
+    }
+
+} // namespace mongo
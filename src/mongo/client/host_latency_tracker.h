@@ -0,0 +1,97 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /**
+     * Process-wide smoothed per-host operation latency, fed from every completed
+     * replica set read.  The ReplicaSetMonitor only refreshes ping times on its
+     * periodic check, so a briefly-slow host keeps receiving reads for most of a
+     * monitor cycle; node selection consults this tracker instead so routing
+     * adapts within a few operations.
+     *
+     * A host whose latency spikes well above its own average for several
+     * consecutive operations is "ejected" for a short period and is then only
+     * selected when no alternative exists.  Repeated ejections back off the
+     * ejection period.  When the period lapses the host becomes selectable again
+     * but keeps its elevated average, so latency-sensitive routing ramps traffic
+     * back up gradually as fresh fast responses decay the average.
+     *
+     * All methods are thread-safe.  Tests can construct their own instance;
+     * everything else uses the process-wide one from get().
+     */
+    class HostLatencyTracker {
+    public:
+        HostLatencyTracker();
+
+        static HostLatencyTracker& get();
+
+        /** note a successfully completed operation against host taking micros. */
+        void noteLatency( const std::string& host, long long micros );
+
+        /** note a failed operation against host; counts like an outlier. */
+        void noteFailure( const std::string& host );
+
+        /** @return smoothed operation latency in ms, 0 if the host is unknown. */
+        int ewmaMillis( const std::string& host ) const;
+
+        /** @return true while the host is ejected for consecutive slow responses. */
+        bool isEjected( const std::string& host ) const;
+
+        // tuning knobs (public for tests)
+        static const int kEwmaWeightInverse = 4;       // new sample weight is 1/4
+        static const int kOutlierMultiplier = 4;       // outlier if > 4x the average
+        static const long long kOutlierFloorMicros = 50 * 1000; // and > 50ms absolute
+        static const int kMinSamples = 4;              // no outlier calls before this
+        static const int kEjectionStreak = 3;          // consecutive outliers to eject
+        static const long long kMinEjectionMillis = 5 * 1000;
+        static const long long kMaxEjectionMillis = 60 * 1000;
+        static const int kCleanOpsToRelax = 64;        // ops to halve the backoff again
+
+    private:
+        struct HostStats {
+            HostStats() :
+                ewmaMicros( 0 ),
+                samples( 0 ),
+                outlierStreak( 0 ),
+                cleanOps( 0 ),
+                ejectedUntil( 0 ),
+                ejectionMillis( kMinEjectionMillis ) {
+            }
+
+            long long ewmaMicros;
+            long long samples;
+            int outlierStreak;
+            int cleanOps;
+            unsigned long long ejectedUntil;  // curTimeMillis64() deadline, 0 if none
+            long long ejectionMillis;         // current backoff length
+        };
+
+        typedef std::map<std::string,HostStats> StatsMap;
+
+        void _noteOutlier_inlock( HostStats& stats );
+
+        mutable mongo::mutex _lock;
+        StatsMap _stats;
+    };
+
+} // namespace mongo
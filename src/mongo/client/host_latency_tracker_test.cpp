@@ -0,0 +1,84 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/client/host_latency_tracker.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using mongo::HostLatencyTracker;
+
+    const std::string host = "a:27017";
+
+    TEST(HostLatencyTracker, UnknownHostIsClean) {
+        HostLatencyTracker tracker;
+        ASSERT_EQUALS(0, tracker.ewmaMillis(host));
+        ASSERT_FALSE(tracker.isEjected(host));
+    }
+
+    TEST(HostLatencyTracker, EwmaTracksSteadyLatency) {
+        HostLatencyTracker tracker;
+        for (int i = 0; i < 100; i++) {
+            tracker.noteLatency(host, 10 * 1000); // 10ms
+        }
+        ASSERT_EQUALS(10, tracker.ewmaMillis(host));
+        ASSERT_FALSE(tracker.isEjected(host));
+    }
+
+    TEST(HostLatencyTracker, SingleOutlierDoesNotEject) {
+        HostLatencyTracker tracker;
+        for (int i = 0; i < 20; i++) {
+            tracker.noteLatency(host, 5 * 1000);
+        }
+        tracker.noteLatency(host, 500 * 1000);
+        ASSERT_FALSE(tracker.isEjected(host));
+    }
+
+    TEST(HostLatencyTracker, OutlierStreakEjects) {
+        HostLatencyTracker tracker;
+        for (int i = 0; i < 20; i++) {
+            tracker.noteLatency(host, 5 * 1000);
+        }
+        for (int i = 0; i < HostLatencyTracker::kEjectionStreak; i++) {
+            tracker.noteLatency(host, 500 * 1000);
+        }
+        ASSERT_TRUE(tracker.isEjected(host));
+        // the elevated average sticks around for gradual reintroduction
+        ASSERT_GREATER_THAN(tracker.ewmaMillis(host), 5);
+    }
+
+    TEST(HostLatencyTracker, FailureStreakEjects) {
+        HostLatencyTracker tracker;
+        for (int i = 0; i < HostLatencyTracker::kEjectionStreak; i++) {
+            tracker.noteFailure(host);
+        }
+        ASSERT_TRUE(tracker.isEjected(host));
+    }
+
+    TEST(HostLatencyTracker, FastOpBreaksOutlierStreak) {
+        HostLatencyTracker tracker;
+        for (int i = 0; i < 20; i++) {
+            tracker.noteLatency(host, 5 * 1000);
+        }
+        for (int rounds = 0; rounds < 5; rounds++) {
+            // never kEjectionStreak slow ops in a row
+            tracker.noteLatency(host, 500 * 1000);
+            tracker.noteLatency(host, 500 * 1000);
+            tracker.noteLatency(host, 5 * 1000);
+        }
+        ASSERT_FALSE(tracker.isEjected(host));
+    }
+
+} // namespace
@@ -478,6 +478,7 @@ namespace mongo {
         _numServers = _servers.size();
         _lastFrom = 0;
         _cursors = 0;
+        _mergeHeapBuilt = false;
 
         if( ! _qSpec.isEmpty() ){
 
@@ -1265,6 +1266,8 @@ namespace mongo {
         }
 
         _numServers = _cursorMap.size();
+        _mergeHeap.clear();
+        _mergeHeapBuilt = false;
 
     }
 
@@ -1603,7 +1606,64 @@ namespace mongo {
         return false;
     }
 
+    namespace {
+        /** orders merge heap entries so the smallest sort key is on top */
+        struct MergeHeapCmp {
+            const BSONObj& sortKey;
+            MergeHeapCmp( const BSONObj& sk ) : sortKey( sk ) {}
+            bool operator()( const pair<BSONObj,int>& l, const pair<BSONObj,int>& r ) const {
+                return l.first.woSortOrder( r.first, sortKey, true ) > 0;
+            }
+        };
+    }
+
+    BSONObj ParallelSortClusteredCursor::_nextSorted() {
+        MergeHeapCmp cmp( _sortKey );
+
+        if ( ! _mergeHeapBuilt ) {
+            _mergeHeapBuilt = true;
+            _mergeHeap.clear();
+            for ( int i = 0; i < _numServers; i++ ) {
+                if ( ! _cursors[i].more() ) {
+                    if ( _cursors[i].rawMData() )
+                        _cursors[i].rawMData()->pcState->done = true;
+                    continue;
+                }
+                _mergeHeap.push_back( make_pair( _cursors[i].peek(), i ) );
+            }
+            std::make_heap( _mergeHeap.begin(), _mergeHeap.end(), cmp );
+        }
+
+        uassert( 10019 ,  "no more elements" , ! _mergeHeap.empty() );
+
+        std::pop_heap( _mergeHeap.begin(), _mergeHeap.end(), cmp );
+        const pair<BSONObj,int> best = _mergeHeap.back();
+        _mergeHeap.pop_back();
+
+        const int from = best.second;
+        _lastFrom = from;
+        _cursors[from].next();
+
+        if ( _cursors[from].rawMData() )
+            _cursors[from].rawMData()->pcState->count++;
+
+        if ( _cursors[from].more() ) {
+            _mergeHeap.push_back( make_pair( _cursors[from].peek(), from ) );
+            std::push_heap( _mergeHeap.begin(), _mergeHeap.end(), cmp );
+        }
+        else if ( _cursors[from].rawMData() ) {
+            _cursors[from].rawMData()->pcState->done = true;
+        }
+
+        return best.first;
+    }
+
     BSONObj ParallelSortClusteredCursor::next() {
+        // for sorted results keep a heap of each shard's current head -- O(log nShards)
+        // comparisons per document rather than a full rescan of all the heads
+        if ( ! _sortKey.isEmpty() )
+            return _nextSorted();
+
         BSONObj best = BSONObj();
         int bestFrom = -1;
 
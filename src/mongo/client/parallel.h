@@ -392,6 +392,17 @@ namespace mongo {
         FilteringClientCursor * _cursors;
         int _needToSkip;
 
+        // sorted-merge state: one (peeked head, cursor index) entry per shard cursor
+        // with data, kept as a binary min-heap on the sort key.  each next() then
+        // costs O(log nShards) comparisons instead of re-comparing every shard's
+        // head.  entries are safe to hold across calls: a peeked object's buffer
+        // only changes when its own cursor advances, and FilteringClientCursor owns
+        // batch-boundary objects.
+        std::vector< std::pair<BSONObj,int> > _mergeHeap;
+        bool _mergeHeapBuilt;
+
+        BSONObj _nextSorted();
+
     private:
         /**
          * Setups the shard version of the connection. When using a replica
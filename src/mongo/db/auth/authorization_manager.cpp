@@ -30,7 +30,6 @@
 
 #include "mongo/db/auth/authorization_manager.h"
 
-#include <boost/thread/mutex.hpp>
 #include <memory>
 #include <string>
 #include <vector>
@@ -92,7 +91,7 @@ namespace mongo {
     bool AuthorizationManager::_doesSupportOldStylePrivileges = true;
 
     AuthorizationManager::AuthorizationManager(AuthzManagerExternalState* externalState) :
-        _authEnabled(false), _externalState(externalState) {
+        _authEnabled(false), _externalState(externalState), _lock("AuthorizationManager") {
 
         setAuthorizationVersion(2);
     }
@@ -108,7 +107,7 @@ namespace mongo {
     }
 
     Status AuthorizationManager::setAuthorizationVersion(int version) {
-        boost::lock_guard<boost::mutex> lk(_lock);
+        rwlock lk(_lock, true);
 
         if (version != 1 && version != 2) {
             return Status(ErrorCodes::UnsupportedFormat,
@@ -122,7 +121,7 @@ namespace mongo {
     }
 
     int AuthorizationManager::getAuthorizationVersion() {
-        boost::lock_guard<boost::mutex> lk(_lock);
+        rwlock_shared lk(_lock);
         return _getVersion_inlock();
     }
 
@@ -347,42 +346,76 @@ namespace mongo {
     }
 
     Status AuthorizationManager::acquireUser(const UserName& userName, User** acquiredUser) {
-        boost::lock_guard<boost::mutex> lk(_lock);
-        unordered_map<UserName, User*>::iterator it = _userCache.find(userName);
-        if (it != _userCache.end()) {
-            fassert(16914, it->second);
-            fassert(17003, it->second->isValid());
-            fassert(17008, it->second->getRefCount() > 0);
-            it->second->incrementRefCount();
-            *acquiredUser = it->second;
-            return Status::OK();
-        }
+        {
+            // Cache hits -- the common case once connections are authenticated -- only
+            // take the lock shared, so concurrently connecting clients don't serialize
+            // here.
+            rwlock_shared lk(_lock);
+            unordered_map<UserName, User*>::iterator it = _userCache.find(userName);
+            if (it != _userCache.end()) {
+                fassert(16914, it->second);
+                fassert(17003, it->second->isValid());
+                // This fails only if the count is zero, meaning the last holder is in
+                // releaseUser waiting to tear the object down; treat that as a miss.
+                if (it->second->tryIncrementRefCount()) {
+                    *acquiredUser = it->second;
+                    return Status::OK();
+                }
+            }
 
-        if (_getVersion_inlock() != 2) {
-            return Status(ErrorCodes::UserNotFound, mongoutils::str::stream() <<
-                          "User " << userName.getFullName() << " not found.");
+            if (_getVersion_inlock() != 2) {
+                return Status(ErrorCodes::UserNotFound, mongoutils::str::stream() <<
+                              "User " << userName.getFullName() << " not found.");
+            }
         }
 
-        // Put the new user into an auto_ptr temporarily in case there's an error while
-        // initializing the user.
-        auto_ptr<User> userHolder(new User(userName));
-        User* user = userHolder.get();
+        // Not in the cache.  Fetch and parse the privilege document without holding the
+        // lock, as this may read from disk or another node; two threads missing on the
+        // same user may both do this work, but only the first insert below wins.
+        while (true) {
+            const long long cacheGeneration = _cacheGeneration.load();
 
-        BSONObj userObj;
-        Status status = getUserDescription(userName, &userObj);
-        if (!status.isOK()) {
-            return status;
-        }
+            // Put the new user into an auto_ptr temporarily in case there's an error while
+            // initializing the user.
+            auto_ptr<User> userHolder(new User(userName));
+            User* user = userHolder.get();
 
-        status = _initializeUserFromPrivilegeDocument(user, userObj);
-        if (!status.isOK()) {
-            return status;
-        }
+            BSONObj userObj;
+            Status status = getUserDescription(userName, &userObj);
+            if (!status.isOK()) {
+                return status;
+            }
 
-        user->incrementRefCount();
-        _userCache.insert(make_pair(userName, userHolder.release()));
-        *acquiredUser = user;
-        return Status::OK();
+            status = _initializeUserFromPrivilegeDocument(user, userObj);
+            if (!status.isOK()) {
+                return status;
+            }
+
+            rwlock lk(_lock, true);
+            if (_cacheGeneration.load() != cacheGeneration) {
+                // The cache was invalidated while we were fetching, so we can't tell
+                // whether the document we read predates the invalidation.  Refetch.
+                continue;
+            }
+
+            unordered_map<UserName, User*>::iterator it = _userCache.find(userName);
+            if (it != _userCache.end()) {
+                if (it->second->tryIncrementRefCount()) {
+                    // Someone else cached this user while we were fetching it; use theirs.
+                    *acquiredUser = it->second;
+                    return Status::OK();
+                }
+                // The cached object is moribund (ref count zero).  Drop it from the cache
+                // and replace it; the releaseUser call that zeroed the count deletes the
+                // object.
+                _userCache.erase(it);
+            }
+
+            user->incrementRefCount();
+            _userCache.insert(make_pair(userName, userHolder.release()));
+            *acquiredUser = user;
+            return Status::OK();
+        }
     }
 
     void AuthorizationManager::releaseUser(User* user) {
@@ -390,25 +423,33 @@ namespace mongo {
             return;
         }
 
-        boost::lock_guard<boost::mutex> lk(_lock);
-        user->decrementRefCount();
-        if (user->getRefCount() == 0) {
-            // If it's been invalidated then it's not in the _userCache anymore.
-            if (user->isValid()) {
-                MONGO_COMPILER_VARIABLE_UNUSED bool erased = _userCache.erase(user->getName());
-                dassert(erased);
-            }
-            delete user;
+        if (user->decrementRefCount() > 0) {
+            return;
+        }
+
+        rwlock lk(_lock, true);
+        // Nothing can have resurrected the object in the meantime: tryIncrementRefCount
+        // refuses a zero count, so re-checking here is just belt and suspenders.
+        dassert(user->getRefCount() == 0);
+
+        // If it's been invalidated then it's not in the _userCache anymore; acquireUser
+        // may also have already replaced it after finding it with a zero ref count, so
+        // only erase the entry if it is still this object.
+        unordered_map<UserName, User*>::iterator it = _userCache.find(user->getName());
+        if (it != _userCache.end() && it->second == user) {
+            _userCache.erase(it);
         }
+        delete user;
     }
 
     void AuthorizationManager::invalidateUser(User* user) {
-        boost::lock_guard<boost::mutex> lk(_lock);
+        rwlock lk(_lock, true);
         if (!user->isValid()) {
             return;
         }
 
         unordered_map<UserName, User*>::iterator it = _userCache.find(user->getName());
+        _cacheGeneration.addAndFetch(1);
         massert(17052,
                 mongoutils::str::stream() <<
                         "Invalidating cache for user " << user->getName().getFullName() <<
@@ -419,21 +460,23 @@ namespace mongo {
     }
 
     void AuthorizationManager::invalidateUserByName(const UserName& userName) {
-        boost::lock_guard<boost::mutex> lk(_lock);
+        rwlock lk(_lock, true);
 
         unordered_map<UserName, User*>::iterator it = _userCache.find(userName);
         if (it == _userCache.end()) {
             return;
         }
 
+        _cacheGeneration.addAndFetch(1);
         User* user = it->second;
         _userCache.erase(it);
         user->invalidate();
     }
 
     void AuthorizationManager::invalidateUsersFromDB(const std::string& dbname) {
-        boost::lock_guard<boost::mutex> lk(_lock);
+        rwlock lk(_lock, true);
 
+        _cacheGeneration.addAndFetch(1);
         unordered_map<UserName, User*>::iterator it = _userCache.begin();
         while (it != _userCache.end()) {
             User* user = it->second;
@@ -448,16 +491,17 @@ namespace mongo {
 
 
     void AuthorizationManager::addInternalUser(User* user) {
-        boost::lock_guard<boost::mutex> lk(_lock);
+        rwlock lk(_lock, true);
         _userCache.insert(make_pair(user->getName(), user));
     }
 
     void AuthorizationManager::invalidateUserCache() {
-        boost::lock_guard<boost::mutex> lk(_lock);
+        rwlock lk(_lock, true);
         _invalidateUserCache_inlock();
     }
 
     void AuthorizationManager::_invalidateUserCache_inlock() {
+        _cacheGeneration.addAndFetch(1);
         for (unordered_map<UserName, User*>::iterator it = _userCache.begin();
                 it != _userCache.end(); ++it) {
             if (it->second->getName() == internalSecurity.user->getName()) {
@@ -493,7 +537,7 @@ namespace mongo {
     }
 
     Status AuthorizationManager::_initializeAllV1UserData() {
-        boost::lock_guard<boost::mutex> lk(_lock);
+        rwlock lk(_lock, true);
         _invalidateUserCache_inlock();
         V1UserDocumentParser parser;
 
@@ -633,7 +677,7 @@ namespace mongo {
         if (!lkUpgrade.tryLock("Upgrade authorization data")) {
             return Status(ErrorCodes::LockBusy, "Could not lock auth data upgrade process lock.");
         }
-        boost::lock_guard<boost::mutex> lkLocal(_lock);
+        rwlock lkLocal(_lock, true);
         int durableVersion = 0;
         Status status = readAuthzVersion(_externalState.get(), &durableVersion);
         if (!status.isOK())
@@ -737,7 +781,7 @@ namespace mongo {
         if (ns == rolesCollectionNamespace.ns() ||
             ns == adminCommandNamespace.ns() ||
             ns == usersCollectionNamespace.ns()) {
-            boost::lock_guard<boost::mutex> lk(_lock);
+            rwlock lk(_lock, true);
             if (_getVersion_inlock() == 2) {
                 _invalidateUserCache_inlock();
             }
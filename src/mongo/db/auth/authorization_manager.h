@@ -30,7 +30,6 @@
 
 #include <boost/function.hpp>
 #include <boost/scoped_ptr.hpp>
-#include <boost/thread/mutex.hpp>
 #include <string>
 
 #include "mongo/base/disallow_copying.h"
@@ -44,7 +43,9 @@
 #include "mongo/db/auth/user_name_hash.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/unordered_map.h"
+#include "mongo/util/concurrency/rwlock.h"
 
 namespace mongo {
 
@@ -306,6 +307,14 @@ namespace mongo {
          */
         void invalidateUserCache();
 
+        /**
+         * Returns the generation number of the user cache.  The generation is incremented
+         * whenever any user is invalidated, so callers that cache the results of privilege
+         * checks can compare generations to detect that their cached results may be stale.
+         * May be called without holding any locks.
+         */
+        long long getCacheGeneration() const { return _cacheGeneration.load(); }
+
         /**
          * Parses privDoc and fully initializes the user object (credentials, roles, and privileges)
          * with the information extracted from the privilege document.
@@ -410,9 +419,18 @@ namespace mongo {
         unordered_map<UserName, User*> _userCache;
 
         /**
-         * Protects _userCache and _version.
+         * Incremented whenever a User object is invalidated.  Read without _lock by
+         * getCacheGeneration(); see that method for the intended use.
+         */
+        AtomicInt64 _cacheGeneration;
+
+        /**
+         * Protects _userCache and _version.  The acquireUser cache-hit path only takes
+         * this shared (reference counts are atomic), so authenticating connections do not
+         * serialize on it; anything that mutates the cache or _version must hold it
+         * exclusively.
          */
-        boost::mutex _lock;
+        RWLock _lock;
     };
 
 } // namespace mongo
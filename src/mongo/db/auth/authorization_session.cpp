@@ -51,8 +51,12 @@ namespace {
     const std::string ADMIN_DBNAME = "admin";
 }  // namespace
 
-    AuthorizationSession::AuthorizationSession(AuthzSessionExternalState* externalState) {
+    const size_t AuthorizationSession::kGrantCacheSize;
+
+    AuthorizationSession::AuthorizationSession(AuthzSessionExternalState* externalState)
+        : _grantCacheGeneration(-1) {
         _externalState.reset(externalState);
+        _clearGrantCache();
     }
 
     AuthorizationSession::~AuthorizationSession() {
@@ -83,6 +87,7 @@ namespace {
         if (replacedUser) {
             getAuthorizationManager().releaseUser(replacedUser);
         }
+        _clearGrantCache();
 
         return Status::OK();
     }
@@ -96,6 +101,7 @@ namespace {
         if (removedUser) {
             getAuthorizationManager().releaseUser(removedUser);
         }
+        _clearGrantCache();
     }
 
     UserSet::NameIterator AuthorizationSession::getAuthenticatedUserNames() {
@@ -116,6 +122,7 @@ namespace {
 
     void AuthorizationSession::grantInternalAuthorization() {
         _authenticatedUsers.add(internalSecurity.user);
+        _clearGrantCache();
     }
 
     Status AuthorizationSession::checkAuthForQuery(const NamespaceString& ns,
@@ -286,7 +293,45 @@ namespace {
         return size;
     }
 
+    void AuthorizationSession::_clearGrantCache() {
+        for (size_t i = 0; i < kGrantCacheSize; ++i) {
+            _grantCache[i].populated = false;
+        }
+    }
+
     bool AuthorizationSession::_isAuthorizedForPrivilege(const Privilege& privilege) {
+        // Cached verdicts are only valid while the AuthorizationManager's user cache is
+        // unchanged; any user invalidation bumps the generation and flushes this cache.
+        const long long generation = getAuthorizationManager().getCacheGeneration();
+        if (generation != _grantCacheGeneration) {
+            _clearGrantCache();
+            _grantCacheGeneration = generation;
+        }
+
+        const ResourcePattern& target = privilege.getResourcePattern();
+        CachedGrant& slot = _grantCache[target.hash() % kGrantCacheSize];
+        if (slot.populated && slot.resource == target && slot.actions == privilege.getActions()) {
+            return slot.authorized;
+        }
+
+        const bool authorized = _checkAuthorizedForPrivilege(privilege);
+
+        // Don't cache a verdict computed from out-of-date user data (re-acquiring a fresh user
+        // object failed during the check); the next check should retry the refresh.
+        for (UserSet::iterator it = _authenticatedUsers.begin();
+                it != _authenticatedUsers.end(); ++it) {
+            if (!(*it)->isValid())
+                return authorized;
+        }
+
+        slot.populated = true;
+        slot.authorized = authorized;
+        slot.resource = target;
+        slot.actions = privilege.getActions();
+        return authorized;
+    }
+
+    bool AuthorizationSession::_checkAuthorizedForPrivilege(const Privilege& privilege) {
         AuthorizationManager& authMan = getAuthorizationManager();
         const ResourcePattern& target(privilege.getResourcePattern());
 
@@ -38,6 +38,7 @@
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authz_session_external_state.h"
 #include "mongo/db/auth/privilege.h"
+#include "mongo/db/auth/resource_pattern.h"
 #include "mongo/db/auth/user_name.h"
 #include "mongo/db/auth/user_set.h"
 #include "mongo/db/namespace_string.h"
@@ -148,14 +149,42 @@ namespace mongo {
     private:
 
         // Checks if this connection is authorized for the given Privilege, ignoring whether or not
-        // we should even be doing authorization checks in general.  Note: this may acquire a read
-        // lock on the admin database (to update out-of-date user privilege information).
+        // we should even be doing authorization checks in general.  Consults and populates the
+        // session's grant cache; see _checkAuthorizedForPrivilege.
         bool _isAuthorizedForPrivilege(const Privilege& privilege);
 
+        // Resolves the given Privilege against the authenticated users' granted privileges,
+        // without consulting the grant cache.  Note: this may acquire a read lock on the admin
+        // database (to update out-of-date user privilege information).
+        bool _checkAuthorizedForPrivilege(const Privilege& privilege);
+
+        // Marks all grant cache entries empty.  Must be called whenever the set of authenticated
+        // users on this session changes; changes to the users' privileges themselves are detected
+        // via the AuthorizationManager's cache generation.
+        void _clearGrantCache();
+
+        // The verdict of a previous privilege check, so that repeating the same check does not
+        // repeat the resolution against every authenticated user's privilege maps.
+        struct CachedGrant {
+            bool populated;
+            bool authorized;
+            ResourcePattern resource;
+            ActionSet actions;
+        };
+
+        // The cache is direct-mapped by the resource's hash; a conflicting check simply
+        // replaces the slot's previous entry.
+        static const size_t kGrantCacheSize = 32;
+
         scoped_ptr<AuthzSessionExternalState> _externalState;
 
         // All Users who have been authenticated on this connection
         UserSet _authenticatedUsers;
+
+        // Cached privilege check verdicts, valid only while the AuthorizationManager's cache
+        // generation equals _grantCacheGeneration.
+        CachedGrant _grantCache[kGrantCacheSize];
+        long long _grantCacheGeneration;
     };
 
 } // namespace mongo
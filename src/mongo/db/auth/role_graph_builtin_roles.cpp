@@ -125,6 +125,7 @@ namespace {
             << ActionType::createIndex
             << ActionType::indexStats
             << ActionType::profileEnable
+            << ActionType::queryShapeStats
             << ActionType::reIndex
             << ActionType::renameCollectionSameDB // read_write gets this also
             << ActionType::storageDetails
@@ -142,6 +143,7 @@ namespace {
             << ActionType::hostInfo
             << ActionType::listDatabases
             << ActionType::listShards
+            << ActionType::lockStats
             << ActionType::logRotate
             << ActionType::netstat
             << ActionType::replSetFreeze
@@ -156,6 +158,7 @@ namespace {
             << ActionType::shutdown
             << ActionType::top
             << ActionType::touch
+            << ActionType::traceDump
             << ActionType::unlock
             << ActionType::unsetSharding
             << ActionType::writeBacksQueued
@@ -29,7 +29,7 @@ namespace mongo {
 
     User::User(const UserName& name) : _name(name), _refCount(0), _isValid(1) {}
     User::~User() {
-        dassert(_refCount == 0);
+        dassert(_refCount.load() == 0);
     }
 
     const UserName& User::getName() const {
@@ -49,7 +49,7 @@ namespace mongo {
     }
 
     uint32_t User::getRefCount() const {
-        return _refCount;
+        return _refCount.load();
     }
 
     const ActionSet User::getActionsForResource(const ResourcePattern& resource) const {
@@ -65,8 +65,8 @@ namespace mongo {
         _privileges = other._privileges;
         _roles = other._roles;
         _credentials = other._credentials;
-        _refCount = other._refCount;
-        _isValid= other._isValid;
+        _refCount.store(other._refCount.load());
+        _isValid.store(other._isValid.load());
     }
 
     void User::setCredentials(const CredentialData& credentials) {
@@ -140,11 +140,23 @@ namespace mongo {
     }
 
     void User::incrementRefCount() {
-        ++_refCount;
+        _refCount.fetchAndAdd(1);
+    }
+
+    bool User::tryIncrementRefCount() {
+        while (true) {
+            uint32_t count = _refCount.load();
+            if (count == 0) {
+                return false;
+            }
+            if (_refCount.compareAndSwap(count, count + 1) == count) {
+                return true;
+            }
+        }
     }
 
-    void User::decrementRefCount() {
-        dassert(_refCount > 0);
-        --_refCount;
+    uint32_t User::decrementRefCount() {
+        dassert(_refCount.load() > 0);
+        return _refCount.subtractAndFetch(1);
     }
 } // namespace mongo
@@ -172,14 +172,23 @@ namespace mongo {
          */
         void incrementRefCount();
 
+        /**
+         * As incrementRefCount(), but refuses to resurrect an object whose reference count
+         * has already reached zero (meaning the last holder is concurrently tearing it
+         * down).  Returns false in that case and the caller must not use the object.
+         *
+         * This method should *only* be called by the AuthorizationManager.
+         */
+        bool tryIncrementRefCount();
+
         /**
          * Decrements the reference count for this User object, which records how many threads have
-         * a reference to it.  Once the reference count goes to zero, the AuthorizationManager is
-         * allowed to destroy this instance.
+         * a reference to it.  Returns the remaining count; once it goes to zero, the
+         * AuthorizationManager is allowed to destroy this instance.
          *
          * This method should *only* be called by the AuthorizationManager.
          */
-        void decrementRefCount();
+        uint32_t decrementRefCount();
 
 
     private:
@@ -197,8 +206,9 @@ namespace mongo {
 
         // _refCount and _isInvalidated are modified exclusively by the AuthorizationManager
         // _isInvalidated can be read by any consumer of User, but _refCount can only be
-        // meaningfully read by the AuthorizationManager, as _refCount is guarded by the AM's _lock
-        uint32_t _refCount;
+        // meaningfully read by the AuthorizationManager.  _refCount is atomic so that the
+        // AM's cache fast path can adjust it while holding its lock only shared.
+        AtomicUInt32 _refCount;
         AtomicUInt32 _isValid; // Using as a boolean
 
     };
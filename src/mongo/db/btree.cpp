@@ -754,6 +754,55 @@ namespace mongo {
      */
 
     bool guessIncreasing = false;
+
+    namespace {
+
+        /**
+         * Tracks, per index, whether recent inserts have been arriving in increasing key
+         * order (timestamps, sequence numbers, ...).  Costs one key compare per insert;
+         * after kMinRun consecutive increasing keys, bt_insert() sets guessIncreasing so
+         * find()'s binary search starts at the top of each bucket, which makes the
+         * descent for an append cost a single compare per level.
+         *
+         * Entries are keyed by IndexDetails address.  A stale entry after an index drop
+         * merely mispredicts the first few searches on whatever index reuses the slot,
+         * so no invalidation hook is needed, and reuse of the slots keeps the map small.
+         */
+        class IncreasingInsertDetector {
+        public:
+            IncreasingInsertDetector() : _mutex( "increasingInsertDetector" ) { }
+
+            /** note an insert of 'key'; returns true if this index looks append-mostly */
+            bool note( const IndexDetails& idx, const BSONObj& key, const Ordering& order ) {
+                scoped_lock lk( _mutex );
+                Entry& e = _entries[ &idx ];
+                if ( !e.lastKey.isEmpty() && key.woCompare( e.lastKey, order, false ) >= 0 ) {
+                    if ( e.run < kMinRun )
+                        e.run++;
+                }
+                else {
+                    e.run = 0;
+                }
+                e.lastKey = key.getOwned();
+                return e.run >= kMinRun;
+            }
+
+        private:
+            static const int kMinRun = 8;
+            struct Entry {
+                Entry() : run(0) { }
+                BSONObj lastKey;
+                int run;
+            };
+            map<const IndexDetails*,Entry> _entries;
+            mongo::mutex _mutex;
+        };
+
+        const int IncreasingInsertDetector::kMinRun;
+
+        IncreasingInsertDetector increasingInsertDetector;
+    }
+
     template< class V >
     bool BtreeBucket<V>::find(const IndexDetails& idx, const Key& key, const DiskLoc &rl, 
                               const Ordering &order, int& pos, bool assertIfDup) const {
@@ -953,6 +1002,26 @@ namespace mongo {
 //#define BTREEMOD(loc) (static_cast<DiskLoc>(loc).btreemod<V>())
 #define BTREEMOD(loc) (loc.template btreemod<V>())
 
+    /** Resolves buckets during a single descent or scan.  BTREE() goes through
+        cc() and an out-of-line recordFor() call on every child it follows; this
+        grabs the thread's ExtentManager once at construction so each hop is just
+        base-pointer arithmetic.  Only valid while the lock it was created under
+        is held (same lifetime rule as the bucket pointers themselves).
+    */
+    template< class V >
+    class BtreeBucketResolver {
+    public:
+        BtreeBucketResolver() : _em( cc().database()->getExtentManager() ) { }
+        const BtreeBucket<V>* operator()( const DiskLoc& loc ) const {
+            Record *r = _em.fastRecordFor( loc );
+            if ( r )
+                return (const BtreeBucket<V> *) r->data();
+            return loc.btree<V>(); // file base not published yet; checked path
+        }
+    private:
+        const ExtentManager& _em;
+    };
+
     template< class V >
     void BtreeBucket<V>::replaceWithNextChild( const DiskLoc thisLoc, IndexDetails &id ) {
         verify( this->n == 0 && !this->nextChild.isNull() );
@@ -1481,12 +1550,15 @@ namespace mongo {
         int ko = keyOfs + direction;
         DiskLoc nextDown = this->childForPos(ko+adj);
         if ( !nextDown.isNull() ) {
+            BtreeBucketResolver<V> resolve;
+            const BtreeBucket *b = resolve(nextDown);
             while ( 1 ) {
-                keyOfs = direction>0 ? 0 : BTREE(nextDown)->n - 1;
-                DiskLoc loc = BTREE(nextDown)->childForPos(keyOfs + adj);
+                keyOfs = direction>0 ? 0 : b->n - 1;
+                DiskLoc loc = b->childForPos(keyOfs + adj);
                 if ( loc.isNull() )
                     break;
                 nextDown = loc;
+                b = resolve(nextDown);
             }
             return nextDown;
         }
@@ -1499,10 +1571,11 @@ namespace mongo {
         // end of bucket.  traverse back up.
         DiskLoc childLoc = thisLoc;
         DiskLoc ancestor = this->parent;
+        BtreeBucketResolver<V> resolve;
         while ( 1 ) {
             if ( ancestor.isNull() )
                 break;
-            const BtreeBucket *an = BTREE(ancestor);
+            const BtreeBucket *an = resolve(ancestor);
             for ( int i = 0; i < an->n; i++ ) {
                 if ( an->childForPos(i+adj) == childLoc ) {
                     keyOfs = i;
@@ -1551,6 +1624,7 @@ namespace mongo {
     template< class V >
     bool BtreeBucket<V>::customFind( int l, int h, const BSONObj &keyBegin, int keyBeginLen, bool afterKey, const vector< const BSONElement * > &keyEnd, const vector< bool > &keyEndInclusive, const Ordering &order, int direction, DiskLoc &thisLoc, int &keyOfs, pair< DiskLoc, int > &bestParent ) {
         const BtreeBucket<V> * bucket = BTREE(thisLoc);
+        BufBuilder bb(512); // reused across probes so each key unpack doesn't allocate
         while( 1 ) {
             if ( l + 1 == h ) {
                 keyOfs = ( direction > 0 ) ? h : l;
@@ -1565,7 +1639,8 @@ namespace mongo {
                 }
             }
             int m = l + ( h - l ) / 2;
-            int cmp = customBSONCmp( bucket->keyNode( m ).key.toBson(), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction );
+            bb.reset();
+            int cmp = customBSONCmp( bucket->keyNode( m ).key.toBson(bb), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction );
             if ( cmp < 0 ) {
                 l = m;
             }
@@ -1592,15 +1667,16 @@ namespace mongo {
     void BtreeBucket<V>::advanceTo(DiskLoc &thisLoc, int &keyOfs, const BSONObj &keyBegin, int keyBeginLen, bool afterKey, const vector< const BSONElement * > &keyEnd, const vector< bool > &keyEndInclusive, const Ordering &order, int direction ) const {
         int l,h;
         bool dontGoUp;
+        BufBuilder bb(512); // reused across probes so each key unpack doesn't allocate
         if ( direction > 0 ) {
             l = keyOfs;
             h = this->n - 1;
-            dontGoUp = ( customBSONCmp( keyNode( h ).key.toBson(), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction ) >= 0 );
+            dontGoUp = ( customBSONCmp( keyNode( h ).key.toBson(bb), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction ) >= 0 );
         }
         else {
             l = 0;
             h = keyOfs;
-            dontGoUp = ( customBSONCmp( keyNode( l ).key.toBson(), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction ) <= 0 );
+            dontGoUp = ( customBSONCmp( keyNode( l ).key.toBson(bb), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction ) <= 0 );
         }
         pair< DiskLoc, int > bestParent;
         if ( dontGoUp ) {
@@ -1611,15 +1687,19 @@ namespace mongo {
         }
         else {
             // go up parents until rightmost/leftmost node is >=/<= target or at top
-            while( !BTREE(thisLoc)->parent.isNull() ) {
-                thisLoc = BTREE(thisLoc)->parent;
+            BtreeBucketResolver<V> resolve;
+            const BtreeBucket *b = resolve(thisLoc);
+            while( !b->parent.isNull() ) {
+                thisLoc = b->parent;
+                b = resolve(thisLoc);
+                bb.reset();
                 if ( direction > 0 ) {
-                    if ( customBSONCmp( BTREE(thisLoc)->keyNode( BTREE(thisLoc)->n - 1 ).key.toBson(), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction ) >= 0 ) {
+                    if ( customBSONCmp( b->keyNode( b->n - 1 ).key.toBson(bb), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction ) >= 0 ) {
                         break;
                     }
                 }
                 else {
-                    if ( customBSONCmp( BTREE(thisLoc)->keyNode( 0 ).key.toBson(), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction ) <= 0 ) {
+                    if ( customBSONCmp( b->keyNode( 0 ).key.toBson(bb), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction ) <= 0 ) {
                         break;
                     }
                 }
@@ -1644,11 +1724,13 @@ namespace mongo {
                                       const vector< const BSONElement * > &keyEnd, const vector< bool > &keyEndInclusive, 
                                       const Ordering &order, int direction, pair< DiskLoc, int > &bestParent ) {
         dassert( direction == 1 || direction == -1 );
-        const BtreeBucket<V> *bucket = BTREE(locInOut);
+        BtreeBucketResolver<V> resolve;
+        const BtreeBucket<V> *bucket = resolve(locInOut);
         if ( bucket->n == 0 ) {
             locInOut = DiskLoc();
             return;
         }
+        BufBuilder bb(512); // reused across probes so each key unpack doesn't allocate
         // go down until find smallest/biggest >=/<= target
         while( 1 ) {
             int l = 0;
@@ -1658,7 +1740,8 @@ namespace mongo {
             int z = (1-direction)/2*h;
 
             // leftmost/rightmost key may possibly be >=/<= search key
-            int res = customBSONCmp( bucket->keyNode( z ).key.toBson(), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction );
+            bb.reset();
+            int res = customBSONCmp( bucket->keyNode( z ).key.toBson(bb), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction );
             bool firstCheck = direction*res >= 0;
 
             if ( firstCheck ) {
@@ -1674,7 +1757,7 @@ namespace mongo {
                 if ( !next.isNull() ) {
                     bestParent = pair< DiskLoc, int >( locInOut, keyOfs );
                     locInOut = next;
-                    bucket = BTREE(locInOut);
+                    bucket = resolve(locInOut);
                     continue;
                 }
                 else {
@@ -1682,7 +1765,8 @@ namespace mongo {
                 }
             }
 
-            res = customBSONCmp( bucket->keyNode( h-z ).key.toBson(), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction );
+            bb.reset();
+            res = customBSONCmp( bucket->keyNode( h-z ).key.toBson(bb), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction );
             bool secondCheck = direction*res < 0;
 
             if ( secondCheck ) {
@@ -1701,7 +1785,7 @@ namespace mongo {
                 }
                 else {
                     locInOut = next;
-                    bucket = BTREE(locInOut);
+                    bucket = resolve(locInOut);
                     continue;
                 }
             }
@@ -1709,7 +1793,7 @@ namespace mongo {
             if ( !customFind( l, h, keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction, locInOut, keyOfs, bestParent ) ) {
                 return;
             }
-            bucket = BTREE(locInOut);
+            bucket = resolve(locInOut);
         }
     }
 
@@ -1795,7 +1879,11 @@ namespace mongo {
                                const BSONObj& _key, const Ordering &order, bool dupsAllowed,
                                IndexDetails& idx, bool toplevel) const 
     {
-        guessIncreasing = _key.firstElementType() == jstOID && idx.isIdIndex();
+        // _id ObjectIds are known increasing a priori; any other near-ordered key
+        // pattern (timestamps etc.) is detected at the cost of one compare against the
+        // previous key, and mispredictions fall back to an ordinary binary search.
+        const bool nearOrdered = increasingInsertDetector.note( idx, _key, order );
+        guessIncreasing = nearOrdered || ( _key.firstElementType() == jstOID && idx.isIdIndex() );
         KeyOwned key(_key);
 
         dassert(toplevel); 
@@ -394,6 +394,9 @@ namespace mongo {
         int nKeys() const { return this->n; }
         const DiskLoc getNextChild() const { return this->nextChild; }
 
+        /** Child bucket at position i; i == n returns the right child.  For tree inspection. */
+        const DiskLoc getChildForPos( int i ) const { return childForPos( i ); }
+
         // for tree inspection and statistical analysis
         // NOTE: topSize and emptySize have different types in BtreeData_V0 and BtreeData_V1
 
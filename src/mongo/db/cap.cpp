@@ -34,6 +34,7 @@
 #include <algorithm>
 #include <list>
 
+#include "mongo/db/capped_insert_notifier.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/db.h"
 #include "mongo/db/index_update.h"
@@ -116,6 +117,40 @@ namespace mongo {
 
     }
 
+    /* O(1) fast path for the cappedAlloc delete loop.  deleteRecord() just freed the
+       oldest record in the cap extent and addDeletedRec() pushed it at the head of the
+       current extent's deleted list.  Records are freed in physical order, so nearly
+       always the freed record begins exactly where the extent's free hole (the next
+       list entry) ends, and the two can be merged in place without rebuilding and
+       sorting the list.  When the neighborhood is more complicated (e.g. right after
+       the capExtent advances past the leftover sliver at the end of an extent) we fall
+       back on the general compact().
+    */
+    void NamespaceDetails::cappedCoalesce() {
+        verify( isCapped() );
+
+        DiskLoc head = cappedFirstDeletedInCurExtent();
+        verify( !head.isNull() && inCapExtent( head ) );
+        DiskLoc next = head.drec()->nextDeleted();
+        if ( !next.isNull() && inCapExtent( next ) ) {
+            if ( next.getOfs() + next.drec()->lengthWithHeaders() == head.getOfs() ) {
+                // the hole ends where the freed record begins; grow the hole and drop
+                // the freed record's list entry
+                getDur().writingInt( next.drec()->lengthWithHeaders() ) += head.drec()->lengthWithHeaders();
+                getDur().writingDiskLoc( cappedFirstDeletedInCurExtent() ) = next;
+                return;
+            }
+            if ( head.getOfs() + head.drec()->lengthWithHeaders() == next.getOfs() ) {
+                // the freed record ends where the hole begins; absorb the hole
+                getDur().writingInt( head.drec()->lengthWithHeaders() ) += next.drec()->lengthWithHeaders();
+                getDur().writingDiskLoc( head.drec()->nextDeleted() ) = next.drec()->nextDeleted();
+                return;
+            }
+        }
+
+        compact();
+    }
+
     DiskLoc &NamespaceDetails::cappedFirstDeletedInCurExtent() {
         if ( cappedLastDelRecLastExtent().isNull() )
             return cappedListOfAllDeletedRecords();
@@ -279,7 +314,7 @@ namespace mongo {
 
             DiskLoc fr = theCapExtent()->firstRecord;
             theDataFileMgr.deleteRecord(this, ns, fr.rec(), fr, true); // ZZZZZZZZZZZZ
-            compact();
+            cappedCoalesce();
             if( ++passes > maxPasses ) {
                 StringBuilder sb;
                 sb << "passes >= maxPasses in NamespaceDetails::cappedAlloc: ns: " << ns
@@ -296,6 +331,9 @@ namespace mongo {
         if ( _capFirstNewRecord.isValid() && _capFirstNewRecord.isNull() )
             getDur().writingDiskLoc(_capFirstNewRecord) = loc;
 
+        // wake awaitData tailers; they re-scan once our write lock is released
+        CappedInsertNotifier::notify( ns );
+
         return loc;
     }
 
@@ -0,0 +1,106 @@
+// capped_insert_notifier.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/capped_insert_notifier.h"
+
+#include "mongo/bson/util/atomic_int.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+    namespace {
+        typedef StringMap< shared_ptr<CappedInsertNotifier> > NotifierMap;
+
+        mongo::mutex notifierRegistryLock("cappedInsertNotifierRegistry");
+        NotifierMap* notifierRegistry = NULL; // created on first use, never destroyed
+        AtomicUInt notifierCount;             // fast existence check for notify()
+    }
+
+    CappedInsertNotifier::CappedInsertNotifier()
+        : _mutex("CappedInsertNotifier"), _version(0) {
+    }
+
+    unsigned long long CappedInsertNotifier::version() const {
+        mutex::scoped_lock lk(_mutex);
+        return _version;
+    }
+
+    void CappedInsertNotifier::waitForInsert(unsigned long long referenceVersion,
+                                             unsigned timeoutMillis) {
+        mutex::scoped_lock lk(_mutex);
+        while (_version == referenceVersion) {
+            if (!_notifier.timed_wait(lk.boost(),
+                                      boost::posix_time::milliseconds(timeoutMillis)))
+                return; // timed out
+        }
+    }
+
+    void CappedInsertNotifier::notifyAll() {
+        mutex::scoped_lock lk(_mutex);
+        _version++;
+        _notifier.notify_all();
+    }
+
+    // static
+    shared_ptr<CappedInsertNotifier> CappedInsertNotifier::get(const StringData& ns) {
+        mutex::scoped_lock lk(notifierRegistryLock);
+        if (!notifierRegistry)
+            notifierRegistry = new NotifierMap();
+        shared_ptr<CappedInsertNotifier>& n = (*notifierRegistry)[ns];
+        if (!n) {
+            n.reset(new CappedInsertNotifier());
+            notifierCount++;
+        }
+        return n;
+    }
+
+    // static
+    void CappedInsertNotifier::notify(const StringData& ns) {
+        if (notifierCount == 0) {
+            // nothing has ever tailed a capped collection; stay off the hot path
+            return;
+        }
+        shared_ptr<CappedInsertNotifier> n;
+        {
+            mutex::scoped_lock lk(notifierRegistryLock);
+            NotifierMap::const_iterator it = notifierRegistry->find(ns);
+            if (it == notifierRegistry->end())
+                return;
+            n = it->second;
+        }
+        // the version bump must happen for every insert once a notifier exists, even
+        // with no one currently in timed_wait, or a waiter between its scan and its
+        // wait would sleep through this insert until the timeout
+        n->notifyAll();
+    }
+
+}
@@ -0,0 +1,78 @@
+// capped_insert_notifier.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <boost/thread/condition.hpp>
+
+#include "mongo/base/string_data.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /** Lets tailable awaitData getMores block until a capped collection actually
+        receives an insert instead of sleep-polling every couple of milliseconds.
+        Capped allocations fire notify(); the getMore retry loop in receivedGetMore
+        waits on the collection's notifier with a timeout.
+
+        The version counter exists to close the obvious race: a waiter captures the
+        version before scanning, so an insert that lands during the scan makes the
+        subsequent wait return immediately rather than being missed.
+    */
+    class CappedInsertNotifier : boost::noncopyable {
+    public:
+        CappedInsertNotifier();
+
+        /** @return an opaque version to pass to waitForInsert().  capture it before
+            scanning the collection. */
+        unsigned long long version() const;
+
+        /** block until an insert moves the version past 'referenceVersion' or
+            'timeoutMillis' elapses.  spurious returns are fine; callers re-scan. */
+        void waitForInsert(unsigned long long referenceVersion, unsigned timeoutMillis);
+
+        /** wake all waiters.  called with the collection write locked. */
+        void notifyAll();
+
+        /** the notifier for 'ns', created on first use.  entries are never removed;
+            the registry is bounded by the number of capped namespaces ever tailed. */
+        static shared_ptr<CappedInsertNotifier> get(const StringData& ns);
+
+        /** fire the notifier for 'ns' if one exists.  a single atomic read when no
+            capped collection has ever been tailed, so safe on the insert hot path. */
+        static void notify(const StringData& ns);
+
+    private:
+        mutable mongo::mutex _mutex;
+        boost::condition _notifier;
+        unsigned long long _version;
+    };
+
+}
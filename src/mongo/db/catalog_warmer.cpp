@@ -0,0 +1,138 @@
+// catalog_warmer.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/catalog_warmer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/client.h"
+#include "mongo/db/database.h"
+#include "mongo/db/instance.h"
+#include "mongo/db/storage/extent_manager.h"
+#include "mongo/db/storage_options.h"
+#include "mongo/util/background.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    namespace {
+
+        struct DbRecency {
+            string name;
+            std::time_t lastWritten;
+
+            bool operator<( const DbRecency& other ) const {
+                // most recently written first
+                return lastWritten > other.lastWritten;
+            }
+        };
+
+        /* when a database was last written: the mtime of its first datafile,
+           which every flush of the database touches.  this survives restarts,
+           so it orders warming by what the node was actually serving before it
+           went down. */
+        std::time_t lastWriteTime( const string& dbName ) {
+            boost::filesystem::path p( storageGlobalParams.dbpath );
+            if ( storageGlobalParams.directoryperdb )
+                p /= dbName;
+            p /= dbName + ".0";
+            try {
+                if ( boost::filesystem::exists( p ) )
+                    return boost::filesystem::last_write_time( p );
+            }
+            catch ( const std::exception& ) {
+                // fall through; warm it last
+            }
+            return 0;
+        }
+    }
+
+    class CatalogWarmer : public BackgroundJob {
+    public:
+        CatalogWarmer() : BackgroundJob( true /* selfDelete */ ) {}
+
+        virtual string name() const { return "CatalogWarmer"; }
+
+        // warming is housekeeping; yield the cpu/io schedulers to foreground work
+        virtual Priority priority() const { return LOW; }
+
+        virtual void run() {
+            Client::initThread( "catalogWarmer" );
+            cc().getAuthorizationSession()->grantInternalAuthorization();
+
+            vector<DbRecency> dbs;
+            {
+                vector<string> names;
+                getDatabaseNames( names );
+                for ( unsigned i = 0; i < names.size(); i++ ) {
+                    DbRecency r;
+                    r.name = names[i];
+                    r.lastWritten = lastWriteTime( names[i] );
+                    dbs.push_back( r );
+                }
+            }
+            std::sort( dbs.begin(), dbs.end() );
+
+            Timer t;
+            unsigned warmed = 0;
+            for ( unsigned i = 0; i < dbs.size() && !inShutdown(); i++ ) {
+                try {
+                    Client::ReadContext ctx( dbs[i].name );
+                    cc().database()->getExtentManager().warmFiles();
+                    warmed++;
+                }
+                catch ( const DBException& e ) {
+                    // e.g. dropped since we listed it; fine, move on
+                    LOG(1) << "catalog warmer skipping " << dbs[i].name << ": " << e.what() << endl;
+                }
+                // a brief gap between databases keeps the lock manager free for
+                // foreground work while we go through a long catalog
+                sleepmillis( 2 );
+            }
+
+            if ( warmed )
+                log() << "catalog warmer mapped " << warmed << " databases in "
+                      << t.millis() << "ms" << endl;
+
+            cc().shutdown();
+        }
+    };
+
+    void startCatalogWarmer() {
+        ( new CatalogWarmer() )->go();
+    }
+
+}
@@ -183,6 +183,7 @@ namespace mongo {
     {
         _hasWrittenThisPass = false;
         _pageFaultRetryableSection = 0;
+        _replyBufSize = 32768;
         _connectionId = p ? p->connectionId() : 0;
         _curOp = new CurOp( this );
 #ifndef _WIN32
@@ -230,6 +231,26 @@ namespace mongo {
         }
     }
 
+    void Client::noteReplyLen( int len ) {
+        static const int kMinReplyBufSize = 4 * 1024;
+        static const int kMaxReplyBufSize = 4 * 1024 * 1024;
+
+        if ( len > _replyBufSize ) {
+            // jump straight to a size that fits; the current reply already paid
+            // for the growth reallocs
+            int sz = _replyBufSize;
+            while ( sz < len && sz < kMaxReplyBufSize )
+                sz *= 2;
+            _replyBufSize = sz;
+        }
+        else if ( len * 4 < _replyBufSize && _replyBufSize > kMinReplyBufSize ) {
+            // trim gradually once replies run well below the reservation, so one
+            // burst of big replies doesn't leave this connection over-reserving
+            // for its lifetime
+            _replyBufSize /= 2;
+        }
+    }
+
     bool Client::shutdown() {
 #if defined(_DEBUG) && !defined(MONGO_OPTIMIZED_BUILD) && !XSAN_ENABLED
         {
@@ -130,6 +130,15 @@ namespace mongo {
 
         LockState& lockState() { return _ls; }
 
+        /**
+         * Initial reservation for reply buffers built on this connection.
+         * Tracks recent reply sizes via noteReplyLen() so steady-state replies
+         * neither grow the buffer (each growth is a realloc and copy) nor
+         * over-reserve once traffic shrinks again.
+         */
+        int replyBufferSize() const { return _replyBufSize; }
+        void noteReplyLen( int len );
+
     private:
         Client(const std::string& desc, AbstractMessagingPort *p = 0);
         friend class CurOp;
@@ -146,6 +155,7 @@ namespace mongo {
 
         bool _hasWrittenThisPass;
         PageFaultRetryableSection *_pageFaultRetryableSection;
+        int _replyBufSize;
 
         LockState _ls;
         
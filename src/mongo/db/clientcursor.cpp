@@ -53,15 +53,30 @@
 #include "mongo/db/scanandorder.h"
 #include "mongo/platform/random.h"
 #include "mongo/util/processinfo.h"
+#include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
 
-    ClientCursor::CCById ClientCursor::clientCursorsById;
+    ClientCursor::IdShard ClientCursor::idShards[ClientCursor::NumIdShards];
+    AtomicUInt ClientCursor::_numCursors;
     boost::recursive_mutex& ClientCursor::ccmutex( *(new boost::recursive_mutex()) );
     long long ClientCursor::numberTimedOut = 0;
     set<Runner*> ClientCursor::nonCachedRunners;
 
+    namespace {
+        // Reply byte thresholds for getMore batches.  The base matches the historical
+        // 4MB "enough" cutoff; streaming consumers are grown geometrically up to the
+        // ceiling, which leaves headroom under MaxMessageSizeBytes (48MB) for the
+        // reply header and the document that crosses the threshold.
+        const int kBatchByteBudgetBase = 4 * 1024 * 1024;
+        const int kBatchByteBudgetMax = 32 * 1024 * 1024;
+
+        // A client that issues its next getMore within this interval of the previous
+        // reply is draining batches as fast as we produce them.
+        const uint64_t kFastConsumerGapMicros = 100 * 1000;
+    }
+
     void aboutToDeleteForSharding(const StringData& ns,
                                   const Database* db,
                                   const NamespaceDetails* nsd,
@@ -93,8 +108,12 @@ namespace mongo {
 
         _idleAgeMillis = 0;
         _leftoverMaxTimeMicros = 0;
+        _batchByteBudget = kBatchByteBudgetBase;
+        _lastBatchReturnedMicros = 0;
         _pinValue = 0;
         _pos = 0;
+        _oplogWindowEligible = false;
+        _oplogWindowServed = false;
         
         Lock::assertAtLeastReadLocked(_ns);
 
@@ -104,9 +123,44 @@ namespace mongo {
             ++_pinValue;
         }
 
-        recursive_scoped_lock lock(ccmutex);
-        _cursorid = allocCursorId_inlock();
-        clientCursorsById.insert( make_pair(_cursorid, this) );
+        // Pick an id and publish ourselves in its shard.  Ids are effectively unique
+        // (timestamp << 32 | random), but the id is only ours once the insert succeeds.
+        for ( ;; ) {
+            _cursorid = allocCursorId();
+            IdShard& shard = shardForId( _cursorid );
+            recursive_scoped_lock lock( shard.mutex );
+            if ( shard.byId.insert( make_pair(_cursorid, this) ).second )
+                break;
+        }
+        _numCursors++;
+    }
+
+    int ClientCursor::nextBatchByteBudget() {
+        if ( _queryOptions & QueryOption_Exhaust ) {
+            // an exhaust client has committed to draining the whole stream back-to-back,
+            // so there is no risk of shipping data it never consumes; ramping up would
+            // just pay extra per-batch overhead at the start of every stream
+            return kBatchByteBudgetMax;
+        }
+        if ( _lastBatchReturnedMicros ) {
+            uint64_t gap = curTimeMicros64() - _lastBatchReturnedMicros;
+            if ( gap < kFastConsumerGapMicros ) {
+                if ( _batchByteBudget < kBatchByteBudgetMax / 2 )
+                    _batchByteBudget *= 2;
+                else
+                    _batchByteBudget = kBatchByteBudgetMax;
+            }
+            else {
+                // the client paused to chew on what it had (or a human is paging);
+                // don't keep shipping huge batches it may never finish
+                _batchByteBudget = kBatchByteBudgetBase;
+            }
+        }
+        return _batchByteBudget;
+    }
+
+    void ClientCursor::noteBatchReturned() {
+        _lastBatchReturnedMicros = curTimeMicros64();
     }
 
     ClientCursor::~ClientCursor() {
@@ -122,25 +176,33 @@ namespace mongo {
                 // Removes 'this' from bylocation map
                 setLastLoc_inlock( DiskLoc() );
             }
+        }
 
-            clientCursorsById.erase(_cursorid);
+        {
+            IdShard& shard = shardForId( _cursorid );
+            recursive_scoped_lock lock( shard.mutex );
+            shard.byId.erase(_cursorid);
 
             // defensive:
             _cursorid = INVALID_CURSOR_ID;
             _pos = -2;
             _pinValue = 0;
         }
+        _numCursors--;
     }
 
     // static
     void ClientCursor::assertNoCursors() {
-        recursive_scoped_lock lock(ccmutex);
-        if (clientCursorsById.size() > 0) {
-            log() << "ERROR clientcursors exist but should not at this point" << endl;
-            ClientCursor *cc = clientCursorsById.begin()->second;
-            log() << "first one: " << cc->_cursorid << ' ' << cc->_ns << endl;
-            clientCursorsById.clear();
-            verify(false);
+        for ( int i = 0; i < NumIdShards; i++ ) {
+            recursive_scoped_lock lock( idShards[i].mutex );
+            CCById& byId = idShards[i].byId;
+            if (byId.size() > 0) {
+                log() << "ERROR clientcursors exist but should not at this point" << endl;
+                ClientCursor *cc = byId.begin()->second;
+                log() << "first one: " << cc->_cursorid << ' ' << cc->_ns << endl;
+                byId.clear();
+                verify(false);
+            }
         }
     }
 
@@ -170,67 +232,73 @@ namespace mongo {
             }
         }
 
+        // ccmutex is held across the walk (before the shard mutexes, per the lock order)
+        // because deleting a cursor reenters it.
         recursive_scoped_lock cclock(ccmutex);
-        CCById::const_iterator it = clientCursorsById.begin();
-        while (it != clientCursorsById.end()) {
-            ClientCursor* cc = it->second;
-
-            // We're only interested in cursors over one db.
-            if (cc->_db != db) {
-                ++it;
-                continue;
-            }
+        for ( int shardNum = 0; shardNum < NumIdShards; shardNum++ ) {
+            recursive_scoped_lock shardLock( idShards[shardNum].mutex );
+            CCById& byId = idShards[shardNum].byId;
+            CCById::const_iterator it = byId.begin();
+            while (it != byId.end()) {
+                ClientCursor* cc = it->second;
 
-            bool shouldDelete = false;
+                // We're only interested in cursors over one db.
+                if (cc->_db != db) {
+                    ++it;
+                    continue;
+                }
 
-            // We will only delete CCs with runners that are not actively in use.  The runners that
-            // are actively in use are instead kill()-ed.
-            if (NULL != cc->_runner.get()) {
-                verify(NULL == cc->c());
+                bool shouldDelete = false;
+
+                // We will only delete CCs with runners that are not actively in use.  The runners
+                // that are actively in use are instead kill()-ed.
+                if (NULL != cc->_runner.get()) {
+                    verify(NULL == cc->c());
+
+                    if (isDB || cc->_runner->ns() == ns) {
+                        // If there is a pinValue >= 100, somebody is actively using the CC and we
+                        // do not delete it.  Instead we notify the holder that we killed it.  The
+                        // holder will then delete the CC.
+                        if (cc->_pinValue >= 100) {
+                            cc->_runner->kill();
+                        }
+                        else {
+                            // pinvalue is <100, so there is nobody actively holding the CC.  We
+                            // can safely delete it as nobody is holding the CC.
+                            shouldDelete = true;
+                        }
+                    }
+                }
+                // Begin cursor-only DEPRECATED
+                else if (cc->c()->shouldDestroyOnNSDeletion()) {
+                    verify(NULL == cc->_runner.get());
 
-                if (isDB || cc->_runner->ns() == ns) {
-                    // If there is a pinValue >= 100, somebody is actively using the CC and we do
-                    // not delete it.  Instead we notify the holder that we killed it.  The holder
-                    // will then delete the CC.
-                    if (cc->_pinValue >= 100) {
-                        cc->_runner->kill();
+                    if (isDB) {
+                        // already checked that db matched above
+                        dassert( StringData(cc->_ns).startsWith( ns ) );
+                        shouldDelete = true;
                     }
                     else {
-                        // pinvalue is <100, so there is nobody actively holding the CC.  We can
-                        // safely delete it as nobody is holding the CC.
-                        shouldDelete = true;
+                        if ( ns == cc->_ns ) {
+                            shouldDelete = true;
+                        }
                     }
                 }
-            }
-            // Begin cursor-only DEPRECATED
-            else if (cc->c()->shouldDestroyOnNSDeletion()) {
-                verify(NULL == cc->_runner.get());
-
-                if (isDB) {
-                    // already checked that db matched above
-                    dassert( StringData(cc->_ns).startsWith( ns ) );
-                    shouldDelete = true;
+                // End cursor-only DEPRECATED
+
+                if (shouldDelete) {
+                    ClientCursor* toDelete = it->second;
+                    CursorId id = toDelete->cursorid();
+                    delete toDelete;
+                    // We're not following the usual paradigm of saving it, ++it, and deleting the
+                    // saved 'it' because deleting 'it' might invalidate the next thing in the map.
+                    // TODO: Why?
+                    it = byId.upper_bound(id);
                 }
                 else {
-                    if ( ns == cc->_ns ) {
-                        shouldDelete = true;
-                    }
+                    ++it;
                 }
             }
-            // End cursor-only DEPRECATED
-
-            if (shouldDelete) {
-                ClientCursor* toDelete = it->second;
-                CursorId id = toDelete->cursorid();
-                delete toDelete;
-                // We're not following the usual paradigm of saving it, ++it, and deleting the saved
-                // 'it' because deleting 'it' might invalidate the next thing in clientCursorsById.
-                // TODO: Why?
-                it = clientCursorsById.upper_bound(id);
-            }
-            else {
-                ++it;
-            }
         }
     }
 
@@ -266,14 +334,16 @@ namespace mongo {
         //
         // We could also queue invalidations somehow and have them processed later in the runner's
         // read locks.
-        for (CCById::const_iterator it = clientCursorsById.begin(); it != clientCursorsById.end();
-             ++it) {
-
-            ClientCursor* cc = it->second;
-            // We're only interested in cursors over one db.
-            if (cc->_db != db) { continue; }
-            if (NULL == cc->_runner.get()) { continue; }
-            cc->_runner->invalidate(dl);
+        for ( int shardNum = 0; shardNum < NumIdShards; shardNum++ ) {
+            recursive_scoped_lock shardLock( idShards[shardNum].mutex );
+            CCById& byId = idShards[shardNum].byId;
+            for (CCById::const_iterator it = byId.begin(); it != byId.end(); ++it) {
+                ClientCursor* cc = it->second;
+                // We're only interested in cursors over one db.
+                if (cc->_db != db) { continue; }
+                if (NULL == cc->_runner.get()) { continue; }
+                cc->_runner->invalidate(dl);
+            }
         }
 
         // Begin cursor-only
@@ -444,50 +514,59 @@ namespace mongo {
     }
 
     void ClientCursor::idleTimeReport(unsigned millis) {
-        bool foundSomeToTimeout = false;
-
-        // two passes so that we don't need to readlock unless we really do some timeouts
-        // we assume here that incrementing _idleAgeMillis outside readlock is ok.
         {
-            recursive_scoped_lock lock(ccmutex);
-            {
-                unsigned sz = clientCursorsById.size();
-                static time_t last;
-                if( sz >= 100000 ) { 
-                    if( time(0) - last > 300 ) {
-                        last = time(0);
-                        log() << "warning number of open cursors is very large: " << sz << endl;
-                    }
-                }
-            }
-            for ( CCById::iterator i = clientCursorsById.begin(); i != clientCursorsById.end();  ) {
-                CCById::iterator j = i;
-                i++;
-                if( j->second->shouldTimeout( millis ) ) {
-                    foundSomeToTimeout = true;
+            unsigned sz = numCursors();
+            static time_t last;
+            if( sz >= 100000 ) {
+                if( time(0) - last > 300 ) {
+                    last = time(0);
+                    log() << "warning number of open cursors is very large: " << sz << endl;
                 }
             }
         }
 
-        if( foundSomeToTimeout ) {
-            Lock::GlobalRead lk;
+        // The sweep works one shard at a time so that cursor lookups on the other shards
+        // don't stall behind it, and only takes the read lock for shards that actually
+        // have cursors to time out.
+        for ( int shardNum = 0; shardNum < NumIdShards; shardNum++ ) {
+            bool foundSomeToTimeout = false;
 
-            recursive_scoped_lock cclock(ccmutex);
-            CCById::const_iterator it = clientCursorsById.begin();
-            while (it != clientCursorsById.end()) {
-                ClientCursor* cc = it->second;
-                if( cc->shouldTimeout(0) ) {
-                    numberTimedOut++;
-                    LOG(1) << "killing old cursor " << cc->_cursorid << ' ' << cc->_ns
-                           << " idle:" << cc->idleTime() << "ms\n";
-                    ClientCursor* toDelete = it->second;
-                    CursorId id = toDelete->cursorid();
-                    // This is what winds up removing it from the map.
-                    delete toDelete;
-                    it = clientCursorsById.upper_bound(id);
+            // two passes so that we don't need to readlock unless we really do some timeouts
+            // we assume here that incrementing _idleAgeMillis outside readlock is ok.
+            {
+                recursive_scoped_lock lock( idShards[shardNum].mutex );
+                CCById& byId = idShards[shardNum].byId;
+                for ( CCById::iterator i = byId.begin(); i != byId.end();  ) {
+                    CCById::iterator j = i;
+                    i++;
+                    if( j->second->shouldTimeout( millis ) ) {
+                        foundSomeToTimeout = true;
+                    }
                 }
-                else {
-                    ++it;
+            }
+
+            if( foundSomeToTimeout ) {
+                Lock::GlobalRead lk;
+
+                recursive_scoped_lock cclock(ccmutex);
+                recursive_scoped_lock shardLock( idShards[shardNum].mutex );
+                CCById& byId = idShards[shardNum].byId;
+                CCById::const_iterator it = byId.begin();
+                while (it != byId.end()) {
+                    ClientCursor* cc = it->second;
+                    if( cc->shouldTimeout(0) ) {
+                        numberTimedOut++;
+                        LOG(1) << "killing old cursor " << cc->_cursorid << ' ' << cc->_ns
+                               << " idle:" << cc->idleTime() << "ms\n";
+                        ClientCursor* toDelete = it->second;
+                        CursorId id = toDelete->cursorid();
+                        // This is what winds up removing it from the map.
+                        delete toDelete;
+                        it = byId.upper_bound(id);
+                    }
+                    else {
+                        ++it;
+                    }
                 }
             }
         }
@@ -515,17 +594,21 @@ namespace mongo {
 
     void ClientCursor::appendStats( BSONObjBuilder& result ) {
         recursive_scoped_lock lock(ccmutex);
-        result.appendNumber("totalOpen", clientCursorsById.size() );
+        result.appendNumber("totalOpen", (long long) numCursors() );
         result.appendNumber("clientCursors_size", (int) numCursors());
         result.appendNumber("timedOut" , numberTimedOut);
         unsigned pinned = 0;
         unsigned notimeout = 0;
-        for ( CCById::iterator i = clientCursorsById.begin(); i != clientCursorsById.end(); i++ ) {
-            unsigned p = i->second->_pinValue;
-            if( p >= 100 )
-                pinned++;
-            else if( p > 0 )
-                notimeout++;
+        for ( int shardNum = 0; shardNum < NumIdShards; shardNum++ ) {
+            recursive_scoped_lock shardLock( idShards[shardNum].mutex );
+            CCById& byId = idShards[shardNum].byId;
+            for ( CCById::iterator i = byId.begin(); i != byId.end(); i++ ) {
+                unsigned p = i->second->_pinValue;
+                if( p >= 100 )
+                    pinned++;
+                else if( p > 0 )
+                    notimeout++;
+            }
         }
         if( pinned ) 
             result.append("pinned", pinned);
@@ -537,15 +620,16 @@ namespace mongo {
     // ClientCursor creation/deletion/access.
     //
 
-    // Some statics used by allocCursorId_inlock().
+    // Some statics used by allocCursorId().
     namespace {
-        // so we don't have to do find() which is a little slow very often.
-        long long cursorGenTSLast = 0;
         PseudoRandom* cursorGenRandom = NULL;
     }
 
-    long long ClientCursor::allocCursorId_inlock() {
+    long long ClientCursor::allocCursorId() {
         // It is important that cursor IDs not be reused within a short period of time.
+        // The generator statics are guarded by ccmutex; uniqueness is enforced by the
+        // caller's insert into the id's shard.
+        recursive_scoped_lock lock(ccmutex);
         if (!cursorGenRandom) {
             scoped_ptr<SecureRandom> sr( SecureRandom::create() );
             cursorGenRandom = new PseudoRandom( sr->nextInt64() );
@@ -561,18 +645,17 @@ namespace mongo {
 
             if ( x < 0 ) { x *= -1; }
 
-            if ( ts != cursorGenTSLast || ClientCursor::find_inlock(x, false) == 0 )
-                break;
+            break;
         }
 
-        cursorGenTSLast = ts;
         return x;
     }
 
     // static
     ClientCursor* ClientCursor::find_inlock(CursorId id, bool warn) {
-        CCById::iterator it = clientCursorsById.find(id);
-        if ( it == clientCursorsById.end() ) {
+        CCById& byId = shardForId( id ).byId;
+        CCById::iterator it = byId.find(id);
+        if ( it == byId.end() ) {
             if ( warn ) {
                 OCCASIONALLY out() << "ClientCursor::find(): cursor not found in map '" << id
                     << "' (ok after a drop)" << endl;
@@ -583,17 +666,19 @@ namespace mongo {
     }
 
     void ClientCursor::find( const string& ns , set<CursorId>& all ) {
-        recursive_scoped_lock lock(ccmutex);
-
-        for ( CCById::iterator i=clientCursorsById.begin(); i!=clientCursorsById.end(); ++i ) {
-            if ( i->second->_ns == ns )
-                all.insert( i->first );
+        for ( int shardNum = 0; shardNum < NumIdShards; shardNum++ ) {
+            recursive_scoped_lock lock( idShards[shardNum].mutex );
+            CCById& byId = idShards[shardNum].byId;
+            for ( CCById::iterator i=byId.begin(); i!=byId.end(); ++i ) {
+                if ( i->second->_ns == ns )
+                    all.insert( i->first );
+            }
         }
     }
 
     // static
     ClientCursor* ClientCursor::find(CursorId id, bool warn) {
-        recursive_scoped_lock lock(ccmutex);
+        recursive_scoped_lock lock( shardForId( id ).mutex );
         ClientCursor *c = find_inlock(id, warn);
         // if this asserts, your code was not thread safe - you either need to set no timeout
         // for the cursor or keep a ClientCursor::Pointer in scope for it.
@@ -611,7 +696,9 @@ namespace mongo {
     }
 
     bool ClientCursor::erase(CursorId id) {
+        // ccmutex before the shard mutex: deleting the cursor reenters ccmutex.
         recursive_scoped_lock lock(ccmutex);
+        recursive_scoped_lock shardLock( shardForId( id ).mutex );
         ClientCursor* cursor = find_inlock(id);
         if (!cursor) { return false; }
         _erase_inlock(cursor);
@@ -633,7 +720,7 @@ namespace mongo {
     bool ClientCursor::eraseIfAuthorized(CursorId id) {
         NamespaceString ns;
         {
-            recursive_scoped_lock lock(ccmutex);
+            recursive_scoped_lock lock( shardForId( id ).mutex );
             ClientCursor* cursor = find_inlock(id);
             if (!cursor) {
                 audit::logKillCursorsAuthzCheck(
@@ -662,6 +749,7 @@ namespace mongo {
         // of 2 invariants: that the cursor ID won't be re-used in a short period of time, and that
         // the namespace associated with a cursor cannot change.
         recursive_scoped_lock lock(ccmutex);
+        recursive_scoped_lock shardLock( shardForId( id ).mutex );
         ClientCursor* cursor = find_inlock(id);
         if (!cursor) {
             // Cursor was deleted in another thread since we found it earlier in this function.
@@ -769,7 +857,10 @@ namespace mongo {
     bool ClientCursor::yieldSometimes(RecordNeeds need, bool* yielded) {
         if (yielded) { *yielded = false; }
 
-        if ( ! _yieldSometimesTracker.intervalHasElapsed() ) {
+        // A blocked writer can't make progress until we yield; go ahead of
+        // schedule when one is queued rather than waiting out our interval.
+        if ( ! _yieldSometimesTracker.intervalHasElapsed() &&
+             Lock::writersWaiting() == 0 ) {
             Record* rec = _recordForYield( need );
             if ( rec ) {
                 // yield for page fault
@@ -790,13 +881,23 @@ namespace mongo {
                 *yielded = true;   
             }
             bool res = yield( micros , _recordForYield( need ) );
-            if ( res ) 
+            if ( res )
                 _yieldSometimesTracker.resetLastTime();
             return res;
         }
+        // Nothing is waiting; skip the yield and don't recheck (the suggestion
+        // walks the client list) until the next interval elapses.
+        _yieldSometimesTracker.resetLastTime();
         return true;
     }
 
+    bool ClientCursor::yieldMayOccur( RecordNeeds need ) {
+        if ( _yieldSometimesTracker.nearInterval() || Lock::writersWaiting() > 0 )
+            return true;
+        // mirror the page-fault branch of yieldSometimes()
+        return _recordForYield( need ) != NULL;
+    }
+
     bool ClientCursor::prepareToYield( YieldData &data ) {
         if (!_c->supportYields()) { return false; }
 
@@ -845,7 +946,7 @@ namespace mongo {
     //
 
     ClientCursorPin::ClientCursorPin(long long cursorid) : _cursorid( INVALID_CURSOR_ID ) {
-        recursive_scoped_lock lock( ClientCursor::ccmutex );
+        recursive_scoped_lock lock( ClientCursor::shardForId( cursorid ).mutex );
         ClientCursor *cursor = ClientCursor::find_inlock( cursorid, true );
         if (NULL != cursor) {
             uassert( 12051, "clientcursor already in use? driver problem?",
@@ -32,6 +32,7 @@
 
 #include <boost/thread/recursive_mutex.hpp>
 
+#include "mongo/bson/util/atomic_int.h"
 #include "mongo/db/cc_by_loc.h"
 #include "mongo/db/cursor.h"
 #include "mongo/db/diskloc.h"
@@ -125,7 +126,7 @@ namespace mongo {
         // ClientCursor creation/deletion.
         //
 
-        static unsigned numCursors() { return clientCursorsById.size(); }
+        static unsigned numCursors() { return _numCursors; }
         static void find( const string& ns , set<CursorId>& all );
         static ClientCursor* find(CursorId id, bool warn = true);
 
@@ -170,6 +171,17 @@ namespace mongo {
             _leftoverMaxTimeMicros = leftoverMaxTimeMicros;
         }
 
+        /**
+         * Adaptive getMore batch sizing.  Call at the start of a getMore for the reply
+         * byte threshold at which to cut the batch, and noteBatchReturned() when the
+         * reply is handed back.  A consumer that issues its next getMore soon after the
+         * previous reply (streaming/ETL) gets geometrically larger batches, fewer round
+         * trips; a pause between batches resets to the normal size so interactive
+         * cursors stay snappy.
+         */
+        int nextBatchByteBudget();
+        void noteBatchReturned();
+
         //
         // Sharding-specific data.  TODO: Document.
         //
@@ -187,6 +199,17 @@ namespace mongo {
         /** Just for testing. */
         OpTime getSlaveReadTill() const { return _slaveReadTill; }
 
+        /**
+         * Oplog window serving (see OplogWindow).  A cursor marked eligible at query
+         * time may have its getMore batches answered from the in-memory oplog window;
+         * once a batch has actually been served from the window the underlying
+         * collection cursor is left behind and must not be read from again.
+         */
+        void setOplogWindowEligible() { _oplogWindowEligible = true; }
+        bool oplogWindowEligible() const { return _oplogWindowEligible; }
+        void noteOplogWindowServed() { _oplogWindowServed = true; }
+        bool oplogWindowServed() const { return _oplogWindowServed; }
+
         //
         // Query-specific functionality that may be adapted for the Runner.
         //
@@ -231,6 +254,15 @@ namespace mongo {
          * @return same as yield()
          */
         bool yieldSometimes( RecordNeeds need, bool *yielded = 0 );
+
+        /**
+         * @return true if a yieldSometimes( need ) call right now may actually yield.
+         * Lets callers holding deferred work (see DeferredIndexUpdates) apply it before
+         * the lock is released, without paying for that on every iteration.  May return
+         * true when yieldSometimes() would not in fact yield, never the reverse.
+         */
+        bool yieldMayOccur( RecordNeeds need );
+
         struct YieldData { CursorId _id; bool _doingDeletes; };
         bool prepareToYield( YieldData &data );
         static bool recoverFromYield( const YieldData &data );
@@ -275,7 +307,30 @@ namespace mongo {
         // A map from the CursorId to the ClientCursor behind it.
         // TODO: Consider making this per-connection.
         typedef map<CursorId, ClientCursor*> CCById;
-        static CCById clientCursorsById;
+
+        /**
+         * The id->cursor map is sharded by cursor id, with a mutex per shard, so that
+         * getMore lookups on different cursors don't serialize on one global mutex and
+         * the timeout sweep can walk one shard at a time.
+         *
+         * Lock order: when ccmutex is needed along with a shard mutex (any path that can
+         * delete a cursor), ccmutex is acquired first.  Single-cursor lookups (find, pin)
+         * take only the shard mutex.
+         */
+        struct IdShard {
+            boost::recursive_mutex mutex;
+            CCById byId;
+        };
+
+        enum { NumIdShards = 16 };
+        static IdShard idShards[NumIdShards];
+
+        static IdShard& shardForId( CursorId id ) {
+            return idShards[ static_cast<unsigned long long>( id ) % NumIdShards ];
+        }
+
+        // Total number of cursors across all shards.
+        static AtomicUInt _numCursors;
 
         // A list of NON-CACHED runners.  Any runner that yields must be put into this map before
         // yielding in order to be notified of invalidation and namespace deletion.  Before the
@@ -287,7 +342,8 @@ namespace mongo {
         // How many cursors have timed out?
         static long long numberTimedOut;
 
-        // This must be held when modifying any static member.
+        // This must be held when modifying any static member other than the id shards,
+        // which have their own mutexes (see IdShard above for the lock order).
         static boost::recursive_mutex& ccmutex;
 
         /**
@@ -297,14 +353,14 @@ namespace mongo {
         void init();
 
         /**
-         * Allocates a new CursorId.
-         * Called from init(...).  Assumes ccmutex held.
+         * Picks a candidate CursorId.  Called from init(...), which enforces uniqueness
+         * by inserting into the id's shard under the shard mutex.
          */
-        static CursorId allocCursorId_inlock();
+        static CursorId allocCursorId();
 
         /**
          * Find the ClientCursor with the provided ID.  Optionally warn if it's not found.
-         * Assumes ccmutex is held.
+         * Assumes the mutex of the id's shard is held.
          */
 
         static ClientCursor* find_inlock(CursorId id, bool warn = true);
@@ -345,12 +401,21 @@ namespace mongo {
         // TODO: document better.
         OpTime _slaveReadTill;
 
+        // See setOplogWindowEligible() / noteOplogWindowServed().
+        bool _oplogWindowEligible;
+        bool _oplogWindowServed;
+
         // How long has the cursor been idle?
         unsigned _idleAgeMillis;
 
         // TODO: Document.
         uint64_t _leftoverMaxTimeMicros;
 
+        // Adaptive getMore batch sizing: the current reply byte budget and when the
+        // previous batch was handed back.  See nextBatchByteBudget().
+        int _batchByteBudget;
+        uint64_t _lastBatchReturnedMicros;
+
         // For chunks that are being migrated, there is a period of time when that chunks data is in
         // two shards, the donor and the receiver one. That data is picked up by a cursor on the
         // receiver side, even before the migration was decided.  The CollectionMetadata allow one
@@ -428,6 +493,7 @@ namespace mongo {
     class ClientCursorMonitor : public BackgroundJob {
     public:
         string name() const { return "ClientCursorMonitor"; }
+        Priority priority() const { return LOW; }
         void run();
     };
         
@@ -30,6 +30,8 @@
 
 #include "mongo/pch.h"
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/base/init.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
@@ -38,15 +40,19 @@
 #include "mongo/db/commands/rename_collection.h"
 #include "mongo/db/db.h"
 #include "mongo/db/dbhelpers.h"
+#include "mongo/db/index.h"
 #include "mongo/db/index_builder.h"
+#include "mongo/db/index_update.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/sort_phase_one.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/pdfile.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/util/queue.h"
 
 namespace mongo {
 
@@ -220,12 +226,19 @@ namespace mongo {
         }
 
         if ( storedForLater.size() ) {
+            // one scan per collection feeds the sort phase of all its plain btree
+            // builds; entries stay NULL for specs taking the normal path
+            vector< shared_ptr<SortPhaseOne> > phases;
+            precalcIndexPhaseOnes( storedForLater, mayBeInterrupted, &phases );
+
+            size_t specNum = 0;
             for (list<BSONObj>::const_iterator i = storedForLater.begin();
                  i != storedForLater.end();
-                 ++i) {
+                 ++i, ++specNum) {
                 BSONObj js = *i;
                 scoped_lock precalcLock(theDataFileMgr._precalcedMutex);
                 try {
+                    theDataFileMgr.setPrecalced(phases[specNum].get());
                     theDataFileMgr.insertWithObjMod(to_collection, js);
                     theDataFileMgr.setPrecalced(NULL);
 
@@ -247,6 +260,251 @@ namespace mongo {
         }
     }
 
+    /* ---- parallel collection cloning for Cloner::go ------------------------
+       several reader threads, each with its own connection, pull collections
+       off a shared work list and batch the documents into a bounded queue; the
+       calling thread stays the only inserter (inserts serialize on the write
+       lock anyway), so the pipeline overlaps the network reads of N collections
+       with the local inserts instead of alternating them on one connection.
+    */
+    namespace {
+
+        const int kMaxCloneReaders = 4;
+        const int kMaxQueuedCloneBatches = 8;
+        const size_t kCloneBatchTargetBytes = 8 * 1024 * 1024;
+
+        struct CloneBatch {
+            CloneBatch() : readerDone(false), failed(false) { }
+            string fromCollection;
+            string toCollection;
+            vector<BSONObj> objs;    // owned
+            bool readerDone;         // final push from a reader thread; no data
+            bool failed;             // a reader hit an error; errmsg is set
+            string errmsg;
+        };
+        typedef shared_ptr<CloneBatch> CloneBatchPtr;
+
+        /** collections waiting for a reader, plus a stop flag the inserter sets
+            on error so readers quit at their next batch boundary */
+        class CloneWorkSet : boost::noncopyable {
+        public:
+            CloneWorkSet() : _mutex("CloneWorkSet"), _next(0), _stopped(false) { }
+            void add( const string& from, const string& to ) {
+                _items.push_back( make_pair( from, to ) );
+            }
+            size_t size() const { return _items.size(); }
+            bool next( pair<string,string>* out ) {
+                scoped_lock lk( _mutex );
+                if ( _stopped || _next >= _items.size() )
+                    return false;
+                *out = _items[_next++];
+                return true;
+            }
+            void stop() {
+                scoped_lock lk( _mutex );
+                _stopped = true;
+            }
+            bool stopped() const {
+                scoped_lock lk( _mutex );
+                return _stopped;
+            }
+        private:
+            mutable mongo::mutex _mutex;
+            vector< pair<string,string> > _items;
+            size_t _next;
+            bool _stopped;
+        };
+
+        class CloneReader : boost::noncopyable {
+        public:
+            CloneReader( const string& masterHost, const CloneOptions& opts,
+                         CloneWorkSet* work, BlockingQueue<CloneBatchPtr>* out )
+                : _masterHost(masterHost), _opts(opts), _work(work), _out(out) { }
+
+            void run() {
+                Client::initThread( "clone reader" );
+                try {
+                    string errmsg;
+                    ConnectionString cs = ConnectionString::parse( _masterHost, errmsg );
+                    auto_ptr<DBClientBase> conn( cs.connect( errmsg ) );
+                    if ( !conn.get() || !replAuthenticate( conn.get() ) ) {
+                        fail( "couldn't connect to " + _masterHost +
+                              " for parallel clone: " + errmsg );
+                    }
+                    else {
+                        pair<string,string> item;
+                        while ( _work->next( &item ) )
+                            cloneOne( conn.get(), item.first, item.second );
+                    }
+                }
+                catch ( DBException& e ) {
+                    fail( e.toString() );
+                }
+                catch ( std::exception& e ) {
+                    fail( e.what() );
+                }
+                CloneBatchPtr done( new CloneBatch() );
+                done->readerDone = true;
+                _out->push( done );
+                cc().shutdown();
+            }
+
+        private:
+            void cloneOne( DBClientBase* conn, const string& from, const string& to ) {
+                LOG(1) << "\t\t parallel cloning " << from << " -> " << to << endl;
+                Query q;
+                if ( _opts.snapshot )
+                    q.snapshot();
+                int options = QueryOption_NoCursorTimeout |
+                              ( _opts.slaveOk ? QueryOption_SlaveOk : 0 );
+                auto_ptr<DBClientCursor> c = conn->query( from, q, 0, 0, 0, options );
+                uassert( 17526, "parallel clone query failed on " + from, c.get() );
+
+                CloneBatchPtr batch( new CloneBatch() );
+                batch->fromCollection = from;
+                batch->toCollection = to;
+                size_t bytes = 0;
+                while ( c->more() ) {
+                    if ( _work->stopped() )
+                        return;
+                    BSONObj o = c->nextSafe().getOwned();
+                    bytes += o.objsize();
+                    batch->objs.push_back( o );
+                    if ( bytes >= kCloneBatchTargetBytes ) {
+                        _out->push( batch );
+                        batch.reset( new CloneBatch() );
+                        batch->fromCollection = from;
+                        batch->toCollection = to;
+                        bytes = 0;
+                    }
+                }
+                if ( !batch->objs.empty() )
+                    _out->push( batch );
+            }
+
+            void fail( const string& msg ) {
+                CloneBatchPtr b( new CloneBatch() );
+                b->failed = true;
+                b->errmsg = msg;
+                _out->push( b );
+            }
+
+            const string _masterHost;
+            const CloneOptions _opts;
+            CloneWorkSet* _work;
+            BlockingQueue<CloneBatchPtr>* _out;
+        };
+
+        /** clone the given (from,to) collection pairs with several reader
+            connections feeding this thread, which does all the inserts.
+            on a reader error, errmsg is set and false returned. */
+        bool parallelCloneCollections( const string& masterHost, const CloneOptions& opts,
+                                       const vector< pair<string,string> >& sources,
+                                       string& errmsg ) {
+            const int nReaders = std::min( (int)sources.size(), kMaxCloneReaders );
+            log() << "cloning " << sources.size() << " collections with "
+                  << nReaders << " reader connections" << endl;
+
+            CloneWorkSet work;
+            for ( size_t i = 0; i < sources.size(); i++ )
+                work.add( sources[i].first, sources[i].second );
+
+            // bound is a batch count; push blocks at _maxSize so allow one extra
+            BlockingQueue<CloneBatchPtr> queue( kMaxQueuedCloneBatches + 1 );
+
+            vector< shared_ptr<CloneReader> > readers;
+            vector< shared_ptr<boost::thread> > threads;
+            for ( int i = 0; i < nReaders; i++ ) {
+                shared_ptr<CloneReader> r(
+                        new CloneReader( masterHost, opts, &work, &queue ) );
+                readers.push_back( r );
+                threads.push_back( shared_ptr<boost::thread>(
+                        new boost::thread( boost::bind( &CloneReader::run, r.get() ) ) ) );
+            }
+
+            Client::Context *context = cc().getContext();
+            int readersDone = 0;
+            long long n = 0;
+            time_t lastLog = time( 0 );
+            bool ok = true;
+            try {
+                mayInterrupt( opts.mayBeInterrupted );
+                dbtempreleaseif r( opts.mayYield );
+                while ( readersDone < nReaders ) {
+                    CloneBatchPtr b = queue.blockingPop();
+                    if ( b->readerDone ) {
+                        readersDone++;
+                        continue;
+                    }
+                    if ( b->failed ) {
+                        if ( ok ) {
+                            ok = false;
+                            errmsg = b->errmsg;
+                            work.stop();
+                        }
+                        continue;
+                    }
+                    if ( !ok )
+                        continue;   // draining after an error
+
+                    mayInterrupt( opts.mayBeInterrupted );
+                    Lock::GlobalWrite lk;
+                    if ( context )
+                        context->relocked();
+                    for ( size_t j = 0; j < b->objs.size(); j++ ) {
+                        BSONObj tmp = b->objs[j];
+
+                        /* assure object is valid.  note this will slow us down a little. */
+                        if ( !tmp.valid() ) {
+                            out() << "Cloner: skipping corrupt object from "
+                                  << b->fromCollection << endl;
+                            continue;
+                        }
+
+                        try {
+                            DiskLoc loc = theDataFileMgr.insertWithObjMod(
+                                    b->toCollection.c_str(), tmp );
+                            loc.assertOk();
+                            if ( opts.logForRepl )
+                                logOp( "i", b->toCollection.c_str(), tmp );
+
+                            getDur().commitIfNeeded();
+                        }
+                        catch ( UserException& e ) {
+                            error() << "error: exception cloning object in " << b->fromCollection
+                                    << ' ' << e.what() << " obj:" << tmp.toString() << '\n';
+                            throw;
+                        }
+                        n++;
+                    }
+
+                    if ( time( 0 ) - lastLog >= 60 ) {
+                        log() << n << " objects cloned so far" << endl;
+                        lastLog = time( 0 );
+                    }
+                }
+            }
+            catch ( ... ) {
+                // stop and drain the readers before unwinding so none is left
+                // blocked pushing into the queue
+                work.stop();
+                while ( readersDone < nReaders ) {
+                    CloneBatchPtr b = queue.blockingPop();
+                    if ( b->readerDone )
+                        readersDone++;
+                }
+                for ( size_t i = 0; i < threads.size(); i++ )
+                    threads[i]->join();
+                throw;
+            }
+
+            for ( size_t i = 0; i < threads.size(); i++ )
+                threads[i]->join();
+            return ok;
+        }
+
+    }
+
     bool Cloner::validateQueryResults(const auto_ptr<DBClientCursor>& cur,
                                       int32_t* errCode,
                                       string& errmsg) {
@@ -435,11 +693,12 @@ namespace mongo {
             }
         }
 
+        // create the target collections up front (deferring the _id index
+        // builds - building them in batch afterwards is much faster) and
+        // collect the (from,to) pairs to clone
+        vector< pair<string,string> > sources;
+        vector<string> deferredIdIndexNs;
         for ( list<BSONObj>::iterator i=toClone.begin(); i != toClone.end(); i++ ) {
-            {
-                mayInterrupt( opts.mayBeInterrupted );
-                dbtempreleaseif r( opts.mayYield );
-            }
             BSONObj collection = *i;
             LOG(2) << "  really will clone: " << collection << endl;
             const char * from_name = collection["name"].valuestr();
@@ -454,29 +713,50 @@ namespace mongo {
             {
                 string err;
                 const char *toname = to_name.c_str();
-                /* we defer building id index for performance - building it in batch is much faster */
                 userCreateNS(toname, options, err, opts.logForRepl, &wantIdIndex);
             }
-            LOG(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
-            Query q;
-            if( opts.snapshot )
-                q.snapshot();
-            copy(from_name, to_name.c_str(), false, opts.logForRepl, masterSameProcess, opts.slaveOk, opts.mayYield, opts.mayBeInterrupted, q);
-
-            if( wantIdIndex ) {
-                /* we need dropDups to be true as we didn't do a true snapshot and this is before applying oplog operations
-                   that occur during the initial sync.  inDBRepair makes dropDups be true.
-                   */
-                bool old = inDBRepair;
-                try {
-                    inDBRepair = true;
-                    ensureIdIndexForNewNs(to_name.c_str());
-                    inDBRepair = old;
-                }
-                catch(...) {
-                    inDBRepair = old;
-                    throw;
+            sources.push_back( make_pair( string( from_name ), to_name ) );
+            if( wantIdIndex )
+                deferredIdIndexNs.push_back( to_name );
+        }
+
+        /* several collections in flight on separate reader connections when we
+           can authenticate new connections the way we authenticated _conn
+           (the replAuth case, i.e. initial sync); otherwise one at a time
+           through _conn.  never from self - in-process readers would deadlock
+           against the lock we hold. */
+        if ( sources.size() > 1 && !masterSameProcess && opts.useReplAuth ) {
+            if ( !parallelCloneCollections( masterHost, opts, sources, errmsg ) )
+                return false;
+        }
+        else {
+            for ( size_t i = 0; i < sources.size(); i++ ) {
+                {
+                    mayInterrupt( opts.mayBeInterrupted );
+                    dbtempreleaseif r( opts.mayYield );
                 }
+                LOG(1) << "\t\t cloning " << sources[i].first << " -> " << sources[i].second << endl;
+                Query q;
+                if( opts.snapshot )
+                    q.snapshot();
+                copy(sources[i].first.c_str(), sources[i].second.c_str(), false, opts.logForRepl,
+                     masterSameProcess, opts.slaveOk, opts.mayYield, opts.mayBeInterrupted, q);
+            }
+        }
+
+        for ( size_t i = 0; i < deferredIdIndexNs.size(); i++ ) {
+            /* we need dropDups to be true as we didn't do a true snapshot and this is before applying oplog operations
+               that occur during the initial sync.  inDBRepair makes dropDups be true.
+               */
+            bool old = inDBRepair;
+            try {
+                inDBRepair = true;
+                ensureIdIndexForNewNs(deferredIdIndexNs[i].c_str());
+                inDBRepair = old;
+            }
+            catch(...) {
+                inDBRepair = old;
+                throw;
             }
         }
 
@@ -66,11 +66,15 @@ namespace mongo {
         out->push_back(Privilege(ResourcePattern::forDatabaseName(dbname), actions));
     }
 
-    string DBHashCmd::hashCollection( const string& fullCollectionName, bool* fromCache ) {
+    string DBHashCmd::hashCollection( const string& fullCollectionName, bool background,
+                                      bool* fromCache ) {
 
         scoped_ptr<scoped_lock> cachedHashedLock;
 
-        if ( isCachable( fullCollectionName ) ) {
+        // Background mode bypasses the cache entirely: a write during one of our yields
+        // would wipe the entry we are about to store, and holding the cache mutex across
+        // yields would block the very writers we are yielding for.
+        if ( !background && isCachable( fullCollectionName ) ) {
             cachedHashedLock.reset( new scoped_lock( _cachedHashedMutex ) );
             string hash = _cachedHashed[fullCollectionName];
             if ( hash.size() > 0 ) {
@@ -81,6 +85,10 @@ namespace mongo {
 
         *fromCache = false;
         NamespaceDetails * nsd = nsdetails( fullCollectionName );
+        if ( background && !nsd ) {
+            // dropped while we yielded during an earlier collection's scan
+            return "dropped";
+        }
         verify( nsd );
 
         // debug SERVER-761
@@ -115,6 +123,15 @@ namespace mongo {
             return "no _id _index";
         }
 
+        // In background mode let the scan yield the read lock periodically (and whenever
+        // writers are queued), keeping the md5 state across yields.  The resulting hash
+        // is then not a point-in-time snapshot -- documents written during the scan may
+        // or may not be included -- which is why this is opt-in.  Capped collections are
+        // excluded: their scan has no index position to recover and deletions wrap.
+        if ( background && idNum >= 0 ) {
+            runner->setYieldPolicy( Runner::YIELD_AUTO );
+        }
+
         md5_state_t st;
         md5_init(&st);
 
@@ -143,6 +160,12 @@ namespace mongo {
     bool DBHashCmd::run(const string& dbname , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool) {
         Timer timer;
 
+        // { dbHash: 1, background: true } yields the read lock while hashing so writers
+        // are not starved for the whole scan.  The hash is then not a point-in-time
+        // snapshot; only use it when the database is known to be quiet (e.g. weekly
+        // consistency checks against a maintenance-mode secondary).
+        const bool background = cmdObj["background"].trueValue();
+
         set<string> desiredCollections;
         if ( cmdObj["collections"].type() == Array ) {
             BSONObjIterator i( cmdObj["collections"].Obj() );
@@ -183,7 +206,7 @@ namespace mongo {
                 continue;
 
             bool fromCache = false;
-            string hash = hashCollection( fullCollectionName, &fromCache );
+            string hash = hashCollection( fullCollectionName, background, &fromCache );
 
             bb.append( shortCollectionName, hash );
 
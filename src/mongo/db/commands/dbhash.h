@@ -59,7 +59,8 @@ namespace mongo {
 
         bool isCachable( const StringData& ns ) const;
 
-        string hashCollection( const string& fullCollectionName, bool* fromCache );
+        string hashCollection( const string& fullCollectionName, bool background,
+                               bool* fromCache );
 
         map<string,string> _cachedHashed;
         mutex _cachedHashedMutex;
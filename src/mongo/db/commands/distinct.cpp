@@ -36,10 +36,12 @@
 #include "mongo/db/auth/privilege.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/hasher.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/query_optimizer.h"
+#include "mongo/util/sketches.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -58,7 +60,9 @@ namespace mongo {
             out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
         }
         virtual void help( stringstream &help ) const {
-            help << "{ distinct : 'collection name' , key : 'a.b' , query : {} }";
+            help << "{ distinct : 'collection name' , key : 'a.b' , query : {} }\n"
+                "approx:true replaces the full value set with fixed-memory sketches:\n"
+                "an approximate distinct count plus the topK most frequent values";
         }
 
         bool run(const string& dbname, BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl ) {
@@ -70,6 +74,21 @@ namespace mongo {
 
             BSONObj query = getQuery( cmdObj );
 
+            // approximate mode: stream the values through sketches instead of
+            // keeping them all, so memory stays fixed at any cardinality
+            const bool approx = cmdObj["approx"].trueValue();
+            int topK = 10;
+            if ( cmdObj["topK"].isNumber() )
+                topK = cmdObj["topK"].numberInt();
+            uassert( 17554, "topK must be non-negative", topK >= 0 );
+
+            HyperLogLog hll;
+            scoped_ptr<SpaceSaving> heavy;
+            if ( approx && topK > 0 ) {
+                // track well beyond what we report so the reported counts are tight
+                heavy.reset( new SpaceSaving( std::max( 10 * topK, 100 ) ) );
+            }
+
             int bufSize = BSONObjMaxUserSize - 4096;
             BufBuilder bb( bufSize );
             char * start = bb.buf();
@@ -85,7 +104,10 @@ namespace mongo {
             NamespaceDetails * d = nsdetails( ns );
 
             if ( ! d ) {
-                result.appendArray( "values" , BSONObj() );
+                if ( approx )
+                    result.appendNumber( "approxDistinct", 0 );
+                else
+                    result.appendArray( "values" , BSONObj() );
                 result.append( "stats" , BSON( "n" << 0 << "nscanned" << 0 << "nscannedObjects" << 0 ) );
                 return true;
             }
@@ -155,6 +177,15 @@ namespace mongo {
 
                     for ( BSONElementSet::iterator i=temp.begin(); i!=temp.end(); ++i ) {
                         BSONElement e = *i;
+
+                        if ( approx ) {
+                            long long h = BSONElementHasher::hash64( e, 0 );
+                            hll.addHash( (unsigned long long)h );
+                            if ( heavy )
+                                heavy->add( (unsigned long long)h, e.wrap() );
+                            continue;
+                        }
+
                         if ( values.count( e ) )
                             continue;
 
@@ -184,7 +215,28 @@ namespace mongo {
 
             verify( start == bb.buf() );
 
-            result.appendArray( "values" , arr.done() );
+            if ( approx ) {
+                result.appendNumber( "approxDistinct", hll.estimate() );
+                result.append( "standardError", hll.standardError() );
+                if ( heavy ) {
+                    // counts are per matching document; each may overstate the
+                    // true count by at most its maxOverestimate
+                    std::vector<SpaceSaving::Entry> top;
+                    heavy->entries( &top );
+                    BSONArrayBuilder t( result.subarrayStart( "top" ) );
+                    for ( size_t i = 0; i < top.size() && i < (size_t)topK; i++ ) {
+                        BSONObjBuilder eb( t.subobjStart() );
+                        eb.appendAs( top[i].value.firstElement(), "value" );
+                        eb.appendNumber( "count", top[i].count );
+                        eb.appendNumber( "maxOverestimate", top[i].maxError );
+                        eb.done();
+                    }
+                    t.done();
+                }
+            }
+            else {
+                result.appendArray( "values" , arr.done() );
+            }
 
             {
                 BSONObjBuilder b;
@@ -19,6 +19,7 @@
 
 #include "mongo/pch.h"
 
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -37,7 +38,9 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/namespace_details.h"
+#include "mongo/platform/random.h"
 #include "mongo/util/descriptive_stats.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -47,6 +50,11 @@ namespace mongo {
     struct IndexStatsParams {
         string indexName;
         vector<int> expandNodes;
+        // fraction of leaf buckets to inspect, (0, 1]; leaves are chosen at random and
+        // the output gains a "sampling" section with confidence intervals
+        double sample;
+
+        IndexStatsParams() : sample(1.0) {}
     };
 
     /**
@@ -143,7 +151,14 @@ namespace mongo {
         vector<AreaStats> perLevel;
         vector<vector<AreaStats> > branch;
 
-        BtreeStats() : bucketBodyBytes(0), depth(0) {
+        // leaf sampling bookkeeping; sampleRate == 1 means the whole tree was walked
+        double sampleRate;
+        unsigned int leafDepth;
+        long long sampledLeafBuckets;
+        long long skippedLeafBuckets;
+
+        BtreeStats() : bucketBodyBytes(0), depth(0), sampleRate(1.0), leafDepth(0),
+                       sampledLeafBuckets(0), skippedLeafBuckets(0) {
             branch.push_back(vector<AreaStats>(1));
         }
 
@@ -190,6 +205,38 @@ namespace mongo {
                 }
                 expandedNodesArrayBuilder.doneFast();
             }
+
+            if (sampleRate < 1) {
+                // Every leaf was either inspected or counted as skipped off its parent's
+                // child pointers, so the total is exact even though the stats are sampled.
+                const long long totalLeafBuckets = sampledLeafBuckets + skippedLeafBuckets;
+
+                BSONObjBuilder samplingBuilder(builder.subobjStart("sampling"));
+                samplingBuilder.append("sample", sampleRate);
+                samplingBuilder.append("sampledLeafBuckets", sampledLeafBuckets);
+                samplingBuilder.append("totalLeafBuckets", totalLeafBuckets);
+
+                if (leafDepth < perLevel.size() &&
+                    perLevel[leafDepth].fillRatio.count() > 1) {
+                    // normal-approximation 95% interval for the mean leaf fill ratio,
+                    // with the finite population correction since leaves are sampled
+                    // without replacement
+                    const SummaryEstimators<double, AreaStats::quantiles>& fill =
+                            perLevel[leafDepth].fillRatio;
+                    double halfWidth = 1.96 * fill.stddev() /
+                            std::sqrt(static_cast<double>(fill.count()));
+                    if (totalLeafBuckets > 1) {
+                        halfWidth *= std::sqrt(
+                                static_cast<double>(totalLeafBuckets - sampledLeafBuckets) /
+                                (totalLeafBuckets - 1));
+                    }
+                    samplingBuilder.append("leafFillRatio", fill.mean());
+                    samplingBuilder.append("leafFillRatioCi95",
+                                           BSON_ARRAY(fill.mean() - halfWidth
+                                                      << fill.mean() + halfWidth));
+                }
+                samplingBuilder.doneFast();
+            }
         }
     };
 
@@ -215,11 +262,35 @@ namespace mongo {
         typedef typename mongo::BucketBasics<Version>::KeyNode KeyNode;
         typedef typename mongo::BucketBasics<Version>::Key Key;
 
-        BtreeInspectorImpl(vector<int> expandNodes) : _expandNodes(expandNodes) {
+        BtreeInspectorImpl(vector<int> expandNodes, double sample)
+            : _expandNodes(expandNodes),
+              _sampleThreshold(static_cast<int>(sample * 10000 + 0.5)),
+              _prng(static_cast<int64_t>(curTimeMicros64())),
+              _leafDepth(0) {
+            _stats.sampleRate = sample;
         }
 
         virtual bool inspect(const DiskLoc& head)  {
             _stats.bucketBodyBytes = BucketBasics::bodySize();
+
+            // All leaves sit at the same depth; find it off the leftmost path so the walk
+            // below can tell, before loading a child, whether it is a leaf the sample may
+            // skip.
+            DiskLoc dl = head;
+            while (!dl.isNull()) {
+                const BtreeBucket<Version>* bucket = dl.btree<Version>();
+                DiskLoc child = bucket->getN() > 0 ? bucket->k(0).prevChildBucket
+                                                   : bucket->getNextChild();
+                if (child.isNull()) break;
+                _leafDepth++;
+                dl = child;
+            }
+            _stats.leafDepth = _leafDepth;
+            if (0 == _leafDepth) {
+                // the root is the only (leaf) bucket; it is never skipped
+                _stats.sampledLeafBuckets++;
+            }
+
             vector<int> expandedAncestors;
             return this->inspectBucket(head, 0, 0, true, expandedAncestors);
         }
@@ -286,12 +357,12 @@ namespace mongo {
                     }
                     lastKeyNode = &kn;
 
-                    this->inspectBucket(kn.prevChildBucket, depth + 1, i, curNodeIsExpanded,
-                                        expandedAncestors);
+                    this->maybeInspectChild(kn.prevChildBucket, depth + 1, i, curNodeIsExpanded,
+                                            expandedAncestors);
                 }
             }
-            this->inspectBucket(bucket->getNextChild(), depth + 1, keyCount, curNodeIsExpanded,
-                                expandedAncestors);
+            this->maybeInspectChild(bucket->getNextChild(), depth + 1, keyCount,
+                                    curNodeIsExpanded, expandedAncestors);
 
             killCurrentOp.checkForInterrupt();
 
@@ -338,9 +409,33 @@ namespace mongo {
             level.addStats(keyCount, usedKeyCount, bucket, sizeof(_KeyNode));
 
             return true;
-        } 
+        }
+
+        /**
+         * Recurse into a child bucket, except that leaf children may be skipped when
+         * sampling: each leaf is inspected with probability sample.  Skipped leaves are
+         * still counted off the parent's child pointers, so leaf totals stay exact.
+         * Expanded subtrees are always walked in full.
+         */
+        bool maybeInspectChild(const DiskLoc& dl, unsigned int depth, int childNum,
+                               bool parentIsExpanded, const vector<int>& expandedAncestors) {
+            if (dl.isNull()) return true;
+            if (depth == _leafDepth) {
+                if (_sampleThreshold < 10000 && !parentIsExpanded &&
+                    (_prng.nextInt32() & 0x7fffffff) % 10000 >= _sampleThreshold) {
+                    _stats.skippedLeafBuckets++;
+                    return true;
+                }
+                _stats.sampledLeafBuckets++;
+            }
+            return this->inspectBucket(dl, depth, childNum, parentIsExpanded,
+                                       expandedAncestors);
+        }
 
         vector<int> _expandNodes;
+        int _sampleThreshold; // inspect a leaf when nextInt32(10000) falls below this
+        PseudoRandom _prng;
+        unsigned int _leafDepth;
         BtreeStats _stats;
     };
 
@@ -379,8 +474,8 @@ namespace mongo {
 
         scoped_ptr<BtreeInspector> inspector(NULL);
         switch (details->version()) {
-          case 1: inspector.reset(new BtreeInspectorV1(params.expandNodes)); break;
-          case 0: inspector.reset(new BtreeInspectorV0(params.expandNodes)); break;
+          case 1: inspector.reset(new BtreeInspectorV1(params.expandNodes, params.sample)); break;
+          case 0: inspector.reset(new BtreeInspectorV0(params.expandNodes, params.sample)); break;
           default:
             errmsg = str::stream() << "index version " << details->version() << " is "
                                    << "not supported";
@@ -482,7 +577,8 @@ namespace mongo {
               << "of the nodes to be expanded, {expandNodes: [...]}. "
               << "For example, {indexStats: 'collection', index: '_id', expandNodes: [0, 4]} "
               << "aggregates statistics for the _id index for 'collection' and expands root "
-              << "and the fifth child of root.";
+              << "and the fifth child of root. {sample: fraction} inspects only that fraction "
+              << "of leaf buckets, chosen at random, and reports confidence intervals.";
         }
 
         virtual LockType locktype() const { return READ; }
@@ -534,6 +630,17 @@ namespace mongo {
                 }
             }
 
+            // { sample: fraction }
+            BSONElement sampleElm = cmdObj["sample"];
+            if (sampleElm.ok()) {
+                if (!sampleElm.isNumber() || sampleElm.numberDouble() <= 0 ||
+                    sampleElm.numberDouble() > 1) {
+                    errmsg = "sample must be a number in (0, 1]";
+                    return false;
+                }
+                params.sample = sampleElm.numberDouble();
+            }
+
             BSONObjBuilder resultBuilder;
             if (!runInternal(nsd, params, errmsg, resultBuilder))
                 return false;
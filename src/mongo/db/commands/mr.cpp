@@ -466,6 +466,11 @@ namespace mongo {
 
             if (_config.outputOptions.outNonAtomic)
                 return postProcessCollectionNonAtomic(op, pm);
+            if (_config.outputOptions.outType == Config::REPLACE) {
+                // the rename swap is atomic to readers on its own; no need to
+                // stall every other operation while it happens
+                return postProcessCollectionNonAtomic(op, pm);
+            }
             Lock::GlobalWrite lock; // TODO(erh): this is how it was, but seems it doesn't need to be global
             return postProcessCollectionNonAtomic(op, pm);
         }
@@ -495,6 +500,12 @@ namespace mongo {
         // End SERVER-6116
         //
 
+        // documents copied from the temp collection per write lock acquisition
+        // in the merge/reduce output phases.  one document per lock thrashes
+        // the lock manager; one lock for the whole copy blocks foreground
+        // writes for the length of the output.
+        static const int outputBatchSize = 100;
+
         long long State::postProcessCollectionNonAtomic(CurOp* op, ProgressMeterHolder& pm) {
 
             if ( _config.outputOptions.finalNamespace == _config.tempNamespace )
@@ -502,19 +513,21 @@ namespace mongo {
 
             if (_config.outputOptions.outType == Config::REPLACE ||
                     _safeCount(_db, _config.outputOptions.finalNamespace) == 0) {
-                Lock::GlobalWrite lock; // TODO(erh): why global???
-                // replace: just rename from temp to final collection name, dropping previous collection
-                _db.dropCollection( _config.outputOptions.finalNamespace );
+                // replace: a single rename swaps the fully built temp collection
+                // in and drops the previous output inside the rename command's
+                // own (brief) lock; readers see the old output right up to the
+                // swap and the new one after, never an empty window
                 BSONObj info;
 
                 if ( ! _db.runCommand( "admin"
                                       , BSON( "renameCollection" << _config.tempNamespace <<
                                               "to" << _config.outputOptions.finalNamespace <<
+                                              "dropTarget" << true <<
                                               "stayTemp" << _config.shardedFirstPass )
                                       , info ) ) {
                     uasserted( 10076 ,  str::stream() << "rename failed: " << info );
                 }
-                         
+
                 _db.dropCollection( _config.tempNamespace );
             }
             else if ( _config.outputOptions.outType == Config::MERGE ) {
@@ -525,10 +538,12 @@ namespace mongo {
                 auto_ptr<DBClientCursor> cursor = _db.query( _config.tempNamespace , BSONObj() );
                 while ( cursor->more() ) {
                     Lock::DBWrite lock( _config.outputOptions.finalNamespace );
-                    BSONObj o = cursor->nextSafe();
-                    Helpers::upsert( _config.outputOptions.finalNamespace , o );
+                    for ( int i = 0; i < outputBatchSize && cursor->more(); i++ ) {
+                        BSONObj o = cursor->nextSafe();
+                        Helpers::upsert( _config.outputOptions.finalNamespace , o );
+                        pm.hit();
+                    }
                     getDur().commitIfNeeded();
-                    pm.hit();
                 }
                 _db.dropCollection( _config.tempNamespace );
                 pm.finished();
@@ -542,33 +557,37 @@ namespace mongo {
                                _safeCount(_db, _config.tempNamespace, BSONObj()));
                 auto_ptr<DBClientCursor> cursor = _db.query( _config.tempNamespace , BSONObj() );
                 while ( cursor->more() ) {
-                    Lock::GlobalWrite lock; // TODO(erh) why global?
-                    BSONObj temp = cursor->nextSafe();
-                    BSONObj old;
-
-                    bool found;
-                    {
-                        Client::Context tx( _config.outputOptions.finalNamespace );
-                        found = Helpers::findOne(_config.outputOptions.finalNamespace.c_str(),
-                                                 temp["_id"].wrap(),
-                                                 old,
-                                                 true);
-                    }
+                    // the output collection's write lock suffices here, as in
+                    // the merge case above
+                    Lock::DBWrite lock( _config.outputOptions.finalNamespace );
+                    for ( int i = 0; i < outputBatchSize && cursor->more(); i++ ) {
+                        BSONObj temp = cursor->nextSafe();
+                        BSONObj old;
+
+                        bool found;
+                        {
+                            Client::Context tx( _config.outputOptions.finalNamespace );
+                            found = Helpers::findOne(_config.outputOptions.finalNamespace.c_str(),
+                                                     temp["_id"].wrap(),
+                                                     old,
+                                                     true);
+                        }
 
-                    if ( found ) {
-                        // need to reduce
-                        values.clear();
-                        values.push_back( temp );
-                        values.push_back( old );
-                        Helpers::upsert(_config.outputOptions.finalNamespace,
-                                        _config.reducer->finalReduce(values,
-                                                                     _config.finalizer.get()));
-                    }
-                    else {
-                        Helpers::upsert( _config.outputOptions.finalNamespace , temp );
+                        if ( found ) {
+                            // need to reduce
+                            values.clear();
+                            values.push_back( temp );
+                            values.push_back( old );
+                            Helpers::upsert(_config.outputOptions.finalNamespace,
+                                            _config.reducer->finalReduce(values,
+                                                                         _config.finalizer.get()));
+                        }
+                        else {
+                            Helpers::upsert( _config.outputOptions.finalNamespace , temp );
+                        }
+                        pm.hit();
                     }
                     getDur().commitIfNeeded();
-                    pm.hit();
                 }
                 pm.finished();
             }
@@ -1447,21 +1466,30 @@ namespace mongo {
                 BSONObj query;
                 BSONArrayBuilder chunkSizes;
                 while (true) {
-                    ChunkPtr chunk;
+                    // Coalesce a run of contiguous chunks owned by this shard into a single
+                    // range, so each run costs one sorted query per source shard instead of
+                    // one per chunk. The chunk map iterates in range order, so owned chunks
+                    // that abut are adjacent in 'chunks'.
+                    unsigned int runEnd = index;
                     if (chunks.size() > 0) {
-                        chunk = chunks[index];
+                        runEnd = index + 1;
+                        while (runEnd < chunks.size() &&
+                               chunks[runEnd]->getMin().woCompare(
+                                       chunks[runEnd - 1]->getMax()) == 0) {
+                            runEnd++;
+                        }
                         BSONObjBuilder b;
-                        b.appendAs(chunk->getMin().firstElement(), "$gte");
-                        b.appendAs(chunk->getMax().firstElement(), "$lt");
+                        b.appendAs(chunks[index]->getMin().firstElement(), "$gte");
+                        b.appendAs(chunks[runEnd - 1]->getMax().firstElement(), "$lt");
                         query = BSON("_id" << b.obj());
-//                        chunkSizes.append(min);
                     }
 
-                    // reduce from each shard for a chunk
+                    // reduce from each shard for a run of chunks
                     BSONObj sortKey = BSON( "_id" << 1 );
                     ParallelSortClusteredCursor cursor(servers, inputNS,
                             Query(query).sort(sortKey), QueryOption_NoCursorTimeout);
                     cursor.init();
+                    unsigned int chunkIndex = index;
                     int chunkSize = 0;
 
                     while ( cursor.more() || !values.empty() ) {
@@ -1482,7 +1510,20 @@ namespace mongo {
                         }
 
                         BSONObj res = config.reducer->finalReduce( values , config.finalizer.get());
+
+                        // results arrive in key order, so once a key reaches a chunk's max the
+                        // size of that chunk is final and we move on to the next in the run
+                        while (chunkIndex + 1 < runEnd &&
+                               res["_id"].woCompare(
+                                       chunks[chunkIndex]->getMax().firstElement(),
+                                       false) >= 0) {
+                            chunkSizes.append(chunks[chunkIndex]->getMin());
+                            chunkSizes.append(chunkSize);
+                            chunkSize = 0;
+                            chunkIndex++;
+                        }
                         chunkSize += res.objsize();
+
                         if (state.isOnDisk())
                             state.insert( config.tempNamespace , res );
                         else
@@ -1492,11 +1533,15 @@ namespace mongo {
                             values.push_back( t );
                     }
 
-                    if (chunk) {
-                        chunkSizes.append(chunk->getMin());
+                    // flush the last chunk of the run, plus any that received no results
+                    for ( ; chunkIndex < runEnd; chunkIndex++) {
+                        chunkSizes.append(chunks[chunkIndex]->getMin());
                         chunkSizes.append(chunkSize);
+                        chunkSize = 0;
                     }
-                    if (++index >= chunks.size())
+
+                    index = runEnd;
+                    if (index >= chunks.size())
                         break;
                 }
 
@@ -0,0 +1,196 @@
+// parallel_collection_scan.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/clientcursor.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/database.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/runner.h"
+#include "mongo/db/query/type_explain.h"
+#include "mongo/db/structure/collection.h"
+#include "mongo/db/structure/collection_iterator.h"
+
+namespace mongo {
+
+    /**
+     * A Runner that simply drains one CollectionIterator, used to hang a cursor off each
+     * partition of a parallel collection scan.  Does not interact with the plan cache or
+     * the query planner at all.
+     */
+    class MultiIteratorRunner : public Runner {
+    public:
+        /** Takes ownership of 'iter'. */
+        MultiIteratorRunner(const string& ns, CollectionIterator* iter)
+            : _ns(ns), _iter(iter), _killed(false) {
+        }
+
+        virtual ~MultiIteratorRunner() { }
+
+        virtual RunnerState getNext(BSONObj* objOut, DiskLoc* dlOut) {
+            if (_killed) { return RUNNER_DEAD; }
+            if (_iter->isEOF()) { return RUNNER_EOF; }
+
+            DiskLoc loc = _iter->getNext();
+            if (NULL != objOut) { *objOut = loc.obj(); }
+            if (NULL != dlOut) { *dlOut = loc; }
+            return RUNNER_ADVANCED;
+        }
+
+        virtual bool isEOF() {
+            return _killed || _iter->isEOF();
+        }
+
+        virtual void invalidate(const DiskLoc& dl) {
+            if (_killed) { return; }
+            _iter->invalidate(dl);
+        }
+
+        virtual void kill() {
+            _killed = true;
+        }
+
+        virtual void saveState() {
+            if (!_killed) {
+                _iter->prepareToYield();
+            }
+        }
+
+        virtual bool restoreState() {
+            if (!_killed && !_iter->recoverFromYield()) {
+                _killed = true;
+            }
+            return !_killed;
+        }
+
+        virtual void setYieldPolicy(YieldPolicy policy) {
+            // We're always manually yielded by the getMore machinery.
+        }
+
+        virtual const string& ns() {
+            return _ns;
+        }
+
+        virtual Status getExplainPlan(TypeExplain** explain) const {
+            *explain = new TypeExplain;
+            (*explain)->setCursor("MultiIteratorRunner");
+            return Status::OK();
+        }
+
+    private:
+        string _ns;
+        boost::scoped_ptr<CollectionIterator> _iter;
+        bool _killed;
+    };
+
+    /**
+     * { parallelCollectionScan: "coll", numCursors: 4 }
+     *
+     * Partitions the collection by extent into (up to) numCursors ranges and returns a
+     * cursor over each, so clients can drive concurrent scan streams over disjoint parts
+     * of the collection.
+     */
+    class ParallelCollectionScanCmd : public Command {
+    public:
+        ParallelCollectionScanCmd() : Command( "parallelCollectionScan" ) {}
+
+        virtual bool slaveOk() const { return true; }
+        virtual LockType locktype() const { return READ; }
+
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::find);
+            out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+        }
+
+        virtual void help( stringstream &help ) const {
+            help << "{ parallelCollectionScan : 'collection name' , numCursors : n }";
+        }
+
+        bool run(const string& dbname, BSONObj& cmdObj, int, string& errmsg,
+                 BSONObjBuilder& result, bool fromRepl ) {
+
+            string ns = parseNs( dbname, cmdObj );
+
+            Collection* collection = cc().database()->getCollection( ns );
+            if ( !collection ) {
+                errmsg = "ns does not exist: " + ns;
+                return false;
+            }
+
+            int numCursors = cmdObj["numCursors"].numberInt();
+            if ( numCursors <= 0 || numCursors > 10000 ) {
+                errmsg = "numCursors has to be between 1 and 10000";
+                return false;
+            }
+
+            vector<CollectionIterator*> iterators;
+            // Takes ownership below; each iterator ends up inside exactly one runner.
+            collection->getManyIterators( numCursors, &iterators );
+
+            BSONArrayBuilder bucketsBuilder;
+            for ( size_t i = 0; i < iterators.size(); i++ ) {
+                auto_ptr<MultiIteratorRunner> runner(
+                        new MultiIteratorRunner( ns, iterators[i] ) );
+
+                // We won't use the runner until it's getMore'd.
+                runner->saveState();
+
+                // ClientCursor inserts itself into a global map by its ctor, and takes
+                // ownership of the runner.
+                ClientCursor* cursor = new ClientCursor( runner.release() );
+
+                BSONObjBuilder threadResult;
+                {
+                    BSONObjBuilder cursorBuilder( threadResult.subobjStart( "cursor" ) );
+                    cursorBuilder.append( "firstBatch", BSONArray() );
+                    cursorBuilder.append( "ns", ns );
+                    cursorBuilder.append( "id", cursor->cursorid() );
+                    cursorBuilder.done();
+                }
+                threadResult.append( "ok", 1 );
+                bucketsBuilder.append( threadResult.obj() );
+            }
+            result.appendArray( "cursors", bucketsBuilder.obj() );
+
+            return true;
+        }
+    } parallelCollectionScanCmd;
+
+}  // namespace mongo
@@ -35,6 +35,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/util/coarse_ticker.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -236,6 +237,12 @@ namespace mongo {
                                                     &serverGlobalParams.quiet,
                                                     true,
                                                     true );
+
+        ExportedServerParameter<int> CoarseClockIntervalSetting( ServerParameterSet::getGlobal(),
+                                                                 "coarseClockIntervalMicros",
+                                                                 &coarseClockIntervalMicros,
+                                                                 true,
+                                                                 true );
     }
 
 }
@@ -0,0 +1,97 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/pch.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/query/query_shape_stats.h"
+
+namespace mongo {
+
+    /**
+     * { queryShapeStats: <collection> }
+     *
+     * Dumps the per-query-shape planning statistics accumulated for the collection, hottest
+     * shape first.  See QueryShapeStats.
+     */
+    class QueryShapeStatsCmd : public Command {
+    public:
+        QueryShapeStatsCmd() : Command("queryShapeStats") { }
+
+        virtual bool slaveOk() const { return true; }
+        virtual LockType locktype() const { return NONE; }
+
+        virtual void help( stringstream& help ) const {
+            help << "{ queryShapeStats: <collection> }\n"
+                "show per-query-shape planning statistics for the collection: plan trials,\n"
+                "winning plans and works/returned ratios from cached runs.  a shape whose\n"
+                "ratio climbs over time is a plan going stale as the data distribution\n"
+                "shifts.  statistics are in-memory and reset on restart.";
+        }
+
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::queryShapeStats);
+            out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+        }
+
+        virtual bool run(const string& dbname,
+                         BSONObj& cmdObj,
+                         int,
+                         string& errmsg,
+                         BSONObjBuilder& result,
+                         bool fromRepl) {
+            string coll = cmdObj.firstElement().valuestr();
+            if ( coll.empty() ) {
+                errmsg = "no collection name specified";
+                return false;
+            }
+
+            string ns = dbname + '.' + coll;
+            if ( ! NamespaceString::normal(ns.c_str()) ) {
+                errmsg = "bad namespace name";
+                return false;
+            }
+
+            result.append( "ns", ns );
+            QueryShapeStats::get(ns)->appendStats(&result);
+            return true;
+        }
+    };
+    static QueryShapeStatsCmd queryShapeStatsCmd;
+
+}  // namespace mongo
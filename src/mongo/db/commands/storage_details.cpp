@@ -15,6 +15,7 @@
 
 #include "mongo/pch.h"
 
+#include <cmath>
 #include <ctime>
 #include <string>
 
@@ -22,13 +23,17 @@
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/privilege.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/db.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/namespace_details.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/descriptive_stats.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -59,10 +64,14 @@ namespace {
         bool processDeletedRecords;
         bool showRecords;
         time_t startTime;
+        // fraction of extents to analyze in full-namespace mode, (0, 1]; extents are
+        // chosen by reservoir sampling and the output gains confidence intervals
+        double sample;
 
         AnalyzeParams() : startOfs(0), endOfs(INT_MAX), length(INT_MAX), numberOfSlices(0),
                           granularity(0), lastSliceLength(0), characteristicField("_id"),
-                          processDeletedRecords(true), showRecords(false), startTime(time(NULL)) {
+                          processDeletedRecords(true), showRecords(false), startTime(time(NULL)),
+                          sample(1.0) {
         }
     };
 
@@ -304,11 +313,14 @@ namespace {
               << "{characteristicField: dotted_path} enables collection of a field to make "
               << "it possible to identify which kind of record belong to each slice/extent. "
               << "{showRecords: true} enables a dump of all records and deleted records "
-              << "encountered. Example: "
+              << "encountered. {sample: fraction} analyzes only that fraction of extents, "
+              << "chosen at random, and reports confidence intervals. Example: "
               << "{storageDetails: 'collectionName', analyze: 'diskStorage', granularity: 1 << 20}";
         }
 
-        virtual LockType locktype() const { return READ; }
+        // Takes its own read lock per analyzed extent (see analyzeNamespace) so long
+        // analyses don't starve writers.
+        virtual LockType locktype() const { return NONE; }
 
         virtual void addRequiredPrivileges(const std::string& dbname,
                                            const BSONObj& cmdObj,
@@ -524,7 +536,8 @@ namespace {
      */
     bool analyzeDiskStorage(const NamespaceDetails* nsd, const Extent* ex,
                                                const AnalyzeParams& params, string& errmsg,
-                                               BSONObjBuilder& result) {
+                                               BSONObjBuilder& result,
+                                               double* usedRatioOut = NULL) {
         bool isCapped = nsd->isCapped();
 
         result.append("extentHeaderBytes", Extent::HeaderSize());
@@ -595,8 +608,14 @@ namespace {
             sliceArrayBuilder.doneFast();
             extentData.appendToBSONObjBuilder(result, processingDeletedRecords);
         } else {
+            extentData += sliceData[0];
             sliceData[0].appendToBSONObjBuilder(result, processingDeletedRecords);
         }
+        if (usedRatioOut != NULL) {
+            *usedRatioOut = extentData.onDiskBytes > 0
+                ? static_cast<double>(extentData.recBytes) / extentData.onDiskBytes
+                : 0;
+        }
         return true;
     }
 
@@ -618,7 +637,7 @@ namespace {
      * @return true on success, false on failure (partial output may still be present)
      */
     bool analyzePagesInRAM(const Extent* ex, const AnalyzeParams& params, string& errmsg,
-                           BSONObjBuilder& result) {
+                           BSONObjBuilder& result, double* inMemOut = NULL) {
 
         verify(sizeof(char) == 1);
         int pageBytes = static_cast<int>(ProcessInfo::getPageSize());
@@ -667,6 +686,9 @@ namespace {
         }
 
         result.append("inMem", static_cast<double>(extentInMemCount) / extentPages);
+        if (inMemOut != NULL) {
+            *inMemOut = static_cast<double>(extentInMemCount) / extentPages;
+        }
 
         return true;
     }
@@ -677,7 +699,8 @@ namespace {
      *               granularity
      */
     bool analyzeExtent(const NamespaceDetails* nsd, const Extent* ex, SubCommand subCommand,
-                       AnalyzeParams& params, string& errmsg, BSONObjBuilder& outputBuilder) {
+                       AnalyzeParams& params, string& errmsg, BSONObjBuilder& outputBuilder,
+                       double* headlineOut = NULL) {
 
         params.startOfs = max(0, params.startOfs);
         params.endOfs = min(params.endOfs, ex->length);
@@ -697,56 +720,149 @@ namespace {
                 (params.granularity * (params.numberOfSlices - 1));
         switch (subCommand) {
             case SUBCMD_DISK_STORAGE:
-                return analyzeDiskStorage(nsd, ex, params, errmsg, outputBuilder);
+                return analyzeDiskStorage(nsd, ex, params, errmsg, outputBuilder, headlineOut);
             case SUBCMD_PAGES_IN_RAM:
-                return analyzePagesInRAM(ex, params, errmsg, outputBuilder);
+                return analyzePagesInRAM(ex, params, errmsg, outputBuilder, headlineOut);
         }
         verify(false && "unreachable");
     }
 
     /**
-     * @param ex requested extent; if NULL analyze entire namespace
-     */ 
+     * Analyzes the requested extent under the caller's read lock.
+     */
     bool runInternal(const NamespaceDetails* nsd, const Extent* ex, SubCommand subCommand,
                      AnalyzeParams& globalParams, string& errmsg, BSONObjBuilder& result) {
 
         BSONObjBuilder outputBuilder; // temporary builder to avoid output corruption in case of
                                       // failure
-        bool success = false;
-        if (ex != NULL) {
-            success = analyzeExtent(nsd, ex, subCommand, globalParams, errmsg, outputBuilder);
-        }
-        else {
-            const DiskLoc dl = nsd->firstExtent();
-            if (dl.isNull()) {
+        bool success = analyzeExtent(nsd, ex, subCommand, globalParams, errmsg, outputBuilder);
+        if (!success) return false;
+        result.appendElements(outputBuilder.obj());
+        return true;
+    }
+
+    /**
+     * Analyzes every extent of the namespace, or a reservoir-sampled subset of them when
+     * globalParams.sample < 1.  Each extent is analyzed under its own read lock and the
+     * namespace is re-resolved after every relock, so a long analysis never pins the lock
+     * for more than one extent's worth of work.  When sampling, the output gains a
+     * "sampling" section with the analyzed/total extent counts and a 95% confidence
+     * interval for the mean per-extent headline ratio (record bytes per disk byte for
+     * diskStorage, resident page ratio for pagesInRAM).
+     */
+    bool analyzeNamespace(const string& ns, SubCommand subCommand, AnalyzeParams& globalParams,
+                          string& errmsg, BSONObjBuilder& result) {
+
+        int totalExtents = 0;
+        {
+            Client::ReadContext ctx(ns);
+            const NamespaceDetails* nsd = nsdetails(ns);
+            if (!nsd) {
+                errmsg = "ns not found";
+                return false;
+            }
+            if (nsd->firstExtent().isNull()) {
                 errmsg = "no extents in namespace";
                 return false;
             }
 
-            long long storageSize = nsd->storageSize(NULL, NULL);
+            for (Extent* e = nsd->firstExtent().ext(); e != NULL; e = e->getNextExtent()) {
+                totalExtents++;
+            }
 
             if (globalParams.numberOfSlices != 0) {
-                globalParams.granularity = ceilingDiv(storageSize, globalParams.numberOfSlices);
+                globalParams.granularity = ceilingDiv(nsd->storageSize(NULL, NULL),
+                                                      globalParams.numberOfSlices);
+            }
+        }
+
+        // Decide which extents to analyze: all of them, or ceil(sample * totalExtents)
+        // chosen by reservoir sampling (algorithm R) so every extent is equally likely.
+        vector<bool> chosen(totalExtents, true);
+        int analyzedExtents = totalExtents;
+        if (globalParams.sample < 1.0) {
+            analyzedExtents = max(1, static_cast<int>(globalParams.sample * totalExtents + 0.5));
+            vector<int> reservoir(analyzedExtents);
+            PseudoRandom prng(static_cast<int64_t>(curTimeMicros64()));
+            for (int i = 0; i < totalExtents; i++) {
+                if (i < analyzedExtents) {
+                    reservoir[i] = i;
+                }
+                else {
+                    // mask the sign bit: nextInt32(max) may return negative values
+                    int j = (prng.nextInt32() & 0x7fffffff) % (i + 1);
+                    if (j < analyzedExtents) {
+                        reservoir[j] = i;
+                    }
+                }
             }
+            chosen.assign(totalExtents, false);
+            for (int i = 0; i < analyzedExtents; i++) {
+                chosen[reservoir[i]] = true;
+            }
+        }
 
-            BSONArrayBuilder extentsArrayBuilder(outputBuilder.subarrayStart("extents"));
-            for (Extent* curExtent = dl.ext();
-                 curExtent != NULL;
-                 curExtent = curExtent->getNextExtent()) {
+        BSONObjBuilder outputBuilder; // temporary builder to avoid output corruption in case of
+                                      // failure
+        BasicEstimators<double> headline;
 
-                AnalyzeParams extentParams(globalParams);
-                extentParams.numberOfSlices = 0; // use the specified or calculated granularity;
-                                                 // globalParams.numberOfSlices refers to the
-                                                 // total number of slices across all the
-                                                 // extents
-                BSONObjBuilder extentBuilder(extentsArrayBuilder.subobjStart());
-                success = analyzeExtent(nsd, curExtent, subCommand, extentParams, errmsg,
-                                        extentBuilder);
-                extentBuilder.doneFast();
+        BSONArrayBuilder extentsArrayBuilder(outputBuilder.subarrayStart("extents"));
+        for (int extentNum = 0; extentNum < totalExtents; extentNum++) {
+            if (!chosen[extentNum]) continue;
+
+            killCurrentOp.checkForInterrupt();
+
+            // relock per extent; the collection may have changed in between
+            Client::ReadContext ctx(ns);
+            const NamespaceDetails* nsd = nsdetails(ns);
+            const Extent* ex = nsd != NULL ? getNthExtent(extentNum, nsd) : NULL;
+            if (ex == NULL) {
+                errmsg = str::stream() << "extent " << extentNum
+                                       << " went away during the analysis";
+                return false;
             }
-            extentsArrayBuilder.doneFast();
+
+            AnalyzeParams extentParams(globalParams);
+            extentParams.numberOfSlices = 0; // use the specified or calculated granularity;
+                                             // globalParams.numberOfSlices refers to the
+                                             // total number of slices across all the
+                                             // extents
+            double extentHeadline = 0;
+            BSONObjBuilder extentBuilder(extentsArrayBuilder.subobjStart());
+            extentBuilder.append("extentNum", extentNum);
+            if (!analyzeExtent(nsd, ex, subCommand, extentParams, errmsg, extentBuilder,
+                               &extentHeadline)) {
+                return false;
+            }
+            extentBuilder.doneFast();
+            headline << extentHeadline;
+        }
+        extentsArrayBuilder.doneFast();
+
+        if (analyzedExtents < totalExtents) {
+            const char* headlineName =
+                    subCommand == SUBCMD_DISK_STORAGE ? "usedRatio" : "inMem";
+
+            // normal-approximation 95% interval for the mean per-extent ratio, with the
+            // finite population correction since extents are sampled without replacement
+            double fpc = totalExtents > 1
+                ? std::sqrt(static_cast<double>(totalExtents - analyzedExtents) /
+                            (totalExtents - 1))
+                : 0;
+            double halfWidth =
+                    1.96 * headline.stddev() / std::sqrt((double)analyzedExtents) * fpc;
+
+            BSONObjBuilder samplingBuilder(outputBuilder.subobjStart("sampling"));
+            samplingBuilder.append("sample", globalParams.sample);
+            samplingBuilder.append("analyzedExtents", analyzedExtents);
+            samplingBuilder.append("totalExtents", totalExtents);
+            samplingBuilder.append(headlineName, headline.mean());
+            samplingBuilder.append(string(headlineName) + "Ci95",
+                                   BSON_ARRAY(headline.mean() - halfWidth
+                                              << headline.mean() + halfWidth));
+            samplingBuilder.doneFast();
         }
-        if (!success) return false;
+
         result.appendElements(outputBuilder.obj());
         return true;
     }
@@ -778,30 +894,19 @@ namespace {
         }
 
         const string ns = dbname + "." + cmdObj.firstElement().valuestrsafe();
-        const NamespaceDetails* nsd = nsdetails(ns);
         if (!serverGlobalParams.quiet) {
             MONGO_TLOG(0) << "CMD: storageDetails " << ns << ", analyze " << subCommandStr << endl;
         }
-        if (!nsd) {
-            errmsg = "ns not found";
-            return false;
-        }
 
-        const Extent* extent = NULL;
-
-        // { extent: num }
+        // { extent: num }; resolved under the lock below
+        int extentNum = -1;
         BSONElement extentElm = cmdObj["extent"];
         if (extentElm.ok()) {
             if (!extentElm.isNumber()) {
                 errmsg = "extent number must be a number, e.g. {..., extent: 3, ...}";
                 return false;
             }
-            int extentNum = extentElm.numberInt();
-            extent = getNthExtent(extentNum, nsd);
-            if (extent == NULL) {
-                errmsg = str::stream() << "extent " << extentNum << " does not exist";
-                return false;
-            }
+            extentNum = extentElm.numberInt();
         }
 
         AnalyzeParams params;
@@ -809,7 +914,7 @@ namespace {
         // { range: [from, to] }, extent-relative
         BSONElement rangeElm = cmdObj["range"];
         if (rangeElm.ok()) {
-            if (extent == NULL) {
+            if (extentNum < 0) {
                 errmsg = "a range is only allowed when a single extent is requested, "
                          "use {..., extent: _num, range: [_a, _b], ...}";
                 return false;
@@ -853,7 +958,38 @@ namespace {
 
         params.showRecords = cmdObj["showRecords"].trueValue();
 
-        return runInternal(nsd, extent, subCommand, params, errmsg, result);
+        // { sample: fraction }
+        BSONElement sampleElm = cmdObj["sample"];
+        if (sampleElm.ok()) {
+            if (!sampleElm.isNumber() || sampleElm.numberDouble() <= 0 ||
+                sampleElm.numberDouble() > 1) {
+                errmsg = "sample must be a number in (0, 1]";
+                return false;
+            }
+            if (extentNum >= 0) {
+                errmsg = "sample cannot be combined with a single extent request";
+                return false;
+            }
+            params.sample = sampleElm.numberDouble();
+        }
+
+        if (extentNum >= 0) {
+            // single extent: analyzed under one read lock, as before
+            Client::ReadContext ctx(ns);
+            const NamespaceDetails* nsd = nsdetails(ns);
+            if (!nsd) {
+                errmsg = "ns not found";
+                return false;
+            }
+            const Extent* extent = getNthExtent(extentNum, nsd);
+            if (extent == NULL) {
+                errmsg = str::stream() << "extent " << extentNum << " does not exist";
+                return false;
+            }
+            return runInternal(nsd, extent, subCommand, params, errmsg, result);
+        }
+
+        return analyzeNamespace(ns, subCommand, params, errmsg, result);
     }
 
 }  // namespace
@@ -60,8 +60,11 @@ namespace mongo {
         virtual void help( stringstream& help ) const {
             help << "touch collection\n"
                 "Page in all pages of memory containing every extent for the given collection\n"
-                "{ touch : <collection_name>, [data : true] , [index : true] }\n"
-                " at least one of data or index must be true; default is both are false\n";
+                "{ touch : <collection_name>, [data : true] , [index : true],\n"
+                "  [threads : <n>], [rateMBPerSec : <n>] }\n"
+                " at least one of data or index must be true; default is both are false\n"
+                " threads > 1 faults extents in concurrently so warmup is bounded by\n"
+                " aggregate disk bandwidth; rateMBPerSec caps the touch rate\n";
         }
         virtual void addRequiredPrivileges(const std::string& dbname,
                                            const BSONObj& cmdObj,
@@ -97,19 +100,41 @@ namespace mongo {
                 errmsg = "must specify at least one of (data:true, index:true)";
                 return false;
             }
-            bool ok = touch( ns, errmsg, touch_data, touch_indexes, result );
+
+            int numThreads = 1;
+            if ( cmdObj["threads"].isNumber() ) {
+                numThreads = cmdObj["threads"].numberInt();
+                if ( numThreads < 1 || numThreads > 32 ) {
+                    errmsg = "threads must be between 1 and 32";
+                    return false;
+                }
+            }
+
+            int rateMBPerSec = 0;
+            if ( cmdObj["rateMBPerSec"].isNumber() ) {
+                rateMBPerSec = cmdObj["rateMBPerSec"].numberInt();
+                if ( rateMBPerSec < 0 ) {
+                    errmsg = "rateMBPerSec cannot be negative";
+                    return false;
+                }
+            }
+
+            bool ok = touch( ns, errmsg, touch_data, touch_indexes,
+                             numThreads, rateMBPerSec, result );
             return ok;
         }
 
-        bool touch( std::string& ns, 
-                    std::string& errmsg, 
-                    bool touch_data, 
-                    bool touch_indexes, 
+        bool touch( std::string& ns,
+                    std::string& errmsg,
+                    bool touch_data,
+                    bool touch_indexes,
+                    int numThreads,
+                    int rateMBPerSec,
                     BSONObjBuilder& result ) {
 
             if (touch_data) {
                 log() << "touching namespace " << ns << endl;
-                touchNs( ns );
+                touchNs( ns, numThreads, rateMBPerSec );
                 log() << "touching namespace " << ns << " complete" << endl;
             }
 
@@ -127,10 +152,12 @@ namespace mongo {
                         indexes.push_back( idx.indexNamespace() );
                     }
                 }
-                for ( std::vector<std::string>::const_iterator it = indexes.begin(); 
-                      it != indexes.end(); 
+                // touching an index namespace's extents faults in every btree bucket
+                // at every level, in file order -- no need to walk the tree
+                for ( std::vector<std::string>::const_iterator it = indexes.begin();
+                      it != indexes.end();
                       it++ ) {
-                    touchNs( *it );
+                    touchNs( *it, numThreads, rateMBPerSec );
                 }
             }
             return true;
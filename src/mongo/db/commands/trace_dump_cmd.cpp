@@ -0,0 +1,112 @@
+/*
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/util/trace_point.h"
+
+namespace mongo {
+
+    /**
+     * Command for controlling and dumping the trace point flight recorder.
+     *
+     * Format
+     * {
+     *    traceDump: 1,
+     *    enable: <bool>,      // optional; turn recording on or off
+     *    maxPerThread: <n>    // optional; cap on records returned per thread
+     * }
+     *
+     * Without "enable" the most recent records of every thread are returned.
+     */
+    class TraceDumpCmd : public Command {
+    public:
+        TraceDumpCmd() : Command("traceDump") {}
+
+        virtual bool slaveOk() const {
+            return true;
+        }
+
+        virtual LockType locktype() const {
+            return NONE;
+        }
+
+        virtual bool adminOnly() const {
+            return true;
+        }
+
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::traceDump);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+
+        virtual void help(stringstream& h) const {
+            h << "dump the hot-path trace point flight recorder, "
+              << "or toggle it with { traceDump: 1, enable: <bool> }";
+        }
+
+        bool run(const string& dbname,
+                 BSONObj& cmdObj,
+                 int,
+                 string& errmsg,
+                 BSONObjBuilder& result,
+                 bool fromRepl) {
+            const BSONElement enableElem(cmdObj["enable"]);
+            if (!enableElem.eoo()) {
+                TraceRecorder::setEnabled(enableElem.trueValue());
+                result.appendBool("enabled", TraceRecorder::enabled());
+                return true;
+            }
+
+            unsigned maxPerThread = TraceRecorder::Ring::kNumRecords;
+            if (cmdObj["maxPerThread"].isNumber()) {
+                const int n = cmdObj["maxPerThread"].numberInt();
+                if (n <= 0) {
+                    errmsg = "maxPerThread should be positive";
+                    return false;
+                }
+                maxPerThread = static_cast<unsigned>(n);
+            }
+
+            result.appendBool("enabled", TraceRecorder::enabled());
+            TraceRecorder::dump(result, maxPerThread);
+            return true;
+        }
+    };
+
+    namespace {
+        TraceDumpCmd traceDumpCmd;
+    }
+}
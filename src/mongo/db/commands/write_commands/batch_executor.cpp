@@ -58,17 +58,25 @@ namespace mongo {
 
         // Apply batch ops
         size_t numBatchOps = request.sizeWriteOps();
-        for ( size_t i = 0; i < numBatchOps; i++ ) {
-            if ( !applyWriteItem( request, i, &stats, error.get() ) ) {
+        if ( request.getBatchType() == BatchedCommandRequest::BatchType_Insert ) {
+            // All inserts in a batch target the same collection and carry their
+            // documents inline, so they can share lock acquisitions and journal
+            // commit checks; see applyInserts().
+            batchSuccess = applyInserts( request, &stats, response );
+        }
+        else {
+            for ( size_t i = 0; i < numBatchOps; i++ ) {
+                if ( !applyWriteItem( request, i, &stats, error.get() ) ) {
 
-                // Batch item failed
-                error->setIndex( static_cast<int>( i ) );
-                response->addToErrDetails( error.release() );
-                batchSuccess = false;
+                    // Batch item failed
+                    error->setIndex( static_cast<int>( i ) );
+                    response->addToErrDetails( error.release() );
+                    batchSuccess = false;
 
-                if ( !request.getContinueOnError() ) break;
+                    if ( !request.getContinueOnError() ) break;
 
-                error.reset( new BatchedErrorDetail );
+                    error.reset( new BatchedErrorDetail );
+                }
             }
         }
 
@@ -161,15 +169,9 @@ namespace mongo {
                 {
                     Client::WriteContext ctx( ns );
 
+                    // Inserts never come through here; executeBatch() routes
+                    // them to applyInserts() so they can share lock holds.
                     switch ( request.getBatchType() ) {
-                    case BatchedCommandRequest::BatchType_Insert:
-                        opSuccess =
-                                applyInsert( ns,
-                                             request.getInsertRequest()->getDocumentsAt( index ),
-                                             &childOp,
-                                             stats,
-                                             error );
-                        break;
                     case BatchedCommandRequest::BatchType_Update:
                         opSuccess = applyUpdate( ns,
                                                  *request.getUpdateRequest()->getUpdatesAt( index ),
@@ -225,35 +227,159 @@ namespace mongo {
         error->setErrMessage( ex.what() );
     }
 
-    bool WriteBatchExecutor::applyInsert( const string& ns,
-                                          const BSONObj& insertOp,
-                                          CurOp* currentOp,
-                                          WriteStats* stats,
-                                          BatchedErrorDetail* error ) {
-        OpDebug& opDebug = currentOp->debug();
+    bool WriteBatchExecutor::applyInserts( const BatchedCommandRequest& request,
+                                           WriteStats* stats,
+                                           BatchedCommandResponse* response ) {
+        const string& ns = request.getNS();
+        const size_t numInserts = request.sizeWriteOps();
 
-        _opCounters->gotInsert();
+        // Maximum number of documents inserted per write lock hold.  Keeps the
+        // latency seen by concurrent operations bounded when a batch is large.
+        const size_t maxPerLockHold = 64;
 
-        opDebug.op = dbInsert;
+        bool batchSuccess = true;
+        bool stopBatch = false;
+
+        size_t i = 0;
+        while ( i < numInserts && !stopBatch ) {
+
+            // Clear operation's LastError before starting.
+            _le->reset( true );
+
+            // Execute this run of inserts as a child operation of the current operation.
+            CurOp childOp( _client, _client->curop() );
+            childOp.reset( _client->getRemote(), dbInsert );
+            childOp.ensureStarted();
+            OpDebug& opDebug = childOp.debug();
+            opDebug.ns = ns;
+            opDebug.op = dbInsert;
+
+            const size_t runEnd = std::min( i + maxPerLockHold, numInserts );
+            int numInsertedForRun = 0;
+
+            // As in applyWriteItem(), each lock hold gets its own
+            // PageFaultRetryableSection.  Documents inserted before a page
+            // fault are not reapplied on retry since "i" only advances once a
+            // document has been handled.
+            PageFaultRetryableSection s;
+            while ( true ) {
+                try {
+                    Client::WriteContext ctx( ns );
 
-        try {
-            // TODO Should call insertWithObjMod directly instead of checkAndInsert?  Note that
-            // checkAndInsert will use mayInterrupt=false, so index builds initiated here won't
-            // be interruptible.
-            BSONObj doc = insertOp; // b/c we're const going in
-            checkAndInsert( ns.c_str(), doc );
-            getDur().commitIfNeeded();
-            _le->nObjects = 1; // TODO Replace after implementing LastError::recordInsert().
-            opDebug.ninserted = 1;
-            stats->numInserted++;
-        }
-        catch ( const UserException& ex ) {
-            opDebug.exceptionInfo = ex.getInfo();
-            toBatchedError( ex, error );
-            return false;
+                    // Try the whole run as one bulk insert first; that reserves space
+                    // for the run with a single allocation instead of one freelist
+                    // search per document.  Ineligible runs (e.g. capped collections,
+                    // or a document that fails validation) return false and take the
+                    // per-document loop below.
+                    if ( runEnd - i > 1 && !stopBatch ) {
+                        vector<BSONObj> docs;
+                        docs.reserve( runEnd - i );
+                        for ( size_t j = i; j < runEnd; j++ )
+                            docs.push_back( request.getInsertRequest()->getDocumentsAt( j ) );
+
+                        size_t numInserted = 0;
+                        try {
+                            if ( checkAndInsertBatch( ns.c_str(), docs, &numInserted ) ) {
+                                for ( size_t j = 0; j < numInserted; j++ )
+                                    _opCounters->gotInsert();
+                                numInsertedForRun += numInserted;
+                                stats->numInserted += numInserted;
+                                i += numInserted;
+                            }
+                        }
+                        catch ( const UserException& ex ) {
+                            // the documents before the failed one went in; the failed
+                            // document is at i + numInserted
+                            for ( size_t j = 0; j <= numInserted; j++ )
+                                _opCounters->gotInsert();
+                            numInsertedForRun += numInserted;
+                            stats->numInserted += numInserted;
+                            i += numInserted;
+
+                            opDebug.exceptionInfo = ex.getInfo();
+                            auto_ptr<BatchedErrorDetail> error( new BatchedErrorDetail );
+                            toBatchedError( ex, error.get() );
+                            error->setIndex( static_cast<int>( i ) );
+                            response->addToErrDetails( error.release() );
+                            batchSuccess = false;
+
+                            i++;
+                            if ( !request.getContinueOnError() )
+                                stopBatch = true;
+                        }
+                        catch ( ... ) {
+                            // e.g. a page fault: advance past the prefix that was
+                            // inserted so the retry doesn't reapply it
+                            numInsertedForRun += numInserted;
+                            stats->numInserted += numInserted;
+                            i += numInserted;
+                            for ( size_t j = 0; j < numInserted; j++ )
+                                _opCounters->gotInsert();
+                            throw;
+                        }
+                    }
+
+                    for ( ; i < runEnd && !stopBatch; i++ ) {
+                        _opCounters->gotInsert();
+                        try {
+                            // TODO Should call insertWithObjMod directly instead of
+                            // checkAndInsert?  Note that checkAndInsert will use
+                            // mayInterrupt=false, so index builds initiated here won't
+                            // be interruptible.
+                            BSONObj doc = request.getInsertRequest()->getDocumentsAt( i );
+                            checkAndInsert( ns.c_str(), doc );
+                            numInsertedForRun++;
+                            stats->numInserted++;
+                        }
+                        catch ( const UserException& ex ) {
+                            opDebug.exceptionInfo = ex.getInfo();
+                            auto_ptr<BatchedErrorDetail> error( new BatchedErrorDetail );
+                            toBatchedError( ex, error.get() );
+                            error->setIndex( static_cast<int>( i ) );
+                            response->addToErrDetails( error.release() );
+                            batchSuccess = false;
+
+                            if ( !request.getContinueOnError() ) {
+                                stopBatch = true;
+                                i++;
+                                break;
+                            }
+                        }
+                    }
+
+                    // One group commit check per lock hold instead of one per
+                    // document.
+                    getDur().commitIfNeeded();
+                    break;
+                }
+                catch ( PageFaultException& e ) {
+                    e.touch();
+                }
+            }
+
+            // TODO Replace after implementing LastError::recordInsert().
+            _le->nObjects = numInsertedForRun;
+            opDebug.ninserted = numInsertedForRun;
+
+            childOp.done();
+            opDebug.executionTime = childOp.totalTimeMillis();
+            opDebug.recordStats();
+
+            // Log operation if running with at least "-v", or if exceeds slow threshold.
+            if (logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(1))
+                 || opDebug.executionTime >
+                    serverGlobalParams.slowMS + childOp.getExpectedLatencyMs()) {
+
+                MONGO_TLOG(1) << opDebug.report( childOp ) << endl;
+            }
+
+            // Save operation to system.profile if shouldDBProfile().
+            if ( childOp.shouldDBProfile( opDebug.executionTime ) ) {
+                profile( *_client, dbInsert, childOp );
+            }
         }
 
-        return true;
+        return batchSuccess;
     }
 
     bool WriteBatchExecutor::applyUpdate( const string& ns,
@@ -327,7 +453,7 @@ namespace mongo {
 
         try {
             n = deleteObjects( ns, queryObj, // ns, query
-                               false, // justOne
+                               deleteOp.isLimitSet() && deleteOp.getLimit() == 1, // justOne
                                true, // logOp
                                false // god
                                );
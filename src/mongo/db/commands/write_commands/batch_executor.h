@@ -74,6 +74,16 @@ namespace mongo {
             int numDeleted;
         };
 
+        /**
+         * Issues all inserts in the batch, grouping contiguous documents so each
+         * write lock hold covers a run of inserts with a single journal commit
+         * check.  Returns true iff all inserts succeeded; adds per-item details
+         * to "response" for those that did not.
+         */
+        bool applyInserts( const BatchedCommandRequest& request,
+                           WriteStats* stats,
+                           BatchedCommandResponse* response );
+
         /**
          * Issues a single write.  Fills "results" with write result.
          * Returns true iff write item was issued sucessfully and increments stats, populates error
@@ -89,12 +99,6 @@ namespace mongo {
         // Returns true iff write item was issued sucessfully and increments stats, populates error
         // if not successful.
         //
-        bool applyInsert( const std::string& ns,
-                          const BSONObj& insertOp,
-                          CurOp* currentOp,
-                          WriteStats* stats,
-                          BatchedErrorDetail* error );
-
         bool applyUpdate( const std::string& ns,
                           const BatchedUpdateDocument& updateOp,
                           CurOp* currentOp,
@@ -32,14 +32,18 @@
 
 #include "mongo/pch.h"
 
+#include <set>
 #include <string>
 #include <vector>
 
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/privilege.h"
 #include "mongo/db/background.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/fsync.h"
 #include "mongo/db/d_concurrency.h"
 #include "mongo/db/curop-inl.h"
 #include "mongo/db/extsort.h"
@@ -49,6 +53,8 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/storage_hints.h"
+#include "mongo/util/background.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/timer.h"
 #include "mongo/util/touch_pages.h"
@@ -279,9 +285,228 @@ namespace mongo {
             theDataFileMgr.insert(si.c_str(), info.objdata(), info.objsize());
         }
 
+        // the collection now sits in freshly allocated extents; reapply any
+        // declared access-pattern advice (see storageHints command)
+        applyStorageHints( d );
+
         return true;
     }
 
+    namespace {
+
+        /**
+         * Unlink every deleted record inside extent 'extLoc' from the namespace
+         * free lists.  While an extent is being drained the allocator must not
+         * hand out space in it, or the records we move out would simply land
+         * back in it.  The space is not lost: the whole extent goes back to the
+         * ExtentManager once it is empty.
+         */
+        void orphanDeletedInExtent( NamespaceDetails* d, const DiskLoc& extLoc, const Extent* e ) {
+            for( int b = 0; b < Buckets; b++ ) {
+                DiskLoc prev;
+                DiskLoc cur = d->deletedListEntry( b );
+                while( !cur.isNull() ) {
+                    DiskLoc next = cur.drec()->nextDeleted();
+                    if( cur.a() == extLoc.a() &&
+                        cur.getOfs() >= extLoc.getOfs() &&
+                        cur.getOfs() < extLoc.getOfs() + e->length ) {
+                        if( prev.isNull() )
+                            getDur().writingDiskLoc( d->deletedListEntry( b ) ) = next;
+                        else
+                            getDur().writingDiskLoc( prev.drec()->nextDeleted() ) = next;
+                    }
+                    else {
+                        prev = cur;
+                    }
+                    cur = next;
+                }
+            }
+        }
+
+        /**
+         * deleteRecord just pushed the freed space at 'dl' onto the head of its
+         * size bucket; pop it back off so a subsequent allocation cannot reuse
+         * the extent being drained.
+         */
+        void orphanJustDeleted( NamespaceDetails* d, const DiskLoc& dl ) {
+            int b = NamespaceDetails::bucket( dl.drec()->lengthWithHeaders() );
+            verify( d->deletedListEntry( b ) == dl );
+            getDur().writingDiskLoc( d->deletedListEntry( b ) ) = dl.drec()->nextDeleted();
+        }
+    }
+
+    /**
+     * Drains a collection's extents from the front in small batches per write
+     * lock acquisition, so compaction can run against a live server.  Records
+     * are moved with a full delete + reinsert -- index entries and cursors are
+     * maintained by the normal paths, as there is no in-place forwarding of
+     * DiskLocs in this storage engine -- and each emptied extent is handed
+     * back to the ExtentManager.  Between batches the thread sleeps for at
+     * least as long as the batch held the lock, so foreground writes keep at
+     * least half the lock bandwidth.
+     */
+    class OnlineCompactor : public BackgroundJob {
+    public:
+        static bool start( const string& ns, string& errmsg ) {
+            scoped_lock lk( _activeMutex );
+            if( _active.count( ns ) ) {
+                errmsg = "online compaction already running for this collection";
+                return false;
+            }
+            _active.insert( ns );
+            _stopRequested.erase( ns );
+            ( new OnlineCompactor( ns ) )->go();
+            return true;
+        }
+
+        static bool requestStop( const string& ns, string& errmsg ) {
+            scoped_lock lk( _activeMutex );
+            if( !_active.count( ns ) ) {
+                errmsg = "no online compaction running for this collection";
+                return false;
+            }
+            _stopRequested.insert( ns );
+            return true;
+        }
+
+        virtual string name() const { return "OnlineCompactor"; }
+
+        // compaction is housekeeping; yield the cpu/io schedulers to foreground work
+        virtual Priority priority() const { return LOW; }
+
+        virtual void run() {
+            Client::initThread( "compactOnline" );
+            cc().getAuthorizationSession()->grantInternalAuthorization();
+
+            log() << "compact online " << _ns << " begin" << endl;
+            long long moved = 0;
+            int freed = 0;
+            const char* whyStopped = "finished";
+            while( 1 ) {
+                if( inShutdown() || stopRequested() ) {
+                    whyStopped = "stopped";
+                    break;
+                }
+                if( lockedForWriting() ) {
+                    // fsync+lock in effect; try again later
+                    sleepsecs( 1 );
+                    continue;
+                }
+                bool more = false;
+                int batchMillis;
+                {
+                    Timer t;
+                    try {
+                        more = doOneBatch( moved, freed );
+                    }
+                    catch( DBException& e ) {
+                        error() << "compact online " << _ns << " error: " << e.what() << endl;
+                        whyStopped = "error";
+                        break;
+                    }
+                    batchMillis = t.millis();
+                }
+                if( !more )
+                    break;
+                // pace: give foreground writes at least as much lock time as
+                // the batch just used
+                sleepmillis( std::max( 10, std::min( batchMillis, 1000 ) ) );
+            }
+            log() << "compact online " << _ns << " end (" << whyStopped << "): moved "
+                  << moved << " documents, freed " << freed << " extents" << endl;
+
+            {
+                scoped_lock lk( _activeMutex );
+                _active.erase( _ns );
+                _stopRequested.erase( _ns );
+            }
+            cc().shutdown();
+        }
+
+    private:
+        explicit OnlineCompactor( const string& ns )
+            : BackgroundJob( true /* selfDelete */ ), _ns( ns ) {}
+
+        bool stopRequested() const {
+            scoped_lock lk( _activeMutex );
+            return _stopRequested.count( _ns ) > 0;
+        }
+
+        /**
+         * One write lock acquisition: move up to kBatchDocs records out of the
+         * front extent, and release the extent once it is empty.
+         * @return true if there is more work to do
+         */
+        bool doOneBatch( long long& moved, int& freed ) {
+            Client::WriteContext ctx( _ns );
+            NamespaceDetails* d = nsdetails( _ns );
+            if( !d || d->isCapped() ) {
+                // dropped (or dropped and recreated capped) while we were off the lock
+                return false;
+            }
+            if( d->firstExtent() == d->lastExtent() ) {
+                // down to one extent; the allocator is filling it, leave it be
+                return false;
+            }
+
+            const DiskLoc extLoc = d->firstExtent();
+            Extent* e = extLoc.ext();
+            e->assertOk();
+
+            if( _draining != extLoc ) {
+                // first visit to this extent: take its free space out of the
+                // free lists so the moves below cannot allocate from it
+                orphanDeletedInExtent( d, extLoc, e );
+                _draining = extLoc;
+            }
+
+            for( int i = 0; i < kBatchDocs && !e->firstRecord.isNull(); i++ ) {
+                const DiskLoc L = e->firstRecord;
+                Record* recOld = L.rec();
+                BSONObj obj = BSONObj::make( recOld ).getOwned();
+                if( !obj.valid() ) {
+                    error() << "compact online " << _ns << " stopping: corrupt document at "
+                            << L.toString() << "; run the offline compact command" << endl;
+                    return false;
+                }
+                theDataFileMgr.deleteRecord( d, _ns.c_str(), recOld, L, false, true, false );
+                orphanJustDeleted( d, L );
+                // god: the document is reinserted verbatim, and frozen collections
+                // (read-only to users) are a prime candidate for draining
+                theDataFileMgr.insertWithObjMod( _ns.c_str(), obj, false, true );
+                moved++;
+            }
+
+            if( e->firstRecord.isNull() ) {
+                // extent drained; unlink it from the chain and hand it back
+                verify( d->lastExtent() != extLoc );
+                DiskLoc newFirst = e->xnext;
+                d->firstExtent().writing() = newFirst;
+                newFirst.ext()->xprev.writing().Null();
+                getDur().writing( e )->markEmpty();
+                cc().database()->getExtentManager().freeExtents( extLoc, extLoc );
+                _draining.Null();
+                freed++;
+            }
+
+            getDur().commitIfNeeded();
+            return true;
+        }
+
+        static const int kBatchDocs = 100;
+
+        static mongo::mutex _activeMutex;
+        static set<string> _active;
+        static set<string> _stopRequested;
+
+        const string _ns;
+        DiskLoc _draining; // extent currently being emptied, if any
+    };
+
+    mongo::mutex OnlineCompactor::_activeMutex( "OnlineCompactor" );
+    set<string> OnlineCompactor::_active;
+    set<string> OnlineCompactor::_stopRequested;
+
     bool isCurrentlyAReplSetPrimary();
 
     class CompactCmd : public Command {
@@ -302,9 +527,11 @@ namespace mongo {
             help << "compact collection\n"
                 "warning: this operation blocks the server and is slow. you can cancel with cancelOp()\n"
                 "{ compact : <collection_name>, [force:<bool>], [validate:<bool>],\n"
-                "  [paddingFactor:<num>], [paddingBytes:<num>] }\n"
+                "  [paddingFactor:<num>], [paddingBytes:<num>], [online:<bool>] }\n"
                 "  force - allows to run on a replica set primary\n"
-                "  validate - check records are noncorrupt before adding to newly compacting extents. slower but safer (defaults to true in this version)\n";
+                "  validate - check records are noncorrupt before adding to newly compacting extents. slower but safer (defaults to true in this version)\n"
+                "  online - compact in the background in small batches without blocking the server;\n"
+                "    stop with { compact : <collection_name>, online : true, stop : true }\n";
         }
         CompactCmd() : Command("compact") { }
 
@@ -325,7 +552,8 @@ namespace mongo {
                 return false;
             }
 
-            if( isCurrentlyAReplSetPrimary() && !cmdObj["force"].trueValue() ) { 
+            if( isCurrentlyAReplSetPrimary() && !cmdObj["online"].trueValue() &&
+                !cmdObj["force"].trueValue() ) {
                 errmsg = "will not run compact on an active replica set primary as this is a slow blocking operation. use force:true to force";
                 return false;
             }
@@ -357,6 +585,25 @@ namespace mongo {
                 }
             }
 
+            if( cmdObj["online"].trueValue() ) {
+                if( cmdObj.hasElement("paddingFactor") || cmdObj.hasElement("paddingBytes") ) {
+                    // the online path reinserts through the normal allocator, which
+                    // applies the collection's current padding
+                    errmsg = "paddingFactor/paddingBytes cannot be combined with online:true";
+                    return false;
+                }
+                if( cmdObj["stop"].trueValue() ) {
+                    if( !OnlineCompactor::requestStop( ns, errmsg ) )
+                        return false;
+                    result.append( "note", "online compaction stop requested" );
+                    return true;
+                }
+                if( !OnlineCompactor::start( ns, errmsg ) )
+                    return false;
+                result.append( "note", "online compaction started in background" );
+                return true;
+            }
+
             double pf = 1.0;
             int pb = 0;
             if( cmdObj.hasElement("paddingFactor") ) {
@@ -29,10 +29,12 @@
 #include "mongo/pch.h"
 
 #include "mongo/base/counter.h"
+#include "mongo/base/init.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/database.h"
 #include "mongo/db/kill_current_op.h"
+#include "mongo/db/op_memory.h"
 #include "mongo/util/fail_point_service.h"
 
 namespace mongo {
@@ -52,6 +54,31 @@ namespace mongo {
 
     // todo : move more here
 
+    namespace {
+
+        // per-operation memory accounting hooks (see db/op_memory.h).  consumers charge
+        // through opmem::charge from wherever they run; here we route those charges to the
+        // operation that is actually executing on this thread.
+        long long curopNoteOpCharge( long long bytes ) {
+            if ( !haveClient() )
+                return 0;
+            return cc().curop()->chargeMemory( bytes );
+        }
+
+        void curopNoteOpRelease( long long bytes ) {
+            if ( !haveClient() )
+                return;
+            cc().curop()->releaseMemory( bytes );
+        }
+
+        MONGO_INITIALIZER(CurOpMemoryAccounting)(InitializerContext* context) {
+            opmem::noteOpCharge = curopNoteOpCharge;
+            opmem::noteOpRelease = curopNoteOpRelease;
+            return Status::OK();
+        }
+
+    }
+
     CurOp::CurOp( Client * client , CurOp * wrapped ) :
         _client(client),
         _wrapped(wrapped)
@@ -81,6 +108,7 @@ namespace mongo {
         killCurrentOp.notifyAllWaiters();
         _numYields = 0;
         _expectedLatencyMs = 0;
+        _memCharged = 0;
         _lockStat.reset();
     }
 
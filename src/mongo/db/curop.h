@@ -36,6 +36,7 @@
 #include "mongo/bson/util/atomic_int.h"
 #include "mongo/db/client.h"
 #include "mongo/db/storage/namespace.h"
+#include "mongo/util/coarse_ticker.h"
 #include "mongo/util/concurrency/spin_lock.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/progress_meter.h"
@@ -266,6 +267,19 @@ namespace mongo {
         int elapsedMillis() {
             return (int) (elapsedMicros() / 1000);
         }
+        /**
+         * elapsedMillis() off the coarse ticker: one atomic load instead of a clock
+         * syscall, accurate to the ticker interval (~1ms).  For checks made per
+         * document or per record access; anything reported to a user (explain, the
+         * profiler) should use elapsedMillis().
+         */
+        int approxElapsedMillis() {
+            unsigned long long nowMicros = coarseCurTimeMillis() * 1000;
+            unsigned long long start = startTime();
+            if ( nowMicros <= start )
+                return 0;
+            return (int) ( ( nowMicros - start ) / 1000 );
+        }
         int elapsedSeconds() { return elapsedMillis() / 1000; }
 
         void setQuery(const BSONObj& query) { _query.set( query ); }
@@ -294,6 +308,21 @@ namespace mongo {
         long long getExpectedLatencyMs() const { return _expectedLatencyMs; }
         void setExpectedLatencyMs( long long latency ) { _expectedLatencyMs = latency; }
 
+        /**
+         * note 'bytes' of buffered memory charged to this op (see db/op_memory.h);
+         * returns the op's new charged total
+         */
+        long long chargeMemory( long long bytes ) {
+            _memCharged += bytes;
+            return _memCharged;
+        }
+        void releaseMemory( long long bytes ) {
+            _memCharged -= bytes;
+            if ( _memCharged < 0 )
+                _memCharged = 0; // released by a consumer that outlived the charging op
+        }
+        long long memoryCharged() const { return _memCharged; }
+
         void recordGlobalTime( long long micros ) const;
         
         const LockStat& lockStat() const { return _lockStat; }
@@ -339,7 +368,10 @@ namespace mongo {
         // this is how much "extra" time a query might take
         // a writebacklisten for example will block for 30s 
         // so this should be 30000 in that case
-        long long _expectedLatencyMs; 
+        long long _expectedLatencyMs;
+
+        // bytes of buffered memory currently charged to this op (see db/op_memory.h)
+        long long _memCharged;
 
         /** Nested class that implements a time limit ($maxTimeMS) for a CurOp object. */
         class MaxTimeTracker {
@@ -32,6 +32,7 @@
 
 #include "mongo/db/d_concurrency.h"
 
+#include "mongo/base/parse_number.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/curop.h"
@@ -39,6 +40,8 @@
 #include "mongo/db/dur.h"
 #include "mongo/db/lockstat.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/lock_wait_stats.h"
 #include "mongo/server.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/concurrency/mapsf.h"
@@ -46,6 +49,7 @@
 #include "mongo/util/concurrency/rwlock.h"
 #include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/stacktrace.h"
+#include "mongo/util/trace_point.h"
 
 // oplog locking
 // no top level read locks
@@ -125,21 +129,27 @@ namespace mongo {
         void lock_r() { 
             verify( threadState() == 0 );
             lockState().lockedStart( 'r' );
+            MONGO_TRACE_POINT( "lock/r", 0, 0 );
             q.lock_r(); 
+            MONGO_TRACE_POINT( "lock/r/acquired", 0, 0 );
         }
         
         void lock_w() { 
             verify( threadState() == 0 );
             getDur().commitIfNeeded();
             lockState().lockedStart( 'w' );
+            MONGO_TRACE_POINT( "lock/w", 0, 0 );
             q.lock_w(); 
+            MONGO_TRACE_POINT( "lock/w/acquired", 0, 0 );
         }
         
         void lock_R() {
             LockState& ls = lockState();
             massert(16103, str::stream() << "can't lock_R, threadState=" << (int) ls.threadState(), ls.threadState() == 0);
             ls.lockedStart( 'R' );
+            MONGO_TRACE_POINT( "lock/R", 0, 0 );
             q.lock_R(); 
+            MONGO_TRACE_POINT( "lock/R/acquired", 0, 0 );
         }
 
         void lock_W() {            
@@ -150,9 +160,11 @@ namespace mongo {
             }
             getDur().commitIfNeeded(); // check before locking - will use an R lock for the commit if need to do one, which is better than W
             ls.lockedStart( 'W' );
+            MONGO_TRACE_POINT( "lock/W", 0, 0 );
             {
                 q.lock_W();
             }
+            MONGO_TRACE_POINT( "lock/W/acquired", 0, 0 );
             locked_W();
         }
 
@@ -195,9 +207,15 @@ namespace mongo {
             unlocking_W();
             lockState().unlocked();
             q.unlock_W(); 
+            MONGO_TRACE_POINT( "unlock/W", 0, 0 );
         }
 
-        // todo timing stats? : 
+        void getQLockStats(QLock::Stats& s) { q.getStats(s); }
+        void setStarvationThresholdMicros(long long micros) {
+            q.setStarvationThresholdMicros(micros);
+        }
+
+        // todo timing stats? :
         void W_to_R()                        { q.W_to_R(); }
         void R_to_W()                        { q.R_to_W(); }
         bool w_to_X() { return q.w_to_X(); }
@@ -208,6 +226,7 @@ namespace mongo {
             wassert( threadState() == 'R' );
             lockState().unlocked();
             q.unlock_R(); 
+            MONGO_TRACE_POINT( "unlock/R", 0, 0 );
         }
     };
 
@@ -216,6 +235,12 @@ namespace mongo {
         return &qlk.stats;
     }
     
+    AtomicUInt Lock::_pendingWriters;
+
+    int Lock::writersWaiting() {
+        return _pendingWriters;
+    }
+
     int Lock::isLocked() {
         return threadState();
     }
@@ -314,7 +339,18 @@ namespace mongo {
         long long acquisitionTime = _timer.micros();
         _timer.reset();
         _stat = stat;
-        cc().curop()->lockStat().recordAcquireTimeMicros( _type , acquisitionTime );
+
+        CurOp* op = cc().curop();
+        op->lockStat().recordAcquireTimeMicros( _type , acquisitionTime );
+
+        // if we actually waited, attribute the wait to the op's namespace so convoys can
+        // be traced to the collections causing them.  uncontended acquisitions skip this.
+        if ( acquisitionTime >= LockWaitStats::kMinWaitMicros ) {
+            const char* ns = op->getNS();
+            if ( ns && *ns ) {
+                LockWaitStats::global.record( ns , op->getOp() , _type , acquisitionTime );
+            }
+        }
         return acquisitionTime;
     }
 
@@ -539,10 +575,16 @@ namespace mongo {
 
         if( db != ls.otherName() )
         {
-            DBLocksMap::ref r(dblocks);
-            WrapperForRWLock*& lock = r[db];
-            if( lock == 0 )
-                lock = new WrapperForRWLock(db);
+            WrapperForRWLock* lock = ls.getDbLockCached(db);
+            if( lock == 0 ) {
+                // first use of this db by this thread - consult the shared map
+                DBLocksMap::ref r(dblocks);
+                WrapperForRWLock*& l = r[db];
+                if( l == 0 )
+                    l = new WrapperForRWLock(db);
+                lock = l;
+                ls.cacheDbLock(db, lock);
+            }
             ls.lockedOther( db , 1 , lock );
         }
         else { 
@@ -729,10 +771,16 @@ namespace mongo {
 
         if( db != ls.otherName() )
         {
-            DBLocksMap::ref r(dblocks);
-            WrapperForRWLock*& lock = r[db];
-            if( lock == 0 )
-                lock = new WrapperForRWLock(db);
+            WrapperForRWLock* lock = ls.getDbLockCached(db);
+            if( lock == 0 ) {
+                // first use of this db by this thread - consult the shared map
+                DBLocksMap::ref r(dblocks);
+                WrapperForRWLock*& l = r[db];
+                if( l == 0 )
+                    l = new WrapperForRWLock(db);
+                lock = l;
+                ls.cacheDbLock(db, lock);
+            }
             ls.lockedOther( db , -1 , lock );
         }
         else { 
@@ -876,4 +924,76 @@ namespace mongo {
 
     } lockStatsServerStatusSection;
 
+    class QLockServerStatusSection : public ServerStatusSection {
+    public:
+        QLockServerStatusSection() : ServerStatusSection( "qlock" ){}
+        virtual bool includeByDefault() const { return false; }
+
+        BSONObj generateSection( const BSONElement& configElement ) const {
+            QLock::Stats stats;
+            qlk.getQLockStats(stats);
+
+            BSONObjBuilder b;
+            _appendState(b, "r", stats.r);
+            _appendState(b, "w", stats.w);
+            _appendState(b, "R", stats.R);
+            _appendState(b, "W", stats.W);
+            return b.obj();
+        }
+
+    private:
+        static void _appendState(BSONObjBuilder& b, const char* name,
+                                 const QLock::StateStats& s) {
+            BSONObjBuilder t(b.subobjStart(name));
+            t.append("held", s.threadsHolding);
+            t.append("waiting", s.threadsWaiting);
+            t.append("waits", s.waits);
+            t.append("waitMicros", s.waitMicros);
+            t.append("oldestWaitMicros", s.oldestWaitMicros);
+            t.done();
+        }
+    } qlockServerStatusSection;
+
+    namespace {
+        class QLockStarvationThresholdSetting : public ServerParameter {
+        public:
+            QLockStarvationThresholdSetting()
+                : ServerParameter(ServerParameterSet::getGlobal(),
+                                  "qlockWriterStarvationThresholdMillis"),
+                  _millis(100) { // must match the QLock constructor's default
+            }
+
+            virtual void append(BSONObjBuilder& b, const std::string& name) {
+                b << name << _millis;
+            }
+
+            virtual Status set(const BSONElement& newValueElement) {
+                if (!newValueElement.isNumber())
+                    return Status(ErrorCodes::BadValue, str::stream() <<
+                                  "Invalid value for " << name() << ": " << newValueElement);
+                return _set(newValueElement.numberLong());
+            }
+
+            virtual Status setFromString(const std::string& str) {
+                long long newValue;
+                Status status = parseNumberFromString(str, &newValue);
+                if (!status.isOK())
+                    return status;
+                return _set(newValue);
+            }
+
+        private:
+            Status _set(long long millis) {
+                if (millis < 0)
+                    return Status(ErrorCodes::BadValue, str::stream() <<
+                                  name() << " cannot be negative");
+                _millis = millis;
+                qlk.setStarvationThresholdMicros(millis * 1000);
+                return Status::OK();
+            }
+
+            long long _millis;
+        } qlockStarvationThresholdSetting;
+    }
+
 }
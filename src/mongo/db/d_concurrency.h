@@ -35,6 +35,7 @@
 #pragma once
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/util/atomic_int.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/lockstat.h"
 #include "mongo/util/concurrency/mutex.h"
@@ -42,10 +43,11 @@
 
 namespace mongo {
 
+    class Acquiring;
     class WrapperForRWLock;
     class LockState;
 
-    class Lock : boost::noncopyable { 
+    class Lock : boost::noncopyable {
     public:
         enum Nestable { notnestable=0, local, admin };
         static int isLocked();      // true if *anything* is locked (by us)
@@ -60,8 +62,14 @@ namespace mongo {
         static void assertAtLeastReadLocked(const StringData& ns);
         static void assertWriteLocked(const StringData& ns);
 
-        static bool dbLevelLockingEnabled(); 
-        
+        static bool dbLevelLockingEnabled();
+
+        /** Approximate number of threads currently blocked acquiring a write
+            lock (global or per-database).  Read without synchronization, so
+            momentarily stale -- cheap enough to consult per document in yield
+            heuristics, where a stale answer only costs one yield. */
+        static int writersWaiting();
+
         static LockStat* globalLockStat();
         static LockStat* nestableLockStat( Nestable db );
 
@@ -89,6 +97,10 @@ namespace mongo {
         };
 
     private:
+        // bumped by Acquiring while a 'w' or 'W' ScopedLock is being acquired
+        static AtomicUInt _pendingWriters;
+        friend class Acquiring;
+
         class ParallelBatchWriterSupport : boost::noncopyable {
         public:
             ParallelBatchWriterSupport();
@@ -109,6 +121,8 @@ namespace mongo {
             /** @return micros since we started acquiring */
             long long acquireFinished( LockStat* stat );
 
+            char type() const { return _type; }
+
             // Accrue elapsed lock time since last we called reset
             void recordTime();
             // Start recording a new period, starting now()
@@ -45,7 +45,9 @@
 #include "mongo/db/introspect.h"
 #include "mongo/db/pdfile.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/ops/delete.h"
+#include "mongo/db/storage_hints.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/structure/collection.h"
 
@@ -128,6 +130,9 @@ namespace mongo {
                 _namespaceIndex.init();
                 _extentManager.init( _namespaceIndex.details( _extentFreelistName ) );
                 openAllFiles();
+
+                // madvise policies don't survive a remap; reapply any recorded ones
+                applyDatabaseStorageHints( this );
             }
             _magic = 781231;
         }
@@ -303,6 +308,7 @@ namespace mongo {
         ClientCursor::invalidate( fullns );
         Top::global.collectionDropped( fullns );
         NamespaceDetailsTransient::eraseCollection( fullns.toString() );
+        PlanCache::clear( fullns.toString() );
 
         Status s = _dropNS( fullns );
 
@@ -40,11 +40,13 @@
 #include "mongo/db/auth/authz_manager_external_state_d.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_manager_global.h"
+#include "mongo/db/catalog_warmer.h"
 #include "mongo/db/client.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/d_concurrency.h"
 #include "mongo/db/d_globals.h"
+#include "mongo/db/index_stats_refresher.h"
 #include "mongo/db/db.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/dbwebserver.h"
@@ -75,7 +77,9 @@
 #include "mongo/s/d_writeback.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/util/background.h"
+#include "mongo/util/buffer_arena.h"
 #include "mongo/util/cmdline_utils/censor_cmdline.h"
+#include "mongo/util/coarse_ticker.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/exception_filter_win32.h"
@@ -83,6 +87,7 @@
 #include "mongo/util/net/message_server.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/ntservice.h"
+#include "mongo/util/numa.h"
 #include "mongo/util/options_parser/environment.h"
 #include "mongo/util/options_parser/option_section.h"
 #include "mongo/util/options_parser/options_parser.h"
@@ -187,6 +192,7 @@ namespace mongo {
         }
 
         virtual void process( Message& m , AbstractMessagingPort* port , LastError * le) {
+            int exhaustBatches = 0;
             while ( true ) {
                 if ( inShutdown() ) {
                     log() << "got request after shutdown()" << endl;
@@ -226,7 +232,12 @@ namespace mongo {
                             m.appendData(b.buf(), b.len());
                             b.decouple();
                             DEV log() << "exhaust=true sending more" << endl;
-                            beNice();
+                            // the getmore yields its locks inside each batch already; an
+                            // unconditional pause here (which also scans the client list
+                            // under a mutex) just caps streaming throughput, so only
+                            // come up for air every few batches
+                            if( ++exhaustBatches % 8 == 0 )
+                                beNice();
                             continue; // this goes back to top loop
                         }
                     }
@@ -278,6 +289,7 @@ namespace mongo {
 
         MessageServer * server = createServer( options , new MyMessageHandler() );
         server->setAsTimeTracker();
+        startCoarseTicker();
         // we must setupSockets prior to logStartup() to avoid getting too high
         // a file descriptor for our calls to select()
         server->setupSockets();
@@ -500,8 +512,14 @@ namespace mongo {
 
         string name() const { return "DataFileSync"; }
 
+        // gap inserted between flush slices/files; small relative to syncdelay but enough
+        // for queued journal I/O to drain
+        static const int flushPauseMillis = 100;
+
         void run() {
             Client::initThread( name().c_str() );
+            if ( numaBindThreadToNode( numaDurabilityNode ) )
+                log() << "flush thread bound to NUMA node " << numaDurabilityNode << endl;
             if (storageGlobalParams.syncdelay == 0) {
                 log() << "warning: --syncdelay 0 is not recommended and can have strange performance" << endl;
             }
@@ -514,8 +532,9 @@ namespace mongo {
             int time_flushing = 0;
             while ( ! inShutdown() ) {
                 _diaglog.flush();
-                if (storageGlobalParams.syncdelay == 0) {
-                    // in case at some point we add an option to change at runtime
+                if (storageGlobalParams.syncdelay == 0 || storageGlobalParams.ephemeral) {
+                    // nothing to flush: syncdelay 0, or ephemeral mode where the
+                    // copy-on-write mappings have no backing to write to anyway
                     sleepsecs(5);
                     continue;
                 }
@@ -528,7 +547,11 @@ namespace mongo {
                 }
 
                 Date_t start = jsTime();
-                int numFiles = MemoryMappedFile::flushAll( true );
+                // staggered: dirtiest file first, with short pauses between slices so the
+                // periodic flush doesn't collide with journal writes in one big burst.
+                // note time_flushing (and the backgroundFlushing averages) thus includes
+                // the pacing sleeps, not just time spent issuing I/O.
+                int numFiles = MemoryMappedFile::flushAllStaggered( flushPauseMillis );
                 time_flushing = (int) (jsTime() - start);
 
                 _flushed(time_flushing);
@@ -581,6 +604,31 @@ namespace mongo {
 
             }
         } memJournalServerStatusMetric;
+
+        class BufferArenaServerStatusMetric : public ServerStatusMetric {
+        public:
+            BufferArenaServerStatusMetric() : ServerStatusMetric("bufferArena.hits") {}
+            virtual void appendAtLeaf( BSONObjBuilder& b ) const {
+                b.appendNumber( "hits", bufferarena::hits() );
+                b.appendNumber( "misses", bufferarena::misses() );
+                b.appendNumber( "unpooled", bufferarena::unpooled() );
+            }
+        } bufferArenaServerStatusMetric;
+
+        class NumaServerStatusSection : public ServerStatusSection {
+        public:
+            NumaServerStatusSection() : ServerStatusSection( "numa" ) {}
+
+            // only interesting on NUMA machines, and costs a few sysfs reads
+            virtual bool includeByDefault() const { return false; }
+
+            virtual BSONObj generateSection(const BSONElement& configElement) const {
+                BSONObjBuilder b;
+                b.append( "nodes", numaNodeCount() );
+                numaAppendStats( b );
+                return b.obj();
+            }
+        } numaServerStatusSection;
     }
 
 
@@ -740,6 +788,10 @@ namespace mongo {
             startTTLBackgroundJob();
         }
 
+        startCatalogWarmer();
+
+        startIndexStatsRefresher();
+
 #ifndef _WIN32
         mongo::signalForkSuccess();
 #endif
@@ -66,6 +66,7 @@
 #include "mongo/db/query_optimizer.h"
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/sort_phase_one.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/s/d_writeback.h"
 #include "mongo/s/stale_exception.h"  // for SendStaleConfigException
@@ -809,6 +810,165 @@ namespace mongo {
         }
     } cmdReIndex;
 
+    /* batched index DDL: validate a set of index drops and creates for one
+       collection up front, then apply them in a single lock scope.  The drops
+       share one pass over the IndexDetails array and the creates share one
+       collection scan for their sort phases, so migrating a large index set
+       costs one rewrite and one scan instead of one of each per index. */
+    class CmdBatchIndexes : public Command {
+    public:
+        virtual bool logTheOp() {
+            return true;
+        }
+        virtual bool slaveOk() const {
+            return false;
+        }
+        virtual LockType locktype() const { return WRITE; }
+        virtual void help( stringstream& help ) const {
+            help << "apply a batch of index drops and creates on one collection in a single lock scope\n"
+                "{ batchIndexes: <collection>, drop: [<name or key pattern>, ...], create: [<index spec>, ...] }";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::dropIndex);
+            actions.addAction(ActionType::createIndex);
+            out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+        }
+
+        virtual std::vector<BSONObj> stopIndexBuilds(const std::string& dbname,
+                                                     const BSONObj& cmdObj) {
+            std::string systemIndexes = dbname + ".system.indexes";
+            std::string ns = dbname + '.' + cmdObj["batchIndexes"].valuestrsafe();
+            BSONObj criteria = BSON("ns" << systemIndexes << "op" << "insert" << "insert.ns" << ns);
+
+            return IndexBuilder::killMatchingIndexBuilds(criteria);
+        }
+
+        CmdBatchIndexes() : Command("batchIndexes") { }
+        bool run(const string& dbname, BSONObj& jsobj, int, string& errmsg, BSONObjBuilder& result, bool /*fromRepl*/) {
+            BSONElement e = jsobj.firstElement();
+            string ns = dbname + '.' + e.valuestr();
+            NamespaceDetails* d = nsdetails(ns);
+            if ( !d ) {
+                errmsg = "ns not found";
+                return false;
+            }
+            MONGO_TLOG(0) << "CMD: batchIndexes " << ns << endl;
+            BackgroundOperation::assertNoBgOpInProgForNs(ns.c_str());
+
+            // resolve and validate everything before changing anything
+
+            vector<int> toDrop;
+            if ( jsobj["drop"].type() == Array ) {
+                BSONObjIterator it( jsobj["drop"].Obj() );
+                while ( it.more() ) {
+                    BSONElement f = it.next();
+                    int idxNo;
+                    if ( f.type() == String ) {
+                        idxNo = d->findIndexByName( f.valuestr() );
+                    }
+                    else if ( f.type() == Object ) {
+                        idxNo = d->findIndexByKeyPattern( f.embeddedObject() );
+                    }
+                    else {
+                        errmsg = "drop entries must be index names or key patterns";
+                        return false;
+                    }
+                    if ( idxNo < 0 ) {
+                        errmsg = str::stream() << "index not found: " << f.toString( false );
+                        return false;
+                    }
+                    if ( d->idx( idxNo ).isIdIndex() ) {
+                        errmsg = "may not drop _id index";
+                        return false;
+                    }
+                    if ( std::find( toDrop.begin(), toDrop.end(), idxNo ) == toDrop.end() )
+                        toDrop.push_back( idxNo );
+                }
+            }
+
+            list<BSONObj> toCreate;
+            if ( jsobj["create"].type() == Array ) {
+                BSONObjIterator it( jsobj["create"].Obj() );
+                while ( it.more() ) {
+                    BSONElement f = it.next();
+                    if ( f.type() != Object ) {
+                        errmsg = "create entries must be index spec objects";
+                        return false;
+                    }
+                    BSONObj spec = f.embeddedObject();
+                    if ( spec.getObjectField("key").isEmpty() ) {
+                        errmsg = str::stream() << "bad index key spec: " << spec.toString();
+                        return false;
+                    }
+                    if ( spec["background"].trueValue() ) {
+                        // the point of the batch is to stay inside one lock scope
+                        errmsg = "background index builds cannot be batched";
+                        return false;
+                    }
+                    BSONElement nsElt = spec["ns"];
+                    if ( nsElt.eoo() ) {
+                        BSONObjBuilder b;
+                        b.appendElements( spec );
+                        b.append( "ns", ns );
+                        spec = b.obj();
+                    }
+                    else if ( nsElt.type() != String || nsElt.valuestr() != ns ) {
+                        errmsg = str::stream() << "spec ns doesn't match: " << spec.toString();
+                        return false;
+                    }
+                    toCreate.push_back( spec );
+                }
+            }
+
+            if ( toDrop.empty() && toCreate.empty() ) {
+                errmsg = "nothing to do; specify drop and/or create arrays";
+                return false;
+            }
+
+            stopIndexBuilds(dbname, jsobj);
+
+            result.appendNumber( "nIndexesWas", d->getCompletedIndexCount() );
+
+            if ( !toDrop.empty() ) {
+                // there may be pointers pointing at keys in the btree(s).  kill them.
+                ClientCursor::invalidate(ns.c_str());
+                d->removeIndexes( toDrop );
+            }
+
+            if ( !toCreate.empty() ) {
+                // one scan of the collection feeds the sort phase of every plain
+                // btree create; entries stay NULL for specs taking the normal path
+                vector< shared_ptr<SortPhaseOne> > phases;
+                precalcIndexPhaseOnes( toCreate, false, &phases );
+
+                string systemIndexes = dbname + ".system.indexes";
+                size_t specNum = 0;
+                for ( list<BSONObj>::iterator i = toCreate.begin();
+                      i != toCreate.end();
+                      ++i, ++specNum ) {
+                    BSONObj spec = *i;
+                    scoped_lock precalcLock(theDataFileMgr._precalcedMutex);
+                    try {
+                        theDataFileMgr.setPrecalced(phases[specNum].get());
+                        theDataFileMgr.insertWithObjMod( systemIndexes.c_str(), spec, false, true );
+                        theDataFileMgr.setPrecalced(NULL);
+                    }
+                    catch (...) {
+                        theDataFileMgr.setPrecalced(NULL);
+                        throw;
+                    }
+                }
+            }
+
+            result.append( "nDropped", (int)toDrop.size() );
+            result.append( "nCreated", (int)toCreate.size() );
+            return true;
+        }
+    } cmdBatchIndexes;
+
     class CmdListDatabases : public Command {
     public:
         virtual bool slaveOk() const {
@@ -1224,7 +1384,8 @@ namespace mongo {
         virtual LockType locktype() const { return READ; }
         virtual void help( stringstream &help ) const {
             help << "{ collStats:\"blog.posts\" , scale : 1 } scale divides sizes e.g. for KB use 1024\n"
-                    "    avgObjSize - in bytes";
+                    "    avgObjSize - in bytes\n"
+                    "    exact:true walks the extent chain rather than using cached storage sizes";
         }
         virtual void addRequiredPrivileges(const std::string& dbname,
                                            const BSONObj& cmdObj,
@@ -1269,7 +1430,15 @@ namespace mongo {
             int numExtents;
             BSONArrayBuilder extents;
 
-            result.appendNumber( "storageSize" , nsd->storageSize( &numExtents , verbose ? &extents : 0  ) / scale );
+            long long storageSize;
+            if ( verbose || jsobj["exact"].trueValue() ) {
+                // the per-extent detail requires the walk anyway
+                storageSize = nsd->storageSize( &numExtents , verbose ? &extents : 0 );
+            }
+            else {
+                storageSize = NamespaceDetailsTransient::get( ns.c_str() ).storageSize( nsd, &numExtents );
+            }
+            result.appendNumber( "storageSize" , storageSize / scale );
             result.append( "numExtents" , numExtents );
             result.append( "nindexes" , nsd->getCompletedIndexCount() );
             result.append( "lastExtentSize" , nsd->lastExtentSize() / scale );
@@ -1286,8 +1455,15 @@ namespace mongo {
                 result.appendNumber( "max" , nsd->maxCappedDocs() );
             }
 
-            if ( verbose )
+            if ( verbose ) {
                 result.appendArray( "extents" , extents.arr() );
+                if ( !nsd->isCapped() ) {
+                    // how the free space is distributed over allocation size classes
+                    BSONObjBuilder deleted( result.subobjStart( "deletedRecords" ) );
+                    nsd->appendDeletedRecordStats( deleted, scale );
+                    deleted.done();
+                }
+            }
 
             return true;
         }
@@ -1303,7 +1479,9 @@ namespace mongo {
             help << 
                 "Sets collection options.\n"
                 "Example: { collMod: 'foo', usePowerOf2Sizes:true }\n"
-                "Example: { collMod: 'foo', index: {keyPattern: {a: 1}, expireAfterSeconds: 600} }";
+                "Example: { collMod: 'foo', index: {keyPattern: {a: 1}, expireAfterSeconds: 600} }\n"
+                "frozen:true marks a collection read-only so cold data stays densely packed;\n"
+                "run compact afterwards to rewrite existing records without padding.";
         }
         virtual void addRequiredPrivileges(const std::string& dbname,
                                            const BSONObj& cmdObj,
@@ -1342,6 +1520,42 @@ namespace mongo {
                         result.appendBool( "usePowerOf2Sizes_new", newPowerOf2 );
                     }
                 }
+                else if ( str::equals( "useFineGrainedSizes", e.fieldName() ) ) {
+                    bool oldFine = nsd->isUserFlagSet(NamespaceDetails::Flag_UseFineGrainedSizes);
+                    bool newFine = e.trueValue();
+
+                    if ( oldFine != newFine ) {
+                        // change userFlags
+                        result.appendBool( "useFineGrainedSizes_old", oldFine );
+
+                        newFine ? nsd->setUserFlag( NamespaceDetails::Flag_UseFineGrainedSizes ) :
+                                  nsd->clearUserFlag( NamespaceDetails::Flag_UseFineGrainedSizes );
+                        nsd->syncUserFlags( ns ); // must keep system.namespaces up-to-date
+
+                        result.appendBool( "useFineGrainedSizes_new", newFine );
+                    }
+                }
+                else if ( str::equals( "frozen", e.fieldName() ) ) {
+                    bool oldFrozen = nsd->isUserFlagSet(NamespaceDetails::Flag_Frozen);
+                    bool newFrozen = e.trueValue();
+
+                    if ( oldFrozen != newFrozen ) {
+                        result.appendBool( "frozen_old", oldFrozen );
+
+                        if ( newFrozen ) {
+                            nsd->setUserFlag( NamespaceDetails::Flag_Frozen );
+                            // nothing will ever grow in place again, so future
+                            // allocations (e.g. from a compact) need no padding
+                            nsd->setPaddingFactor( 1.0 );
+                        }
+                        else {
+                            nsd->clearUserFlag( NamespaceDetails::Flag_Frozen );
+                        }
+                        nsd->syncUserFlags( ns ); // must keep system.namespaces up-to-date
+
+                        result.appendBool( "frozen_new", newFrozen );
+                    }
+                }
                 else if ( str::equals( "index", e.fieldName() ) ) {
                     BSONObj indexObj = e.Obj();
                     BSONObj keyPattern = indexObj.getObjectField( "keyPattern" );
@@ -1409,8 +1623,9 @@ namespace mongo {
         virtual LockType locktype() const { return READ; }
         virtual void help( stringstream &help ) const {
             help << 
-                "Get stats on a database. Not instantaneous. Slower for databases with large .ns files.\n" << 
-                "Example: { dbStats:1, scale:1 }";
+                "Get stats on a database. Not instantaneous. Slower for databases with large .ns files.\n" <<
+                "Example: { dbStats:1, scale:1 }\n"
+                "exact:true walks each collection's extent chain rather than using cached storage sizes";
         }
         virtual void addRequiredPrivileges(const std::string& dbname,
                                            const BSONObj& cmdObj,
@@ -1433,6 +1648,8 @@ namespace mongo {
                 return false;
             }
 
+            bool exact = jsobj["exact"].trueValue();
+
             list<string> collections;
             Database* d = cc().database();
             if ( d )
@@ -1461,7 +1678,10 @@ namespace mongo {
                 size += nsd->dataSize();
 
                 int temp;
-                storageSize += nsd->storageSize( &temp );
+                if ( exact )
+                    storageSize += nsd->storageSize( &temp );
+                else
+                    storageSize += NamespaceDetailsTransient::get( ns.c_str() ).storageSize( nsd, &temp );
                 numExtents += temp;
 
                 indexes += nsd->getCompletedIndexCount();
@@ -52,6 +52,7 @@
 #include "mongo/db/storage_options.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/s/d_logic.h"
+#include "mongo/util/elapsed_tracker.h"
 
 namespace mongo {
 
@@ -336,67 +337,83 @@ namespace mongo {
         
         long long millisWaitingForReplication = 0;
 
-        while ( 1 ) {
+        // Process the range in batches: each write lock acquisition covers up to
+        // rangeDeleteBatchDocs deletes or rangeDeleteBatchMillis of work, whichever
+        // comes first, instead of relocking around every document.  Between batches
+        // we stay out of the way of foreground operations (see below).
+        const int rangeDeleteBatchDocs = 100;
+        const int rangeDeleteBatchMillis = 10;
+
+        bool done = false;
+        while ( !done ) {
+            const long long acquiringBefore =
+                    Lock::globalLockStat()->getTimeAcquiring( 'w' ) +
+                    Lock::globalLockStat()->getTimeAcquiring( 'W' );
+
             // Scoping for write lock.
             {
                 Client::WriteContext ctx(ns);
-
-                NamespaceDetails* nsd = nsdetails( ns );
-                if (NULL == nsd) { break; }
-                int ii = nsd->findIndexByKeyPattern( indexKeyPattern.toBSON() );
-
-                auto_ptr<Runner> runner(InternalPlanner::indexScan(ns, nsd, ii, min, max,
-                                                                   maxInclusive,
-                                                                   InternalPlanner::FORWARD,
-                                                                   InternalPlanner::IXSCAN_FETCH));
-
-                runner->setYieldPolicy(Runner::YIELD_AUTO);
-
-                DiskLoc rloc;
-                BSONObj obj;
-                Runner::RunnerState state;
-                // This may yield so we cannot touch nsd after this.
-                state = runner->getNext(&obj, &rloc);
-                runner.reset();
-                if (Runner::RUNNER_EOF == state) { break; }
-
-                if ( onlyRemoveOrphanedDocs ) {
-                    // Do a final check in the write lock to make absolutely sure that our
-                    // collection hasn't been modified in a way that invalidates our migration
-                    // cleanup.
-
-                    // We should never be able to turn off the sharding state once enabled, but
-                    // in the future we might want to.
-                    verify(shardingState.enabled());
-
-                    // In write lock, so will be the most up-to-date version
-                    CollectionMetadataPtr metadataNow = shardingState.getCollectionMetadata( ns );
-
-                    bool docIsOrphan;
-                    if ( metadataNow ) {
-                        KeyPattern kp( metadataNow->getKeyPattern() );
-                        BSONObj key = kp.extractSingleKey( obj );
-                        docIsOrphan = !metadataNow->keyBelongsToMe( key )
-                            && !metadataNow->keyIsPending( key );
-                    }
-                    else {
-                        docIsOrphan = false;
+                ElapsedTracker batchTracker( rangeDeleteBatchDocs, rangeDeleteBatchMillis );
+
+                do {
+                    NamespaceDetails* nsd = nsdetails( ns );
+                    if (NULL == nsd) { done = true; break; }
+                    int ii = nsd->findIndexByKeyPattern( indexKeyPattern.toBSON() );
+
+                    auto_ptr<Runner> runner(InternalPlanner::indexScan(ns, nsd, ii, min, max,
+                                                                       maxInclusive,
+                                                                       InternalPlanner::FORWARD,
+                                                                       InternalPlanner::IXSCAN_FETCH));
+
+                    runner->setYieldPolicy(Runner::YIELD_AUTO);
+
+                    DiskLoc rloc;
+                    BSONObj obj;
+                    Runner::RunnerState state;
+                    // This may yield so we cannot touch nsd after this.
+                    state = runner->getNext(&obj, &rloc);
+                    runner.reset();
+                    if (Runner::RUNNER_EOF == state) { done = true; break; }
+
+                    if ( onlyRemoveOrphanedDocs ) {
+                        // Do a final check in the write lock to make absolutely sure that our
+                        // collection hasn't been modified in a way that invalidates our migration
+                        // cleanup.
+
+                        // We should never be able to turn off the sharding state once enabled, but
+                        // in the future we might want to.
+                        verify(shardingState.enabled());
+
+                        // In write lock, so will be the most up-to-date version
+                        CollectionMetadataPtr metadataNow = shardingState.getCollectionMetadata( ns );
+
+                        bool docIsOrphan;
+                        if ( metadataNow ) {
+                            KeyPattern kp( metadataNow->getKeyPattern() );
+                            BSONObj key = kp.extractSingleKey( obj );
+                            docIsOrphan = !metadataNow->keyBelongsToMe( key )
+                                && !metadataNow->keyIsPending( key );
+                        }
+                        else {
+                            docIsOrphan = false;
+                        }
+
+                        if ( !docIsOrphan ) {
+                            warning() << "aborting migration cleanup for chunk " << min << " to " << max
+                                      << ( metadataNow ? (string) " at document " + obj.toString() : "" )
+                                      << ", collection " << ns << " has changed " << endl;
+                            done = true;
+                            break;
+                        }
                     }
 
-                    if ( !docIsOrphan ) {
-                        warning() << "aborting migration cleanup for chunk " << min << " to " << max
-                                  << ( metadataNow ? (string) " at document " + obj.toString() : "" )
-                                  << ", collection " << ns << " has changed " << endl;
-                        break;
-                    }
-                }
+                    if ( callback )
+                        callback->goingToDelete( obj );
 
-                if ( callback )
-                    callback->goingToDelete( obj );
-
-                logOp("d", ns.c_str(), obj["_id"].wrap(), 0, 0, fromMigrate);
-                c.database()->getCollection( ns )->deleteDocument( rloc );
-                numDeleted++;
+                    logOp("d", ns.c_str(), obj["_id"].wrap(), 0, 0, fromMigrate);
+                    c.database()->getCollection( ns )->deleteDocument( rloc );
+                    numDeleted++;
+                } while ( !batchTracker.intervalHasElapsed() );
             }
 
             Timer secondaryThrottleTime;
@@ -407,11 +424,23 @@ namespace mongo {
                 }
                 millisWaitingForReplication += secondaryThrottleTime.millis();
             }
-            
-            if ( ! Lock::isLocked() ) {
-                int micros = ( 2 * Client::recommendedYieldMicros() ) - secondaryThrottleTime.micros();
+
+            if ( !done && ! Lock::isLocked() ) {
+                // Adaptive throttle: sleep for at least as long as writers spent
+                // queueing on the global lock while we held our batch, so cleanup
+                // backs off in proportion to the contention it is causing, capped
+                // so it always keeps making progress.
+                long long waitedMicros =
+                        Lock::globalLockStat()->getTimeAcquiring( 'w' ) +
+                        Lock::globalLockStat()->getTimeAcquiring( 'W' ) - acquiringBefore;
+                long long micros = 2 * Client::recommendedYieldMicros();
+                if ( waitedMicros > micros )
+                    micros = waitedMicros;
+                if ( micros > 500 * 1000 )
+                    micros = 500 * 1000;
+                micros -= secondaryThrottleTime.micros();
                 if ( micros > 0 ) {
-                    LOG(1) << "Helpers::removeRangeUnlocked going to sleep for " << micros << " micros" << endl;
+                    LOG(1) << "Helpers::removeRange going to sleep for " << micros << " micros" << endl;
                     sleepmicros( micros );
                 }
             }
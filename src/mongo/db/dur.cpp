@@ -84,8 +84,10 @@
 #include "mongo/util/concurrency/race.h"
 #include "mongo/util/mongoutils/hash.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/numa.h"
 #include "mongo/util/stacktrace.h"
 #include "mongo/util/timer.h"
+#include "mongo/util/trace_point.h"
 
 using namespace mongoutils;
 
@@ -154,7 +156,9 @@ namespace mongo {
                        "writeToDataFilesMB" << _writeToDataFilesBytes / 1000000.0 <<
                        "compression" << _journaledBytes / (_uncompressedBytes+1.0) <<
                        "commitsInWriteLock" << _commitsInWriteLock <<
-                       "earlyCommits" << _earlyCommits << 
+                       "earlyCommits" << _earlyCommits <<
+                       "commitWaiters" << _commitWaiters <<
+                       "commitQueueDepth" << _commitQueueDepth <<
                        "timeMs" <<
                        BSON( "dt" << _dtMillis <<
                              "prepLogBuffer" << (unsigned) (_prepLogBufferMicros/1000) <<
@@ -524,6 +528,13 @@ namespace mongo {
             unsigned startedAt = startAt;
             startAt = (startAt + ntodo) % sz; // mark where to start next time
 
+            // cap the bytes remapped per pass.  the real cost of a remap is the
+            // copy-on-write faults taken afterwards, so when a burst of writes dirtied
+            // large spans we spread the remapping over several commit cycles rather
+            // than taking one big stall.
+            const size_t remapBytesBudget = 512 * 1024 * 1024;
+            size_t remappedBytes = 0;
+
             Timer t;
             for( unsigned x = 0; x < ntodo; x++ ) {
                 dassert( i != e );
@@ -532,22 +543,32 @@ namespace mongo {
                     verify(mmf);
                     if( mmf->willNeedRemap() ) {
                         mmf->willNeedRemap() = false;
-                        mmf->remapThePrivateView();
+                        remappedBytes += mmf->remapThePrivateView();
                     }
                     i++;
                     if( i == e ) i = b;
+                    if( remappedBytes >= remapBytesBudget && x + 1 < ntodo ) {
+                        // out of budget; resume here next pass
+                        startAt = (startedAt + x + 1) % sz;
+                        ntodo = x + 1;
+                        break;
+                    }
                 }
             }
-            LOG(2) << "journal REMAPPRIVATEVIEW done startedAt: " << startedAt << " n:" << ntodo << ' ' << t.millis() << "ms" << endl;
+            LOG(2) << "journal REMAPPRIVATEVIEW done startedAt: " << startedAt << " n:" << ntodo
+                   << " bytes:" << remappedBytes << ' ' << t.millis() << "ms" << endl;
         }
 
         /** We need to remap the private views periodically. otherwise they would become very large.
             Call within write lock.  See top of file for more commentary.
         */
         void REMAPPRIVATEVIEW() {
+            MONGO_TRACE_POINT( "dur/remapprivateview", 0, 0 );
             Timer t;
             _REMAPPRIVATEVIEW();
-            stats.curr->_remapPrivateViewMicros += t.micros();
+            const unsigned long long m = t.micros();
+            stats.curr->_remapPrivateViewMicros += m;
+            MONGO_TRACE_POINT( "dur/remapprivateview/done", 0, m );
         }
 
         // this is a pseudo-local variable in the groupcommit functions 
@@ -555,24 +576,198 @@ namespace mongo {
         // reallocate, and more importantly regrow it, on every single commit.
         static AlignedBuilder __theBuilder(4 * 1024 * 1024);
 
+        // when this many getlasterror j:true waiters have queued, the journal thread commits
+        // immediately rather than waiting out journalCommitInterval, so one fsync satisfies
+        // the whole batch
+        static const unsigned GroupCommitWaiterThreshold = 16;
+
+        /** account for the j:true waiters this commit will satisfy.
+            locking: call with groupCommitMutex held, just after commitingBegin().
+        */
+        static void noteCommitBatch() {
+            unsigned waiters = commitJob._notify.nWaiting();
+            stats.curr->_commitWaiters += waiters;
+            if( waiters > stats.curr->_commitQueueDepth )
+                stats.curr->_commitQueueDepth = waiters;
+        }
+
+        /** Double buffering for the limited-locks commit path.  The durThread prepares
+            a log buffer, hands it off here, and goes back to batching the next group
+            commit while this thread flushes the one in flight: it writes and syncs the
+            journal (the durability point, so it is also the one that notifies the
+            getlasterror j:true waiters), applies the buffer to the shared view, and
+            recycles it.  Building the next buffer thus overlaps the previous fsync, so
+            journal throughput tracks the device rather than (prep + fsync) round-trips.
+
+            concurrency notes:
+            - there are two builders; at most one is being flushed while the other is
+              being prepared.  only the durThread calls getFreeBuffer()/submit().
+            - we take LockMongoFilesShared ourselves for the data file writes.  a data
+              file cannot go away underneath us: DurableMappedFile::close() group
+              commits (under the global write lock, which excludes a new PREPLOGBUFFER)
+              before unmapping, and _groupCommit() drains us first.
+            - the synchronous _groupCommit() path and shutdown must call drain() before
+              touching the journal or remapping so section ordering is preserved.
+        */
+        class JournalWriter : boost::noncopyable {
+        public:
+            JournalWriter() : _mutex("journalWriter"),
+                              _b0(4 * 1024 * 1024),
+                              _b1(4 * 1024 * 1024),
+                              _pendingBuffer(0),
+                              _busy(false),
+                              _running(false),
+                              _stop(false) {
+                _free[0] = &_b0;
+                _free[1] = &_b1;
+                _nFree = 2;
+            }
+
+            /** an empty builder to PREPLOGBUFFER into.  waits, outside any lock others
+                care about, if both buffers are still being flushed.  the buffer stays
+                "free" until submitted, so an early return is harmless. */
+            AlignedBuilder& getFreeBuffer() {
+                scoped_lock lk(_mutex);
+                while( _nFree == 0 )
+                    _recycled.wait(lk.boost());
+                return *_free[_nFree-1];
+            }
+
+            /** queue the prepared buffer for flushing and return immediately.  the
+                caller must not touch ab afterwards; commitNumber's waiters are notified
+                once the buffer is in the journal on disk. */
+            void submit(const JSectHeader& h, AlignedBuilder& ab, NotifyAll::When commitNumber) {
+                scoped_lock lk(_mutex);
+                verify( _nFree > 0 && _free[_nFree-1] == &ab );
+                verify( !_pendingBuffer );
+                _nFree--;
+                _pendingHeader = h;
+                _pendingBuffer = &ab;
+                _pendingCommitNumber = commitNumber;
+                if( !_running ) {
+                    _running = true;
+                    boost::thread t(boost::bind(&JournalWriter::loop, this));
+                }
+                _submitted.notify_one();
+            }
+
+            /** block until nothing is queued or in flight */
+            void drain() {
+                scoped_lock lk(_mutex);
+                while( _pendingBuffer || _busy )
+                    _recycled.wait(lk.boost());
+            }
+
+            /** drain, then stop the writer thread.  only the durThread submits,
+                and it calls this as it exits, so nothing arrives afterwards. */
+            void shutdown() {
+                scoped_lock lk(_mutex);
+                while( _pendingBuffer || _busy )
+                    _recycled.wait(lk.boost());
+                _stop = true;
+                _submitted.notify_one();
+            }
+
+        private:
+            void loop() {
+                Client::initThread("journalWriter");
+                while( 1 ) {
+                    JSectHeader h;
+                    AlignedBuilder *ab;
+                    NotifyAll::When commitNumber;
+                    {
+                        scoped_lock lk(_mutex);
+                        while( !_pendingBuffer && !_stop )
+                            _submitted.wait(lk.boost());
+                        if( !_pendingBuffer ) {
+                            // stopped and idle; allow a lazy restart just in case
+                            _stop = false;
+                            _running = false;
+                            break;
+                        }
+                        h = _pendingHeader;
+                        ab = _pendingBuffer;
+                        commitNumber = _pendingCommitNumber;
+                        _pendingBuffer = 0;
+                        _busy = true;
+                    }
+
+                    try {
+                        LockMongoFilesShared lk3;
+
+                        const unsigned abLen = ab->len();
+                        WRITETOJOURNAL(h, *ab);
+                        verify( abLen == ab->len() ); // no one else should ever touch our buffer
+
+                        // data is now in the journal, which is sufficient for acknowledging
+                        // getLastError. (ok to crash after that)
+                        // we notify the epoch we were handed -- durThread may have already
+                        // called commitingBegin() for the next commit.
+                        commitJob._notify.notifyAll(commitNumber);
+
+                        WRITETODATAFILES(h, *ab);
+                        verify( abLen == ab->len() );
+                        ab->reset();
+                    }
+                    catch(std::exception& e) {
+                        log() << "exception in journal writer thread causing immediate shutdown: " << e.what() << endl;
+                        mongoAbort("journalWriter");
+                    }
+
+                    {
+                        scoped_lock lk(_mutex);
+                        verify( _nFree < 2 );
+                        _free[_nFree++] = ab;
+                        _busy = false;
+                        _recycled.notify_all();
+                    }
+                }
+                cc().shutdown();
+            }
+
+            mongo::mutex _mutex;
+            boost::condition _submitted; // durThread -> writer: a buffer is pending
+            boost::condition _recycled;  // writer -> durThread: a buffer was freed
+
+            AlignedBuilder _b0, _b1;
+            AlignedBuilder* _free[2]; // used as a stack; protected by _mutex
+            int _nFree;
+
+            JSectHeader _pendingHeader;
+            AlignedBuilder* _pendingBuffer;
+            NotifyAll::When _pendingCommitNumber;
+            bool _busy;    // the writer is flushing a buffer it already dequeued
+            bool _running; // thread started (lazily, on first submit)
+            bool _stop;    // shutdown(): exit the loop once nothing is pending
+        };
+
+        static JournalWriter journalWriter;
+
         static bool _groupCommitWithLimitedLocks() {
             unspoolWriteIntents(); // in case we were doing some writing ourself (likely impossible with limitedlocks version)
-            AlignedBuilder &ab = __theBuilder;
 
             verify( ! Lock::isLocked() );
 
+            // if both buffers are still being flushed, wait here, before taking locks
+            // anyone else cares about
+            AlignedBuilder &ab = journalWriter.getFreeBuffer();
+
             // do we need this to be greedy, so that it can start working fairly soon?
             // probably: as this is a read lock, it wouldn't change anything if only reads anyway.
-            // also needs to stop greed. our time to work before clearing lk1 is not too bad, so 
+            // also needs to stop greed. our time to work before clearing lk1 is not too bad, so
             // not super critical, but likely 'correct'.  todo.
             scoped_ptr<Lock::GlobalRead> lk1( new Lock::GlobalRead() );
 
             SimpleMutex::scoped_lock lk2(commitJob.groupCommitMutex);
 
             commitJob.commitingBegin(); // increments the commit epoch for getlasterror j:true
+            noteCommitBatch();
 
             if( !commitJob.hasWritten() ) {
-                // getlasterror request could have came after the data was already committed
+                // getlasterror request could have came after the data was already committed.
+                // wait out any in-flight flush first: notifying our (higher) commit number
+                // would otherwise tell waiters the older, still-being-written commit is down.
+                journalWriter.drain();
                 commitJob.committingNotifyCommitted();
                 return true;
             }
@@ -580,31 +775,18 @@ namespace mongo {
             JSectHeader h;
             PREPLOGBUFFER(h,ab); // need to be in readlock (writes excluded) for this
 
-            LockMongoFilesShared lk3;
-
-            unsigned abLen = ab.len();
             commitJob.committingReset(); // must be reset before allowing anyone to write
             DEV verify( !commitJob.hasWritten() );
 
-            // release the readlock -- allowing others to now write while we are writing to the journal (etc.)
+            // release the readlock -- allowing others to now write while the journal writer
+            // flushes the buffer.  we don't wait for the flush: the next pass through here
+            // prepares the other buffer while this one is in flight, and the writer thread
+            // notifies the j:true waiters when the data is down.
             lk1.reset();
 
             // ****** now other threads can do writes ******
 
-            WRITETOJOURNAL(h, ab);
-            verify( abLen == ab.len() ); // a check that no one touched the builder while we were doing work. if so, our locking is wrong.
-
-            // data is now in the journal, which is sufficient for acknowledging getLastError.
-            // (ok to crash after that)
-            commitJob.committingNotifyCommitted();
-
-            // note the higher-up-the-chain locking of filesLockedFsync is important here, 
-            // as we are not in Lock::GlobalRead anymore. private view readers won't see 
-            // anything as we do this, but external viewers of the datafiles will see them 
-            // mutating.
-            WRITETODATAFILES(h, ab);
-            verify( abLen == ab.len() ); // check again wasn't modded
-            ab.reset();
+            journalWriter.submit(h, ab, commitJob.commitNumber());
 
             // can't : d.dbMutex._remapPrivateViewRequested = true;
             // (writes have happened we released)
@@ -642,6 +824,13 @@ namespace mongo {
             // We are 'R' or 'W'
             assertLockedForCommitting();
 
+            // a buffer handed off by the limited-locks path may still be in flight.
+            // wait it out so journal sections stay ordered, our notify doesn't outrun
+            // its flush, and REMAPPRIVATEVIEW below can't run before its
+            // WRITETODATAFILES.  (this is also what makes it safe for a closing
+            // DurableMappedFile, which group commits through here, to unmap.)
+            journalWriter.drain();
+
             unspoolWriteIntents(); // in case we were doing some writing ourself
 
             {
@@ -652,6 +841,7 @@ namespace mongo {
                 SimpleMutex::scoped_lock lk(commitJob.groupCommitMutex);
 
                 commitJob.commitingBegin();
+                noteCommitBatch();
 
                 if( !commitJob.hasWritten() ) {
                     // getlasterror request could have came after the data was already committed
@@ -744,21 +934,36 @@ namespace mongo {
         static void durThreadGroupCommit() {
             SimpleMutex::scoped_lock flk(filesLockedFsync);
 
+            // every Nth commit we remap private views so they don't grow without bound;
+            // remapping a lot all at once could cause jitter from a large amount of
+            // copy-on-writes all at once, hence doing some every N rather than waiting
+            // for UncommittedBytesLimit.
             const int N = 10;
             static int n;
-            if (privateMapBytes < UncommittedBytesLimit && ++n % N &&
+            const bool remapPass = privateMapBytes >= UncommittedBytesLimit ||
+                (++n % N) == 0 ||
                 (storageGlobalParams.durOptions &
-                 StorageGlobalParams::DurAlwaysRemap) == 0) {
-                // limited locks version doesn't do any remapprivateview at all, so only try this if privateMapBytes
-                // is in an acceptable range.  also every Nth commit, we do everything so we can do some remapping;
-                // remapping a lot all at once could cause jitter from a large amount of copy-on-writes all at once.
-                if( groupCommitWithLimitedLocks() )
+                 StorageGlobalParams::DurAlwaysRemap) != 0;
+
+            if( groupCommitWithLimitedLocks() ) {
+                if( !remapPass )
                     return;
+
+                // the batch is now flushing on the journal writer thread with writers
+                // free to proceed -- they are not stalled behind the journal fsync the
+                // way they were when the remap pass journaled inline under the read
+                // lock.  wait the flush out with no locks held, then take the write
+                // lock only for the (usually tiny) remainder commit and
+                // REMAPPRIVATEVIEW itself.
+                journalWriter.drain();
+                Lock::GlobalWrite w(/*stopgreed:*/true);
+                groupCommit(0);
+                return;
             }
 
             // we get a write lock, downgrade, do work, upgrade, finish work.
             // getting a write lock is helpful also as we need to be greedy and not be starved here
-            // note our "stopgreed" parm -- to stop greed by others while we are working. you can't write 
+            // note our "stopgreed" parm -- to stop greed by others while we are working. you can't write
             // anytime soon anyway if we are journaling for a while, that was the idea.
             Lock::GlobalWrite w(/*stopgreed:*/true);
             w.downgrade();
@@ -786,9 +991,27 @@ namespace mongo {
         extern int groupCommitIntervalMs;
         boost::filesystem::path getJournalDir();
 
+        // shutdown handshake: durThread drains and stops the journal writer before
+        // it exits, and flips durThreadDone.  see waitForJournalThreadsToStop().
+        static bool durThreadStarted = false;
+        static bool durThreadDone = false;
+        static mongo::mutex durThreadDoneMutex("durThreadDone");
+        static boost::condition durThreadDoneCondition;
+
+        void waitForJournalThreadsToStop() {
+            scoped_lock lk(durThreadDoneMutex);
+            if( !durThreadStarted )
+                return; // shutting down before dur::startup() ran
+            while( !durThreadDone )
+                durThreadDoneCondition.wait(lk.boost());
+        }
+
         void durThread() {
             Client::initThread("journal");
 
+            if( numaBindThreadToNode( numaDurabilityNode ) )
+                log() << "journal thread bound to NUMA node " << numaDurabilityNode << endl;
+
             bool samePartition = true;
             try {
                 const std::string dbpathDir =
@@ -812,14 +1035,21 @@ namespace mongo {
                 try {
                     stats.rotate();
 
-                    // commit sooner if one or more getLastError j:true is pending
-                    sleepmillis(oneThird);
-                    for( unsigned i = 1; i <= 2; i++ ) {
-                        if( commitJob._notify.nWaiting() )
+                    // commit sooner if one or more getLastError j:true is pending, and
+                    // commit immediately once enough waiters or bytes have queued that one
+                    // fsync can satisfy a whole batch of them (adaptive group commit) --
+                    // under bursty loads this keeps the waiter queue from building up in
+                    // lock-step with the timer
+                    unsigned slept = 0;
+                    while( slept < ms ) {
+                        sleepmillis(1);
+                        slept++;
+                        if( commitJob._notify.nWaiting() >= GroupCommitWaiterThreshold )
+                            break;
+                        if( commitJob.bytes() > UncommittedBytesLimit / 2 )
                             break;
-                        if( commitJob.bytes() > UncommittedBytesLimit / 2  )
+                        if( slept >= oneThird && commitJob._notify.nWaiting() )
                             break;
-                        sleepmillis(oneThird);
                     }
                                         
                     //DEV log() << "privateMapBytes=" << privateMapBytes << endl;
@@ -831,6 +1061,18 @@ namespace mongo {
                     mongoAbort("exception in durThread");
                 }
             }
+
+            // don't leave a buffer in flight as the rest of shutdown closes files:
+            // a flush needs LockMongoFilesShared to finish, and closeAllFiles holds
+            // the exclusive lock while closing.  this also stops the writer thread.
+            journalWriter.shutdown();
+
+            {
+                scoped_lock lk(durThreadDoneMutex);
+                durThreadDone = true;
+                durThreadDoneCondition.notify_all();
+            }
+
             cc().shutdown();
         }
 
@@ -881,6 +1123,10 @@ namespace mongo {
 
             preallocateFiles();
 
+            {
+                scoped_lock lk(durThreadDoneMutex);
+                durThreadStarted = true;
+            }
             boost::thread t(durThread);
         }
 
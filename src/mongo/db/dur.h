@@ -53,6 +53,15 @@ namespace mongo {
          */
         void startup();
 
+        /** Shutdown: block until the durability thread (and the journal writer
+            thread it feeds) have flushed their last buffer and exited.  Must be
+            called before MongoFile::closeAllFiles -- a journal writer flush needs
+            LockMongoFilesShared to finish, so a buffer left in flight would
+            deadlock against the close's exclusive lock.
+            Returns immediately if the durability thread was never started.
+         */
+        void waitForJournalThreadsToStop();
+
         class DurableInterface : boost::noncopyable {
         public:
             virtual ~DurableInterface() { log() << "ERROR warning ~DurableInterface not intended to be called" << endl; }
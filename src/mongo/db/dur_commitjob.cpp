@@ -32,6 +32,8 @@
 
 #include "mongo/db/dur_commitjob.h"
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/db/client.h"
 #include "mongo/db/dur_stats.h"
 #include "mongo/db/taskqueue.h"
@@ -54,6 +56,14 @@ namespace mongo {
             if( !commitJob._hasWritten )
                 commitJob._hasWritten = true;
 
+            // a document is typically declared in several consecutive pieces, so the
+            // new intent very often touches the previous one.  merge inline rather
+            // than letting near-duplicates pile up until condense() sorts them out.
+            if( !intents.empty() && intents.back().overlaps( x ) ) {
+                intents.back().absorb( x );
+                return;
+            }
+
             if( intents.size() == N ) {
                 if ( !condense() ) {
                     unspool();
@@ -212,6 +222,34 @@ namespace mongo {
             _nSinceCommitIfNeededCall = 0;
         }
 
+        // update-heavy workloads can queue hundreds of thousands of intents in one
+        // group commit, and sorting them is a meaningful slice of PREPLOGBUFFER cpu.
+        // above this size sort the two halves concurrently and merge; two threads is
+        // about the right balance (see the Hackenberg reference in
+        // dur_writetodatafiles.cpp).
+        static const size_t parallelSortThreshold = 100 * 1000;
+
+        static void sortIntentRange( vector<WriteIntent>::iterator begin,
+                                     vector<WriteIntent>::iterator end ) {
+            std::sort( begin, end );
+        }
+
+        const vector<WriteIntent>& CommitJob::getIntentsSorted() {
+            groupCommitMutex.dassertLocked();
+            vector<WriteIntent>& v = _intentsAndDurOps._intents;
+            if( v.size() >= parallelSortThreshold ) {
+                vector<WriteIntent>::iterator mid = v.begin() + v.size() / 2;
+                boost::thread t( boost::bind( &sortIntentRange, v.begin(), mid ) );
+                std::sort( mid, v.end() );
+                t.join();
+                std::inplace_merge( v.begin(), mid, v.end() );
+            }
+            else {
+                std::sort( v.begin(), v.end() );
+            }
+            return v;
+        }
+
         void CommitJob::note(void* p, int len) {
             groupCommitMutex.dassertLocked();
 
@@ -168,9 +168,16 @@ namespace mongo {
             /** these called by the groupCommit code as it goes along */
             void commitingBegin();
             /** the commit code calls this when data reaches the journal (on disk) */
-            void committingNotifyCommitted() { 
+            void committingNotifyCommitted() {
                 groupCommitMutex.dassertLocked();
-                _notify.notifyAll(_commitNumber); 
+                _notify.notifyAll(_commitNumber);
+            }
+            /** the epoch commitingBegin() began.  the journal writer thread is handed
+                this so it can notify the right waiters when the buffer for this commit
+                reaches disk -- by then we may have begun the next epoch. */
+            NotifyAll::When commitNumber() const {
+                groupCommitMutex.dassertLocked();
+                return _commitNumber;
             }
             /** we use the commitjob object over and over, calling reset() rather than reconstructing */
             void committingReset() {
@@ -182,14 +189,10 @@ namespace mongo {
             /** we check how much written and if it is getting to be a lot, we commit sooner. */
             size_t bytes() const { return _bytes; }
 
-            /** used in prepbasicwrites. sorted so that overlapping and duplicate items 
-             * can be merged.  we sort here so the caller receives something they must 
+            /** used in prepbasicwrites. sorted so that overlapping and duplicate items
+             * can be merged.  we sort here so the caller receives something they must
              * keep const from their pov. */
-            const vector<WriteIntent>& getIntentsSorted() {
-                groupCommitMutex.dassertLocked();
-                sort(_intentsAndDurOps._intents.begin(), _intentsAndDurOps._intents.end());
-                return _intentsAndDurOps._intents;
-            }
+            const vector<WriteIntent>& getIntentsSorted();
 
             bool _hasWritten;
 
@@ -48,6 +48,8 @@
 #include "mongo/util/checksum.h"
 #include "mongo/util/compress.h"
 #include "mongo/util/concurrency/race.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/crc32c.h"
 #include "mongo/util/file.h"
 #include "mongo/util/logfile.h"
 #include "mongo/util/mmap.h"
@@ -55,6 +57,7 @@
 #include "mongo/util/net/listen.h" // getelapsedtimemillis
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/timer.h"
+#include "mongo/util/trace_point.h"
 
 using namespace mongoutils;
 
@@ -90,6 +93,7 @@ namespace mongo {
         BOOST_STATIC_ASSERT( sizeof(Checksum) == 16 );
         BOOST_STATIC_ASSERT( sizeof(JHeader) == 8192 );
         BOOST_STATIC_ASSERT( sizeof(JSectHeader) == 20 );
+        BOOST_STATIC_ASSERT( sizeof(JBlockHeader) == 12 );
         BOOST_STATIC_ASSERT( sizeof(JSectFooter) == 32 );
         BOOST_STATIC_ASSERT( sizeof(JEntry) == 12 );
         BOOST_STATIC_ASSERT( sizeof(LSNFile) == 88 );
@@ -172,6 +176,7 @@ namespace mongo {
                 fileId = t&0xffffffff;
                 fileId |= static_cast<unsigned long long>( getMySecureRandomNumber() ) << 32;
             }
+            generation = 0; // stamped by Journal when the header is written
             memset(reserved3, 0, sizeof(reserved3));
             txt2[0] = txt2[1] = '\n';
             n1 = n2 = n3 = n4 = '\n';
@@ -185,6 +190,7 @@ namespace mongo {
             _curLogFileMutex("JournalLfMutex") {
             _written = 0;
             _nextFileNumber = 0;
+            _nextGeneration = 1;
             _curLogFile = 0;
             _curFileId = 0;
             _preFlushTime = 0;
@@ -518,6 +524,7 @@ namespace mongo {
                             // JHeader::fileId must be updated before renaming to be race-safe
                             LogFile f(p.string());
                             JHeader h(p.string());
+                            h.generation = _nextGeneration++;
                             AlignedBuilder b(8192);
                             b.appendStruct(h);
                             f.synchronousAppend(b.buf(), b.len());
@@ -535,6 +542,7 @@ namespace mongo {
             _nextFileNumber++;
             {
                 JHeader h(fname.string());
+                h.generation = _nextGeneration++;
                 _curFileId = h.fileId;
                 verify(_curFileId);
                 AlignedBuilder b(8192);
@@ -543,6 +551,45 @@ namespace mongo {
             }
         }
 
+        /** reuse a retired journal file in place.  we stamp a fresh header -- new fileId and
+            generation -- over the old one and append sections from there.  stale sections left
+            in the tail still carry the old fileId, so recovery stops at the first of them.
+            no rename/unlink/truncate happens, so the file keeps its on-disk allocation and
+            rotation is a metadata no-op.  call from within _curLogFileMutex.
+        */
+        void Journal::_openInPlace(const boost::filesystem::path& fname) {
+            _curFileId = 0;
+            verify( _curLogFile == 0 );
+            _curLogFile = new LogFile(fname.string());
+            {
+                JHeader h(fname.string());
+                h.generation = _nextGeneration++;
+                _curFileId = h.fileId;
+                verify(_curFileId);
+                AlignedBuilder b(8192);
+                b.appendStruct(h);
+                _curLogFile->synchronousAppend(b.buf(), b.len());
+            }
+            LOG(1) << "journal file reused in place: " << fname.string() << endl;
+        }
+
+        /** if the oldest retired journal file's sections are all flushed to the datafiles,
+            pop and return its path for in-place reuse; else return an empty path.
+            call from within _curLogFileMutex.
+        */
+        boost::filesystem::path Journal::takeRecyclableJournalFile() {
+            if( !usingPreallocate || _oldJournalFiles.empty() )
+                return boost::filesystem::path();
+            const JFile& f = _oldJournalFiles.front();
+            if( f.lastEventTimeMs >= _lastFlushTime + ExtraKeepTimeMs ) {
+                // its sections might still be needed on recovery
+                return boost::filesystem::path();
+            }
+            boost::filesystem::path p( f.filename );
+            _oldJournalFiles.pop_front();
+            return p;
+        }
+
         void Journal::init() {
             verify( _curLogFile == 0 );
             MongoFile::notifyPreFlush = preFlush;
@@ -697,15 +744,24 @@ namespace mongo {
             if( _curLogFile && _written < DataLimitPerJournalFile )
                 return;
 
+            boost::filesystem::path recycle;
             if( _curLogFile ) {
-                _curLogFile->truncate();
+                recycle = takeRecyclableJournalFile();
+                if( recycle.empty() ) {
+                    // chop the unwritten preallocated tail before retiring the file.  when
+                    // reusing in place we skip this so the file keeps its full allocation.
+                    _curLogFile->truncate();
+                }
                 closeCurrentJournalFile();
                 removeUnneededJournalFiles();
             }
 
             try {
                 Timer t;
-                _open();
+                if( !recycle.empty() )
+                    _openInPlace(recycle);
+                else
+                    _open();
                 int ms = t.millis();
                 if( ms >= 200 ) {
                     log() << "DR101 latency warning on journal file open " << ms << "ms" << endl;
@@ -723,32 +779,90 @@ namespace mongo {
             will not return until on disk
         */
         void WRITETOJOURNAL(JSectHeader h, AlignedBuilder& uncompressed) {
+            MONGO_TRACE_POINT( "dur/writetojournal", uncompressed.len(), 0 );
             Timer t;
             j.journal(h, uncompressed);
-            stats.curr->_writeToJournalMicros += t.micros();
+            const unsigned long long m = t.micros();
+            stats.curr->_writeToJournalMicros += m;
+            MONGO_TRACE_POINT( "dur/writetojournal/done", uncompressed.len(), m );
+        }
+        namespace {
+            // input chunk size for journal compression.  chunks compress independently
+            // (see JBlockHeader) so a large group commit fans out across the pool below
+            // instead of serializing behind one snappy stream.
+            const unsigned JournalBlockBytes = 1024 * 1024;
+
+            // snappy does a couple hundred MB/s per core; a few workers keep the journal
+            // pipeline ahead of fast storage without stealing many cores from queries
+            const int NJournalCompressThreads = 4;
+
+            struct CompressedBlock {
+                size_t compressedLength;
+                unsigned crc;
+            };
+
+            void compressBlock(const char *in, unsigned len, char *out, CompressedBlock *res) {
+                rawCompress(in, len, out, &res->compressedLength);
+                res->crc = crc32c(out, res->compressedLength);
+            }
         }
+
         void Journal::journal(const JSectHeader& h, const AlignedBuilder& uncompressed) {
             RACECHECK
             static AlignedBuilder b(32*1024*1024);
+            static AlignedBuilder scratch(32*1024*1024); // raw per-block output, compacted into b below
+            static threadpool::ThreadPool compressPool(NJournalCompressThreads);
             /* buffer to journal will be
                JSectHeader
-               compressed operations
+               compressed operations (JBlockHeader-prefixed blocks)
                JSectFooter
             */
+            unsigned nBlocks = (uncompressed.len() + JournalBlockBytes - 1) / JournalBlockBytes;
+            if( nBlocks == 0 )
+                nBlocks = 1; // keep an empty section well formed
+            const size_t slot = maxCompressedLength(JournalBlockBytes); // worst case room per block in scratch
             const unsigned headTailSize = sizeof(JSectHeader) + sizeof(JSectFooter);
-            const unsigned max = maxCompressedLength(uncompressed.len()) + headTailSize;
+            const unsigned max = nBlocks * ((unsigned)slot + sizeof(JBlockHeader)) + headTailSize;
             b.reset(max);
+            scratch.reset(nBlocks * slot);
 
             {
                 dassert( h.sectionLen() == (unsigned) 0xffffffff ); // we will backfill later
                 b.appendStruct(h);
             }
 
-            size_t compressedLength = 0;
-            rawCompress(uncompressed.buf(), uncompressed.len(), b.cur(), &compressedLength);
-            verify( compressedLength < 0xffffffff );
-            verify( compressedLength < max );
-            b.skip(compressedLength);
+            // compress the blocks, in parallel when there is more than one.  each block
+            // gets its own worst-case sized region of scratch; since compressed sizes
+            // vary, the results are compacted into b afterwards.
+            vector<CompressedBlock> results(nBlocks);
+            {
+                vector<threadpool::Task> tasks;
+                for( unsigned i = 0; i < nBlocks; i++ ) {
+                    const char *in = uncompressed.buf() + (size_t) i * JournalBlockBytes;
+                    const unsigned len = std::min(JournalBlockBytes, uncompressed.len() - i * JournalBlockBytes);
+                    char *out = scratch.cur() + (size_t) i * slot;
+                    if( nBlocks == 1 )
+                        compressBlock(in, len, out, &results[i]); // skip the thread handoff for small commits
+                    else
+                        tasks.push_back(boost::bind(&compressBlock, in, len, out, &results[i]));
+                }
+                if( !tasks.empty() ) {
+                    compressPool.schedule_batch(tasks);
+                    compressPool.join();
+                }
+            }
+
+            for( unsigned i = 0; i < nBlocks; i++ ) {
+                verify( results[i].compressedLength <= slot );
+                JBlockHeader bh;
+                bh.uncompressedLen = std::min(JournalBlockBytes, uncompressed.len() - i * JournalBlockBytes);
+                bh.compressedLen = (unsigned) results[i].compressedLength;
+                bh.crc32c = results[i].crc;
+                b.appendStruct(bh);
+                memcpy(b.cur(), scratch.buf() + (size_t) i * slot, bh.compressedLen);
+                b.skip(bh.compressedLen);
+            }
+            verify( b.len() < max );
 
             // footer
             unsigned L = 0xffffffff;
@@ -761,7 +875,9 @@ namespace mongo {
 
                 ((JSectHeader*)b.atOfs(0))->setSectionLen(lenUnpadded);
 
-                JSectFooter f(b.buf(), b.len()); // computes checksum
+                // the per-block crc32c checksums protect the data; the footer hash just
+                // covers the section header
+                JSectFooter f(b.buf(), sizeof(JSectHeader));
                 b.appendStruct(f);
                 dassert( b.len() == lenUnpadded );
 
@@ -51,7 +51,11 @@ namespace mongo {
 #if defined(_NOCOMPRESS)
             enum { CurrentVersion = 0x4148 };
 #else
-            enum { CurrentVersion = 0x4149 };
+            // 0x4149 : single snappy stream per section, md5-style footer hash over the
+            //          whole section
+            // 0x414a : section body is a sequence of JBlockHeader-prefixed snappy blocks,
+            //          each crc32c checksummed; the footer hash covers only the JSectHeader
+            enum { CurrentVersion = 0x414a };
 #endif
             unsigned short _version;
 
@@ -64,7 +68,13 @@ namespace mongo {
 
             unsigned long long fileId; // unique identifier that will be in each JSectHeader. important as we recycle prealloced files
 
-            char reserved3[8026]; // 8KB total for the file header
+            // rotation stamp, > 0, increasing with each (re)use of a journal file.  recovery
+            // orders journal files by this rather than by filename, which lets us reuse a
+            // retired file in place under its old name.  0 in files written by older versions
+            // (those were never reused in place, so filename order is correct for them).
+            unsigned long long generation;
+
+            char reserved3[8018]; // 8KB total for the file header
             char txt2[2];         // "\n\n" at the end
 
             bool versionOk() const { return _version == CurrentVersion; }
@@ -94,6 +104,19 @@ namespace mongo {
             }
         };
 
+        /** header for one compressed block within a section body (format 0x414a).  the
+            uncompressed section is split into fixed size chunks which are snappy
+            compressed independently, so compression of a large group commit can fan out
+            across cores and recovery can verify/uncompress blocks while earlier ones are
+            being applied.  blocks are contiguous: the next JBlockHeader starts
+            compressedLen bytes after this one's data.
+        */
+        struct JBlockHeader {
+            unsigned uncompressedLen; // bytes of section data this block decodes to
+            unsigned compressedLen;   // bytes of snappy data following this header
+            unsigned crc32c;          // CRC-32C of the compressed bytes (see util/crc32c.h)
+        };
+
         /** an individual write operation within a group commit section.  Either the entire section should
             be applied, or nothing.  (We check the md5 for the whole section before doing anything on recovery.)
         */
@@ -141,7 +164,10 @@ namespace mongo {
             }
         };
 
-        /** group commit section footer. md5 is a key field. */
+        /** group commit section footer. md5 is a key field.
+            as of format 0x414a the hash only covers the JSectHeader; the section data is
+            protected by the per-block crc32c checksums in the JBlockHeaders.
+        */
         struct JSectFooter {
             JSectFooter();
             JSectFooter(const void* begin, int len); // needs buffer to compute hash
@@ -80,11 +80,14 @@ namespace mongo {
             void _rotate();
 
             void _open();
+            void _openInPlace(const boost::filesystem::path& fname); // reuse a retired journal file
+            boost::filesystem::path takeRecyclableJournalFile();
             void closeCurrentJournalFile();
             void removeUnneededJournalFiles();
 
             unsigned long long _written; // bytes written so far to the current journal (log) file
             unsigned _nextFileNumber;
+            unsigned long long _nextGeneration; // next JHeader::generation to stamp
 
             SimpleMutex _curLogFileMutex;
 
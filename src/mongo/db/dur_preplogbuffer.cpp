@@ -49,6 +49,7 @@
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/stacktrace.h"
 #include "mongo/util/timer.h"
+#include "mongo/util/trace_point.h"
 
 using namespace mongoutils;
 
@@ -95,6 +96,7 @@ namespace mongo {
 
             JEntry e;
             e.len = min(i->length(), (unsigned)(mmf->length() - ofs)); //don't write past end of file
+            mmf->noteWriteRegion(ofs, e.len); // so REMAPPRIVATEVIEW can remap just the dirty span
             verify( ofs <= 0x80000000 );
             e.ofs = (unsigned) ofs;
             e.setFileNo( mmf->fileSuffixNo() );
@@ -191,10 +193,13 @@ namespace mongo {
         }
         void PREPLOGBUFFER(/*out*/ JSectHeader& h, AlignedBuilder& ab) {
             assertLockedForCommitting();
+            MONGO_TRACE_POINT( "dur/preplogbuffer", 0, 0 );
             Timer t;
             j.assureLogFileOpen(); // so fileId is set
             _PREPLOGBUFFER(h, ab);
-            stats.curr->_prepLogBufferMicros += t.micros();
+            const unsigned long long m = t.micros();
+            stats.curr->_prepLogBufferMicros += m;
+            MONGO_TRACE_POINT( "dur/preplogbuffer/done", ab.len(), m );
         }
 
     }
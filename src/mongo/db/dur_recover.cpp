@@ -33,6 +33,7 @@
 #include "mongo/db/dur_recover.h"
 
 #include <boost/filesystem/operations.hpp>
+#include <boost/thread/thread.hpp>
 #include <fcntl.h>
 #include <sys/stat.h>
 
@@ -53,7 +54,11 @@
 #include "mongo/util/checksum.h"
 #include "mongo/util/compress.h"
 #include "mongo/util/concurrency/race.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/crc32c.h"
+#include "mongo/util/file.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/queue.h"
 #include "mongo/util/startup_test.h"
 
 using namespace mongoutils;
@@ -79,6 +84,26 @@ namespace mongo {
         void removeJournalFiles();
         boost::filesystem::path getJournalDir();
 
+        /** generation stamp from a journal file's header, or 0 for files written by versions
+            that predate in-place reuse (or if the header can't be read).  never throws. */
+        static unsigned long long readGeneration(const boost::filesystem::path& p) {
+            try {
+                File f;
+                f.open( p.string().c_str(), /*readOnly*/ true );
+                if( !f.is_open() || f.len() < (fileofs) sizeof(JHeader) )
+                    return 0;
+                JHeader h;
+                f.read( 0, (char*)&h, sizeof(h) );
+                if( !h.valid() )
+                    return 0;
+                return h.generation;
+            }
+            catch(const std::exception& e) {
+                log() << "couldn't read journal file header " << p.string() << ' ' << e.what() << endl;
+                return 0;
+            }
+        }
+
         /** get journal filenames, in order. throws if unexpected content found */
         static void getFiles(boost::filesystem::path dir, vector<boost::filesystem::path>& files) {
             map<unsigned,boost::filesystem::path> m;
@@ -95,6 +120,36 @@ namespace mongo {
                     m.insert( pair<unsigned,boost::filesystem::path>(u,filepath) );
                 }
             }
+
+            // journal files can be reused in place, so write order is the header generation
+            // order, not the filename order.  generations may have gaps (some are consumed
+            // invalidating a prealloc file that then gets a fresh header) so we only check for
+            // duplicates.  if any file lacks a generation -- written by an older version, which
+            // never reused files -- fall through to filename order for the whole set.
+            {
+                map<unsigned long long,boost::filesystem::path> byGeneration;
+                bool allStamped = !m.empty();
+                for( map<unsigned,boost::filesystem::path>::iterator i = m.begin(); i != m.end(); ++i ) {
+                    unsigned long long gen = readGeneration(i->second);
+                    if( gen == 0 ) {
+                        allStamped = false;
+                        break;
+                    }
+                    if( byGeneration.count(gen) ) {
+                        uasserted(17543, str::stream() << "unexpected files in journal directory " << dir.string()
+                          << " : " << boost::filesystem::path(i->second).leaf().string() << " : duplicate generation");
+                    }
+                    byGeneration[gen] = i->second;
+                }
+                if( allStamped ) {
+                    for( map<unsigned long long,boost::filesystem::path>::iterator i = byGeneration.begin();
+                         i != byGeneration.end(); ++i ) {
+                        files.push_back(i->second);
+                    }
+                    return;
+                }
+            }
+
             for( map<unsigned,boost::filesystem::path>::iterator i = m.begin(); i != m.end(); ++i ) {
                 if( i != m.begin() && m.count(i->first - 1) == 0 ) {
                     uasserted(13532,
@@ -105,7 +160,7 @@ namespace mongo {
             }
         }
 
-        /** read through the memory mapped data of a journal file (journal/j._<n> file)
+        /** read through the uncompressed entries of one journal section
             throws
         */
         class JournalSectionIterator : boost::noncopyable {
@@ -113,31 +168,14 @@ namespace mongo {
             const JSectHeader _h;
             const char *_lastDbName; // pointer into mmaped journal file
             const bool _doDurOps;
-            string _uncompressed;
         public:
-            JournalSectionIterator(const JSectHeader& h, const void *compressed, unsigned compressedLen, bool doDurOpsRecovering) :
-                _h(h),
-                _lastDbName(0)
-                , _doDurOps(doDurOpsRecovering)
-            {
-                verify( doDurOpsRecovering );
-                bool ok = uncompress((const char *)compressed, compressedLen, &_uncompressed);
-                if( !ok ) { 
-                    // it should always be ok (i think?) as there is a previous check to see that the JSectFooter is ok
-                    log() << "couldn't uncompress journal section" << endl;
-                    msgasserted(15874, "couldn't uncompress journal section");
-                }
-                const char *p = _uncompressed.c_str();
-                verify( compressedLen == _h.sectionLen() - sizeof(JSectFooter) - sizeof(JSectHeader) );
-                _entries = auto_ptr<BufReader>( new BufReader(p, _uncompressed.size()) );
-            }
-
-            // we work with the uncompressed buffer when doing a WRITETODATAFILES (for speed)
-            JournalSectionIterator(const JSectHeader &h, const void *p, unsigned len) :
+            // p is the (already uncompressed) section body; DurOps are only replayed
+            // during recovery, not on a WRITETODATAFILES
+            JournalSectionIterator(const JSectHeader &h, const void *p, unsigned len, bool doDurOps) :
                 _entries( new BufReader((const char *) p, len) ),
                 _h(h),
                 _lastDbName(0)
-                , _doDurOps(false)
+                , _doDurOps(doDurOps)
 
                 { }
 
@@ -211,6 +249,176 @@ namespace mongo {
             return full.string();
         }
 
+        /** walks the sections of a memory mapped journal file on its own thread during
+            recovery, checksumming and uncompressing each one so the next section is
+            ready while the current one is being applied to the datafiles.  this
+            overlaps journal reads (page faults on the mapped file) and snappy
+            uncompression with datafile writes.
+        */
+        class JournalSectionPrefetcher : boost::noncopyable {
+        public:
+            struct Section {
+                Section() : skipped(false), last(false), abruptEnd(false), errCode(0) { }
+                JSectHeader h;
+                string body;    // uncompressed section body (the entries, no header/footer)
+                bool skipped;   // lsn says the section is already in the datafiles
+                bool last;      // no more sections in this file
+                bool abruptEnd; // the file ended mid-section (only meaningful when last)
+                int errCode;    // nonzero: bad section; the consumer msgasserts with this
+                string errMsg;
+            };
+
+            /** @param p the bytes of the journal file after the JHeader */
+            JournalSectionPrefetcher(RecoveryJob& rj, unsigned long long fileId, const void *p, unsigned len) :
+                _rj(rj),
+                _fileId(fileId),
+                _br((const char *) p, len),
+                _queue(kMaxQueuedSections + 1),
+                _consumedLast(false),
+                _thread(boost::bind(&JournalSectionPrefetcher::run, this)) {
+            }
+
+            ~JournalSectionPrefetcher() {
+                // if the consumer bailed early (assertion, interrupt), drain so the
+                // producer isn't stuck pushing into a full queue
+                while( !_consumedLast )
+                    next();
+                _thread.join();
+            }
+
+            /** blocks until the next section is ready */
+            shared_ptr<Section> next() {
+                shared_ptr<Section> s = _queue.blockingPop();
+                if( s->last )
+                    _consumedLast = true;
+                return s;
+            }
+
+        private:
+            // bounds read-ahead so a huge journal doesn't all sit uncompressed in memory
+            static const size_t kMaxQueuedSections = 2;
+
+            void run() {
+                try {
+                    while( !_br.atEof() ) {
+                        JSectHeader h;
+                        _br.peek(h);
+                        if( h.fileId != _fileId ) {
+                            if (debug || (storageGlobalParams.durOptions &
+                                          StorageGlobalParams::DurDumpJournal)) {
+                                log() << "Ending processFileBuffer at differing fileId want:" << _fileId << " got:" << h.fileId << endl;
+                                log() << "  sect len:" << h.sectionLen() << " seqnum:" << h.seqNumber << endl;
+                            }
+                            pushLast(false);
+                            return;
+                        }
+                        unsigned slen = h.sectionLen();
+                        unsigned dataLen = slen - sizeof(JSectHeader) - sizeof(JSectFooter);
+                        const char *hdr = (const char *) _br.skip(h.sectionLenWithPadding());
+                        const char *data = hdr + sizeof(JSectHeader);
+                        const char *footer = data + dataLen;
+
+                        shared_ptr<Section> s( new Section() );
+                        s->h = h;
+
+                        if( _rj._lastDataSyncedFromLastRun > h.seqNumber + ExtraKeepTimeMs ) {
+                            if( h.seqNumber != _rj._lastSeqMentionedInConsoleLog ) {
+                                static int n;
+                                if( ++n < 10 ) {
+                                    log() << "recover skipping application of section seq:" << h.seqNumber << " < lsn:" << _rj._lastDataSyncedFromLastRun << endl;
+                                }
+                                else if( n == 10 ) {
+                                    log() << "recover skipping application of section more..." << endl;
+                                }
+                                _rj._lastSeqMentionedInConsoleLog = h.seqNumber;
+                            }
+                            s->skipped = true;
+                            _queue.push(s);
+                            continue;
+                        }
+
+                        // as of format 0x414a the footer hash only covers the section
+                        // header; the data is protected per block below
+                        if( !((const JSectFooter *) footer)->checkHash(hdr, sizeof(JSectHeader)) ) {
+                            s->errCode = 13594;
+                            s->errMsg = "journal checksum doesn't match";
+                            _queue.push(s);
+                            pushLast(false);
+                            return;
+                        }
+
+                        // the body is a sequence of JBlockHeader-prefixed snappy blocks;
+                        // verify each block's crc32c then uncompress it
+                        const char *pos = data;
+                        unsigned remaining = dataLen;
+                        string block;
+                        while( remaining && !s->errCode ) {
+                            JBlockHeader bh;
+                            if( remaining < sizeof(JBlockHeader) ) {
+                                s->errCode = 17550;
+                                s->errMsg = "journal section block framing invalid";
+                                break;
+                            }
+                            memcpy(&bh, pos, sizeof(bh));
+                            pos += sizeof(bh);
+                            remaining -= sizeof(bh);
+                            if( bh.compressedLen > remaining ) {
+                                s->errCode = 17550;
+                                s->errMsg = "journal section block framing invalid";
+                                break;
+                            }
+                            if( crc32c(pos, bh.compressedLen) != bh.crc32c ) {
+                                s->errCode = 13594;
+                                s->errMsg = "journal checksum doesn't match";
+                                break;
+                            }
+                            if( !uncompress(pos, bh.compressedLen, &block) ||
+                                block.size() != bh.uncompressedLen ) {
+                                // it should always be ok as the block crc above matched
+                                log() << "couldn't uncompress journal section" << endl;
+                                s->errCode = 15874;
+                                s->errMsg = "couldn't uncompress journal section";
+                                break;
+                            }
+                            s->body += block;
+                            pos += bh.compressedLen;
+                            remaining -= bh.compressedLen;
+                        }
+                        if( s->errCode ) {
+                            _queue.push(s);
+                            pushLast(false);
+                            return;
+                        }
+
+                        _queue.push(s);
+                    }
+                    pushLast(false);
+                }
+                catch( BufReader::eof& ) {
+                    if (storageGlobalParams.durOptions & StorageGlobalParams::DurDumpJournal)
+                        log() << "ABRUPT END" << endl;
+                    pushLast(true);
+                }
+            }
+
+            void pushLast(bool abrupt) {
+                shared_ptr<Section> s( new Section() );
+                s->last = true;
+                s->abruptEnd = abrupt;
+                _queue.push(s);
+            }
+
+            RecoveryJob& _rj;
+            const unsigned long long _fileId;
+            BufReader _br;
+            BlockingQueue< shared_ptr<Section> > _queue;
+            bool _consumedLast; // consumer side; true once next() returned the last marker
+            boost::thread _thread;
+        };
+
+        RecoveryJob::RecoveryJob() : _lastDataSyncedFromLastRun(0),
+            _mx("recovery"), _recovering(false) { _lastSeqMentionedInConsoleLog = 1; }
+
         RecoveryJob::~RecoveryJob() {
             DESTRUCTOR_GUARD(
                 if( !_mmfs.empty() )
@@ -348,6 +556,108 @@ namespace mongo {
             return mmf;
         }
 
+        namespace {
+            /** the basic writes one journal section holds for a single datafile.
+                one worker owns each batch, so writes to a file are applied in journal
+                order; different files are disjoint memory and can proceed concurrently.
+            */
+            struct FileWriteBatch : boost::noncopyable {
+                FileWriteBatch() : mmf(NULL), bytesWritten(0), failed(false) { }
+                DurableMappedFile *mmf;
+                vector<const JEntry*> writes;
+                unsigned long long bytesWritten; // this worker's count; summed after join
+                bool failed;
+            };
+
+            typedef map< pair<string,int>, shared_ptr<FileWriteBatch> > FileWriteBatches; // by (dbName, fileNo)
+
+            void applyFileWriteBatch(FileWriteBatch* b) {
+                try {
+                    verify( b->mmf->view_write() );
+                    char *base = (char *) b->mmf->view_write();
+                    unsigned long long flen = b->mmf->length();
+                    for( vector<const JEntry*>::const_iterator i = b->writes.begin(); i != b->writes.end(); ++i ) {
+                        const JEntry *e = *i;
+                        if( (e->ofs + e->len) <= flen ) {
+                            verify( e->srcData() );
+                            memcpy(base + e->ofs, e->srcData(), e->len);
+                            b->bytesWritten += e->len;
+                        }
+                        // else: a write past the current end of file; ok during recovery
+                        // (see RecoveryJob::write)
+                    }
+                }
+                catch(...) {
+                    // the pool's workers log and swallow exceptions; surface the failure
+                    b->failed = true;
+                }
+            }
+
+            void flushFileWriteBatches(ThreadPool& pool, FileWriteBatches& batches) {
+                if( batches.empty() )
+                    return;
+                if( batches.size() == 1 ) {
+                    // nothing to parallelize; skip the pool handoff
+                    applyFileWriteBatch(batches.begin()->second.get());
+                }
+                else {
+                    for( FileWriteBatches::const_iterator i = batches.begin(); i != batches.end(); ++i )
+                        pool.schedule(applyFileWriteBatch, i->second.get());
+                    pool.join();
+                }
+                unsigned long long bytes = 0;
+                for( FileWriteBatches::const_iterator i = batches.begin(); i != batches.end(); ++i ) {
+                    massert(17523, "error applying journal section to datafiles during recovery",
+                            !i->second->failed);
+                    bytes += i->second->bytesWritten;
+                }
+                stats.curr->_writeToDataFilesBytes += bytes;
+                batches.clear();
+            }
+
+            int numRecoveryApplyThreads() {
+                int n = (int) boost::thread::hardware_concurrency();
+                if( n == 0 )
+                    n = 2;
+                return std::min(n, 8);
+            }
+        }
+
+        /** recovery only: apply a section's writes grouped by target datafile on the
+            worker pool.  DurOps (file creates, db drops) are barriers: all writes
+            before them are flushed first, then the op replays on this thread.
+        */
+        void RecoveryJob::applyEntriesInParallel(const vector<ParsedJournalEntry> &entries) {
+            if( !_applyPool )
+                _applyPool.reset( new ThreadPool(numRecoveryApplyThreads()) );
+
+            FileWriteBatches batches;
+            for( vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i ) {
+                const ParsedJournalEntry& entry = *i;
+                if( entry.op ) {
+                    flushFileWriteBatches(*_applyPool, batches);
+                    if( entry.op->needFilesClosed() ) {
+                        _close(); // locked in applyPreparedSection
+                    }
+                    entry.op->replay();
+                }
+                else {
+                    verify(entry.e);
+                    verify(entry.dbName);
+                    verify((size_t)strnlen(entry.dbName, MaxDatabaseNameLen) < MaxDatabaseNameLen);
+
+                    shared_ptr<FileWriteBatch>& b = batches[ make_pair(string(entry.dbName), entry.e->getFileNo()) ];
+                    if( !b ) {
+                        b.reset( new FileWriteBatch() );
+                        // resolved serially here: may open the file and grow _mmfs
+                        b->mmf = getDurableMappedFile(entry);
+                    }
+                    b->writes.push_back(entry.e);
+                }
+            }
+            flushFileWriteBatches(*_applyPool, batches);
+        }
+
         void RecoveryJob::applyEntries(const vector<ParsedJournalEntry> &entries) {
             bool apply = (storageGlobalParams.durOptions &
                           StorageGlobalParams::DurScanOnly) == 0;
@@ -356,9 +666,14 @@ namespace mongo {
             if( dump )
                 log() << "BEGIN section" << endl;
 
-            Last last;
-            for( vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i ) {
-                applyEntry(last, *i, apply, dump);
+            if( _recovering && apply && !dump ) {
+                applyEntriesInParallel(entries);
+            }
+            else {
+                Last last;
+                for( vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i ) {
+                    applyEntry(last, *i, apply, dump);
+                }
             }
 
             if( dump )
@@ -370,33 +685,13 @@ namespace mongo {
             scoped_lock lk(_mx);
             RACECHECK
 
-            /** todo: we should really verify the checksum to see that seqNumber is ok?
-                      that is expensive maybe there is some sort of checksum of just the header 
-                      within the header itself
-            */
-            if( _recovering && _lastDataSyncedFromLastRun > h->seqNumber + ExtraKeepTimeMs ) {
-                if( h->seqNumber != _lastSeqMentionedInConsoleLog ) {
-                    static int n;
-                    if( ++n < 10 ) {
-                        log() << "recover skipping application of section seq:" << h->seqNumber << " < lsn:" << _lastDataSyncedFromLastRun << endl;
-                    }
-                    else if( n == 10 ) { 
-                        log() << "recover skipping application of section more..." << endl;
-                    }
-                    _lastSeqMentionedInConsoleLog = h->seqNumber;
-                }
-                return;
-            }
+            // recovery goes through applyPreparedSection; here the caller
+            // (WRITETODATAFILES) hands us its own uncompressed buffer
+            verify( !_recovering );
 
-            auto_ptr<JournalSectionIterator> i;
-            if( _recovering ) {
-                i = auto_ptr<JournalSectionIterator>(new JournalSectionIterator(*h, p, len, _recovering));
-            }
-            else { 
-                i = auto_ptr<JournalSectionIterator>(new JournalSectionIterator(*h, /*after header*/p, /*w/out header*/len));
-            }
+            JournalSectionIterator i(*h, /*after header*/p, /*w/out header*/len, false /*doDurOps*/);
 
-            // we use a static so that we don't have to reallocate every time through.  occasionally we 
+            // we use a static so that we don't have to reallocate every time through.  occasionally we
             // go back to a small allocation so that if there were a spiky growth it won't stick forever.
             static vector<ParsedJournalEntry> entries;
             entries.clear();
@@ -411,17 +706,35 @@ namespace mongo {
 
             // first read all entries to make sure this section is valid
             ParsedJournalEntry e;
-            while( !i->atEof() ) {
-                i->next(e);
+            while( !i.atEof() ) {
+                i.next(e);
                 entries.push_back(e);
             }
 
-            // after the entries check the footer checksum
-            if( _recovering ) {
-                verify( ((const char *)h) + sizeof(JSectHeader) == p );
-                if( !f->checkHash(h, len + sizeof(JSectHeader)) ) { 
-                    msgasserted(13594, "journal checksum doesn't match");
-                }
+            // got all the entries for one group commit.  apply them:
+            applyEntries(entries);
+        }
+
+        /** recovery path counterpart of processSection: the prefetch thread already
+            verified the footer checksum and uncompressed the body.
+        */
+        void RecoveryJob::applyPreparedSection(const JSectHeader& h, const std::string& body) {
+            LockMongoFilesShared lkFiles; // for RecoveryJob::Last
+            scoped_lock lk(_mx);
+            RACECHECK
+
+            JournalSectionIterator i(h, body.c_str(), body.size(), true /*doDurOps*/);
+
+            // static for the same reallocation-avoidance reason as in processSection;
+            // both run under _mx
+            static vector<ParsedJournalEntry> entries;
+            entries.clear();
+
+            // first read all entries to make sure this section is valid
+            ParsedJournalEntry e;
+            while( !i.atEof() ) {
+                i.next(e);
+                entries.push_back(e);
             }
 
             // got all the entries for one group commit.  apply them:
@@ -465,36 +778,35 @@ namespace mongo {
                     }
                 }
 
-                // read sections
-                while ( !br.atEof() ) {
-                    JSectHeader h;
-                    br.peek(h);
-                    if( h.fileId != fileId ) {
-                        if (debug || (storageGlobalParams.durOptions &
-                                      StorageGlobalParams::DurDumpJournal)) {
-                            log() << "Ending processFileBuffer at differing fileId want:" << fileId << " got:" << h.fileId << endl;
-                            log() << "  sect len:" << h.sectionLen() << " seqnum:" << h.seqNumber << endl;
-                        }
-                        return true;
+                // read sections.  the prefetcher walks the rest of the file on its own
+                // thread, checksumming and uncompressing the next sections while we
+                // apply the current one.
+                JournalSectionPrefetcher prefetcher(*this, fileId, br.pos(), br.remaining());
+                for( ;; ) {
+                    shared_ptr<JournalSectionPrefetcher::Section> s = prefetcher.next();
+                    if( s->last )
+                        return s->abruptEnd;
+                    if( s->errCode ) {
+                        msgasserted(s->errCode, s->errMsg);
+                    }
+                    if( !s->skipped ) {
+                        applyPreparedSection(s->h, s->body);
                     }
-                    unsigned slen = h.sectionLen();
-                    unsigned dataLen = slen - sizeof(JSectHeader) - sizeof(JSectFooter);
-                    const char *hdr = (const char *) br.skip(h.sectionLenWithPadding());
-                    const char *data = hdr + sizeof(JSectHeader);
-                    const char *footer = data + dataLen;
-                    processSection((const JSectHeader*) hdr, data, dataLen, (const JSectFooter*) footer);
 
                     // ctrl c check
                     killCurrentOp.checkForInterrupt(false);
                 }
             }
             catch( BufReader::eof& ) {
+                // the file was shorter than a JHeader; sections past the header are
+                // handled by the prefetcher
                 if (storageGlobalParams.durOptions & StorageGlobalParams::DurDumpJournal)
                     log() << "ABRUPT END" << endl;
                 return true; // abrupt end
             }
 
-            return false; // non-abrupt end
+            verify(false); // unreachable: the section loop above returns or throws
+            return false;
         }
 
         /** apply a specific journal file */
@@ -537,6 +849,7 @@ namespace mongo {
             }
 
             close();
+            _applyPool.reset(); // joins the workers; no reason to keep them past recovery
 
             if (storageGlobalParams.durOptions & StorageGlobalParams::DurScanOnly) {
                 uasserted(13545, str::stream() << "--durOptions "
@@ -31,6 +31,7 @@
 #pragma once
 
 #include <boost/filesystem/operations.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <list>
 
 #include "mongo/db/dur_journalformat.h"
@@ -40,8 +41,13 @@
 namespace mongo {
     class DurableMappedFile;
 
+    namespace threadpool {
+        class ThreadPool;
+    }
+
     namespace dur {
         struct ParsedJournalEntry;
+        class JournalSectionPrefetcher;
 
         /** call go() to execute a recovery from existing journal files.
          */
@@ -56,12 +62,11 @@ namespace mongo {
                 int fileNo;
             } last;        
         public:
-            RecoveryJob() : _lastDataSyncedFromLastRun(0), 
-                _mx("recovery"), _recovering(false) { _lastSeqMentionedInConsoleLog = 1; }
+            RecoveryJob(); // out of line: ~scoped_ptr<ThreadPool> needs the complete type
             void go(vector<boost::filesystem::path>& files);
             ~RecoveryJob();
 
-            /** @param data data between header and footer. compressed if recovering. */
+            /** WRITETODATAFILES path. @param data uncompressed data between header and footer. */
             void processSection(const JSectHeader *h, const void *data, unsigned len, const JSectFooter *f);
 
             void close(); // locks and calls _close()
@@ -71,6 +76,10 @@ namespace mongo {
             void write(Last& last, const ParsedJournalEntry& entry); // actually writes to the file
             void applyEntry(Last& last, const ParsedJournalEntry& entry, bool apply, bool dump);
             void applyEntries(const vector<ParsedJournalEntry> &entries);
+            void applyEntriesInParallel(const vector<ParsedJournalEntry> &entries);
+            // recovery path: the section body was already checksummed and uncompressed
+            // by the prefetch thread
+            void applyPreparedSection(const JSectHeader& h, const std::string& body);
             bool processFileBuffer(const void *, unsigned len);
             bool processFile(boost::filesystem::path journalfile);
             void _close(); // doesn't lock
@@ -78,6 +87,10 @@ namespace mongo {
 
             list<boost::shared_ptr<DurableMappedFile> > _mmfs;
 
+            // lazily created; applies the writes of a section to different datafiles
+            // concurrently during recovery
+            boost::scoped_ptr<threadpool::ThreadPool> _applyPool;
+
             unsigned long long _lastDataSyncedFromLastRun;
             unsigned long long _lastSeqMentionedInConsoleLog;
         public:
@@ -85,6 +98,8 @@ namespace mongo {
         private:
             bool _recovering; // are we in recovery or WRITETODATAFILES
 
+            friend class JournalSectionPrefetcher; // reads _lastDataSyncedFromLastRun et al
+
             static RecoveryJob &_instance;
         };
     }
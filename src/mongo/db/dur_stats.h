@@ -63,6 +63,13 @@ namespace mongo {
                 // - data being written faster than the normal group commit interval
                 unsigned _commitsInWriteLock;
 
+                // group commit batching: total j:true waiters satisfied by commits in this
+                // interval, and the deepest waiter queue observed when a commit began.  a
+                // high depth with few commits means the size-triggered batching is doing
+                // its job; a high depth with many commits means fsync amplification.
+                unsigned _commitWaiters;
+                unsigned _commitQueueDepth;
+
                 unsigned _dtMillis;
             };
             S *curr;
@@ -35,6 +35,7 @@
 #include "mongo/db/dur_stats.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/timer.h"
+#include "mongo/util/trace_point.h"
 
 namespace mongo {
 #ifdef _WIN32
@@ -102,10 +103,12 @@ namespace mongo {
 #ifdef _WIN32
             SimpleMutex::scoped_lock _globalFlushMutex(globalFlushMutex);
 #endif
+            MONGO_TRACE_POINT( "dur/writetodatafiles", uncompressed.len(), 0 );
             Timer t;
             WRITETODATAFILES_Impl1(h, uncompressed);
             unsigned long long m = t.micros();
             stats.curr->_writeToDataFilesMicros += m;
+            MONGO_TRACE_POINT( "dur/writetodatafiles/done", uncompressed.len(), m );
             LOG(2) << "journal WRITETODATAFILES " << m / 1000.0 << "ms" << endl;
         }
 
@@ -31,12 +31,37 @@
 #include "mongo/db/exec/and_common-inl.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/kill_current_op.h"
 
 namespace mongo {
 
+    // The amount of data we're willing to buffer from our first child while intersecting.
+    // If we hit this we fail the stage; the runner will fall back to another plan, and
+    // anything is better than eating memory without bound.
+    const size_t kMaxBytes = 32 * 1024 * 1024;
+
+    // How often the buildup phase checks for interrupt/maxTimeMS: every this many works or
+    // this many milliseconds, whichever comes first.  The check is an approximate comparison
+    // against the coarse ticker, so it's cheap to do often.
+    const int kInterruptCheckWorks = 256;
+    const int kInterruptCheckMillis = 20;
+
+    // Estimate of the memory pinned by a member buffered in the hash map.
+    static size_t memUsageForMember(const WorkingSetMember* member) {
+        size_t size = sizeof(DiskLoc) + sizeof(WorkingSetID);
+        for (size_t i = 0; i < member->keyData.size(); ++i) {
+            size += member->keyData[i].keyData.objsize();
+        }
+        if (member->hasObj()) {
+            size += member->obj.objsize();
+        }
+        return size;
+    }
+
     AndHashStage::AndHashStage(WorkingSet* ws, const MatchExpression* filter)
         : _ws(ws), _filter(filter), _resultIterator(_dataMap.end()),
-          _shouldScanChildren(true), _currentChild(0) {}
+          _shouldScanChildren(true), _currentChild(0), _memUsage(0),
+          _interruptTracker(kInterruptCheckWorks, kInterruptCheckMillis) {}
 
     AndHashStage::~AndHashStage() {
         for (size_t i = 0; i < _children.size(); ++i) { delete _children[i]; }
@@ -50,13 +75,25 @@ namespace mongo {
     }
 
     PlanStage::StageState AndHashStage::work(WorkingSetID* out) {
+        ScopedWorkTimer workTimer(&_commonStats);
         ++_commonStats.works;
 
+        if (_memUsage > kMaxBytes) {
+            return PlanStage::FAILURE;
+        }
+
         if (isEOF()) { return PlanStage::IS_EOF; }
 
         // An AND is either reading the first child into the hash table, probing against the hash
         // table with subsequent children, or returning results.
 
+        // We don't reach a yield point while building or probing the table, so check for
+        // interrupt (kill or maxTimeMS expiry) ourselves every so often.  Throws if the
+        // operation should die.
+        if (_shouldScanChildren && _interruptTracker.intervalHasElapsed()) {
+            killCurrentOp.checkForInterrupt();
+        }
+
         // We read the first child into our hash table.
         if (_shouldScanChildren && (0 == _currentChild)) {
             return readFirstChild(out);
@@ -106,6 +143,7 @@ namespace mongo {
             verify(_dataMap.end() == _dataMap.find(member->loc));
 
             _dataMap[member->loc] = id;
+            _memUsage += memUsageForMember(member);
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
         }
@@ -153,7 +191,9 @@ namespace mongo {
                 // We have a hit.  Copy data into the WSM we already have.
                 _seenMap.insert(member->loc);
                 WorkingSetMember* olderMember = _ws->get(_dataMap[member->loc]);
+                const size_t memUsageBefore = memUsageForMember(olderMember);
                 AndCommon::mergeFrom(olderMember, member);
+                _memUsage += memUsageForMember(olderMember) - memUsageBefore;
             }
             _ws->free(id);
             ++_commonStats.needTime;
@@ -169,6 +209,7 @@ namespace mongo {
                 if (_seenMap.end() == _seenMap.find(it->first)) {
                     DataMap::iterator toErase = it;
                     ++it;
+                    _memUsage -= memUsageForMember(_ws->get(toErase->second));
                     _ws->free(toErase->second);
                     _dataMap.erase(toErase);
                 }
@@ -254,6 +295,9 @@ namespace mongo {
                 ++_specificStats.flaggedButPassed;
             }
 
+            // About to leave the buffered set; account for it before the fetch mutates it.
+            _memUsage -= memUsageForMember(member);
+
             // The loc is about to be invalidated.  Fetch it and clear the loc.
             WorkingSetCommon::fetchAndInvalidateLoc(member);
 
@@ -266,6 +310,9 @@ namespace mongo {
     PlanStageStats* AndHashStage::getStats() {
         _commonStats.isEOF = isEOF();
 
+        _specificStats.memUsage = _memUsage;
+        _specificStats.memLimit = kMaxBytes;
+
         auto_ptr<PlanStageStats> ret(new PlanStageStats(_commonStats, STAGE_AND_HASH));
         ret->specific.reset(new AndHashStats(_specificStats));
         for (size_t i = 0; i < _children.size(); ++i) {
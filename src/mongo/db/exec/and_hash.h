@@ -36,6 +36,7 @@
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/platform/unordered_set.h"
+#include "mongo/util/elapsed_tracker.h"
 
 namespace mongo {
 
@@ -96,6 +97,14 @@ namespace mongo {
         // Which child are we currently working on?
         size_t _currentChild;
 
+        // Estimated memory consumed by the members buffered in _dataMap.  If this exceeds
+        // the limit in and_hash.cpp we return FAILURE rather than buffering without bound.
+        size_t _memUsage;
+
+        // We don't yield while filling or probing _dataMap, so we poll for interrupt/maxTimeMS
+        // ourselves during that phase.  Tells us when it's time to check.
+        ElapsedTracker _interruptTracker;
+
         // Stats
         CommonStats _commonStats;
         AndHashStats _specificStats;
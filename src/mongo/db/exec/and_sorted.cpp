@@ -49,6 +49,7 @@ namespace mongo {
     bool AndSortedStage::isEOF() { return _isEOF; }
 
     PlanStage::StageState AndSortedStage::work(WorkingSetID* out) {
+        ScopedWorkTimer workTimer(&_commonStats);
         ++_commonStats.works;
 
         if (isEOF()) { return PlanStage::IS_EOF; }
@@ -31,6 +31,7 @@
 #include "mongo/db/database.h"
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/scan_coordinator.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/db/structure/collection_iterator.h"
@@ -43,9 +44,19 @@ namespace mongo {
     CollectionScan::CollectionScan(const CollectionScanParams& params,
                                    WorkingSet* workingSet,
                                    const MatchExpression* filter)
-        : _workingSet(workingSet), _filter(filter), _params(params), _nsDropped(false) { }
+        : _workingSet(workingSet), _filter(filter), _params(params), _nsDropped(false),
+          _sharedPass(false), _wrapped(false), _done(false), _registered(false) {
+        _quickFilter.compile(_filter);
+    }
+
+    CollectionScan::~CollectionScan() {
+        if (_registered) {
+            ScanCoordinator::instance().remove(this);
+        }
+    }
 
     PlanStage::StageState CollectionScan::work(WorkingSetID* out) {
+        ScopedWorkTimer workTimer(&_commonStats);
         ++_commonStats.works;
         if (_nsDropped) { return PlanStage::IS_EOF; }
 
@@ -56,7 +67,26 @@ namespace mongo {
                 return PlanStage::IS_EOF;
             }
 
-            _iter.reset( collection->getIterator( _params.start,
+            DiskLoc start = _params.start;
+
+            // A full forward scan can join an in-progress pass over the same namespace:
+            // start where that scan is now, wrap around at the end, and stop where we
+            // joined.  Concurrent full scans then share one pass over the disk.  Capped
+            // collections are excluded: their wrap-around deletes invalidate the join
+            // point routinely rather than rarely.
+            bool sharable = start.isNull()
+                            && !_params.tailable
+                            && CollectionScanParams::FORWARD == _params.direction
+                            && !collection->details()->isCapped();
+            if (sharable) {
+                _joinedAt = ScanCoordinator::instance().joinPosition(_params.ns);
+                start = _joinedAt;
+                _sharedPass = !_joinedAt.isNull();
+                ScanCoordinator::instance().add(this, _params.ns);
+                _registered = true;
+            }
+
+            _iter.reset( collection->getIterator( start,
                                                   _params.tailable,
                                                   _params.direction ) );
 
@@ -64,6 +94,22 @@ namespace mongo {
             return PlanStage::NEED_TIME;
         }
 
+        // A joined scan that exhausts the collection wraps around to the beginning and
+        // keeps going until it reaches its starting position again.
+        if (_sharedPass && !_wrapped && _iter->isEOF()) {
+            Collection* collection = cc().database()->getCollection( _params.ns );
+            if ( collection == NULL ) {
+                _nsDropped = true;
+                return PlanStage::IS_EOF;
+            }
+            _iter.reset( collection->getIterator( DiskLoc(),
+                                                  _params.tailable,
+                                                  _params.direction ) );
+            _wrapped = true;
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+
         DiskLoc nextLoc;
 
         // Should we try getNext() on the underlying _iter if we're EOF?  Yes, if we're tailable.
@@ -84,6 +130,19 @@ namespace mongo {
             nextLoc = _iter->getNext();
         }
 
+        if (_wrapped && !_joinedAt.isNull() && nextLoc == _joinedAt) {
+            // Back where we joined the shared pass; the scan has covered everything.
+            _done = true;
+            return PlanStage::IS_EOF;
+        }
+
+        if (_registered && 0 == (_specificStats.docsTested & 0x3F)) {
+            // Refresh our published position occasionally.  It's only a locality hint for
+            // joiners, so a little staleness is fine and keeps the coordinator's mutex off
+            // the per-document path.
+            ScanCoordinator::instance().setPosition(this, nextLoc);
+        }
+
         WorkingSetID id = _workingSet->allocate();
         WorkingSetMember* member = _workingSet->get(id);
         member->loc = nextLoc;
@@ -92,7 +151,42 @@ namespace mongo {
 
         ++_specificStats.docsTested;
 
-        if (Filter::passes(member, _filter)) {
+        bool passes;
+        if (_quickFilter.isCompiled()) {
+            bool canAnswer;
+            passes = _quickFilter.matches(member->obj, &canAnswer);
+            // Documents the flat matcher can't answer (array-valued fields) get the tree.
+            if (!canAnswer) { passes = Filter::passes(member, _filter); }
+        }
+        else {
+            passes = Filter::passes(member, _filter);
+        }
+
+        if (passes && !_params.neededFields.empty()) {
+            // The stage above only wants these top-level fields.  Copy them out in a
+            // single pass over the record's BSON, stopping as soon as we've seen them
+            // all, instead of surfacing the whole document.  The filter already ran
+            // against the full document above, so fields it tests needn't be kept.
+            const size_t n = _params.neededFields.size();
+            const unsigned allSeen = (1U << n) - 1;  // planner guarantees n < 32
+            unsigned seen = 0;
+            BSONObjBuilder bob;
+            BSONObjIterator it(member->obj);
+            while (it.more() && seen != allSeen) {
+                BSONElement e = it.next();
+                for (size_t i = 0; i < n; ++i) {
+                    if (0 == (seen & (1U << i)) && _params.neededFields[i] == e.fieldName()) {
+                        bob.append(e);
+                        seen |= (1U << i);
+                        break;
+                    }
+                }
+            }
+            member->obj = bob.obj();
+            member->state = WorkingSetMember::OWNED_OBJ;
+        }
+
+        if (passes) {
             *out = id;
             ++_commonStats.advanced;
             return PlanStage::ADVANCED;
@@ -105,13 +199,37 @@ namespace mongo {
     }
 
     bool CollectionScan::isEOF() {
-        if (_nsDropped) { return true; }
+        if (_nsDropped || _done) { return true; }
         if (NULL == _iter) { return false; }
+        if (_sharedPass && !_wrapped) {
+            // We joined mid-pass; exhausting the first segment isn't EOF, work() still
+            // needs to wrap around to the beginning.
+            return false;
+        }
         return _iter->isEOF();
     }
 
     void CollectionScan::invalidate(const DiskLoc& dl) {
         ++_commonStats.invalidates;
+
+        // If the record the wrapped segment must stop at is deleted or moved, advance
+        // the stop marker past it -- everything else in the pass still has to be
+        // visited; only the vanished record itself may be skipped.  If it had no
+        // successor the marker goes null and the wrapped segment runs to iterator EOF
+        // instead, which covers the same ground now that the record is gone.
+        if (!_joinedAt.isNull() && dl == _joinedAt) {
+            Collection* collection = cc().database()->getCollection( _params.ns );
+            if ( collection != NULL ) {
+                scoped_ptr<CollectionIterator> it( collection->getIterator(
+                        _joinedAt, false, CollectionScanParams::FORWARD ) );
+                it->getNext(); // returns _joinedAt itself
+                _joinedAt = it->getNext(); // its successor, or null if it was last
+            }
+            else {
+                _joinedAt = DiskLoc();
+            }
+        }
+
         if (NULL != _iter) {
             _iter->invalidate(dl);
         }
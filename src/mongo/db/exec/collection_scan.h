@@ -32,6 +32,7 @@
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/quick_matcher.h"
 #include "mongo/db/structure/collection_iterator.h"
 
 namespace mongo {
@@ -48,6 +49,7 @@ namespace mongo {
     public:
         CollectionScan(const CollectionScanParams& params, WorkingSet* workingSet,
                        const MatchExpression* filter);
+        virtual ~CollectionScan();
 
         virtual StageState work(WorkingSetID* out);
         virtual bool isEOF();
@@ -65,6 +67,10 @@ namespace mongo {
         // The filter is not owned by us.
         const MatchExpression* _filter;
 
+        // Flattened form of _filter for simple filters; scans spend most of their time in the
+        // matcher, so eligible filters skip the tree walk per document.
+        QuickMatcher _quickFilter;
+
         scoped_ptr<CollectionIterator> _iter;
 
         CollectionScanParams _params;
@@ -72,6 +78,30 @@ namespace mongo {
         // True if nsdetails(_ns) == NULL on our first call to work.
         bool _nsDropped;
 
+        // Shared ("elevator") scan state.  A full forward scan may join an in-progress scan
+        // over the same namespace: it starts at that scan's position, runs to the end, wraps
+        // around to the beginning, and stops where it joined, so concurrent full scans share
+        // one pass over the disk.
+        //
+        // Where we joined the shared pass; null if we started at the beginning (or at a
+        // caller-supplied position) and never wrap.  invalidate() advances this marker
+        // past a deleted or moved record so the rest of the pass is still visited.
+        DiskLoc _joinedAt;
+
+        // True if we joined an in-progress pass mid-collection and therefore owe a wrap
+        // around to the beginning -- even if _joinedAt is later invalidated away (the
+        // wrapped segment then runs to iterator EOF).
+        bool _sharedPass;
+
+        // True once we've wrapped around to the beginning of the collection.
+        bool _wrapped;
+
+        // True once a wrapped scan has come back around to _joinedAt.
+        bool _done;
+
+        // True if we registered with the ScanCoordinator and must deregister on destruction.
+        bool _registered;
+
         // Stats
         CommonStats _commonStats;
         CollectionScanStats _specificStats;
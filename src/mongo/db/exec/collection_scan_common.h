@@ -53,6 +53,11 @@ namespace mongo {
 
         // Do we want the scan to be 'tailable'?  Only meaningful if the collection is capped.
         bool tailable;
+
+        // If non-empty, surface only these top-level fields of each matching document
+        // (extracted in a single pass over the record) instead of the whole document.
+        // The filter still sees the full document.
+        vector<string> neededFields;
     };
 
 }  // namespace mongo
@@ -0,0 +1,479 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/exec/exchange.h"
+
+#include <deque>
+
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "mongo/bson/util/atomic_int.h"
+#include "mongo/db/client.h"
+#include "mongo/db/clientcursor.h"
+#include "mongo/db/database.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/namespace_details.h"
+#include "mongo/db/pdfile.h"
+#include "mongo/db/query/runner.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/extent.h"
+#include "mongo/db/storage/extent_manager.h"
+#include "mongo/util/background.h"
+
+namespace mongo {
+
+    // Worker threads per eligible collection scan; 0 disables parallel scans.
+    MONGO_EXPORT_SERVER_PARAMETER( internalQueryExchangeWorkers, int, 0 );
+
+    // Process-wide ceiling on concurrent exchange workers; scans that would push the
+    // total past this run single threaded instead.
+    MONGO_EXPORT_SERVER_PARAMETER( internalQueryExchangeMaxThreads, int, 16 );
+
+    static AtomicUInt exchangeThreadsRunning;
+
+    namespace {
+        const size_t kBatchDocs = 256;
+        const int kBatchBytes = 1024 * 1024;
+    }
+
+    /**
+     * The state the stage shares with its workers.  Refcounted (the stage and every
+     * worker hold a shared_ptr) so the stage can be destroyed without waiting for the
+     * workers; they notice 'shutdown' and let go on their own.
+     */
+    class ExchangeStage::Shared {
+    public:
+
+        struct Slice {
+            Slice() : extentIdx( 0 ) { }
+            std::vector<DiskLoc> extents;
+            size_t extentIdx;   // which of 'extents' nextRecord points into
+            DiskLoc nextRecord; // null: advance to the next extent (or, past the last, done)
+        };
+
+        Shared( const std::string& ns_, const BSONObj& filterData_, size_t maxQueuedBatches_ )
+            : ns( ns_ ),
+              filterData( filterData_ ),
+              maxQueuedBatches( maxQueuedBatches_ ),
+              activeWorkers( 0 ),
+              shutdown( false ),
+              failed( false ),
+              forwarder( this ) {
+        }
+
+        ~Shared() {
+            for ( std::deque< std::vector<BSONObj>* >::iterator i = batches.begin();
+                  i != batches.end(); ++i ) {
+                delete *i;
+            }
+        }
+
+        /**
+         * A record one of the slices is parked on is about to be deleted; step the slice
+         * past it.  Called via the forwarder from ClientCursor::aboutToDelete, under the
+         * write lock, so no worker can be mid-batch (batches are filled under a read
+         * lock) and the positions here are authoritative.
+         */
+        void invalidateLoc( const DiskLoc& dl ) {
+            boost::mutex::scoped_lock lk( mutex );
+            const ExtentManager& em = cc().database()->getExtentManager();
+            for ( size_t i = 0; i < slices.size(); ++i ) {
+                Slice& s = slices[i];
+                if ( s.nextRecord != dl )
+                    continue;
+                s.nextRecord = em.getNextRecordInExtent( dl );
+                if ( s.nextRecord.isNull() )
+                    ++s.extentIdx;
+            }
+        }
+
+        void setShutdown() {
+            boost::mutex::scoped_lock lk( mutex );
+            shutdown = true;
+            hasSpace.notify_all();
+        }
+
+        /**
+         * Stub Runner registered with ClientCursor for the scan's lifetime.  It exists
+         * so record deletions (aboutToDelete) and collection-level invalidation (drop,
+         * compact -- ClientCursor::invalidate calls kill()) reach the workers' saved
+         * positions; it never produces results itself.
+         */
+        class Forwarder : public Runner {
+        public:
+            explicit Forwarder( Shared* shared ) : _shared( shared ) { }
+
+            virtual void invalidate( const DiskLoc& dl ) { _shared->invalidateLoc( dl ); }
+            virtual void kill() { _shared->setShutdown(); }
+            virtual const string& ns() { return _shared->ns; }
+
+            // The rest of the Runner interface is unused for a forwarder.
+            virtual RunnerState getNext( BSONObj* objOut, DiskLoc* dlOut ) {
+                return Runner::RUNNER_EOF;
+            }
+            virtual bool isEOF() { return true; }
+            virtual void saveState() { }
+            virtual bool restoreState() { return true; }
+            virtual void setYieldPolicy( YieldPolicy policy ) { }
+            virtual Status getExplainPlan( TypeExplain** explain ) const {
+                return Status( ErrorCodes::InternalError, "exchange forwarder has no plan" );
+            }
+
+        private:
+            Shared* _shared;
+        };
+
+        const std::string ns;
+        const BSONObj filterData;
+        const size_t maxQueuedBatches;
+
+        boost::mutex mutex;
+        boost::condition hasSpace; // queue space freed up, or shutdown
+
+        std::deque< std::vector<BSONObj>* > batches; // owned
+        std::vector<Slice> slices;
+        int activeWorkers;
+        bool shutdown;
+        bool failed;    // a worker couldn't set up; the stage reports FAILURE
+
+        Forwarder forwarder;
+    };
+
+    /**
+     * One scanning thread.  Self deleting; holds its own reference to the shared block
+     * so it can outlive the stage.
+     */
+    class ExchangeStage::Worker : public BackgroundJob {
+    public:
+        Worker( const boost::shared_ptr<Shared>& shared, size_t sliceNum )
+            : BackgroundJob( true /* selfDelete */ ),
+              _shared( shared ),
+              _sliceNum( sliceNum ) {
+        }
+
+        virtual std::string name() const { return "exchange"; }
+
+        virtual void run() {
+            Client::initThread( "exchange" );
+
+            auto_ptr<MatchExpression> filter;
+            {
+                // Our own tree, parsed from the owned filter data, so matching depends
+                // on nothing owned by the stage or the query that built it.
+                StatusWithMatchExpression swme =
+                    MatchExpressionParser::parse( _shared->filterData );
+                if ( !swme.isOK() ) {
+                    boost::mutex::scoped_lock lk( _shared->mutex );
+                    _shared->failed = true;
+                    _shared->shutdown = true;
+                    _shared->hasSpace.notify_all();
+                }
+                else {
+                    filter.reset( swme.getValue() );
+                }
+            }
+
+            bool finished = false;
+            while ( !finished ) {
+                {
+                    boost::mutex::scoped_lock lk( _shared->mutex );
+                    while ( !_shared->shutdown &&
+                            _shared->batches.size() >= _shared->maxQueuedBatches ) {
+                        _shared->hasSpace.wait( lk );
+                    }
+                    if ( _shared->shutdown )
+                        break;
+                }
+
+                auto_ptr< std::vector<BSONObj> > batch( new std::vector<BSONObj>() );
+                {
+                    Client::ReadContext ctx( _shared->ns );
+
+                    // Deletes need the write lock, which we now exclude, so it's safe
+                    // to scan against a local copy of our position and publish it
+                    // again before unlocking.
+                    Shared::Slice slice;
+                    {
+                        boost::mutex::scoped_lock lk( _shared->mutex );
+                        if ( _shared->shutdown )
+                            break;
+                        slice = _shared->slices[_sliceNum];
+                    }
+
+                    finished = _fillBatch( filter.get(), &slice, batch.get() );
+
+                    {
+                        boost::mutex::scoped_lock lk( _shared->mutex );
+                        _shared->slices[_sliceNum] = slice;
+                    }
+                }
+
+                if ( !batch->empty() ) {
+                    boost::mutex::scoped_lock lk( _shared->mutex );
+                    _shared->batches.push_back( batch.release() );
+                }
+            }
+
+            {
+                boost::mutex::scoped_lock lk( _shared->mutex );
+                _shared->activeWorkers--;
+            }
+            exchangeThreadsRunning--;
+            cc().shutdown();
+        }
+
+    private:
+
+        /**
+         * Scans forward from the slice's saved position, appending owned copies of
+         * matching documents to 'batch' until it is full or the slice is exhausted.
+         * Caller holds a read lock.  @return true when the slice is exhausted.
+         */
+        bool _fillBatch( const MatchExpression* filter, Shared::Slice* slice,
+                         std::vector<BSONObj>* batch ) {
+            if ( NULL == nsdetails( _shared->ns ) ) {
+                // dropped out from under us; kill() normally gets here first
+                return true;
+            }
+
+            const ExtentManager& em = cc().database()->getExtentManager();
+            int bytes = 0;
+
+            while ( true ) {
+                if ( slice->nextRecord.isNull() ) {
+                    // move to the first record of the next non-empty extent
+                    while ( slice->extentIdx < slice->extents.size() ) {
+                        Extent* e = em.getExtent( slice->extents[slice->extentIdx] );
+                        if ( !e->firstRecord.isNull() ) {
+                            slice->nextRecord = e->firstRecord;
+                            break;
+                        }
+                        ++slice->extentIdx;
+                    }
+                    if ( slice->nextRecord.isNull() )
+                        return true;
+                }
+
+                BSONObj obj = BSONObj::make( em.recordFor( slice->nextRecord ) );
+
+                slice->nextRecord = em.getNextRecordInExtent( slice->nextRecord );
+                if ( slice->nextRecord.isNull() )
+                    ++slice->extentIdx;
+
+                if ( NULL == filter || filter->matchesBSON( obj ) ) {
+                    batch->push_back( obj.getOwned() );
+                    bytes += obj.objsize();
+                    if ( batch->size() >= kBatchDocs || bytes >= kBatchBytes ) {
+                        return slice->nextRecord.isNull() &&
+                               slice->extentIdx >= slice->extents.size();
+                    }
+                }
+            }
+        }
+
+        boost::shared_ptr<Shared> _shared;
+        size_t _sliceNum;
+    };
+
+    // static
+    int ExchangeStage::suggestedWorkers( const std::string& ns ) {
+        const int requested = internalQueryExchangeWorkers;
+        if ( requested < 2 )
+            return 0;
+
+        NamespaceDetails* nsd = nsdetails( ns );
+        if ( NULL == nsd || nsd->isCapped() )
+            return 0;
+
+        // Each slice needs a couple of extents for the parallelism to pay for the
+        // thread handoff; small collections scan faster in line.
+        int extents = 0;
+        for ( DiskLoc el = nsd->firstExtent(); !el.isNull(); el = el.ext()->xnext )
+            ++extents;
+
+        int workers = requested;
+        if ( workers > extents / 2 )
+            workers = extents / 2;
+        if ( workers < 2 )
+            return 0;
+
+        if ( (int)( exchangeThreadsRunning + workers ) > internalQueryExchangeMaxThreads )
+            return 0;
+
+        return workers;
+    }
+
+    ExchangeStage::ExchangeStage( const std::string& ns, const BSONObj& filterData,
+                                  int numWorkers, WorkingSet* ws )
+        : _ws( ws ),
+          _ns( ns ),
+          _filterData( filterData.getOwned() ),
+          _numWorkers( numWorkers ),
+          _started( false ),
+          _nsDropped( false ),
+          _currentIdx( 0 ) {
+        verify( _numWorkers >= 1 );
+    }
+
+    ExchangeStage::~ExchangeStage() {
+        if ( _shared ) {
+            _shared->setShutdown();
+            // After deregistering, no invalidate/kill can be in flight (both run under
+            // ClientCursor's mutex).  We never join the workers: our caller may hold
+            // the global lock a worker is waiting for.  Each worker keeps the shared
+            // block alive until it notices the shutdown flag and exits.
+            ClientCursor::deregisterRunner( &_shared->forwarder );
+        }
+    }
+
+    bool ExchangeStage::_start() {
+        NamespaceDetails* nsd = nsdetails( _ns );
+        if ( NULL == nsd ) {
+            _nsDropped = true;
+            return false;
+        }
+
+        std::vector<DiskLoc> extents;
+        for ( DiskLoc el = nsd->firstExtent(); !el.isNull(); el = el.ext()->xnext )
+            extents.push_back( el );
+        if ( extents.empty() )
+            return false;
+
+        int numWorkers = _numWorkers;
+        if ( numWorkers > (int)extents.size() )
+            numWorkers = (int)extents.size();
+
+        _shared.reset( new Shared( _ns, _filterData, 2 * (size_t)numWorkers ) );
+
+        // Contiguous runs of extents per slice, so each worker reads the disk roughly
+        // sequentially.
+        _shared->slices.resize( numWorkers );
+        for ( int i = 0; i < numWorkers; ++i ) {
+            const size_t begin = extents.size() * i / numWorkers;
+            const size_t end = extents.size() * ( i + 1 ) / numWorkers;
+            _shared->slices[i].extents.assign( extents.begin() + begin,
+                                               extents.begin() + end );
+        }
+        _shared->activeWorkers = numWorkers;
+
+        ClientCursor::registerRunner( &_shared->forwarder );
+
+        for ( int i = 0; i < numWorkers; ++i ) {
+            exchangeThreadsRunning++;
+            Worker* w = new Worker( _shared, i ); // deletes itself when run() returns
+            w->go();
+        }
+        return true;
+    }
+
+    PlanStage::StageState ExchangeStage::work( WorkingSetID* out ) {
+        ScopedWorkTimer workTimer( &_commonStats );
+        ++_commonStats.works;
+
+        if ( _nsDropped ) { return PlanStage::IS_EOF; }
+
+        if ( !_started ) {
+            _started = true;
+            if ( !_start() ) {
+                return PlanStage::IS_EOF;
+            }
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+
+        if ( !_shared ) { return PlanStage::IS_EOF; } // _start() found nothing to scan
+
+        if ( _currentIdx >= _current.size() ) {
+            _current.clear();
+            _currentIdx = 0;
+
+            boost::mutex::scoped_lock lk( _shared->mutex );
+            if ( _shared->failed ) {
+                return PlanStage::FAILURE;
+            }
+            if ( !_shared->batches.empty() ) {
+                std::vector<BSONObj>* batch = _shared->batches.front();
+                _shared->batches.pop_front();
+                _shared->hasSpace.notify_all();
+                _current.swap( *batch );
+                delete batch;
+            }
+            else if ( 0 == _shared->activeWorkers ) {
+                return PlanStage::IS_EOF;
+            }
+            else {
+                // Workers are still scanning.  Burn a cycle rather than block: we may
+                // be under the global read lock, and waiting here would hold it.
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+        }
+
+        WorkingSetID id = _ws->allocate();
+        WorkingSetMember* member = _ws->get( id );
+        member->obj = _current[_currentIdx++];
+        member->state = WorkingSetMember::OWNED_OBJ;
+        *out = id;
+        ++_commonStats.advanced;
+        return PlanStage::ADVANCED;
+    }
+
+    bool ExchangeStage::isEOF() {
+        if ( _nsDropped ) { return true; }
+        if ( !_started ) { return false; }
+        if ( !_shared ) { return true; } // _start() found nothing to scan
+        if ( _currentIdx < _current.size() ) { return false; }
+        boost::mutex::scoped_lock lk( _shared->mutex );
+        return _shared->batches.empty() && 0 == _shared->activeWorkers;
+    }
+
+    void ExchangeStage::invalidate( const DiskLoc& dl ) {
+        ++_commonStats.invalidates;
+        // The forwarder already stepped any slice parked on dl; adjusting here as well
+        // would step it twice and skip a live record.  Everything we hand out is owned,
+        // so nothing else of ours can be invalidated.
+    }
+
+    void ExchangeStage::prepareToYield() {
+        ++_commonStats.yields;
+        // The current batch is owned objects and the workers hold their own locks;
+        // nothing to save.
+    }
+
+    void ExchangeStage::recoverFromYield() {
+        ++_commonStats.unyields;
+    }
+
+    PlanStageStats* ExchangeStage::getStats() {
+        _commonStats.isEOF = isEOF();
+        return new PlanStageStats( _commonStats, STAGE_EXCHANGE );
+    }
+
+}  // namespace mongo
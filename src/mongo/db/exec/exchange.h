@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    /**
+     * Parallel table scan ("exchange").  The collection's extents are partitioned into
+     * contiguous slices, one per worker thread; each worker scans its slice under its own
+     * read lock, applies the query predicate, and hands owned results back through a
+     * bounded batch queue.  The stage is the single consumer: work() drains batches and
+     * surfaces one owned object at a time, so stages above it see an ordinary (unordered)
+     * stream of matching documents.
+     *
+     * Safety model:
+     *  - workers touch mmap'd data only while holding a read lock, and persist their scan
+     *    position (a DiskLoc inside one of their extents) before releasing it;
+     *  - record deletions reach saved positions through a registered invalidation
+     *    forwarder (a stub Runner), under the global write lock -- when no worker can be
+     *    mid-batch -- and nudge the position past the dying record exactly the way
+     *    ClientCursor::aboutToDelete nudges cursors.  Collection-level invalidation
+     *    (drop, compact) kills the forwarder, which stops the workers;
+     *  - everything the workers touch lives in a refcounted shared block, so tearing the
+     *    stage down never joins threads (our caller may hold the global lock, and a join
+     *    would deadlock against a worker waiting for that lock).  Workers notice the
+     *    shutdown flag after taking their next read lock and exit on their own.
+     *
+     * Built only by the planner, for forward non-tailable scans of uncapped collections
+     * at the root of the plan, and only when internalQueryExchangeWorkers > 0.  Results
+     * are unordered, so explicit $natural-order scans are never eligible.
+     */
+    class ExchangeStage : public PlanStage {
+    public:
+
+        /**
+         * @return how many workers a parallel scan of 'ns' should use, or 0 if the scan
+         * should not be parallelized (feature off, collection small, or too many exchange
+         * workers already running).  Must be called within a lock on 'ns'.
+         */
+        static int suggestedWorkers( const std::string& ns );
+
+        ExchangeStage( const std::string& ns, const BSONObj& filterData, int numWorkers,
+                       WorkingSet* ws );
+        virtual ~ExchangeStage();
+
+        virtual StageState work( WorkingSetID* out );
+        virtual bool isEOF();
+
+        virtual void invalidate( const DiskLoc& dl );
+        virtual void prepareToYield();
+        virtual void recoverFromYield();
+
+        virtual PlanStageStats* getStats();
+
+    private:
+
+        // Worker threads and the state they share with us; defined in exchange.cpp.
+        class Shared;
+        class Worker;
+
+        /**
+         * Snapshots the extent list, slices it and spawns the workers.  Called on the
+         * first work(), under the query's read lock.  @return false if there is nothing
+         * to scan (missing or empty collection).
+         */
+        bool _start();
+
+        // Not owned by us.
+        WorkingSet* _ws;
+
+        std::string _ns;
+
+        // Owned copy of the predicate; each worker parses its own MatchExpression from
+        // this, so evaluation needs nothing owned by the stage or the query.
+        BSONObj _filterData;
+
+        int _numWorkers;
+        bool _started;
+        bool _nsDropped;
+
+        // Kept alive by us and by every worker.
+        boost::shared_ptr<Shared> _shared;
+
+        // The batch currently being drained by work().
+        std::vector<BSONObj> _current;
+        size_t _currentIdx;
+
+        CommonStats _commonStats;
+    };
+
+}  // namespace mongo
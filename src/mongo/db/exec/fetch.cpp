@@ -28,9 +28,14 @@
 
 #include "mongo/db/exec/fetch.h"
 
+#include <algorithm>
+
+#include "mongo/bson/util/atomic_int.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/util/concurrency/synchronization.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point_service.h"
 
 namespace mongo {
@@ -39,6 +44,76 @@ namespace mongo {
     MONGO_FP_DECLARE(fetchInMemoryFail);
     MONGO_FP_DECLARE(fetchInMemorySucceed);
 
+    // How many results we read ahead from our child when we hit a record that's not in memory.
+    // Bigger batches sort into longer sequential runs on disk (see lookaheadFetch) but hold
+    // more results buffered against invalidates.
+    const size_t kLookahead = 32;
+
+    namespace {
+
+        // Pool that faults cold records in.  Lazily created; many deployments never fault.
+        // The tasks don't take any locks: the FetchStage that scheduled a batch blocks until
+        // the whole batch is done and it holds the read lock the whole time, so the files
+        // backing the records can't be closed out from under the pool.
+        SimpleMutex touchPoolMutex("recordTouchPool");
+        ThreadPool* touchPool = NULL;
+
+        struct TouchBatch {
+            TouchBatch(unsigned n) : left(n) { }
+            AtomicUInt left;
+            Notification done;
+        };
+
+        void touchTask(Record* record, TouchBatch* batch) {
+            try {
+                record->touch();
+            }
+            catch (const DBException&) {
+                // We were only warming pages; the consumer will find out for real.
+            }
+            if (0 == --batch->left) {
+                batch->done.notifyOne();
+            }
+        }
+
+        // Fault in every record in 'cold', overlapping the page faults instead of taking them
+        // one at a time.  Blocks until all of them have been touched.
+        void touchColdRecords(const vector<Record*>& cold) {
+            if (cold.empty()) { return; }
+
+            TouchBatch batch(cold.size() - 1);
+            {
+                SimpleMutex::scoped_lock lk(touchPoolMutex);
+                if (NULL == touchPool) {
+                    touchPool = new ThreadPool();
+                }
+                for (size_t i = 1; i < cold.size(); ++i) {
+                    touchPool->schedule(&touchTask, cold[i], &batch);
+                }
+            }
+
+            // Touch the first one ourselves rather than sitting idle.  We can't leave before
+            // the pool is done with the batch (it points into our stack), so swallow here.
+            try {
+                cold[0]->touch();
+            }
+            catch (const DBException&) { }
+
+            if (cold.size() > 1) {
+                batch.done.waitToBeNotified();
+            }
+        }
+
+        // Orders a cold batch by physical position (file number, then offset within the file)
+        // so the page faults walk the data files front to back instead of hopping around in
+        // key order.
+        bool byDiskLoc(const std::pair<DiskLoc, Record*>& lhs,
+                       const std::pair<DiskLoc, Record*>& rhs) {
+            return lhs.first < rhs.first;
+        }
+
+    }  // namespace
+
     FetchStage::FetchStage(WorkingSet* ws, PlanStage* child, const MatchExpression* filter)
         : _ws(ws), _child(child), _filter(filter), _idBeingPagedIn(WorkingSet::INVALID_ID) { }
 
@@ -51,6 +126,9 @@ namespace mongo {
             return false;
         }
 
+        // We buffered results ahead of the consumer and haven't handed them all out yet.
+        if (!_lookahead.empty()) { return false; }
+
         return _child->isEOF();
     }
 
@@ -67,6 +145,7 @@ namespace mongo {
     }
 
     PlanStage::StageState FetchStage::work(WorkingSetID* out) {
+        ScopedWorkTimer workTimer(&_commonStats);
         ++_commonStats.works;
 
         if (isEOF()) { return PlanStage::IS_EOF; }
@@ -77,6 +156,13 @@ namespace mongo {
             return fetchCompleted(out);
         }
 
+        // Hand out read-ahead results before going back to the child.
+        if (!_lookahead.empty()) {
+            WorkingSetID id = _lookahead.front();
+            _lookahead.pop_front();
+            return completeFetch(id, out);
+        }
+
         // If we're here, we're not waiting for a DiskLoc to be fetched.  Get another to-be-fetched
         // result from our child.
         WorkingSetID id;
@@ -96,23 +182,18 @@ namespace mongo {
             verify(member->hasLoc());
 
             Record* record = member->loc.rec();
-            const char* data = record->dataNoThrowing();
 
-            if (!recordInMemory(data)) {
-                // member->loc points to a record that's NOT in memory.  Pass a fetch request up.
-                verify(WorkingSet::INVALID_ID == _idBeingPagedIn);
-                _idBeingPagedIn = id;
-                *out = id;
-                ++_commonStats.needFetch;
-                return PlanStage::NEED_FETCH;
-            }
-            else {
-                // Don't need index data anymore as we have an obj.
-                member->keyData.clear();
-                member->obj = BSONObj(data);
-                member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
-                return returnIfMatches(member, id, out);
+            if (!recordInMemory(record->dataNoThrowing())) {
+                // Cold record.  Read ahead from the child and fault this record in along with
+                // the upcoming ones rather than waiting on them one at a time.
+                return lookaheadFetch(id, out);
             }
+
+            // Don't need index data anymore as we have an obj.
+            member->keyData.clear();
+            member->obj = BSONObj(record->dataNoThrowing());
+            member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+            return returnIfMatches(member, id, out);
         }
         else {
             if (PlanStage::NEED_FETCH == status) {
@@ -153,6 +234,16 @@ namespace mongo {
                 ++_specificStats.forcedFetches;
             }
         }
+
+        // Buffered read-ahead results hang on to their locs too.
+        for (std::deque<WorkingSetID>::const_iterator it = _lookahead.begin();
+             it != _lookahead.end(); ++it) {
+            WorkingSetMember* member = _ws->get(*it);
+            if (member->hasLoc() && member->loc == dl) {
+                WorkingSetCommon::fetchAndInvalidateLoc(member);
+                ++_specificStats.forcedFetches;
+            }
+        }
     }
 
     PlanStage::StageState FetchStage::fetchCompleted(WorkingSetID* out) {
@@ -188,6 +279,102 @@ namespace mongo {
         return returnIfMatches(member, memberID, out);
     }
 
+    PlanStage::StageState FetchStage::completeFetch(WorkingSetID memberID, WorkingSetID* out) {
+        WorkingSetMember* member = _ws->get(memberID);
+
+        // An invalidate while the batch was buffered forces the fetch of affected members.
+        if (member->hasObj()) {
+            return returnIfMatches(member, memberID, out);
+        }
+
+        verify(WorkingSetMember::LOC_AND_IDX == member->state);
+        verify(member->hasLoc());
+
+        Record* record = member->loc.rec();
+        const char* data = record->dataNoThrowing();
+
+        if (!recordInMemory(data)) {
+            // The record went cold again (or never warmed).  Pass a fetch request up.
+            verify(WorkingSet::INVALID_ID == _idBeingPagedIn);
+            _idBeingPagedIn = memberID;
+            *out = memberID;
+            ++_commonStats.needFetch;
+            return PlanStage::NEED_FETCH;
+        }
+
+        // Don't need index data anymore as we have an obj.
+        member->keyData.clear();
+        member->obj = BSONObj(data);
+        member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+        return returnIfMatches(member, memberID, out);
+    }
+
+    PlanStage::StageState FetchStage::lookaheadFetch(WorkingSetID triggerID, WorkingSetID* out) {
+        verify(_lookahead.empty());
+
+        vector<std::pair<DiskLoc, Record*> > cold;
+        _lookahead.push_back(triggerID);
+        cold.push_back(std::make_pair(_ws->get(triggerID)->loc,
+                                      _ws->get(triggerID)->loc.rec()));
+
+        // Read ahead from the child.  Whatever it can produce without an unreasonable amount
+        // of work goes into the buffer; the cold records are collected so we can fault them
+        // all in at once.
+        WorkingSetID childRequest = WorkingSet::INVALID_ID;
+        StageState childStatus = PlanStage::NEED_TIME;
+        for (size_t works = 0; _lookahead.size() < kLookahead && works < 2 * kLookahead;
+             ++works) {
+            WorkingSetID id;
+            childStatus = _child->work(&id);
+
+            if (PlanStage::ADVANCED == childStatus) {
+                WorkingSetMember* member = _ws->get(id);
+                _lookahead.push_back(id);
+                if (!member->hasObj() && member->hasLoc()) {
+                    Record* record = member->loc.rec();
+                    if (!recordInMemory(record->dataNoThrowing())) {
+                        cold.push_back(std::make_pair(member->loc, record));
+                    }
+                }
+            }
+            else if (PlanStage::NEED_TIME == childStatus) {
+                continue;
+            }
+            else {
+                // IS_EOF ends the read-ahead; NEED_FETCH and FAILURE belong to our parent but
+                // only after the batch is warm.
+                childRequest = id;
+                break;
+            }
+        }
+
+        // An index scan hands us locs in key order, which is effectively random record
+        // order.  Fault the batch in sorted by DiskLoc so the disk sees one mostly
+        // sequential pass; _lookahead still hands results out in the order the child
+        // produced them, so the consumer never notices.
+        std::sort(cold.begin(), cold.end(), byDiskLoc);
+        vector<Record*> coldRecords;
+        coldRecords.reserve(cold.size());
+        for (size_t i = 0; i < cold.size(); ++i) {
+            coldRecords.push_back(cold[i].second);
+        }
+        touchColdRecords(coldRecords);
+        _specificStats.recordsPrefetched += coldRecords.size();
+
+        if (PlanStage::NEED_FETCH == childStatus || PlanStage::FAILURE == childStatus) {
+            *out = childRequest;
+            if (PlanStage::NEED_FETCH == childStatus) {
+                ++_commonStats.needFetch;
+            }
+            return childStatus;
+        }
+
+        // Serve the triggering result; the rest of the buffer waits for later calls.
+        WorkingSetID id = _lookahead.front();
+        _lookahead.pop_front();
+        return completeFetch(id, out);
+    }
+
     PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID memberID,
                                                       WorkingSetID* out) {
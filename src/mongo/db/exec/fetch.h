@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include "mongo/db/diskloc.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
@@ -70,6 +72,19 @@ namespace mongo {
          */
         StageState fetchCompleted(WorkingSetID* out);
 
+        /**
+         * Turn the record behind memberID into an object, or, if it's not in memory, ask our
+         * parent to page it in.
+         */
+        StageState completeFetch(WorkingSetID memberID, WorkingSetID* out);
+
+        /**
+         * Called when the child handed us triggerID and its record is not in memory.  Reads
+         * ahead from the child into _lookahead and faults all the cold records in at once so
+         * they come in at device queue depth rather than one at a time.
+         */
+        StageState lookaheadFetch(WorkingSetID triggerID, WorkingSetID* out);
+
         // _ws is not owned by us.
         WorkingSet* _ws;
         scoped_ptr<PlanStage> _child;
@@ -81,6 +96,10 @@ namespace mongo {
         // a "please page this in" result and hold on to the WSID until the next call to work(...).
         WorkingSetID _idBeingPagedIn;
 
+        // Results we read ahead of the consumer when we hit a cold record; their records were
+        // touched as a batch and they're handed out, in order, before we go back to our child.
+        std::deque<WorkingSetID> _lookahead;
+
         // Stats
         CommonStats _commonStats;
         FetchStats _specificStats;
@@ -54,7 +54,7 @@ namespace mongo {
             // BSONElementIterator does some interesting things with arrays that I don't think
             // SimpleArrayElementIterator does.
             if (_wsm->hasObj()) {
-                return new BSONElementIterator(path, _wsm->obj);
+                return new BSONElementIterator(path, _wsm->obj, &_memo);
             }
 
             // NOTE: This (kind of) duplicates code in WorkingSetMember::getFieldDotted.
@@ -94,6 +94,9 @@ namespace mongo {
 
     private:
         WorkingSetMember* _wsm;
+
+        // Shared by the iterators we allocate; they're all rooted at _wsm->obj.
+        mutable PathTraversalMemo _memo;
     };
 
     /**
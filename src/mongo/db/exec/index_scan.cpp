@@ -81,6 +81,7 @@ namespace mongo {
     }
 
     PlanStage::StageState IndexScan::work(WorkingSetID* out) {
+        ScopedWorkTimer workTimer(&_commonStats);
         ++_commonStats.works;
 
         if (NULL == _indexCursor.get()) {
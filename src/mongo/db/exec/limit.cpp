@@ -38,6 +38,7 @@ namespace mongo {
     bool LimitStage::isEOF() { return (0 == _numToReturn) || _child->isEOF(); }
 
     PlanStage::StageState LimitStage::work(WorkingSetID* out) {
+        ScopedWorkTimer workTimer(&_commonStats);
         ++_commonStats.works;
 
         // If we've returned as many results as we're limited to, isEOF will be true.
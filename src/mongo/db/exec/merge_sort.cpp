@@ -55,6 +55,7 @@ namespace mongo {
     }
 
     PlanStage::StageState MergeSortStage::work(WorkingSetID* out) {
+        ScopedWorkTimer workTimer(&_commonStats);
         ++_commonStats.works;
 
         if (isEOF()) { return PlanStage::IS_EOF; }
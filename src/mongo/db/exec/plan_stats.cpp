@@ -38,6 +38,12 @@ namespace mongo {
         // potential overflow because original counters are unsigned 64-bit values
         bob->append("works", static_cast<long long>(works));
         bob->append("advanced", static_cast<long long>(advanced));
+        if (workTimeSamples > 0) {
+            bob->append("workTimeSamples", static_cast<long long>(workTimeSamples));
+            // the sampled average extrapolated over every work() call
+            bob->append("estimatedWorkTimeMicros",
+                        static_cast<long long>(sampledWorkTimeMicros * works / workTimeSamples));
+        }
     }
 
     // forward to CommonStats for now
@@ -37,6 +37,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/stage_types.h"
 #include "mongo/platform/cstdint.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -51,8 +52,16 @@ namespace mongo {
                         advanced(0),
                         needTime(0),
                         needFetch(0),
+                        workTimeSamples(0),
+                        sampledWorkTimeMicros(0),
                         isEOF(false) { }
 
+        /**
+         * Appends the explain-visible subset of these counters to 'bob'.  Tolerates a NULL
+         * builder (appends nothing).
+         */
+        void writeExplainTo(BSONObjBuilder* bob) const;
+
         // Count calls into the stage.
         uint64_t works;
         uint64_t yields;
@@ -64,17 +73,46 @@ namespace mongo {
         uint64_t needTime;
         uint64_t needFetch;
 
+        // Sampled timing of work(): every kWorkTimeSampleIntervalth call is timed (see
+        // ScopedWorkTimer).  Extrapolate with works / workTimeSamples to estimate the total
+        // time spent in this stage.
+        uint64_t workTimeSamples;
+        uint64_t sampledWorkTimeMicros;
+
         // TODO: have some way of tracking WSM sizes (or really any series of #s).  We can measure
         // the size of our inputs and the size of our outputs.  We can do a lot with the WS here.
 
-        // TODO: once we've picked a plan, collect different (or additional) stats for display to
-        // the user, eg. time_t totalTimeSpent;
-
         // TODO: keep track of total yield time / fetch time for a plan (done by runner)
 
         bool isEOF;
     };
 
+    // Time one work() call out of this many.  Two clock reads per sampled call keeps the
+    // overhead well under 1% so the accounting can stay on in production.
+    const uint64_t kWorkTimeSampleInterval = 64;
+
+    /**
+     * Declare one of these on the stack at the top of a stage's work(), before the works
+     * counter is bumped; if this call is due for a sample, the destructor adds its elapsed
+     * time to the stats.
+     */
+    class ScopedWorkTimer {
+    public:
+        explicit ScopedWorkTimer(CommonStats* stats)
+            : _stats(stats->works % kWorkTimeSampleInterval == 0 ? stats : NULL) { }
+
+        ~ScopedWorkTimer() {
+            if (NULL != _stats) {
+                ++_stats->workTimeSamples;
+                _stats->sampledWorkTimeMicros += _timer.micros();
+            }
+        }
+
+    private:
+        CommonStats* _stats;
+        Timer _timer;
+    };
+
     // The universal container for a stage's stats.
     struct PlanStageStats {
         PlanStageStats(const CommonStats& c, StageType t) : stageType(t), common(c) { }
@@ -85,6 +123,12 @@ namespace mongo {
             }
         }
 
+        /**
+         * Appends the explain-visible stats for this stage to 'bob'.  Tolerates a NULL
+         * builder (appends nothing).
+         */
+        void writeExplainTo(BSONObjBuilder* bob) const;
+
         // See query/stage_type.h
         StageType stageType;
 
@@ -117,7 +161,9 @@ namespace mongo {
 
     struct AndHashStats : public SpecificStats {
         AndHashStats() : flaggedButPassed(0),
-                         flaggedInProgress(0) { }
+                         flaggedInProgress(0),
+                         memUsage(0),
+                         memLimit(0) { }
 
         virtual ~AndHashStats() { }
 
@@ -135,6 +181,10 @@ namespace mongo {
 
         // mapAfterChild[mapAfterChild.size() - 1] WSMswere match tested.
         // commonstats.advanced is how many passed.
+
+        // What's our current memory usage, and what are we willing to buffer?
+        uint64_t memUsage;
+        uint64_t memLimit;
     };
 
     struct AndSortedStats : public SpecificStats {
@@ -156,7 +206,8 @@ namespace mongo {
     struct FetchStats : public SpecificStats {
         FetchStats() : alreadyHasObj(0),
                        forcedFetches(0),
-                       matchTested(0) { }
+                       matchTested(0),
+                       recordsPrefetched(0) { }
 
         virtual ~FetchStats() { }
 
@@ -172,6 +223,9 @@ namespace mongo {
 
         // We know how many passed (it's the # of advanced) and therefore how many failed.
         uint64_t matchTested;
+
+        // How many cold records did we fault in as part of a read-ahead batch?
+        uint64_t recordsPrefetched;
     };
 
     struct IndexScanStats : public SpecificStats {
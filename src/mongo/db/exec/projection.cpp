@@ -38,13 +38,112 @@ namespace mongo {
 
     ProjectionStage::ProjectionStage(ParsedProjection* projection, WorkingSet* ws, PlanStage* child,
                                      const MatchExpression* filter)
-        : _projection(projection), _ws(ws), _child(child), _filter(filter) { }
+        : _projection(projection),
+          _ws(ws),
+          _child(child),
+          _filter(filter),
+          _coveredMapValid(false),
+          _coveredPatternData(NULL),
+          _coveredMaxSlot(0),
+          _coveredLastSize(64) {
+
+        // A plain inclusion list that doesn't need the document can be answered
+        // straight from index key data.
+        _coveredEligible = ParsedProjection::FIND_SYNTAX == projection->getType()
+                           && !projection->requiresDocument();
+    }
 
     ProjectionStage::~ProjectionStage() { }
 
+    bool ProjectionStage::applyCovered(WorkingSetMember* member) {
+        if (!_coveredEligible || member->hasObj() || 1 != member->keyData.size()) {
+            return false;
+        }
+
+        const IndexKeyDatum& ikd = member->keyData[0];
+
+        // An index scan hands up the same key pattern buffer every row, so after the
+        // first row this is a pointer compare.
+        if (!_coveredMapValid
+            || (ikd.indexKeyPattern.objdata() != _coveredPatternData
+                && 0 != ikd.indexKeyPattern.woCompare(_coveredPattern))) {
+
+            // Compile the field -> key slot map for this pattern.
+            _coveredMapValid = false;
+            _coveredOutput.clear();
+            _coveredMaxSlot = 0;
+            _coveredPattern = ikd.indexKeyPattern.getOwned();
+            _coveredPatternData = ikd.indexKeyPattern.objdata();
+
+            const FindProjection* proj = static_cast<const FindProjection*>(_projection);
+
+            // Output order matches the generic path: _id first if included, then the
+            // inclusion list.
+            vector<string> names;
+            if (proj->_includeID) {
+                names.push_back("_id");
+            }
+            for (size_t i = 0; i < proj->_includedFields.size(); ++i) {
+                if ("_id" != proj->_includedFields[i]) {
+                    names.push_back(proj->_includedFields[i]);
+                }
+            }
+
+            for (size_t i = 0; i < names.size(); ++i) {
+                size_t slot = 0;
+                bool found = false;
+                BSONObjIterator patIt(_coveredPattern);
+                while (patIt.more()) {
+                    BSONElement patElt = patIt.next();
+                    if (names[i] == patElt.fieldName()) {
+                        found = true;
+                        break;
+                    }
+                    ++slot;
+                }
+                if (!found) {
+                    // Field isn't in this key; let the generic path decide what that
+                    // means (skip, or error for a missing _id).
+                    return false;
+                }
+                _coveredOutput.push_back(make_pair(names[i], slot));
+                if (slot > _coveredMaxSlot) {
+                    _coveredMaxSlot = slot;
+                }
+            }
+            _coveredMapValid = true;
+        }
+
+        // Gather the key's elements by position (index keys have empty field names).
+        BSONElement keyElts[64];
+        size_t nElts = 0;
+        BSONObjIterator keyIt(ikd.keyData);
+        while (keyIt.more() && nElts < 64) {
+            keyElts[nElts++] = keyIt.next();
+        }
+        if (_coveredMaxSlot >= nElts) {
+            return false;
+        }
+
+        // Presized off the previous row, so steady state is one exact allocation for
+        // the owned output object and no builder growth.
+        BSONObjBuilder bob(_coveredLastSize);
+        for (size_t i = 0; i < _coveredOutput.size(); ++i) {
+            bob.appendAs(keyElts[_coveredOutput[i].second], _coveredOutput[i].first);
+        }
+
+        member->state = WorkingSetMember::OWNED_OBJ;
+        member->obj = bob.obj();
+        member->keyData.clear();
+        member->loc = DiskLoc();
+        _coveredLastSize = member->obj.objsize();
+        return true;
+    }
+
     bool ProjectionStage::isEOF() { return _child->isEOF(); }
 
     PlanStage::StageState ProjectionStage::work(WorkingSetID* out) {
+        ScopedWorkTimer workTimer(&_commonStats);
         ++_commonStats.works;
 
         if (isEOF()) { return PlanStage::IS_EOF; }
@@ -53,10 +152,12 @@ namespace mongo {
 
         if (PlanStage::ADVANCED == status) {
             WorkingSetMember* member = _ws->get(id);
-            Status status = ProjectionExecutor::apply(_projection, member);
-            if (!status.isOK()) {
-                warning() << "Couldn't execute projection: " << status.toString() << endl;
-                return PlanStage::FAILURE;
+            if (!applyCovered(member)) {
+                Status status = ProjectionExecutor::apply(_projection, member);
+                if (!status.isOK()) {
+                    warning() << "Couldn't execute projection: " << status.toString() << endl;
+                    return PlanStage::FAILURE;
+                }
             }
             *out = id;
             ++_commonStats.advanced;
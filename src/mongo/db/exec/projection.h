@@ -55,6 +55,14 @@ namespace mongo {
         PlanStageStats* getStats();
 
     private:
+        /**
+         * Fast path for covered members: emits the output straight from index key
+         * data through a compiled field -> key slot map, skipping the generic
+         * per-field lookups in ProjectionExecutor.  Returns false if this member
+         * can't go through the fast path (caller falls back to the executor).
+         */
+        bool applyCovered(WorkingSetMember* member);
+
         // Not owned by us.
         ParsedProjection* _projection;
 
@@ -65,6 +73,17 @@ namespace mongo {
         // The filter is not owned by us.
         const MatchExpression* _filter;
 
+        // Covered fast path state.  The slot map is compiled lazily off the first
+        // covered member's key pattern (the stage doesn't know at build time which
+        // index the child scan will use) and recompiled if the pattern changes.
+        bool _coveredEligible;              // projection shape allows the fast path
+        bool _coveredMapValid;
+        BSONObj _coveredPattern;            // owned copy of the mapped key pattern
+        const char* _coveredPatternData;    // unowned; cheap same-pattern check
+        std::vector< std::pair<std::string, size_t> > _coveredOutput; // name -> key slot
+        size_t _coveredMaxSlot;
+        int _coveredLastSize;               // presize the builder off the last row
+
         // Stats
         CommonStats _commonStats;
     };
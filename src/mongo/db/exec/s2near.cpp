@@ -93,6 +93,7 @@ namespace mongo {
     PlanStage::StageState S2NearStage::work(WorkingSetID* out) {
         if (_failed) { return PlanStage::FAILURE; }
         if (isEOF()) { return PlanStage::IS_EOF; }
+        ScopedWorkTimer workTimer(&_commonStats);
         ++_commonStats.works;
 
         // If we haven't opened up our very first ixscan+fetch children, do it.  This is kind of
@@ -141,6 +142,12 @@ namespace mongo {
         // We might have just grown our radius beyond anything reasonable.
         if (isEOF()) { return; }
 
+        // Results we measured on earlier scans may now fall inside the annulus.
+        while (!_deferred.empty() && _deferred.top().distance < _outerRadius) {
+            _results.push(_deferred.top());
+            _deferred.pop();
+        }
+
         // Step 2: Fill out bounds for the ixscan we use.
         _innerCap = S2Cap::FromAxisAngle(_nearQuery.centroid.point,
                                          S1Angle::Radians(_innerRadius / kRadiusOfEarthInMeters));
@@ -206,15 +213,22 @@ namespace mongo {
         // TODO Speed improvements:
         //
         // 0. Modify fetch to preserve key data and test for intersection w/annulus.
-        //
-        // 1. keep track of what we've seen in this scan and possibly ignore it.
-        //
-        // 2. keep track of results we've returned before and ignore them.
 
         WorkingSetMember* member = _ws->get(*out);
         // Must have an object in order to get geometry out of it.
         verify(member->hasObj());
 
+        if (member->hasLoc()) {
+            // The covers of successive annuli share their boundary cells, so each scan
+            // revisits part of the previous one.  If we measured this doc already its
+            // result (if any) is sitting in _results or _deferred.
+            if (_seenDocs.count(member->loc) > 0) {
+                _ws->free(*out);
+                return PlanStage::NEED_TIME;
+            }
+            _seenDocs.insert(member->loc);
+        }
+
         // Get all the fields with that name from the document.
         BSONElementSet geom;
         member->obj.getFieldsDotted(_nearQuery.field, geom, false);
@@ -242,6 +256,14 @@ namespace mongo {
                 _invalidationMap[member->loc] = *out;
             }
         }
+        else if (minDistance >= _outerRadius && minDistance < _maxDistance) {
+            // Belongs to a shell we haven't searched yet.  Hang on to it so growing the
+            // annulus doesn't fetch and measure it all over again.
+            _deferred.push(Result(*out, minDistance));
+            if (member->hasLoc()) {
+                _invalidationMap[member->loc] = *out;
+            }
+        }
 
         return PlanStage::NEED_TIME;
     }
@@ -263,6 +285,9 @@ namespace mongo {
             _child->invalidate(dl);
         }
 
+        // The DiskLoc might be reused for another document, which we'd have to measure.
+        _seenDocs.erase(dl);
+
         unordered_map<DiskLoc, WorkingSetID, DiskLoc::Hasher>::iterator it
             = _invalidationMap.find(dl);
 
@@ -115,6 +115,16 @@ namespace mongo {
         // We compute an annulus of results and cache it here.
         priority_queue<Result> _results;
 
+        // Documents we measured that belong to a shell we haven't reached yet:
+        // distance >= _outerRadius but within _maxDistance.  Covers of successive
+        // annuli share boundary cells, so without this we'd fetch and measure these
+        // documents again on a later scan.  Drained into _results as the annulus grows.
+        priority_queue<Result> _deferred;
+
+        // DiskLocs we've already fetched and measured, so overlapping annulus covers
+        // pay the fetch + distance computation only once per document.
+        unordered_set<DiskLoc, DiskLoc::Hasher> _seenDocs;
+
         // For fast invalidation.  Perhaps not worth it.
         unordered_map<DiskLoc, WorkingSetID, DiskLoc::Hasher> _invalidationMap;
 
@@ -0,0 +1,73 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/exec/scan_coordinator.h"
+
+namespace mongo {
+
+    ScanCoordinator::ScanCoordinator() : _mutex( "ScanCoordinator" ) {
+    }
+
+    void ScanCoordinator::add( const void* scan, const std::string& ns ) {
+        SimpleMutex::scoped_lock lk( _mutex );
+        Entry& entry = _scans[ scan ];
+        entry.ns = ns;
+        entry.pos = DiskLoc();
+    }
+
+    void ScanCoordinator::setPosition( const void* scan, const DiskLoc& loc ) {
+        SimpleMutex::scoped_lock lk( _mutex );
+        ScanMap::iterator it = _scans.find( scan );
+        if ( it != _scans.end() )
+            it->second.pos = loc;
+    }
+
+    void ScanCoordinator::remove( const void* scan ) {
+        SimpleMutex::scoped_lock lk( _mutex );
+        _scans.erase( scan );
+    }
+
+    DiskLoc ScanCoordinator::joinPosition( const std::string& ns ) const {
+        SimpleMutex::scoped_lock lk( _mutex );
+        // Any in-flight position gives us cache locality; take the first one we find.
+        for ( ScanMap::const_iterator it = _scans.begin(); it != _scans.end(); ++it ) {
+            if ( it->second.ns == ns && !it->second.pos.isNull() )
+                return it->second.pos;
+        }
+        return DiskLoc();
+    }
+
+    namespace {
+        ScanCoordinator globalScanCoordinator;
+    }
+
+    ScanCoordinator& ScanCoordinator::instance() {
+        return globalScanCoordinator;
+    }
+
+}  // namespace mongo
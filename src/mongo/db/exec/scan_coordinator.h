@@ -0,0 +1,87 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "mongo/db/diskloc.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /**
+     * Tracks the positions of in-progress full collection scans so that a new scan over the
+     * same namespace can join an existing pass ("elevator" scanning).  A joining scan starts
+     * at the reported position, runs to the end of the collection, wraps around to the
+     * beginning, and stops where it joined -- so N concurrent full scans read each page from
+     * disk roughly once instead of N times.
+     *
+     * Positions are cache-locality hints only: each scan still independently covers the whole
+     * collection, so a stale position just means the joiner re-reads a few recently-touched
+     * (and therefore resident) pages.  Scans refresh their position every few dozen documents
+     * to keep the mutex off the per-document path.
+     */
+    class ScanCoordinator {
+    public:
+        ScanCoordinator();
+
+        /**
+         * Register a scan over 'ns'.  'scan' is used only as an opaque key for later
+         * setPosition()/remove() calls.
+         */
+        void add( const void* scan, const std::string& ns );
+
+        /** Report 'scan's current position.  A null loc is ignored as a join candidate. */
+        void setPosition( const void* scan, const DiskLoc& loc );
+
+        /** Deregister a scan; a no-op if 'scan' was never added. */
+        void remove( const void* scan );
+
+        /**
+         * @return the position of some in-progress scan over 'ns', or a null DiskLoc if no
+         * scan is under way there.
+         */
+        DiskLoc joinPosition( const std::string& ns ) const;
+
+        static ScanCoordinator& instance();
+
+    private:
+        struct Entry {
+            std::string ns;
+            DiskLoc pos;
+        };
+
+        typedef std::map<const void*, Entry> ScanMap;
+
+        mutable SimpleMutex _mutex;
+        ScanMap _scans;
+    };
+
+}  // namespace mongo
@@ -38,6 +38,7 @@ namespace mongo {
     bool SkipStage::isEOF() { return _child->isEOF(); }
 
     PlanStage::StageState SkipStage::work(WorkingSetID* out) {
+        ScopedWorkTimer workTimer(&_commonStats);
         ++_commonStats.works;
 
         if (isEOF()) { return PlanStage::IS_EOF; }
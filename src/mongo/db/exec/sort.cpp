@@ -32,18 +32,103 @@
 
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/kill_current_op.h"
+#include "mongo/platform/float_utils.h"
 
 namespace mongo {
 
     const size_t kMaxBytes = 32 * 1024 * 1024;
 
+    // How often the load phase checks for interrupt/maxTimeMS: every this many buffered
+    // results or this many milliseconds, whichever comes first.  The check itself is an
+    // approximate comparison against the coarse ticker, so it's cheap to do often.
+    const int kInterruptCheckWorks = 256;
+    const int kInterruptCheckMillis = 20;
+
+    /**
+     * Builds an order-preserving 64-bit prefix of a sort key element: the canonical
+     * type in the top byte (biased so MinKey's -1 fits) and the leading bytes of a
+     * type-specific big-endian encoding below it.  Whenever two prefixes differ, the
+     * element with the smaller prefix is also smaller under woCompare; equal prefixes
+     * say nothing and the caller must fall back to a full comparison.  For a
+     * descending field the bits are inverted so prefixes always sort ascending.
+     */
+    static unsigned long long sortKeyPrefix(const BSONElement& elt, bool descending) {
+        unsigned long long value = 0;
+
+        switch (elt.type()) {
+        case NumberInt:
+        case NumberLong:
+        case NumberDouble: {
+            // Map the double's bits to an unsigned value with the same ordering.  A
+            // NumberLong that loses precision in the cast still maps monotonically,
+            // so the prefix can declare a false tie but never invert the order.
+            double d = elt.number();
+            if (d == 0) { d = 0; }  // normalize -0.0, which woCompare treats as 0.0
+            unsigned long long bits;
+            memcpy(&bits, &d, sizeof(bits));
+            if (isNaN(d)) {
+                bits = 0;  // woCompare sorts NaN before all other numbers
+            }
+            else if (bits & (1ULL << 63)) {
+                bits = ~bits;  // negatives: reverse magnitude order, below positives
+            }
+            else {
+                bits |= 1ULL << 63;  // positives: above all negatives
+            }
+            value = bits >> 8;
+            break;
+        }
+        case mongo::String:
+        case Symbol:
+        case Code: {
+            // Compared with memcmp (embedded NUL bytes are allowed), shorter string
+            // first on a shared prefix; zero padding preserves both properties.
+            const unsigned char* s = reinterpret_cast<const unsigned char*>(elt.valuestr());
+            int len = elt.valuestrsize() - 1;  // don't encode the trailing NUL
+            for (int i = 0; i < 7; i++) {
+                value = (value << 8) | (i < len ? s[i] : 0);
+            }
+            break;
+        }
+        case mongo::Date:
+        case Timestamp:
+            // Dates compare as signed millis, so flip the sign bit.  Timestamps
+            // compare as unsigned but never have the high bit set in practice, and
+            // the two share a canonical type, so encode them identically.
+            value = (elt.date().millis ^ (1ULL << 63)) >> 8;
+            break;
+        case jstOID: {
+            const unsigned char* s = reinterpret_cast<const unsigned char*>(elt.value());
+            for (int i = 0; i < 7; i++) {
+                value = (value << 8) | s[i];
+            }
+            break;
+        }
+        case mongo::Bool:
+            value = elt.boolean() ? 1 : 0;
+            break;
+        default:
+            // Object, Array, BinData, RegEx, etc: same-type prefixes always tie and
+            // the full comparison decides.
+            break;
+        }
+
+        unsigned long long prefix =
+            (static_cast<unsigned long long>(elt.canonicalType() + 1) << 56) | value;
+        return descending ? ~prefix : prefix;
+    }
+
     // Used in STL sort.
     struct WorkingSetComparison {
         WorkingSetComparison(WorkingSet* ws, BSONObj pattern) : _ws(ws), _pattern(pattern) { }
 
-        bool operator()(const WorkingSetID& lhs, const WorkingSetID& rhs) const {
-            WorkingSetMember* lhsMember = _ws->get(lhs);
-            WorkingSetMember* rhsMember = _ws->get(rhs);
+        bool operator()(const SortStage::SortItem& lhs, const SortStage::SortItem& rhs) const {
+            // The common case: the key prefixes differ and we never leave this array.
+            if (lhs.prefix != rhs.prefix) { return lhs.prefix < rhs.prefix; }
+
+            WorkingSetMember* lhsMember = _ws->get(lhs.wsid);
+            WorkingSetMember* rhsMember = _ws->get(rhs.wsid);
 
             BSONObjIterator it(_pattern);
             while (it.more()) {
@@ -74,7 +159,8 @@ namespace mongo {
 
     SortStage::SortStage(const SortStageParams& params, WorkingSet* ws, PlanStage* child)
         : _ws(ws), _child(child), _pattern(params.pattern), _sorted(false),
-          _resultIterator(_data.end()), _memUsage(0) { }
+          _resultIterator(_data.end()), _memUsage(0), _memCharge(opmem::ClassSort),
+          _interruptTracker(kInterruptCheckWorks, kInterruptCheckMillis) { }
 
     SortStage::~SortStage() { }
 
@@ -85,6 +171,7 @@ namespace mongo {
     }
 
     PlanStage::StageState SortStage::work(WorkingSetID* out) {
+        ScopedWorkTimer workTimer(&_commonStats);
         ++_commonStats.works;
 
         if (_memUsage > kMaxBytes) {
@@ -95,22 +182,42 @@ namespace mongo {
 
         // Still reading in results to sort.
         if (!_sorted) {
+            // We don't reach a yield point while loading, so check for interrupt (kill or
+            // maxTimeMS expiry) ourselves every so often.  Throws if the operation should die.
+            if (_interruptTracker.intervalHasElapsed()) {
+                killCurrentOp.checkForInterrupt();
+            }
+
             WorkingSetID id;
             StageState code = _child->work(&id);
 
             if (PlanStage::ADVANCED == code) {
-                // We let the data stay in the WorkingSet and sort using the IDs.
-                _data.push_back(id);
+                // We let the data stay in the WorkingSet and sort using the IDs, each
+                // paired with a key prefix computed once here so the sort below mostly
+                // compares inline integers instead of chasing members.
+                WorkingSetMember* member = _ws->get(id);
+
+                SortItem item;
+                item.wsid = id;
+                item.prefix = 0;
+                if (!_pattern.isEmpty()) {
+                    BSONElement patternElt = _pattern.firstElement();
+                    BSONElement keyElt;
+                    verify(member->getFieldDotted(patternElt.fieldName(), &keyElt));
+                    item.prefix = sortKeyPrefix(keyElt, -1 == patternElt.number());
+                }
+                _data.push_back(item);
 
                 // Add it into the map for quick invalidation if it has a valid DiskLoc.
                 // A DiskLoc may be invalidated at any time (during a yield).  We need to get into
                 // the WorkingSet as quickly as possible to handle it.
-                WorkingSetMember* member = _ws->get(id);
                 if (member->hasLoc()) {
                     _wsidByDiskLoc[member->loc] = id;
                 }
 
                 // Do some accounting to make sure we're not using too much memory.
+                _memUsage += sizeof(SortItem);
+
                 if (member->hasLoc()) {
                     _memUsage += sizeof(DiskLoc);
                 }
@@ -119,6 +226,9 @@ namespace mongo {
                     _memUsage += member->obj.objsize();
                 }
 
+                // Throws if this pushes the op (or the server) over its memory budget.
+                _memCharge.set(static_cast<long long>(_memUsage));
+
                 ++_commonStats.needTime;
                 return PlanStage::NEED_TIME;
             }
@@ -146,7 +256,7 @@ namespace mongo {
         // Returning results.
         verify(_resultIterator != _data.end());
         verify(_sorted);
-        *out = *_resultIterator++;
+        *out = (_resultIterator++)->wsid;
 
         // If we're returning something, take it out of our DL -> WSID map so that future
         // calls to invalidate don't cause us to take action for a DL we're done with.
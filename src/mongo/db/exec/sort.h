@@ -34,7 +34,9 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/op_memory.h"
 #include "mongo/platform/unordered_map.h"
+#include "mongo/util/elapsed_tracker.h"
 
 namespace mongo {
 
@@ -53,6 +55,18 @@ namespace mongo {
 
         virtual ~SortStage();
 
+        /**
+         * An entry in the sort buffer.  'prefix' is an order-preserving 8-byte
+         * truncation of the member's sort key, computed once when the result is
+         * buffered.  The sort comparator orders entries on the prefix alone and only
+         * walks the full pattern (getFieldDotted + woCompare per field) when two
+         * prefixes tie, so most comparisons touch nothing but this array.
+         */
+        struct SortItem {
+            unsigned long long prefix;
+            WorkingSetID wsid;
+        };
+
         virtual bool isEOF();
         virtual StageState work(WorkingSetID* out);
 
@@ -73,13 +87,13 @@ namespace mongo {
         BSONObj _pattern;
 
         // We read the child into this.
-        vector<WorkingSetID> _data;
+        vector<SortItem> _data;
 
         // Have we sorted our data?
         bool _sorted;
 
         // Iterates through _data post-sort returning it.
-        vector<WorkingSetID>::iterator _resultIterator;
+        vector<SortItem>::iterator _resultIterator;
 
         // We buffer a lot of data and we want to look it up by DiskLoc quickly upon invalidation.
         typedef unordered_map<DiskLoc, WorkingSetID, DiskLoc::Hasher> DataMap;
@@ -91,6 +105,13 @@ namespace mongo {
 
         // The usage in bytes of all bufered data that we're sorting.
         size_t _memUsage;
+
+        // Keeps _memUsage charged against the op's memory budget (see db/op_memory.h).
+        opmem::OpMemoryCharge _memCharge;
+
+        // The load phase never yields, so it has to poll for interrupt/maxTimeMS itself or a
+        // runaway query can buffer forever.  Tells us when it's time to check.
+        ElapsedTracker _interruptTracker;
     };
 
     // Parameters that must be provided to a SortStage
@@ -34,17 +34,36 @@ namespace mongo {
 
     const WorkingSetID WorkingSet::INVALID_ID = -1;
 
-    WorkingSet::WorkingSet() : _nextId(0) { }
+    WorkingSet::WorkingSet()
+        : _nextId(0), _memCharge(new opmem::OpMemoryCharge(opmem::ClassWorkingSet)) { }
 
     WorkingSet::~WorkingSet() {
-        for (DataMap::const_iterator i = _data.begin(); i != _data.end(); ++i) {
-            delete i->second;
+        // Members live in the slabs, so there is nothing to free per-ID.
+        for (size_t i = 0; i < _slabs.size(); ++i) {
+            delete[] _slabs[i];
         }
     }
 
+    WorkingSetMember* WorkingSet::allocateMember() {
+        if (_freeList.empty()) {
+            // Throws if this pushes the op (or the server) over its memory budget.
+            _memCharge->set(_memCharge->charged()
+                            + static_cast<long long>(kMembersPerSlab * sizeof(WorkingSetMember)));
+            WorkingSetMember* slab = new WorkingSetMember[kMembersPerSlab];
+            _slabs.push_back(slab);
+            _freeList.reserve(kMembersPerSlab);
+            for (size_t i = 0; i < kMembersPerSlab; ++i) {
+                _freeList.push_back(&slab[i]);
+            }
+        }
+        WorkingSetMember* member = _freeList.back();
+        _freeList.pop_back();
+        return member;
+    }
+
     WorkingSetID WorkingSet::allocate() {
         verify(_data.end() == _data.find(_nextId));
-        _data[_nextId] = new WorkingSetMember();
+        _data[_nextId] = allocateMember();
         return _nextId++;
     }
 
@@ -57,7 +76,8 @@ namespace mongo {
     void WorkingSet::free(const WorkingSetID& i) {
         DataMap::iterator it = _data.find(i);
         verify(_data.end() != it);
-        delete it->second;
+        it->second->clear();
+        _freeList.push_back(it->second);
         _data.erase(it);
     }
 
@@ -73,6 +93,13 @@ namespace mongo {
 
     WorkingSetMember::WorkingSetMember() : state(WorkingSetMember::INVALID) { }
 
+    void WorkingSetMember::clear() {
+        loc = DiskLoc();
+        obj = BSONObj();
+        keyData.clear();
+        state = WorkingSetMember::INVALID;
+    }
+
     bool WorkingSetMember::hasLoc() const {
         return state == LOC_AND_IDX || state == LOC_AND_UNOWNED_OBJ;
     }
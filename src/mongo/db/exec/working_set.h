@@ -29,8 +29,12 @@
 #pragma once
 
 #include <vector>
+
+#include <boost/shared_ptr.hpp>
+
 #include "mongo/db/diskloc.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/op_memory.h"
 #include "mongo/platform/unordered_map.h"
 
 namespace mongo {
@@ -84,14 +88,37 @@ namespace mongo {
     private:
         typedef unordered_map<WorkingSetID, WorkingSetMember*> DataMap;
 
+        // How many members are carved out of each slab.  Scan-heavy plans allocate and free a
+        // member per advance; slabs plus the freelist keep that off the global allocator.
+        static const size_t kMembersPerSlab = 64;
+
+        /**
+         * Returns a member from the freelist, carving a new slab if the freelist is empty.
+         * The returned member is in the INVALID state.
+         */
+        WorkingSetMember* allocateMember();
+
         DataMap _data;
 
+        // Slabs of members; each is an array of kMembersPerSlab constructed members, owned here.
+        vector<WorkingSetMember*> _slabs;
+
+        // Members carved from _slabs but not currently allocated to a WorkingSetID.  Recycled
+        // members keep their keyData capacity, so steady-state advances do not malloc at all.
+        vector<WorkingSetMember*> _freeList;
+
         // The WorkingSetID returned by the next call to allocate().  Should refer to the next valid
-        // ID.  IDs allocated contiguously.  Should never point at an in-use ID.  
+        // ID.  IDs allocated contiguously.  Should never point at an in-use ID.
         WorkingSetID _nextId;
 
         // All WSIDs invalidated during evaluation of a predicate (AND).
         vector<WorkingSetID> _flagged;
+
+        // Charges slab memory against the op's budget (see db/op_memory.h); charged at slab
+        // granularity since members are recycled rather than returned to the allocator.
+        // Held by pointer: OpMemoryCharge is noncopyable and WorkingSet must stay
+        // assignable (see working_set_test.cpp).
+        boost::shared_ptr<opmem::OpMemoryCharge> _memCharge;
     };
 
     /**
@@ -147,6 +174,12 @@ namespace mongo {
         bool hasOwnedObj() const;
         bool hasUnownedObj() const;
 
+        /**
+         * Reset to the initial state so this member can be recycled by the WorkingSet.  Keeps
+         * keyData's capacity so recycled members don't reallocate it on the next advance.
+         */
+        void clear();
+
         /**
          * getFieldDotted uses its state (obj or index data) to produce the field with the provided
          * name.
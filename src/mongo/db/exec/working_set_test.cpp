@@ -58,6 +58,24 @@ namespace {
         WorkingSetMember* member;
     };
 
+    TEST_F(WorkingSetFixture, allocateFreeRecycles) {
+        // Free the fixture's member and allocate again; the member should come back from the
+        // freelist in the INVALID state with no stale data.
+        member->state = WorkingSetMember::OWNED_OBJ;
+        member->obj = fromjson("{a: 1}");
+
+        WorkingSetID id = ws.allocate();
+        ws.free(id - 1);
+
+        WorkingSetID recycled = ws.allocate();
+        WorkingSetMember* recycledMember = ws.get(recycled);
+        ASSERT(NULL != recycledMember);
+        ASSERT_EQUALS(WorkingSetMember::INVALID, recycledMember->state);
+        ASSERT(recycledMember->obj.isEmpty());
+        ASSERT(recycledMember->keyData.empty());
+        ASSERT(recycledMember->loc.isNull());
+    }
+
     TEST_F(WorkingSetFixture, noFieldToGet) {
         BSONElement elt;
 
@@ -380,12 +380,12 @@ namespace mongo {
 
         int size;
         verify( _read( reinterpret_cast<char*>(&size), 4 ) );
-        char* buf = reinterpret_cast<char*>( malloc( sizeof(unsigned) + size ) );
+        char* buf = reinterpret_cast<char*>( malloc( BSONObj::Holder::HeaderSize + size ) );
         verify( buf );
 
-        memset( buf, 0, 4 ); // for Holder
-        memcpy( buf+sizeof(unsigned), reinterpret_cast<char*>(&size), sizeof(int) ); // size of doc
-        if ( ! _read( buf + sizeof(unsigned) + sizeof(int), size-sizeof(int) ) ) { // doc content
+        memset( buf, 0, BSONObj::Holder::HeaderSize ); // for Holder
+        memcpy( buf+BSONObj::Holder::HeaderSize, reinterpret_cast<char*>(&size), sizeof(int) ); // size of doc
+        if ( ! _read( buf + BSONObj::Holder::HeaderSize + sizeof(int), size-sizeof(int) ) ) { // doc content
             free( buf );
             msgasserted( 16394, std::string("reading doc for external sort failed:") + errnoWithDescription() );
         }
@@ -45,9 +45,10 @@ namespace mongo {
         }
 
         // We guarantee that accesses through getPart() will be valid while 'this' is. So we
-        // keep a copy in a local sting.
+        // keep a copy in a local sting. Assign rather than construct a temporary so a
+        // FieldRef reused across parses keeps its allocation.
 
-        _dotted = dottedField.toString();
+        _dotted.assign(dottedField.rawData(), dottedField.size());
 
         // Separate the field parts using '.' as a delimiter.
         std::string::iterator beg = _dotted.begin();
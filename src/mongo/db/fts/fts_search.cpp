@@ -66,6 +66,12 @@ namespace mongo {
             _objectsLookedAt = 0;
         }
 
+        // How many index entries we drain from one term's cursor before moving on to
+        // the next term.  A common term is a long run of duplicate-prefix keys in the
+        // btree, so scoring a block at a time stays on that run's pages instead of
+        // ping-ponging between the terms' regions of the index on every key.
+        const unsigned kScoreBlockSize = 256;
+
         bool FTSSearch::_ok( Record* record ) const {
             if ( !_query.hasNonTermPieces() )
                 return true;
@@ -98,17 +104,17 @@ namespace mongo {
             while ( !inShutdown() ) {
                 bool gotAny = false;
                 for ( unsigned i = 0; i < cursors.size(); i++ ) {
-                    if ( cursors[i]->eof() )
-                        continue;
-                    gotAny = true;
-                    _process( cursors[i].get() );
-                    cursors[i]->advance();
+                    for ( unsigned n = 0; n < kScoreBlockSize && !cursors[i]->eof(); n++ ) {
+                        gotAny = true;
+                        _process( cursors[i].get() );
+                        cursors[i]->advance();
+                    }
                 }
 
                 if ( !gotAny )
                     break;
 
-                RARELY killCurrentOp.checkForInterrupt();
+                killCurrentOp.checkForInterrupt();
             }
 
 
@@ -118,27 +124,21 @@ namespace mongo {
                 if ( i->second < 0 )
                     continue;
 
-                // priority queue
-                if ( results->size() < limit ) { // case a: queue unfilled
-
-                    if ( !_ok( i->first ) )
-                        continue;
-
-                    results->push( ScoredLocation( i->first, i->second ) );
+                // case c: the score can't make the result set, so don't touch the
+                // record at all
+                if ( results->size() >= limit && i->second <= results->top().score )
+                    continue;
 
-                }
-                else if ( i->second > results->top().score ) { // case b: queue filled
+                Record* rec = i->first.rec();
 
-                    if ( !_ok( i->first ) )
-                        continue;
+                if ( !_ok( rec ) )
+                    continue;
 
+                // priority queue
+                if ( results->size() >= limit ) // case b: queue filled
                     results->pop();
-                    results->push( ScoredLocation( i->first, i->second ) );
-                }
-                else {
-                    // else do nothing (case c)
-                }
 
+                results->push( ScoredLocation( rec, i->second ) );
             }
 
         }
@@ -160,7 +160,7 @@ namespace mongo {
 
             double score = scoreElement.number();
 
-            double& cur = _scores[(cursor->currLoc()).rec()];
+            double& cur = _scores[cursor->currLoc()];
 
             if ( cur < 0 ) {
                 // already been rejected
@@ -36,6 +36,7 @@
 #include <queue>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/db/diskloc.h"
 #include "mongo/db/fts/fts_matcher.h"
 #include "mongo/db/fts/fts_query.h"
 #include "mongo/db/fts/fts_util.h"
@@ -67,7 +68,10 @@ namespace mongo {
             MONGO_DISALLOW_COPYING(FTSSearch);
         public:
 
-            typedef std::map<Record*,double> Scores;
+            // Partial scores keyed by DiskLoc, NOT Record*, so accumulating a score
+            // doesn't fault in the document; records are only touched for the
+            // candidates that survive to the final pass.
+            typedef std::map<DiskLoc,double> Scores;
 
             FTSSearch( IndexDescriptor* descriptor,
                        const FTSSpec& ftsSpec,
@@ -129,9 +129,10 @@ namespace mongo {
 
             string language = getLanguageToUse( obj );
 
-            Stemmer stemmer(language);
             Tools tools(language);
-            tools.stemmer = &stemmer;
+            // thread-local: reuses one snowball stemmer per language and caches stemmed
+            // forms across documents, instead of rebuilding both per document
+            tools.stemmer = StemmerCache::get( language );
             tools.stopwords = StopWords::getStopWords( language );
 
             if ( wildcard() ) {
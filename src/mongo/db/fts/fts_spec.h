@@ -35,7 +35,7 @@
 #include <string>
 
 #include "mongo/db/fts/fts_util.h"
-#include "mongo/db/fts/stemmer.h"
+#include "mongo/db/fts/stemmer_cache.h"
 #include "mongo/db/fts/stop_words.h"
 #include "mongo/db/fts/tokenizer.h"
 #include "mongo/platform/unordered_map.h"
@@ -57,7 +57,7 @@ namespace mongo {
                 Tools( string language )
                     : language( language ){}
                 const std::string& language;
-                const Stemmer* stemmer;
+                StemmerCache* stemmer;
                 const StopWords* stopwords;
             };
 
@@ -0,0 +1,82 @@
+// stemmer_cache.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "mongo/db/fts/stemmer_cache.h"
+
+namespace mongo {
+
+    namespace fts {
+
+        const size_t StemmerCache::kMaxCachedStems;
+
+        namespace {
+            // one cache per (thread, language); a thread indexing a corpus typically
+            // touches one or two languages, so the map stays tiny
+            typedef std::map<std::string, boost::shared_ptr<StemmerCache> > CachesByLanguage;
+            boost::thread_specific_ptr<CachesByLanguage> threadCaches;
+        }
+
+        StemmerCache* StemmerCache::get( const std::string& language ) {
+            CachesByLanguage* caches = threadCaches.get();
+            if ( !caches ) {
+                caches = new CachesByLanguage();
+                threadCaches.reset( caches );
+            }
+            boost::shared_ptr<StemmerCache>& c = (*caches)[language];
+            if ( !c )
+                c.reset( new StemmerCache( language ) );
+            return c.get();
+        }
+
+        StemmerCache::StemmerCache( const std::string& language )
+            : _stemmer( language ) {
+        }
+
+        std::string StemmerCache::stem( const std::string& word ) {
+            unordered_map<std::string,std::string>::const_iterator it = _stems.find( word );
+            if ( it != _stems.end() )
+                return it->second;
+
+            std::string stemmed = _stemmer.stem( word );
+
+            if ( _stems.size() >= kMaxCachedStems )
+                _stems.clear();
+            _stems[word] = stemmed;
+
+            return stemmed;
+        }
+
+    }
+}
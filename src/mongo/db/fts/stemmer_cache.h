@@ -0,0 +1,72 @@
+// stemmer_cache.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <string>
+
+#include "mongo/db/fts/stemmer.h"
+#include "mongo/platform/unordered_map.h"
+
+namespace mongo {
+
+    namespace fts {
+
+        /**
+         * A per-thread, per-language Stemmer with a word -> stemmed form dictionary in
+         * front of it.  Creating a snowball stemmer per document is expensive, and
+         * natural language repeats a small vocabulary, so during an index build most
+         * words hit the dictionary and never reach the snowball code at all.
+         *
+         * Instances are thread local (see get()), so stem() needs no locking.
+         */
+        class StemmerCache {
+        public:
+            /**
+             * returns the calling thread's cache for 'language', creating it on first
+             * use.  The returned object stays valid for the lifetime of the thread.
+             */
+            static StemmerCache* get( const std::string& language );
+
+            std::string stem( const std::string& word );
+
+        private:
+            explicit StemmerCache( const std::string& language );
+
+            // the dictionary is reset wholesale if unique words exceed this (e.g. a
+            // field full of random tokens); normal text refills it almost instantly
+            static const size_t kMaxCachedStems = 50000;
+
+            Stemmer _stemmer;
+            unordered_map<std::string,std::string> _stems;
+        };
+
+    }
+}
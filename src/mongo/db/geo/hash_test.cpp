@@ -83,4 +83,30 @@ namespace {
         string a = makeRandomBitString(13);
         ASSERT_THROWS(makeHash(a), mongo::UserException);
     }
+
+    TEST(GeoHash, UnhashOfHashIsIdentity) {
+        mongo::PseudoRandom random(12345);
+        for (int i = 0; i < 100; ++i) {
+            unsigned x = random.nextInt32();
+            unsigned y = random.nextInt32();
+            GeoHash hash(x, y);
+            unsigned xOut, yOut;
+            hash.unhash(&xOut, &yOut);
+            ASSERT_EQUALS(x, xOut);
+            ASSERT_EQUALS(y, yOut);
+        }
+    }
+
+    TEST(GeoHash, CoarserHashIsPrefixOfFiner) {
+        mongo::PseudoRandom random(54321);
+        for (int i = 0; i < 100; ++i) {
+            unsigned x = random.nextInt32();
+            unsigned y = random.nextInt32();
+            GeoHash full(x, y);
+            for (unsigned bits = 1; bits <= 32; ++bits) {
+                GeoHash partial(x, y, bits);
+                ASSERT_TRUE(full.hasPrefix(partial));
+            }
+        }
+    }
 }
@@ -355,7 +355,8 @@ namespace mongo {
         }
 
         bool checkAndAdvance(const GeoHash& hash, int& totalFound, GeoAccumulator* all){
-            if(! _cursor->ok() || ! hasPrefix(hash)) return false;
+            // No cursor at all for the descending side of a forward-only scan.
+            if(! _cursor || ! _cursor->ok() || ! hasPrefix(hash)) return false;
 
             if(all){
                 totalFound++;
@@ -368,10 +369,11 @@ namespace mongo {
             return true;
         }
 
-        void save(){ _cursor->noteLocation(); }
-        void restore(){ _cursor->checkLocation(); }
+        void save(){ if(_cursor) _cursor->noteLocation(); }
+        void restore(){ if(_cursor) _cursor->checkLocation(); }
 
         string toString() {
+            if(! _cursor) return "[no cursor]";
             stringstream ss;
             ss << "bucket: " << _cursor->getBucket().toString() << " pos: " << _cursor->getKeyOfs()
                << (_cursor->ok() ? (str::stream() << " k: " << _cursor->currKey()
@@ -385,19 +387,30 @@ namespace mongo {
         // itself, otherwise our expanding algorithm will fail.
         static bool initial(IndexDescriptor* descriptor, const TwoDIndexingParams& params,
                              BtreeLocation& min, BtreeLocation& max,
-                             GeoHash start, int& found, GeoAccumulator* hopper) {
+                             GeoHash start, int& found, GeoAccumulator* hopper,
+                             bool forwardOnly = false) {
             verify(descriptor);
             verify(hopper);
             // Would be nice to build this directly, but bug in max/min queries SERVER-3766 and lack
             // of interface makes this easiest for now.
 
-            BSONObj minQuery = BSON(params.geo << BSON("$gt" << MINKEY
-                << start.wrap("$lte").firstElement()));
+            // When 'start' is a whole cell rather than a point inside one, every key in the
+            // cell compares greater than or equal to 'start' itself, so a single ascending
+            // cursor sees everything and the descending half is never built or seeked.
+
             BSONObj maxQuery = BSON(params.geo << BSON("$lt" << MAXKEY
-                << start.wrap("$gt").firstElement()));
+                << start.wrap(forwardOnly ? "$gte" : "$gt").firstElement()));
 
-            min._frs.reset(new FieldRangeSet(descriptor->parentNS().c_str(),
-                                             minQuery, true, false));
+            if (forwardOnly) {
+                min._frs.reset();
+                min._cursor.reset();
+            }
+            else {
+                BSONObj minQuery = BSON(params.geo << BSON("$gt" << MINKEY
+                    << start.wrap("$lte").firstElement()));
+                min._frs.reset(new FieldRangeSet(descriptor->parentNS().c_str(),
+                                                 minQuery, true, false));
+            }
 
             max._frs.reset(new FieldRangeSet(descriptor->parentNS().c_str(),
                                              maxQuery, true, false));
@@ -413,16 +426,19 @@ namespace mongo {
             min._keyPattern = iSpec;
             max._keyPattern = iSpec;
 
-            shared_ptr<FieldRangeVector> frvMin(new FieldRangeVector(*min._frs, min._keyPattern, -1));
-            shared_ptr<FieldRangeVector> frvMax(new FieldRangeVector(*max._frs, max._keyPattern, 1));
+            if (!forwardOnly) {
+                shared_ptr<FieldRangeVector> frvMin(new FieldRangeVector(*min._frs,
+                                                                         min._keyPattern, -1));
+                min._cursor.reset(BtreeCursor::make(nsdetails(descriptor->parentNS()),
+                                                    descriptor->getOnDisk(), frvMin, 0, -1));
+            }
 
-            min._cursor.reset(BtreeCursor::make(nsdetails(descriptor->parentNS()),
-                                                descriptor->getOnDisk(), frvMin, 0, -1));
+            shared_ptr<FieldRangeVector> frvMax(new FieldRangeVector(*max._frs, max._keyPattern, 1));
 
             max._cursor.reset(BtreeCursor::make(nsdetails(descriptor->parentNS()),
                                                 descriptor->getOnDisk(), frvMax, 0, 1));
 
-            return min._cursor->ok() || max._cursor->ok();
+            return (min._cursor && min._cursor->ok()) || max._cursor->ok();
         }
     };
 
@@ -709,8 +725,11 @@ namespace mongo {
                       << Box(_g, _prefix) << endl;
 #endif
 
+                // Neighbor cells (and their fringe sub-cells) are scanned whole, so they
+                // only need the ascending cursor; only the initial expansion outward from
+                // the query point needs to walk in both directions.
                 if (!BtreeLocation::initial(_descriptor, _params, _min, _max, _prefix,
-                                            _foundInExp, this)) {
+                                            _foundInExp, this, isNeighbor)) {
                     _state = isNeighbor ? DONE_NEIGHBOR : DONE;
                 } else {
                     _state = DOING_EXPAND;
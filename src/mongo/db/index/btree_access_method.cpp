@@ -33,6 +33,7 @@
 #include "mongo/base/status.h"
 #include "mongo/db/index/btree_index_cursor.h"
 #include "mongo/db/index/btree_interface.h"
+#include "mongo/db/index/deferred_index_updates.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/pdfile.h"
@@ -236,6 +237,48 @@ namespace mongo {
         return Status::OK();
     }
 
+    Status BtreeBasedAccessMethod::updateDeferred(const UpdateTicket& ticket, int idxNo,
+                                                  DeferredIndexUpdates* deferred,
+                                                  int64_t* numUpdated) {
+        if (!ticket._isValid) {
+            return Status(ErrorCodes::InternalError, "Invalid updateticket in updateDeferred");
+        }
+
+        BtreeBasedPrivateUpdateData* data =
+            static_cast<BtreeBasedPrivateUpdateData*>(ticket._indexSpecificUpdateData.get());
+
+        if (!data->dupsAllowed) {
+            // A unique index's entries must track the btree exactly; see header comment.
+            return update(ticket, numUpdated);
+        }
+
+        if (data->oldKeys.size() + data->added.size() - data->removed.size() > 1) {
+            _descriptor->setMultikey();
+        }
+
+        for (size_t i = 0; i < data->added.size(); ++i) {
+            deferred->add(idxNo, *data->added[i], data->loc, true);
+        }
+
+        for (size_t i = 0; i < data->removed.size(); ++i) {
+            deferred->add(idxNo, *data->removed[i], data->loc, false);
+        }
+
+        *numUpdated = data->added.size();
+
+        return Status::OK();
+    }
+
+    void BtreeBasedAccessMethod::insertKey(const BSONObj& key, const DiskLoc& loc,
+                                           bool dupsAllowed) {
+        _interface->bt_insert(_descriptor->getHead(), loc, key, _ordering, dupsAllowed,
+                              _descriptor->getOnDisk(), true);
+    }
+
+    bool BtreeBasedAccessMethod::removeKey(const BSONObj& key, const DiskLoc& loc) {
+        return removeOneKey(key, loc);
+    }
+
     // Standard Btree implementation below.
     BtreeAccessMethod::BtreeAccessMethod(IndexDescriptor* descriptor)
         : BtreeBasedAccessMethod(descriptor) {
@@ -39,6 +39,8 @@
 
 namespace mongo {
 
+    class DeferredIndexUpdates;
+
     /**
      * Any access method that is Btree based subclasses from this.
      *
@@ -70,8 +72,33 @@ namespace mongo {
 
         virtual Status update(const UpdateTicket& ticket, int64_t* numUpdated);
 
+        /**
+         * Like update(), but instead of descending the btree now, queues the ticket's
+         * key-level inserts and removes on 'deferred' for a later sorted pass (see
+         * DeferredIndexUpdates).  Multikey state is still updated immediately.  Unique
+         * indexes fall back to update() in line: their duplicate check in
+         * validateUpdate() ran against the btree as it stands, so their entries can't
+         * be allowed to lag behind it.
+         */
+        Status updateDeferred(const UpdateTicket& ticket, int idxNo,
+                              DeferredIndexUpdates* deferred, int64_t* numUpdated);
+
+        /**
+         * Key-level entry points for DeferredIndexUpdates::flush().  'key' must have
+         * been produced by this index's getKeys().
+         */
+        void insertKey(const BSONObj& key, const DiskLoc& loc, bool dupsAllowed);
+        bool removeKey(const BSONObj& key, const DiskLoc& loc);
+
         virtual Status newCursor(IndexCursor **out) = 0;
 
+        /**
+         * Public entry point for key generation outside the class hierarchy
+         * (index builds computing keys on worker threads).  Same contract as
+         * getKeys().
+         */
+        void computeKeys(const BSONObj& obj, BSONObjSet* keys) { getKeys(obj, keys); }
+
         virtual Status touch(const BSONObj& obj);
 
         virtual Status validate(int64_t* numKeys);
@@ -28,7 +28,13 @@
 
 #include "mongo/db/index/btree_based_builder.h"
 
+#include <deque>
+
+#include <boost/thread/condition.hpp>
+#include <boost/thread/thread.hpp>
+
 #include "mongo/db/btreebuilder.h"
+#include "mongo/db/client.h"
 #include "mongo/db/index/catalog_hack.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index/index_access_method.h"
@@ -153,6 +159,139 @@ namespace mongo {
         }
     }
 
+    namespace {
+
+        /**
+         * Parallel key generation for addKeysToPhaseOne.  The collection scan
+         * stays on the build thread (runner and lock ownership are per thread);
+         * workers pull batches of documents, run getKeys on their own access
+         * method instance (key generation is pure computation, and the mapped
+         * records can't move while the build holds the write lock), and
+         * serialize only the insert into the shared external sorter.
+         */
+        class PhaseOneKeyGenerator : boost::noncopyable {
+        public:
+            struct Doc {
+                BSONObj obj; // points into the mapped file; stable during the build
+                DiskLoc loc;
+            };
+            typedef std::vector<Doc> Batch;
+
+            static const size_t BatchSize = 64;
+            static const size_t MaxQueuedBatches = 16;
+
+            PhaseOneKeyGenerator( NamespaceDetails* d, int idxNo, SortPhaseOne* phaseOne,
+                                  bool mayInterrupt )
+                : _d( d ), _idxNo( idxNo ), _phaseOne( phaseOne ),
+                  _mayInterrupt( mayInterrupt ),
+                  _mutex( "phaseOneKeyGenerator" ), _sorterMutex( "phaseOneSorter" ),
+                  _done( false ), _failed( false ) {
+            }
+
+            void addWorkers( int n ) {
+                for ( int i = 0; i < n; i++ )
+                    _threads.create_thread( boost::bind( &PhaseOneKeyGenerator::_workerLoop,
+                                                         this ) );
+            }
+
+            /** takes ownership of batch.  @return false if a worker has failed */
+            bool submit( Batch* batch ) {
+                scoped_lock lk( _mutex );
+                if ( _failed ) {
+                    delete batch;
+                    return false;
+                }
+                while ( _queue.size() >= MaxQueuedBatches && ! _failed )
+                    _notFull.wait( lk.boost() );
+                _queue.push_back( batch );
+                _notEmpty.notify_one();
+                return ! _failed;
+            }
+
+            /**
+             * drains the queue, joins the workers and rethrows any worker error.
+             * must be called before destruction, even when the scan threw.
+             * @param throwOnError false to suppress the rethrow (unwinding already)
+             */
+            void finish( bool throwOnError = true ) {
+                {
+                    scoped_lock lk( _mutex );
+                    _done = true;
+                    _notEmpty.notify_all();
+                }
+                _threads.join_all();
+                for ( size_t i = 0; i < _queue.size(); i++ ) {
+                    delete _queue[i]; // left behind if the workers bailed out
+                }
+                _queue.clear();
+                if ( throwOnError ) {
+                    uassert( 17517,
+                             str::stream() << "error generating keys for index build: " << _errmsg,
+                             ! _failed );
+                }
+            }
+
+        private:
+            void _workerLoop() {
+                Client::initThread( "indexKeyGen" );
+                try {
+                    auto_ptr<IndexDescriptor> desc( CatalogHack::getDescriptor( _d, _idxNo ) );
+                    auto_ptr<BtreeBasedAccessMethod> iam(
+                            CatalogHack::getBtreeBasedIndex( desc.get() ) );
+
+                    while ( true ) {
+                        auto_ptr<Batch> batch;
+                        {
+                            scoped_lock lk( _mutex );
+                            while ( _queue.empty() && ! _done )
+                                _notEmpty.wait( lk.boost() );
+                            if ( _queue.empty() )
+                                break;
+                            batch.reset( _queue.front() );
+                            _queue.pop_front();
+                            _notFull.notify_one();
+                        }
+
+                        for ( size_t i = 0; i < batch->size(); i++ ) {
+                            BSONObjSet keys;
+                            iam->computeKeys( (*batch)[i].obj, &keys );
+                            scoped_lock lk( _sorterMutex );
+                            _phaseOne->addKeys( keys, (*batch)[i].loc, _mayInterrupt );
+                        }
+                    }
+                }
+                catch ( const std::exception& e ) {
+                    scoped_lock lk( _mutex );
+                    if ( ! _failed ) {
+                        _failed = true;
+                        _errmsg = e.what();
+                    }
+                    // unblock the producer and the other workers
+                    _notFull.notify_all();
+                    _notEmpty.notify_all();
+                }
+                cc().shutdown();
+            }
+
+            NamespaceDetails* _d;
+            const int _idxNo;
+            SortPhaseOne* _phaseOne;
+            const bool _mayInterrupt;
+
+            mongo::mutex _mutex;         // protects the queue and failure state
+            mongo::mutex _sorterMutex;   // serializes SortPhaseOne::addKeys
+            boost::condition _notEmpty;
+            boost::condition _notFull;
+            std::deque<Batch*> _queue;
+            bool _done;
+            bool _failed;
+            string _errmsg;
+
+            boost::thread_group _threads;
+        };
+
+    } // namespace
+
     void BtreeBasedBuilder::addKeysToPhaseOne(NamespaceDetails* d, const char* ns,
                            const IndexDetails& idx,
                            const BSONObj& order,
@@ -164,20 +303,58 @@ namespace mongo {
         phaseOne->sortCmp.reset(getComparison(idx.version(), idx.keyPattern()));
         phaseOne->sorter.reset(new BSONObjExternalSorter(phaseOne->sortCmp.get()));
         phaseOne->sorter->hintNumObjects( nrecords );
-        auto_ptr<IndexDescriptor> desc(CatalogHack::getDescriptor(d, idxNo));
-        auto_ptr<BtreeBasedAccessMethod> iam(CatalogHack::getBtreeBasedIndex(desc.get()));
         BSONObj o;
         DiskLoc loc;
         Runner::RunnerState state;
-        while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&o, &loc))) {
-            RARELY killCurrentOp.checkForInterrupt( !mayInterrupt );
-            BSONObjSet keys;
-            iam->getKeys(o, &keys);
-            phaseOne->addKeys(keys, loc, mayInterrupt);
-            progressMeter->hit();
-            if (logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(2))
-                && phaseOne->n % 10000 == 0 ) {
-                printMemInfo( "\t iterating objects" );
+
+        // Key generation (not the scan or the sort) dominates phase one on wide
+        // documents, and it's pure computation; spread it over the cores when the
+        // collection is big enough for the thread handoff to pay for itself.
+        static const int64_t kMinRecordsForParallelKeyGen = 100 * 1000;
+        const int numWorkers =
+                std::min( 8 , static_cast<int>( ProcessInfo().getNumCores() ) - 1 );
+
+        if ( numWorkers >= 2 && nrecords >= kMinRecordsForParallelKeyGen ) {
+            PhaseOneKeyGenerator keyGen( d, idxNo, phaseOne, mayInterrupt );
+            keyGen.addWorkers( numWorkers );
+
+            try {
+                auto_ptr<PhaseOneKeyGenerator::Batch> batch( new PhaseOneKeyGenerator::Batch );
+                batch->reserve( PhaseOneKeyGenerator::BatchSize );
+                while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&o, &loc))) {
+                    RARELY killCurrentOp.checkForInterrupt( !mayInterrupt );
+                    PhaseOneKeyGenerator::Doc doc = { o, loc };
+                    batch->push_back( doc );
+                    if ( batch->size() >= PhaseOneKeyGenerator::BatchSize ) {
+                        if ( ! keyGen.submit( batch.release() ) )
+                            break; // a worker failed; finish() below rethrows
+                        batch.reset( new PhaseOneKeyGenerator::Batch );
+                        batch->reserve( PhaseOneKeyGenerator::BatchSize );
+                    }
+                    progressMeter->hit();
+                }
+                if ( ! batch->empty() )
+                    keyGen.submit( batch.release() );
+            }
+            catch ( ... ) {
+                keyGen.finish( false ); // join workers before unwinding
+                throw;
+            }
+            keyGen.finish();
+        }
+        else {
+            auto_ptr<IndexDescriptor> desc(CatalogHack::getDescriptor(d, idxNo));
+            auto_ptr<BtreeBasedAccessMethod> iam(CatalogHack::getBtreeBasedIndex(desc.get()));
+            while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&o, &loc))) {
+                RARELY killCurrentOp.checkForInterrupt( !mayInterrupt );
+                BSONObjSet keys;
+                iam->getKeys(o, &keys);
+                phaseOne->addKeys(keys, loc, mayInterrupt);
+                progressMeter->hit();
+                if (logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(2))
+                    && phaseOne->n % 10000 == 0 ) {
+                    printMemInfo( "\t iterating objects" );
+                }
             }
         }
 
@@ -208,20 +385,29 @@ namespace mongo {
                                               "Index: (1/3) External Sort Progress",
                                               d->numRecords(),
                                               10));
-        SortPhaseOne phase1;
-        addKeysToPhaseOne(d, ns, idx, order, &phase1, d->numRecords(), pm.get(),
-                          mayInterrupt, idxNo );
+        SortPhaseOne myPhase1;
+        SortPhaseOne* phase1 = theDataFileMgr.getPrecalced();
+        if ( phase1 == NULL ) {
+            phase1 = &myPhase1;
+            addKeysToPhaseOne(d, ns, idx, order, phase1, d->numRecords(), pm.get(),
+                              mayInterrupt, idxNo );
+        }
+        else {
+            // the cloner fed this index's keys off a shared collection scan;
+            // skip straight to the sort
+            LOG(1) << "\t using precalculated sort data for " << idx.indexNamespace() << endl;
+        }
         pm.finished();
 
-        BSONObjExternalSorter& sorter = *(phase1.sorter);
+        BSONObjExternalSorter& sorter = *(phase1->sorter);
 
-        if( phase1.multi ) {
+        if( phase1->multi ) {
             d->setIndexIsMultikey(ns, idxNo);
         }
 
         if ( logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(2) ) )
             printMemInfo( "before final sort" );
-        phase1.sorter->sort( mayInterrupt );
+        phase1->sorter->sort( mayInterrupt );
         if ( logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(2) ) )
             printMemInfo( "after final sort" );
 
@@ -238,30 +424,30 @@ namespace mongo {
                                          dropDups,
                                          dupsToDrop,
                                          op,
-                                         &phase1,
+                                         phase1,
                                          pm,
                                          t,
                                          mayInterrupt);
-        else if( idx.version() == 1 ) 
+        else if( idx.version() == 1 )
             buildBottomUpPhases2And3<V1>(dupsAllowed,
                                          idx,
                                          sorter,
                                          dropDups,
                                          dupsToDrop,
                                          op,
-                                         &phase1,
+                                         phase1,
                                          pm,
                                          t,
                                          mayInterrupt);
         else
             verify(false);
 
-        if( dropDups ) 
+        if( dropDups )
             log() << "\t fastBuildIndex dupsToDrop:" << dupsToDrop.size() << endl;
 
         BtreeBasedBuilder::doDropDups(ns, d, dupsToDrop, mayInterrupt);
 
-        return phase1.n;
+        return phase1->n;
     }
 
     void BtreeBasedBuilder::doDropDups(const char* ns, NamespaceDetails* d,
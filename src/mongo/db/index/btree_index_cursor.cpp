@@ -163,7 +163,11 @@ namespace mongo {
 
     Status BtreeIndexCursor::savePosition() {
         if (!isEOF()) {
-            _savedKey = getKey().getOwned();
+            // Build the key into a buffer we reuse across yields rather than taking an
+            // owned copy: a long scan saves and restores its position thousands of times,
+            // and the per-yield malloc was a measurable share of the yield cost.
+            _savedKeyBuf.reset();
+            _savedKey = _interface->keyAt(_bucket, _keyOffset, _savedKeyBuf);
             _savedLoc = getValue();
             return Status::OK();
         } else {
@@ -238,7 +242,8 @@ namespace mongo {
 
     bool BtreeIndexCursor::isSavedPositionValid() {
         // We saved the key.  If it's in the same position we saved it from...
-        if (_interface->keyAt(_bucket, _keyOffset).binaryEqual(_savedKey)) {
+        _currentKeyBuf.reset();
+        if (_interface->keyAt(_bucket, _keyOffset, _currentKeyBuf).binaryEqual(_savedKey)) {
             // And the record it points to is the same record...
             if (_interface->recordAt(_bucket, _keyOffset) == _savedLoc) {
                 // Success!  We found it.  However!
@@ -94,9 +94,12 @@ namespace mongo {
         // Move to the next/prev. key.  Used by normal getNext and also skipping unused keys.
         void advance(const char* caller);
 
-        // For saving/restoring position.
+        // For saving/restoring position.  _savedKey's data lives in _savedKeyBuf; both
+        // buffers are reused across save/restore cycles so that yielding doesn't malloc.
         BSONObj _savedKey;
         DiskLoc _savedLoc;
+        BufBuilder _savedKeyBuf;
+        BufBuilder _currentKeyBuf;
 
         BSONObj _emptyObj;
 
@@ -156,6 +156,28 @@ namespace mongo {
             return keyOffset >= n ? BSONObj() : b->keyNode(keyOffset).key.toBson();
         }
 
+        virtual BSONObj keyAt(DiskLoc bucket, int keyOffset, BufBuilder& bb) const {
+            verify(!bucket.isNull());
+            const BtreeBucket<Version> *b = bucket.btree<Version>();
+            int n = b->getN();
+            if (n == b->INVALID_N_SENTINEL) {
+                throw UserException(deletedBucketCode, "keyAt bucket deleted");
+            }
+            dassert( n >= 0 && n < 10000 );
+            if (keyOffset >= n) {
+                return BSONObj();
+            }
+            BSONObj key = b->keyNode(keyOffset).key.toBson(bb);
+            if (key.objdata() != bb.buf()) {
+                // The key was already in bson format, so toBson returned a view into the
+                // bucket rather than building into bb.  Copy it out so the caller's
+                // lifetime guarantee holds.
+                bb.appendBuf(key.objdata(), key.objsize());
+                key = BSONObj(bb.buf());
+            }
+            return key;
+        }
+
         virtual DiskLoc recordAt(DiskLoc bucket, int keyOffset) const {
             const BtreeBucket<Version> *b = bucket.btree<Version>();
             return b->keyNode(keyOffset).recordLoc;
@@ -124,6 +124,15 @@ namespace mongo {
          */
         virtual BSONObj keyAt(DiskLoc bucket, int keyOffset) const = 0;
 
+        /**
+         * As above, but builds the object in 'bb', which must be empty on entry, instead of
+         * allocating an owned copy.  The returned object's data lives in 'bb' (even when the
+         * on-disk key is already in bson format), so it stays valid across a yield as long as
+         * 'bb' isn't touched.  Lets callers that save and compare positions frequently reuse
+         * one buffer instead of mallocing per call.
+         */
+        virtual BSONObj keyAt(DiskLoc bucket, int keyOffset, BufBuilder& bb) const = 0;
+
         /**
          * Get the DiskLoc that the key at (bucket, keyOffset) points at.
          */
@@ -27,6 +27,9 @@
 */
 
 #include "mongo/db/index/btree_key_generator.h"
+
+#include <algorithm>
+
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -51,12 +54,48 @@ namespace mongo {
     }
 
     void BtreeKeyGenerator::getKeys(const BSONObj &obj, BSONObjSet *keys) const {
-        // These are mutated as part of the getKeys call.  :|
-        vector<const char*> fieldNames(_fieldNames);
-        vector<BSONElement> fixed(_fixed);
-        getKeysImpl(fieldNames, fixed, obj, keys);
-        if (keys->empty() && ! _isSparse) {
-            keys->insert(_nullKey);
+        // Collect into a flat reusable buffer and dedup the whole batch afterwards.  For
+        // multikey documents this replaces a tree insert (node allocation plus rebalance)
+        // per array element with an append, at most one sort, and hinted set inserts.
+        _keysBuffer.clear();
+
+        // getKeysImpl copies these before mutating them; no need to copy here too.
+        getKeysImpl(_fieldNames, _fixed, obj, &_keysBuffer);
+
+        if (_keysBuffer.empty()) {
+            if (!_isSparse) {
+                keys->insert(_nullKey);
+            }
+            return;
+        }
+
+        if (_keysBuffer.size() == 1) {
+            // the common non-multikey case
+            keys->insert(_keysBuffer.front());
+            return;
+        }
+
+        // Already-sorted batches (append-style tag arrays are usually inserted in order)
+        // skip the sort.
+        const BSONObjCmp cmp;
+        bool isSorted = true;
+        for (size_t i = 1; i < _keysBuffer.size(); ++i) {
+            if (cmp(_keysBuffer[i], _keysBuffer[i - 1])) {
+                isSorted = false;
+                break;
+            }
+        }
+        if (!isSorted) {
+            std::sort(_keysBuffer.begin(), _keysBuffer.end(), cmp);
+        }
+
+        // Ascending hinted inserts are amortized constant time; equal neighbors are
+        // skipped here instead of being rediscovered by the set.
+        for (size_t i = 0; i < _keysBuffer.size(); ++i) {
+            if (i > 0 && !cmp(_keysBuffer[i - 1], _keysBuffer[i])) {
+                continue; // duplicate of the previous key
+            }
+            keys->insert(keys->end(), _keysBuffer[i]);
         }
     }
 
@@ -71,7 +110,8 @@ namespace mongo {
             : BtreeKeyGenerator(fieldNames, fixed, isSparse) { }
         
     void BtreeKeyGeneratorV0::getKeysImpl(vector<const char*> fieldNames, vector<BSONElement> fixed,
-                                          const BSONObj &obj, BSONObjSet *keys) const {
+                                          const BSONObj &obj, vector<BSONObj> *keys) const {
+        // fieldNames and fixed are mutated below and in recursive calls, hence by value.
         BSONElement arrElt;
         unsigned arrIdx = ~0;
         unsigned numNotFound = 0;
@@ -129,7 +169,7 @@ namespace mongo {
                 BSONObjBuilder b(_sizeTracker);
                 for( vector< BSONElement >::iterator i = fixed.begin(); i != fixed.end(); ++i )
                     b.appendAs( *i, "" );
-                keys->insert( b.obj() );
+                keys->push_back( b.obj() );
             }
             else {
                 // terminal array element to expand, so generate all keys
@@ -143,7 +183,7 @@ namespace mongo {
                             else
                                 b.appendAs( fixed[ j ], "" );
                         }
-                        keys->insert( b.obj() );
+                        keys->push_back( b.obj() );
                     }
                 }
                 else if ( fixed.size() > 1 ) {
@@ -183,7 +223,7 @@ namespace mongo {
                         b.appendAs( e , "" );
                 }
             }
-            keys->insert( b.obj() );
+            keys->push_back( b.obj() );
         }
     }
 
@@ -200,7 +240,9 @@ namespace mongo {
     BSONElement BtreeKeyGeneratorV1::extractNextElement(const BSONObj &obj, const BSONObj &arr,
                                                         const char *&field,
                                                         bool &arrayNestedArray) const {
-        string firstField = mongoutils::str::before( field, '.' );
+        // no heap allocation here -- this runs once per field per document per index
+        const char* dot = strchr( field, '.' );
+        StringData firstField = dot ? StringData( field, dot - field ) : StringData( field );
         bool haveObjField = !obj.getField( firstField ).eoo();
         BSONElement arrField = arr.getField( firstField );
         bool haveArrField = !arrField.eoo();
@@ -229,7 +271,7 @@ namespace mongo {
 
     void BtreeKeyGeneratorV1::_getKeysArrEltFixed(vector<const char*> &fieldNames,
                                                   vector<BSONElement> &fixed,
-                                                  const BSONElement &arrEntry, BSONObjSet *keys,
+                                                  const BSONElement &arrEntry, vector<BSONObj> *keys,
                                                   unsigned numNotFound,
                                                   const BSONElement &arrObjElt,
                                                   const set<unsigned> &arrIdxs,
@@ -249,13 +291,13 @@ namespace mongo {
                              arrObjElt.embeddedObject());
     }
 
-    void BtreeKeyGeneratorV1::getKeysImpl(vector<const char*> fieldNames, vector<BSONElement> fixed,                                          const BSONObj &obj, BSONObjSet *keys) const {
+    void BtreeKeyGeneratorV1::getKeysImpl(vector<const char*> fieldNames, vector<BSONElement> fixed,                                          const BSONObj &obj, vector<BSONObj> *keys) const {
         getKeysImplWithArray(fieldNames, fixed, obj, keys, 0, BSONObj());
     }
 
     void BtreeKeyGeneratorV1::getKeysImplWithArray(vector<const char*> fieldNames,
                                                    vector<BSONElement> fixed, const BSONObj &obj,
-                                                   BSONObjSet *keys, unsigned numNotFound,
+                                                   vector<BSONObj> *keys, unsigned numNotFound,
                                                    const BSONObj &array) const {
         BSONElement arrElt;
         set<unsigned> arrIdxs;
@@ -305,7 +347,7 @@ namespace mongo {
             for( vector< BSONElement >::iterator i = fixed.begin(); i != fixed.end(); ++i ) {
                 b.appendAs( *i, "" );
             }
-            keys->insert( b.obj() );
+            keys->push_back( b.obj() );
         }
         else if ( arrElt.embeddedObject().firstElement().eoo() ) {
             // Empty array, so set matching fields to undefined.
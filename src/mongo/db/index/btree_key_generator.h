@@ -56,10 +56,16 @@ namespace mongo {
         BSONElement _nullElt; // jstNull
         BSONSizeTracker _sizeTracker;
     private:
-        // We have V0 and V1.  Sigh.
+        // We have V0 and V1.  Sigh.  The impls append into a flat vector; getKeys() dedups
+        // the whole batch afterwards, which beats a tree insert per array element.
         virtual void getKeysImpl(vector<const char*> fieldNames, vector<BSONElement> fixed,
-                                 const BSONObj &obj, BSONObjSet *keys) const = 0;
+                                 const BSONObj &obj, vector<BSONObj> *keys) const = 0;
         vector<BSONElement> _fixed;
+
+        // Reused across documents so one key pattern pays for the buffer growth once per
+        // batch.  Generators are per-index and only used by one thread at a time, like the
+        // rest of this class.
+        mutable vector<BSONObj> _keysBuffer;
     };
 
     class BtreeKeyGeneratorV0 : public BtreeKeyGenerator {
@@ -70,7 +76,7 @@ namespace mongo {
         
     private:
         virtual void getKeysImpl(vector<const char*> fieldNames, vector<BSONElement> fixed,
-                                 const BSONObj &obj, BSONObjSet *keys) const;
+                                 const BSONObj &obj, vector<BSONObj> *keys) const;
     };
 
     class BtreeKeyGeneratorV1 : public BtreeKeyGenerator {
@@ -90,11 +96,11 @@ namespace mongo {
          *        If obj and array are both nonempty, obj will be one of the elements of array.
          */        
         virtual void getKeysImpl(vector<const char*> fieldNames, vector<BSONElement> fixed,
-                                 const BSONObj &obj, BSONObjSet *keys) const;
+                                 const BSONObj &obj, vector<BSONObj> *keys) const;
 
         // These guys are called by getKeysImpl.
         void getKeysImplWithArray(vector<const char*> fieldNames, vector<BSONElement> fixed,
-                                  const BSONObj &obj, BSONObjSet *keys, unsigned numNotFound,
+                                  const BSONObj &obj, vector<BSONObj> *keys, unsigned numNotFound,
                                   const BSONObj &array) const;
         /**
          * @param arrayNestedArray - set if the returned element is an array nested directly
@@ -103,7 +109,7 @@ namespace mongo {
         BSONElement extractNextElement(const BSONObj &obj, const BSONObj &arr, const char *&field,
                                        bool &arrayNestedArray ) const;
         void _getKeysArrEltFixed(vector<const char*> &fieldNames, vector<BSONElement> &fixed,
-                                 const BSONElement &arrEntry, BSONObjSet *keys,
+                                 const BSONElement &arrEntry, vector<BSONObj> *keys,
                                  unsigned numNotFound, const BSONElement &arrObjElt,
                                  const set<unsigned> &arrIdxs, bool mayExpandArrayUnembedded) const;
         
@@ -0,0 +1,97 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/db/index/deferred_index_updates.h"
+
+#include <algorithm>
+
+#include "mongo/db/index/btree_access_method_internal.h"
+#include "mongo/db/index/catalog_hack.h"
+#include "mongo/db/namespace_details.h"
+
+namespace mongo {
+
+    void DeferredIndexUpdates::add( int idxNo, const BSONObj& key, const DiskLoc& loc,
+                                    bool isInsert ) {
+        Delta delta;
+        delta.key = key.getOwned();
+        delta.loc = loc;
+        delta.isInsert = isInsert;
+        _deltas[idxNo].push_back( delta );
+        ++_numDeltas;
+    }
+
+    namespace {
+
+        /**
+         * orders deltas by key per the index's key pattern, so the flush descends the
+         * btree in roughly leaf order.  Inserts and removes never carry the same
+         * (key, loc) pair -- each document is updated once per batch and its added and
+         * removed key sets are disjoint -- so ties need no further ordering.
+         */
+        class DeltaKeyLess {
+        public:
+            explicit DeltaKeyLess( const BSONObj& keyPattern ) : _keyPattern( keyPattern ) { }
+            bool operator()( const DeferredIndexUpdates::Delta& l,
+                             const DeferredIndexUpdates::Delta& r ) const {
+                return l.key.woCompare( r.key, _keyPattern, false ) < 0;
+            }
+        private:
+            BSONObj _keyPattern;
+        };
+
+    }  // namespace
+
+    void DeferredIndexUpdates::flush( NamespaceDetails* d ) {
+        for ( PerIndexDeltas::iterator it = _deltas.begin(); it != _deltas.end(); ++it ) {
+            const int idxNo = it->first;
+            std::vector<Delta>& deltas = it->second;
+
+            auto_ptr<IndexDescriptor> descriptor( CatalogHack::getDescriptor( d, idxNo ) );
+            auto_ptr<IndexAccessMethod> iam( CatalogHack::getIndex( descriptor.get() ) );
+            // every access method in the catalog is btree backed
+            BtreeBasedAccessMethod* btree = static_cast<BtreeBasedAccessMethod*>( iam.get() );
+
+            std::sort( deltas.begin(), deltas.end(), DeltaKeyLess( descriptor->keyPattern() ) );
+
+            for ( size_t i = 0; i < deltas.size(); ++i ) {
+                if ( deltas[i].isInsert ) {
+                    // only dups-allowed indexes defer, so this can't see a dup failure
+                    btree->insertKey( deltas[i].key, deltas[i].loc, true );
+                }
+                else {
+                    btree->removeKey( deltas[i].key, deltas[i].loc );
+                }
+            }
+        }
+
+        _deltas.clear();
+        _numDeltas = 0;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,88 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "mongo/db/diskloc.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    class NamespaceDetails;
+
+    /**
+     * Key-level index deltas batched up across a run of in-place updates, applied per
+     * index in key order at flush() time.  A multi-update that touches N documents
+     * normally makes N random btree descents per affected index; collecting the
+     * (key, DiskLoc) inserts and removes here and applying them sorted turns that into
+     * one roughly sequential pass per index.
+     *
+     * Correctness rules, enforced by the caller (see update()):
+     *  - the write lock must be held continuously from the first deferred delta until
+     *    flush(); with the lock released the btrees must agree with the documents, so
+     *    pending deltas may never survive a yield;
+     *  - only indexes that allow duplicates may defer.  A unique index's duplicate
+     *    check runs against the btree as it stands, so its changes can't lag behind it
+     *    (see BtreeBasedAccessMethod::updateDeferred, which applies those in line).
+     */
+    class DeferredIndexUpdates {
+    public:
+
+        DeferredIndexUpdates() : _numDeltas( 0 ) { }
+
+        /**
+         * queue one key insert or remove against index 'idxNo'; 'key' is copied.
+         */
+        void add( int idxNo, const BSONObj& key, const DiskLoc& loc, bool isInsert );
+
+        bool empty() const { return 0 == _numDeltas; }
+        size_t size() const { return _numDeltas; }
+
+        /**
+         * apply everything queued, sorted per index, and forget it.  'd' must be the
+         * same (still valid) collection the deltas were queued against.
+         */
+        void flush( NamespaceDetails* d );
+
+        struct Delta {
+            BSONObj key;
+            DiskLoc loc;
+            bool isInsert;
+        };
+
+    private:
+
+        typedef std::map< int, std::vector<Delta> > PerIndexDeltas;
+        PerIndexDeltas _deltas;
+        size_t _numDeltas;
+    };
+
+}  // namespace mongo
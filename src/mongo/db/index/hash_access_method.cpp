@@ -77,6 +77,12 @@ namespace mongo {
         massert(16765, "error: no hashed index field",
                 firstElt.str().compare(HASHED_INDEX_TYPE_IDENTIFIER) == 0);
         _hashedField = firstElt.fieldName();
+
+        // The key for a document missing the hashed field is the same for every
+        // such document in this index, so hash it once here instead of once per
+        // getKeys() call.
+        BSONObj nullObj = BSON("" << BSONNULL);
+        _missingKey = BSON("" << makeSingleKey(nullObj.firstElement(), _seed, _hashVersion));
     }
 
     Status HashAccessMethod::newCursor(IndexCursor** out) {
@@ -85,7 +91,22 @@ namespace mongo {
     }
 
     void HashAccessMethod::getKeys(const BSONObj& obj, BSONObjSet* keys) {
-        getKeysImpl(obj, _hashedField, _seed, _hashVersion, _descriptor->isSparse(), keys);
+        const char* cstr = _hashedField.c_str();
+        BSONElement fieldVal = obj.getFieldDottedOrArray(cstr);
+        uassert(17516, "Error: hashed indexes do not currently support array values",
+                fieldVal.type() != Array );
+
+        if (!fieldVal.eoo()) {
+            // {"": NumberLong} needs exactly 16 bytes: length, type byte, empty
+            // name, 8-byte value, EOO.  Presizing skips the builder's default
+            // 64-byte buffer and its growth checks.
+            BSONObjBuilder b(16);
+            b.append("", makeSingleKey(fieldVal, _seed, _hashVersion));
+            keys->insert(b.obj());
+        }
+        else if (!_descriptor->isSparse()) {
+            keys->insert(_missingKey);
+        }
     }
 
     // static
@@ -0,0 +1,218 @@
+// index_stats_refresher.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/index_stats_refresher.h"
+
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/btree.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/fsync.h"
+#include "mongo/db/database_holder.h"
+#include "mongo/db/index.h"
+#include "mongo/db/instance.h"
+#include "mongo/db/namespace_details.h"
+#include "mongo/db/query/index_statistics.h"
+#include "mongo/db/repl/rs.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/background.h"
+
+namespace mongo {
+
+    MONGO_EXPORT_SERVER_PARAMETER( indexStatsRefreshSecs, int, 300 );
+
+    // random descents per index per refresh; the samples double as equi-depth
+    // histogram boundaries, so more samples mean finer selectivity estimates
+    static const int IndexStatsSamplesPerIndex = 256;
+
+    class IndexStatsRefresher : public BackgroundJob {
+    public:
+        IndexStatsRefresher() : _prng( static_cast<int64_t>( curTimeMicros64() ) ) {}
+        virtual ~IndexStatsRefresher() {}
+
+        virtual string name() const { return "IndexStatsRefresher"; }
+
+        // statistics are advisory; yield the cpu/io schedulers to foreground work
+        virtual Priority priority() const { return LOW; }
+
+        virtual void run() {
+            Client::initThread( name().c_str() );
+            cc().getAuthorizationSession()->grantInternalAuthorization();
+
+            while ( ! inShutdown() ) {
+                sleepsecs( std::max( 10 , static_cast<int>( indexStatsRefreshSecs ) ) );
+
+                LOG(3) << "IndexStatsRefresher thread awake" << endl;
+
+                if ( lockedForWriting() ) {
+                    LOG(3) << " locked for writing" << endl;
+                    continue;
+                }
+
+                // if part of replSet but not in a readable state (e.g. during initial
+                // sync), the btrees aren't worth sampling yet
+                if ( theReplSet && !theReplSet->state().readable() )
+                    continue;
+
+                set<string> dbs;
+                {
+                    Lock::DBRead lk( "local" );
+                    dbHolder().getAllShortNames( dbs );
+                }
+
+                for ( set<string>::const_iterator i = dbs.begin(); i != dbs.end(); ++i ) {
+                    try {
+                        refreshForDB( *i );
+                    }
+                    catch ( const DBException& e ) {
+                        LOG(1) << "IndexStatsRefresher error on db " << *i
+                               << causedBy( e ) << endl;
+                    }
+                    if ( inShutdown() )
+                        break;
+                }
+            }
+
+            cc().shutdown();
+        }
+
+    private:
+        void refreshForDB( const string& dbName ) {
+            vector<BSONObj> indexes;
+            {
+                auto_ptr<DBClientCursor> cursor =
+                                _db.query( dbName + ".system.indexes" , BSONObj() ,
+                                           0 , 0 , 0 , QueryOption_SlaveOk );
+                if ( cursor.get() ) {
+                    while ( cursor->more() ) {
+                        indexes.push_back( cursor->next().getOwned() );
+                    }
+                }
+            }
+
+            for ( unsigned i = 0; i < indexes.size(); i++ ) {
+                const BSONObj& spec = indexes[i];
+                string ns = spec["ns"].String();
+                if ( ns.find( ".system." ) != string::npos )
+                    continue;
+
+                // only plain btree indexes: special plugins (2d, hashed, text, ...)
+                // mark themselves with a non-numeric value in the key pattern
+                BSONObj key = spec["key"].Obj();
+                if ( ! key.firstElement().isNumber() )
+                    continue;
+
+                refreshOne( ns , spec["name"].String() );
+                sleepmillis( 10 );
+            }
+        }
+
+        void refreshOne( const string& ns , const string& indexName ) {
+            vector<BSONObj> samples;
+            BSONObj keyPattern;
+            long long numKeys;
+            {
+                Client::ReadContext ctx( ns );
+                NamespaceDetails* d = nsdetails( ns );
+                if ( ! d )
+                    return; // collection was dropped
+                int idxNo = d->findIndexByName( indexName );
+                if ( idxNo < 0 )
+                    return;
+                IndexDetails& idx = d->idx( idxNo );
+                if ( idx.head.isNull() )
+                    return;
+
+                switch ( idx.version() ) {
+                case 0: sampleKeys<V0>( idx.head , &samples ); break;
+                case 1: sampleKeys<V1>( idx.head , &samples ); break;
+                default: return;
+                }
+
+                keyPattern = idx.keyPattern().getOwned();
+                numKeys = d->numRecords();
+            }
+
+            if ( samples.empty() )
+                return;
+
+            indexStatsRegistry.set( ns , keyPattern , IndexStatisticsPtr(
+                    new IndexStatistics( keyPattern , numKeys , samples ) ) );
+
+            LOG(2) << "IndexStatsRefresher sampled " << samples.size() << " keys from "
+                   << ns << " " << keyPattern << endl;
+        }
+
+        /**
+         * Collects up to IndexStatsSamplesPerIndex leading-field values by random
+         * descents from the btree root: at each bucket pick a child slot uniformly and
+         * descend, taking a key when the descent bottoms out.  Interior buckets have
+         * far fewer keys than leaves, so this is close enough to uniform for planning
+         * estimates and touches only O(depth) buckets per sample.
+         */
+        template<class Version>
+        void sampleKeys( const DiskLoc& head , vector<BSONObj>* out ) {
+            for ( int i = 0; i < IndexStatsSamplesPerIndex; i++ ) {
+                DiskLoc dl = head;
+                BSONObj key;
+                while ( true ) {
+                    const BtreeBucket<Version>* b = dl.btree<Version>();
+                    int n = b->getN();
+                    if ( 0 == n )
+                        break;
+                    int pos = ( _prng.nextInt32() & 0x7fffffff ) % ( n + 1 );
+                    DiskLoc child = ( pos == n ) ? b->getNextChild()
+                                                 : b->k( pos ).prevChildBucket;
+                    if ( child.isNull() ) {
+                        if ( pos == n )
+                            pos = n - 1;
+                        if ( b->k( pos ).isUsed() )
+                            key = b->keyNode( pos ).key.toBson();
+                        break;
+                    }
+                    dl = child;
+                }
+                if ( ! key.isEmpty() )
+                    out->push_back( key.firstElement().wrap().getOwned() );
+            }
+        }
+
+        DBDirectClient _db;
+        PseudoRandom _prng;
+    };
+
+    void startIndexStatsRefresher() {
+        IndexStatsRefresher* refresher = new IndexStatsRefresher();
+        refresher->go();
+    }
+
+}  // namespace mongo
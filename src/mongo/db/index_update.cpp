@@ -35,14 +35,18 @@
 #include "mongo/db/extsort.h"
 #include "mongo/db/index.h"
 #include "mongo/db/index/btree_based_builder.h"
+#include "mongo/db/index/btree_key_generator.h"
 #include "mongo/db/index/catalog_hack.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/namespace_details.h"
 #include "mongo/db/pdfile_private.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/runner_yield_policy.h"
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/rs.h"
+#include "mongo/db/sort_phase_one.h"
 #include "mongo/util/processinfo.h"
 
 namespace mongo {
@@ -331,6 +335,9 @@ namespace mongo {
         /* there may be pointers pointing at keys in the btree(s).  kill them. */
         ClientCursor::invalidate(ns);
 
+        // cached solutions may reference the index(es) being dropped
+        PlanCache::clear(ns.toString());
+
         // delete a specific index or all?
         if ( name == "*" ) {
             // this should be covered by assertNoBgOpInProgForNs above, but being paranoid
@@ -389,4 +396,98 @@ namespace mongo {
         return true;
     }
 
+    /** true if we can generate this spec's keys before the index exists: a plain
+        (no plugin) btree spec built in the foreground.  _id is excluded because it
+        is built while the collection is populated. */
+    static bool eligibleForPrecalc( const BSONObj& spec ) {
+        if ( spec["background"].trueValue() )
+            return false;
+        BSONElement v = spec["v"];
+        if ( !v.eoo() && v.Number() != 1 )
+            return false;
+        BSONObj key = spec.getObjectField("key");
+        if ( key.isEmpty() || IndexDetails::isIdIndexPattern( key ) )
+            return false;
+        return IndexNames::findPluginName( key ).empty();
+    }
+
+    void precalcIndexPhaseOnes( const list<BSONObj>& specs,
+                                bool mayBeInterrupted,
+                                vector< shared_ptr<SortPhaseOne> >* phases ) {
+        vector<BSONObj> specVec( specs.begin(), specs.end() );
+        phases->clear();
+        phases->resize( specVec.size() );
+
+        // group eligible specs by the collection they index
+        map< string, vector<size_t> > byNs;
+        for ( size_t i = 0; i < specVec.size(); i++ ) {
+            if ( eligibleForPrecalc( specVec[i] ) )
+                byNs[ specVec[i]["ns"].valuestrsafe() ].push_back( i );
+        }
+
+        for ( map< string, vector<size_t> >::const_iterator it = byNs.begin();
+              it != byNs.end();
+              ++it ) {
+            const string& ns = it->first;
+            const vector<size_t>& which = it->second;
+            if ( which.size() < 2 )
+                continue;
+
+            NamespaceDetails* nsd = nsdetails( ns );
+            if ( !nsd )
+                continue;
+
+            log() << "shared scan of " << ns << " for the sort phase of "
+                  << which.size() << " index builds" << endl;
+
+            // a key generator and a sorter per index.  the generators point into
+            // the spec objects, which specVec keeps alive for the whole scan.
+            vector< shared_ptr<BtreeKeyGeneratorV1> > gens;
+            for ( size_t j = 0; j < which.size(); j++ ) {
+                const BSONObj& spec = specVec[which[j]];
+                BSONObj key = spec.getObjectField("key");
+
+                vector<const char*> fieldNames;
+                vector<BSONElement> fixed;
+                BSONObjIterator kit(key);
+                while ( kit.more() ) {
+                    fieldNames.push_back( kit.next().fieldName() );
+                    fixed.push_back( BSONElement() );
+                }
+                gens.push_back( shared_ptr<BtreeKeyGeneratorV1>(
+                        new BtreeKeyGeneratorV1( fieldNames, fixed,
+                                                 spec["sparse"].trueValue() ) ) );
+
+                shared_ptr<SortPhaseOne> p( new SortPhaseOne() );
+                p->sortCmp.reset( BtreeBasedBuilder::getComparison( 1, key ) );
+                p->sorter.reset( new BSONObjExternalSorter( p->sortCmp.get() ) );
+                p->sorter->hintNumObjects( nsd->numRecords() );
+                (*phases)[which[j]] = p;
+            }
+
+            auto_ptr<Runner> runner( InternalPlanner::collectionScan( ns ) );
+            BSONObj o;
+            DiskLoc loc;
+            Runner::RunnerState state;
+            while ( Runner::RUNNER_ADVANCED == ( state = runner->getNext( &o, &loc ) ) ) {
+                RARELY if ( mayBeInterrupted ) {
+                    killCurrentOp.checkForInterrupt( false );
+                }
+                for ( size_t j = 0; j < which.size(); j++ ) {
+                    BSONObjSet keys;
+                    gens[j]->getKeys( o, &keys );
+                    (*phases)[which[j]]->addKeys( keys, loc, mayBeInterrupted );
+                }
+            }
+
+            if ( state != Runner::RUNNER_EOF ) {
+                warning() << "shared index scan of " << ns << " did not reach EOF;"
+                          << " falling back on per-index scans" << endl;
+                for ( size_t j = 0; j < which.size(); j++ ) {
+                    (*phases)[which[j]].reset();
+                }
+            }
+        }
+    }
+
 }  // namespace mongo
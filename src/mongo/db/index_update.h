@@ -36,6 +36,7 @@
 namespace mongo {
     class NamespaceDetails;
     class Record;
+    struct SortPhaseOne;
 
     // unindex all keys in index for this record. 
     void unindexRecord(NamespaceDetails *d, Record *todelete, const DiskLoc& dl,
@@ -61,4 +62,17 @@ namespace mongo {
      */
     void ensureHaveIdIndex(const char* ns, bool mayInterrupt);
 
+    /**
+     * Feed the external-sort phase of every plain (foreground, no plugin, v1)
+     * btree index in 'specs' from one scan of each indexed collection, instead
+     * of letting each fastBuildIndex rescan.  *phases is replaced by a vector
+     * parallel to specs; entries stay NULL for specs that must take the normal
+     * build path, or when a collection has only one index to build.  Set each
+     * non-NULL entry as DataFileMgr::setPrecalced around the corresponding
+     * system.indexes insert.
+     */
+    void precalcIndexPhaseOnes( const list<BSONObj>& specs,
+                                bool mayBeInterrupted,
+                                vector< shared_ptr<SortPhaseOne> >* phases );
+
 } // namespace mongo
@@ -44,6 +44,7 @@
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/auth/security_key.h"
+#include "mongo/logger/async_message_appender.h"
 #include "mongo/logger/logger.h"
 #include "mongo/logger/message_event.h"
 #include "mongo/logger/message_event_utf8_encoder.h"
@@ -207,10 +208,13 @@ namespace mongo {
             openlog(strdup(sb.str().c_str()), LOG_PID | LOG_CONS, LOG_USER);
             LogManager* manager = logger::globalLogManager();
             manager->getGlobalDomain()->clearAppenders();
-            manager->getGlobalDomain()->attachAppender(
-                    MessageLogDomain::AppenderAutoPtr(
-                            new SyslogAppender<MessageEventEphemeral>(
-                                    new logger::MessageEventWithContextEncoder)));
+            MessageLogDomain::AppenderAutoPtr appender(
+                    new SyslogAppender<MessageEventEphemeral>(
+                            new logger::MessageEventWithContextEncoder));
+            if (serverGlobalParams.logAsync) {
+                appender.reset(new logger::AsyncMessageAppender(appender));
+            }
+            manager->getGlobalDomain()->attachAppender(appender);
             manager->getNamedDomain("javascriptOutput")->attachAppender(
                     MessageLogDomain::AppenderAutoPtr(
                             new SyslogAppender<MessageEventEphemeral>(
@@ -266,10 +270,15 @@ namespace mongo {
 
             LogManager* manager = logger::globalLogManager();
             manager->getGlobalDomain()->clearAppenders();
-            manager->getGlobalDomain()->attachAppender(
-                    MessageLogDomain::AppenderAutoPtr(
-                            new RotatableFileAppender<MessageEventEphemeral>(
-                                    new MessageEventDetailsEncoder, writer.getValue())));
+            MessageLogDomain::AppenderAutoPtr appender(
+                    new RotatableFileAppender<MessageEventEphemeral>(
+                            new MessageEventDetailsEncoder, writer.getValue()));
+            if (serverGlobalParams.logAsync) {
+                // Queue log writes behind a dedicated writer thread so hot paths are not
+                // stalled formatting timestamps or waiting on the log file.
+                appender.reset(new logger::AsyncMessageAppender(appender));
+            }
+            manager->getGlobalDomain()->attachAppender(appender);
             manager->getNamedDomain("javascriptOutput")->attachAppender(
                     MessageLogDomain::AppenderAutoPtr(
                             new RotatableFileAppender<MessageEventEphemeral>(
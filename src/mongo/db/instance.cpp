@@ -32,6 +32,7 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
 #include <fstream>
 #if defined(_WIN32)
 #include <io.h>
@@ -46,11 +47,14 @@
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/background.h"
+#include "mongo/db/capped_insert_notifier.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands/fsync.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/d_concurrency.h"
 #include "mongo/db/db.h"
 #include "mongo/db/dbmessage.h"
+#include "mongo/db/dur.h"
 #include "mongo/db/dur_commitjob.h"
 #include "mongo/db/dur_journal.h"
 #include "mongo/db/dur_recover.h"
@@ -69,16 +73,20 @@
 #include "mongo/db/pagefault.h"
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/platform/process_id.h"
+#include "mongo/s/d_hotspots.h"
 #include "mongo/s/d_logic.h"
 #include "mongo/s/stale_exception.h" // for SendStaleConfigException
+#include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/file_allocator.h"
 #include "mongo/util/gcov.h"
 #include "mongo/util/goodies.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/listen.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
@@ -90,7 +98,7 @@ namespace mongo {
     void receivedKillCursors(Message& m);
     void receivedUpdate(Message& m, CurOp& op);
     void receivedDelete(Message& m, CurOp& op);
-    void receivedInsert(Message& m, CurOp& op);
+    void receivedInsert(Message& m, CurOp& op, DbResponse& dbresponse);
     bool receivedGetMore(DbResponse& dbresponse, Message& m, CurOp& curop );
 
     int nloggedsome = 0;
@@ -352,6 +360,75 @@ namespace mongo {
     }
 
     // Returns false when request includes 'end'
+    // --- operation admission control ---
+
+    // Maximum number of CRUD operations allowed into the database concurrently;
+    // 0 (the default) disables admission control.  Commands are always exempt so
+    // health checks and monitoring keep responding under saturation.
+    MONGO_EXPORT_SERVER_PARAMETER(admissionControlTickets, int, 0);
+
+    namespace {
+
+        TicketHolder admissionTicketHolder(0);
+
+        /** Clients tag background scans by adding "$lowPriority: true" next to $query
+            in the query wrapper; such operations defer to untagged traffic whenever
+            the admission gate is saturated.  Unknown $-fields are ignored by the
+            query parser so the tag needs no changes there.
+        */
+        bool isLowPriorityOp( Message& m ) {
+            if ( m.operation() != dbQuery )
+                return false;
+            try {
+                DbMessage d( m );
+                QueryMessage q( d );
+                return q.query["$lowPriority"].trueValue();
+            }
+            catch ( ... ) {
+                // malformed message; the real parse will deal with it
+                return false;
+            }
+        }
+
+        class ScopedAdmission {
+            MONGO_DISALLOW_COPYING(ScopedAdmission);
+        public:
+            explicit ScopedAdmission( Message& m ) : _acquired(false) {
+                int tickets = admissionControlTickets;
+                if ( tickets <= 0 )
+                    return;
+                if ( tickets != admissionTicketHolder.outof() ) {
+                    admissionTicketHolder.resize( tickets );
+                    // keep one ticket in ten (at least one) out of reach of
+                    // low-priority operations
+                    admissionTicketHolder.setLowPriorityReserve( std::max( 1, tickets / 10 ) );
+                }
+                admissionTicketHolder.waitForTicket( isLowPriorityOp( m ) ?
+                                                         TicketHolder::PRIORITY_LOW :
+                                                         TicketHolder::PRIORITY_NORMAL );
+                _acquired = true;
+            }
+            ~ScopedAdmission() {
+                if ( _acquired )
+                    admissionTicketHolder.release();
+            }
+        private:
+            bool _acquired;
+        };
+
+        class AdmissionServerStatusMetric : public ServerStatusMetric {
+        public:
+            AdmissionServerStatusMetric() : ServerStatusMetric("admission.used") {}
+            virtual void appendAtLeaf( BSONObjBuilder& b ) const {
+                b.append( "used", admissionTicketHolder.used() );
+                b.append( "available", admissionTicketHolder.available() );
+                b.append( "queuedNormal", admissionTicketHolder.queuedNormal() );
+                b.append( "queuedLow", admissionTicketHolder.queuedLow() );
+            }
+        } admissionServerStatusMetric;
+
+    }  // namespace
+
     void assembleResponse( Message &m, DbResponse &dbresponse, const HostAndPort& remote ) {
 
         // before we lock...
@@ -416,8 +493,21 @@ namespace mongo {
         }
 
         Client& c = cc();
+
+        // Gate CRUD operations when admission control is enabled.  This happens before
+        // we take any locks, so queued operations don't hold anything anyone wants.
+        // Nested operations (DBDirectClient) are exempt: their enclosing op was already
+        // admitted and may be holding locks and a ticket.
+        scoped_ptr<ScopedAdmission> admission;
+        if ( admissionControlTickets > 0 &&
+             !c.curop()->active() &&
+             ( ( op == dbQuery && !isCommand ) || op == dbGetMore ||
+               op == dbInsert || op == dbUpdate || op == dbDelete ) ) {
+            admission.reset( new ScopedAdmission( m ) );
+        }
+
         c.getAuthorizationSession()->startRequest();
-        
+
         auto_ptr<CurOp> nestedOp;
         CurOp* currentOpP = c.curop();
         if ( currentOpP->active() ) {
@@ -480,7 +570,7 @@ namespace mongo {
                     uassert( 16257, str::stream() << "Invalid ns [" << ns << "]", false );
                 }
                 else if ( op == dbInsert ) {
-                    receivedInsert(m, currentOp);
+                    receivedInsert(m, currentOp, dbresponse);
                 }
                 else if ( op == dbUpdate ) {
                     receivedUpdate(m, currentOp);
@@ -583,6 +673,10 @@ namespace mongo {
         dbHolderW().erase( db, path );
         ctx->_clear();
         delete database; // closes files
+
+        // closing a database just freed a lot of heap; let the allocator hand
+        // its cached pages back rather than sit on them
+        mallocReleaseFreeMemory();
     }
 
     void receivedUpdate(Message& m, CurOp& op) {
@@ -743,6 +837,8 @@ namespace mongo {
         bool exhaust = false;
         QueryResult* msgdata = 0;
         OpTime last;
+        shared_ptr<CappedInsertNotifier> capNotifier;
+        unsigned long long capVersion = 0;
         while( 1 ) {
             bool isCursorAuthorized = false;
             try {
@@ -767,6 +863,11 @@ namespace mongo {
                         last.waitForDifferent(1000/*ms*/);
                     }
                 }
+                else if ( capNotifier ) {
+                    // capture before the scan so an insert landing mid-scan makes the
+                    // wait below return immediately instead of being missed
+                    capVersion = capNotifier->version();
+                }
 
                 msgdata = processGetMore(ns,
                                          ntoreturn,
@@ -805,11 +906,20 @@ namespace mongo {
                     }
                 }
                 pass++;
-                if (debug)
-                    sleepmillis(20);
-                else
-                    sleepmillis(2);
-                
+                if (str::startsWith(ns, "local.oplog.")) {
+                    // waitForDifferent above already blocked waiting for oplog writes
+                }
+                else if ( !capNotifier ) {
+                    // first empty result: register for insert signaling.  don't wait
+                    // yet -- re-scan with a version captured before the scan.
+                    capNotifier = CappedInsertNotifier::get(ns);
+                }
+                else {
+                    // block until a capped insert signals us instead of sleep-polling;
+                    // the timeout keeps us responsive to shutdown and cursor timeout
+                    capNotifier->waitForInsert(capVersion, 200/*ms*/);
+                }
+
                 // note: the 1100 is beacuse of the waitForDifferent above
                 // should eventually clean this up a bit
                 curop.setExpectedLatencyMs( 1100 + timer->millis() );
@@ -848,7 +958,7 @@ namespace mongo {
         return ok;
     }
 
-    void checkAndInsert(const char *ns, /*modifies*/BSONObj& js) {
+    static void checkForInsert(const BSONObj& js) {
         uassert( 10059 , "object to insert too large", js.objsize() <= BSONObjMaxUserSize);
         {
             BSONObjIterator i( js );
@@ -871,6 +981,10 @@ namespace mongo {
                 }
             }
         }
+    }
+
+    void checkAndInsert(const char *ns, /*modifies*/BSONObj& js) {
+        checkForInsert(js);
 
         theDataFileMgr.insertWithObjMod(ns,
                                         // May be modified in the call to add an _id field.
@@ -884,6 +998,39 @@ namespace mongo {
         logOp("i", ns, js);
     }
 
+    bool checkAndInsertBatch(const char *ns, const vector<BSONObj>& objs, size_t* numInserted) {
+        *numInserted = 0;
+
+        // If any document fails validation, fall back to the one-at-a-time path so the
+        // caller's per-document error reporting sees the failure at the right index.
+        try {
+            for (size_t i = 0; i < objs.size(); i++)
+                checkForInsert(objs[i]);
+        }
+        catch (const UserException&) {
+            return false;
+        }
+
+        vector<BSONObj> inserted;
+        inserted.reserve(objs.size());
+        try {
+            if (!theDataFileMgr.insertBatch(ns, objs, &inserted))
+                return false;
+        }
+        catch (...) {
+            // a prefix of the batch may have gone in; it must reach the oplog
+            for (size_t i = 0; i < inserted.size(); i++)
+                logOp("i", ns, inserted[i]);
+            *numInserted = inserted.size();
+            throw;
+        }
+
+        for (size_t i = 0; i < inserted.size(); i++)
+            logOp("i", ns, inserted[i]);
+        *numInserted = inserted.size();
+        return true;
+    }
+
     NOINLINE_DECL void insertMulti(bool keepGoing, const char *ns, vector<BSONObj>& objs, CurOp& op) {
         size_t i;
         for (i=0; i<objs.size(); i++){
@@ -903,7 +1050,60 @@ namespace mongo {
         op.debug().ninserted = i;
     }
 
-    void receivedInsert(Message& m, CurOp& op) {
+    namespace {
+
+        /**
+         * Per-connection accounting for streaming ingest (InsertOption_StreamReceipt).
+         * Receipts are batched: one group-commit wait and one reply message cover
+         * everything streamed on the connection since the previous receipt.
+         */
+        struct StreamIngestState {
+            StreamIngestState() : insertedSinceReceipt(0), lastReceiptMillis(0) {}
+            long long insertedSinceReceipt;
+            long long lastReceiptMillis;
+        };
+        boost::thread_specific_ptr<StreamIngestState> streamIngestState;
+
+        const long long kReceiptMaxDocs = 10000;
+        const long long kReceiptIntervalMillis = 1000;
+
+    } // namespace
+
+    /**
+     * Account the documents the frame inserted and, when a receipt is due, wait once
+     * for the group commit and answer the frame with { ok, n, j } covering everything
+     * since the last receipt.  Frames that don't trigger a receipt get no response.
+     * Must not be called with the db lock held: the commit wait can need it.
+     */
+    static void streamIngestReceipt(Message& m, CurOp& op, DbResponse& dbresponse) {
+        StreamIngestState* state = streamIngestState.get();
+        if ( !state ) {
+            state = new StreamIngestState();
+            state->lastReceiptMillis = Listener::getElapsedTimeMillis();
+            streamIngestState.reset( state );
+        }
+        state->insertedSinceReceipt += op.debug().ninserted;
+
+        const long long now = Listener::getElapsedTimeMillis();
+        if ( state->insertedSinceReceipt < kReceiptMaxDocs &&
+             now - state->lastReceiptMillis < kReceiptIntervalMillis ) {
+            return;
+        }
+
+        // one group-commit wait covers every insert since the last receipt
+        const bool durable = getDur().awaitCommit();
+
+        BSONObjBuilder b;
+        b.append( "ok" , 1.0 );
+        b.appendNumber( "n" , state->insertedSinceReceipt );
+        b.appendBool( "j" , durable );
+        replyToQuery( 0, m, dbresponse, b.obj() );
+
+        state->insertedSinceReceipt = 0;
+        state->lastReceiptMillis = now;
+    }
+
+    void receivedInsert(Message& m, CurOp& op, DbResponse& dbresponse) {
         DbMessage d(m);
         const char *ns = d.getns();
         op.debug().ns = ns;
@@ -926,34 +1126,66 @@ namespace mongo {
             uassertStatusOK(status);
         }
 
+        const bool streaming = d.reservedField() & InsertOption_StreamReceipt;
+
         PageFaultRetryableSection s;
         while ( true ) {
             try {
                 Lock::DBWrite lk(ns);
-                
+
                 // CONCURRENCY TODO: is being read locked in big log sufficient here?
                 // writelock is used to synchronize stepdowns w/ writes
                 uassert( 10058 , "not master", isMasterNs(ns) );
-                
+
                 if ( handlePossibleShardedMessage( m , 0 ) )
                     return;
-                
+
                 Client::Context ctx(ns);
-                
+
                 if (multi.size() > 1) {
                     const bool keepGoing = d.reservedField() & InsertOption_ContinueOnError;
-                    insertMulti(keepGoing, ns, multi, op);
+                    bool batched = false;
+                    if (streaming && !keepGoing) {
+                        // Take the whole frame through one allocation and one oplog
+                        // pass when the collection is eligible; ineligible frames
+                        // (capped collections, a document failing validation) fall
+                        // back to the per-document path.
+                        size_t numInserted = 0;
+                        try {
+                            batched = checkAndInsertBatch(ns, multi, &numInserted);
+                        }
+                        catch (const UserException&) {
+                            // a prefix of the frame went in before the failure
+                            globalOpCounters.incInsertInWriteLock(numInserted);
+                            op.debug().ninserted = numInserted;
+                            throw;
+                        }
+                        if (batched) {
+                            globalOpCounters.incInsertInWriteLock(numInserted);
+                            op.debug().ninserted = numInserted;
+                        }
+                    }
+                    if (!batched) {
+                        insertMulti(keepGoing, ns, multi, op);
+                    }
                 } else {
                     checkAndInsert(ns, multi[0]);
                     globalOpCounters.incInsertInWriteLock(1);
                     op.debug().ninserted = 1;
                 }
-                return;
+
+                // hotspot telemetry: charge the inserts to their chunks' counters
+                noteShardedInserts( ns, multi );
+                break;
             }
             catch ( PageFaultException& e ) {
                 e.touch();
             }
         }
+
+        if ( streaming ) {
+            streamIngestReceipt( m, op, dbresponse );
+        }
     }
 
     void getDatabaseNames( vector< string > &names , const string& usePath ) {
@@ -1124,6 +1356,14 @@ namespace mongo {
             MemoryMappedFile::flushAll(true);
         }
 
+        if (storageGlobalParams.dur) {
+            // let the journal threads flush their last buffer and exit before
+            // closeAllFiles takes LockMongoFilesExclusive; a writer flush needs
+            // the shared lock to finish and would deadlock against it
+            log() << "shutdown: waiting for journal threads..." << endl;
+            dur::waitForJournalThreadsToStop();
+        }
+
         log() << "shutdown: closing all files..." << endl;
         stringstream ss3;
         MemoryMappedFile::closeAllFiles( ss3 );
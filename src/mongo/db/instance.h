@@ -139,4 +139,12 @@ namespace mongo {
 
     void checkAndInsert(const char *ns, BSONObj& js);
 
+    /**
+     * Validates and inserts a whole batch through DataFileMgr::insertBatch, logging each
+     * inserted document to the oplog.  Returns false without inserting anything if the
+     * batch is not eligible for the bulk path (caller should insert one at a time).
+     * On an exception, *numInserted tells how many leading documents made it in.
+     */
+    bool checkAndInsertBatch(const char *ns, const vector<BSONObj>& objs, size_t* numInserted);
+
 } // namespace mongo
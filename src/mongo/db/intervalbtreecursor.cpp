@@ -55,6 +55,27 @@ namespace mongo {
         }
     }
 
+    /**
+     * Count every used key in the subtree rooted at 'bucket'.  Only bucket headers and
+     * key flags are touched; no key comparisons or record dereferences are performed.
+     */
+    static int64_t countSubtree( const DiskLoc& bucket ) {
+        if ( bucket.isNull() ) {
+            return 0;
+        }
+        RARELY killCurrentOp.checkForInterrupt();
+        const BtreeBucket<V1>* b = bucket.btree<V1>();
+        int64_t count = 0;
+        for( int i = 0; i < b->getN(); ++i ) {
+            if ( !b->k( i ).isUnused() ) {
+                ++count;
+            }
+            count += countSubtree( b->getChildForPos( i ) );
+        }
+        count += countSubtree( b->getChildForPos( b->getN() ) );
+        return count;
+    }
+
     IntervalBtreeCursor* IntervalBtreeCursor::make( NamespaceDetails* namespaceDetails,
                                                     const IndexDetails& indexDetails,
                                                     const BSONObj& lowerBound,
@@ -188,6 +209,61 @@ namespace mongo {
                      "upper" << _upperBound.replaceFieldNames( _indexDetails.keyPattern() ) );
     }
 
+    int64_t IntervalBtreeCursor::countInterval() const {
+        return countRange( _indexDetails.head );
+    }
+
+    int64_t IntervalBtreeCursor::countRange( const DiskLoc& bucket ) const {
+        if ( bucket.isNull() ) {
+            return 0;
+        }
+        const BtreeBucket<V1>* b = bucket.btree<V1>();
+        const int n = b->getN();
+
+        // Find the first in-bounds key and the first key past the upper bound.  Key
+        // comparisons happen only in buckets like this one that a bound passes through;
+        // subtrees strictly between in-bounds keys are counted without any.
+        int lo = 0;
+        while( lo < n ) {
+            int32_t cmp = b->keyNode( lo ).key.toBson().woCompare( _lowerBound, _ordering, false );
+            if ( cmp > 0 || ( cmp == 0 && _lowerBoundInclusive ) ) {
+                break;
+            }
+            ++lo;
+        }
+        int hi = lo;
+        while( hi < n ) {
+            int32_t cmp = b->keyNode( hi ).key.toBson().woCompare( _upperBound, _ordering, false );
+            if ( cmp > 0 || ( cmp == 0 && !_upperBoundInclusive ) ) {
+                break;
+            }
+            ++hi;
+        }
+
+        int64_t count = 0;
+        for( int i = lo; i < hi; ++i ) {
+            if ( !b->k( i ).isUnused() ) {
+                ++count;
+            }
+        }
+
+        // The child between two in-bounds keys holds only in-bounds keys.
+        for( int i = lo + 1; i < hi; ++i ) {
+            count += countSubtree( b->getChildForPos( i ) );
+        }
+
+        if ( lo == hi ) {
+            // The whole interval falls within a single child's subtree.
+            count += countRange( b->getChildForPos( lo ) );
+        }
+        else {
+            // Boundary children may straddle a bound; descend with the bounds applied.
+            count += countRange( b->getChildForPos( lo ) );
+            count += countRange( b->getChildForPos( hi ) );
+        }
+        return count;
+    }
+
     BtreeKeyLocation IntervalBtreeCursor::locateKey( const BSONObj& key, bool afterKey ) {
         bool found;
         BtreeKeyLocation ret;
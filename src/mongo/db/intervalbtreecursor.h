@@ -115,6 +115,16 @@ namespace mongo {
 
         virtual ~IntervalBtreeCursor();
 
+        /**
+         * @return the number of used keys in the cursor's full interval, computed by summing
+         * per-bucket key counts and descending with key comparisons only where a bound cuts
+         * through a bucket, rather than advancing key by key.  The caller must hold the read
+         * lock for the whole call and must not yield; the cursor's position is unaffected.
+         * Do not use on a multikey index -- key counts would overcount documents with
+         * multiple in-range keys.
+         */
+        int64_t countInterval() const;
+
     private:
         IntervalBtreeCursor( NamespaceDetails* namespaceDetails,
                              const IndexDetails& indexDetails,
@@ -140,6 +150,9 @@ namespace mongo {
         /** Find the iteration end location and set _end to it. */
         void relocateEnd();
 
+        /** Count the used keys within bounds in the subtree rooted at 'bucket'. */
+        int64_t countRange( const DiskLoc& bucket ) const;
+
         const NamespaceDetails& _namespaceDetails;
         const int32_t _indexNo;
         const IndexDetails& _indexDetails;
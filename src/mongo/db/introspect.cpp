@@ -30,15 +30,22 @@
 
 #include "mongo/pch.h"
 
+#include <boost/thread/condition.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "mongo/base/counter.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_set.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/database_holder.h"
 #include "mongo/db/introspect.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/util/goodies.h"
 
@@ -78,11 +85,10 @@ namespace {
     }
 } // namespace
 
-    static void _profile(const Client& c, CurOp& currentOp, BufBuilder& profileBufBuilder) {
-        Database *db = c.database();
-        DEV verify( db );
-        const char *ns = db->getProfilingNS();
-
+    /** build the profile document for currentOp.  no locks required; everything read
+        here belongs to the operation's own client. */
+    static BSONObj _buildProfileDoc(const Client& c, CurOp& currentOp,
+                                    BufBuilder& profileBufBuilder) {
         // build object
         BSONObjBuilder b(profileBufBuilder);
 
@@ -118,26 +124,155 @@ namespace {
             p = b.done();
         }
 
-        // write: not replicated
-        // get or create the profiling collection
-        NamespaceDetails *details = getOrCreateProfileCollection(db);
-        if (details) {
-            int len = p.objsize();
-            Record *r = theDataFileMgr.fast_oplog_insert(details, ns, len);
-            memcpy(getDur().writingPtr(r->data(), len), p.objdata(), len);
-        }
+        return p;
     }
 
+    // When true, profile documents are queued and written by a background thread
+    // instead of synchronously by the profiled operation.  Off by default: async
+    // writes give up read-your-own-entry semantics (an op's profile document may
+    // appear a moment later), which is surprising for interactive diagnosis but a
+    // fine trade for leaving level 2 on in production.
+    static bool profileAsyncWrites = false;
+    static ExportedServerParameter<bool> profileAsyncWritesParam(
+            ServerParameterSet::getGlobal(), "profileAsyncWrites",
+            &profileAsyncWrites, true, true );
+
+    // entries dropped because the profile write queue was full
+    static Counter64 profilerDropsCounter;
+    static ServerStatusMetricField<Counter64> displayProfilerDrops( "profiler.drops",
+                                                                    &profilerDropsCounter );
+
+    /** Writes queued profile documents into each database's system.profile from a
+        background thread, so the operation being profiled pays for building its
+        profile document but not for the collection write or its lock acquisition.
+        The queue is bounded: when it is full (the writer can't keep up), entries
+        are dropped and counted in the profiler.drops metric -- profiling is
+        best-effort diagnostics, stalling operations for it would defeat the point.
+    */
+    class ProfileWriter : boost::noncopyable {
+        struct Entry {
+            string db;
+            BSONObj doc; // owned
+        };
+        static const size_t MaxQueuedBytes = 4 * 1024 * 1024;
+    public:
+        ProfileWriter() : _mutex("profileWriter"), _queuedBytes(0), _running(false) { }
+
+        void enqueue(const string& db, const BSONObj& doc) {
+            {
+                scoped_lock lk(_mutex);
+                if (_queuedBytes + doc.objsize() > (int)MaxQueuedBytes) {
+                    profilerDropsCounter.increment();
+                    return;
+                }
+                _queue.push_back(Entry());
+                _queue.back().db = db;
+                _queue.back().doc = doc.getOwned();
+                _queuedBytes += doc.objsize();
+                if (!_running) {
+                    _running = true;
+                    boost::thread t(boost::bind(&ProfileWriter::loop, this));
+                }
+            }
+            _hasEntries.notify_one();
+        }
+
+    private:
+        void loop() {
+            Client::initThread("profileWriter");
+            while (!inShutdown()) {
+                vector<Entry> batch;
+                {
+                    scoped_lock lk(_mutex);
+                    while (_queue.empty() && !inShutdown()) {
+                        _hasEntries.timed_wait(lk.boost(),
+                                               boost::posix_time::milliseconds(100));
+                    }
+                    batch.swap(_queue);
+                    _queuedBytes = 0;
+                }
+                _write(batch);
+            }
+            cc().shutdown();
+        }
+
+        /** one lock scope per run of entries for the same database */
+        void _write(const vector<Entry>& batch) {
+            size_t i = 0;
+            while (i < batch.size()) {
+                const string& db = batch[i].db;
+                size_t runEnd = i;
+                while (runEnd < batch.size() && batch[runEnd].db == db)
+                    runEnd++;
+
+                const string profileNS = db + ".system.profile";
+                try {
+                    Lock::DBWrite lk(profileNS);
+                    if (dbHolder()._isLoaded(db, storageGlobalParams.dbpath)) {
+                        Client::Context cx(profileNS, storageGlobalParams.dbpath);
+                        Database* database = cx.db();
+                        const char* ns = database->getProfilingNS();
+
+                        // write: not replicated
+                        // get or create the profiling collection
+                        NamespaceDetails* details = getOrCreateProfileCollection(database);
+                        for (size_t j = i; details && j < runEnd; j++) {
+                            const BSONObj& p = batch[j].doc;
+                            int len = p.objsize();
+                            Record* r = theDataFileMgr.fast_oplog_insert(details, ns, len);
+                            memcpy(getDur().writingPtr(r->data(), len), p.objdata(), len);
+                        }
+                    }
+                    else {
+                        log() << "note: not profiling because db went away - probably a "
+                              << "close on: " << profileNS << endl;
+                    }
+                }
+                catch (const AssertionException& assertionEx) {
+                    warning() << "Caught Assertion while trying to profile against "
+                              << profileNS << ": " << assertionEx.toString() << endl;
+                }
+                i = runEnd;
+            }
+        }
+
+        mongo::mutex _mutex;
+        boost::condition _hasEntries;
+        vector<Entry> _queue;
+        int _queuedBytes;
+        bool _running; // thread started (lazily, on first entry)
+    };
+
+    static ProfileWriter profileWriter;
+
     void profile(const Client& c, int op, CurOp& currentOp) {
         // initialize with 1kb to start, to avoid realloc later
         // doing this outside the dblock to improve performance
         BufBuilder profileBufBuilder(1024);
 
         try {
+            BSONObj p = _buildProfileDoc(c, currentOp, profileBufBuilder);
+
+            if (profileAsyncWrites) {
+                profileWriter.enqueue(nsToDatabase(currentOp.getNS()), p);
+                return;
+            }
+
             Lock::DBWrite lk( currentOp.getNS() );
             if (dbHolder()._isLoaded(nsToDatabase(currentOp.getNS()), storageGlobalParams.dbpath)) {
                 Client::Context cx(currentOp.getNS(), storageGlobalParams.dbpath);
-                _profile(c, currentOp, profileBufBuilder);
+                Database* database = cx.db();
+
+                // write: not replicated
+                // get or create the profiling collection
+                NamespaceDetails* details = getOrCreateProfileCollection(database);
+                if (details) {
+                    int len = p.objsize();
+                    Record* r = theDataFileMgr.fast_oplog_insert(details,
+                                                                 database->getProfilingNS(),
+                                                                 len);
+                    memcpy(getDur().writingPtr(r->data(), len), p.objdata(), len);
+                }
             }
             else {
                 mongo::log() << "note: not profiling because db went away - probably a close on: "
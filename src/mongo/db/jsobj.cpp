@@ -745,6 +745,82 @@ namespace mongo {
         return b.obj();
     }
 
+    namespace {
+        // minimum number of fields before a holder-cached index beats the linear scan
+        const int minFieldsToIndex = 16;
+
+        inline unsigned hashFieldName( const StringData& name ) {
+            // FNV-1a
+            unsigned hash = 2166136261U;
+            for ( size_t i = 0; i < name.size(); i++ ) {
+                hash ^= static_cast<unsigned char>( name[i] );
+                hash *= 16777619U;
+            }
+            return hash;
+        }
+
+        bool fieldIndexEntryLT( const BSONObj::Holder::FieldIndex::Entry& lhs,
+                                const BSONObj::Holder::FieldIndex::Entry& rhs ) {
+            if ( lhs.hash != rhs.hash )
+                return lhs.hash < rhs.hash;
+            return lhs.offset < rhs.offset;
+        }
+    }
+
+    const BSONObj::Holder::FieldIndex* BSONObj::_buildFieldIndex() const {
+        dassert( _holder );
+
+        std::vector<Holder::FieldIndex::Entry> entries;
+        BSONObjIterator i( *this );
+        while ( i.more() ) {
+            BSONElement e = i.next();
+            Holder::FieldIndex::Entry entry;
+            entry.hash = hashFieldName( StringData( e.fieldName(), e.fieldNameSize() - 1 ) );
+            entry.offset = static_cast<int>( e.rawdata() - objdata() );
+            entries.push_back( entry );
+        }
+
+        // for narrow objects we install an empty index so getField() falls back to the
+        // linear scan without re-walking the object on every call
+        const size_t n = entries.size() >= static_cast<size_t>( minFieldsToIndex ) ?
+            entries.size() : 0;
+
+        Holder::FieldIndex* index = static_cast<Holder::FieldIndex*>(
+            malloc( sizeof(Holder::FieldIndex) +
+                    ( n ? n - 1 : 0 ) * sizeof(Holder::FieldIndex::Entry) ) );
+        index->nEntries = static_cast<int>( n );
+        if ( n ) {
+            std::sort( entries.begin(), entries.end(), fieldIndexEntryLT );
+            memcpy( index->entries, &entries[0], n * sizeof(Holder::FieldIndex::Entry) );
+        }
+
+        _holder->setFieldIndex( index ); // frees 'index' if another thread won the race
+        return _holder->getFieldIndex();
+    }
+
+    BSONElement BSONObj::_getFieldUsingIndex( const StringData& name,
+                                              const Holder::FieldIndex& index ) const {
+        const unsigned hash = hashFieldName( name );
+
+        // lower_bound on hash
+        int lo = 0;
+        int hi = index.nEntries;
+        while ( lo < hi ) {
+            const int mid = ( lo + hi ) / 2;
+            if ( index.entries[mid].hash < hash )
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        for ( int i = lo; i < index.nEntries && index.entries[i].hash == hash; i++ ) {
+            BSONElement e( objdata() + index.entries[i].offset );
+            if ( name == e.fieldName() )
+                return e;
+        }
+        return BSONElement();
+    }
+
     BSONElement BSONObj::getFieldUsingIndexNames(const StringData& fieldName,
                                                  const BSONObj &indexKey) const {
         BSONObjIterator i( indexKey );
@@ -722,6 +722,41 @@ namespace mongo {
         long long retll;
         double retd;
 
+        // Fast path for plain integers, far and away the most common numeric token in
+        // bulk loads.  strtod/strtoll both rescan the input and touch errno; for a short
+        // run of decimal digits we can accumulate the value directly.  Bail out to the
+        // general path on anything unusual: '.', exponent, hex prefix (strtod accepts
+        // "0x.."), a leading '+', or enough digits to risk overflow.
+        {
+            const char* p = _input;
+            bool neg = false;
+            if (p < _input_end && *p == '-') {
+                neg = true;
+                ++p;
+            }
+            const char* digits = p;
+            long long absval = 0;
+            while (p < _input_end && *p >= '0' && *p <= '9' && p - digits < 18) {
+                absval = absval * 10 + (*p - '0');
+                ++p;
+            }
+            if (p > digits && p < _input_end &&
+                    !(*p >= '0' && *p <= '9') &&
+                    *p != '.' && *p != 'e' && *p != 'E' && *p != 'x' && *p != 'X') {
+                long long retval = neg ? -absval : absval;
+                if (retval == static_cast<int>(retval)) {
+                    MONGO_JSON_DEBUG("Type: 32 bit int");
+                    builder.append(fieldName, static_cast<int>(retval));
+                }
+                else {
+                    MONGO_JSON_DEBUG("Type: 64 bit int");
+                    builder.append(fieldName, retval);
+                }
+                _input = p;
+                return Status::OK();
+            }
+        }
+
         // reset errno to make sure that we are getting it from strtod
         errno = 0;
         retd = strtod(_input, &endptrd);
@@ -821,8 +856,27 @@ namespace mongo {
             return parseError("Unexpected end of input");
         }
         const char* q = _input;
+        // When there is a single terminal character and no allowedSet restriction (the
+        // quoted string body case, which dominates bulk loads), copy whole runs of
+        // ordinary characters with one append() rather than one push_back() per byte.
+        // Escapes, control characters and the terminal still fall through to the
+        // general handling below.
+        const char fastTerminal =
+            (allowedSet == NULL && terminalSet[0] != '\0' && terminalSet[1] == '\0') ?
+            terminalSet[0] : '\0';
         while (q < _input_end && !match(*q, terminalSet)) {
             MONGO_JSON_DEBUG("q: " << q);
+            if (fastTerminal != '\0') {
+                const char* runStart = q;
+                while (q < _input_end && *q != fastTerminal && *q != '\\' &&
+                        !(0x00 <= *q && *q <= 0x1F)) {
+                    ++q;
+                }
+                if (q != runStart) {
+                    result->append(runStart, q - runStart);
+                    continue;
+                }
+            }
             if (allowedSet != NULL) {
                 if (!match(*q, allowedSet)) {
                     _input = q;
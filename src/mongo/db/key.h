@@ -47,6 +47,7 @@ namespace mongo {
         explicit KeyBson(const BSONObj& obj) : _o(obj) { }
         int woCompare(const KeyBson& r, const Ordering &o) const;
         BSONObj toBson() const { return _o; }
+        BSONObj toBson(BufBuilder&) const { return _o; } // already bson; buffer unused
         string toString() const { return _o.toString(); }
         int dataSize() const { return _o.objsize(); }
         const char * data() const { return _o.objdata(); }
@@ -86,6 +87,10 @@ namespace mongo {
         int woCompare(const KeyV1& r, const Ordering &o) const;
         bool woEqual(const KeyV1& r) const;
         BSONObj toBson() const;
+        /** as above but unpacks into bb, which the caller can reuse across calls
+            rather than allocating a fresh buffer per conversion.  the returned
+            object points into bb and is only valid until bb is reset. */
+        BSONObj toBson(BufBuilder& bb) const;
         string toString() const { return toBson().toString(); }
 
         /** get the key data we want to store in the btree bucket */
@@ -224,6 +224,18 @@ namespace mongo {
         _otherLock = lock;
     }
 
+    WrapperForRWLock* LockState::getDbLockCached( const StringData& db ) const {
+        StringMap<WrapperForRWLock*>::const_iterator i = _otherLockCache.find( db );
+        if ( i == _otherLockCache.end() )
+            return NULL;
+        return i->second;
+    }
+
+    void LockState::cacheDbLock( const StringData& db , WrapperForRWLock* lock ) {
+        verify( lock );
+        _otherLockCache[db] = lock;
+    }
+
     void LockState::unlockedOther() {
         // we leave _otherName and _otherLock set as
         // _otherLock exists to cache a pointer
@@ -244,12 +256,20 @@ namespace mongo {
     }
 
 
+    static bool isWriteLockType( const Lock::ScopedLock* lock ) {
+        return lock && ( lock->type() == 'w' || lock->type() == 'W' );
+    }
+
     Acquiring::Acquiring( Lock::ScopedLock* lock,  LockState& ls )
         : _lock( lock ), _ls( ls ){
         _ls._lockPending = true;
+        if ( isWriteLockType( _lock ) )
+            Lock::_pendingWriters++;
     }
 
     Acquiring::~Acquiring() {
+        if ( isWriteLockType( _lock ) )
+            Lock::_pendingWriters--;
         _ls._lockPending = false;
         LockStat* stat = _ls.getRelevantLockStat();
         if ( stat && _lock )
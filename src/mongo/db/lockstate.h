@@ -32,6 +32,7 @@
 #pragma once
 
 #include "mongo/db/d_concurrency.h"
+#include "mongo/util/string_map.h"
 
 namespace mongo {
 
@@ -82,7 +83,18 @@ namespace mongo {
         int otherCount() const { return _otherCount; }
         const string& otherName() const { return _otherName; }
         WrapperForRWLock* otherLock() const { return _otherLock; }
-        
+
+        /**
+         * entries in the global db lock map are never deleted, so once this thread has
+         * looked a database up it can remember the pointer and skip the map (and the
+         * mutex guarding it) on later acquisitions.  _otherLock only remembers the most
+         * recently used database, which degenerates when a connection alternates
+         * between several.
+         * @return the cached lock for db, or NULL if this thread hasn't seen it yet
+         */
+        WrapperForRWLock* getDbLockCached( const StringData& db ) const;
+        void cacheDbLock( const StringData& db , WrapperForRWLock* lock );
+
         void enterScopedLock( Lock::ScopedLock* lock );
         Lock::ScopedLock* leaveScopedLock();
 
@@ -110,6 +122,7 @@ namespace mongo {
         int _otherCount;               //   >0 means write lock, <0 read lock - XXX change name
         string _otherName;             // which database are we locking and working with (besides local/admin) 
         WrapperForRWLock* _otherLock;  // so we don't have to check the map too often (the map has a mutex)
+        StringMap<WrapperForRWLock*> _otherLockCache; // all db locks this thread has ever used - see getDbLockCached()
 
         // for temprelease
         // for the nonrecursive case. otherwise there would be many
@@ -33,6 +33,7 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/matcher/path.h"
+#include "mongo/db/matcher/path_internal.h"
 
 namespace mongo {
 
@@ -80,9 +81,9 @@ namespace mongo {
 
         virtual ElementIterator* allocateIterator( const ElementPath* path ) const {
             if ( _iteratorUsed )
-                return new BSONElementIterator( path, _obj );
+                return new BSONElementIterator( path, _obj, &_memo );
             _iteratorUsed = true;
-            _iterator.reset( path, _obj );
+            _iterator.reset( path, _obj, &_memo );
             return &_iterator;
         }
 
@@ -99,5 +100,7 @@ namespace mongo {
         BSONObj _obj;
         mutable BSONElementIterator _iterator;
         mutable bool _iteratorUsed;
+        // shared by all iterators we allocate; they're all rooted at _obj
+        mutable PathTraversalMemo _memo;
     };
 }
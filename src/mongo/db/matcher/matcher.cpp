@@ -105,6 +105,7 @@ namespace mongo {
                  result.isOK() );
 
         _expression.reset( result.getValue() );
+        _quick.compile( _expression.get() );
     }
 
     Matcher2::Matcher2( const Matcher2 &docMatcher, const BSONObj &constrainIndexKey )
@@ -122,8 +123,17 @@ namespace mongo {
         if ( !_expression )
             return true;
 
-        if ( _indexKey.isEmpty() )
+        if ( _indexKey.isEmpty() ) {
+            // Fast path: simple filters are evaluated flat, without walking the tree.
+            // MatchDetails callers need the tree walk's elemMatchKey bookkeeping.
+            if ( _quick.isCompiled() && details == NULL ) {
+                bool canAnswer;
+                bool res = _quick.matches( doc, &canAnswer );
+                if ( canAnswer )
+                    return res;
+            }
             return _expression->matchesBSON( doc, details );
+        }
 
         if ( !doc.isEmpty() && doc.firstElement().fieldName()[0] )
             return _expression->matchesBSON( doc, details );
@@ -37,6 +37,7 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/match_details.h"
+#include "mongo/db/matcher/quick_matcher.h"
 
 namespace mongo {
 
@@ -93,6 +94,9 @@ namespace mongo {
 
         boost::scoped_ptr<MatchExpression> _expression;
 
+        // Flattened form of _expression for simple filters; empty if the tree isn't eligible.
+        QuickMatcher _quick;
+
         IndexSpliceInfo _spliceInfo;
 
         static MatchExpression* _spliceForIndex( const set<std::string>& keys,
@@ -87,10 +87,12 @@ namespace mongo {
     // ------
     BSONElementIterator::BSONElementIterator() {
         _path = NULL;
+        _memo = NULL;
     }
 
-    BSONElementIterator::BSONElementIterator( const ElementPath* path, const BSONObj& context )
-        : _path( path ), _context( context ) {
+    BSONElementIterator::BSONElementIterator( const ElementPath* path, const BSONObj& context,
+                                              PathTraversalMemo* memo )
+        : _path( path ), _context( context ), _memo( memo ) {
         _state = BEGIN;
         //log() << "path: " << path.fieldRef().dottedField() << " context: " << context << endl;
     }
@@ -98,9 +100,11 @@ namespace mongo {
     BSONElementIterator::~BSONElementIterator() {
     }
 
-    void BSONElementIterator::reset( const ElementPath* path, const BSONObj& context ) {
+    void BSONElementIterator::reset( const ElementPath* path, const BSONObj& context,
+                                     PathTraversalMemo* memo ) {
         _path = path;
         _context = context;
+        _memo = memo;
         _state = BEGIN;
         _next.reset();
 
@@ -177,7 +181,11 @@ namespace mongo {
 
         if ( _state == BEGIN ) {
             size_t idxPath = 0;
-            BSONElement e = getFieldDottedOrArray( _context, _path->fieldRef(), &idxPath );
+            // Sub-cursors are rooted at sub-objects, so only a top-level iterator can use
+            // the per-document memo.
+            BSONElement e = _memo ?
+                _memo->getFieldDottedOrArray( _context, _path->fieldRef(), &idxPath ) :
+                getFieldDottedOrArray( _context, _path->fieldRef(), &idxPath );
 
             if ( e.type() != Array ) {
                 _next.reset( e, BSONElement(), false );
@@ -40,6 +40,8 @@
 
 namespace mongo {
 
+    class PathTraversalMemo;
+
     class ElementPath {
     public:
         Status init( const StringData& path );
@@ -116,11 +118,19 @@ namespace mongo {
     class BSONElementIterator : public ElementIterator {
     public:
         BSONElementIterator();
-        BSONElementIterator( const ElementPath* path, const BSONObj& context );
+
+        /**
+         * 'memo', when provided, caches dotted-path traversals of the document rooted at
+         * 'context' so iterators sharing a path prefix don't each re-walk it.  It must
+         * outlive the iterator and only be shared between iterators over the same root.
+         */
+        BSONElementIterator( const ElementPath* path, const BSONObj& context,
+                             PathTraversalMemo* memo = NULL );
 
         virtual ~BSONElementIterator();
 
-        void reset( const ElementPath* path, const BSONObj& context );
+        void reset( const ElementPath* path, const BSONObj& context,
+                    PathTraversalMemo* memo = NULL );
 
         bool more();
         Context next();
@@ -128,6 +138,7 @@ namespace mongo {
     private:
         const ElementPath* _path;
         BSONObj _context;
+        PathTraversalMemo* _memo;
 
         enum State { BEGIN, IN_ARRAY, DONE } _state;
         Context _next;
@@ -83,5 +83,73 @@ namespace mongo {
         return res;
     }
 
+    BSONElement PathTraversalMemo::getFieldDottedOrArray( const BSONObj& doc,
+                                                          const FieldRef& path,
+                                                          size_t* idxPath ) {
+        if ( path.numParts() == 0 )
+            return doc.getField( "" );
+
+        BSONObj curr = doc;
+        size_t partNum = 0;
+        std::string prefix;
+
+        // Resume from the deepest prefix of 'path' we've already walked for this document.
+        // The map only holds prefixes that resolved to an object, so a hit is always safe
+        // to descend into.
+        while ( partNum + 1 < path.numParts() ) {
+            StringData part = path.getPart( partNum );
+            std::string next = prefix;
+            if ( !next.empty() )
+                next.push_back( '.' );
+            next.append( part.rawData(), part.size() );
+
+            PrefixMap::const_iterator it = _prefixes.find( next );
+            if ( it == _prefixes.end() )
+                break;
+
+            curr = it->second;
+            prefix.swap( next );
+            ++partNum;
+        }
+
+        BSONElement res;
+        bool stop = false;
+        while ( partNum < path.numParts() && !stop ) {
+
+            StringData part = path.getPart( partNum );
+            res = curr.getField( part );
+
+            switch ( res.type() ) {
+
+            case EOO:
+                stop = true;
+                break;
+
+            case Object:
+                curr = res.Obj();
+                if ( !prefix.empty() )
+                    prefix.push_back( '.' );
+                prefix.append( part.rawData(), part.size() );
+                _prefixes[prefix] = curr;
+                ++partNum;
+                break;
+
+            case Array:
+                stop = true;
+                break;
+
+            default:
+                if ( partNum+1 < path.numParts() ) {
+                    res = BSONElement();
+                }
+                stop = true;
+
+            }
+        }
+
+        *idxPath = partNum;
+        return res;
+    }
+
 
 }  // namespace mongo
@@ -30,6 +30,9 @@
 
 #pragma once
 
+#include <map>
+#include <string>
+
 #include "mongo/base/string_data.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/jsobj.h"
@@ -45,4 +48,26 @@ namespace mongo {
                                        const FieldRef& path,
                                        size_t* idxPath );
 
+    /**
+     * Per-document memo for getFieldDottedOrArray.  A MatchExpression tree with several
+     * predicates under a common dotted prefix ( "a.b.c.x", "a.b.c.y", ... ) otherwise
+     * re-walks the document from the root once per predicate.  The memo remembers every
+     * object subtree reached along any walked path, so a shared prefix is traversed once
+     * per document and later walks resume from the deepest cached point.
+     *
+     * Only valid for walks that start from the same document root; a MatchableDocument
+     * owns one and hands it to the iterators it allocates.
+     */
+    class PathTraversalMemo {
+    public:
+        BSONElement getFieldDottedOrArray( const BSONObj& doc,
+                                           const FieldRef& path,
+                                           size_t* idxPath );
+
+    private:
+        // dotted prefix -> object subtree reached by walking it from the root
+        typedef std::map<std::string,BSONObj> PrefixMap;
+        PrefixMap _prefixes;
+    };
+
 }  // namespace mongo
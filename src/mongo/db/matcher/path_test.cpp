@@ -33,6 +33,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/path.h"
+#include "mongo/db/matcher/path_internal.h"
 
 namespace mongo {
 
@@ -322,4 +323,42 @@ namespace mongo {
 
     }
 
+    TEST( PathTraversalMemo, SharedPrefix1 ) {
+        BSONObj doc = BSON( "a" << BSON( "b" << BSON( "c" << BSON( "x" << 1 << "y" << 2 ) ) ) );
+
+        PathTraversalMemo memo;
+
+        ElementPath px;
+        ASSERT( px.init( "a.b.c.x" ).isOK() );
+        BSONElementIterator cx( &px, doc, &memo );
+        ASSERT( cx.more() );
+        ASSERT_EQUALS( 1, cx.next().element().numberInt() );
+        ASSERT( !cx.more() );
+
+        // the second walk resumes from the memoized "a.b.c" subtree
+        ElementPath py;
+        ASSERT( py.init( "a.b.c.y" ).isOK() );
+        BSONElementIterator cy( &py, doc, &memo );
+        ASSERT( cy.more() );
+        ASSERT_EQUALS( 2, cy.next().element().numberInt() );
+        ASSERT( !cy.more() );
+    }
+
+    TEST( PathTraversalMemo, ArrayUnchanged1 ) {
+        // an array ends the memoized part of the walk exactly as it does without a memo
+        BSONObj doc = BSON( "a" << BSON( "b" << BSON_ARRAY( BSON( "c" << 5 ) << BSON( "c" << 6 ) ) ) );
+
+        PathTraversalMemo memo;
+
+        ElementPath p;
+        ASSERT( p.init( "a.b.c" ).isOK() );
+        BSONElementIterator cursor( &p, doc, &memo );
+
+        ASSERT( cursor.more() );
+        ASSERT_EQUALS( 5, cursor.next().element().numberInt() );
+        ASSERT( cursor.more() );
+        ASSERT_EQUALS( 6, cursor.next().element().numberInt() );
+        ASSERT( !cursor.more() );
+    }
+
 }
@@ -0,0 +1,176 @@
+// quick_matcher.cpp
+
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/matcher/quick_matcher.h"
+
+#include <cstring>
+
+#include "mongo/bson/bsonobjiterator.h"
+#include "mongo/db/matcher/expression_leaf.h"
+
+namespace mongo {
+
+    bool QuickMatcher::compile( const MatchExpression* expr ) {
+        _preds.clear();
+        _compiled = false;
+
+        if ( !expr )
+            return false;
+
+        if ( expr->matchType() == MatchExpression::AND ) {
+            if ( expr->numChildren() == 0 ||
+                 expr->numChildren() > static_cast<size_t>( MaxPredicates ) )
+                return false;
+            for ( size_t i = 0; i < expr->numChildren(); i++ ) {
+                if ( !_addPredicate( expr->getChild( i ) ) ) {
+                    _preds.clear();
+                    return false;
+                }
+            }
+        }
+        else if ( !_addPredicate( expr ) ) {
+            _preds.clear();
+            return false;
+        }
+
+        _compiled = true;
+        return true;
+    }
+
+    bool QuickMatcher::_addPredicate( const MatchExpression* expr ) {
+        switch ( expr->matchType() ) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+            break;
+        default:
+            return false;
+        }
+
+        const ComparisonMatchExpression* cmp =
+            static_cast<const ComparisonMatchExpression*>( expr );
+
+        // Dotted paths need the tree matcher's path traversal.
+        if ( cmp->path().toString().find( '.' ) != std::string::npos )
+            return false;
+
+        const BSONElement& rhs = cmp->getRHS();
+        switch ( rhs.type() ) {
+        case NumberDouble:
+        case NumberInt:
+        case NumberLong:
+        case String:
+        case Bool:
+        case Date:
+        case Timestamp:
+        case jstOID:
+            break;
+        default:
+            // null (missing fields match), MinKey/MaxKey (cross type brackets), arrays,
+            // objects, regexes, etc. keep their tree matcher behavior.
+            return false;
+        }
+
+        Predicate pred;
+        pred.op = expr->matchType();
+        pred.fieldName = cmp->path().toString();
+        pred.rhs = rhs;
+        pred.rhsCanonicalType = rhs.canonicalType();
+        _preds.push_back( pred );
+        return true;
+    }
+
+    // Mirrors ComparisonMatchExpression::matchesSingleElement(), minus the special cases
+    // (null, MinKey and MaxKey operands) that compile() rejects.
+    bool QuickMatcher::_evaluate( const Predicate& pred, const BSONElement& e ) {
+        if ( e.canonicalType() != pred.rhsCanonicalType )
+            return false;
+
+        const int x = compareElementValues( e, pred.rhs );
+        switch ( pred.op ) {
+        case MatchExpression::LT:
+            return x < 0;
+        case MatchExpression::LTE:
+            return x <= 0;
+        case MatchExpression::EQ:
+            return x == 0;
+        case MatchExpression::GT:
+            return x > 0;
+        default:
+            dassert( pred.op == MatchExpression::GTE );
+            return x >= 0;
+        }
+    }
+
+    bool QuickMatcher::matches( const BSONObj& doc, bool* canAnswer ) const {
+        dassert( _compiled );
+        *canAnswer = true;
+
+        const unsigned all = ( _preds.size() == static_cast<size_t>( MaxPredicates ) )
+                             ? 0xffffffffu
+                             : ( 1u << _preds.size() ) - 1;
+
+        // Only the first occurrence of a field counts, as with the tree matcher's path
+        // lookup, so track which predicates have seen their field.
+        unsigned seen = 0;
+
+        BSONObjIterator it( doc );
+        while ( it.more() && seen != all ) {
+            BSONElement e = it.next();
+            const char* name = e.fieldName();
+
+            // Linear scan; eligible filters have only a handful of predicates.  No break on
+            // a hit - several predicates may test the same field ({a: {$gt: 1, $lt: 5}}).
+            for ( size_t i = 0; i < _preds.size(); i++ ) {
+                if ( seen & ( 1u << i ) )
+                    continue;
+                if ( strcmp( name, _preds[i].fieldName.c_str() ) != 0 )
+                    continue;
+
+                // Array values match if any element matches; hand those back to the tree.
+                if ( e.type() == Array ) {
+                    *canAnswer = false;
+                    return false;
+                }
+
+                seen |= 1u << i;
+                if ( !_evaluate( _preds[i], e ) )
+                    return false;
+            }
+        }
+
+        // Predicates whose fields are missing can't be satisfied (null operands, where a
+        // missing field would match, are rejected at compile time).
+        return seen == all;
+    }
+
+}
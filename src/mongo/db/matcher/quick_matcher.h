@@ -0,0 +1,94 @@
+// quick_matcher.h
+
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+    /**
+     * A QuickMatcher is a flattened form of a simple MatchExpression tree: a linear array of
+     * comparison predicates over top-level fields, evaluated in one pass over a document's
+     * elements with no virtual dispatch and no per-leaf path iterator allocation.
+     *
+     * compile() accepts a tree that is a single comparison, or an AND of comparisons
+     * (EQ/LT/LTE/GT/GTE), where every path is a non-dotted top-level field and every
+     * right-hand side is a plain scalar.  Anything else -- $where, $elemMatch, $in, dotted
+     * paths, null/MinKey/MaxKey/array/object operands -- is rejected and the caller keeps
+     * using the tree matcher.
+     *
+     * Array-valued fields get implicit per-element traversal from the tree matcher, which a
+     * single flat pass cannot reproduce; matches() reports such documents through *canAnswer
+     * and the caller must re-run the tree matcher on them.
+     */
+    class QuickMatcher {
+    public:
+        QuickMatcher() : _compiled( false ) {}
+
+        /**
+         * Attempts to flatten 'expr'.  The expression is not owned and must outlive this
+         * matcher; we keep BSONElement references into its pattern.  Returns true and enables
+         * matches() iff the tree is eligible.
+         */
+        bool compile( const MatchExpression* expr );
+
+        bool isCompiled() const { return _compiled; }
+
+        /**
+         * Valid only when isCompiled().  Sets *canAnswer to false (return value meaningless)
+         * when the document needs the tree matcher; otherwise sets it to true and returns the
+         * match result.
+         */
+        bool matches( const BSONObj& doc, bool* canAnswer ) const;
+
+    private:
+        struct Predicate {
+            MatchExpression::MatchType op; // EQ, LT, LTE, GT or GTE
+            std::string fieldName;
+            BSONElement rhs;               // into the source expression's pattern
+            int rhsCanonicalType;
+        };
+
+        // satisfied-predicate accounting below uses a 32-bit mask
+        enum { MaxPredicates = 32 };
+
+        bool _addPredicate( const MatchExpression* expr );
+        static bool _evaluate( const Predicate& pred, const BSONElement& e );
+
+        std::vector<Predicate> _preds;
+        bool _compiled;
+    };
+
+}
@@ -0,0 +1,150 @@
+// quick_matcher_test.cpp
+
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/** Unit tests for QuickMatcher, the flattened form of simple MatchExpression trees. */
+
+#include "mongo/unittest/unittest.h"
+
+#include <boost/scoped_ptr.hpp>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/matcher/quick_matcher.h"
+
+namespace mongo {
+
+    namespace {
+        MatchExpression* parse( const BSONObj& pattern ) {
+            StatusWithMatchExpression result = MatchExpressionParser::parse( pattern );
+            ASSERT_TRUE( result.isOK() );
+            return result.getValue();
+        }
+
+        // The flat and tree matchers must agree on every document they can both answer.
+        void checkAgainstTree( const QuickMatcher& quick,
+                               const MatchExpression* tree,
+                               const BSONObj& doc ) {
+            bool canAnswer;
+            bool res = quick.matches( doc, &canAnswer );
+            ASSERT_TRUE( canAnswer );
+            ASSERT_EQUALS( res, tree->matchesBSON( doc ) );
+        }
+    }
+
+    TEST( QuickMatcherTest, CompileEligibility ) {
+        QuickMatcher quick;
+
+        boost::scoped_ptr<MatchExpression> e( parse( fromjson( "{ x : 5 }" ) ) );
+        ASSERT_TRUE( quick.compile( e.get() ) );
+
+        e.reset( parse( fromjson( "{ x : { $gt : 1, $lt : 5 }, y : 'a' }" ) ) );
+        ASSERT_TRUE( quick.compile( e.get() ) );
+
+        // Dotted path
+        e.reset( parse( fromjson( "{ 'x.y' : 5 }" ) ) );
+        ASSERT_FALSE( quick.compile( e.get() ) );
+        ASSERT_FALSE( quick.isCompiled() );
+
+        // Null operand (missing fields match null)
+        e.reset( parse( fromjson( "{ x : null }" ) ) );
+        ASSERT_FALSE( quick.compile( e.get() ) );
+
+        // Array operand
+        e.reset( parse( fromjson( "{ x : [1, 2] }" ) ) );
+        ASSERT_FALSE( quick.compile( e.get() ) );
+
+        // Non-comparison operator
+        e.reset( parse( fromjson( "{ x : { $in : [1, 2] } }" ) ) );
+        ASSERT_FALSE( quick.compile( e.get() ) );
+
+        // $or
+        e.reset( parse( fromjson( "{ $or : [ { x : 1 }, { y : 2 } ] }" ) ) );
+        ASSERT_FALSE( quick.compile( e.get() ) );
+    }
+
+    TEST( QuickMatcherTest, MatchesEquality ) {
+        boost::scoped_ptr<MatchExpression> e( parse( fromjson( "{ x : 5, y : 'a' }" ) ) );
+        QuickMatcher quick;
+        ASSERT_TRUE( quick.compile( e.get() ) );
+
+        checkAgainstTree( quick, e.get(), fromjson( "{ x : 5, y : 'a' }" ) );
+        checkAgainstTree( quick, e.get(), fromjson( "{ y : 'a', x : 5, z : 1 }" ) );
+        checkAgainstTree( quick, e.get(), fromjson( "{ x : 5, y : 'b' }" ) );
+        checkAgainstTree( quick, e.get(), fromjson( "{ x : 6, y : 'a' }" ) );
+        checkAgainstTree( quick, e.get(), fromjson( "{ x : 5 }" ) ); // missing y
+        checkAgainstTree( quick, e.get(), fromjson( "{}" ) );
+        checkAgainstTree( quick, e.get(), fromjson( "{ x : '5', y : 'a' }" ) ); // wrong type
+        checkAgainstTree( quick, e.get(), fromjson( "{ x : null, y : 'a' }" ) );
+    }
+
+    TEST( QuickMatcherTest, MatchesRange ) {
+        boost::scoped_ptr<MatchExpression> e( parse( fromjson( "{ x : { $gte : 2, $lt : 5 } }" ) ) );
+        QuickMatcher quick;
+        ASSERT_TRUE( quick.compile( e.get() ) );
+
+        checkAgainstTree( quick, e.get(), fromjson( "{ x : 2 }" ) );
+        checkAgainstTree( quick, e.get(), fromjson( "{ x : 4.5 }" ) );
+        checkAgainstTree( quick, e.get(), fromjson( "{ x : 5 }" ) );
+        checkAgainstTree( quick, e.get(), fromjson( "{ x : 1 }" ) );
+        checkAgainstTree( quick, e.get(), fromjson( "{ x : 'a' }" ) ); // type bracket
+        checkAgainstTree( quick, e.get(), fromjson( "{}" ) );
+
+        // Mixed numeric types compare by value
+        checkAgainstTree( quick, e.get(), BSON( "x" << 3LL ) );
+        checkAgainstTree( quick, e.get(), BSON( "x" << 2.0 ) );
+    }
+
+    TEST( QuickMatcherTest, ArrayFieldNeedsTree ) {
+        boost::scoped_ptr<MatchExpression> e( parse( fromjson( "{ x : 5 }" ) ) );
+        QuickMatcher quick;
+        ASSERT_TRUE( quick.compile( e.get() ) );
+
+        bool canAnswer;
+        quick.matches( fromjson( "{ x : [1, 5] }" ), &canAnswer );
+        ASSERT_FALSE( canAnswer );
+
+        // An array in an untested field is fine
+        checkAgainstTree( quick, e.get(), fromjson( "{ x : 5, z : [1, 2] }" ) );
+    }
+
+    TEST( QuickMatcherTest, FirstOccurrenceWins ) {
+        boost::scoped_ptr<MatchExpression> e( parse( fromjson( "{ x : 5 }" ) ) );
+        QuickMatcher quick;
+        ASSERT_TRUE( quick.compile( e.get() ) );
+
+        // Duplicate field names: only the first is consulted, as with the tree's path lookup
+        BSONObjBuilder b;
+        b.append( "x", 4 );
+        b.append( "x", 5 );
+        checkAgainstTree( quick, e.get(), b.obj() );
+    }
+
+}
@@ -165,6 +165,12 @@ namespace mongo {
         if (!ret.isOK()) {
             return ret;
         }
+        ret = general_options.addOption(OD("ephemeral", "ephemeral", moe::Switch,
+                    "keep all data in memory only, never flushing to disk; the dataset "
+                    "does not survive a restart (start with an empty dbpath)", true));
+        if (!ret.isOK()) {
+            return ret;
+        }
         ret = general_options.addOption(OD("noscripting", "noscripting", moe::Switch,
                     "disable scripting engine", true));
         if (!ret.isOK()) {
@@ -506,6 +512,19 @@ namespace mongo {
             storageGlobalParams.dur = true;
         }
 
+        if (params.count("ephemeral")) {
+            if (params.count("dur") || params.count("journal")) {
+                std::cerr << "Can't specify both --journal and --ephemeral options." << std::endl;
+                ::_exit(EXIT_BADOPTIONS);
+            }
+            // in-memory only: no journal, and the (never written) backing files should
+            // be as small as the allocator permits
+            storageGlobalParams.ephemeral = true;
+            storageGlobalParams.dur = false;
+            storageGlobalParams.prealloc = false;
+            storageGlobalParams.smallfiles = true;
+        }
+
         if (params.count("durOptions")) {
             storageGlobalParams.durOptions = params["durOptions"].as<int>();
         }
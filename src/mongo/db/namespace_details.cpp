@@ -61,6 +61,14 @@ namespace mongo {
         0x200000, 0x400000, 0x1000000,
      };
 
+    /* fine-grained size classes (Flag_UseFineGrainedSizes): records up to
+       MaxFineGrainedSize are quantized to FineGrainedQuantum byte steps, so a
+       collection of small documents settles into a handful of uniform classes
+       and the freelists for them hit on the first link.
+    */
+    const int FineGrainedQuantum = 16;
+    const int MaxFineGrainedSize = 1024;
+
     NamespaceDetails::NamespaceDetails( const DiskLoc &loc, bool capped ) {
         /* be sure to initialize new fields here -- doesn't default to zeroes the way we use it */
         _firstExtent = _lastExtent = _capExtent = loc;
@@ -172,6 +180,11 @@ namespace mongo {
         return quantizedSpace;
     }
 
+    int NamespaceDetails::quantizeFineGrainedAllocationSpace(int allocSize) {
+        verify( allocSize <= MaxFineGrainedSize );
+        return ( allocSize + FineGrainedQuantum - 1 ) & ~( FineGrainedQuantum - 1 );
+    }
+
     int NamespaceDetails::quantizePowerOf2AllocationSpace(int allocSize) {
         int allocationSize = bucketSizes[ bucket( allocSize ) ];
         if ( allocationSize == bucketSizes[MaxBucket] ) {
@@ -231,8 +244,11 @@ namespace mongo {
         if ( !isCapped() && NamespaceString::normal( ns ) ) {
             // we quantize here so that it only impacts newly sized records
             // this prevents oddities with older records and space re-use SERVER-8435
-            lenToAlloc = std::min( r->lengthWithHeaders(),
-                                   NamespaceDetails::quantizeAllocationSpace( lenToAlloc ) );
+            int quantized =
+                ( isUserFlagSet( Flag_UseFineGrainedSizes ) && lenToAlloc <= MaxFineGrainedSize ) ?
+                    quantizeFineGrainedAllocationSpace( lenToAlloc ) :
+                    quantizeAllocationSpace( lenToAlloc );
+            lenToAlloc = std::min( r->lengthWithHeaders(), quantized );
             left = regionlen - lenToAlloc;
 
             if ( left < 24 ) {
@@ -303,8 +319,11 @@ namespace mongo {
                 bestmatchlen = r->lengthWithHeaders();
                 bestmatch = cur;
                 bestprev = prev;
-                if (r->lengthWithHeaders() == len)
-                    // exact match, stop searching
+                if (r->lengthWithHeaders() < len + 24)
+                    // the remainder is too small to split off (see alloc()), so
+                    // this is as good as an exact match; stop searching.  with
+                    // quantized sizes this is the common case and makes a hit on
+                    // a uniform freelist O(1).
                     break;
             }
             if ( bestmatchlen < 0x7fffffff && --extra <= 0 )
@@ -356,6 +375,37 @@ namespace mongo {
         }
     }
 
+    void NamespaceDetails::appendDeletedRecordStats( BSONObjBuilder& result, int scale ) const {
+        verify( !isCapped() ); // capped deleted list slots mean something else
+        long long totalCount = 0;
+        long long totalSize = 0;
+        // size class -> (count, bytes).  small records get their 16 byte class,
+        // everything else its bucket size.
+        map< int, pair<long long, long long> > classes;
+        for ( int i = 0; i < Buckets; i++ ) {
+            for ( DiskLoc dl = _deletedList[i]; !dl.isNull(); dl = dl.drec()->nextDeleted() ) {
+                int len = dl.drec()->lengthWithHeaders();
+                int sizeClass = len <= MaxFineGrainedSize ?
+                    ( len & ~( FineGrainedQuantum - 1 ) ) : bucketSizes[ bucket( len ) ];
+                classes[sizeClass].first++;
+                classes[sizeClass].second += len;
+                totalCount++;
+                totalSize += len;
+            }
+        }
+        result.appendNumber( "count" , totalCount );
+        result.appendNumber( "size" , totalSize / scale );
+        BSONObjBuilder byClass( result.subobjStart( "sizeClasses" ) );
+        for ( map< int, pair<long long, long long> >::const_iterator i = classes.begin();
+                i != classes.end(); ++i ) {
+            BSONObjBuilder b( byClass.subobjStart( BSONObjBuilder::numStr( i->first ) ) );
+            b.appendNumber( "count" , i->second.first );
+            b.appendNumber( "size" , i->second.second / scale );
+            b.done();
+        }
+        byClass.done();
+    }
+
     DiskLoc NamespaceDetails::firstRecord( const DiskLoc &startExtent ) const {
         for (DiskLoc i = startExtent.isNull() ? _firstExtent : startExtent;
                 !i.isNull(); i = i.ext()->xnext ) {
@@ -580,9 +630,10 @@ namespace mongo {
     NamespaceDetailsTransient::DMap NamespaceDetailsTransient::_nsdMap;
 
     void NamespaceDetailsTransient::reset() {
-        Lock::assertWriteLocked(_ns); 
+        Lock::assertWriteLocked(_ns);
         clearQueryCache();
         _keysComputed = false;
+        _storageSizeValid = false;
     }
 
     NamespaceDetailsTransient::CMap& NamespaceDetailsTransient::get_cmap_inlock(const string& ns) {
@@ -609,12 +660,42 @@ namespace mongo {
     // note with repair there could be two databases with the same ns name.
     // that is NOT handled here yet!  TODO
     // repair may not use nsdt though not sure.  anyway, requires work.
-    NamespaceDetailsTransient::NamespaceDetailsTransient(Database *db, const string& ns) : 
-        _ns(ns), _keysComputed(false), _qcWriteCount() 
+    NamespaceDetailsTransient::NamespaceDetailsTransient(Database *db, const string& ns) :
+        _ns(ns), _storageSizeValid(false), _storageSizeLastExtentSize(),
+        _cachedStorageSize(), _cachedNumExtents(), _keysComputed(false), _qcWriteCount()
     {
         dassert(db);
     }
 
+    long long NamespaceDetailsTransient::storageSize( const NamespaceDetails* d, int* numExtents ) {
+        if ( _storageSizeValid &&
+             d->firstExtent() == _storageSizeFirstExtent &&
+             d->lastExtent() == _storageSizeLastExtent &&
+             d->lastExtentSize() == _storageSizeLastExtentSize ) {
+            if ( numExtents )
+                *numExtents = _cachedNumExtents;
+            return _cachedStorageSize;
+        }
+
+        // chain changed (or first use): do the exact walk and remember it.  clear the
+        // flag first so a concurrent reader never sees a half-updated cache; two
+        // readers racing here compute identical values since extents can't change
+        // under the read lock.
+        _storageSizeValid = false;
+        int n;
+        long long total = d->storageSize( &n );
+        _storageSizeFirstExtent = d->firstExtent();
+        _storageSizeLastExtent = d->lastExtent();
+        _storageSizeLastExtentSize = d->lastExtentSize();
+        _cachedStorageSize = total;
+        _cachedNumExtents = n;
+        _storageSizeValid = true;
+
+        if ( numExtents )
+            *numExtents = n;
+        return total;
+    }
+
     NamespaceDetailsTransient::~NamespaceDetailsTransient() { 
     }
     
@@ -789,12 +870,23 @@ namespace mongo {
         if ( isCapped() )
             return minRecordSize;
 
+        // in ephemeral mode a record move costs no disk I/O, so skip growth padding
+        // and quantization entirely and keep the working set dense
+        if ( storageGlobalParams.ephemeral )
+            return minRecordSize;
+
         if ( _paddingFactor == 0 ) {
             warning() << "implicit updgrade of paddingFactor of very old collection" << endl;
             setPaddingFactor(1.0);
         }
         verify( _paddingFactor >= 1 );
 
+        if ( isUserFlagSet( Flag_UseFineGrainedSizes ) && minRecordSize <= MaxFineGrainedSize ) {
+            // 16 byte size classes for small records; larger ones fall through to
+            // the collection's coarse policy below
+            return quantizeFineGrainedAllocationSpace( minRecordSize );
+        }
+
         if ( isUserFlagSet( Flag_UsePowerOf2Sizes ) ) {
             // quantize to the nearest bucketSize (or nearest 1mb boundary for large sizes).
             return quantizePowerOf2AllocationSpace(minRecordSize);
@@ -846,6 +938,42 @@ namespace mongo {
         _removeIndex( idxNumber );
     }
 
+    void NamespaceDetails::removeIndexes( const vector<int>& indexNumbers ) {
+        if ( indexNumbers.empty() )
+            return;
+        verify( _indexBuildsInProgress == 0 );
+
+        aboutToDeleteAnIndex();
+
+        set<int> doomed( indexNumbers.begin(), indexNumbers.end() );
+        verify( (int)doomed.size() == (int)indexNumbers.size() );
+        verify( *doomed.begin() >= 0 && *doomed.rbegin() < _nIndexes );
+
+        NamespaceDetails* d = writingWithExtra();
+
+        // one compaction pass: kill the doomed indexes and slide the survivors
+        // (and their multikey bits) down over them
+        int kept = 0;
+        unsigned long long keptMultiKeyBits = 0;
+        for ( int i = 0; i < _nIndexes; i++ ) {
+            if ( doomed.count( i ) ) {
+                string indexNamespace = d->idx(i).indexNamespace();
+                d->idx(i).kill_idx();
+                cc().database()->_clearCollectionCache( indexNamespace );
+                continue;
+            }
+            if ( d->_multiKeyIndexBits & ( ((unsigned long long)1) << i ) )
+                keptMultiKeyBits |= ((unsigned long long)1) << kept;
+            if ( kept != i )
+                d->idx(kept) = d->idx(i);
+            kept++;
+        }
+        for ( int i = kept; i < _nIndexes; i++ )
+            d->idx(i) = IndexDetails();
+        d->_multiKeyIndexBits = keptMultiKeyBits;
+        d->_nIndexes = kept;
+    }
+
     void NamespaceDetails::_removeIndex( int idxNumber ) {
 
         // TODO: don't do this whole thing, do it piece meal for readability
@@ -253,7 +253,27 @@ namespace mongo {
         };
 
         enum UserFlags {
-            Flag_UsePowerOf2Sizes = 1 << 0
+            Flag_UsePowerOf2Sizes = 1 << 0,
+
+            // quantize records up to 1kb to 16 byte size classes instead of the
+            // collection's coarse policy; bounds per-record waste to 15 bytes where
+            // rounding to the next power of two wastes up to ~50%.  set via
+            // collMod { useFineGrainedSizes : true }.
+            Flag_UseFineGrainedSizes = 1 << 1,
+
+            // collection is read-only: user inserts, updates and deletes are rejected,
+            // so cold data can sit densely packed (freeze drops the padding factor to
+            // 1.0; run compact afterwards to rewrite existing records back to back)
+            // without ever fragmenting again.  queries are unaffected.  set and
+            // cleared via collMod { frozen : true/false }.
+            Flag_Frozen = 1 << 2,
+
+            // declared access pattern for this namespace's extents, applied as
+            // madvise() when the database opens, after a compact, and live via the
+            // storageHints command.  default kernel readahead suits neither
+            // btrees (random) nor the oplog (sequential).  at most one is set.
+            Flag_AdviseRandom = 1 << 3,
+            Flag_AdviseSequential = 1 << 4
         };
 
         IndexDetails& idx(int idxNo, bool missingExpected = false );
@@ -374,6 +394,14 @@ namespace mongo {
 
         void removeIndex( int idx );
 
+        /**
+         * batch form of removeIndex: kills each listed index and compacts the
+         * IndexDetails array and multikey bits in one journalled pass over the
+         * metadata instead of once per index.  indexNumbers must be distinct
+         * completed-index numbers; requires no index builds in progress.
+         */
+        void removeIndexes( const vector<int>& indexNumbers );
+
         /**
          * removes things beteen getCompletedIndexCount() and getTotalIndexCount()
          * this should only be used for crash recovery
@@ -460,6 +488,20 @@ namespace mongo {
          * Quantize 'allocSize' to the nearest bucketSize (or nearest 1mb boundary for large sizes).
          */
         static int quantizePowerOf2AllocationSpace(int allocSize);
+
+        /**
+         * Quantize 'allocSize' (which must be <= 1kb) up to its 16 byte size class.
+         * Used for small records in Flag_UseFineGrainedSizes collections.
+         */
+        static int quantizeFineGrainedAllocationSpace(int allocSize);
+
+        /**
+         * appends count/size totals and a per size class breakdown of the deleted
+         * record lists.  walks every freelist entry, so this is for diagnostics
+         * (collStats { verbose : true }).  not valid for capped collections, whose
+         * deleted list slots have different meanings.
+         */
+        void appendDeletedRecordStats( BSONObjBuilder& result, int scale ) const;
         
         /* predetermine location of the next alloc without actually doing it. 
            if cannot predetermine returns null (so still call alloc() then)
@@ -511,6 +553,7 @@ namespace mongo {
         void maybeComplain( const char *ns, int len ) const;
         DiskLoc __stdAlloc(int len, bool willBeAt);
         void compact(); // combine adjacent deleted records
+        void cappedCoalesce(); // O(1) merge of the record cappedAlloc just freed; falls back on compact()
         friend class NamespaceIndex;
         struct ExtraOld {
             // note we could use this field for more chaining later, so don't waste it:
@@ -592,6 +635,25 @@ namespace mongo {
             return _indexedPaths;
         }
 
+        /* storage size cache ---------------------------------------------------- */
+        /* extents only come and go under the write lock, so a previous extent chain
+           walk stays valid while the chain's endpoints are unchanged.  monitoring
+           tends to hit collStats/dbStats every few seconds; this makes those O(1)
+           instead of a pointer chase over every (possibly paged-out) extent.
+        */
+    private:
+        bool _storageSizeValid;
+        DiskLoc _storageSizeFirstExtent;  // chain endpoints at the time of the walk
+        DiskLoc _storageSizeLastExtent;
+        int _storageSizeLastExtentSize;
+        long long _cachedStorageSize;
+        int _cachedNumExtents;
+    public:
+        /** storageSize()/numExtents without walking the extent chain when a previous
+            walk is still valid; falls back to (and remembers) the exact walk.
+        */
+        long long storageSize( const NamespaceDetails* d, int* numExtents = 0 );
+
         /* query cache (for query optimizer) ------------------------------------- */
     private:
         int _qcWriteCount;
@@ -0,0 +1,114 @@
+// @file op_memory.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/db/op_memory.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    namespace opmem {
+
+        // budgets in megabytes; 0 disables the check
+        MONGO_EXPORT_SERVER_PARAMETER( opMemoryLimitMB, int, 0 );
+        MONGO_EXPORT_SERVER_PARAMETER( totalOpMemoryLimitMB, int, 0 );
+
+        long long (*noteOpCharge)( long long bytes ) = NULL;
+        void (*noteOpRelease)( long long bytes ) = NULL;
+
+        namespace {
+
+            const char* const classNames[NumClasses] = { "workingSet", "sort", "group" };
+
+            AtomicInt64 classBytes[NumClasses];
+            AtomicInt64 totalBytes;
+            AtomicInt64 peakBytes; // highest totalBytes seen; updated racily, fine for reporting
+
+        }
+
+        void charge( Class cls, long long bytes ) {
+            verify( cls >= 0 && cls < NumClasses );
+            if ( bytes <= 0 )
+                return;
+
+            classBytes[cls].addAndFetch( bytes );
+            const long long totalNow = totalBytes.addAndFetch( bytes );
+            if ( totalNow > peakBytes.load() )
+                peakBytes.store( totalNow );
+
+            long long opNow = bytes;
+            if ( noteOpCharge )
+                opNow = noteOpCharge( bytes );
+
+            const long long opLimit =
+                static_cast<long long>( opMemoryLimitMB ) * 1024 * 1024;
+            if ( opLimit > 0 && opNow > opLimit ) {
+                uasserted( 17545, mongoutils::str::stream()
+                           << "operation exceeded its memory limit of " << opMemoryLimitMB
+                           << "MB (charged " << opNow / ( 1024 * 1024 ) << "MB)" );
+            }
+
+            const long long totalLimit =
+                static_cast<long long>( totalOpMemoryLimitMB ) * 1024 * 1024;
+            if ( totalLimit > 0 && totalNow > totalLimit ) {
+                uasserted( 17546, mongoutils::str::stream()
+                           << "operations exceeded the server-wide memory limit of "
+                           << totalOpMemoryLimitMB << "MB (charged "
+                           << totalNow / ( 1024 * 1024 ) << "MB)" );
+            }
+        }
+
+        void release( Class cls, long long bytes ) {
+            verify( cls >= 0 && cls < NumClasses );
+            if ( bytes <= 0 )
+                return;
+            classBytes[cls].subtractAndFetch( bytes );
+            totalBytes.subtractAndFetch( bytes );
+            if ( noteOpRelease )
+                noteOpRelease( bytes );
+        }
+
+        void appendStats( BSONObjBuilder& b ) {
+            b.appendNumber( "current", totalBytes.load() );
+            b.appendNumber( "peak", peakBytes.load() );
+            BSONObjBuilder classes( b.subobjStart( "classes" ) );
+            for ( int i = 0; i < NumClasses; i++ ) {
+                classes.appendNumber( classNames[i], classBytes[i].load() );
+            }
+            classes.done();
+        }
+
+    }  // namespace opmem
+
+}  // namespace mongo
@@ -0,0 +1,114 @@
+// @file op_memory.h accounting of memory buffered on behalf of in-flight operations
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * Accounting of memory buffered on behalf of in-flight operations: sort buffers, $group
+     * maps, working set slabs.  Consumers charge the bytes they hold as their usage grows
+     * and release them as it shrinks or they are destroyed.  Totals are kept per consumer
+     * class for the serverStatus "opMemory" section, and two budgets are enforced at charge
+     * time -- per operation (opMemoryLimitMB) and server wide (totalOpMemoryLimitMB) -- so a
+     * runaway query fails with an error instead of taking the node down.  Both budgets
+     * default to 0 (off).
+     */
+    namespace opmem {
+
+        /** what the memory is buffered for; indexes the serverStatus breakdown */
+        enum Class {
+            ClassWorkingSet = 0,
+            ClassSort,
+            ClassGroup,
+            NumClasses
+        };
+
+        /**
+         * Charge 'bytes' to the current operation under 'cls'.  uasserts if this pushes the
+         * operation over opMemoryLimitMB or the server over totalOpMemoryLimitMB.  The
+         * charge is recorded even when it throws, so the caller must still release the full
+         * amount it has charged (OpMemoryCharge does this automatically).
+         */
+        void charge( Class cls, long long bytes );
+
+        /** give back memory previously charge()d.  never throws. */
+        void release( Class cls, long long bytes );
+
+        /** fill in the serverStatus "opMemory" section */
+        void appendStats( BSONObjBuilder& b );
+
+        /**
+         * Per-operation accounting hooks.  mongod points these at the current CurOp (see
+         * curop.cpp); in mongos and the tools they stay NULL and only the class totals and
+         * the server-wide limit apply.  noteOpCharge returns the operation's new total.
+         */
+        extern long long (*noteOpCharge)( long long bytes );
+        extern void (*noteOpRelease)( long long bytes );
+
+        /**
+         * Tracks the bytes one consumer has charged.  Call set() with the consumer's
+         * current usage estimate as it changes; set() may uassert (over budget), but the
+         * accounting stays consistent either way and the destructor releases whatever is
+         * still charged.
+         */
+        class OpMemoryCharge : private boost::noncopyable {
+        public:
+            explicit OpMemoryCharge( Class cls ) : _cls( cls ), _charged( 0 ) {}
+            ~OpMemoryCharge() { release( _cls, _charged ); }
+
+            void set( long long newTotal ) {
+                if ( newTotal < 0 )
+                    newTotal = 0;
+                if ( newTotal > _charged ) {
+                    const long long delta = newTotal - _charged;
+                    _charged = newTotal; // recorded first so a throwing charge() is released too
+                    charge( _cls, delta );
+                }
+                else {
+                    release( _cls, _charged - newTotal );
+                    _charged = newTotal;
+                }
+            }
+
+            long long charged() const { return _charged; }
+
+        private:
+            const Class _cls;
+            long long _charged;
+        };
+
+    }  // namespace opmem
+
+}  // namespace mongo
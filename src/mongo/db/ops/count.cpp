@@ -33,6 +33,7 @@
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/client.h"
 #include "mongo/db/clientcursor.h"
+#include "mongo/db/intervalbtreecursor.h"
 #include "mongo/db/query_optimizer.h"
 #include "mongo/db/queryutil.h"
 #include "mongo/util/elapsed_tracker.h"
@@ -89,6 +90,19 @@ namespace mongo {
         }
 
         shared_ptr<Cursor> cursor = getOptimizedCursor( ns, query, BSONObj(), _countPlanPolicies );
+
+        // An IntervalBtreeCursor with no matcher means the single btree interval exactly
+        // represents the query.  Count its keys by summing bucket counts instead of
+        // advancing through them one by one.  Multikey indexes still iterate so duplicate
+        // record locations can be deduped.  The traversal touches only bucket headers, but
+        // holds the read lock throughout rather than yielding.
+        {
+            IntervalBtreeCursor* interval = dynamic_cast<IntervalBtreeCursor*>( cursor.get() );
+            if ( interval && !interval->matcher() && !interval->isMultiKey() ) {
+                return applySkipLimit( interval->countInterval(), cmd );
+            }
+        }
+
         ClientCursorHolder ccPointer;
         ElapsedTracker timeToStartYielding( 256, 20 );
         try {
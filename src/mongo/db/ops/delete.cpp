@@ -49,8 +49,10 @@ namespace mongo {
        pattern: the "where" clause / criteria
        justOne: stop after 1 match
        god:     allow access to system namespaces, and don't yield
+       limit:   if > 0, stop after deleting this many documents
     */
-    long long deleteObjects(const StringData& ns, BSONObj pattern, bool justOne, bool logop, bool god) {
+    long long deleteObjects(const StringData& ns, BSONObj pattern, bool justOne, bool logop, bool god,
+                            long long limit) {
         if( !god ) {
             if ( ns.find( ".system.") != string::npos ) {
                 /* note a delete from system.indexes would corrupt the db
@@ -70,6 +72,9 @@ namespace mongo {
             if ( ! d )
                 return 0;
             uassert( 10101, "can't remove from a capped collection", ! d->isCapped() );
+            uassert( 17556,
+                     str::stream() << "cannot remove from frozen collection: " << ns.toString(),
+                     god || !d->isUserFlagSet( NamespaceDetails::Flag_Frozen ) );
         }
 
         string nsForLoOp = ns.toString(); // XXX-ERH
@@ -89,19 +94,32 @@ namespace mongo {
 
         bool canYield = !god && !(creal->matcher() && creal->matcher()->docMatcher().atomic());
 
-        do {
-            // TODO: we can generalize this I believe
-            //       
-            bool willNeedRecord = (creal->matcher() && creal->matcher()->needRecord()) || pattern.isEmpty() || isSimpleIdQuery( pattern );
-            if ( ! willNeedRecord ) {
-                // TODO: this is a total hack right now
-                // check if the index full encompasses query
-                
-                if ( pattern.nFields() == 1 && 
-                     str::equals( pattern.firstElement().fieldName() , creal->indexKeyPattern().firstElement().fieldName() ) )
-                    willNeedRecord = true;
-            }
-            
+        // TODO: we can generalize this I believe
+        //
+        bool willNeedRecord = (creal->matcher() && creal->matcher()->needRecord()) || pattern.isEmpty() || isSimpleIdQuery( pattern );
+        if ( ! willNeedRecord ) {
+            // TODO: this is a total hack right now
+            // check if the index full encompasses query
+
+            if ( pattern.nFields() == 1 &&
+                 str::equals( pattern.firstElement().fieldName() , creal->indexKeyPattern().firstElement().fieldName() ) )
+                willNeedRecord = true;
+        }
+
+        // Matching documents are deleted in batches, saving and restoring the cursor's
+        // position once per batch instead of once per document.  Repositioning a btree
+        // cursor is the expensive part of a delete scan (see the NOTE below), so this
+        // keeps large range deletes linear.  The scan is also bounded so a long run of
+        // non-matching documents still reaches the yield check.
+        const size_t kDeleteBatchSize = 64;
+        const size_t kScanBatchSize = 256;
+
+        vector<DiskLoc> batch;
+        set<DiskLoc> batchSet;
+        batch.reserve( kDeleteBatchSize );
+
+        bool doneScanning = false;
+        while ( ! doneScanning ) {
             if ( canYield && ! cc->yieldSometimes( willNeedRecord ? ClientCursor::WillNeed : ClientCursor::MaybeCovered ) ) {
                 cc.release(); // has already been deleted elsewhere
                 // TODO should we assert or something?
@@ -115,58 +133,85 @@ namespace mongo {
             // as well as some other nuances handled
             cc->setDoingDeletes( true );
 
-            DiskLoc rloc = cc->currLoc();
-            BSONObj key = cc->currKey();
+            // gather a batch of matching documents, advancing past each before it is deleted
+            batch.clear();
+            batchSet.clear();
+            for ( size_t scanned = 0;
+                  cc->ok() && batch.size() < kDeleteBatchSize && scanned < kScanBatchSize;
+                  scanned++ ) {
+                DiskLoc rloc = cc->currLoc();
+                bool match = creal->currentMatches();
 
-            bool match = creal->currentMatches();
+                cc->advance();
 
-            cc->advance();
-            
-            if ( ! match )
-                continue;
+                if ( ! match )
+                    continue;
+
+                // a multikey cursor may visit the same document more than once, but it may
+                // only enter the batch (and be deleted) the first time
+                if ( cc->c()->getsetdup( rloc ) )
+                    continue;
+
+                batch.push_back( rloc );
+                batchSet.insert( rloc );
+
+                if ( justOne || ( limit > 0 && nDeleted + (long long)batch.size() >= limit ) ) {
+                    doneScanning = true;
+                    break;
+                }
+            }
 
-            // SERVER-5198 Advance past the document to be modified, but see SERVER-5725.
-            while( cc->ok() && rloc == cc->currLoc() ) {
+            // SERVER-5198 The cursor must not be positioned on any document in the batch
+            // when the batch is deleted, but see SERVER-5725.
+            while ( cc->ok() && batchSet.count( cc->currLoc() ) ) {
                 cc->advance();
             }
-            
-            bool foundAllResults = ( justOne || !cc->ok() );
 
-            if ( !foundAllResults ) {
-                // NOTE: Saving and restoring a btree cursor's position was historically described
-                // as slow here.
+            if ( ! cc->ok() ) {
+                doneScanning = true;
+            }
+
+            if ( batch.empty() )
+                continue;
+
+            if ( ! doneScanning ) {
+                // NOTE: Saving and restoring a btree cursor's position was historically
+                // described as slow here; it now happens once per batch.
                 cc->c()->prepareToTouchEarlierIterate();
             }
 
-            if ( logop ) {
-                BSONElement e;
-                if( BSONObj::make( rloc.rec() ).getObjectID( e ) ) {
-                    BSONObjBuilder b;
-                    b.append( e );
-                    bool replJustOne = true;
-                    logOp( "d", nsForLoOp.c_str(), b.done(), 0, &replJustOne );
-                }
-                else {
-                    problem() << "deleted object without id, not logging" << endl;
+            for ( size_t i = 0; i < batch.size(); i++ ) {
+                const DiskLoc rloc = batch[i];
+
+                if ( logop ) {
+                    BSONElement e;
+                    if( BSONObj::make( rloc.rec() ).getObjectID( e ) ) {
+                        BSONObjBuilder b;
+                        b.append( e );
+                        bool replJustOne = true;
+                        logOp( "d", nsForLoOp.c_str(), b.done(), 0, &replJustOne );
+                    }
+                    else {
+                        problem() << "deleted object without id, not logging" << endl;
+                    }
                 }
-            }
 
-            //theDataFileMgr.deleteRecord(ns, rloc.rec(), rloc);
-            currentClient.get()->database()->getCollection( ns )->deleteDocument( rloc );
+                //theDataFileMgr.deleteRecord(ns, rloc.rec(), rloc);
+                currentClient.get()->database()->getCollection( ns )->deleteDocument( rloc );
 
-            nDeleted++;
-            if ( foundAllResults ) {
-                break;
+                nDeleted++;
+
+                if( debug && god && nDeleted == 100 )
+                    log() << "warning high number of deletes with god=true which could use significant memory" << endl;
             }
-            cc->c()->recoverFromTouchingEarlierIterate();
-         
-            if( !god ) 
-                getDur().commitIfNeeded();
 
-            if( debug && god && nDeleted == 100 ) 
-                log() << "warning high number of deletes with god=true which could use significant memory" << endl;
+            if ( ! doneScanning ) {
+                cc->c()->recoverFromTouchingEarlierIterate();
+            }
+
+            if( !god )
+                getDur().commitIfNeeded();
         }
-        while ( cc->ok() );
 
         if ( cc.get() && ClientCursor::find( id , false ) == 0 ) {
             // TODO: remove this and the id declaration above if this doesn't trigger
@@ -35,10 +35,12 @@
 namespace mongo {
 
     // If justOne is true, deletedId is set to the id of the deleted object.
+    // If limit is greater than zero, stops after deleting that many documents.
     long long deleteObjects(const StringData& ns,
                             BSONObj pattern,
                             bool justOne,
                             bool logop = false,
-                            bool god=false);
+                            bool god=false,
+                            long long limit = 0);
 
 }
@@ -47,6 +47,7 @@
 #include "mongo/db/query/new_find.h"
 #include "mongo/db/repl/finding_start_cursor.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/oplog_window.h"
 #include "mongo/db/repl/repl_reads_ok.h"
 #include "mongo/db/scanandorder.h"
 #include "mongo/db/storage_options.h"
@@ -198,9 +199,67 @@ namespace mongo {
             curop.debug().query = cc->query();
             curop.setQuery( cc->query() );
 
+            // Tailing oplog cursors are answered from the in-memory oplog window while
+            // their position is inside it, so healthy tailers never touch oplog pages
+            // in the page cache (see OplogWindow).
+            if ( cc->oplogWindowEligible() && !cc->getSlaveReadTill().isNull() ) {
+                OpTime pos = cc->getSlaveReadTill();
+                OpTime newPos = pos;
+                if ( theOplogWindow.readAfter( pos, ntoreturn, cc->nextBatchByteBudget(),
+                                               b, &n, &newPos ) == OplogWindow::Served ) {
+                    if ( n == 0 && ( cc->queryOptions() & QueryOption_AwaitData ) &&
+                         pass < 1000 ) {
+                        return 0;
+                    }
+
+                    start = cc->pos();
+                    cc->incPos( n );
+                    cc->slaveReadTill( newPos );
+                    cc->noteOplogWindowServed();
+                    cc->noteBatchReturned();
+                    exhaust = cc->queryOptions() & QueryOption_Exhaust;
+                    cc->setLeftoverMaxTimeMicros( curop.getRemainingMaxTimeMicros() );
+
+                    QueryResult* qr = (QueryResult*) b.buf();
+                    qr->len = b.len();
+                    qr->setOperation(opReply);
+                    qr->_resultFlags() = resultFlags;
+                    qr->cursorId = cursorid;
+                    qr->startingFrom = start;
+                    qr->nReturned = n;
+                    b.decouple();
+                    return qr;
+                }
+                if ( cc->oplogWindowServed() ) {
+                    // already served past the collection cursor's position and now
+                    // behind the window (lagging tailer); end the cursor so the
+                    // client requeries from its own last timestamp
+                    p.release();
+                    ClientCursor::erase( cursorid );
+                    cursorid = 0;
+
+                    QueryResult* qr = (QueryResult*) b.buf();
+                    qr->len = b.len();
+                    qr->setOperation(opReply);
+                    qr->_resultFlags() = resultFlags;
+                    qr->cursorId = 0;
+                    qr->startingFrom = 0;
+                    qr->nReturned = 0;
+                    b.decouple();
+                    return qr;
+                }
+                // never served from the window; the collection cursor is still
+                // positioned correctly, use the normal path (and retry the window
+                // once the tail catches up into it)
+            }
+
             start = cc->pos();
             Cursor *c = cc->c();
 
+            // how many reply bytes to accumulate before cutting the batch; grows for
+            // consumers that come right back for more (see ClientCursor)
+            const int batchByteBudget = cc->nextBatchByteBudget();
+
             if (!c->requiresLock()) {
                 // make sure it won't be destroyed under us
                 fassert(16952, !c->shouldDestroyOnNSDeletion());
@@ -273,7 +332,7 @@ namespace mongo {
                                     ( ( cc->pq.get() && cc->pq->showDiskLoc() ) ? &loc : 0 ) );
                         }
 
-                        if ( ( ntoreturn && n >= ntoreturn ) || b.len() > MaxBytesToReturnToClientAtOnce ) {
+                        if ( ( ntoreturn && n >= ntoreturn ) || b.len() > batchByteBudget ) {
                             c->advance();
                             cc->incPos( n );
                             break;
@@ -300,6 +359,7 @@ namespace mongo {
                     cc->c()->noteLocation();
                 }
                 cc->storeOpForSlave( last );
+                cc->noteBatchReturned();
                 exhaust = cc->queryOptions() & QueryOption_Exhaust;
 
                 // If the getmore had a time limit, remaining time is "rolled over" back to the
@@ -903,6 +963,15 @@ namespace mongo {
             if ( pq.hasOption( QueryOption_OplogReplay ) && !slaveReadTill.isNull() ) {
                 ccPointer->slaveReadTill( slaveReadTill );
             }
+
+            // A plain ts-bounded tail of the replset oplog can have its getMore
+            // batches answered from the in-memory oplog window; its position is the
+            // slaveReadTill timestamp maintained above and by storeOpForSlave().
+            if ( pq.hasOption( QueryOption_OplogReplay ) && ccPointer->c()->tailable() &&
+                 str::equals( ns.c_str(), rsoplog ) && !pq.getFieldPtr() &&
+                 OplogWindow::isTailQuery( query ) ) {
+                ccPointer->setOplogWindowEligible();
+            }
             
             if ( !ccPointer->ok() && ccPointer->c()->tailable() ) {
                 DEV {
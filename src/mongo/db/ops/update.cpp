@@ -34,10 +34,13 @@
 
 #include <cstring>  // for memcpy
 
+#include "mongo/base/counter.h"
 #include "mongo/bson/mutable/damage_vector.h"
 #include "mongo/bson/mutable/document.h"
 #include "mongo/client/dbclientinterface.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/clientcursor.h"
+#include "mongo/db/index/deferred_index_updates.h"
 #include "mongo/db/index_set.h"
 #include "mongo/db/namespace_details.h"
 #include "mongo/db/ops/update_driver.h"
@@ -48,10 +51,21 @@
 #include "mongo/db/queryutil.h"
 #include "mongo/db/storage/record.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/oplog_delta.h"
 #include "mongo/platform/unordered_set.h"
 
 namespace mongo {
 
+    // how often updates are applied without rewriting or moving the record vs. going
+    // through updateRecord().  the ratio of the two is a good health indicator for
+    // update-heavy workloads.
+    static Counter64 updatesInPlaceCounter;
+    static ServerStatusMetricField<Counter64> displayUpdatesInPlace(
+        "record.updatesInPlace", &updatesInPlaceCounter );
+    static Counter64 updatesRewrittenCounter;
+    static ServerStatusMetricField<Counter64> displayUpdatesRewritten(
+        "record.updatesRewritten", &updatesRewrittenCounter );
+
     namespace {
 
         // TODO: Make this a function on NamespaceString, or make it cleaner.
@@ -87,6 +101,34 @@ namespace mongo {
             }
         }
 
+        /**
+         * Applies any still-deferred index deltas if the update loop unwinds on an
+         * assertion, so documents already rewritten don't lose their index changes.
+         * The normal path flushes explicitly and leaves nothing for this to do.
+         */
+        class DeferredIndexUpdatesFlushGuard {
+        public:
+            DeferredIndexUpdatesFlushGuard( DeferredIndexUpdates* deferred,
+                                            NamespaceDetails** nsDetails )
+                : _deferred( deferred ), _nsDetails( nsDetails ) {
+            }
+            ~DeferredIndexUpdatesFlushGuard() {
+                if ( _deferred->empty() || NULL == *_nsDetails )
+                    return;
+                try {
+                    _deferred->flush( *_nsDetails );
+                }
+                catch ( const DBException& e ) {
+                    // an exception is already in flight; just record this one
+                    error() << "flushing deferred index updates failed: "
+                            << e.what() << endl;
+                }
+            }
+        private:
+            DeferredIndexUpdates* _deferred;
+            NamespaceDetails** _nsDetails;
+        };
+
     } // namespace
 
     UpdateResult update(const UpdateRequest& request, OpDebug* opDebug) {
@@ -125,11 +167,20 @@ namespace mongo {
         NamespaceDetailsTransient* nsDetailsTransient =
             &NamespaceDetailsTransient::get( nsString.ns().c_str() );
 
+        uassert( 17557,
+                 str::stream() << "cannot update frozen collection: " << nsString.ns(),
+                 request.isGod() || request.isFromReplication() || !nsDetails ||
+                 !nsDetails->isUserFlagSet( NamespaceDetails::Flag_Frozen ) );
+
         // TODO: This seems a bit circuitious.
         opDebug->updateobj = request.getUpdates();
 
         driver->refreshIndexKeys( nsDetailsTransient->indexKeys() );
 
+        // Precompute the document-independent part of the per-document analysis (mod
+        // conflicts and index effects), so a multi-update doesn't redo it per match.
+        driver->prepare();
+
         shared_ptr<Cursor> cursor = getOptimizedCursor(
             nsString.ns(), request.getQuery(), BSONObj(), request.getQueryPlanSelectionPolicy() );
 
@@ -167,6 +218,13 @@ namespace mongo {
         unordered_set<DiskLoc, DiskLoc::Hasher> seenLocs;
         int numMatched = 0;
 
+        // For a multi-update, updateRecord() queues key-level changes to dups-allowed
+        // indexes here instead of applying them per document; they are applied sorted
+        // per index at flush points below, turning N random btree descents per index
+        // into one roughly sequential pass.  Must never hold deltas across a yield.
+        DeferredIndexUpdates deferredIndexUpdates;
+        DeferredIndexUpdatesFlushGuard flushGuard( &deferredIndexUpdates, &nsDetails );
+
         // Reset these counters on each call. We might re-enter this function to retry this
         // update if we throw a page fault exception below, and we rely on these counters
         // reflecting only the actions taken locally. In particlar, we must have the no-op
@@ -209,11 +267,26 @@ namespace mongo {
                     clientCursor.reset(
                         new ClientCursor( QueryOption_NoCursorTimeout, cursor, nsString.ns() ) );
 
-                // Ask the client cursor to yield. We get two bits of state back: whether or not
-                // we yielded, and whether or not we correctly recovered from yielding.
+                // With the write lock released the btrees must agree with the documents,
+                // so deferred index deltas may not survive a yield.  When a yield may be
+                // coming, apply them first; while deltas are pending and no yield is due
+                // (bounded by the yield tracker's time interval), skip the yield check
+                // entirely so the batch can keep growing.
                 bool yielded = false;
-                const bool recovered = clientCursor->yieldSometimes(
-                    ClientCursor::WillNeed, &yielded );
+                bool recovered = true;
+                if ( deferredIndexUpdates.empty() ||
+                     clientCursor->yieldMayOccur( ClientCursor::WillNeed ) ) {
+                    if ( !deferredIndexUpdates.empty() ) {
+                        deferredIndexUpdates.flush( nsDetails );
+                        getDur().commitIfNeeded();
+                    }
+
+                    // Ask the client cursor to yield. We get two bits of state back:
+                    // whether or not we yielded, and whether or not we correctly
+                    // recovered from yielding.
+                    recovered = clientCursor->yieldSometimes(
+                        ClientCursor::WillNeed, &yielded );
+                }
 
                 if ( !recovered ) {
                     // If we failed to recover from the yield, then the ClientCursor is already
@@ -239,6 +312,7 @@ namespace mongo {
 
                     // TODO: This copies the index keys, but it may not need to do so.
                     driver->refreshIndexKeys( nsDetailsTransient->indexKeys() );
+                    driver->prepare();
                 }
 
             }
@@ -321,6 +395,7 @@ namespace mongo {
             // document is needed to accomodate the new bson layout of the resulting document.
             doc.reset( oldObj, mutablebson::Document::kInPlaceEnabled );
             BSONObj logObj;
+            BSONObj oplogDelta;
 
             // If there was a matched field, obtain it.
             string matchedField;
@@ -364,30 +439,73 @@ namespace mongo {
                     }
                     objectWasChanged = true;
                     opDebug->fastmod = true;
+                    updatesInPlaceCounter.increment();
                 }
                 newObj = oldObj;
             }
             else {
 
-                // The updates were not in place. Apply them through the file manager.
+                // The updates were not in place. Ask the driver for the new version of the
+                // document.
                 newObj = doc.getObject();
-                DiskLoc newLoc = theDataFileMgr.updateRecord(nsString.ns().c_str(),
-                                                             nsDetails,
-                                                             nsDetailsTransient,
-                                                             record,
-                                                             loc,
-                                                             newObj.objdata(),
-                                                             newObj.objsize(),
-                                                             *opDebug);
-
-                // If we've moved this object to a new location, make sure we don't apply
-                // that update again if our traversal picks the objecta again.
-                //
-                // We also take note that the diskloc if the updates are affecting indices.
-                // Chances are that we're traversing one of them and they may be multi key and
-                // therefore duplicate disklocs.
-                if ( newLoc != loc || driver->modsAffectIndices()  ) {
-                    seenLocs.insert( newLoc );
+
+                // A replacement that leaves the document size unchanged usually rewrites
+                // only a few of its bytes; log those instead of the whole document.  The
+                // delta has to be computed now, before the writes below destroy the
+                // pre-image.
+                if ( driver->isDocReplacement() && request.shouldUpdateOpLog() )
+                    oplogDelta = makeUpdateOplogDelta( oldObj, newObj );
+
+                // Note the isDocReplacement() check: a whole-object replacement reports no
+                // field refs, so modsAffectIndices() is not meaningful for it.
+                if ( !driver->isDocReplacement() &&
+                     !driver->modsAffectIndices() &&
+                     newObj.objsize() <= record->netLength() &&
+                     nsString.coll() != "system.users" ) {
+
+                    // The mods changed the binary layout (e.g. an int counter became a
+                    // long), but no indexed field is involved and the new version still
+                    // fits where the record already lives.  Overwrite the record where it
+                    // stands instead of going through updateRecord(), which re-derives the
+                    // keys for every index on the collection and may move the record --
+                    // most of the cost of a "grew by a few bytes" counter update.  This
+                    // leans on the same invariant as the damage path above: when
+                    // modsAffectIndices() is false no index entry can change.
+                    // (system.users is left to updateRecord() so its document validation
+                    // still runs.)
+                    nsDetails->paddingFits();
+                    nsDetailsTransient->notifyOfWriteOp();
+
+                    const int sz = newObj.objsize();
+                    memcpy( getDur().writingPtr( const_cast<char*>( oldObj.objdata() ), sz ),
+                            newObj.objdata(), sz );
+
+                    updatesInPlaceCounter.increment();
+                }
+                else {
+                    updatesRewrittenCounter.increment();
+                    DiskLoc newLoc = theDataFileMgr.updateRecord(nsString.ns().c_str(),
+                                                                 nsDetails,
+                                                                 nsDetailsTransient,
+                                                                 record,
+                                                                 loc,
+                                                                 newObj.objdata(),
+                                                                 newObj.objsize(),
+                                                                 *opDebug,
+                                                                 false,
+                                                                 request.isMulti() ?
+                                                                     &deferredIndexUpdates :
+                                                                     NULL);
+
+                    // If we've moved this object to a new location, make sure we don't apply
+                    // that update again if our traversal picks the objecta again.
+                    //
+                    // We also take note that the diskloc if the updates are affecting indices.
+                    // Chances are that we're traversing one of them and they may be multi key and
+                    // therefore duplicate disklocs.
+                    if ( newLoc != loc || driver->modsAffectIndices()  ) {
+                        seenLocs.insert( newLoc );
+                    }
                 }
 
                 objectWasChanged = true;
@@ -397,7 +515,8 @@ namespace mongo {
             if ( request.shouldUpdateOpLog() ) {
                 if ( driver->isDocReplacement() || !logObj.isEmpty() ) {
                     BSONObj idQuery = driver->makeOplogEntryQuery(newObj, request.isMulti());
-                    logOp("u", nsString.ns().c_str(), logObj , &idQuery,
+                    logOp("u", nsString.ns().c_str(),
+                          oplogDelta.isEmpty() ? logObj : oplogDelta, &idQuery,
                           NULL, request.isFromMigration(), &newObj);
                 }
             }
@@ -416,10 +535,24 @@ namespace mongo {
                 cursor->recoverFromTouchingEarlierIterate();
             }
 
-            getDur().commitIfNeeded();
+            // Keep the documents and their index maintenance inside one dur commit
+            // scope: only commit when nothing is deferred, and cap how much index work
+            // a single scope accumulates.
+            if ( deferredIndexUpdates.empty() ) {
+                getDur().commitIfNeeded();
+            }
+            else if ( deferredIndexUpdates.size() >= 1000 ) {
+                deferredIndexUpdates.flush( nsDetails );
+                getDur().commitIfNeeded();
+            }
 
         }
 
+        if ( !deferredIndexUpdates.empty() ) {
+            deferredIndexUpdates.flush( nsDetails );
+            getDur().commitIfNeeded();
+        }
+
         // TODO: Can this be simplified?
         if ((numMatched > 0) || (numMatched == 0 && !request.isUpsert()) ) {
             opDebug->nupdated = numMatched;
@@ -29,10 +29,12 @@
 #include "mongo/db/ops/update_driver.h"
 
 #include "mongo/base/error_codes.h"
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/base/string_data.h"
 #include "mongo/bson/mutable/document.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/field_ref_set.h"
+#include "mongo/db/ops/field_checker.h"
 #include "mongo/db/ops/log_builder.h"
 #include "mongo/db/ops/modifier_object_replace.h"
 #include "mongo/db/ops/modifier_table.h"
@@ -48,7 +50,8 @@ namespace mongo {
         : _multi(opts.multi)
         , _upsert(opts.upsert)
         , _logOp(opts.logOp)
-        , _modOptions(opts.modOptions) {
+        , _modOptions(opts.modOptions)
+        , _planValid(false) {
     }
 
     UpdateDriver::~UpdateDriver() {
@@ -134,6 +137,15 @@ namespace mongo {
                     return status;
                 }
 
+                // Remember the path(s) this mod targets so prepare() can reason about
+                // them without a document. $rename also "targets" its destination, which
+                // it carries in the mod value.
+                string secondPath;
+                if (modType == modifiertable::MOD_RENAME && innerModElem.type() == String) {
+                    secondPath = innerModElem.valuestr();
+                }
+                _modPaths.push_back(make_pair(string(innerModElem.fieldName()), secondPath));
+
                 _mods.push_back(mod.release());
             }
         }
@@ -145,6 +157,61 @@ namespace mongo {
         return Status::OK();
     }
 
+    void UpdateDriver::prepare() {
+        _planValid = false;
+        _modCanAffectIndices.clear();
+
+        // A full object replacement can touch anything; there is nothing to precompute
+        // (and it cannot be a multi update anyway).
+        if (_replacementMode) {
+            return;
+        }
+
+        dassert(_modPaths.size() == _mods.size());
+
+        // Run the same conflict check update() performs per document, but once. The
+        // FieldRefs must outlive 'targetFields', which does not own what it holds.
+        FieldRefSet targetFields;
+        OwnedPointerVector<FieldRef> fieldRefs;
+        vector<char> canAffect;
+
+        for (size_t i = 0; i < _modPaths.size(); i++) {
+            bool affects = false;
+            for (int j = 0; j < 2; j++) {
+                const string& path = (j == 0) ? _modPaths[i].first : _modPaths[i].second;
+                if (path.empty()) {
+                    continue; // mods other than $rename have a single target
+                }
+
+                auto_ptr<FieldRef> ref(new FieldRef);
+                ref->parse(path);
+
+                size_t dollarPos;
+                if (fieldchecker::isPositional(*ref, &dollarPos)) {
+                    // The path binds to a per-document match; no static plan possible.
+                    return;
+                }
+
+                const FieldRef* conflict;
+                if (!targetFields.insert(ref.get(), &conflict)) {
+                    // Leave the plan invalid so update() rediscovers the conflict per
+                    // document and reports it exactly as it always has.
+                    return;
+                }
+
+                if (!affects && _indexedFields.mightBeIndexed(ref->dottedField())) {
+                    affects = true;
+                }
+
+                fieldRefs.mutableVector().push_back(ref.release());
+            }
+            canAffect.push_back(affects ? 1 : 0);
+        }
+
+        _modCanAffectIndices.swap(canAffect);
+        _planValid = true;
+    }
+
     Status UpdateDriver::createFromQuery(const BSONObj& query, mutablebson::Document& doc) {
         BSONObjIteratorSorted i(query);
         while (i.more()) {
@@ -210,9 +277,17 @@ namespace mongo {
         _logDoc.reset();
         LogBuilder logBuilder(_logDoc.root());
 
+        // If prepare() produced a plan for this operation, the conflict check below was
+        // already done once and each mod's possible index effects are known, so the
+        // per-document field analysis can be skipped.
+        const bool planned = _planValid;
+        size_t modIndex = 0;
+
         // Ask each of the mods to type check whether they can operate over the current document
         // and, if so, to change that document accordingly.
-        for (vector<ModifierInterface*>::iterator it = _mods.begin(); it != _mods.end(); ++it) {
+        for (vector<ModifierInterface*>::iterator it = _mods.begin();
+                it != _mods.end();
+                ++it, ++modIndex) {
             ModifierInterface::ExecInfo execInfo;
             Status status = (*it)->prepare(doc->root(), matchedField, &execInfo);
             if (!status.isOK()) {
@@ -231,37 +306,48 @@ namespace mongo {
             }
 
 
-            // Gather which fields this mod is interested on and whether these fields were
-            // "taken" by previous mods.  Note that not all mods are multi-field mods. When we
-            // see an empty field, we may stop looking for others.
-            for (int i = 0; i < ModifierInterface::ExecInfo::MAX_NUM_FIELDS; i++) {
-                if (execInfo.fieldRef[i] == 0) {
-                    break;
+            if (planned) {
+                // prepare() already established that the mods don't conflict and whether
+                // each of them can reach inside an index.
+                if (!_affectIndices && !execInfo.noOp && _modCanAffectIndices[modIndex]) {
+                    _affectIndices = true;
+                    doc->disableInPlaceUpdates();
                 }
+            }
+            else {
+
+                // Gather which fields this mod is interested on and whether these fields were
+                // "taken" by previous mods.  Note that not all mods are multi-field mods. When we
+                // see an empty field, we may stop looking for others.
+                for (int i = 0; i < ModifierInterface::ExecInfo::MAX_NUM_FIELDS; i++) {
+                    if (execInfo.fieldRef[i] == 0) {
+                        break;
+                    }
 
-                if (!targetFields.empty() || _mods.size() > 1) {
-                    const FieldRef* other;
-                    if (!targetFields.insert(execInfo.fieldRef[i], &other)) {
-                        return Status(ErrorCodes::ConflictingUpdateOperators,
-                                      str::stream() << "Cannot update '"
-                                                    << other->dottedField()
-                                                    << "' and '"
-                                                    << execInfo.fieldRef[i]->dottedField()
-                                                    << "' at the same time");
+                    if (!targetFields.empty() || _mods.size() > 1) {
+                        const FieldRef* other;
+                        if (!targetFields.insert(execInfo.fieldRef[i], &other)) {
+                            return Status(ErrorCodes::ConflictingUpdateOperators,
+                                          str::stream() << "Cannot update '"
+                                                        << other->dottedField()
+                                                        << "' and '"
+                                                        << execInfo.fieldRef[i]->dottedField()
+                                                        << "' at the same time");
+                        }
                     }
-                }
 
-                // We start with the expectation that a mod will be in-place. But if the mod
-                // touched an indexed field and the mod will indeed be executed -- that is, it
-                // is not a no-op and it is in a valid context -- then we switch back to a
-                // non-in-place mode.
-                //
-                // TODO: make mightBeIndexed and fieldRef like each other.
-                if (!_affectIndices &&
-                    !execInfo.noOp &&
-                    _indexedFields.mightBeIndexed(execInfo.fieldRef[i]->dottedField())) {
-                    _affectIndices = true;
-                    doc->disableInPlaceUpdates();
+                    // We start with the expectation that a mod will be in-place. But if the mod
+                    // touched an indexed field and the mod will indeed be executed -- that is, it
+                    // is not a no-op and it is in a valid context -- then we switch back to a
+                    // non-in-place mode.
+                    //
+                    // TODO: make mightBeIndexed and fieldRef like each other.
+                    if (!_affectIndices &&
+                        !execInfo.noOp &&
+                        _indexedFields.mightBeIndexed(execInfo.fieldRef[i]->dottedField())) {
+                        _affectIndices = true;
+                        doc->disableInPlaceUpdates();
+                    }
                 }
             }
 
@@ -302,6 +388,9 @@ namespace mongo {
 
     void UpdateDriver::refreshIndexKeys(const IndexPathSet& indexedFields) {
         _indexedFields = indexedFields;
+
+        // The per-mod index effects precomputed by prepare() are now stale.
+        _planValid = false;
     }
 
     bool UpdateDriver::multi() const {
@@ -367,8 +456,11 @@ namespace mongo {
         for (vector<ModifierInterface*>::iterator it = _mods.begin(); it != _mods.end(); ++it) {
             delete *it;
         }
+        _modPaths.clear();
         _indexedFields.clear();
         _replacementMode = false;
+        _planValid = false;
+        _modCanAffectIndices.clear();
     }
 
 } // namespace mongo
@@ -53,6 +53,22 @@ namespace mongo {
          */
         Status parse(const BSONObj& updateExpr);
 
+        /**
+         * Precomputes, once per operation, the parts of the per-document analysis in
+         * update() that do not depend on the document: the check that no two mods target
+         * conflicting fields, and whether each mod can touch an indexed field.  Without
+         * this, a multi-update redoes both for every matched document.
+         *
+         * Only possible when no mod uses the positional operator, since a positional
+         * path binds per document.  When no plan can be built -- positional mods, object
+         * replacement, or a statically detected conflict -- update() silently falls back
+         * to the per-document analysis (and reports any conflict itself, as before).
+         *
+         * Must be called after parse() and refreshIndexKeys(); calling the latter again
+         * invalidates the plan.
+         */
+        void prepare();
+
         /**
          * Fills in document with any fields in the query which are valid.
          *
@@ -127,6 +143,11 @@ namespace mongo {
         // Collection of update mod instances. Owned here.
         vector<ModifierInterface*> _mods;
 
+        // For each mod, the dotted path(s) it targets as written in the update expression
+        // (second entry non-empty only for $rename). Fuel for prepare(); parallel to
+        // '_mods'. Empty in replacement mode.
+        vector<pair<string, string> > _modPaths;
+
         // What are the list of fields in the collection over which the update is going to be
         // applied that participate in indices?
         //
@@ -153,6 +174,13 @@ namespace mongo {
         // at each call to update.
         bool _affectIndices;
 
+        // Is the precomputed plan below usable? See prepare().
+        bool _planValid;
+
+        // For each mod, could it touch an indexed field? Parallel to '_mods'; meaningful
+        // only while '_planValid'.
+        vector<char> _modCanAffectIndices;
+
         // Is this update going to be an upsert?
         ModifierInterface::ExecInfo::UpdateContext _context;
 
@@ -36,7 +36,9 @@ namespace {
 
     using mongo::fromjson;
     using mongo::IndexPathSet;
+    using mongo::StringData;
     using mongo::UpdateDriver;
+    using mongo::mutablebson::Document;
 
     TEST(Parse, Normal) {
         UpdateDriver::Options opts;
@@ -109,4 +111,41 @@ namespace {
         ASSERT_FALSE(driver.isDocReplacement());
     }
 
+    TEST(Prepare, IndexEffectsPrecomputed) {
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+        ASSERT_OK(driver.parse(fromjson("{$set:{a:1}, $inc:{b:1}}")));
+        IndexPathSet indexes;
+        indexes.addPath("b");
+        driver.refreshIndexKeys(indexes);
+        driver.prepare();
+        Document doc(fromjson("{a:0, b:0}"));
+        ASSERT_OK(driver.update(StringData(), &doc, NULL));
+        ASSERT_TRUE(driver.modsAffectIndices());
+    }
+
+    TEST(Prepare, IndexUntouchedPrecomputed) {
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+        ASSERT_OK(driver.parse(fromjson("{$set:{a:1}, $inc:{b:1}}")));
+        IndexPathSet indexes;
+        indexes.addPath("c");
+        driver.refreshIndexKeys(indexes);
+        driver.prepare();
+        Document doc(fromjson("{a:0, b:0}"));
+        ASSERT_OK(driver.update(StringData(), &doc, NULL));
+        ASSERT_FALSE(driver.modsAffectIndices());
+    }
+
+    TEST(Prepare, ConflictStillReported) {
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+        ASSERT_OK(driver.parse(fromjson("{$set:{a:1}, $inc:{a:1}}")));
+        driver.prepare();
+        // prepare() refuses to build a plan for conflicting mods; update() must still
+        // report the conflict itself.
+        Document doc(fromjson("{a:0}"));
+        ASSERT_NOT_OK(driver.update(StringData(), &doc, NULL));
+    }
+
 } // unnamed namespace
@@ -110,6 +110,7 @@ namespace mongo {
         _showDiskLoc = false;
         _maxScan = 0;
         _maxTimeMS = 0;
+        _afterOpTime = OpTime();
     }
 
     /* This is for languages whose "objects" are not well ordered (JSON is well ordered).
@@ -188,6 +189,11 @@ namespace mongo {
                             maxTimeMS.isOK());
                     _maxTimeMS = maxTimeMS.getValue();
                 }
+                else if ( strcmp( "afterOpTime" , name ) == 0 ) {
+                    uassert( 17540, "$afterOpTime must be a timestamp",
+                             Timestamp == e.type() || Date == e.type() );
+                    _afterOpTime = e._opTime();
+                }
                 else if ( strcmp( "comment" , name ) == 0 ) {
                     ; // no-op
                 }
@@ -67,6 +67,7 @@ namespace mongo {
         const BSONObj& getHint() const { return _hint; }
         int getMaxScan() const { return _maxScan; }
         int getMaxTimeMS() const { return _maxTimeMS; }
+        const OpTime& getAfterOpTime() const { return _afterOpTime; }
 
         bool hasIndexSpecifier() const;
         
@@ -110,6 +111,10 @@ namespace mongo {
         BSONObj _hint;
         int _maxScan;
         int _maxTimeMS;
+
+        // read-your-writes token: secondaries only serve the query once their applied
+        // optime has reached this.  Null (the default) means no constraint.
+        OpTime _afterOpTime;
     };
 
 } // namespace mongo
@@ -61,7 +61,9 @@ _ disallow system* manipulations from the database.
 #include "mongo/db/index_legacy.h"
 #include "mongo/db/index_names.h"
 #include "mongo/db/index_update.h"
+#include "mongo/db/index/btree_access_method_internal.h"
 #include "mongo/db/index/catalog_hack.h"
+#include "mongo/db/index/deferred_index_updates.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/instance.h"
@@ -70,6 +72,7 @@ _ disallow system* manipulations from the database.
 #include "mongo/db/memconcept.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/ops/delete.h"
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/sort_phase_one.h"
 #include "mongo/db/repl/oplog.h"
@@ -300,7 +303,9 @@ namespace mongo {
             d->setMaxCappedDocs( mx );
 
         if ( options["flags"].numberInt() ) {
-            d->replaceUserFlags( options["flags"].numberInt() );
+            // never create a collection already frozen - cloning/restoring one has to
+            // be able to insert its documents.  refreeze with collMod once populated.
+            d->replaceUserFlags( options["flags"].numberInt() & ~NamespaceDetails::Flag_Frozen );
         }
 
         return true;
@@ -513,7 +518,8 @@ namespace mongo {
         NamespaceDetails *d,
         NamespaceDetailsTransient *nsdt,
         Record *toupdate, const DiskLoc& dl,
-        const char *_buf, int _len, OpDebug& debug,  bool god) {
+        const char *_buf, int _len, OpDebug& debug,  bool god,
+        DeferredIndexUpdates* deferredIndexUpdates) {
 
         dassert( toupdate == dl.rec() );
 
@@ -544,6 +550,8 @@ namespace mongo {
         uassert( 13596 , str::stream() << "cannot change _id of a document old:" << objOld << " new:" << objNew,
                 objNew["_id"] == objOld["_id"]);
 
+        const bool fits = toupdate->netLength() >= objNew.objsize();
+
         /* duplicate key check. we descend the btree twice - once for this check, and once for the actual inserts, further
            below.  that is suboptimal, but it's pretty complicated to do it the other way without rollbacks...
         */
@@ -551,12 +559,21 @@ namespace mongo {
         updateTickets.mutableVector().resize(d->getTotalIndexCount());
         for (int i = 0; i < d->getTotalIndexCount(); ++i) {
             auto_ptr<IndexDescriptor> descriptor(CatalogHack::getDescriptor(d, i));
-            auto_ptr<IndexAccessMethod> iam(CatalogHack::getIndex(descriptor.get()));
             InsertDeleteOptions options;
             options.logIfError = false;
             options.dupsAllowed = !(KeyPattern::isIdKeyPattern(descriptor->keyPattern())
                                     || descriptor->unique())
                                   || ignoreUniqueIndex(descriptor->getOnDisk());
+
+            // If the record is moving, its entries in every index are removed and
+            // reinserted by the deleteRecord()/insert() pair below and the tickets
+            // prepared here are never executed.  Only the duplicate key check
+            // matters for that path, and only indexes that disallow dups can fail
+            // it, so skip the old/new key generation for all the others.
+            if ( !fits && options.dupsAllowed )
+                continue;
+
+            auto_ptr<IndexAccessMethod> iam(CatalogHack::getIndex(descriptor.get()));
             updateTickets.mutableVector()[i] = new UpdateTicket();
             Status ret = iam->validateUpdate(objOld, objNew, dl, options,
                                              updateTickets.mutableVector()[i]);
@@ -566,7 +583,7 @@ namespace mongo {
             }
         }
 
-        if ( toupdate->netLength() < objNew.objsize() ) {
+        if ( !fits ) {
             // doesn't fit.  reallocate -----------------------------------------------------
             moveCounter.increment();
             uassert( 10003 , "failing update: objects in a capped ns cannot grow", !(d && d->isCapped()));
@@ -591,7 +608,17 @@ namespace mongo {
             auto_ptr<IndexDescriptor> descriptor(CatalogHack::getDescriptor(d, i));
             auto_ptr<IndexAccessMethod> iam(CatalogHack::getIndex(descriptor.get()));
             int64_t updatedKeys;
-            Status ret = iam->update(*updateTickets.vector()[i], &updatedKeys);
+            Status ret = Status::OK();
+            if (deferredIndexUpdates) {
+                // every access method in the catalog is btree backed
+                BtreeBasedAccessMethod* btree =
+                    static_cast<BtreeBasedAccessMethod*>(iam.get());
+                ret = btree->updateDeferred(*updateTickets.vector()[i], i,
+                                            deferredIndexUpdates, &updatedKeys);
+            }
+            else {
+                ret = iam->update(*updateTickets.vector()[i], &updatedKeys);
+            }
             if (Status::OK() != ret) {
                 // This shouldn't happen unless something disastrous occurred.
                 massert(16799, "update failed: " + ret.toString(), false);
@@ -924,6 +951,10 @@ namespace mongo {
 
         NamespaceDetails* d = collection->details();
 
+        uassert( 17555,
+                 str::stream() << "cannot insert into frozen collection: " << ns,
+                 god || !d->isUserFlagSet( NamespaceDetails::Flag_Frozen ) );
+
         NamespaceDetails *tableToIndex = 0;
 
         string tabletoidxns;
@@ -1049,10 +1080,159 @@ namespace mongo {
         return loc;
     }
 
+    bool DataFileMgr::insertBatch(const char* ns,
+                                  const vector<BSONObj>& objs,
+                                  vector<BSONObj>* inserted) {
+        if ( objs.size() < 2 ) {
+            // nothing to gain over insert()
+            return false;
+        }
+        if ( !NamespaceString::normal( ns ) || strstr( ns, ".system." ) )
+            return false;
+
+        Collection* collection = cc().database()->getCollection( ns );
+        if ( collection == NULL ) {
+            // let the first regular insert create the collection
+            return false;
+        }
+
+        NamespaceDetails* d = collection->details();
+        if ( d->isCapped() )
+            return false;
+
+        // Finalize the documents first (adding _id where needed) so the record lengths
+        // are known before we size the reservation.
+        vector<BSONObj> docs;
+        docs.reserve( objs.size() );
+        vector<int> lens;
+        lens.reserve( objs.size() );
+        long long totalLenWHdr = 0;
+        for ( size_t i = 0; i < objs.size(); i++ ) {
+            BSONObj obj = objs[i];
+            if ( obj["_id"].eoo() &&
+                 nsToDatabase( ns ) != "local" &&
+                 d->haveIdIndex() ) {
+                BSONObjBuilder b;
+                b.appendOID( "_id", 0, true );
+                b.appendElements( obj );
+                obj = b.obj();
+            }
+            BSONElementManipulator::lookForTimestamps( obj );
+
+            int lenWHdr = d->getRecordAllocationSize( obj.objsize() + Record::HeaderSize );
+            fassert( 17518, lenWHdr >= ( obj.objsize() + Record::HeaderSize ) );
+            // records are carved back-to-back, so keep each one aligned as alloc() would
+            lenWHdr = ( lenWHdr + 3 ) & 0xfffffffc;
+
+            docs.push_back( obj );
+            lens.push_back( lenWHdr );
+            totalLenWHdr += lenWHdr;
+        }
+
+        // The reservation has to come out of one extent; outsized batches take the
+        // regular path.
+        if ( totalLenWHdr > Extent::maxSize() / 2 )
+            return false;
+
+        DiskLoc regionLoc = allocateSpaceForANewRecord( ns, d, (int)totalLenWHdr, false );
+        if ( regionLoc.isNull() )
+            return false;
+
+        const int regionLen = regionLoc.rec()->lengthWithHeaders();
+        const int extentOfs = regionLoc.rec()->extentOfs();
+        verify( regionLen >= totalLenWHdr );
+
+        // alloc() may quantize the reservation up; split the slop back off for further
+        // use unless it is too small to stand alone as a deleted record, in which case
+        // the last record absorbs it as padding.
+        int usedLen = (int)totalLenWHdr;
+        const int leftover = regionLen - usedLen;
+        if ( leftover < 24 ) {
+            lens.back() += leftover;
+            usedLen = regionLen;
+        }
+        else {
+            DiskLoc slopLoc = regionLoc;
+            slopLoc.inc( usedLen );
+            DeletedRecord* slop = getDeletedRecord( slopLoc );
+            DeletedRecord* slopW = getDur().writing( slop );
+            slopW->extentOfs() = extentOfs;
+            slopW->lengthWithHeaders() = leftover;
+            slopW->nextDeleted().Null();
+            d->addDeletedRec( slop, slopLoc );
+        }
+
+        // One intent range covers every record header and body in the batch.
+        char* base = (char*) getDur().writingPtr( regionLoc.rec(), usedLen );
+        {
+            int offset = 0;
+            for ( size_t i = 0; i < docs.size(); i++ ) {
+                Record* r = (Record*)( base + offset );
+                r->lengthWithHeaders() = lens[i];
+                r->extentOfs() = extentOfs;
+                memcpy( r->data(), docs[i].objdata(), docs[i].objsize() );
+                offset += lens[i];
+            }
+        }
+
+        // Link and index the records in order.  On an index error (e.g. a duplicate
+        // _id) the offending record is rolled back and the batch's unused tail goes
+        // back to the freelist before the exception escapes; the documents already in
+        // stay put, matching a sequence of single inserts.
+        int offset = 0;
+        size_t i = 0;
+        try {
+            for ( ; i < docs.size(); i++ ) {
+                DiskLoc loc = regionLoc;
+                loc.inc( offset );
+                Record* r = (Record*)( base + offset );
+
+                addRecordToRecListInExtent( r, loc );
+                d->incrementStats( r->netLength(), 1 );
+
+                if ( d->getTotalIndexCount() > 0 ) {
+                    try {
+                        indexRecord( ns, d, docs[i], loc );
+                    }
+                    catch ( AssertionException& ) {
+                        _deleteRecord( d, ns, r, loc );
+                        throw;
+                    }
+                }
+
+                inserted->push_back( docs[i] );
+                offset += lens[i];
+            }
+        }
+        catch ( ... ) {
+            // not just AssertionException: a page fault mid-batch must not leave the
+            // unlinked remainder of the reservation off the freelist
+            const int tailOfs = offset + lens[i];
+            const int tailLen = usedLen - tailOfs;
+            if ( tailLen > 0 ) {
+                DiskLoc tailLoc = regionLoc;
+                tailLoc.inc( tailOfs );
+                DeletedRecord* tail = getDeletedRecord( tailLoc );
+                DeletedRecord* tailW = getDur().writing( tail );
+                tailW->extentOfs() = extentOfs;
+                tailW->lengthWithHeaders() = tailLen;
+                tailW->nextDeleted().Null();
+                d->addDeletedRec( tail, tailLoc );
+            }
+            throw;
+        }
+
+        NamespaceDetailsTransient::get( ns ).notifyOfWriteOp();
+        d->paddingFits();
+
+        return true;
+    }
+
     /* special version of insert for transaction logging -- streamlined a bit.
        assumes ns is capped and no indexes
     */
-    Record* DataFileMgr::fast_oplog_insert(NamespaceDetails *d, const char *ns, int len) {
+    Record* DataFileMgr::fast_oplog_insert(NamespaceDetails *d, const char *ns, int len,
+                                           DiskLoc* locOut) {
         verify( d );
         RARELY verify( d == nsdetails(ns) );
         DEV verify( d == nsdetails(ns) );
@@ -1074,6 +1254,8 @@ namespace mongo {
         int lenWHdr = len + Record::HeaderSize;
         DiskLoc loc = d->alloc(ns, lenWHdr);
         verify( !loc.isNull() );
+        if ( locOut )
+            *locOut = loc;
 
         Record *r = loc.rec();
         verify( r->lengthWithHeaders() >= lenWHdr );
@@ -1138,6 +1320,8 @@ namespace mongo {
 
         getDur().syncDataAndTruncateJournal();
 
+        PlanCache::clearForDatabase( db );
+
         Database::closeDatabase( d->name(), d->path() );
         d = 0; // d is now deleted
 
@@ -58,6 +58,7 @@ namespace mongo {
 
     class Cursor;
     class DataFileHeader;
+    class DeferredIndexUpdates;
     class Extent;
     class OpDebug;
     class Record;
@@ -81,12 +82,16 @@ namespace mongo {
 
         /** @return DiskLoc where item ends up */
         // changedId should be initialized to false
+        // if deferredIndexUpdates is non-NULL, the in-place path queues key-level
+        // changes to dups-allowed indexes there instead of applying them; the caller
+        // must flush() before yielding (see DeferredIndexUpdates)
         const DiskLoc updateRecord(
             const char *ns,
             NamespaceDetails *d,
             NamespaceDetailsTransient *nsdt,
             Record *toupdate, const DiskLoc& dl,
-            const char *buf, int len, OpDebug& debug, bool god=false);
+            const char *buf, int len, OpDebug& debug, bool god=false,
+            DeferredIndexUpdates* deferredIndexUpdates=NULL);
 
         // The object o may be updated if modified on insert.
         void insertAndLog( const char *ns, const BSONObj &o, bool god = false, bool fromMigrate = false );
@@ -121,13 +126,33 @@ namespace mongo {
                        bool god = false,
                        bool mayAddIndex = true,
                        bool* addedID = 0);
+
+        /**
+         * Append-mode bulk insert.  Space for the whole batch is reserved with a single
+         * allocation, the records are laid out contiguously inside it with the
+         * collection's usual padding policy, and durability notes one intent range
+         * covering all of the record data -- so loads are bound by sequential writes
+         * instead of the per-document freelist search.
+         * note: does NOT put on oplog.  @param inserted receives the final documents
+         * (with any added _id) in insertion order; if an index error escapes after a
+         * prefix of the batch went in, 'inserted' holds exactly that prefix.
+         * @return false without inserting anything if the batch must take the regular
+         * insert() path (capped or system collections, collection not yet created,
+         * batch too large for one extent).
+         */
+        bool insertBatch(const char* ns,
+                         const vector<BSONObj>& objs,
+                         vector<BSONObj>* inserted);
+
         static shared_ptr<Cursor> findAll(const StringData& ns, const DiskLoc &startLoc = DiskLoc());
 
         /* special version of insert for transaction logging -- streamlined a bit.
            assumes ns is capped and no indexes
            no _id field check
         */
-        Record* fast_oplog_insert(NamespaceDetails *d, const char *ns, int len);
+        /** @param locOut if non-NULL, receives the location of the new record */
+        Record* fast_oplog_insert(NamespaceDetails *d, const char *ns, int len,
+                                  DiskLoc* locOut = NULL);
 
         static Extent* getExtent(const DiskLoc& dl);
         static Record* getRecord(const DiskLoc& dl);
@@ -34,15 +34,28 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/field_path.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
     using namespace mongoutils;
 
+    unsigned long long DocumentStorage::nextLayoutToken() {
+        static AtomicUInt64 source;
+        return source.addAndFetch(1);
+    }
+
     Position DocumentStorage::findField(StringData requested) const {
         int reqSize = requested.size(); // get size calculation out of the way if needed
 
         if (_numFields >= HASH_TAB_MIN) { // hash lookup
+            if (_hashTabStale) {
+                // appendField() defers table maintenance; build the whole table in
+                // one pass now that a lookup actually needs it
+                const_cast<DocumentStorage*>(this)->rehash();
+                _hashTabStale = false;
+            }
+
             const unsigned bucket = bucketForKey(requested);
 
             Position pos = _hashTab[bucket];
@@ -99,12 +112,10 @@ namespace mongo {
 
         _numFields++;
 
-        if (_numFields > HASH_TAB_MIN) {
-            addFieldToHashTable(pos);
-        }
-        else if (_numFields == HASH_TAB_MIN) {
-            // adds all fields to hash table (including the one we just added)
-            rehash();
+        if (_numFields >= HASH_TAB_MIN) {
+            // defer hashing to findField(); conversion-heavy paths append every
+            // field up front and many documents are never looked up by name
+            _hashTabStale = true;
         }
 
         return getField(pos).val;
@@ -152,8 +163,9 @@ namespace mongo {
 
             if (_numFields >= HASH_TAB_MIN) {
                 // if we were hashing, deal with the hash table
-                if (doingRehash) {
-                    rehash();
+                if (doingRehash || _hashTabStale) {
+                    // findField() rebuilds the table on the next lookup
+                    _hashTabStale = true;
                 }
                 else {
                     // no rehash needed so just slide table down to new position
@@ -195,6 +207,10 @@ namespace mongo {
         out->_usedBytes = _usedBytes;
         out->_numFields = _numFields;
         out->_hashTabMask = _hashTabMask;
+        out->_hashCache = _hashCache;
+        out->_hashCacheValid = _hashCacheValid;
+        out->_hashTabStale = _hashTabStale;
+        out->_layoutToken = _layoutToken; // same bytes, same layout
 
         // Tell values that they have been memcpyed (updates ref counts)
         for (DocumentStorageIterator it = out->iteratorAll(); !it.atEnd(); it.advance()) {
@@ -224,6 +240,23 @@ namespace mongo {
         *this = md.freeze();
     }
 
+    Document::Document(const BSONObj& bson, const BSONObj& ownerObj) {
+        MutableDocument md(bson.nFields());
+
+        BSONObjIterator it(bson);
+        while(it.more()) {
+            BSONElement bsonElement(it.next());
+            md.addField(bsonElement.fieldNameStringData(), Value(bsonElement, ownerObj));
+        }
+
+        *this = md.freeze();
+    }
+
+    Document Document::fromSharedBson(const BSONObj& bson) {
+        const BSONObj owned = bson.getOwned(); // no-op if already owned
+        return Document(owned, owned);
+    }
+
     BSONObjBuilder& operator << (BSONObjBuilderValueStream& builder, const Document& doc) {
         BSONObjBuilder subobj(builder.subobjStart());
         doc.toBson(&subobj);
@@ -290,7 +323,7 @@ namespace mongo {
                                       vector<Position>* positions,
                                       size_t level) {
 
-        const string& fieldName = fieldNames.getFieldName(level);
+        const StringData fieldName = fieldNames.getFieldName(level);
         const Position pos = doc.positionOf(fieldName);
 
         if (!pos.found())
@@ -330,12 +363,27 @@ namespace mongo {
         return size;
     }
 
-    void Document::hash_combine(size_t &seed) const {
-        for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
+    size_t DocumentStorage::hash() const {
+        if (_hashCacheValid)
+            return _hashCache;
+
+        size_t seed = 0;
+        for (DocumentStorageIterator it = iterator(); !it.atEnd(); it.advance()) {
             StringData name = it->nameSD();
             boost::hash_range(seed, name.rawData(), name.rawData() + name.size());
             it->val.hash_combine(seed);
         }
+
+        // emptyDoc() lives in const storage, so never write the cache there
+        if (_buffer) {
+            _hashCache = seed;
+            _hashCacheValid = true;
+        }
+        return seed;
+    }
+
+    void Document::hash_combine(size_t &seed) const {
+        boost::hash_combine(seed, storage().hash());
     }
 
     int Document::compare(const Document& rL, const Document& rR) {
@@ -71,12 +71,35 @@ namespace mongo {
         /// Create a new Document deep-converted from the given BSONObj.
         explicit Document(const BSONObj& bson);
 
+        /** Create a new Document sharing string storage with the given BSONObj.
+         *
+         *  Large string values alias bson's buffer instead of each being copied into
+         *  its own allocation, and keep the buffer alive as long as they exist.  bson
+         *  is promoted with getOwned() first if it doesn't already own its buffer.
+         */
+        static Document fromSharedBson(const BSONObj& bson);
+
+        /// Used by fromSharedBson() and Value to alias string data out of ownerObj
+        Document(const BSONObj& bson, const BSONObj& ownerObj);
+
         void swap(Document& rhs) { _storage.swap(rhs._storage); }
 
         /// Look up a field by key name. Returns Value() if no such field. O(1)
         const Value operator[] (StringData key) const { return getField(key); }
         const Value getField(StringData key) const { return storage().getField(key); }
 
+        /** Look up a field by key name, maintaining *hint across calls.  Start
+         *  with a default PositionHint; when this document's storage is the one
+         *  the hint came from (or a clone of it) the lookup is hash-free.  A hint
+         *  from any other layout is ignored.  See findFieldWithHint.
+         */
+        const Value getField(StringData key, PositionHint* hint) const {
+            Position pos = storage().findFieldWithHint(key, hint);
+            if (!pos.found())
+                return Value();
+            return storage().getField(pos).val;
+        }
+
         /// Look up a field by Position. See positionOf and getNestedField.
         const Value operator[] (Position pos) const { return getField(pos); }
         const Value getField(Position pos) const { return storage().getField(pos).val; }
@@ -133,6 +156,12 @@ namespace mongo {
          */
         void hash_combine(size_t &seed) const;
 
+        /** If a structural hash for this document has already been computed (by
+         *  hash_combine or a hashed container), return true and set *out to it.
+         *  Equal documents hash equally, so differing hashes prove inequality.
+         */
+        bool getCachedHash(size_t* out) const { return storage().getCachedHash(out); }
+
         /// Add this document to the BSONObj under construction with the given BSONObjBuilder.
         void toBson(BSONObjBuilder *pBsonObjBuilder) const;
         BSONObj toBson() const;
@@ -180,10 +209,13 @@ namespace mongo {
     };
 
     inline bool operator== (const Document& l, const Document& r) {
+        size_t lh, rh;
+        if (l.getCachedHash(&lh) && r.getCachedHash(&rh) && lh != rh)
+            return false;
         return Document::compare(l, r) == 0;
     }
     inline bool operator!= (const Document& l, const Document& r) {
-        return Document::compare(l, r) != 0;
+        return !(l == r);
     }
     inline bool operator<  (const Document& l, const Document& r) {
         return Document::compare(l, r) <  0;
@@ -391,6 +423,9 @@ namespace mongo {
             if (MONGO_unlikely( _storage->isShared() ))
                 return clonedStorage();
 
+            // handing out mutable access, so any cached structural hash may go stale
+            storagePtr()->invalidateHash();
+
             // This function exists to ensure this is safe
             return const_cast<DocumentStorage&>(*storagePtr());
         }
@@ -400,6 +435,7 @@ namespace mongo {
         }
         DocumentStorage& clonedStorage() {
             reset(storagePtr()->clone().get());
+            storagePtr()->invalidateHash(); // clone() copies the cache
             return const_cast<DocumentStorage&>(*storagePtr());
         }
 
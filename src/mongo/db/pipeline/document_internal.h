@@ -58,6 +58,20 @@ namespace mongo {
         friend class DocumentStorageIterator;
     };
 
+    /** A Position remembered across lookups, together with the layout token of the
+     *  storage it was found in.  DocumentStorage only honors a hint whose token
+     *  matches its own, so a stale hint can never be applied to a document laid
+     *  out differently than the one it came from.
+     */
+    class PositionHint {
+    public:
+        PositionHint() : _token(0) {} // 0 never matches a real storage
+    private:
+        unsigned long long _token;
+        Position _pos;
+        friend class DocumentStorage;
+    };
+
 #pragma pack(1)
     /** This is how values are stored in the DocumentStorage buffer
      *  Internal class. Consumers shouldn't care about this.
@@ -166,6 +180,10 @@ namespace mongo {
                           , _usedBytes(0)
                           , _numFields(0)
                           , _hashTabMask(0)
+                          , _hashCache(0)
+                          , _hashCacheValid(false)
+                          , _hashTabStale(false)
+                          , _layoutToken(nextLayoutToken())
         {}
         ~DocumentStorage();
 
@@ -188,6 +206,28 @@ namespace mongo {
         /// Returns the position of the named field (may be missing) or Position()
         Position findField(StringData name) const;
 
+        /** findField for callers keeping a PositionHint across lookups.  When the
+         *  hint was produced by a storage with this exact layout (the same
+         *  instance, or a clone of it), the lookup is a token compare and a name
+         *  compare, with no field-name hashing.  Hints from any other layout are
+         *  ignored: a raw position carried over from a differently laid out
+         *  document could point into the middle of an element, and buffer bytes
+         *  there must never be reinterpreted as a ValueElement, however plausible
+         *  they look.
+         */
+        Position findFieldWithHint(StringData name, PositionHint* hint) const {
+            if (_layoutToken && hint->_token == _layoutToken
+                && getField(hint->_pos).nameSD() == name) {
+                return hint->_pos;
+            }
+            Position pos = findField(name);
+            if (pos.found()) {
+                hint->_token = _layoutToken;
+                hint->_pos = pos;
+            }
+            return pos;
+        }
+
         // Document uses these
         const ValueElement& getField(Position pos) const {
             verify(pos.found());
@@ -233,6 +273,23 @@ namespace mongo {
         /// Shallow copy of this. Caller owns memory.
         intrusive_ptr<DocumentStorage> clone() const;
 
+        /**
+         * Structural hash over all (name, value) pairs, cached after the first
+         * computation. Equal documents hash equally, so containers can reject
+         * membership on a hash mismatch without a field-by-field walk.
+         */
+        size_t hash() const;
+
+        /// @return true and set *out if hash() has been computed and is still valid
+        bool getCachedHash(size_t* out) const {
+            if (_hashCacheValid)
+                *out = _hashCache;
+            return _hashCacheValid;
+        }
+
+        /// Call whenever mutable access to the storage is handed out.
+        void invalidateHash() const { _hashCacheValid = false; }
+
         size_t allocatedBytes() const {
             return !_buffer ? 0 : (_bufferEnd - _buffer + hashTabBytes());
         }
@@ -265,6 +322,9 @@ namespace mongo {
             return out;
         }
 
+        /// Source of _layoutToken values; never returns 0.
+        static unsigned long long nextLayoutToken();
+
         unsigned bucketForKey(StringData name) const {
             return hashKey(name) & _hashTabMask;
         }
@@ -305,6 +365,26 @@ namespace mongo {
         unsigned _usedBytes; // position where next field would start
         unsigned _numFields; // this includes removed fields
         unsigned _hashTabMask; // equal to hashTabBuckets()-1 but used more often
+
+        // cached result of hash(); mutable because the lazy computation happens inside
+        // logically-const lookups, like the field-name hash table above
+        mutable size_t _hashCache;
+        mutable bool _hashCacheValid;
+
+        // appendField() no longer maintains the hash table; it just sets this flag and
+        // findField() rebuilds the table in one pass when a lookup actually needs it.
+        // That way converting a BSONObj hashes nothing, and documents that are only
+        // iterated (e.g. streamed through the pipeline in batches and serialized)
+        // never hash their field names at all.  mutable because the deferred build
+        // happens inside logically-const lookups; storage is not shared across threads.
+        mutable bool _hashTabStale;
+
+        // Identifies this layout for PositionHint validation.  Assigned from a
+        // global counter at construction and shared only by clone(), which copies
+        // the buffer byte for byte; never 0, so emptyDoc() (zeroed bytes) can't
+        // match a hint.  Positions stay valid across appendField -- elements
+        // never move -- so mutation doesn't need to bump the token.
+        unsigned long long _layoutToken;
         // When adding a field, make sure to update clone() method
     };
 }
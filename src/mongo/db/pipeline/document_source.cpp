@@ -42,6 +42,26 @@ namespace mongo {
         nRowsOut(0) {
     }
 
+    const size_t DocumentSource::kDefaultBatchDocs;
+    const size_t DocumentSource::kMaxBatchDocs;
+
+    bool DocumentSource::getNextBatch(DocumentBatch* batch, size_t maxDocs) {
+        if (maxDocs > kMaxBatchDocs)
+            maxDocs = kMaxBatchDocs;
+
+        size_t nAdded = 0;
+        while (nAdded < maxDocs) {
+            boost::optional<Document> next = getNext();
+            if (!next)
+                break;
+
+            batch->push_back(*next);
+            nAdded++;
+        }
+
+        return nAdded > 0;
+    }
+
     const char *DocumentSource::getSourceName() const {
         static const char unknown[] = "[UNKNOWN]";
         return unknown;
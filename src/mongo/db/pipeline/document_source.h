@@ -31,21 +31,25 @@
 #include "mongo/pch.h"
 
 #include <boost/optional.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/unordered_map.hpp>
 #include <deque>
 
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher.h"
+#include "mongo/db/op_memory.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/projection.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/shard.h"
 #include "mongo/s/strategy.h"
 #include "mongo/util/intrusive_counter.h"
+#include "mongo/util/queue.h"
 
 namespace mongo {
     class Accumulator;
@@ -56,6 +60,9 @@ namespace mongo {
     class ExpressionObject;
     class DocumentSourceLimit;
 
+    /// A batch of pipeline output. See DocumentSource::getNextBatch().
+    typedef std::vector<Document> DocumentBatch;
+
     class DocumentSource : public IntrusiveCounterUnsigned {
     public:
         virtual ~DocumentSource() {}
@@ -81,6 +88,20 @@ namespace mongo {
          */
         virtual boost::optional<Document> getNext() = 0;
 
+        /** Appends up to maxDocs Documents to 'batch' and returns true, or returns
+         *  false without touching 'batch' if this source is at EOF.
+         *
+         *  The default implementation just loops over getNext().  Sources that
+         *  materialize documents in bulk (notably the $cursor source) override this
+         *  to hand out a whole batch for the cost of a single virtual call, which
+         *  matters for consumers that would otherwise pay one call per document.
+         */
+        virtual bool getNextBatch(DocumentBatch* batch, size_t maxDocs = kDefaultBatchDocs);
+
+        /// Default and maximum number of Documents per getNextBatch() call.
+        static const size_t kDefaultBatchDocs = 128;
+        static const size_t kMaxBatchDocs = 256;
+
         /**
          * Inform the source that it is no longer needed and may release its resources.  After
          * dispose() is called the source must still be able to handle iteration requests, but may
@@ -267,6 +288,14 @@ namespace mongo {
 
             virtual bool isCapped(const NamespaceString& ns) = 0;
 
+            /**
+             * Performs the per-thread client setup required before directClient() may be used
+             * from a worker thread spawned by a document source, and the matching teardown.
+             * directClient() must still never be used from two threads at once.
+             */
+            virtual void initializeWorkerThread() = 0;
+            virtual void terminateWorkerThread() = 0;
+
             // Add new methods as needed.
         };
 
@@ -375,6 +404,7 @@ namespace mongo {
         // virtuals from DocumentSource
         virtual ~DocumentSourceCursor();
         virtual boost::optional<Document> getNext();
+        virtual bool getNextBatch(DocumentBatch* batch, size_t maxDocs = kDefaultBatchDocs);
         virtual const char *getSourceName() const;
         virtual Value serialize(bool explain = false) const;
         virtual void setSource(DocumentSource *pSource);
@@ -599,7 +629,7 @@ namespace mongo {
         /// Spill groups map to disk and returns an iterator to the file.
         shared_ptr<Sorter<Value, Value>::Iterator> spill();
 
-        // Only used by spill. Would be function-local if that were legal in C++03.
+        // Only used by the spill paths. Would be function-local if that were legal in C++03.
         class SpillSTLComparator;
 
         /*
@@ -617,6 +647,16 @@ namespace mongo {
         typedef boost::unordered_map<Value, Accumulators, Value::Hash> GroupsMap;
         GroupsMap groups;
 
+        /// Spill roughly the biggest half (by memory held) of the groups map, keeping the
+        /// rest accumulating in memory.  Returns an iterator to the file; *freedBytes is
+        /// set to the amount of memory released.
+        shared_ptr<Sorter<Value, Value>::Iterator> spillLargest(int* freedBytes);
+
+        /// Write the given (key-ordered) groups to a temp file.  Shared by the spill paths;
+        /// doesn't remove anything from the groups map.
+        shared_ptr<Sorter<Value, Value>::Iterator> writeSpillFile(
+            const vector<const GroupsMap::value_type*>& ptrs);
+
         /*
           The field names for the result documents and the accumulator
           factories for the result documents.  The Expressions are the
@@ -641,6 +681,9 @@ namespace mongo {
         const bool _extSortAllowed;
         const int _maxMemoryUsageBytes;
 
+        // Charges the groups map's memory against the op's budget (see db/op_memory.h).
+        opmem::OpMemoryCharge _memCharge;
+
         // only used when !_spilled
         GroupsMap::iterator groupsIterator;
 
@@ -782,10 +825,35 @@ namespace mongo {
 
         void spill(DBClientBase* conn, const vector<BSONObj>& toInsert);
 
+        // A batch of documents bound for _tempNs, handed from the pipeline thread to the
+        // writer thread through _batches.  An "eof" batch tells the writer to finish.
+        struct Batch {
+            Batch() : eof(false) {}
+            bool eof;
+            vector<BSONObj> objs;
+        };
+
+        // Entry point of the writer thread.  Pops batches off _batches and inserts them
+        // until the eof batch arrives; a failed insert is remembered in _writeErrMsg and
+        // the remaining batches are drained so the pipeline thread never blocks.
+        void writeThread();
+
+        // Pushes the eof batch and joins the writer thread.  Safe to call repeatedly.
+        void joinWriteThread();
+
+        // Creates _outputNs's indexes on _tempNs.  Called once all data has been inserted
+        // so each index is built bottom-up rather than maintained on every insert.
+        void copyIndexes(DBClientBase* conn);
+
         bool _done;
 
         NamespaceString _tempNs; // output goes here as it is being processed.
         const NamespaceString _outputNs; // output will go here after all data is processed.
+
+        BlockingQueue<Batch> _batches; // bounded; the pipeline thread blocks when it is full.
+        boost::scoped_ptr<boost::thread> _writer;
+        AtomicUInt32 _writeFailed; // nonzero once the writer thread has hit an error.
+        string _writeErrMsg; // only read after joining the writer thread.
     };
 
     
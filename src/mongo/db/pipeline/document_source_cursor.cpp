@@ -63,6 +63,29 @@ namespace mongo {
         return out;
     }
 
+    bool DocumentSourceCursor::getNextBatch(DocumentBatch* batch, size_t maxDocs) {
+        pExpCtx->checkForInterrupt();
+
+        if (_currentBatch.empty()) {
+            loadBatch();
+
+            if (_currentBatch.empty()) // exhausted the cursor
+                return false;
+        }
+
+        // Hand out everything loadBatch() materialized (up to maxDocs) in one go
+        // rather than paying a virtual call per document.
+        if (maxDocs > kMaxBatchDocs)
+            maxDocs = kMaxBatchDocs;
+
+        for (size_t i = 0; i < maxDocs && !_currentBatch.empty(); i++) {
+            batch->push_back(_currentBatch.front());
+            _currentBatch.pop_front();
+        }
+
+        return true;
+    }
+
     void DocumentSourceCursor::dispose() {
         if (_cursorId) {
             ClientCursor::erase(_cursorId);
@@ -145,9 +168,12 @@ namespace mongo {
                     if ( !_collMetadata->keyBelongsToMe( kp.extractSingleKey( next ) ) ) continue;
                 }
 
+                // fromSharedBson() takes one owned copy of the whole object and lets its
+                // large string fields alias that buffer, rather than copying each string
+                // field into an allocation of its own.
                 _currentBatch.push_back(_projection
                                             ? documentFromBsonWithDeps(next, _dependencies)
-                                            : Document(next));
+                                            : Document::fromSharedBson(next));
             }
 
             if (_limit) {
@@ -64,7 +64,7 @@ namespace mongo {
                 // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
                 // At loop exit, it is the first value to be processed in the next group.
 
-                switch (numAccumulators) { // mirrors switch in spill()
+                switch (numAccumulators) { // mirrors switch in writeSpillFile()
                 case 0: // no Accumulators so no Values
                     break;
 
@@ -112,6 +112,7 @@ namespace mongo {
     void DocumentSourceGroup::dispose() {
         // free our resources
         GroupsMap().swap(groups);
+        _memCharge.set(0);
         _sorterIterator.reset();
 
         // make us look done
@@ -171,6 +172,7 @@ namespace mongo {
         , _spilled(false)
         , _extSortAllowed(pExpCtx->extSortAllowed && !pExpCtx->inRouter)
         , _maxMemoryUsageBytes(100*1024*1024)
+        , _memCharge(opmem::ClassGroup)
     {}
 
     void DocumentSourceGroup::addAccumulator(
@@ -356,8 +358,12 @@ namespace mongo {
             if (memoryUsageBytes > _maxMemoryUsageBytes) {
                 uassert(16945, "Exceeded memory limit for $group, but didn't allow external sort",
                         _extSortAllowed);
-                sortedFiles.push_back(spill());
-                memoryUsageBytes = 0;
+                // Push the groups holding the most memory to disk and keep the rest, so
+                // frequently-hit groups keep accumulating in memory rather than being
+                // rebuilt from scratch after every spill.
+                int freedBytes = 0;
+                sortedFiles.push_back(spillLargest(&freedBytes));
+                memoryUsageBytes -= freedBytes;
             }
 
             const Variables vars(*input);
@@ -399,6 +405,9 @@ namespace mongo {
                 memoryUsageBytes += group[i]->memUsageForSorter();
             }
 
+            // Throws if this pushes the op (or the server) over its memory budget.
+            _memCharge.set(memoryUsageBytes);
+
             DEV {
                 // In debug mode, spill every time we have a duplicate id to stress merge logic.
                 if (!inserted // is a dup
@@ -420,6 +429,7 @@ namespace mongo {
 
             // We won't be using groups again so free its memory.
             GroupsMap().swap(groups);
+            _memCharge.set(0);
 
             _sorterIterator.reset(
                     Sorter<Value,Value>::Iterator::merge(
@@ -457,6 +467,60 @@ namespace mongo {
 
         stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator());
 
+        shared_ptr<Sorter<Value, Value>::Iterator> iter = writeSpillFile(ptrs);
+        groups.clear();
+        return iter;
+    }
+
+    namespace {
+        struct FirstGreater {
+            template <typename T>
+            bool operator() (const T& lhs, const T& rhs) const { return lhs.first > rhs.first; }
+        };
+    }
+
+    shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spillLargest(
+            int* freedBytes) {
+        // Rank the groups by how much memory each one holds.
+        typedef pair<size_t, const GroupsMap::value_type*> SizedGroup;
+        vector<SizedGroup> sized;
+        sized.reserve(groups.size());
+        size_t totalBytes = 0;
+        for (GroupsMap::const_iterator it=groups.begin(), end=groups.end(); it != end; ++it) {
+            size_t bytes = it->first.getApproximateSize();
+            for (size_t i = 0; i < it->second.size(); i++) {
+                bytes += it->second[i]->memUsageForSorter();
+            }
+            sized.push_back(make_pair(bytes, &*it));
+            totalBytes += bytes;
+        }
+
+        sort(sized.begin(), sized.end(), FirstGreater());
+
+        // Take the biggest ones until about half the table's footprint is going to disk.
+        // A group spilled more than once is merged back together on drain, the same as
+        // group fragments from separate full spills.
+        vector<const GroupsMap::value_type*> toSpill;
+        size_t freed = 0;
+        for (size_t i = 0; i < sized.size() && freed * 2 < totalBytes; i++) {
+            toSpill.push_back(sized[i].second);
+            freed += sized[i].first;
+        }
+
+        stable_sort(toSpill.begin(), toSpill.end(), SpillSTLComparator());
+        shared_ptr<Sorter<Value, Value>::Iterator> iter = writeSpillFile(toSpill);
+
+        for (size_t i = 0; i < toSpill.size(); i++) {
+            const Value id = toSpill[i]->first; // don't erase with a reference into the node
+            groups.erase(id);
+        }
+
+        *freedBytes = freed;
+        return iter;
+    }
+
+    shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::writeSpillFile(
+            const vector<const GroupsMap::value_type*>& ptrs) {
         SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
         switch (vpAccumulatorFactory.size()) { // same as ptrs[i]->second.size() for all i.
         case 0: // no values, essentially a distinct
@@ -483,8 +547,6 @@ namespace mongo {
             break;
         }
 
-        groups.clear();
-
         return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
     }
 
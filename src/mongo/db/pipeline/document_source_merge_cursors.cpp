@@ -122,7 +122,9 @@ namespace mongo {
             _currentCursor = _cursors.begin();
         }
 
-        // purge eof cursors and release their connections
+        // purge eof cursors and release their connections.  more() first receives a
+        // prefetched batch if one is on the wire (see below), so this blocks only when
+        // that batch hasn't arrived yet.
         while (!_cursors.empty() && !(*_currentCursor)->cursor.more()) {
             (*_currentCursor)->connection.done();
             _cursors.erase(_currentCursor);
@@ -138,9 +140,18 @@ namespace mongo {
                                      << ": " << next,
                 !next.hasField("$err"));
 
-        // advance _currentCursor, wrapping if needed
-        if (++_currentCursor == _cursors.end())
-            _currentCursor = _cursors.begin();
+        // serve out the rest of this cursor's buffered batch before switching shards;
+        // once it drains, put its next getMore on the wire immediately so the round
+        // trip overlaps with consuming the other shards' batches.  interleaving order
+        // across shards carries no meaning, so batch granularity is fine.
+        if (!(*_currentCursor)->cursor.moreInCurrentBatch()) {
+            if (!(*_currentCursor)->cursor.isDead())
+                (*_currentCursor)->cursor.prefetchMore();
+
+            // advance _currentCursor, wrapping if needed
+            if (++_currentCursor == _cursors.end())
+                _currentCursor = _cursors.begin();
+        }
 
         return Document(next);
     }
@@ -35,6 +35,10 @@ namespace mongo {
 
     DocumentSourceOut::~DocumentSourceOut() {
         DESTRUCTOR_GUARD(
+            // If an exception interrupted getNext() the writer thread may still be running;
+            // it must be stopped before the temp collection can be dropped.
+            joinWriteThread();
+
             // Make sure we drop the temp collection if anything goes wrong. Errors are ignored
             // here because nothing can be done about them. Additionally, if this fails and the
             // collection is left behind, it will be cleaned up next time the server is started.
@@ -78,7 +82,9 @@ namespace mongo {
                                          << _tempNs.ns() << "': " << info.toString(),
                     ok);
         }
+    }
 
+    void DocumentSourceOut::copyIndexes(DBClientBase* conn) {
         // copy indexes on _outputNs to _tempNs
         scoped_ptr<DBClientCursor> indexes(conn->getIndexes(_outputNs));
         while (indexes->more()) {
@@ -103,6 +109,39 @@ namespace mongo {
                 DBClientWithCommands::getLastErrorString(err).empty());
     }
 
+    void DocumentSourceOut::writeThread() {
+        _mongod->initializeWorkerThread();
+        DBClientBase* conn = _mongod->directClient();
+        while (true) {
+            Batch batch = _batches.blockingPop();
+            if (batch.eof)
+                break;
+
+            if (_writeFailed.load())
+                continue; // just draining; the error will be raised on the pipeline thread
+
+            try {
+                spill(conn, batch.objs);
+            }
+            catch (const DBException& e) {
+                _writeErrMsg = e.toString();
+                _writeFailed.store(1);
+            }
+        }
+        _mongod->terminateWorkerThread();
+    }
+
+    void DocumentSourceOut::joinWriteThread() {
+        if (!_writer)
+            return;
+
+        Batch eofBatch;
+        eofBatch.eof = true;
+        _batches.push(eofBatch);
+        _writer->join();
+        _writer.reset();
+    }
+
     boost::optional<Document> DocumentSourceOut::getNext() {
         pExpCtx->checkForInterrupt();
 
@@ -117,21 +156,37 @@ namespace mongo {
         prepTempCollection();
         verify(_tempNs.size() != 0);
 
-        vector<BSONObj> bufferedObjects;
+        // The inserts run on a separate thread so they overlap with upstream pipeline
+        // execution; this thread only converts documents and fills batches.
+        verify(!_writer);
+        _writer.reset(new boost::thread(boost::bind(&DocumentSourceOut::writeThread, this)));
+
+        Batch batch;
         int bufferedBytes = 0;
         while (boost::optional<Document> next = pSource->getNext()) {
+            if (_writeFailed.load())
+                break; // stop producing; the writer's error is raised below
+
             BSONObj toInsert = next->toBson();
             bufferedBytes += toInsert.objsize();
-            if (!bufferedObjects.empty() && bufferedBytes > BSONObjMaxUserSize) {
-                spill(conn, bufferedObjects);
-                bufferedObjects.clear();
+            if (!batch.objs.empty() && bufferedBytes > BSONObjMaxUserSize) {
+                _batches.push(batch);
+                batch.objs.clear();
                 bufferedBytes = toInsert.objsize();
             }
-            bufferedObjects.push_back(toInsert);
+            batch.objs.push_back(toInsert);
         }
 
-        if (!bufferedObjects.empty())
-            spill(conn, bufferedObjects);
+        if (!batch.objs.empty() && !_writeFailed.load())
+            _batches.push(batch);
+
+        joinWriteThread();
+        uassert(17549, str::stream() << "insert for $out failed: " << _writeErrMsg,
+                !_writeFailed.load());
+
+        // The indexes are created now that all data has been inserted, so they are built
+        // bottom-up instead of being maintained incrementally during the load.
+        copyIndexes(conn);
 
         // Checking again to make sure we didn't become sharded while running.
         uassert(17018, str::stream() << "namespace '" << _outputNs.ns()
@@ -161,6 +216,8 @@ namespace mongo {
         , _done(false)
         , _tempNs("") // filled in by prepTempCollection
         , _outputNs(outputNs)
+        , _batches(2) // one batch queued ahead of the writer bounds memory use
+        , _writeFailed(0)
     {}
 
     intrusive_ptr<DocumentSource> DocumentSourceOut::createFromBson(
@@ -232,8 +232,14 @@ namespace mongo {
         }
 
         // compound sort
+        // Index the key arrays extractKey() built directly rather than through
+        // Value::operator[], which bounds-checks and copies (refcounting) every
+        // element; this runs once per comparison in the sorter's heap.
+        const vector<Value>& lhsKey = lhs.getArray();
+        const vector<Value>& rhsKey = rhs.getArray();
+        dassert(lhsKey.size() == n && rhsKey.size() == n);
         for (size_t i = 0; i < n; i++) {
-            int cmp = Value::compare(lhs[i], rhs[i]);
+            int cmp = Value::compare(lhsKey[i], rhsKey[i]);
             if (cmp) {
                 /* if necessary, adjust the return value by the key ordering */
                 if (!vAscending[i])
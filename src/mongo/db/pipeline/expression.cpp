@@ -37,6 +37,7 @@
 #include "mongo/base/init.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/expression_bytecode.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/util/string_map.h"
@@ -824,8 +825,11 @@ namespace {
 
     intrusive_ptr<Expression> ExpressionObject::optimize() {
         for (FieldMap::iterator it(_expressions.begin()); it!=_expressions.end(); ++it) {
-            if (it->second)
+            if (it->second) {
                 it->second = it->second->optimize();
+                // arithmetic-only computed fields run much faster as flat bytecode
+                it->second = CompiledExpression::attempt(it->second);
+            }
         }
 
         return intrusive_ptr<Expression>(this);
@@ -1027,7 +1031,7 @@ namespace {
 
     void ExpressionObject::addField(const FieldPath &fieldPath,
                                     const intrusive_ptr<Expression> &pExpression) {
-        const string fieldPart = fieldPath.getFieldName(0);
+        const string fieldPart = fieldPath.getFieldName(0).toString();
         const bool haveExpr = _expressions.count(fieldPart);
 
         intrusive_ptr<Expression>& expr = _expressions[fieldPart]; // inserts if !haveExpr
@@ -1137,6 +1141,7 @@ namespace {
         , _baseVar(_fieldPath.getFieldName(0) == "CURRENT" ? CURRENT :
                    _fieldPath.getFieldName(0) == "ROOT" ?    ROOT :
                                                              OTHER)
+        , _posHints(_fieldPath.getPathLength())
     {}
 
     intrusive_ptr<Expression> ExpressionFieldPath::optimize() {
@@ -1176,12 +1181,15 @@ namespace {
         // Note this function is very hot so it is important that is is well optimized.
         // In particular, all return paths should support RVO.
 
+        // The per-level position hint makes the lookup hash-free whenever this
+        // document's layout matches the previous one's (the common case).
+        const Value val = input.getField(_fieldPath.getFieldName(index), &_posHints[index]);
+
         /* if we've hit the end of the path, stop */
         if (index == _fieldPath.getPathLength() - 1)
-            return input[_fieldPath.getFieldName(index)];
+            return val;
 
         // Try to dive deeper
-        const Value val = input[_fieldPath.getFieldName(index)];
         switch (val.getType()) {
         case Object:
             return evaluatePath(index+1, val.getDocument());
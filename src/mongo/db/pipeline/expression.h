@@ -224,6 +224,9 @@ namespace mongo {
         */
         virtual void addOperand(const intrusive_ptr<Expression> &pExpression);
 
+        /// The operands, in order; used by the bytecode compiler.
+        const ExpressionVector& getOperandList() const { return vpOperand; }
+
         // TODO split this into two functions
         virtual bool isAssociativeAndCommutative() const { return false; }
 
@@ -483,6 +486,14 @@ namespace mongo {
 
         const FieldPath _fieldPath;
         const BaseVar _baseVar;
+
+        // Per-path-level position hints into the documents being traversed,
+        // updated as a side effect of evaluatePath.  A hint only applies when
+        // the same storage (or a clone of it) comes through again -- e.g. a
+        // document fanned out to several consumers -- and is ignored otherwise.
+        // mutable because evaluation is logically const; expressions are never
+        // evaluated from multiple threads at once.
+        mutable vector<PositionHint> _posHints;
     };
 
 
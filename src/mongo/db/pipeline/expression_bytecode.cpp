@@ -0,0 +1,281 @@
+/**
+ * Copyright (c) 2013 10gen Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects for
+ * all of the code used other than as permitted herein. If you modify file(s)
+ * with this exception, you may extend this exception to your version of the
+ * file(s), but you are not obligated to do so. If you do not wish to do so,
+ * delete this exception statement from your version. If you delete this
+ * exception statement from all source files in the program, then also delete
+ * it in the license file.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/db/pipeline/expression_bytecode.h"
+
+#include <limits>
+
+namespace mongo {
+
+    namespace {
+
+        // More registers than any sane expression needs; compilation fails beyond this
+        // so execute() can keep the register file on the stack.
+        const int kMaxRegisters = 64;
+
+    } // namespace
+
+    intrusive_ptr<Expression> CompiledExpression::attempt(const intrusive_ptr<Expression>& tree) {
+        intrusive_ptr<CompiledExpression> compiled(new CompiledExpression());
+        compiled->_tree = tree;
+        compiled->_numRegisters = 0;
+
+        if (!compiled->compile(tree.get(), 0))
+            return tree;
+
+        // A lone constant or field path gains nothing from the interpreter.
+        if (compiled->_program.size() < 2)
+            return tree;
+
+        return compiled;
+    }
+
+    bool CompiledExpression::compile(Expression* node, int dest) {
+        if (dest >= kMaxRegisters)
+            return false;
+        if (dest + 1 > _numRegisters)
+            _numRegisters = dest + 1;
+
+        if (ExpressionConstant* constant = dynamic_cast<ExpressionConstant*>(node)) {
+            const Value v = constant->getValue();
+            Slot s;
+            s.l = 0;
+            s.d = 0;
+            switch (v.getType()) {
+            case NumberInt:    s.type = NumberInt;    s.l = v.getInt();    break;
+            case NumberLong:   s.type = NumberLong;   s.l = v.getLong();   break;
+            case NumberDouble: s.type = NumberDouble; s.d = v.getDouble(); break;
+            default:
+                return false;
+            }
+            Instruction ins = { LOAD_CONST, dest, static_cast<int>(_constants.size()), 0 };
+            _constants.push_back(s);
+            _program.push_back(ins);
+            return true;
+        }
+
+        if (dynamic_cast<ExpressionFieldPath*>(node)) {
+            Instruction ins = { LOAD_FIELD, dest, static_cast<int>(_fieldPaths.size()), 0 };
+            _fieldPaths.push_back(node);
+            _program.push_back(ins);
+            return true;
+        }
+
+        Op op;
+        if (dynamic_cast<ExpressionAdd*>(node))           op = ADD;
+        else if (dynamic_cast<ExpressionMultiply*>(node)) op = MUL;
+        else if (dynamic_cast<ExpressionSubtract*>(node)) op = SUB;
+        else if (dynamic_cast<ExpressionDivide*>(node))   op = DIV;
+        else if (dynamic_cast<ExpressionMod*>(node))      op = MOD;
+        else return false;
+
+        ExpressionNary* nary = static_cast<ExpressionNary*>(node);
+        const std::vector<intrusive_ptr<Expression> >& operands = nary->getOperandList();
+        if (operands.empty())
+            return false;
+
+        // Operands land in consecutive registers starting at dest; any temporaries a
+        // sub-expression needs sit above its own slot and are dead by the time the next
+        // operand compiles.
+        for (size_t i = 0; i < operands.size(); i++) {
+            if (!compile(operands[i].get(), dest + static_cast<int>(i)))
+                return false;
+        }
+
+        Instruction ins = { op, dest, dest, 0 };
+        if (ADD == op || MUL == op) {
+            ins.b = static_cast<int>(operands.size());
+        }
+        else {
+            ins.b = dest + 1;
+        }
+        _program.push_back(ins);
+        return true;
+    }
+
+    double CompiledExpression::slotDouble(const Slot& s) {
+        return s.type == NumberDouble ? s.d : static_cast<double>(s.l);
+    }
+
+    long long CompiledExpression::slotLong(const Slot& s) {
+        return s.type == NumberDouble ? static_cast<long long>(s.d) : s.l;
+    }
+
+    void CompiledExpression::setIntOrLong(Slot* s, long long v) {
+        // mirrors Value::createIntOrLong()
+        const int intValue = static_cast<int>(v);
+        s->type = (intValue == v) ? NumberInt : NumberLong;
+        s->l = v;
+    }
+
+    bool CompiledExpression::execute(const Variables& vars, Slot* result) const {
+        Slot regs[kMaxRegisters];
+
+        const size_t n = _program.size();
+        for (size_t i = 0; i < n; i++) {
+            const Instruction& ins = _program[i];
+
+            switch (ins.op) {
+            case LOAD_CONST:
+                regs[ins.dest] = _constants[ins.a];
+                break;
+
+            case LOAD_FIELD: {
+                const Value v = _fieldPaths[ins.a]->evaluateInternal(vars);
+                Slot& s = regs[ins.dest];
+                switch (v.getType()) {
+                case NumberInt:    s.type = NumberInt;    s.l = v.getInt();    break;
+                case NumberLong:   s.type = NumberLong;   s.l = v.getLong();   break;
+                case NumberDouble: s.type = NumberDouble; s.d = v.getDouble(); break;
+                default:
+                    // nulls, missing fields, dates, strings... take the tree walker
+                    return false;
+                }
+                break;
+            }
+
+            case ADD: {
+                // same parallel double/long accumulation as ExpressionAdd
+                double doubleTotal = 0;
+                long long longTotal = 0;
+                BSONType totalType = NumberInt;
+                for (int j = 0; j < ins.b; j++) {
+                    const Slot& s = regs[ins.a + j];
+                    totalType = Value::getWidestNumeric(totalType, s.type);
+                    doubleTotal += slotDouble(s);
+                    longTotal += slotLong(s);
+                }
+                Slot& out = regs[ins.dest];
+                if (totalType == NumberDouble) {
+                    out.type = NumberDouble;
+                    out.d = doubleTotal;
+                }
+                else if (totalType == NumberLong) {
+                    out.type = NumberLong;
+                    out.l = longTotal;
+                }
+                else {
+                    setIntOrLong(&out, longTotal);
+                }
+                break;
+            }
+
+            case MUL: {
+                double doubleProduct = 1;
+                long long longProduct = 1;
+                BSONType productType = NumberInt;
+                for (int j = 0; j < ins.b; j++) {
+                    const Slot& s = regs[ins.a + j];
+                    productType = Value::getWidestNumeric(productType, s.type);
+                    doubleProduct *= slotDouble(s);
+                    longProduct *= slotLong(s);
+                }
+                Slot& out = regs[ins.dest];
+                if (productType == NumberDouble) {
+                    out.type = NumberDouble;
+                    out.d = doubleProduct;
+                }
+                else if (productType == NumberLong) {
+                    out.type = NumberLong;
+                    out.l = longProduct;
+                }
+                else {
+                    setIntOrLong(&out, longProduct);
+                }
+                break;
+            }
+
+            case SUB: {
+                const Slot& lhs = regs[ins.a];
+                const Slot& rhs = regs[ins.b];
+                const BSONType diffType = Value::getWidestNumeric(rhs.type, lhs.type);
+                Slot& out = regs[ins.dest];
+                if (diffType == NumberDouble) {
+                    out.type = NumberDouble;
+                    out.d = slotDouble(lhs) - slotDouble(rhs);
+                }
+                else if (diffType == NumberLong) {
+                    out.type = NumberLong;
+                    out.l = slotLong(lhs) - slotLong(rhs);
+                }
+                else {
+                    setIntOrLong(&out, slotLong(lhs) - slotLong(rhs));
+                }
+                break;
+            }
+
+            case DIV: {
+                const double denom = slotDouble(regs[ins.b]);
+                if (denom == 0)
+                    return false; // the tree walker raises the user-facing error
+                Slot& out = regs[ins.dest];
+                out.type = NumberDouble;
+                out.d = slotDouble(regs[ins.a]) / denom;
+                break;
+            }
+
+            case MOD: {
+                const Slot& lhs = regs[ins.a];
+                const Slot& rhs = regs[ins.b];
+                // ExpressionMod's double handling has truncation subtleties; doubles
+                // and mod-by-zero take the tree walker.
+                if (lhs.type == NumberDouble || rhs.type == NumberDouble || rhs.l == 0)
+                    return false;
+                Slot& out = regs[ins.dest];
+                if (lhs.type == NumberLong || rhs.type == NumberLong) {
+                    out.type = NumberLong;
+                    out.l = lhs.l % rhs.l;
+                }
+                else {
+                    out.type = NumberInt;
+                    out.l = static_cast<int>(lhs.l) % static_cast<int>(rhs.l);
+                }
+                break;
+            }
+            }
+        }
+
+        *result = regs[0];
+        return true;
+    }
+
+    Value CompiledExpression::evaluateInternal(const Variables& vars) const {
+        Slot result;
+        if (execute(vars, &result)) {
+            switch (result.type) {
+            case NumberInt:  return Value(static_cast<int>(result.l));
+            case NumberLong: return Value(result.l);
+            default:         return Value(result.d);
+            }
+        }
+        return _tree->evaluateInternal(vars);
+    }
+
+} // namespace mongo
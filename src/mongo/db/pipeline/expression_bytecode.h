@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2013 10gen Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects for
+ * all of the code used other than as permitted herein. If you modify file(s)
+ * with this exception, you may extend this exception to your version of the
+ * file(s), but you are not obligated to do so. If you do not wish to do so,
+ * delete this exception statement from your version. If you delete this
+ * exception statement from all source files in the program, then also delete
+ * it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/pch.h"
+
+#include "mongo/db/pipeline/expression.h"
+
+namespace mongo {
+
+    /**
+     * A flat, register-based compilation of an arithmetic Expression tree.
+     *
+     * Tree evaluation pays a virtual call, an intrusive_ptr touch, and a boxed
+     * Value per operation.  For the arithmetic operators that dominate computed
+     * $project fields ($add, $subtract, $multiply, $divide, $mod over constants
+     * and field paths) we can instead run a tight interpreter loop over
+     * registers that hold unboxed int/long/double values.
+     *
+     * The compiled form keeps the original tree: whenever a runtime value falls
+     * outside the unboxed types (null, missing, dates, strings, arrays...) or an
+     * operator would raise, the interpreter abandons the document and re-runs
+     * the tree walker, which owns all of the exotic-type semantics and error
+     * messages.  Results are therefore bit-identical to tree evaluation.
+     */
+    class CompiledExpression : public Expression {
+    public:
+        /**
+         * Compile 'tree' if it is made entirely of supported operators, returning
+         * the wrapped expression; otherwise return 'tree' unchanged.  'tree' should
+         * already be optimized.
+         */
+        static intrusive_ptr<Expression> attempt(const intrusive_ptr<Expression>& tree);
+
+        // virtuals from Expression; all but evaluateInternal() defer to the tree.
+        virtual intrusive_ptr<Expression> optimize() { return this; }
+        virtual void addDependencies(set<string>& deps, vector<string>* path=NULL) const {
+            _tree->addDependencies(deps, path);
+        }
+        virtual Value serialize() const { return _tree->serialize(); }
+        virtual Value evaluateInternal(const Variables& vars) const;
+
+    private:
+        CompiledExpression() {}
+
+        enum Op {
+            LOAD_CONST, // dest = constant pool slot 'a'
+            LOAD_FIELD, // dest = field path pool entry 'a' evaluated on the document
+            ADD,        // dest = sum of registers a .. a+b-1
+            MUL,        // dest = product of registers a .. a+b-1
+            SUB,        // dest = register a - register b
+            DIV,        // dest = register a / register b
+            MOD         // dest = register a % register b
+        };
+
+        struct Instruction {
+            Op op;
+            int dest;
+            int a;
+            int b;
+        };
+
+        /** An unboxed register; 'type' is NumberInt, NumberLong or NumberDouble. */
+        struct Slot {
+            BSONType type;
+            long long l; // holds ints too
+            double d;
+        };
+
+        /** Recursive compile of 'node' targeting register 'dest'; false if unsupported. */
+        bool compile(Expression* node, int dest);
+
+        /** Run the program; false means bail out to the tree walker. */
+        bool execute(const Variables& vars, Slot* result) const;
+
+        static double slotDouble(const Slot& s);
+        static long long slotLong(const Slot& s);
+        static void setIntOrLong(Slot* s, long long v); // Value::createIntOrLong, unboxed
+
+        intrusive_ptr<Expression> _tree;
+        std::vector<Instruction> _program;
+        std::vector<Slot> _constants;
+        std::vector<intrusive_ptr<Expression> > _fieldPaths;
+        int _numRegisters;
+    };
+
+} // namespace mongo
@@ -30,24 +30,42 @@
 
 #include "mongo/db/pipeline/field_path.h"
 
-#include "mongo/util/mongoutils/str.h"
-
 namespace mongo {
 
-    using namespace mongoutils;
-
     const char FieldPath::prefix[] = "$";
 
-    FieldPath::FieldPath(const vector<string>& fieldPath) {
+    FieldPath::FieldPath(const vector<string>& fieldPath)
+        : _numParts(0) {
         massert(16409, "FieldPath cannot be constructed from an empty vector.", !fieldPath.empty());
-        vFieldName.reserve(fieldPath.size());
+
+        // Join the pre-split parts into the dotted backing string, then parse that. A
+        // part containing a '.' must still fail validation rather than silently split,
+        // so check each part up front.
+        size_t dottedSize = fieldPath.size() - 1; // the dots
         for(vector<string>::const_iterator i = fieldPath.begin(); i != fieldPath.end(); ++i) {
-            pushFieldName(*i);
+            uassertValidFieldName(*i);
+            dottedSize += i->size();
         }
+
+        _dotted.reserve(dottedSize);
+        for(vector<string>::const_iterator i = fieldPath.begin(); i != fieldPath.end(); ++i) {
+            if (!_dotted.empty())
+                _dotted.append(1, '.');
+            _dotted.append(*i);
+        }
+
+        parse();
         verify(getPathLength() > 0);
     }
 
-    FieldPath::FieldPath(const string& fieldPath) {
+    FieldPath::FieldPath(const string& fieldPath)
+        : _dotted(fieldPath),
+          _numParts(0) {
+        parse();
+        verify(getPathLength() > 0);
+    }
+
+    void FieldPath::parse() {
         /*
           The field path could be using dot notation.
           Break the field path up by peeling off successive pieces.
@@ -55,61 +73,64 @@ namespace mongo {
         size_t startpos = 0;
         while(true) {
             /* find the next dot */
-            const size_t dotpos = fieldPath.find('.', startpos);
+            const size_t dotpos = _dotted.find('.', startpos);
 
             /* if there are no more dots, use the remainder of the string */
-            if (dotpos == fieldPath.npos) {
-                string lastFieldName = fieldPath.substr(startpos, dotpos);
-                pushFieldName(lastFieldName);
+            if (dotpos == _dotted.npos) {
+                pushPart(startpos, _dotted.size() - startpos);
                 break;
             }
 
             /* use the string up to the dot */
-            const size_t length = dotpos - startpos;
-            string nextFieldName = fieldPath.substr(startpos, length);
-            pushFieldName(nextFieldName);
+            pushPart(startpos, dotpos - startpos);
 
             /* next time, search starting one spot after that */
             startpos = dotpos + 1;
         }
-        verify(getPathLength() > 0);
     }
 
     string FieldPath::getPath(bool fieldPrefix) const {
-        stringstream ss;
-        writePath(ss, fieldPrefix);
-        return ss.str();
+        if (fieldPrefix)
+            return prefix + _dotted;
+        return _dotted;
     }
 
     void FieldPath::writePath(ostream &outStream, bool fieldPrefix) const {
+        verify(getPathLength() > 0);
+
         if (fieldPrefix)
             outStream << prefix;
 
-        const size_t n = vFieldName.size();
-
-        verify(n > 0);
-        outStream << vFieldName[0];
-        for(size_t i = 1; i < n; ++i)
-            outStream << '.' << vFieldName[i];
+        outStream << _dotted;
     }
 
     FieldPath FieldPath::tail() const {
-        vector<string> allButFirst(vFieldName.begin()+1, vFieldName.end());
-        return FieldPath(allButFirst);
+        verify(getPathLength() > 1);
+        return FieldPath(_dotted.substr(getFieldName(0).size() + 1));
     }
 
-    void FieldPath::uassertValidFieldName(const string& fieldName) {
-        uassert(15998, "FieldPath field names may not be empty strings.", fieldName.length() > 0);
+    void FieldPath::uassertValidFieldName(const StringData& fieldName) {
+        uassert(15998, "FieldPath field names may not be empty strings.", fieldName.size() > 0);
         uassert(16410, "FieldPath field names may not start with '$'.", fieldName[0] != '$');
         uassert(16411, "FieldPath field names may not contain '\0'.",
                 fieldName.find('\0') == string::npos);
         uassert(16412, "FieldPath field names may not contain '.'.",
-                !str::contains(fieldName, '.'));
+                fieldName.find('.') == string::npos);
     }
 
-    void FieldPath::pushFieldName(const string& fieldName) {
-        uassertValidFieldName(fieldName);
-        vFieldName.push_back(fieldName);
+    void FieldPath::pushPart(size_t offset, size_t length) {
+        uassertValidFieldName(StringData(_dotted.data() + offset, length));
+        if (_numParts < kInlineParts) {
+            _fixed[_numParts].offset = offset;
+            _fixed[_numParts].length = length;
+        }
+        else {
+            Part part;
+            part.offset = offset;
+            part.length = length;
+            _variable.push_back(part);
+        }
+        _numParts++;
     }
 
 }
@@ -30,6 +30,8 @@
 
 #include "mongo/pch.h"
 
+#include "mongo/base/string_data.h"
+
 namespace mongo {
 
     class FieldPath {
@@ -55,10 +57,13 @@ namespace mongo {
         /**
           Get a particular path element from the path.
 
+          The returned StringData is a view into this FieldPath's storage; it is valid
+          only while this FieldPath is.
+
           @param i the zero based index of the path element.
           @returns the path element
          */
-        const string& getFieldName(size_t i) const;
+        StringData getFieldName(size_t i) const;
 
         /**
           Get the full path.
@@ -92,16 +97,43 @@ namespace mongo {
         FieldPath tail() const;
 
     private:
+        /**
+         * A single path element, as an (offset, length) span of _dotted.  Spans rather
+         * than pointers so the compiler generated copy of a FieldPath stays valid.
+         */
+        struct Part {
+            size_t offset;
+            size_t length;
+        };
+
         /** Uassert if a field name does not pass validation. */
-        static void uassertValidFieldName(const string& fieldName);
+        static void uassertValidFieldName(const StringData& fieldName);
 
         /**
-         * Push a new field name to the back of the vector of names comprising the field path.
-         * Uassert if 'fieldName' does not pass validation.
+         * Split _dotted into parts at '.' delimiters, validating each field name.
+         * Uassert if any field name does not pass validation.
          */
-        void pushFieldName(const string& fieldName);
+        void parse();
+
+        /** Record the path element [offset, offset+length) of _dotted. */
+        void pushPart(size_t offset, size_t length);
 
-        vector<string> vFieldName;
+        // Paths are most often not longer than four parts.  As in FieldRef, we use a
+        // mixed structure so that the common case needs no allocation beyond the path
+        // string itself.
+        static const size_t kInlineParts = 4;
+
+        // the complete dotted path; all parts are views into this string
+        string _dotted;
+
+        // number of path elements
+        size_t _numParts;
+
+        // first kInlineParts path elements
+        Part _fixed[kInlineParts];
+
+        // remaining path elements, if any
+        vector<Part> _variable;
     };
 }
 
@@ -111,12 +143,13 @@ namespace mongo {
 namespace mongo {
 
     inline size_t FieldPath::getPathLength() const {
-        return vFieldName.size();
+        return _numParts;
     }
 
-    inline const string& FieldPath::getFieldName(size_t i) const {
+    inline StringData FieldPath::getFieldName(size_t i) const {
         dassert(i < getPathLength());
-        return vFieldName[i];
+        const Part& part = i < kInlineParts ? _fixed[i] : _variable[i - kInlineParts];
+        return StringData(_dotted.data() + part.offset, part.length);
     }
 
     inline const char *FieldPath::getPrefix() {
@@ -124,4 +157,3 @@ namespace mongo {
     }
 
 }
-
@@ -464,16 +464,20 @@ namespace mongo {
         // cant use subArrayStart() due to error handling
         BSONArrayBuilder resultArray;
         DocumentSource* finalSource = sources.back().get();
-        while (boost::optional<Document> next = finalSource->getNext()) {
-            // add the document to the result set
-            BSONObjBuilder documentBuilder (resultArray.subobjStart());
-            next->toBson(&documentBuilder);
-            documentBuilder.doneFast();
-            // object will be too large, assert. the extra 1KB is for headers
-            uassert(16389,
-                    str::stream() << "aggregation result exceeds maximum document size ("
-                                  << BSONObjMaxUserSize / (1024 * 1024) << "MB)",
-                    resultArray.len() < BSONObjMaxUserSize - 1024);
+        DocumentBatch batch;
+        while (finalSource->getNextBatch(&batch)) {
+            for (size_t i = 0; i < batch.size(); i++) {
+                // add the document to the result set
+                BSONObjBuilder documentBuilder (resultArray.subobjStart());
+                batch[i].toBson(&documentBuilder);
+                documentBuilder.doneFast();
+                // object will be too large, assert. the extra 1KB is for headers
+                uassert(16389,
+                        str::stream() << "aggregation result exceeds maximum document size ("
+                                      << BSONObjMaxUserSize / (1024 * 1024) << "MB)",
+                        resultArray.len() < BSONObjMaxUserSize - 1024);
+            }
+            batch.clear();
         }
 
         resultArray.done();
@@ -58,6 +58,15 @@ namespace {
             return nsd && nsd->isCapped();
         }
 
+        void initializeWorkerThread() {
+            // the worker thread needs its own Client for the DBDirectClient's operations
+            Client::initThread("aggregation writer");
+        }
+
+        void terminateWorkerThread() {
+            cc().shutdown();
+        }
+
     private:
         DBDirectClient _client;
     };
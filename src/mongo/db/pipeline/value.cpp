@@ -63,6 +63,8 @@ namespace mongo {
         case Symbol:
             // the above types reference data when not using short-string optimization
             verify(refCounter == !shortStr);
+            if (sharedStr)
+                verify(typeid(*genericRCPtr) == typeid(const RCBSONString));
             break;
 
         case BinData: // TODO this should probably support short-string optimization
@@ -98,6 +100,16 @@ namespace mongo {
         }
     }
 
+    void ValueStorage::putSharedString(const BSONObj& owner, const StringData& s) {
+        if (s.size() <= sizeof(shortStrStorage) || !owner.isOwned()) {
+            putString(s); // copying is cheaper (or the only safe option)
+        }
+        else {
+            putRefCountable(new RCBSONString(owner, s));
+            sharedStr = true;
+        }
+    }
+
     void ValueStorage::putDocument(const Document& d) {
         putRefCountable(d._storage);
     }
@@ -216,6 +228,34 @@ namespace mongo {
         }
     }
 
+    Value::Value(const BSONElement& elem, const BSONObj& owner) : _storage(elem.type()) {
+        switch(elem.type()) {
+        case Code:
+        case Symbol:
+        case String:
+            _storage.putSharedString(owner, StringData(elem.valuestr(), elem.valuestrsize()-1));
+            break;
+
+        case Object:
+            _storage.putDocument(Document(elem.embeddedObject(), owner));
+            break;
+
+        case Array: {
+            intrusive_ptr<RCVector> vec (new RCVector);
+            BSONForEach(sub, elem.embeddedObject()) {
+                vec->vec.push_back(Value(sub, owner));
+            }
+            _storage.putVector(vec.get());
+            break;
+        }
+
+        default:
+            // no other types hold a payload that is worth sharing
+            *this = Value(elem);
+            break;
+        }
+    }
+
     Value::Value(const BSONArray& arr) : _storage(Array) {
         intrusive_ptr<RCVector> vec (new RCVector);
         BSONForEach(sub, arr) {
@@ -558,6 +598,21 @@ namespace mongo {
         return 1;
     }
 
+    bool Value::equals(const Value& rL, const Value& rR) {
+        // Equal values hash equally, so two documents whose cached hashes differ cannot
+        // compare equal. Hashed containers (e.g. $addToSet's set) warm the cache on
+        // every element they hold, so dedup-heavy paths skip the field-by-field walk.
+        if (rL.getType() == Object && rR.getType() == Object) {
+            size_t lh, rh;
+            if (rL.getDocument().getCachedHash(&lh)
+                    && rR.getDocument().getCachedHash(&rh)
+                    && lh != rh) {
+                return false;
+            }
+        }
+        return compare(rL, rR) == 0;
+    }
+
     int Value::compare(const Value& rL, const Value& rR) {
         // Note, this function needs to behave identically to BSON's compareElementValues().
         // Additionally, any changes here must be replicated in hash_combine().
@@ -93,10 +93,16 @@ namespace mongo {
             : _storage(Date, static_cast<long long>(date.millis)) // millis really signed
         {}
 
-        // TODO: add an unsafe version that can share storage with the BSONElement
         /// Deep-convert from BSONElement to Value
         explicit Value(const BSONElement& elem);
 
+        /** Like Value(elem), but large string data aliases owner's buffer instead of
+         *  being copied.  owner must be the object elem points into; each resulting
+         *  Value keeps its buffer alive.  Falls back to copying if owner doesn't own
+         *  its buffer (see BSONObj::isOwned()).
+         */
+        Value(const BSONElement& elem, const BSONObj& owner);
+
         /** Construct a long or integer-valued Value.
          *
          *  Used when preforming arithmetic operations with int where the
@@ -200,13 +206,18 @@ namespace mongo {
          */
         static int compare(const Value& lhs, const Value& rhs);
 
+        /** Equality check that can short-circuit on cached document hashes, unlike
+         *  compare() which must establish an ordering. Prefer operator==.
+         */
+        static bool equals(const Value& lhs, const Value& rhs);
+
         friend
         bool operator==(const Value& v1, const Value& v2) {
             if (v1._storage.identical(v2._storage)) {
                 // Simple case
                 return true;
             }
-            return (Value::compare(v1, v2) == 0);
+            return Value::equals(v1, v2);
         }
         
         friend bool operator!=(const Value& v1, const Value& v2) {
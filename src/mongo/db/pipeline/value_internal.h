@@ -65,6 +65,19 @@ namespace mongo {
         const OID oid;
     };
 
+    /// String data aliased out of a BSONObj's buffer rather than copied.  Holding the
+    /// object keeps its buffer alive for as long as any Value references the string.
+    class RCBSONString : public RefCountable {
+    public:
+        RCBSONString(const BSONObj& owner, const StringData& s) :_owner(owner), _str(s) {
+            dassert(_owner.isOwned());
+        }
+        StringData str() const { return _str; }
+    private:
+        const BSONObj _owner;
+        const StringData _str; // points into _owner's buffer
+    };
+
 #pragma pack(1)
     class ValueStorage {
     public:
@@ -129,6 +142,8 @@ namespace mongo {
 
         /// These are only to be called during Value construction on an empty Value
         void putString(const StringData& s);
+        /// Aliases s, which must point into owner's buffer, instead of copying it
+        void putSharedString(const BSONObj& owner, const StringData& s);
         void putVector(const RCVector* v);
         void putDocument(const Document& d);
         void putRegEx(const BSONRegEx& re);
@@ -161,6 +176,10 @@ namespace mongo {
             if (shortStr) {
                 return StringData(shortStrStorage, shortStrSize);
             }
+            else if (sharedStr) {
+                dassert(typeid(*genericRCPtr) == typeid(const RCBSONString));
+                return static_cast<const RCBSONString*>(genericRCPtr)->str();
+            }
             else {
                 dassert(typeid(*genericRCPtr) == typeid(const RCString));
                 const RCString* stringPtr = static_cast<const RCString*>(genericRCPtr);
@@ -218,7 +237,8 @@ namespace mongo {
                 struct {
                     bool refCounter : 1; // true if we need to refCount
                     bool shortStr : 1; // true if we are using short strings
-                    // reservedFlags: 6;
+                    bool sharedStr : 1; // true if string data is aliased out of a BSONObj
+                    // reservedFlags: 5;
                 };
 
                 // bytes 3-16;
@@ -28,11 +28,55 @@
 
 #include "mongo/db/query/explain_plan.h"
 
+#include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/stage_types.h"
 #include "mongo/db/query/type_explain.h"
 
 namespace mongo {
 
+    namespace {
+
+        const char* stageTypeString(StageType type) {
+            switch (type) {
+            case STAGE_AND_HASH: return "AND_HASH";
+            case STAGE_AND_SORTED: return "AND_SORTED";
+            case STAGE_COLLSCAN: return "COLLSCAN";
+            case STAGE_EXCHANGE: return "EXCHANGE";
+            case STAGE_FETCH: return "FETCH";
+            case STAGE_GEO_2D: return "GEO_2D";
+            case STAGE_GEO_NEAR_2D: return "GEO_NEAR_2D";
+            case STAGE_GEO_NEAR_2DSPHERE: return "GEO_NEAR_2DSPHERE";
+            case STAGE_IXSCAN: return "IXSCAN";
+            case STAGE_LIMIT: return "LIMIT";
+            case STAGE_OR: return "OR";
+            case STAGE_PROJECTION: return "PROJECTION";
+            case STAGE_SKIP: return "SKIP";
+            case STAGE_SORT: return "SORT";
+            case STAGE_SORT_MERGE: return "SORT_MERGE";
+            default: return "UNKNOWN";
+            }
+        }
+
+        /**
+         * Renders the stats tree rooted at 'stats' as BSON: the per-stage counters (including
+         * the sampled work() timing) plus a "children" array.
+         */
+        BSONObj statsTreeToBSON(const PlanStageStats& stats) {
+            BSONObjBuilder bob;
+            bob.append("type", stageTypeString(stats.stageType));
+            stats.writeExplainTo(&bob);
+            if (!stats.children.empty()) {
+                BSONArrayBuilder childrenBob(bob.subarrayStart("children"));
+                for (size_t i = 0; i < stats.children.size(); ++i) {
+                    childrenBob.append(statsTreeToBSON(*stats.children[i]));
+                }
+                childrenBob.done();
+            }
+            return bob.obj();
+        }
+
+    }  // namespace
+
     Status explainPlan(const PlanStageStats& stats, TypeExplain** explain, bool fullDetails) {
         auto_ptr<TypeExplain> res(new TypeExplain);
 
@@ -136,6 +180,7 @@ namespace mongo {
         if (fullDetails) {
             res->setScanAndOrder(sortPresent);
             res->setNYields(root->common.yields);
+            res->setStats(statsTreeToBSON(*root));
         }
 
         *explain = res.release();
@@ -28,6 +28,8 @@
 
 #include "mongo/db/query/index_bounds.h"
 
+#include <algorithm>
+
 namespace mongo {
 
     namespace {
@@ -343,7 +345,8 @@ namespace mongo {
             Location where = findIntervalForField(keyValues[firstNonContainedField],
                                            _bounds->fields[firstNonContainedField],
                                            _expectedDirection[firstNonContainedField],
-                                           &newIntervalForField);
+                                           &newIntervalForField,
+                                           _curInterval[firstNonContainedField]);
 
             if (WITHIN == where) {
                 // Found a new interval for field firstNonContainedField.  Move our internal choice
@@ -420,21 +423,64 @@ namespace mongo {
 
     // static
     IndexBoundsChecker::Location IndexBoundsChecker::findIntervalForField(const BSONElement& elt,
-            const OrderedIntervalList& oil, const int expectedDirection, size_t* newIntervalIndex) {
+            const OrderedIntervalList& oil, const int expectedDirection, size_t* newIntervalIndex,
+            size_t startHint) {
+
+        const size_t numIntervals = oil.intervals.size();
+        if (0 == numIntervals) {
+            return AHEAD;
+        }
 
-        for (size_t i = 0; i < oil.intervals.size(); ++i) {
-            Location where = intervalCmp(oil.intervals[i], elt, expectedDirection);
+        // Intervals are ordered in the same direction as our keys, so "elt is ahead of
+        // interval i" holds for a (possibly empty) prefix of the list and is false for the
+        // rest.  The first interval we aren't ahead of is the one we're looking for; elt is
+        // WITHIN or BEHIND it.  Find it with a binary search rather than stepping through a
+        // 10,000-element $in's intervals one at a time.
+        //
+        // Keys only move forward through the bounds, so the answer is usually at or just
+        // after 'startHint' (the interval the last key was in).  Gallop forward from the
+        // hint to bracket the answer before searching.
+
+        size_t lo = 0;
+        size_t hi = numIntervals;  // first index known to not be ahead of elt, if < numIntervals
+
+        if (startHint < numIntervals) {
+            if (AHEAD == intervalCmp(oil.intervals[startHint], elt, expectedDirection)) {
+                // The answer is strictly after the hint.
+                lo = startHint + 1;
+                size_t probe = lo;
+                size_t step = 1;
+                while (probe < numIntervals
+                       && AHEAD == intervalCmp(oil.intervals[probe], elt, expectedDirection)) {
+                    lo = probe + 1;
+                    probe += step;
+                    step *= 2;
+                }
+                hi = std::min(probe, numIntervals);
+            }
+            else {
+                // The answer is at or before the hint.
+                hi = startHint;
+            }
+        }
 
-            // Intervals are ordered in the same direction as our keys.  The first interval we
-            // aren't ahead of is the one we're looking for.
-            if (AHEAD != where) {
-                *newIntervalIndex = i;
-                return where;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (AHEAD == intervalCmp(oil.intervals[mid], elt, expectedDirection)) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
             }
         }
 
-        // If we're here, we're ahead of all intervals.
-        return AHEAD;
+        if (lo == numIntervals) {
+            // We're ahead of all intervals.
+            return AHEAD;
+        }
+
+        *newIntervalIndex = lo;
+        return intervalCmp(oil.intervals[lo], elt, expectedDirection);
     }
 
 }  // namespace mongo
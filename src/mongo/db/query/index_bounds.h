@@ -210,11 +210,13 @@ namespace mongo {
          *
          * If 'elt' cannot be advanced to any interval, return AHEAD.
          *
-         * TODO(efficiency): Start search from a given index.
-         * TODO(efficiency): Binary search for the answer.
+         * 'startHint' is the interval index to start the search from -- usually the interval
+         * the previous key was in.  Any value is safe; a good hint just makes the gallop
+         * phase of the O(log #intervals) search shorter.
          */
         static Location findIntervalForField(const BSONElement &elt, const OrderedIntervalList& oil,
-                                             const int expectedDirection, size_t* newIntervalIndex);
+                                             const int expectedDirection, size_t* newIntervalIndex,
+                                             size_t startHint = 0);
 
         // The actual bounds.  Must outlive this object.  Not owned by us.
         const IndexBounds* _bounds;
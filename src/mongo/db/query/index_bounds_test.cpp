@@ -527,4 +527,48 @@ namespace {
         ASSERT(movePastKeyElts);
     }
 
+    TEST(IndexBoundsCheckerTest, ManyIntervals) {
+        // A 1000-point $in: intervals [0,0], [2,2], ..., [1998,1998].  The checker finds
+        // intervals with a hinted binary search, so keys that jump far through the bounds
+        // don't pay for a linear walk of the interval list.
+        OrderedIntervalList list("foo");
+        for (int i = 0; i < 1000; ++i) {
+            list.intervals.push_back(Interval(BSON("" << 2 * i << "" << 2 * i), true, true));
+        }
+
+        IndexBounds bounds;
+        bounds.fields.push_back(list);
+
+        BSONObj idx = BSON("foo" << 1);
+        ASSERT(bounds.isValidFor(idx, 1));
+        IndexBoundsChecker it(&bounds, idx, 1);
+
+        int keyEltsToUse;
+        bool movePastKeyElts;
+        vector<const BSONElement*> elt(1);
+        vector<bool> inc(1);
+
+        IndexBoundsChecker::KeyState state;
+
+        // In the set, far past the current interval.
+        state = it.checkKey(BSON("" << 1204), &keyEltsToUse, &movePastKeyElts, &elt, &inc);
+        ASSERT_EQUALS(state, IndexBoundsChecker::VALID);
+
+        // Between two intervals: seek to the start of the next one.
+        state = it.checkKey(BSON("" << 1205), &keyEltsToUse, &movePastKeyElts, &elt, &inc);
+        ASSERT_EQUALS(state, IndexBoundsChecker::MUST_ADVANCE);
+        ASSERT_EQUALS(keyEltsToUse, 0);
+        ASSERT_FALSE(movePastKeyElts);
+        ASSERT_EQUALS(elt[0]->numberInt(), 1206);
+        ASSERT(inc[0]);
+
+        // In the very last interval.
+        state = it.checkKey(BSON("" << 1998), &keyEltsToUse, &movePastKeyElts, &elt, &inc);
+        ASSERT_EQUALS(state, IndexBoundsChecker::VALID);
+
+        // Past every interval.
+        state = it.checkKey(BSON("" << 1999), &keyEltsToUse, &movePastKeyElts, &elt, &inc);
+        ASSERT_EQUALS(state, IndexBoundsChecker::DONE);
+    }
+
 }  // namespace
@@ -32,6 +32,7 @@
 #include <string>
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/query/index_statistics.h"
 
 namespace mongo {
 
@@ -46,6 +47,7 @@ namespace mongo {
             keyPattern = other.keyPattern;
             multikey = other.multikey;
             sparse = other.sparse;
+            stats = other.stats;
         }
 
         BSONObj keyPattern;
@@ -54,6 +56,10 @@ namespace mongo {
 
         bool sparse;
 
+        // Sampled statistics for this index, or NULL when none have been built yet.
+        // NULL must mean "no information", never "empty index".
+        IndexStatisticsPtr stats;
+
         std::string toString() const {
             stringstream ss;
             ss << keyPattern.toString();
@@ -0,0 +1,108 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/query/index_statistics.h"
+
+#include <algorithm>
+
+namespace mongo {
+
+    namespace {
+        // orders the single-element sample objects by value, ignoring field names
+        struct SampleLess {
+            bool operator()(const BSONObj& lhs, const BSONObj& rhs) const {
+                return lhs.firstElement().woCompare(rhs.firstElement(), false) < 0;
+            }
+        };
+    }
+
+    IndexStatistics::IndexStatistics(const BSONObj& keyPattern, long long numKeys,
+                                     const std::vector<BSONObj>& samples)
+        : _keyPattern(keyPattern.getOwned()), _numKeys(numKeys), _samples(samples),
+          _distinctSampled(0) {
+
+        std::sort(_samples.begin(), _samples.end(), SampleLess());
+
+        for (size_t i = 0; i < _samples.size(); ++i) {
+            if (0 == i || 0 != _samples[i].firstElement().woCompare(
+                                  _samples[i - 1].firstElement(), false)) {
+                ++_distinctSampled;
+            }
+        }
+    }
+
+    double IndexStatistics::equalitySelectivity(const BSONElement& value) const {
+        if (_samples.empty()) {
+            return 1;  // no information; assume nothing
+        }
+
+        BSONObj lookup = value.wrap();
+        std::pair<std::vector<BSONObj>::const_iterator,
+                  std::vector<BSONObj>::const_iterator> range =
+            std::equal_range(_samples.begin(), _samples.end(), lookup, SampleLess());
+
+        size_t hits = range.second - range.first;
+        if (0 == hits) {
+            // unseen by the sample: rarer than any sampled value
+            return 0.5 / _samples.size();
+        }
+        return static_cast<double>(hits) / _samples.size();
+    }
+
+    //
+    // IndexStatisticsRegistry
+    //
+
+    IndexStatisticsRegistry indexStatsRegistry;
+
+    IndexStatisticsPtr IndexStatisticsRegistry::get(const std::string& ns,
+                                                    const BSONObj& keyPattern) const {
+        boost::mutex::scoped_lock lk(_mutex);
+        NamespaceMap::const_iterator nsIt = _map.find(ns);
+        if (nsIt == _map.end()) {
+            return IndexStatisticsPtr();
+        }
+        IndexMap::const_iterator it = nsIt->second.find(keyPattern);
+        if (it == nsIt->second.end()) {
+            return IndexStatisticsPtr();
+        }
+        return it->second;
+    }
+
+    void IndexStatisticsRegistry::set(const std::string& ns, const BSONObj& keyPattern,
+                                      const IndexStatisticsPtr& stats) {
+        boost::mutex::scoped_lock lk(_mutex);
+        _map[ns][keyPattern.getOwned()] = stats;
+    }
+
+    void IndexStatisticsRegistry::dropNamespace(const std::string& ns) {
+        boost::mutex::scoped_lock lk(_mutex);
+        _map.erase(ns);
+    }
+
+}  // namespace mongo
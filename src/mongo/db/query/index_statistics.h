@@ -0,0 +1,114 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    /**
+     * Immutable statistics snapshot for one index, built from keys sampled out of its
+     * btree.  The sorted samples form an equi-depth sketch of the leading field: each
+     * consecutive pair covers roughly the same number of keys, so the fraction of samples
+     * equal to a value estimates the fraction of the index that value selects.
+     *
+     * Snapshots are built by the background refresher (db/index_stats_refresher.cpp) and
+     * consulted by the query planner to prune obviously unselective candidate indexes
+     * before multi-plan trialing.
+     */
+    class IndexStatistics {
+    public:
+        /**
+         * 'samples' holds single-element objects wrapping leading-field values, in any
+         * order; they are copied and sorted here.
+         */
+        IndexStatistics(const BSONObj& keyPattern, long long numKeys,
+                        const std::vector<BSONObj>& samples);
+
+        const BSONObj& keyPattern() const { return _keyPattern; }
+
+        /** estimated total number of keys in the index when the sample was taken */
+        long long numKeys() const { return _numKeys; }
+
+        int numSamples() const { return static_cast<int>(_samples.size()); }
+
+        /** number of distinct leading-field values seen among the samples */
+        int distinctSampled() const { return _distinctSampled; }
+
+        /**
+         * Estimated fraction of the index selected by an equality match on the leading
+         * field.  Never returns 0: a value the sample missed is assumed to be rarer than
+         * any sampled one.
+         */
+        double equalitySelectivity(const BSONElement& value) const;
+
+    private:
+        BSONObj _keyPattern;
+        long long _numKeys;
+        std::vector<BSONObj> _samples;  // owned single-element objects, sorted by value
+        int _distinctSampled;
+    };
+
+    typedef boost::shared_ptr<const IndexStatistics> IndexStatisticsPtr;
+
+    /**
+     * Thread-safe registry of the latest snapshot per index, keyed by collection
+     * namespace and index key pattern.  get() returns NULL when no snapshot has been
+     * built yet; callers must treat that as "no information", not "empty index".
+     */
+    class IndexStatisticsRegistry {
+    public:
+        IndexStatisticsPtr get(const std::string& ns, const BSONObj& keyPattern) const;
+
+        void set(const std::string& ns, const BSONObj& keyPattern,
+                 const IndexStatisticsPtr& stats);
+
+        /** forget everything recorded for 'ns' (collection dropped) */
+        void dropNamespace(const std::string& ns);
+
+    private:
+        typedef std::map<BSONObj, IndexStatisticsPtr> IndexMap;  // keyed by key pattern
+        typedef std::map<std::string, IndexMap> NamespaceMap;
+
+        // plain boost mutex: this header is part of the planner library, which links
+        // into unit tests without the server's concurrency helpers
+        mutable boost::mutex _mutex;
+        NamespaceMap _map;
+    };
+
+    extern IndexStatisticsRegistry indexStatsRegistry;
+
+}  // namespace mongo
@@ -0,0 +1,82 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mongo/db/query/index_statistics.h"
+
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using mongo::BSONObj;
+    using mongo::IndexStatistics;
+    using mongo::IndexStatisticsPtr;
+    using mongo::IndexStatisticsRegistry;
+
+    // 90 samples of value 1, 10 of value 2, in shuffled-ish order
+    std::vector<BSONObj> skewedSamples() {
+        std::vector<BSONObj> samples;
+        for (int i = 0; i < 100; ++i) {
+            samples.push_back(BSON("" << ((i % 10) == 0 ? 2 : 1)));
+        }
+        return samples;
+    }
+
+    TEST(IndexStatistics, EqualitySelectivity) {
+        IndexStatistics stats(BSON("a" << 1), 10000, skewedSamples());
+
+        ASSERT_EQUALS(100, stats.numSamples());
+        ASSERT_EQUALS(2, stats.distinctSampled());
+        ASSERT_EQUALS(10000, stats.numKeys());
+
+        ASSERT_APPROX_EQUAL(0.9, stats.equalitySelectivity(BSON("" << 1).firstElement()), 1e-9);
+        ASSERT_APPROX_EQUAL(0.1, stats.equalitySelectivity(BSON("" << 2).firstElement()), 1e-9);
+
+        // an unseen value is assumed rarer than any sampled one, but never impossible
+        double unseen = stats.equalitySelectivity(BSON("" << 3).firstElement());
+        ASSERT_GREATER_THAN(unseen, 0.0);
+        ASSERT_LESS_THAN(unseen, 0.01);
+    }
+
+    TEST(IndexStatistics, NoSamples) {
+        IndexStatistics stats(BSON("a" << 1), 0, std::vector<BSONObj>());
+
+        ASSERT_EQUALS(0, stats.numSamples());
+        ASSERT_EQUALS(0, stats.distinctSampled());
+
+        // no information: assume nothing about selectivity
+        ASSERT_APPROX_EQUAL(1.0, stats.equalitySelectivity(BSON("" << 1).firstElement()), 1e-9);
+    }
+
+    TEST(IndexStatisticsRegistry, GetSetDrop) {
+        IndexStatisticsRegistry registry;
+
+        ASSERT_FALSE(registry.get("test.foo", BSON("a" << 1)));
+
+        IndexStatisticsPtr stats(new IndexStatistics(BSON("a" << 1), 100, skewedSamples()));
+        registry.set("test.foo", BSON("a" << 1), stats);
+
+        ASSERT_TRUE(registry.get("test.foo", BSON("a" << 1)) == stats);
+        ASSERT_FALSE(registry.get("test.foo", BSON("b" << 1)));
+        ASSERT_FALSE(registry.get("test.bar", BSON("a" << 1)));
+
+        registry.dropNamespace("test.foo");
+        ASSERT_FALSE(registry.get("test.foo", BSON("a" << 1)));
+    }
+
+}  // namespace
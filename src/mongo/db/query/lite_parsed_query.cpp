@@ -205,6 +205,12 @@ namespace mongo {
                     }
                     _maxTimeMS = maxTimeMS.getValue();
                 }
+                else if (str::equals("afterOpTime", name)) {
+                    if (Timestamp != e.type() && Date != e.type()) {
+                        return Status(ErrorCodes::BadValue, "$afterOpTime must be a timestamp");
+                    }
+                    _afterOpTime = e._opTime();
+                }
             }
         }
         
@@ -80,7 +80,8 @@ namespace mongo {
         const BSONObj& getMax() const { return _max; }
         int getMaxScan() const { return _maxScan; }
         int getMaxTimeMS() const { return _maxTimeMS; }
-        
+        const OpTime& getAfterOpTime() const { return _afterOpTime; }
+
     private:
         LiteParsedQuery();
 
@@ -107,6 +108,10 @@ namespace mongo {
         BSONObj _hint;
         int _maxScan;
         int _maxTimeMS;
+
+        // read-your-writes token: secondaries only serve the query once their applied
+        // optime has reached this.  Null (the default) means no constraint.
+        OpTime _afterOpTime;
     };
 
 } // namespace mongo
@@ -34,7 +34,9 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/explain_plan.h"
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/type_explain.h"
 
@@ -211,7 +213,9 @@ namespace mongo {
 
         if (_failure || _killed) { return false; }
 
-        size_t bestChild = PlanRanker::pickBestPlan(_candidates, NULL);
+        auto_ptr<PlanRankingDecision> why(new PlanRankingDecision());
+        size_t bestChild = PlanRanker::pickBestPlan(_candidates, why.get());
+        why->onlyOneSolution = (1 == _candidates.size());
 
         // Run the best plan.  Store it.
         _bestPlan.reset(new PlanExecutor(_candidates[bestChild].ws,
@@ -222,11 +226,20 @@ namespace mongo {
         // XXX
         // cout << "Winning solution:\n" << _bestSolution->toString() << endl;
 
-        // TODO:
-        // Store the choice we just made in the cache.
-        // QueryPlanCache* cache = PlanCache::get(somenamespace);
-        // cache->add(_query, *_candidates[bestChild]->solution, decision->bestPlanStats);
-        // delete decision;
+        // Remember the trial outcome so queryShapeStats can report on this shape later and
+        // so the cache has a historical baseline for this shape.
+        QueryShapeStats::get(_query->ns())->recordTrial(
+            PlanCache::computeKey(*_query),
+            _bestSolution->toString(),
+            _candidates.size(),
+            QueryShapeStats::worksPerAdvance(why->statsOfWinner));
+
+        // Store the choice we just made in the cache so future runs of this shape skip the
+        // plan competition and go straight to the CachedPlanRunner.
+        PlanCache* cache = PlanCache::get(_query->ns());
+        if (NULL != cache) {
+            cache->add(*_query, _bestSolution, why.release());
+        }
 
         // Clear out the candidate plans, leaving only stats as we're all done w/them.
         for (size_t i = 0; i < _candidates.size(); ++i) {
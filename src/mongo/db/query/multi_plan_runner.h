@@ -135,8 +135,8 @@ namespace mongo {
         // ...and any results it produced while working toward winning.
         std::deque<WorkingSetID> _alreadyProduced;
 
-        // ...and the solution, for caching.
-        boost::scoped_ptr<QuerySolution> _bestSolution;
+        // ...and the solution, shared with the plan cache.
+        boost::shared_ptr<QuerySolution> _bestSolution;
 
         // Candidate plans.
         std::vector<CandidatePlan> _candidates;
@@ -29,6 +29,7 @@
 #include "mongo/db/query/new_find.h"
 
 #include "mongo/client/dbclientinterface.h"
+#include "mongo/db/client.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/index/catalog_hack.h"
@@ -38,6 +39,7 @@
 #include "mongo/db/query/cached_plan_runner.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/eof_runner.h"
+#include "mongo/db/query/index_statistics.h"
 #include "mongo/db/query/multi_plan_runner.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/query_planner.h"
@@ -147,9 +149,15 @@ namespace mongo {
                 // the cached plan runner, which takes ownership of both.
                 WorkingSet* ws;
                 PlanStage* root;
-                verify(StageBuilder::build(*cs->solution, &root, &ws));
-                *out = new CachedPlanRunner(canonicalQuery.release(), cs, root, ws);
-                return Status::OK();
+                if (StageBuilder::build(*cs->solution, &root, &ws)) {
+                    *out = new CachedPlanRunner(canonicalQuery.release(), cs, root, ws);
+                    return Status::OK();
+                }
+                // The cached solution can't be built into a plan any more, e.g. an index it
+                // uses was dropped out from under us.  Treat it as a cache miss: evict the
+                // stale entry and fall through to replanning.
+                localCache->remove(*canonicalQuery, *cs->solution);
+                delete cs;
             }
         }
 
@@ -188,6 +196,10 @@ namespace mongo {
         for (int i = 0; i < nsd->getCompletedIndexCount(); ++i) {
             auto_ptr<IndexDescriptor> desc(CatalogHack::getDescriptor(nsd, i));
             indices.push_back(IndexEntry(desc->keyPattern(), desc->isMultikey(), desc->isSparse()));
+            // attach the background refresher's sampled statistics, when it has any,
+            // so the planner can prune obviously unselective candidates
+            indices.back().stats = indexStatsRegistry.get(canonicalQuery->ns(),
+                                                          desc->keyPattern());
         }
 
         vector<QuerySolution*> solutions;
@@ -250,9 +262,16 @@ namespace mongo {
     QueryResult* newGetMore(const char* ns, int ntoreturn, long long cursorid, CurOp& curop,
                             int pass, bool& exhaust, bool* isCursorAuthorized) {
         exhaust = false;
-        int bufSize = 512 + sizeof(QueryResult) + MaxBytesToReturnToClientAtOnce;
 
-        BufBuilder bb(bufSize);
+        // Note that the reply buffer grows as documents are appended; don't preallocate
+        // MaxBytesToReturnToClientAtOnce here.  Most getMores return far less than the 4MB
+        // cap, and the mmap'd records themselves can't be handed to the socket layer
+        // directly (the reply is sent after the read lock below is released, by which time
+        // records may have moved), so one copy into this buffer is the floor -- but it should
+        // be a right-sized one.  The initial reservation tracks this connection's recent
+        // reply sizes so steady-state replies don't pay growth reallocs.
+        Client& client = cc(); // the ClientCursor local below shadows cc()
+        BufBuilder bb(client.replyBufferSize());
         bb.skip(sizeof(QueryResult));
 
         // This is a read lock.  TODO: There is a cursor flag for not needing this.  Do we care?
@@ -314,17 +333,29 @@ namespace mongo {
             Runner* runner = cc->getRunner();
             const int queryOptions = cc->queryOptions();
 
+            // How many reply bytes to accumulate before cutting the batch; grows for
+            // consumers that come right back for more (see ClientCursor).
+            const int batchByteBudget = cc->nextBatchByteBudget();
+
             // Get results out of the runner.
             runner->restoreState();
 
+            // Built once per batch, not once per document: collMetadata is an immutable
+            // snapshot we hold a reference to, so its key pattern can't change under us.
+            scoped_ptr<KeyPattern> keyPattern;
+            if (collMetadata) {
+                keyPattern.reset(new KeyPattern(collMetadata->getKeyPattern()));
+            }
+
             BSONObj obj;
             Runner::RunnerState state;
             while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&obj, NULL))) {
                 // If we're sharded make sure that we don't return any data that hasn't been
                 // migrated off of our shard yet.
                 if (collMetadata) {
-                    KeyPattern kp(collMetadata->getKeyPattern());
-                    if (!collMetadata->keyBelongsToMe(kp.extractSingleKey(obj))) { continue; }
+                    if (!collMetadata->keyBelongsToMe(keyPattern->extractSingleKey(obj))) {
+                        continue;
+                    }
                 }
 
                 // Add result to output buffer.
@@ -342,7 +373,7 @@ namespace mongo {
                 }
 
                 if ((numResults && numResults >= ntoreturn)
-                    || bb.len() > MaxBytesToReturnToClientAtOnce) {
+                    || bb.len() > batchByteBudget) {
                     break;
                 }
             }
@@ -365,6 +396,7 @@ namespace mongo {
             else {
                 // Continue caching the ClientCursor.
                 cc->incPos(numResults);
+                cc->noteBatchReturned();
                 runner->saveState();
 
                 // Possibly note slave's position in the oplog.
@@ -387,6 +419,7 @@ namespace mongo {
         qr->cursorId = cursorid;
         qr->startingFrom = startingResult;
         qr->nReturned = numResults;
+        client.noteReplyLen(bb.len());
         bb.decouple();
         return qr;
     }
@@ -464,7 +497,8 @@ namespace mongo {
         // bb is used to hold query results
         // this buffer should contain either requested documents per query or
         // explain information, but not both
-        BufBuilder bb(32768);
+        // initial reservation tracks this connection's recent reply sizes
+        BufBuilder bb(cc().replyBufferSize());
         bb.skip(sizeof(QueryResult));
 
         // How many results have we obtained from the runner?
@@ -487,6 +521,13 @@ namespace mongo {
         Runner::RunnerState state;
         uint64_t numMisplacedDocs = 0;
 
+        // Built once per query, not once per document: collMetadata is an immutable snapshot
+        // we hold a reference to, so its key pattern can't change even across yields.
+        scoped_ptr<KeyPattern> keyPattern;
+        if (collMetadata) {
+            keyPattern.reset(new KeyPattern(collMetadata->getKeyPattern()));
+        }
+
         // set this outside loop. we will need to use this both within loop and when deciding
         // to fill in explain information
         const bool isExplain = pq.isExplain();
@@ -495,11 +536,8 @@ namespace mongo {
             // If we're sharded make sure that we don't return any data that hasn't been migrated
             // off of our shared yet.
             if (collMetadata) {
-                // This information can change if we yield and as such we must make sure to re-fetch
-                // it if we yield.
-                KeyPattern kp(collMetadata->getKeyPattern());
                 // This performs excessive BSONObj creation but that's OK for now.
-                if (!collMetadata->keyBelongsToMe(kp.extractSingleKey(obj))) {
+                if (!collMetadata->keyBelongsToMe(keyPattern->extractSingleKey(obj))) {
                     ++numMisplacedDocs;
                     continue;
                 }
@@ -651,7 +689,9 @@ namespace mongo {
             cc->setLeftoverMaxTimeMicros(curop.getRemainingMaxTimeMicros());
         }
 
-        // Add the results from the query into the output buffer.
+        // Add the results from the query into the output buffer.  appendData takes
+        // ownership of the buffer; no copy here.
+        cc().noteReplyLen(bb.len());
         result.appendData(bb.buf(), bb.len());
         bb.decouple();
 
@@ -97,6 +97,9 @@ namespace mongo {
         // ProjectionExecutor reads the fields below.
         friend class ProjectionExecutor;
 
+        // ProjectionStage reads them to compile its covered fast path.
+        friend class ProjectionStage;
+
         // _id can be included/excluded separately and is by default included.
         bool _includeID;
 
@@ -0,0 +1,265 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/query/plan_cache.h"
+
+#include <memory>
+
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_shape_stats.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+    namespace {
+
+        // Registry of per-namespace caches.  Caches are created on first use and never
+        // destroyed; a namespace's cache is tiny compared to its NamespaceDetails.
+        SimpleMutex planCacheRegistryLock("planCacheRegistry");
+        typedef unordered_map<string, PlanCache*> PlanCacheMap;
+        PlanCacheMap* planCaches = NULL;
+
+        /**
+         * Appends the shape of the predicate rooted at 'node' to 'sb': operators and paths but
+         * not constants, so {a: 7} and {a: 42} share a cache entry but {a: 7} and {b: 7} do not.
+         */
+        void encodeMatchShape(const MatchExpression* node, StringBuilder* sb) {
+            *sb << static_cast<int>(node->matchType()) << ':' << node->path().toString();
+            if (0 == node->numChildren()) { return; }
+            *sb << '(';
+            for (size_t i = 0; i < node->numChildren(); ++i) {
+                encodeMatchShape(node->getChild(i), sb);
+                *sb << '|';
+            }
+            *sb << ')';
+        }
+
+    }  // namespace
+
+    const double PlanCache::kDegradationFactor = 4.0;
+
+    PlanCache::PlanCache(const string& ns) : _ns(ns), _lock("PlanCache") { }
+
+    PlanCache::~PlanCache() {
+        for (EntryMap::const_iterator it = _entries.begin(); it != _entries.end(); ++it) {
+            delete it->second;
+        }
+    }
+
+    // static
+    PlanCache* PlanCache::get(const string& ns) {
+        SimpleMutex::scoped_lock lk(planCacheRegistryLock);
+        if (NULL == planCaches) {
+            planCaches = new PlanCacheMap();
+        }
+        PlanCacheMap::const_iterator it = planCaches->find(ns);
+        if (it != planCaches->end()) {
+            return it->second;
+        }
+        PlanCache* cache = new PlanCache(ns);
+        (*planCaches)[ns] = cache;
+        return cache;
+    }
+
+    // static
+    void PlanCache::clear(const string& ns) {
+        PlanCache* cache = NULL;
+        {
+            SimpleMutex::scoped_lock lk(planCacheRegistryLock);
+            if (NULL == planCaches) { return; }
+            PlanCacheMap::const_iterator it = planCaches->find(ns);
+            if (it == planCaches->end()) { return; }
+            cache = it->second;
+        }
+        // _clear takes the cache's own lock; don't hold the registry lock across it.
+        cache->_clear();
+    }
+
+    // static
+    void PlanCache::clearForDatabase(const string& dbname) {
+        const string prefix = dbname + '.';
+        vector<PlanCache*> caches;
+        {
+            SimpleMutex::scoped_lock lk(planCacheRegistryLock);
+            if (NULL == planCaches) { return; }
+            for (PlanCacheMap::const_iterator it = planCaches->begin();
+                 it != planCaches->end(); ++it) {
+                if (0 == it->first.compare(0, prefix.size(), prefix)) {
+                    caches.push_back(it->second);
+                }
+            }
+        }
+        for (size_t i = 0; i < caches.size(); ++i) {
+            caches[i]->_clear();
+        }
+    }
+
+    void PlanCache::_clear() {
+        SimpleMutex::scoped_lock lk(_lock);
+        while (!_lru.empty()) {
+            _evict(_lru.back());
+        }
+    }
+
+    // static
+    string PlanCache::computeKey(const CanonicalQuery& query) {
+        StringBuilder sb;
+        encodeMatchShape(query.root(), &sb);
+        sb << "#sort:" << query.getParsed().getSort().toString();
+        sb << "#proj:" << query.getParsed().getProj().toString();
+        return sb.str();
+    }
+
+    bool PlanCache::add(const CanonicalQuery& query,
+                        const boost::shared_ptr<QuerySolution>& solution,
+                        PlanRankingDecision* why) {
+        boost::shared_ptr<PlanRankingDecision> ownedWhy(why);
+        const string key = computeKey(query);
+
+        SimpleMutex::scoped_lock lk(_lock);
+
+        bool added = true;
+        EntryMap::iterator it = _entries.find(key);
+        if (it != _entries.end()) {
+            // Somebody replanned this shape while we were planning; take the newer answer.
+            _evict(it->second);
+            added = false;
+        }
+
+        // Cap the number of shapes we remember; evict from the cold end.
+        if (_entries.size() >= kMaxEntries) {
+            _evict(_lru.back());
+        }
+
+        Entry* entry = new Entry();
+        entry->key = key;
+        entry->solution = solution;
+        entry->why = ownedWhy;
+        if (entry->why) {
+            entry->baselineWorksPerAdvance =
+                QueryShapeStats::worksPerAdvance(entry->why->statsOfWinner);
+        }
+        if (0 == entry->baselineWorksPerAdvance) {
+            // No usable trial stats; fall back on the best this shape has ever done so a
+            // plan that is much worse than the shape's history still gets evicted.
+            entry->baselineWorksPerAdvance =
+                QueryShapeStats::get(_ns)->historicalBestWorksPerAdvance(key);
+        }
+        _lru.push_front(entry);
+        entry->lruIt = _lru.begin();
+        _entries[key] = entry;
+        return added;
+    }
+
+    CachedSolution* PlanCache::get(const CanonicalQuery& query) {
+        const string key = computeKey(query);
+
+        SimpleMutex::scoped_lock lk(_lock);
+
+        EntryMap::const_iterator it = _entries.find(key);
+        if (it == _entries.end()) {
+            return NULL;
+        }
+
+        Entry* entry = it->second;
+
+        // Move to the hot end of the LRU list.
+        _lru.erase(entry->lruIt);
+        _lru.push_front(entry);
+        entry->lruIt = _lru.begin();
+
+        auto_ptr<CachedSolution> cs(new CachedSolution());
+        cs->solution = entry->solution;
+        cs->decision = entry->why;
+        return cs.release();
+    }
+
+    bool PlanCache::feedback(const CanonicalQuery& query, const QuerySolution& solution,
+                             const CachedSolutionFeedback* feedback) {
+        auto_ptr<const CachedSolutionFeedback> ownedFeedback(feedback);
+        const string key = computeKey(query);
+
+        SimpleMutex::scoped_lock lk(_lock);
+
+        EntryMap::const_iterator it = _entries.find(key);
+        if (it == _entries.end()) {
+            return false;
+        }
+        Entry* entry = it->second;
+
+        // The entry may have been replaced since this plan was handed out; feedback about the
+        // old solution says nothing about the new one.
+        if (entry->solution.get() != &solution) {
+            return false;
+        }
+
+        const double observed = QueryShapeStats::worksPerAdvance(ownedFeedback->stats);
+        QueryShapeStats::get(_ns)->recordRun(key, observed);
+        if (0 == entry->baselineWorksPerAdvance) {
+            entry->baselineWorksPerAdvance = observed;
+        }
+        else if (observed > entry->baselineWorksPerAdvance * kDegradationFactor) {
+            // The plan is doing far more work per returned document than when it was cached
+            // (data distribution or index contents changed).  Toss it so we replan.
+            QueryShapeStats::get(_ns)->recordEviction(key);
+            _evict(entry);
+            return true;
+        }
+
+        if (entry->feedback.size() >= kMaxFeedbackEntries) {
+            delete entry->feedback.front();
+            entry->feedback.erase(entry->feedback.begin());
+        }
+        entry->feedback.push_back(ownedFeedback.release());
+        return true;
+    }
+
+    bool PlanCache::remove(const CanonicalQuery& query, const QuerySolution& solution) {
+        const string key = computeKey(query);
+
+        SimpleMutex::scoped_lock lk(_lock);
+
+        EntryMap::const_iterator it = _entries.find(key);
+        if (it == _entries.end()) {
+            return false;
+        }
+        if (it->second->solution.get() != &solution) {
+            return false;
+        }
+        _evict(it->second);
+        return true;
+    }
+
+    void PlanCache::_evict(Entry* entry) {
+        _lru.erase(entry->lruIt);
+        _entries.erase(entry->key);
+        delete entry;
+    }
+
+}  // namespace mongo
@@ -28,12 +28,22 @@
 
 #pragma once
 
+#include <list>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/query_solution.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
+    class CanonicalQuery;
+
     /**
      * TODO: Debug commands:
      * 1. show canonical form of query
@@ -47,87 +57,158 @@ namespace mongo {
      * feedback is available to anyone who retrieves that query in the future.
      */
     struct CachedSolutionFeedback {
+        CachedSolutionFeedback() : stats(NULL) { }
+        ~CachedSolutionFeedback() { delete stats; }
+
         PlanStageStats* stats;
     };
 
     /**
-     * A cached solution to a query.
+     * A cached solution to a query, as handed out by PlanCache::get().  The solution and the
+     * ranking decision are shared with the cache entry they came from, so a cached plan keeps
+     * running safely even if its entry is evicted mid-run.
      */
     struct CachedSolution {
-        ~CachedSolution() {
-            for (size_t i = 0; i < feedback.size(); ++i) {
-                delete feedback[i];
-            }
-        }
-
         // The best solution for the CanonicalQuery.
-        scoped_ptr<QuerySolution> solution;
+        boost::shared_ptr<QuerySolution> solution;
 
         // Why the best solution was picked.
-        scoped_ptr<PlanRankingDecision> decision;
-
-        // Annotations from cached runs.
-        // TODO: How many of these do we really want to keep?
-        vector<CachedSolutionFeedback*> feedback;
-    private:
-        MONGO_DISALLOW_COPYING(CachedSolution);
+        boost::shared_ptr<PlanRankingDecision> decision;
     };
 
     /**
-     * Caches the best solution to a query.  Aside from the (CanonicalQuery -> QuerySolution)
+     * Caches the best solution to a query.  Aside from the (query shape -> QuerySolution)
      * mapping, the cache contains information on why that mapping was made, and statistics on the
      * cache entry's actual performance on subsequent runs.
+     *
+     * Entries are kept in LRU order and capped at a fixed size; feedback that shows an entry
+     * performing much worse than when it was cached evicts the entry so the next run replans.
+     * Each namespace has its own PlanCache instance with its own lock, so distinct collections
+     * never contend with each other.
      */
     class PlanCache {
     public:
+        explicit PlanCache(const string& ns);
+        ~PlanCache();
+
         /**
-         * Get the (global) cache for the provided namespace.  Must not be held across yields.
-         * As such, there is no locking required.
+         * Get the (global) cache for the provided namespace, creating it on first use.  The
+         * returned pointer is valid for the life of the process; all methods on it do their own
+         * locking and must not be held across yields.
          */
-        static PlanCache* get(const string& ns) { return NULL; }
+        static PlanCache* get(const string& ns);
 
         /**
-         * Record 'solution' as the best plan for 'query' which was picked for reasons detailed in
-         * 'why'.
-         *
-         * Takes ownership of all arguments.
+         * Record 'solution' as the best plan for 'query', which was picked for reasons detailed
+         * in 'why'.  The cache shares ownership of 'solution' and takes ownership of 'why'.
          *
          * If the mapping was added successfully, returns true.
-         * If the mapping already existed or some other error occurred, returns false;
+         * If a mapping for the query's shape already existed, it is replaced and this returns
+         * false.
          */
-        bool add(CanonicalQuery* query, QuerySolution* solution, PlanRankingDecision* why) {
-            return false;
-        }
+        bool add(const CanonicalQuery& query,
+                 const boost::shared_ptr<QuerySolution>& solution,
+                 PlanRankingDecision* why);
 
         /**
-         * Look up the cached solution for the provided query.  If a cached solution exists, return
-         * a copy of it which the caller then owns.  If no cached solution exists, returns NULL.
-         *
-         * TODO: Allow querying for exact query and querying for the shape of the query.
+         * Look up the cached solution for the provided query's shape.  If a cached solution
+         * exists, returns a new CachedSolution which the caller then owns, and marks the entry
+         * most-recently used.  If no cached solution exists, returns NULL.
          */
-        CachedSolution* get(const CanonicalQuery& query) {
-            return NULL;
-        }
+        CachedSolution* get(const CanonicalQuery& query);
 
         /**
          * When the CachedPlanRunner runs a plan out of the cache, we want to record data about the
          * plan's performance.  Cache takes ownership of 'feedback'.
          *
+         * If the feedback shows the plan performing far worse than when it was cached, the entry
+         * is evicted so the next run of this shape replans.
+         *
          * If the (query, solution) pair isn't in the cache, the cache deletes feedback and returns
          * false.  Otherwise, returns true.
          */
         bool feedback(const CanonicalQuery& query, const QuerySolution& solution,
-                      const CachedSolutionFeedback* feedback) {
-            return false;
-        }
+                      const CachedSolutionFeedback* feedback);
 
         /**
          * Remove the (query, solution) pair from our cache.  Returns true if the plan was removed,
          * false if it wasn't found.
          */
-        bool remove(const CanonicalQuery& query, const QuerySolution& solution) {
-            return false;
-        }
+        bool remove(const CanonicalQuery& query, const QuerySolution& solution);
+
+        /**
+         * Discard all cached plans for 'ns'.  Call on any event that invalidates cached
+         * solutions wholesale -- an index drop or a collection drop.  The namespace's cache
+         * object itself stays alive, so pointers from get(ns) remain valid.
+         */
+        static void clear(const string& ns);
+
+        /**
+         * Discard all cached plans for every namespace in database 'dbname' (dropDatabase).
+         */
+        static void clearForDatabase(const string& dbname);
+
+        /**
+         * Compute the cache key for 'query': the structure of the predicate (paths and operators,
+         * not constants) plus the sort and projection.  Exposed for testing.
+         */
+        static string computeKey(const CanonicalQuery& query);
+
+    private:
+        struct Entry {
+            Entry() : baselineWorksPerAdvance(0) { }
+            ~Entry() {
+                for (size_t i = 0; i < feedback.size(); ++i) {
+                    delete feedback[i];
+                }
+            }
+
+            string key;
+            boost::shared_ptr<QuerySolution> solution;
+            boost::shared_ptr<PlanRankingDecision> why;
+
+            // Annotations from cached runs, most recent last.  Bounded at kMaxFeedbackEntries.
+            vector<const CachedSolutionFeedback*> feedback;
+
+            // works/advanced ratio observed by the first feedback; later feedback is compared
+            // against this to detect plans that have gone stale.
+            double baselineWorksPerAdvance;
+
+            // Position in the owning cache's LRU list.
+            std::list<Entry*>::iterator lruIt;
+
+        private:
+            MONGO_DISALLOW_COPYING(Entry);
+        };
+
+        // Maximum number of distinct query shapes cached per namespace.
+        static const size_t kMaxEntries = 200;
+
+        // Maximum feedback records retained per entry.
+        static const size_t kMaxFeedbackEntries = 10;
+
+        // A later feedback whose works/advanced ratio exceeds the baseline by this factor
+        // evicts the entry.
+        static const double kDegradationFactor;
+
+        /**
+         * Removes 'entry' from the map and the LRU list and deletes it.  Must hold _lock.
+         */
+        void _evict(Entry* entry);
+
+        /** Evicts every entry.  Takes _lock. */
+        void _clear();
+
+        typedef unordered_map<string, Entry*> EntryMap;
+
+        // Namespace we cache plans for; used to reach the namespace's QueryShapeStats.
+        string _ns;
+
+        SimpleMutex _lock;
+        EntryMap _entries;
+
+        // Front is most recently used.
+        std::list<Entry*> _lru;
     };
 
 }  // namespace mongo
@@ -37,6 +37,7 @@
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/matcher/expression_array.h"
 #include "mongo/db/matcher/expression_geo.h"
+#include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/index_bounds_builder.h"
@@ -216,6 +217,7 @@ namespace mongo {
             BSONElement natural = sortObj.getFieldDotted("$natural");
             if (!natural.eoo()) {
                 csn->direction = natural.numberInt() >= 0 ? 1 : -1;
+                csn->naturalOrderRequested = true;
             }
         }
 
@@ -224,6 +226,7 @@ namespace mongo {
             BSONElement natural = query.getParsed().getHint().getFieldDotted("$natural");
             if (!natural.eoo()) {
                 csn->direction = natural.numberInt() >= 0 ? 1 : -1;
+                csn->naturalOrderRequested = true;
             }
         }
 
@@ -898,6 +901,135 @@ namespace mongo {
         return NULL;
     }
 
+    /**
+     * Returns true if the interval is a single point ([x, x], both ends inclusive).
+     */
+    bool isPointInterval(const Interval& ival) {
+        return ival.startInclusive && ival.endInclusive
+               && 0 == ival.start.woCompare(ival.end, false);
+    }
+
+    // Cap on the number of per-point scans explodeForSort will create.  Past this many
+    // streams the merge bookkeeping eats the win over a blocking sort.
+    static const size_t kMaxScansToExplode = 64;
+
+    /**
+     * An index scan whose leading field(s) are fixed to point intervals (an equality or a
+     * small $in on 'a' with index {a:1, b:1}) emits one stream sorted by the trailing
+     * fields per point.  If the requested sort matches those trailing fields we can avoid
+     * a blocking SortNode by splitting the scan into one scan per point combination and
+     * merge-sorting the streams.
+     *
+     * If the rewrite applies, rewires *solnRootInOut (taking ownership of what it replaces)
+     * and returns true; the resulting tree provides 'sortObj'.  Otherwise returns false and
+     * leaves the tree untouched.
+     */
+    bool explodeForSort(const BSONObj& sortObj, QuerySolutionNode** solnRootInOut) {
+        QuerySolutionNode* solnRoot = *solnRootInOut;
+
+        // We rewrite a bare index scan or a fetch directly above one.
+        FetchNode* fetch = NULL;
+        IndexScanNode* scan = NULL;
+        if (STAGE_FETCH == solnRoot->getType()) {
+            fetch = static_cast<FetchNode*>(solnRoot);
+            if (STAGE_IXSCAN != fetch->child->getType()) { return false; }
+            scan = static_cast<IndexScanNode*>(fetch->child.get());
+        }
+        else if (STAGE_IXSCAN == solnRoot->getType()) {
+            scan = static_cast<IndexScanNode*>(solnRoot);
+        }
+        else {
+            return false;
+        }
+
+        // A residual filter would have to be cloned onto every per-point scan; punt.
+        if (NULL != scan->filter) { return false; }
+        if (scan->bounds.isSimpleRange) { return false; }
+        // The per-point streams are sorted in key pattern order only for forward scans.
+        if (1 != scan->direction) { return false; }
+
+        vector<BSONElement> kpElts;
+        BSONObjIterator kpIt(scan->indexKeyPattern);
+        while (kpIt.more()) { kpElts.push_back(kpIt.next()); }
+
+        vector<BSONElement> sortElts;
+        BSONObjIterator sortIt(sortObj);
+        while (sortIt.more()) { sortElts.push_back(sortIt.next()); }
+
+        // We need at least one leading field to explode on.
+        if (sortElts.empty() || kpElts.size() < sortElts.size() + 1) { return false; }
+
+        // Find where the sort pattern appears in the key pattern.  Fields of the key
+        // pattern after the sort fields don't matter; each stream is still sorted by
+        // the sort fields.
+        size_t numPrefix = 0;
+        for (numPrefix = 1; numPrefix + sortElts.size() <= kpElts.size(); ++numPrefix) {
+            bool matches = true;
+            for (size_t i = 0; i < sortElts.size(); ++i) {
+                const BSONElement& kpElt = kpElts[numPrefix + i];
+                if (0 != strcmp(kpElt.fieldName(), sortElts[i].fieldName())
+                    || kpElt.numberInt() != sortElts[i].numberInt()) {
+                    matches = false;
+                    break;
+                }
+            }
+            if (matches) { break; }
+        }
+        if (numPrefix + sortElts.size() > kpElts.size()) { return false; }
+        if (scan->bounds.fields.size() < numPrefix) { return false; }
+
+        // Every leading field must be fixed to a manageable number of point values.
+        size_t numScans = 1;
+        for (size_t i = 0; i < numPrefix; ++i) {
+            const vector<Interval>& ivals = scan->bounds.fields[i].intervals;
+            if (ivals.empty()) { return false; }
+            for (size_t j = 0; j < ivals.size(); ++j) {
+                if (!isPointInterval(ivals[j])) { return false; }
+            }
+            numScans *= ivals.size();
+            if (numScans > kMaxScansToExplode) { return false; }
+        }
+
+        // Enumerate the cartesian product of the prefix points, one scan per combination.
+        auto_ptr<MergeSortNode> msn(new MergeSortNode());
+        msn->sort = sortObj;
+
+        vector<size_t> which(numPrefix, 0);
+        for (size_t s = 0; s < numScans; ++s) {
+            IndexScanNode* child = new IndexScanNode();
+            child->indexKeyPattern = scan->indexKeyPattern;
+            child->indexIsMultiKey = scan->indexIsMultiKey;
+            child->direction = scan->direction;
+            child->bounds.fields.resize(scan->bounds.fields.size());
+            for (size_t i = 0; i < numPrefix; ++i) {
+                OrderedIntervalList oil(scan->bounds.fields[i].name);
+                oil.intervals.push_back(scan->bounds.fields[i].intervals[which[i]]);
+                child->bounds.fields[i] = oil;
+            }
+            for (size_t i = numPrefix; i < scan->bounds.fields.size(); ++i) {
+                child->bounds.fields[i] = scan->bounds.fields[i];
+            }
+            msn->children.push_back(child);
+
+            // Advance the odometer over the prefix points.
+            for (size_t i = numPrefix; i > 0; --i) {
+                size_t idx = i - 1;
+                if (++which[idx] < scan->bounds.fields[idx].intervals.size()) { break; }
+                which[idx] = 0;
+            }
+        }
+
+        if (NULL != fetch) {
+            // Reuse the fetch (and its filter); it now fetches the merged stream.
+            fetch->child.reset(msn.release());
+        }
+        else {
+            delete solnRoot;
+            *solnRootInOut = msn.release();
+        }
+        return true;
+    }
+
     // static
     QuerySolution* QueryPlanner::analyzeDataAccess(const CanonicalQuery& query,
                                                    QuerySolutionNode* solnRoot) {
@@ -921,6 +1053,11 @@ namespace mongo {
                 if (0 == sortObj.woCompare(solnRoot->getSort())) {
                     // Sort is already provided!
                 }
+                else if (explodeForSort(sortObj, &solnRoot)) {
+                    // A scan with its leading fields fixed to points emits one stream sorted
+                    // by the trailing fields per point; the sort is now provided by a merge
+                    // of per-point scans instead of a blocking sort stage.
+                }
                 else {
                     // If solnRoot isn't already sorted, let's see if it has the fields we're
                     // sorting on.  If it's fetched, it has all the fields by definition.  If it's
@@ -983,6 +1120,23 @@ namespace mongo {
                     fetch->child.reset(solnRoot);
                     solnRoot = fetch;
                 }
+                else if (STAGE_COLLSCAN == solnRoot->getType()) {
+                    // A collection scan feeding a projection directly (no sort in between,
+                    // whose keys might fall outside the projection) can trim each record
+                    // down to the projected fields as it reads it, rather than pushing
+                    // whole documents through the working set only to discard most of
+                    // them one stage up.  Top-level fields only: a dotted path requires
+                    // the enclosing subobject, which the projection stage extracts.
+                    bool trimmable = fields.size() > 0 && fields.size() < 32;
+                    for (size_t i = 0; trimmable && i < fields.size(); ++i) {
+                        if (fields[i].find('.') != string::npos) {
+                            trimmable = false;
+                        }
+                    }
+                    if (trimmable) {
+                        static_cast<CollectionScanNode*>(solnRoot)->neededFields = fields;
+                    }
+                }
             }
 
             // We now know we have whatever data is required for the projection.
@@ -1046,6 +1200,70 @@ namespace mongo {
         return i.next().eoo();
     }
 
+    /**
+     * Finds an equality predicate over 'path' at the top level of the query (the root, or
+     * a direct child of a root AND) and returns its value, or eoo if there is none.  Only
+     * top-level equalities gate the whole result set, so only they are safe to base
+     * index pruning on.
+     */
+    static BSONElement getTopLevelEquality(MatchExpression* root, const char* path) {
+        if (MatchExpression::EQ == root->matchType()) {
+            if (root->path() == path) {
+                return static_cast<ComparisonMatchExpression*>(root)->getData();
+            }
+        }
+        else if (MatchExpression::AND == root->matchType()) {
+            for (size_t i = 0; i < root->numChildren(); ++i) {
+                MatchExpression* child = root->getChild(i);
+                if (MatchExpression::EQ == child->matchType() && child->path() == path) {
+                    return static_cast<ComparisonMatchExpression*>(child)->getData();
+                }
+            }
+        }
+        return BSONElement();
+    }
+
+    // An index is pruned when the equality on its leading field is estimated to select
+    // over this fraction of its keys and over this many times the best candidate's
+    // fraction.  Both gates are deliberately loose: a wrongly pruned index can't be
+    // rescued by the multi-plan race, so we only drop the clearly hopeless.
+    static const double kPruneMinSelectivity = 0.1;
+    static const double kPruneSkewFactor = 100.0;
+
+    /**
+     * Drops relevant indexes that sampled statistics say are obviously worse choices
+     * than the best candidate.  Indexes without statistics, or without a top-level
+     * equality on their leading field, are never pruned.
+     */
+    static void pruneBySelectivity(MatchExpression* root, vector<IndexEntry>* relevant) {
+        if (relevant->size() < 2) { return; }
+
+        vector<double> selectivity(relevant->size(), -1);
+        double best = numeric_limits<double>::max();
+
+        for (size_t i = 0; i < relevant->size(); ++i) {
+            const IndexEntry& ie = (*relevant)[i];
+            if (!ie.stats) { continue; }
+            BSONElement val = getTopLevelEquality(root, ie.keyPattern.firstElement().fieldName());
+            if (val.eoo()) { continue; }
+            selectivity[i] = ie.stats->equalitySelectivity(val);
+            if (selectivity[i] < best) { best = selectivity[i]; }
+        }
+
+        if (numeric_limits<double>::max() == best) { return; }
+
+        vector<IndexEntry> kept;
+        for (size_t i = 0; i < relevant->size(); ++i) {
+            if (selectivity[i] > kPruneMinSelectivity
+                && selectivity[i] >= kPruneSkewFactor * best) {
+                continue;
+            }
+            kept.push_back((*relevant)[i]);
+        }
+
+        if (!kept.empty()) { relevant->swap(kept); }
+    }
+
     // static
     void QueryPlanner::plan(const CanonicalQuery& query, const vector<IndexEntry>& indices,
                             size_t options, vector<QuerySolution*>* out) {
@@ -1146,6 +1364,13 @@ namespace mongo {
         }
         else {
             findRelevantIndices(fields, indices, &relevantIndices);
+
+            // When we have sampled statistics for the candidates, prune indexes whose
+            // leading field is matched by an equality but selects a large, far worse
+            // than best fraction of its keys -- they'd only slow the multi-plan race
+            // down.  Must happen before rateIndices, which tags predicates with
+            // positions into relevantIndices.
+            pruneBySelectivity(query.root(), &relevantIndices);
         }
 
         // Figure out how useful each index is to each predicate.
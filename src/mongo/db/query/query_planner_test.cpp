@@ -404,6 +404,21 @@ namespace {
         }
     }
 
+    TEST_F(IndexAssignmentTest, ProjectionPushedIntoCollscan) {
+        // query, sort, proj
+        runDetailedQuery(BSONObj(), BSONObj(), fromjson("{_id: 0, x: 1}"));
+        ASSERT_EQUALS(getNumSolutions(), 1U);
+
+        QuerySolution* soln;
+        getPlanByType(STAGE_PROJECTION, &soln);
+        ProjectionNode* pn = static_cast<ProjectionNode*>(soln->root.get());
+        ASSERT(STAGE_COLLSCAN == pn->child->getType());
+        // The scan itself trims each record down to the projected fields.
+        CollectionScanNode* csn = static_cast<CollectionScanNode*>(pn->child.get());
+        ASSERT_EQUALS(csn->neededFields.size(), 1U);
+        ASSERT_EQUALS(csn->neededFields[0], "x");
+    }
+
     //
     // Basic sort elimination
     //
@@ -421,6 +436,45 @@ namespace {
         getPlanByType(STAGE_FETCH, &indexedSolution);
     }
 
+    //
+    // Sort elimination by exploding a point prefix into a merge sort
+    //
+
+    TEST_F(IndexAssignmentTest, ExplodeInForSort) {
+        addIndex(BSON("a" << 1 << "b" << 1));
+        runDetailedQuery(fromjson("{a: {$in: [1, 2]}}"), fromjson("{b: 1}"), BSONObj());
+        ASSERT_EQUALS(getNumSolutions(), 2U);
+
+        // Collscan + blocking sort...
+        QuerySolution* collScanSolution;
+        getPlanByType(STAGE_SORT, &collScanSolution);
+
+        // ...and a merge sort over one scan per $in value, no sort stage.
+        QuerySolution* indexedSolution;
+        getPlanByType(STAGE_FETCH, &indexedSolution);
+        ASSERT_FALSE(indexedSolution->hasSortStage);
+        FetchNode* fetch = static_cast<FetchNode*>(indexedSolution->root.get());
+        ASSERT_EQUALS(fetch->child->getType(), STAGE_SORT_MERGE);
+        MergeSortNode* msn = static_cast<MergeSortNode*>(fetch->child.get());
+        ASSERT_EQUALS(msn->children.size(), 2U);
+        for (size_t i = 0; i < msn->children.size(); ++i) {
+            ASSERT_EQUALS(msn->children[i]->getType(), STAGE_IXSCAN);
+        }
+    }
+
+    TEST_F(IndexAssignmentTest, ExplodeEqualityForSort) {
+        addIndex(BSON("a" << 1 << "b" << 1));
+        runDetailedQuery(fromjson("{a: 5}"), fromjson("{b: 1}"), BSONObj());
+
+        QuerySolution* indexedSolution;
+        getPlanByType(STAGE_FETCH, &indexedSolution);
+        ASSERT_FALSE(indexedSolution->hasSortStage);
+        FetchNode* fetch = static_cast<FetchNode*>(indexedSolution->root.get());
+        ASSERT_EQUALS(fetch->child->getType(), STAGE_SORT_MERGE);
+        MergeSortNode* msn = static_cast<MergeSortNode*>(fetch->child.get());
+        ASSERT_EQUALS(msn->children.size(), 1U);
+    }
+
     //
     // Basic compound
     //
@@ -0,0 +1,181 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/query/query_shape_stats.h"
+
+#include "mongo/db/exec/plan_stats.h"
+
+namespace mongo {
+
+    namespace {
+
+        // Registry of per-namespace stores.  Stores are created on first use and never
+        // destroyed, mirroring the PlanCache registry.
+        SimpleMutex shapeStatsRegistryLock("queryShapeStatsRegistry");
+        typedef unordered_map<string, QueryShapeStats*> ShapeStatsMap;
+        ShapeStatsMap* shapeStats = NULL;
+
+    }  // namespace
+
+    QueryShapeStats::QueryShapeStats() : _lock("QueryShapeStats") { }
+
+    QueryShapeStats::~QueryShapeStats() {
+        for (ShapeMap::const_iterator it = _shapes.begin(); it != _shapes.end(); ++it) {
+            delete it->second;
+        }
+    }
+
+    // static
+    QueryShapeStats* QueryShapeStats::get(const string& ns) {
+        SimpleMutex::scoped_lock lk(shapeStatsRegistryLock);
+        if (NULL == shapeStats) {
+            shapeStats = new ShapeStatsMap();
+        }
+        ShapeStatsMap::const_iterator it = shapeStats->find(ns);
+        if (it != shapeStats->end()) {
+            return it->second;
+        }
+        QueryShapeStats* stats = new QueryShapeStats();
+        (*shapeStats)[ns] = stats;
+        return stats;
+    }
+
+    // static
+    double QueryShapeStats::worksPerAdvance(const PlanStageStats* stats) {
+        if (NULL == stats || 0 == stats->common.works) { return 0; }
+        uint64_t advanced = stats->common.advanced;
+        if (0 == advanced) { advanced = 1; }
+        return static_cast<double>(stats->common.works) / advanced;
+    }
+
+    void QueryShapeStats::recordTrial(const string& key,
+                                      const string& winningPlan,
+                                      size_t numCandidates,
+                                      double trialWorksPerAdvance) {
+        SimpleMutex::scoped_lock lk(_lock);
+        Shape* shape = _getOrCreate(key);
+        shape->trials++;
+        shape->winningPlan = winningPlan;
+        shape->numCandidates = numCandidates;
+        shape->trialWorksPerAdvance = trialWorksPerAdvance;
+        if (trialWorksPerAdvance > 0) {
+            // Trials count toward the historical best but not toward the run average;
+            // a trial only works each plan a bounded number of times.
+            if (0 == shape->minWorksPerAdvance || trialWorksPerAdvance < shape->minWorksPerAdvance) {
+                shape->minWorksPerAdvance = trialWorksPerAdvance;
+            }
+        }
+    }
+
+    void QueryShapeStats::recordRun(const string& key, double observedWorksPerAdvance) {
+        SimpleMutex::scoped_lock lk(_lock);
+        Shape* shape = _getOrCreate(key);
+        shape->runs++;
+        _observe(shape, observedWorksPerAdvance);
+    }
+
+    void QueryShapeStats::recordEviction(const string& key) {
+        SimpleMutex::scoped_lock lk(_lock);
+        Shape* shape = _getOrCreate(key);
+        shape->evictions++;
+    }
+
+    double QueryShapeStats::historicalBestWorksPerAdvance(const string& key) const {
+        SimpleMutex::scoped_lock lk(_lock);
+        ShapeMap::const_iterator it = _shapes.find(key);
+        if (it == _shapes.end()) {
+            return 0;
+        }
+        return it->second->minWorksPerAdvance;
+    }
+
+    void QueryShapeStats::appendStats(BSONObjBuilder* b) const {
+        SimpleMutex::scoped_lock lk(_lock);
+        BSONArrayBuilder shapes(b->subarrayStart("shapes"));
+        // Walk the LRU list so the hottest shapes come first.
+        for (std::list<Shape*>::const_iterator it = _lru.begin(); it != _lru.end(); ++it) {
+            const Shape* shape = *it;
+            BSONObjBuilder sb(shapes.subobjStart());
+            sb.append("shape", shape->key);
+            sb.append("winningPlan", shape->winningPlan);
+            sb.appendNumber("candidates", shape->numCandidates);
+            sb.appendNumber("trials", shape->trials);
+            sb.appendNumber("runs", shape->runs);
+            sb.appendNumber("evictions", shape->evictions);
+            BSONObjBuilder wb(sb.subobjStart("worksPerReturned"));
+            wb.append("trial", shape->trialWorksPerAdvance);
+            wb.append("last", shape->lastWorksPerAdvance);
+            wb.append("min", shape->minWorksPerAdvance);
+            wb.append("max", shape->maxWorksPerAdvance);
+            wb.append("avg", shape->runs > 0 ? shape->totalWorksPerAdvance / shape->runs : 0);
+            wb.done();
+            sb.done();
+        }
+        shapes.done();
+    }
+
+    QueryShapeStats::Shape* QueryShapeStats::_getOrCreate(const string& key) {
+        ShapeMap::const_iterator it = _shapes.find(key);
+        if (it != _shapes.end()) {
+            Shape* shape = it->second;
+            // Move to the hot end of the LRU list.
+            _lru.erase(shape->lruIt);
+            _lru.push_front(shape);
+            shape->lruIt = _lru.begin();
+            return shape;
+        }
+
+        // Cap the number of shapes we track; forget the coldest one.
+        if (_shapes.size() >= kMaxShapes) {
+            Shape* coldest = _lru.back();
+            _lru.pop_back();
+            _shapes.erase(coldest->key);
+            delete coldest;
+        }
+
+        Shape* shape = new Shape();
+        shape->key = key;
+        _lru.push_front(shape);
+        shape->lruIt = _lru.begin();
+        _shapes[key] = shape;
+        return shape;
+    }
+
+    // static
+    void QueryShapeStats::_observe(Shape* shape, double worksPerAdvance) {
+        shape->lastWorksPerAdvance = worksPerAdvance;
+        shape->totalWorksPerAdvance += worksPerAdvance;
+        if (0 == shape->minWorksPerAdvance || worksPerAdvance < shape->minWorksPerAdvance) {
+            shape->minWorksPerAdvance = worksPerAdvance;
+        }
+        if (worksPerAdvance > shape->maxWorksPerAdvance) {
+            shape->maxWorksPerAdvance = worksPerAdvance;
+        }
+    }
+
+}  // namespace mongo
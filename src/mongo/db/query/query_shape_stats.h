@@ -0,0 +1,166 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <list>
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    struct PlanStageStats;
+
+    /**
+     * Accumulates per-query-shape planning and execution statistics for a namespace: how often
+     * a shape went through a plan competition, what plan won, and the works/advanced ratios
+     * reported by later cached runs of that shape.  The PlanCache consults the history when
+     * setting the baseline for a freshly cached plan, and the queryShapeStats command exposes
+     * everything so a plan that degrades as the data distribution shifts shows up in the
+     * numbers rather than in customer complaints.
+     *
+     * Shapes are keyed exactly as in the PlanCache (predicate structure, sort and projection;
+     * no constants).  Everything lives in memory; statistics restart with the process.
+     */
+    class QueryShapeStats {
+    public:
+        QueryShapeStats();
+        ~QueryShapeStats();
+
+        /**
+         * Get the (global) statistics store for the provided namespace, creating it on first
+         * use.  The returned pointer is valid for the life of the process; all methods do
+         * their own locking.
+         */
+        static QueryShapeStats* get(const string& ns);
+
+        /**
+         * works/advanced for a stats tree; the "effort per returned document" signal used
+         * throughout.  Returns 0 when stats are missing or the plan never worked.
+         */
+        static double worksPerAdvance(const PlanStageStats* stats);
+
+        /**
+         * Record the outcome of a plan competition for 'key': the winning plan (as rendered by
+         * QuerySolution::toString()), how many candidates competed, and the winner's
+         * works/advanced ratio during the trial period.
+         */
+        void recordTrial(const string& key,
+                         const string& winningPlan,
+                         size_t numCandidates,
+                         double trialWorksPerAdvance);
+
+        /**
+         * Record the works/advanced ratio observed by one full cached run of 'key'.
+         */
+        void recordRun(const string& key, double observedWorksPerAdvance);
+
+        /**
+         * Record that 'key' was evicted from the plan cache because feedback showed the plan
+         * performing far worse than its baseline.
+         */
+        void recordEviction(const string& key);
+
+        /**
+         * The best (lowest) works/advanced ratio ever seen for 'key', across both trials and
+         * cached runs.  Returns 0 if the shape has no history.
+         */
+        double historicalBestWorksPerAdvance(const string& key) const;
+
+        /**
+         * Append a 'shapes' array with one document per tracked shape to 'b'.  This is the
+         * payload of the queryShapeStats command.
+         */
+        void appendStats(BSONObjBuilder* b) const;
+
+    private:
+        struct Shape {
+            Shape() : trials(0),
+                      runs(0),
+                      evictions(0),
+                      numCandidates(0),
+                      trialWorksPerAdvance(0),
+                      lastWorksPerAdvance(0),
+                      minWorksPerAdvance(0),
+                      maxWorksPerAdvance(0),
+                      totalWorksPerAdvance(0) { }
+
+            string key;
+
+            // Rendering of the solution that won the most recent plan competition.
+            string winningPlan;
+
+            long long trials;
+            long long runs;
+            long long evictions;
+
+            // Number of candidates in the most recent competition.
+            long long numCandidates;
+
+            // works/advanced of the winner during the most recent trial period.
+            double trialWorksPerAdvance;
+
+            // works/advanced across cached runs; min also folds in trial outcomes so it is
+            // the best the shape has ever done.
+            double lastWorksPerAdvance;
+            double minWorksPerAdvance;
+            double maxWorksPerAdvance;
+            double totalWorksPerAdvance;
+
+            // Position in the owning store's LRU list.
+            std::list<Shape*>::iterator lruIt;
+        };
+
+        // Maximum number of distinct shapes tracked per namespace.
+        static const size_t kMaxShapes = 500;
+
+        /**
+         * Returns the stats for 'key', creating them (and evicting the coldest shape if we are
+         * full) as needed.  Must hold _lock.
+         */
+        Shape* _getOrCreate(const string& key);
+
+        /**
+         * Folds a works/advanced observation into the min/max/total counters.  Must hold
+         * _lock.
+         */
+        static void _observe(Shape* shape, double worksPerAdvance);
+
+        typedef unordered_map<string, Shape*> ShapeMap;
+
+        mutable SimpleMutex _lock;
+        ShapeMap _shapes;
+
+        // Front is most recently used.
+        std::list<Shape*> _lru;
+    };
+
+}  // namespace mongo
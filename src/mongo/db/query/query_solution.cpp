@@ -34,7 +34,8 @@ namespace mongo {
     // CollectionScanNode
     //
 
-    CollectionScanNode::CollectionScanNode() : tailable(false), direction(1), filter(NULL) { }
+    CollectionScanNode::CollectionScanNode()
+        : tailable(false), direction(1), naturalOrderRequested(false), filter(NULL) { }
 
     void CollectionScanNode::appendToString(stringstream* ss, int indent) const {
         addIndent(ss, indent);
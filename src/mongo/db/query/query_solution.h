@@ -176,6 +176,16 @@ namespace mongo {
 
         int direction;
 
+        // True if the query asked for $natural order (sort or hint), i.e. the scan must
+        // surface documents in storage order, not just any order.
+        bool naturalOrderRequested;
+
+        // If non-empty, the scan only surfaces these top-level fields of each matching
+        // record, copied out in one pass over the raw BSON.  Set by the planner when a
+        // projection sits directly above a bare collection scan.  Empty means surface
+        // whole (unowned) documents.
+        vector<string> neededFields;
+
         scoped_ptr<MatchExpression> filter;
     };
 
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "mongo/db/clientcursor.h"
+#include "mongo/db/d_concurrency.h"
 #include "mongo/util/elapsed_tracker.h"
 
 namespace mongo {
@@ -46,6 +47,9 @@ namespace mongo {
         }
 
         bool shouldYield() {
+            // A blocked writer can't make progress until we yield; go now rather
+            // than making it wait out the rest of our interval.
+            if (Lock::writersWaiting() > 0) { return true; }
             return _elapsedTracker.intervalHasElapsed();
         }
 
@@ -58,8 +62,12 @@ namespace mongo {
         bool yieldAndCheckIfOK(Runner* runner) {
             verify(runner);
             int micros = ClientCursor::suggestYieldMicros();
-            // No point in yielding.
-            if (micros <= 0) { return true; }
+            // No point in yielding.  Don't recheck (suggestYieldMicros walks the
+            // client list) until the next interval elapses.
+            if (micros <= 0) {
+                _elapsedTracker.resetLastTime();
+                return true;
+            }
 
             // If micros > 0, we should yield.
             runner->saveState();
@@ -82,8 +90,8 @@ namespace mongo {
             int micros = ClientCursor::suggestYieldMicros();
             if (micros > 0) {
                 staticYield(micros, rec);
-                _elapsedTracker.resetLastTime();
             }
+            _elapsedTracker.resetLastTime();
         }
 
         static void staticYield(int micros, Record* rec = NULL) {
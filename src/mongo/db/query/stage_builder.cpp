@@ -31,6 +31,7 @@
 #include "mongo/db/exec/and_hash.h"
 #include "mongo/db/exec/and_sorted.h"
 #include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/exchange.h"
 #include "mongo/db/exec/fetch.h"
 #include "mongo/db/exec/index_scan.h"
 #include "mongo/db/exec/limit.h"
@@ -53,6 +54,7 @@ namespace mongo {
             params.tailable = csn->tailable;
             params.direction = (csn->direction == 1) ? CollectionScanParams::FORWARD
                                                      : CollectionScanParams::BACKWARD;
+            params.neededFields = csn->neededFields;
             return new CollectionScan(params, ws, csn->filter.get());
         }
         else if (STAGE_IXSCAN == root->getType()) {
@@ -203,6 +205,25 @@ namespace mongo {
         QuerySolutionNode* root = solution.root.get();
         if (NULL == root) { return false; }
 
+        // A forward unordered table scan at the root of the plan can be parallelized:
+        // slice the collection's extents across worker threads and merge their output.
+        // Off unless internalQueryExchangeWorkers is set; see ExchangeStage.
+        if (STAGE_COLLSCAN == root->getType()) {
+            const CollectionScanNode* csn = static_cast<const CollectionScanNode*>(root);
+            if (!csn->tailable && 1 == csn->direction && !csn->naturalOrderRequested
+                && csn->neededFields.empty()
+                && solution.filterData["$where"].eoo()) {
+                int workers = ExchangeStage::suggestedWorkers(solution.ns);
+                if (workers > 0) {
+                    auto_ptr<WorkingSet> exchangeWs(new WorkingSet());
+                    *rootOut = new ExchangeStage(solution.ns, solution.filterData, workers,
+                                                 exchangeWs.get());
+                    *wsOut = exchangeWs.release();
+                    return true;
+                }
+            }
+        }
+
         auto_ptr<WorkingSet> ws(new WorkingSet());
         PlanStage* stageRoot = buildStages(solution.ns, root, ws.get());
 
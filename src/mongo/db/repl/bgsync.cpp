@@ -35,6 +35,7 @@
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/rs_sync.h"
 #include "mongo/db/repl/rs.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/base/counter.h"
 #include "mongo/db/stats/timer_stats.h"
@@ -45,6 +46,13 @@ namespace replset {
     int SleepToAllowBatchingMillis = 2;
     const int BatchIsSmallish = 40000; // bytes
 
+    // transport tuning for high-latency (cross-datacenter) sync sources: snappy
+    // compress oplog batches on the wire, and keep the next getMore in flight
+    // while the current batch is being buffered.  neither pays for itself on a
+    // low-latency local link, so both default off.
+    MONGO_EXPORT_SERVER_PARAMETER(replCompressedOplogFetch, bool, false);
+    MONGO_EXPORT_SERVER_PARAMETER(replPipelinedOplogFetch, bool, false);
+
     MONGO_FP_DECLARE(rsBgSyncProduce);
 
     BackgroundSync* BackgroundSync::s_instance = 0;
@@ -335,6 +343,14 @@ namespace replset {
             lastOpTimeFetched = _lastOpTimeFetched;
         }
 
+        if (replCompressedOplogFetch) {
+            // announce on our requests that we decompress; the sync source then
+            // snappy compresses the batches it sends back (see
+            // MessagingPort::setSendCompressed).  an old sync source ignores the
+            // announcement and replies uncompressed.
+            r.conn()->port().setSendCompressed(true);
+        }
+
         r.tailingQueryGTE(rsoplog, lastOpTimeFetched);
 
         // if target cut connections between connecting and querying (for
@@ -417,6 +433,14 @@ namespace replset {
                 }
             }
 
+            if (replPipelinedOplogFetch) {
+                // double buffering: with a batch in hand, start the next fetch now
+                // so the round trip to the sync source overlaps with buffering and
+                // application instead of stalling the fetch loop.  no-op if the
+                // prefetched reply hasn't been consumed yet.
+                r.prefetchMore();
+            }
+
             // At this point, we are guaranteed to have at least one thing to read out
             // of the oplogreader cursor.
             BSONObj o = r.nextSafe().getOwned();
@@ -33,12 +33,33 @@
 #include "mongo/db/matcher.h"
 #include "mongo/db/query_plan.h"
 #include "mongo/db/queryutil.h"
+#include "mongo/db/repl/oplog_skip_index.h"
 
 namespace mongo {
 
     // Configurable for testing.
     int FindingStartCursor::_initialTimeout = 5;
 
+    namespace {
+        /**
+         * the lower ts bound the oplog query scans from, or a null OpTime if the
+         * query shape isn't one the skip index can serve ({ts: {$gt[e]: T}} or
+         * {ts: T})
+         */
+        OpTime extractTsLowerBound( const BSONElement& tsElt ) {
+            BSONElement e = tsElt;
+            if ( tsElt.type() == Object ) {
+                BSONElement inner = tsElt.Obj().firstElement();
+                if ( strncmp( inner.fieldName(), "$gt", 3 ) != 0 ) // $gt / $gte
+                    return OpTime();
+                e = inner;
+            }
+            if ( e.type() != Timestamp && e.type() != Date )
+                return OpTime();
+            return e._opTime();
+        }
+    }
+
     // -------------------------------------
 
     FindingStartCursor *FindingStartCursor::make( const QueryPlan &qp ) {
@@ -183,6 +204,33 @@ namespace mongo {
             _findingStart = false;
             return;
         }
+
+        // Try the sparse in-memory ts index first: a successful seek starts the scan
+        // a short forward hop from the answer instead of binary searching extents
+        // backwards from the tail.
+        const OpTime bound = extractTsLowerBound( tsElt );
+        if ( !bound.isNull() ) {
+            OplogSkipIndex* skip = OplogSkipIndex::forNs( _qp.ns() );
+            skip->rebuildIfNeeded( _qp.nsd() );
+            DiskLoc hint;
+            OpTime hintTs;
+            while ( skip->seek( bound, &hint, &hintTs ) ) {
+                BSONObj at = BSONObj::make( hint.rec() );
+                BSONElement atTs = at["ts"];
+                if ( ( atTs.type() == Timestamp || atTs.type() == Date ) &&
+                     atTs._opTime() == hintTs ) {
+                    // slot still holds the op we noted (ts is unique per oplog);
+                    // scan forward from here to the first match
+                    createClientCursor( hint );
+                    _findingStartTimer.reset();
+                    _findingStartMode = InExtent;
+                    return;
+                }
+                // the cap wrapped over this entry; drop it and anything older
+                skip->invalidateThrough( hintTs );
+            }
+        }
+
         // Use a ClientCursor here so we can release db mutex while scanning
         // oplog (can take quite a while with large oplogs).
         shared_ptr<Cursor> c = _qp.newReverseCursor();
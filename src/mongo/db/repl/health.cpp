@@ -475,6 +475,15 @@ namespace mongo {
             bb.appendTimeT("lastHeartbeat", m->hbinfo().lastHeartbeat);
             bb.appendTimeT("lastHeartbeatRecv", m->hbinfo().lastHeartbeatRecv);
             bb.append("pingMs", m->hbinfo().ping);
+            const PingHistogram& hist = m->hbinfo().pingHist;
+            if( hist.count() ) {
+                // bucket i counts round trips of at most 2^i ms; last bucket is slower
+                BSONArrayBuilder ph( bb.subarrayStart("pingHistogramMs") );
+                for( int i = 0; i < PingHistogram::kNumBuckets; i++ )
+                    ph.append( (int) hist.bucket(i) );
+                ph.done();
+                bb.append("pingAvgMs", (double) hist.totalMs() / hist.count());
+            }
             string s = m->lhb();
             if( !s.empty() )
                 bb.append("lastHeartbeatMessage", s);
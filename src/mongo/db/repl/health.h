@@ -34,14 +34,18 @@
 
 namespace mongo {
 
-    /* throws */
+    class DBClientConnection;
+
+    /* throws.  runs on 'conn' when one is given, otherwise on the shared
+       ScopedConn for the member. */
     bool requestHeartbeat(const std::string& setname,
                           const std::string& fromHost,
                           const std::string& memberFullName,
                           BSONObj& result,
                           int myConfigVersion,
                           int& theirConfigVersion,
-                          bool checkEmpty = false);
+                          bool checkEmpty = false,
+                          DBClientConnection* conn = NULL);
 
     struct HealthOptions {
         HealthOptions() :  
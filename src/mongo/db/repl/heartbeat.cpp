@@ -56,6 +56,7 @@ namespace mongo {
     extern bool replSetBlind;
 
     unsigned int HeartbeatInfo::numPings;
+    const int PingHistogram::kNumBuckets;
 
     long long HeartbeatInfo::timeDown() const {
         if( up() ) return 0;
@@ -78,6 +79,7 @@ namespace mongo {
         skew = newInfo.skew;
         authIssue = newInfo.authIssue;
         ping = newInfo.ping;
+        pingHist = newInfo.pingHist;
     }
 
     /* { replSetHeartbeat : <setname> } */
@@ -194,7 +196,8 @@ namespace mongo {
                           BSONObj& result,
                           int myCfgVersion,
                           int& theirCfgVersion,
-                          bool checkEmpty) {
+                          bool checkEmpty,
+                          DBClientConnection* conn) {
         if( replSetBlind ) {
             return false;
         }
@@ -214,8 +217,13 @@ namespace mongo {
                             "checkEmpty" << checkEmpty <<
                             "from" << from );
 
-        ScopedConn conn(memberFullName);
-        return conn.runCommand("admin", cmd, result, 0);
+        if ( conn ) {
+            // health poll tasks supply their own dedicated connection
+            return conn->runCommand("admin", cmd, result, 0);
+        }
+
+        ScopedConn sharedConn(memberFullName);
+        return sharedConn.runCommand("admin", cmd, result, 0);
     }
 
     /**
@@ -278,6 +286,12 @@ namespace mongo {
 
                 bool ok = _requestHeartbeat(mem, info, theirConfigVersion);
 
+                if (ok) {
+                    // raw round trip, before smoothing; the histogram shows the tail
+                    // latency that the weighted average below hides
+                    mem.pingHist.record(mem.ping);
+                }
+
                 // weight new ping with old pings
                 // on the first ping, just use the ping value
                 if (old.ping != 0) {
@@ -328,7 +342,7 @@ namespace mongo {
             try {
                 ok = requestHeartbeat(theReplSet->name(), theReplSet->selfFullName(),
                                       h.toString(), *info, theReplSet->config().version,
-                                      *theirConfigVersion);
+                                      *theirConfigVersion, false, _conn.get());
             }
             catch (DBException&) {
                 // don't do anything, ok is already false
@@ -337,15 +351,44 @@ namespace mongo {
             return ok;
         }
 
-        bool _requestHeartbeat(HeartbeatInfo& mem, BSONObj& info, int& theirConfigVersion) {
-            {
-                ScopedConn conn(h.toString());
-                conn.setTimeout(_timeout);
-                if (tries++ % threshold == (threshold - 1)) {
-                    conn.reconnect();
-                }
+        /**
+         * Heartbeats run on their own persistent connection rather than the shared
+         * per-host ScopedConn: anything else holding that connection's lock (config
+         * pushes, election traffic) would add its round trip to our ping time and
+         * can push it past the heartbeat timeout under load.  Reconnects every
+         * 'threshold' rounds as before, staggered across tasks by s_try_offset.
+         *
+         * Throws on connect failure so doWork() marks the member down.
+         */
+        void ensureConnection() {
+            if (_conn && (tries++ % threshold != (threshold - 1))) {
+                return;
             }
 
+            _conn.reset(new DBClientConnection(/*autoReconnect*/ true, 0, _timeout));
+            _conn->_logLevel = logger::LogSeverity::Debug(2);
+            string err;
+            if (!_conn->connect(h.toString(), err)) {
+                _conn.reset();
+                uasserted(17528, str::stream() << "heartbeat couldn't connect to "
+                                               << h.toString() << ": " << err);
+            }
+
+            // stays open when other sockets get closed out
+            _conn->port().tag |= ScopedConn::keepOpen;
+
+            if (getGlobalAuthorizationManager()->isAuthEnabled() &&
+                !authenticateInternalUser(_conn.get())) {
+                _conn.reset();
+                uasserted(17529, str::stream() << "heartbeat couldn't authenticate to "
+                                               << h.toString());
+            }
+        }
+
+        bool _requestHeartbeat(HeartbeatInfo& mem, BSONObj& info, int& theirConfigVersion) {
+            ensureConnection();
+            _conn->setSoTimeout(_timeout);
+
             Timer timer;
             time_t before = curTimeMicros64() / 1000000;
 
@@ -359,10 +402,7 @@ namespace mongo {
                 log() << "replset info " << h.toString() << " heartbeat failed, retrying" << rsLog;
 
                 // lower timeout to remaining ping time
-                {
-                    ScopedConn conn(h.toString());
-                    conn.setTimeout(_timeout - totalSecs);
-                }
+                _conn->setSoTimeout(_timeout - totalSecs);
 
                 int checkpoint = timer.millis();
                 timer.reset();
@@ -371,10 +411,7 @@ namespace mongo {
                 totalSecs = (checkpoint + mem.ping)/1000;
 
                 // set timeout back to default
-                {
-                    ScopedConn conn(h.toString());
-                    conn.setTimeout(_timeout);
-                }
+                _conn->setSoTimeout(_timeout);
             }
 
             // we set this on any response - we don't get this far if
@@ -499,6 +536,9 @@ namespace mongo {
 
         // Heartbeat timeout
         time_t _timeout;
+
+        // Dedicated persistent connection; see ensureConnection().
+        scoped_ptr<DBClientConnection> _conn;
     };
 
     int ReplSetHealthPollTask::s_try_offset = 0;
@@ -32,6 +32,7 @@
 
 #include "mongo/db/repl/oplog.h"
 
+#include <deque>
 #include <vector>
 
 #include "mongo/db/auth/action_set.h"
@@ -48,6 +49,9 @@
 #include "mongo/db/ops/update.h"
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/repl/bgsync.h"
+#include "mongo/db/repl/oplog_delta.h"
+#include "mongo/db/repl/oplog_skip_index.h"
+#include "mongo/db/repl/oplog_window.h"
 #include "mongo/db/repl/replication_server_status.h"
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/repl/write_concern.h"
@@ -64,6 +68,11 @@ namespace mongo {
     static NamespaceDetails *localOplogMainDetails = 0;
     static Database *localDB = 0;
     static NamespaceDetails *rsOplogDetails = 0;
+
+    // sparse ts -> DiskLoc indexes so FindingStartCursor can seek instead of
+    // binary searching extents; registry-owned, so no reset on db close needed
+    static OplogSkipIndex *rsOplogSkip = 0;
+    static OplogSkipIndex *mainOplogSkip = 0;
     void oplogCheckCloseDatabase( Database * db ) {
         verify( Lock::isW() );
         localDB = 0;
@@ -97,8 +106,13 @@ namespace mongo {
             Client::Context ctx(logns , localDB);
             {
                 int len = op.objsize();
-                Record *r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len);
+                DiskLoc loc;
+                Record *r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len, &loc);
                 memcpy(getDur().writingPtr(r->data(), len), op.objdata(), len);
+                if ( !rsOplogSkip )
+                    rsOplogSkip = OplogSkipIndex::forNs(logns);
+                rsOplogSkip->note(ts, loc);
+                theOplogWindow.note(op);
             }
             /* todo: now() has code to handle clock skew.  but if the skew server to server is large it will get unhappy.
                      this code (or code in now() maybe) should be improved.
@@ -126,6 +140,59 @@ namespace mongo {
         OpTime::setLast( ts );
     }
 
+    void writeOpsToOplog(const std::deque<BSONObj>& ops) {
+        if( ops.empty() )
+            return;
+
+        Lock::DBWrite lk("local");
+
+        const char *logns = rsoplog;
+        if ( rsOplogDetails == 0 ) {
+            Client::Context ctx(logns, storageGlobalParams.dbpath);
+            localDB = ctx.db();
+            verify( localDB );
+            rsOplogDetails = nsdetails(logns);
+            massert(17511, "local.oplog.rs missing. did you drop it? if so restart server", rsOplogDetails);
+        }
+        Client::Context ctx(logns, localDB);
+
+        if ( !rsOplogSkip )
+            rsOplogSkip = OplogSkipIndex::forNs(logns);
+
+        for( std::deque<BSONObj>::const_iterator i = ops.begin(); i != ops.end(); ++i ) {
+            const BSONObj& op = *i;
+            int len = op.objsize();
+            DiskLoc loc;
+            Record *r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len, &loc);
+            memcpy(getDur().writingPtr(r->data(), len), op.objdata(), len);
+            rsOplogSkip->note(op["ts"]._opTime(), loc);
+            theOplogWindow.note(op);
+        }
+
+        const OpTime ts = ops.back()["ts"]._opTime();
+        if( theReplSet ) {
+            const OpTime firstTs = ops.front()["ts"]._opTime();
+            if( !(theReplSet->lastOpTimeWritten<firstTs) ) {
+                log() << "replication oplog stream went back in time. previous timestamp: "
+                      << theReplSet->lastOpTimeWritten << " newest timestamp: " << firstTs
+                      << ". attempting to sync directly from primary." << endl;
+                std::string errmsg;
+                BSONObjBuilder result;
+                if (!theReplSet->forceSyncFrom(theReplSet->box.getPrimary()->fullName(),
+                                               errmsg, result)) {
+                    log() << "Can't sync from primary: " << errmsg << endl;
+                }
+            }
+            theReplSet->lastOpTimeWritten = ts;
+            theReplSet->lastH = ops.back()["h"].numberLong();
+            ctx.getClient()->setLastOp( ts );
+
+            replset::BackgroundSync::notify();
+        }
+
+        OpTime::setLast( ts );
+    }
+
     /** given a BSON object, create a new one at dst which is the existing (partial) object
         with a new object element appended at the end with fieldname "o".
 
@@ -236,7 +303,11 @@ namespace mongo {
                 massert(13347, "local.oplog.rs missing. did you drop it? if so restart server", rsOplogDetails);
             }
             Client::Context ctx(logns , localDB);
-            r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len);
+            DiskLoc loc;
+            r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len, &loc);
+            if ( !rsOplogSkip )
+                rsOplogSkip = OplogSkipIndex::forNs(logns);
+            rsOplogSkip->note(ts, loc);
             /* todo: now() has code to handle clock skew.  but if the skew server to server is large it will get unhappy.
                      this code (or code in now() maybe) should be improved.
                      */
@@ -260,6 +331,8 @@ namespace mongo {
 
         append_O_Obj(r->data(), partial, obj);
 
+        theOplogWindow.note( BSONObj::make(r) );
+
         LOG( 6 ) << "logOp:" << BSONObj::make(r) << endl;
     }
 
@@ -310,7 +383,11 @@ namespace mongo {
                 verify( localOplogMainDetails );
             }
             Client::Context ctx(logNS , localDB);
-            r = theDataFileMgr.fast_oplog_insert(localOplogMainDetails, logNS, len);
+            DiskLoc loc;
+            r = theDataFileMgr.fast_oplog_insert(localOplogMainDetails, logNS, len, &loc);
+            if ( !mainOplogSkip )
+                mainOplogSkip = OplogSkipIndex::forNs(logNS);
+            mainOplogSkip->note(ts, loc);
         }
         else {
             Client::Context ctx(logNS, storageGlobalParams.dbpath);
@@ -551,6 +628,12 @@ namespace mongo {
             BSONObj updateCriteria = op.getObjectField("o2");
             const bool upsert = fields[3].booleanSafe() || convertUpdateToUpsert;
 
+            if ( isUpdateOplogDelta( o ) ) {
+                // size-preserving object replacement logged as damaged byte ranges;
+                // applied directly rather than through the update framework
+                return applyUpdateOplogDelta( ns, nsd, updateCriteria, o, upsert );
+            }
+
             const NamespaceString requestNs(ns);
             UpdateRequest request(requestNs, QueryPlanSelectionPolicy::idElseNatural());
 
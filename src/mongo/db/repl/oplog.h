@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <deque>
+
 namespace mongo {
 
     class BSONObj;
@@ -48,6 +50,11 @@ namespace mongo {
     // used internally by replication secondaries after they have applied an op
     void _logOpObjRS(const BSONObj& op);
 
+    // Write a batch of already-built ops into the replica-set oplog.  Same as calling
+    // _logOpObjRS() on each, but the lock, context setup and optime bookkeeping are
+    // paid once per batch instead of once per op.
+    void writeOpsToOplog(const std::deque<BSONObj>& ops);
+
     const char rsoplog[] = "local.oplog.rs";
 
     /** Log an operation to the local oplog 
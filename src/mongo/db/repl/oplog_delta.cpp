@@ -0,0 +1,186 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/repl/oplog_delta.h"
+
+#include <boost/scoped_array.hpp>
+
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/namespace_details.h"
+#include "mongo/db/pdfile.h"
+#include "mongo/util/mongoutils/checksum.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    namespace {
+
+        // Two damaged runs closer together than this are cheaper to merge than to
+        // separate with another eight byte range header.
+        const int kMergeGap = 12;
+
+        // Below this size a full-object entry is cheap enough that the checksum work
+        // on both sides is not worth it.
+        const int kMinDocSize = 256;
+
+        int readInt( const char* p ) {
+            int v;
+            memcpy( &v, p, 4 );
+            return v;
+        }
+    }
+
+    BSONObj makeUpdateOplogDelta( const BSONObj& preImage, const BSONObj& postImage ) {
+        const int size = preImage.objsize();
+        if ( size != postImage.objsize() || size < kMinDocSize )
+            return BSONObj();
+
+        const char* a = preImage.objdata();
+        const char* b = postImage.objdata();
+
+        // Only a clear win is worth taking over the plain full-object entry.
+        const int budget = size / 4;
+
+        BufBuilder blob;
+        int pos = 0;
+        while ( pos < size ) {
+            if ( a[pos] == b[pos] ) {
+                pos++;
+                continue;
+            }
+            const int start = pos;
+            int lastDiff = pos;
+            for ( pos++; pos < size && pos - lastDiff <= kMergeGap; pos++ ) {
+                if ( a[pos] != b[pos] )
+                    lastDiff = pos;
+            }
+            const int len = lastDiff + 1 - start;
+            blob.appendNum( start );
+            blob.appendNum( len );
+            blob.appendBuf( b + start, len );
+            if ( blob.len() > budget )
+                return BSONObj();
+        }
+
+        if ( blob.len() == 0 ) {
+            // identical images; let the caller log the no-op its usual way
+            return BSONObj();
+        }
+
+        BSONObjBuilder bob;
+        bob.appendBinData( "$damages", blob.len(), BinDataGeneral, blob.buf() );
+        bob.append( "s", size );
+        bob.append( "c", mongoutils::checksum( a, size ) );
+        bob.append( "n", mongoutils::checksum( b, size ) );
+        return bob.obj();
+    }
+
+    bool isUpdateOplogDelta( const BSONObj& o ) {
+        return str::equals( o.firstElementFieldName(), "$damages" );
+    }
+
+    bool applyUpdateOplogDelta( const char* ns,
+                                NamespaceDetails* nsd,
+                                const BSONObj& idQuery,
+                                const BSONObj& delta,
+                                bool upsert ) {
+        DiskLoc loc;
+        if ( nsd ) {
+            if ( nsd->findIdIndex() >= 0 )
+                loc = Helpers::findById( nsd, idQuery );
+            else
+                // capped collections won't have an _id index
+                loc = Helpers::findOne( ns, idQuery, false );
+        }
+
+        if ( loc.isNull() ) {
+            if ( !upsert ) {
+                log() << "replication failed to apply delta update: "
+                      << ns << ' ' << idQuery.toString() << endl;
+                return true;
+            }
+            // A delta carries only the changed bytes, so there is nothing to create.
+            // This happens when a reapplied batch updated a document that it deleted
+            // further on; the delete replays as a no-op too.
+            log() << "replication skipping delta update of missing doc: "
+                  << ns << ' ' << idQuery.toString() << endl;
+            return false;
+        }
+
+        int blobLen = 0;
+        const char* blob = delta.firstElement().binData( blobLen );
+        const int size = delta["s"].numberInt();
+        const int preCk = delta["c"].numberInt();
+        const int postCk = delta["n"].numberInt();
+        uassert( 17519, "malformed delta update oplog entry", size > 0 && blobLen > 8 );
+
+        const BSONObj local = loc.obj();
+        const int localCk = local.objsize() == size ?
+            mongoutils::checksum( local.objdata(), size ) : 0;
+        if ( local.objsize() != size || localCk != preCk ) {
+            if ( local.objsize() == size && localCk == postCk ) {
+                // replayed entry; the update is already reflected locally
+                return false;
+            }
+            // The local copy matches neither image: it is ahead of this entry (an
+            // initial sync clone, or a batch reapplied after restart).  A delta
+            // cannot rewind it the way a full-object entry would; skip it and let
+            // the rest of the oplog converge.
+            log() << "replication skipping delta update; local doc matches neither image: "
+                  << ns << ' ' << idQuery.toString() << endl;
+            return false;
+        }
+
+        // Reconstruct the post-image and go through updateRecord() so that any index
+        // entries the damaged ranges touch are maintained.
+        boost::scoped_array<char> buf( new char[size] );
+        memcpy( buf.get(), local.objdata(), size );
+        const char* p = blob;
+        const char* blobEnd = blob + blobLen;
+        while ( p + 8 <= blobEnd ) {
+            const int offset = readInt( p );
+            const int len = readInt( p + 4 );
+            p += 8;
+            uassert( 17520, "bad range in delta update oplog entry",
+                     offset >= 0 && len > 0 && offset + len <= size && p + len <= blobEnd );
+            memcpy( buf.get() + offset, p, len );
+            p += len;
+        }
+        uassert( 17521, "trailing bytes in delta update oplog entry", p == blobEnd );
+        uassert( 17522, "delta update oplog entry does not produce its post-image",
+                 mongoutils::checksum( buf.get(), size ) == postCk );
+
+        OpDebug debug;
+        theDataFileMgr.updateRecord( ns, nsd, &NamespaceDetailsTransient::get( ns ),
+                                     loc.rec(), loc, buf.get(), size, debug );
+        return false;
+    }
+
+}
@@ -0,0 +1,85 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    class NamespaceDetails;
+
+    /**
+     * Delta ("damage") update oplog entries.
+     *
+     * An object-replacement update usually rewrites only a small part of a document,
+     * but its oplog entry carries the whole new version.  When the replacement leaves
+     * the document's size unchanged we instead log just the damaged byte ranges, in
+     * the spirit of the mutable bson DamageVector the in-place update path hands to
+     * the journal.  The entry's 'o' field then looks like
+     *
+     *     { $damages : BinData(...), s : <size>, c : <pre cksum>, n : <post cksum> }
+     *
+     * where the blob is a sequence of ( int32 offset, int32 length, <length> bytes )
+     * runs against the old document.  '$damages' cannot collide with a replacement
+     * document (top-level $ fields are rejected on insert/replace) or with a modifier
+     * document (there is no such update operator).
+     *
+     * A secondary applies the runs to its copy of the document only if that copy
+     * matches the pre-image size and checksum; the reconstructed document goes
+     * through updateRecord() so index entries stay correct.  If the local copy
+     * already matches the post-image the entry is a replayed no-op.  If it matches
+     * neither -- an initial-sync clone or a partially reapplied batch can be ahead of
+     * the entry being applied -- the entry is skipped: unlike a full-object entry a
+     * delta cannot rewind the document, and the remaining oplog converges for the
+     * same reason replaying a full-object entry would have.
+     */
+
+    /**
+     * Builds the 'o' field of a delta update oplog entry from the two images.
+     * Returns an empty object when a delta entry cannot be used (the size changed)
+     * or is not worthwhile (the damaged ranges do not amount to a clear win over
+     * logging the whole document).
+     */
+    BSONObj makeUpdateOplogDelta( const BSONObj& preImage, const BSONObj& postImage );
+
+    /** @return true if 'o' (of a 'u' oplog entry) is a delta built by the above. */
+    bool isUpdateOplogDelta( const BSONObj& o );
+
+    /**
+     * Applies a delta update oplog entry to the document matching idQuery.
+     * @return true if the update failed because the document is missing (and no
+     * upsert was requested), mirroring applyOperation_inlock()'s failedUpdate.
+     */
+    bool applyUpdateOplogDelta( const char* ns,
+                                NamespaceDetails* nsd,
+                                const BSONObj& idQuery,
+                                const BSONObj& delta,
+                                bool upsert );
+
+}
@@ -0,0 +1,153 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/repl/oplog_skip_index.h"
+
+#include <algorithm>
+
+#include "mongo/db/namespace_details.h"
+#include "mongo/db/pdfile.h"
+
+namespace mongo {
+
+    const int OplogSkipIndex::kStride;
+    const size_t OplogSkipIndex::kMaxEntries;
+
+    namespace {
+        // a process has one or two oplog-like namespaces; created on first use and
+        // never destroyed (same lifetime as the oplog itself)
+        mongo::mutex registryLock( "oplogSkipIndexRegistry" );
+        map<string,OplogSkipIndex*>* registry = NULL;
+
+    }
+
+    OplogSkipIndex* OplogSkipIndex::forNs( const char* ns ) {
+        scoped_lock lk( registryLock );
+        if ( !registry )
+            registry = new map<string,OplogSkipIndex*>();
+        OplogSkipIndex*& idx = (*registry)[ns];
+        if ( !idx )
+            idx = new OplogSkipIndex();
+        return idx;
+    }
+
+    OplogSkipIndex::OplogSkipIndex()
+        : _mutex( "oplogSkipIndex" ), _sinceLastNote( 0 ), _rebuilt( false ) {
+    }
+
+    void OplogSkipIndex::note( const OpTime& ts, const DiskLoc& loc ) {
+        scoped_lock lk( _mutex );
+        if ( ++_sinceLastNote < kStride )
+            return;
+        if ( !_entries.empty() && !( _entries.back().ts < ts ) )
+            return;
+        _sinceLastNote = 0;
+        if ( _entries.size() >= kMaxEntries )
+            _entries.erase( _entries.begin(), _entries.begin() + _entries.size() / 2 );
+        Entry e;
+        e.ts = ts;
+        e.loc = loc;
+        _entries.push_back( e );
+    }
+
+    bool OplogSkipIndex::seek( const OpTime& target, DiskLoc* loc, OpTime* entryTs ) const {
+        scoped_lock lk( _mutex );
+        // newest entry with ts <= target
+        int lo = 0;
+        int hi = static_cast<int>( _entries.size() ) - 1;
+        int best = -1;
+        while ( lo <= hi ) {
+            int mid = ( lo + hi ) / 2;
+            if ( _entries[mid].ts <= target ) {
+                best = mid;
+                lo = mid + 1;
+            }
+            else {
+                hi = mid - 1;
+            }
+        }
+        if ( best < 0 )
+            return false;
+        *loc = _entries[best].loc;
+        *entryTs = _entries[best].ts;
+        return true;
+    }
+
+    void OplogSkipIndex::invalidateThrough( const OpTime& entryTs ) {
+        scoped_lock lk( _mutex );
+        vector<Entry>::iterator it = _entries.begin();
+        while ( it != _entries.end() && it->ts <= entryTs )
+            ++it;
+        _entries.erase( _entries.begin(), it );
+    }
+
+    void OplogSkipIndex::rebuildIfNeeded( NamespaceDetails* d ) {
+        {
+            scoped_lock lk( _mutex );
+            if ( _rebuilt )
+                return;
+            _rebuilt = true;
+        }
+
+        // One touch per extent.  For a looped cap the chain isn't in ts order and
+        // some first records may be about to be overwritten; entries are validated
+        // at seek time, so collecting and sorting whatever we see now is enough.
+        vector<Entry> seeded;
+        for ( DiskLoc el = d->firstExtent(); !el.isNull(); el = el.ext()->xnext ) {
+            Extent* e = el.ext();
+            if ( e->firstRecord.isNull() )
+                continue;
+            BSONObj o = BSONObj::make( e->firstRecord.rec() );
+            BSONElement tsElt = o["ts"];
+            if ( tsElt.type() != Timestamp && tsElt.type() != Date )
+                continue;
+            Entry entry;
+            entry.ts = tsElt._opTime();
+            entry.loc = e->firstRecord;
+            seeded.push_back( entry );
+        }
+
+        std::sort( seeded.begin(), seeded.end(), entryLess );
+
+        scoped_lock lk( _mutex );
+        if ( _entries.empty() ) {
+            _entries.swap( seeded );
+        }
+        else {
+            // logOp() raced ahead of us; keep its (newer) entries after ours
+            for ( size_t i = 0; i < _entries.size(); i++ ) {
+                if ( seeded.empty() || seeded.back().ts < _entries[i].ts )
+                    seeded.push_back( _entries[i] );
+            }
+            _entries.swap( seeded );
+        }
+    }
+
+}
@@ -0,0 +1,98 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/bson/optime.h"
+#include "mongo/db/diskloc.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    class NamespaceDetails;
+
+    /**
+     * Sparse in-memory ts -> DiskLoc index over an oplog.  logOp() notes the location
+     * of every kStride-th op; seek() then binary searches for the newest entry at or
+     * before a target OpTime, so FindingStartCursor can start scanning a short
+     * forward hop from the answer instead of binary searching extents from the tail
+     * (minutes on a large, cold oplog).
+     *
+     * Entries go stale when the cap wraps and a record slot is reused.  A caller
+     * must therefore validate the record it finds at the returned DiskLoc against
+     * the returned entry ts (ts is unique within an oplog, so equality proves the
+     * slot still holds the op we noted) and report mismatches via
+     * invalidateThrough(), which discards the stale entry and everything older.
+     */
+    class OplogSkipIndex {
+    public:
+        /** registry of indexes by oplog namespace; never returns NULL */
+        static OplogSkipIndex* forNs( const char* ns );
+
+        /** note that the op with timestamp 'ts' lives at 'loc'; cheap no-op for
+            most calls (sparse), out-of-order timestamps are ignored */
+        void note( const OpTime& ts, const DiskLoc& loc );
+
+        /**
+         * @return true and the newest entry with entryTs <= target, if any.
+         * The caller must validate *loc as described above.
+         */
+        bool seek( const OpTime& target, DiskLoc* loc, OpTime* entryTs ) const;
+
+        /** discard 'entryTs' and all older entries (cap wrapped over them) */
+        void invalidateThrough( const OpTime& entryTs );
+
+        /**
+         * One-time seed after startup: walks the extent chain and notes the first
+         * record of each extent, one record touch per extent.  Caller must hold at
+         * least a read lock on the oplog's database.
+         */
+        void rebuildIfNeeded( NamespaceDetails* d );
+
+    private:
+        OplogSkipIndex();
+
+        struct Entry {
+            OpTime ts;
+            DiskLoc loc;
+        };
+
+        static bool entryLess( const Entry& a, const Entry& b ) { return a.ts < b.ts; }
+
+        static const int kStride = 1024;       // oplog inserts between entries
+        static const size_t kMaxEntries = 8192; // oldest half dropped when exceeded
+
+        mutable mongo::mutex _mutex;
+        int _sinceLastNote;
+        bool _rebuilt;
+        std::vector<Entry> _entries; // ascending ts
+    };
+
+}
@@ -0,0 +1,246 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/repl/oplog_window.h"
+
+#include "mongo/bson/util/builder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/compress.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    // Megabytes of recent oplog kept in memory for tailing cursors; 0 disables.  All
+    // but the newest ops are held snappy-compressed, so the covered stretch of oplog
+    // is usually several times this.
+    MONGO_EXPORT_SERVER_PARAMETER( replOplogWindowMB, int, 64 );
+
+    namespace {
+        // seal the uncompressed head into a compressed block at this size.  Large
+        // enough that snappy sees plenty of cross-op redundancy (field names, common
+        // values), small enough that a read decompresses quickly.
+        const long long kSealBytes = 256 * 1024;
+    }
+
+    OplogWindow theOplogWindow;
+
+    OplogWindow::OplogWindow()
+        : _mutex( "OplogWindow" ),
+          _headBytes( 0 ),
+          _totalBytes( 0 ),
+          _cacheValid( false ) {
+    }
+
+    bool OplogWindow::isTailQuery( const BSONObj& query ) {
+        if ( query.nFields() != 1 )
+            return false;
+
+        BSONElement ts = query["ts"];
+        if ( ts.type() != Object )
+            return false;
+
+        BSONObjIterator i( ts.Obj() );
+        if ( !i.more() )
+            return false;
+        while ( i.more() ) {
+            BSONElement e = i.next();
+            if ( !mongoutils::str::equals( e.fieldName(), "$gte" ) &&
+                 !mongoutils::str::equals( e.fieldName(), "$gt" ) )
+                return false;
+            if ( e.type() != Date && e.type() != Timestamp )
+                return false;
+        }
+        return true;
+    }
+
+    void OplogWindow::_clear() {
+        _blocks.clear();
+        _head.clear();
+        _headBytes = 0;
+        _totalBytes = 0;
+        _cacheValid = false;
+        _cachedData.clear();
+    }
+
+    void OplogWindow::_sealHead() {
+        if ( _head.empty() )
+            return;
+
+        BufBuilder raw( (int)_headBytes );
+        for ( std::deque<Entry>::const_iterator it = _head.begin(); it != _head.end(); ++it )
+            raw.appendBuf( it->op.objdata(), it->op.objsize() );
+
+        _blocks.push_back( Block() );
+        Block& block = _blocks.back();
+        block.firstTs = _head.front().ts;
+        block.lastTs = _head.back().ts;
+        block.n = (int)_head.size();
+        compress( raw.buf(), raw.len(), &block.compressed );
+
+        _totalBytes -= _headBytes;
+        _totalBytes += block.compressed.size();
+        _head.clear();
+        _headBytes = 0;
+    }
+
+    void OplogWindow::note( const BSONObj& op ) {
+        const long long maxBytes = replOplogWindowMB * 1024LL * 1024LL;
+
+        scoped_lock lk( _mutex );
+
+        if ( maxBytes <= 0 ) {
+            if ( _totalBytes )
+                _clear();
+            return;
+        }
+
+        BSONElement tsEl = op["ts"];
+        if ( tsEl.type() != Date && tsEl.type() != Timestamp )
+            return;
+        const OpTime ts = tsEl._opTime();
+
+        if ( !_head.empty() && !( _head.back().ts < ts ) ) {
+            // the oplog stream went back in time (see logOp); rather than serve
+            // disorder, forget everything and restart the window from here
+            _clear();
+        }
+        else if ( _head.empty() && !_blocks.empty() && !( _blocks.back().lastTs < ts ) ) {
+            _clear();
+        }
+
+        _head.push_back( Entry() );
+        _head.back().ts = ts;
+        _head.back().op = op.getOwned();
+        _headBytes += op.objsize();
+        _totalBytes += op.objsize();
+
+        if ( _headBytes >= kSealBytes )
+            _sealHead();
+
+        while ( _totalBytes > maxBytes ) {
+            if ( !_blocks.empty() ) {
+                if ( _cacheValid && _cachedFirstTs == _blocks.front().firstTs )
+                    _cacheValid = false;
+                _totalBytes -= _blocks.front().compressed.size();
+                _blocks.pop_front();
+            }
+            else if ( _head.size() > 1 ) {
+                _headBytes -= _head.front().op.objsize();
+                _totalBytes -= _head.front().op.objsize();
+                _head.pop_front();
+            }
+            else {
+                break; // always keep at least the newest op
+            }
+        }
+    }
+
+    void OplogWindow::discard() {
+        scoped_lock lk( _mutex );
+        _clear();
+    }
+
+    bool OplogWindow::_appendRun( const char* data, int len, const OpTime& pos,
+                                  int ntoreturn, int byteBudget, BufBuilder& b,
+                                  int* n, OpTime* newPos ) const {
+        const char* end = data + len;
+        while ( data < end ) {
+            BSONObj op( data );
+            data += op.objsize();
+
+            const OpTime ts = op["ts"]._opTime();
+            if ( !( pos < ts ) )
+                continue;
+
+            b.appendBuf( op.objdata(), op.objsize() );
+            *newPos = ts;
+            ++(*n);
+            if ( ( ntoreturn && *n >= ntoreturn ) || b.len() > byteBudget )
+                return true;
+        }
+        return false;
+    }
+
+    OplogWindow::ReadStatus OplogWindow::readAfter( const OpTime& pos, int ntoreturn,
+                                                    int byteBudget, BufBuilder& b,
+                                                    int* n, OpTime* newPos ) {
+        scoped_lock lk( _mutex );
+
+        if ( _blocks.empty() && _head.empty() )
+            return OutOfWindow;
+
+        const OpTime floor = _blocks.empty() ? _head.front().ts : _blocks.front().firstTs;
+        if ( pos < floor ) {
+            // can't prove the ops between 'pos' and the window are all present
+            return OutOfWindow;
+        }
+
+        OpTime cur = pos;
+
+        if ( !_blocks.empty() && cur < _blocks.back().lastTs ) {
+            // first block whose lastTs > cur; blocks are sorted by ts
+            size_t lo = 0, hi = _blocks.size();
+            while ( lo < hi ) {
+                size_t mid = ( lo + hi ) / 2;
+                if ( cur < _blocks[mid].lastTs )
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+
+            for ( size_t i = lo; i < _blocks.size(); ++i ) {
+                const Block& block = _blocks[i];
+                if ( !_cacheValid || _cachedFirstTs != block.firstTs ) {
+                    _cachedData.clear();
+                    verify( uncompress( block.compressed.data(), block.compressed.size(),
+                                        &_cachedData ) );
+                    _cachedFirstTs = block.firstTs;
+                    _cacheValid = true;
+                }
+                if ( _appendRun( _cachedData.data(), (int)_cachedData.size(), cur,
+                                 ntoreturn, byteBudget, b, n, newPos ) )
+                    return Served;
+                cur = block.lastTs;
+            }
+        }
+
+        for ( std::deque<Entry>::const_iterator it = _head.begin(); it != _head.end(); ++it ) {
+            if ( !( cur < it->ts ) )
+                continue;
+            b.appendBuf( it->op.objdata(), it->op.objsize() );
+            *newPos = it->ts;
+            ++(*n);
+            if ( ( ntoreturn && *n >= ntoreturn ) || b.len() > byteBudget )
+                break;
+        }
+        return Served;
+    }
+
+}
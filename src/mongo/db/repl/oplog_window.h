@@ -0,0 +1,138 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <deque>
+#include <string>
+
+#include "mongo/bson/optime.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /**
+     * In-memory window over the newest ops in the replset oplog.  logOp() appends each
+     * op here as well as to the capped collection; tailing oplog cursors whose position
+     * is inside the window are then answered straight from memory (see processGetMore),
+     * so healthy secondaries don't pull oplog pages through the page cache at all and
+     * stop competing with data pages on their sync source.
+     *
+     * All but the newest ops are held snappy-compressed: the window accumulates a small
+     * uncompressed head and seals it into compressed blocks, compressing a run of ops
+     * together so repeated field names and values across neighboring entries act as a
+     * shared dictionary.  Oplog payloads commonly compress several-fold, so the same
+     * replOplogWindowMB budget (0 disables) covers a correspondingly longer stretch of
+     * the oplog.  Reads decompress one block at a time into a one-block cache; tailers
+     * advance through the window in order, so consecutive getMores hit the same block.
+     *
+     * The window is a contiguous suffix of the oplog from the moment the process
+     * started writing it.  A tailer that falls behind the window's oldest entry is
+     * handed back to the capped collection.
+     */
+    class OplogWindow {
+    public:
+
+        OplogWindow();
+
+        /**
+         * @return true if 'query' selects nothing but a lower bound on ts ($gt/$gte),
+         * i.e. every op after the bound matches, so a cursor over it can be fed raw
+         * window entries.  This is the exact query shape replica set tailers use.
+         */
+        static bool isTailQuery( const BSONObj& query );
+
+        /**
+         * note an op just written to the oplog.  Ops must arrive in ts order; an
+         * out of order ts discards the window (mirrors the "oplog stream went back
+         * in time" handling in logOp).
+         */
+        void note( const BSONObj& op );
+
+        enum ReadStatus {
+            OutOfWindow, // 'pos' is older than the window; caller must use the collection
+            Served       // batch appended to the builder (possibly empty, caller may wait)
+        };
+
+        /**
+         * Appends up to 'ntoreturn' ops with ts > pos to 'b', stopping past
+         * 'byteBudget' reply bytes.
+         * @param n IN/OUT incremented per op appended
+         * @param newPos set to the ts of the last op appended, untouched if none
+         */
+        ReadStatus readAfter( const OpTime& pos, int ntoreturn, int byteBudget,
+                              BufBuilder& b, int* n, OpTime* newPos );
+
+        /** forget everything; used when the oplog is truncated (rollback). */
+        void discard();
+
+    private:
+
+        struct Entry {
+            OpTime ts;
+            BSONObj op; // owned copy
+        };
+
+        /** a sealed, compressed run of consecutive ops */
+        struct Block {
+            OpTime firstTs;
+            OpTime lastTs;
+            int n;                   // ops in the block
+            std::string compressed;  // snappy of the ops' concatenated raw BSON
+        };
+
+        /** compress the uncompressed head into a new block.  caller holds _mutex. */
+        void _sealHead();
+
+        /** drop all state.  caller holds _mutex. */
+        void _clear();
+
+        /**
+         * append ops with ts > pos from the uncompressed run [data, data + len) to 'b',
+         * honoring the limits.  @return true when the limits cut the batch short.
+         * caller holds _mutex.
+         */
+        bool _appendRun( const char* data, int len, const OpTime& pos, int ntoreturn,
+                         int byteBudget, BufBuilder& b, int* n, OpTime* newPos ) const;
+
+        mongo::mutex _mutex;
+        std::deque<Block> _blocks;  // ascending ts, oldest first
+        std::deque<Entry> _head;    // uncompressed newest ops, ascending ts
+        long long _headBytes;       // raw bytes in _head
+        long long _totalBytes;      // _headBytes + compressed bytes of _blocks
+
+        // one-block decompression cache, keyed by the block's firstTs
+        mutable std::string _cachedData;
+        mutable OpTime _cachedFirstTs;
+        mutable bool _cacheValid;
+    };
+
+    extern OplogWindow theOplogWindow;
+
+}
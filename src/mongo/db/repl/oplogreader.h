@@ -135,6 +135,13 @@ namespace mongo {
             return cursor->moreInCurrentBatch();
         }
 
+        /* start the next getMore streaming in while the current batch is consumed;
+           safe here because this connection carries nothing but this cursor */
+        void prefetchMore() {
+            uassert( 17553, "Doesn't have cursor for reading oplog", cursor.get() );
+            cursor->prefetchMore();
+        }
+
         int currentBatchMessageSize() {
             if( NULL == cursor->getMessage() )
                 return 0;
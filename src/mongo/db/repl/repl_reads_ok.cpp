@@ -51,6 +51,14 @@ namespace mongo {
             uassert(13436,
                     "not master or secondary; cannot currently read from this replSet member",
                     theReplSet && theReplSet->isSecondary() );
+
+            // optime token: only serve the read once we've applied at least as far as the
+            // client's last observed write; otherwise fail fast so it can retry elsewhere
+            if ( pq && !pq->getAfterOpTime().isNull() ) {
+                uassert(17541,
+                        "secondary has not yet applied the requested $afterOpTime",
+                        !(theReplSet->lastOpTimeWritten < pq->getAfterOpTime()) );
+            }
         }
         else {
             // master/slave
@@ -75,6 +83,14 @@ namespace mongo {
             uassert(17070,
                     "not master or secondary; cannot currently read from this replSet member",
                     theReplSet && theReplSet->isSecondary() );
+
+            // optime token: only serve the read once we've applied at least as far as the
+            // client's last observed write; otherwise fail fast so it can retry elsewhere
+            if ( pq && !pq->getAfterOpTime().isNull() ) {
+                uassert(17542,
+                        "secondary has not yet applied the requested $afterOpTime",
+                        !(theReplSet->lastOpTimeWritten < pq->getAfterOpTime()) );
+            }
         }
         else {
             // master/slave
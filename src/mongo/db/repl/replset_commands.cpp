@@ -28,18 +28,24 @@
 
 #include "mongo/pch.h"
 
+#include <boost/filesystem/operations.hpp>
+
 #include "mongo/base/init.h"
 #include "mongo/base/status.h"
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/fsync.h"
 #include "mongo/db/repl/health.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_server_status.h"  // replSettings
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/repl/rs_config.h"
 #include "mongo/db/repl/write_concern.h"
+#include "mongo/db/storage_options.h"
+#include "mongo/util/compress.h"
+#include "mongo/util/file.h"
 
 using namespace bson;
 
@@ -448,4 +454,137 @@ namespace mongo {
         }
     } cmdReplSetUpdatePosition;
 
+    /* Snapshot file streaming, for provisioning a member from a physical copy of a
+       fsync-locked source instead of a logical clone.  The procedure is:
+           1. fsync+lock the source
+           2. _replSetListFiles, then _replSetStreamFile the datafiles into a fresh dbpath
+           3. unlock the source
+           4. start the new member with --fastsync; the existing oplog catch-up brings it current
+       The source only ever serves sequential reads of immutable (locked) files, so a
+       3TB reprovision costs it network bandwidth rather than hours of cache pollution
+       from a logical clone.
+    */
+
+    static bool isDataFileName(const string& name) {
+        // "<db>.ns" or "<db>.<n>"; skip mongod.lock, journal/, $tmp dirs, etc.
+        size_t dot = name.rfind('.');
+        if( dot == string::npos || dot + 1 == name.size() )
+            return false;
+        string ext = name.substr(dot + 1);
+        if( ext == "ns" )
+            return true;
+        for( size_t i = 0; i < ext.size(); i++ ) {
+            if( !isdigit(ext[i]) )
+                return false;
+        }
+        return true;
+    }
+
+    static void listDataFiles(const boost::filesystem::path& dir, const string& prefix,
+                              BSONArrayBuilder& files) {
+        for( boost::filesystem::directory_iterator i( dir );
+                i != boost::filesystem::directory_iterator(); ++i ) {
+            string fileName = boost::filesystem::path(*i).leaf().string();
+            if( boost::filesystem::is_directory( *i ) ) {
+                // with --directoryperdb the datafiles are one level down
+                if( storageGlobalParams.directoryperdb &&
+                        fileName.length() && fileName[0] != '$' && fileName != "journal" )
+                    listDataFiles( *i, fileName + "/", files );
+                continue;
+            }
+            if( !isDataFileName( fileName ) )
+                continue;
+            BSONObjBuilder b( files.subobjStart() );
+            b.append( "name", prefix + fileName );
+            b.append( "size", (long long) boost::filesystem::file_size( *i ) );
+            b.done();
+        }
+    }
+
+    class CmdReplSetListFiles : public ReplSetCommand {
+    public:
+        virtual void help( stringstream &help ) const {
+            help << "internal - list datafiles for snapshot streaming; server must be fsync-locked";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::replSetStreamFiles);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        CmdReplSetListFiles() : ReplSetCommand("_replSetListFiles") { }
+        virtual bool run(const string& , BSONObj& cmdObj, int, string& errmsg,
+                         BSONObjBuilder& result, bool fromRepl) {
+            if( !check(errmsg, result) )
+                return false;
+            uassert(17530, "server must be fsync-locked before streaming datafiles",
+                    lockedForWriting());
+            BSONArrayBuilder files( result.subarrayStart("files") );
+            listDataFiles( boost::filesystem::path(storageGlobalParams.dbpath), "", files );
+            files.done();
+            return true;
+        }
+    } cmdReplSetListFiles;
+
+    class CmdReplSetStreamFile : public ReplSetCommand {
+    public:
+        // well under the 16MB reply limit even if a chunk is incompressible
+        static const long long maxChunkBytes = 4 * 1024 * 1024;
+
+        virtual void help( stringstream &help ) const {
+            help << "internal - read a datafile chunk for snapshot streaming\n";
+            help << "{ _replSetStreamFile : <name from _replSetListFiles>, offset : <n>, length : <n> }";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::replSetStreamFiles);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        CmdReplSetStreamFile() : ReplSetCommand("_replSetStreamFile") { }
+        virtual bool run(const string& , BSONObj& cmdObj, int, string& errmsg,
+                         BSONObjBuilder& result, bool fromRepl) {
+            if( !check(errmsg, result) )
+                return false;
+            uassert(17531, "server must be fsync-locked before streaming datafiles",
+                    lockedForWriting());
+
+            const string name = cmdObj.firstElement().valuestrsafe();
+            // only plain dbpath entries (or one directoryperdb level) are ever listed
+            uassert(17532, "bad datafile name",
+                    !name.empty() && name[0] != '/' && name.find("..") == string::npos);
+
+            boost::filesystem::path full = boost::filesystem::path(storageGlobalParams.dbpath) / name;
+            File f;
+            f.open( full.string().c_str(), /*readOnly*/ true );
+            uassert(17533, string("couldn't open datafile ") + name, f.is_open() );
+
+            long long fileLen = f.len();
+            long long offset = cmdObj["offset"].numberLong();
+            uassert(17534, "bad offset", offset >= 0 && offset <= fileLen);
+            long long length = cmdObj["length"].eoo() ? maxChunkBytes
+                                                      : cmdObj["length"].numberLong();
+            uassert(17535, "bad length", length > 0 && length <= maxChunkBytes);
+            if( offset + length > fileLen )
+                length = fileLen - offset;
+
+            vector<char> buf( static_cast<size_t>(length) );
+            if( length )
+                f.read( offset, &buf[0], static_cast<unsigned>(length) );
+            uassert(17536, string("error reading datafile ") + name, !f.bad() );
+
+            // locked datafiles are mostly zero-prealloc and btree pages; snappy typically
+            // shrinks them well below what the wire would otherwise carry
+            string compressed;
+            compress( length ? &buf[0] : "", static_cast<size_t>(length), &compressed );
+
+            result.append( "bytes", length );     // uncompressed length of this chunk
+            result.append( "fileLength", fileLen );
+            result.appendBinData( "data", compressed.size(), BinDataGeneral, compressed.data() );
+            return true;
+        }
+    } cmdReplSetStreamFile;
+
 }
@@ -31,6 +31,8 @@
 
 #pragma once
 
+#include <cstring>
+
 #include "mongo/util/concurrency/value.h"
 
 namespace mongo {
@@ -78,6 +80,39 @@ namespace mongo {
         bool operator!=(const MemberState& r) const { return s != r.s; }
     };
 
+    /**
+     * Log-scale histogram of heartbeat round trip times, reported by replSetGetStatus.
+     * Bucket i counts pings of at most 2^i milliseconds; the last bucket counts
+     * everything slower.  The weighted pingMs average hides the tail latency that
+     * actually pushes a member past the heartbeat timeout.
+     */
+    class PingHistogram {
+    public:
+        static const int kNumBuckets = 11; // <=1ms, <=2ms, ... <=512ms, slower
+
+        PingHistogram() : _count(0), _totalMs(0) {
+            memset(_buckets, 0, sizeof(_buckets));
+        }
+
+        void record(unsigned ms) {
+            int b = 0;
+            while (b < kNumBuckets - 1 && ms > (1u << b))
+                b++;
+            _buckets[b]++;
+            _count++;
+            _totalMs += ms;
+        }
+
+        unsigned bucket(int i) const { return _buckets[i]; }
+        unsigned count() const { return _count; }
+        unsigned long long totalMs() const { return _totalMs; }
+
+    private:
+        unsigned _buckets[kNumBuckets];
+        unsigned _count;
+        unsigned long long _totalMs;
+    };
+
     /* this is supposed to be just basic information on a member,
        and copy constructable. */
     class HeartbeatInfo {
@@ -101,6 +136,7 @@ namespace mongo {
         int skew;
         bool authIssue;
         unsigned int ping; // milliseconds
+        PingHistogram pingHist; // raw (unsmoothed) round trips
         static unsigned int numPings;
 
         bool up() const { return health > 0; }
@@ -35,6 +35,7 @@
 #include "mongo/db/ops/update_request.h"
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/oplog_window.h"
 #include "mongo/db/repl/rs.h"
 
 /* Scenarios
@@ -587,6 +588,9 @@ namespace mongo {
         // todo: fatal error if this throws?
         oplogDetails->cappedTruncateAfter(rsoplog, h.commonPointOurDiskloc, false);
 
+        // the in-memory oplog window still holds the truncated ops; drop it
+        theOplogWindow.discard();
+
         /* reset cached lastoptimewritten and h value */
         loadLastOpTimeWritten();
 
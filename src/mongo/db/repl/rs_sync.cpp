@@ -227,11 +227,14 @@ namespace replset {
     // Doles out all the work to the reader pool threads and waits for them to complete
     void SyncTail::prefetchOps(const std::deque<BSONObj>& ops) {
         threadpool::ThreadPool& prefetcherPool = theReplSet->getPrefetchPool();
+        std::vector<threadpool::Task> tasks;
+        tasks.reserve(ops.size());
         for (std::deque<BSONObj>::const_iterator it = ops.begin();
              it != ops.end();
              ++it) {
-            prefetcherPool.schedule(&prefetchOp, *it);
+            tasks.push_back(boost::bind(&prefetchOp, *it));
         }
+        prefetcherPool.schedule_batch(tasks);
         prefetcherPool.join();
     }
     
@@ -279,9 +282,16 @@ namespace replset {
             const BSONElement e = it->getField("ns");
             verify(e.type() == String);
             const char* ns = e.valuestr();
-            int len = e.valuestrsize();
+
+            // syncApply() takes a DB-level lock, so partition by database rather than by
+            // full namespace: all ops for one database land on the same writer thread
+            // (applied in oplog order and without lock contention) while different
+            // databases apply concurrently.  Hashing the full namespace would spread one
+            // database's collections across threads that then just serialize on -- and
+            // ping-pong -- that database's write lock.
+            StringData db = nsToDatabaseSubstring(ns);
             uint32_t hash = 0;
-            MurmurHash3_x86_32( ns, len, 0, &hash);
+            MurmurHash3_x86_32( db.rawData(), db.size(), 0, &hash);
 
             (*writerVectors)[hash % writerVectors->size()].push_back(*it);
         }
@@ -560,15 +570,9 @@ namespace replset {
     }
 
     void SyncTail::applyOpsToOplog(std::deque<BSONObj>* ops) {
-        {
-            Lock::DBWrite lk("local");
-            while (!ops->empty()) {
-                const BSONObj& op = ops->front();
-                // this updates theReplSet->lastOpTimeWritten
-                _logOpObjRS(op);
-                ops->pop_front();
-             }
-        }
+        // this updates theReplSet->lastOpTimeWritten; one lock/context for the whole batch
+        writeOpsToOplog(*ops);
+        ops->clear();
 
         // Update write concern on primary
         BackgroundSync::notify();
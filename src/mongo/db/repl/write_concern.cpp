@@ -36,8 +36,10 @@
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/repl/is_master.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/background.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
 
 //#define REPLDEBUG(x) log() << "replBlock: "  << x << endl;
 #define REPLDEBUG(x)
@@ -73,10 +75,24 @@ namespace mongo {
             BSONObj obj;
         };
 
+        /* a getLastError thread blocked waiting for a w value.  the waiter list is
+           sorted by optime so update() can stop scanning at the first waiter whose
+           threshold a progress report cannot have reached. */
+        struct Waiter {
+            Waiter( OpTime o, const BSONElement& wElt )
+                : op(o), w(wElt.wrap()), satisfied(false) {}
+            const OpTime op;
+            const BSONObj w; // owned copy; the command object may not outlive us
+            boost::condition cond;
+            bool satisfied;
+        };
+        typedef multimap<OpTime,Waiter*> WaiterList;
+
         SlaveTracking() : _mutex("SlaveTracking") {
             _dirty = false;
             _started = false;
             _currentlyUpdatingCache = false;
+            _numSlots = 0;
         }
 
         void run() {
@@ -128,6 +144,10 @@ namespace mongo {
                 return;
             scoped_lock mylk(_mutex);
             _slaves.clear();
+            _slaveSlot.clear();
+            for ( int i = 0; i < _numSlots; i++ )
+                _nthReplicated[i].store( 0 );
+            _numSlots = 0;
         }
 
         void update( const BSONObj& rid , const BSONObj config , const string& ns , OpTime last ) {
@@ -139,6 +159,7 @@ namespace mongo {
 
             if (last > _slaves[ident]) {
                 _slaves[ident] = last;
+                _updateRanked_inlock( ident, last );
                 _dirty = true;
 
                 if (theReplSet && theReplSet->isPrimary()) {
@@ -152,6 +173,20 @@ namespace mongo {
                 }
 
                 _threadsWaitingForReplication.notify_all();
+
+                // wake exactly the getLastError waiters this progress report can
+                // satisfy; the list is sorted by optime, so stop at the first
+                // waiter still ahead of it
+                for ( WaiterList::iterator it = _waiters.begin();
+                        it != _waiters.end() && it->first <= last; ++it ) {
+                    Waiter* waiter = it->second;
+                    OpTime op = waiter->op;
+                    if ( !waiter->satisfied &&
+                            _replicatedEnough_inlock( op, waiter->w.firstElement() ) ) {
+                        waiter->satisfied = true;
+                        waiter->cond.notify_one();
+                    }
+                }
             }
         }
 
@@ -191,6 +226,8 @@ namespace mongo {
                 return true;
 
             w--; // now this is the # of slaves i need
+            if ( _replicatedToNum_fastpath( op, w ) )
+                return true;
             scoped_lock mylk(_mutex);
             return _replicatedToNum_slaves_locked( op, w );
         }
@@ -205,6 +242,9 @@ namespace mongo {
 
             w--; // now this is the # of slaves i need
 
+            if ( _replicatedToNum_fastpath( op, w ) )
+                return true;
+
             boost::xtime xt;
             boost::xtime_get(&xt, MONGO_BOOST_TIME_UTC);
             xt.sec += maxSecondsToWait;
@@ -222,7 +262,76 @@ namespace mongo {
             return true;
         }
 
+        /**
+         * Block until 'op' has replicated far enough for 'w', or roughly
+         * 'millisToWait' has elapsed.  Event driven: a progress report that
+         * reaches our threshold wakes us directly, so satisfied writes return
+         * without polling delay.  Callers recheck master-ness and interrupts
+         * between calls, so millisToWait should stay modest.
+         * @return true if the write concern was satisfied
+         */
+        bool awaitReplication( OpTime op, BSONElement w, long long millisToWait ) {
+            if ( opReplicatedEnough( op, w ) ) // also validates w; fast path
+                return true;
+
+            Waiter waiter( op, w );
+            scoped_lock mylk(_mutex);
+            // the fast path above reads the published optimes without the mutex
+            // and can be a report behind; recheck here so a write satisfied in
+            // that window does not sleep until the next progress report
+            if ( _replicatedEnough_inlock( op, w ) )
+                return true;
+            WaiterList::iterator where = _waiters.insert( make_pair( op, &waiter ) );
+            Timer t;
+            while ( !waiter.satisfied ) {
+                long long left = millisToWait - t.millis();
+                if ( left <= 0 )
+                    break;
+                boost::xtime xt;
+                boost::xtime_get(&xt, MONGO_BOOST_TIME_UTC);
+                xt.sec += static_cast<int>( left / 1000 );
+                xt.nsec += static_cast<int>( ( left % 1000 ) * 1000 * 1000 );
+                if ( xt.nsec >= 1000 * 1000 * 1000 ) {
+                    xt.sec += 1;
+                    xt.nsec -= 1000 * 1000 * 1000;
+                }
+                waiter.cond.timed_wait( mylk.boost(), xt );
+            }
+            _waiters.erase( where );
+            return waiter.satisfied;
+        }
+
+        // like opReplicatedEnough but called with _mutex held and without the
+        // master-ness asserts; the wait paths recheck those themselves.  a bad
+        // w mode returns false here rather than throwing (opReplicatedEnough
+        // has already validated w for any waiter that gets this far).
+        bool _replicatedEnough_inlock( OpTime& op, const BSONElement& w ) {
+            if ( w.isNumber() ) {
+                int n = w.numberInt();
+                if ( n <= 1 )
+                    return true;
+                return _replicatedToNum_slaves_locked( op, n - 1 );
+            }
+            if ( w.type() != String || !theReplSet )
+                return false;
+            string wStr = w.String();
+            if ( wStr == "majority" )
+                return _replicatedToNum_slaves_locked( op, theReplSet->config().getMajority() - 1 );
+            map<string,ReplSetConfig::TagRule*>::const_iterator it =
+                theReplSet->config().rules.find(wStr);
+            if ( it == theReplSet->config().rules.end() )
+                return false;
+            return op <= (*it).second->last;
+        }
+
         bool _replicatedToNum_slaves_locked(OpTime& op, int numSlaves ) {
+            // the rank index answers this in one array read for tracked slaves,
+            // and under _mutex it is exactly in step with _slaves
+            if ( _replicatedToNum_fastpath( op, numSlaves ) )
+                return true;
+            if ( static_cast<size_t>( _numSlots ) == _slaves.size() )
+                return false;
+            // some slaves did not get a slot (table full); scan the map
             for ( map<Ident,OpTime>::iterator i=_slaves.begin(); i!=_slaves.end(); i++) {
                 OpTime s = i->second;
                 if ( s < op ) {
@@ -234,6 +343,63 @@ namespace mongo {
             return numSlaves <= 0;
         }
 
+        /**
+         * Wait-free: true if at least 'numSlaves' slaves are known to have
+         * reached 'op', from the published n-th-highest optimes alone.  The
+         * published values are monotonic, so an unlocked read can only lag the
+         * locked view (never overstate progress); callers fall back to the
+         * exact locked scan on false.
+         */
+        bool _replicatedToNum_fastpath( const OpTime& op, int numSlaves ) const {
+            if ( numSlaves <= 0 )
+                return true;
+            if ( numSlaves > MaxTrackedSlaves )
+                return false;
+            unsigned long long nth =
+                static_cast<unsigned long long>( _nthReplicated[numSlaves-1].load() );
+            return nth >= op.asDate();
+        }
+
+        /**
+         * Maintain the rank index and the published n-th-highest optimes for
+         * one slave's new optime.  Called with _mutex held.  Amortized O(1):
+         * slaves mostly advance in lock step, so a progress report rarely
+         * moves its slot more than a place or two up the ranking.
+         */
+        void _updateRanked_inlock( const Ident& ident, OpTime last ) {
+            int slot;
+            map<Ident,int>::iterator it = _slaveSlot.find( ident );
+            if ( it == _slaveSlot.end() ) {
+                if ( _numSlots >= MaxTrackedSlaves ) {
+                    // table full; this slave is only visible to the map scan
+                    return;
+                }
+                slot = _numSlots++;
+                _slaveSlot[ident] = slot;
+                _rankSlot[slot] = slot;
+                _slotRank[slot] = slot;
+            }
+            else {
+                slot = it->second;
+            }
+            _slotOptime[slot] = last;
+            const int oldRank = _slotRank[slot];
+            int r = oldRank;
+            while ( r > 0 && _slotOptime[_rankSlot[r-1]] < last ) {
+                const int other = _rankSlot[r-1];
+                _rankSlot[r-1] = slot;
+                _rankSlot[r] = other;
+                _slotRank[slot] = r - 1;
+                _slotRank[other] = r;
+                r--;
+            }
+            // republish every position this report changed
+            for ( int i = r; i <= oldRank; i++ ) {
+                _nthReplicated[i].store(
+                        static_cast<long long>( _slotOptime[_rankSlot[i]].asDate() ) );
+            }
+        }
+
         std::vector<BSONObj> getHostsAtOp(OpTime& op) {
             std::vector<BSONObj> result;
             if (theReplSet) {
@@ -261,7 +427,24 @@ namespace mongo {
         mutable mongo::mutex _mutex;
         boost::condition _threadsWaitingForReplication;
 
+        // an upper bound on tracked slaves, not on the set size: with chained
+        // replication every downstream member reports through us
+        static const int MaxTrackedSlaves = 256;
+
         map<Ident,OpTime> _slaves;
+        map<Ident,int> _slaveSlot;            // slave -> fixed slot, protected by _mutex
+        int _numSlots;                        // slots assigned so far, protected by _mutex
+        OpTime _slotOptime[MaxTrackedSlaves]; // per-slot optime, protected by _mutex
+        int _rankSlot[MaxTrackedSlaves];      // rank -> slot, descending optime, protected by _mutex
+        int _slotRank[MaxTrackedSlaves];      // inverse of _rankSlot, protected by _mutex
+
+        /* _nthReplicated[i] is an optime known to have reached at least i+1
+           slaves.  written under _mutex, read without it: per-slave optimes only
+           advance, so each published value is monotonic and a stale read is
+           merely conservative. */
+        AtomicInt64 _nthReplicated[MaxTrackedSlaves];
+
+        WaiterList _waiters; // sorted by optime; entries owned by the blocked threads
         bool _dirty;
         bool _started;
         bool _currentlyUpdatingCache; // this is not thread safe, but ok for our purposes
@@ -335,6 +518,10 @@ namespace mongo {
         return slaveTracking.waitForReplication( op, w, maxSecondsToWait );
     }
 
+    bool awaitReplication( OpTime op, BSONElement w, long long millisToWait ) {
+        return slaveTracking.awaitReplication( op, w, millisToWait );
+    }
+
     vector<BSONObj> getHostsWrittenTo(OpTime& op) {
         return slaveTracking.getHostsAtOp(op);
     }
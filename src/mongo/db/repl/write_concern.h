@@ -51,6 +51,11 @@ namespace mongo {
 
     bool waitForReplication( OpTime op , int w , int maxSecondsToWait );
 
+    /** Block until op is replicated enough for w (a number or a mode string) or
+        roughly millisToWait elapses.  Wakes on slave progress reports rather
+        than polling.  @return true if the write concern was satisfied */
+    bool awaitReplication( OpTime op, BSONElement w, long long millisToWait );
+
     std::vector<BSONObj> getHostsWrittenTo(OpTime& op);
 
     void resetSlaveCache();
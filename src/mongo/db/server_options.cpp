@@ -143,6 +143,11 @@ namespace mongo {
         if (!ret.isOK()) {
             return ret;
         }
+        ret = options->addOption(OD("logasync", "logasync", moe::Switch,
+                    "write log entries asynchronously through an in-memory queue", true));
+        if (!ret.isOK()) {
+            return ret;
+        }
         ret = options->addOption(OD("logTimestampFormat", "logTimestampFormat", moe::String,
                     "Desired format for timestamps in log messages. One of ctime, "
                     "iso8601-utc or iso8601-local", true));
@@ -495,6 +500,7 @@ namespace mongo {
 
         serverGlobalParams.logWithSyslog = params.count("syslog");
         serverGlobalParams.logAppend = params.count("logappend");
+        serverGlobalParams.logAsync = params.count("logasync");
         if (!serverGlobalParams.logpath.empty() && serverGlobalParams.logWithSyslog) {
             return Status(ErrorCodes::BadValue, "Cant use both a logpath and syslog ");
         }
@@ -52,7 +52,8 @@ namespace mongo {
             configsvr(false), cpu(false), objcheck(true), defaultProfile(0),
             slowMS(100), defaultLocalThresholdMillis(15), moveParanoia(true),
             noUnixSocket(false), doFork(0), socket("/tmp"), maxConns(DEFAULT_MAX_CONN),
-            logAppend(false), logWithSyslog(false), isHttpInterfaceEnabled(false)
+            logAppend(false), logAsync(false), logWithSyslog(false),
+            isHttpInterfaceEnabled(false)
         {
             started = time(0);
         }
@@ -98,6 +99,7 @@ namespace mongo {
 
         std::string logpath;   // Path to log file, if logging to a file; otherwise, empty.
         bool logAppend;        // True if logging to a file in append mode.
+        bool logAsync;         // True if log writes go through an async in-memory queue.
         bool logWithSyslog;    // True if logging to syslog; must not be set if logpath is set.
         std::string clusterAuthMode; // Cluster authentication mode
 
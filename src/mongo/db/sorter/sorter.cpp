@@ -47,12 +47,16 @@
 
 #include "mongo/db/sorter/sorter.h"
 
+#include <boost/bind.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/thread.hpp>
 #include <snappy.h>
 
 #include "mongo/base/string_data.h"
 #include "mongo/bson/util/atomic_int.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/op_memory.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
@@ -107,6 +111,19 @@ namespace mongo {
 #endif
         }
 
+        /**
+         * FNV-1a over a spill-file block.  Spill files are written and read back within one
+         * process lifetime, so we only need to catch bad sectors / torn writes, not be
+         * cryptographic or stable across platforms.
+         */
+        inline uint32_t blockChecksum(const char* data, size_t len) {
+            uint32_t hash = 2166136261U;
+            for (size_t i = 0; i < len; i++) {
+                hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619U;
+            }
+            return hash;
+        }
+
         /** Ensures a named file is deleted when this object goes out of scope */
         class FileDeleter {
         public:
@@ -147,6 +164,147 @@ namespace mongo {
             std::deque<Data> _data;
         };
 
+        /**
+         * Reads size-prefixed blocks from a spill file on a background thread, keeping up
+         * to two blocks buffered (double buffering) so file reads overlap with the
+         * consumer's decompression and deserialization.  Verifies each block's checksum
+         * as it comes off disk.
+         */
+        class BlockPrefetcher : boost::noncopyable {
+        public:
+            struct Block {
+                boost::shared_array<char> data;
+                size_t size;
+                bool compressed;
+            };
+
+            BlockPrefetcher(std::ifstream* file, const std::string& fileName)
+                : _file(file)
+                , _fileName(fileName)
+                , _doneReading(false)
+                , _shutdown(false)
+            {
+                _thread.reset(new boost::thread(boost::bind(&BlockPrefetcher::run, this)));
+            }
+
+            ~BlockPrefetcher() {
+                {
+                    boost::mutex::scoped_lock lk(_mutex);
+                    _shutdown = true;
+                    _spaceAvailable.notify_one();
+                }
+                _thread->join();
+            }
+
+            /** Returns false at clean end of file.  Asserts on read errors or corruption. */
+            bool next(Block* out) {
+                boost::mutex::scoped_lock lk(_mutex);
+                while (_blocks.empty() && !_doneReading)
+                    _blockAvailable.wait(lk);
+
+                if (!_error.empty())
+                    msgasserted(16817, _error);
+
+                if (_blocks.empty())
+                    return false;
+
+                *out = _blocks.front();
+                _blocks.pop_front();
+                _spaceAvailable.notify_one();
+                return true;
+            }
+
+        private:
+            static const size_t MaxBufferedBlocks = 2;
+
+            void run() {
+                while (true) {
+                    Block block;
+                    bool eof = false;
+                    std::string error;
+                    try {
+                        eof = !readBlock(&block);
+                    }
+                    catch (const std::exception& e) {
+                        error = e.what();
+                    }
+
+                    boost::mutex::scoped_lock lk(_mutex);
+
+                    if (!error.empty() || eof) {
+                        _error = error;
+                        _doneReading = true;
+                        _blockAvailable.notify_one();
+                        return;
+                    }
+
+                    _blocks.push_back(block);
+                    _blockAvailable.notify_one();
+
+                    while (_blocks.size() >= MaxBufferedBlocks && !_shutdown)
+                        _spaceAvailable.wait(lk);
+
+                    if (_shutdown)
+                        return;
+                }
+            }
+
+            /** Returns false at clean end of file.  Throws on errors.  Runs unlocked. */
+            bool readBlock(Block* out) {
+                int32_t rawSize;
+                if (!read(&rawSize, sizeof(rawSize), /*eofOk=*/true))
+                    return false;
+
+                // negative size means compressed
+                out->compressed = rawSize < 0;
+                out->size = std::abs(rawSize);
+
+                uint32_t expected;
+                massert(16816, "file too short?",
+                        read(&expected, sizeof(expected), /*eofOk=*/true));
+
+                out->data.reset(new char[out->size]);
+                massert(16816, "file too short?",
+                        read(out->data.get(), out->size, /*eofOk=*/true));
+
+                massert(17510, str::stream() << "checksum mismatch in external sort file \""
+                                             << _fileName << "\", file appears corrupt",
+                        blockChecksum(out->data.get(), out->size) == expected);
+
+                return true;
+            }
+
+            // returns false on EOF before any bytes are consumed - asserts on other errors
+            bool read(void* out, size_t size, bool eofOk) {
+                _file->read(reinterpret_cast<char*>(out), size);
+                if (!_file->good()) {
+                    if (_file->eof()) {
+                        massert(16816, "file too short?", eofOk && _file->gcount() == 0);
+                        return false;
+                    }
+
+                    msgasserted(16817, str::stream() << "error reading file \""
+                                                     << _fileName << "\": "
+                                                     << myErrnoWithDescription());
+                }
+                verify(_file->gcount() == static_cast<std::streamsize>(size));
+                return true;
+            }
+
+            std::ifstream* _file; // owned by the FileIterator, which outlives us
+            const std::string _fileName;
+
+            boost::mutex _mutex; // guards all state below
+            boost::condition_variable _blockAvailable;
+            boost::condition_variable _spaceAvailable;
+            std::deque<Block> _blocks;
+            std::string _error; // nonempty if the reader hit an error
+            bool _doneReading;
+            bool _shutdown;
+
+            boost::scoped_ptr<boost::thread> _thread;
+        };
+
         /** Returns results in order from a single file */
         template <typename Key, typename Value>
         class FileIterator : public SortIteratorInterface<Key, Value> {
@@ -171,6 +329,12 @@ namespace mongo {
 
                 massert(16815, str::stream() << "unexpected empty file: " << _fileName,
                         boost::filesystem::file_size(_fileName) != 0);
+
+                _prefetcher.reset(new BlockPrefetcher(&_file, _fileName));
+            }
+
+            ~FileIterator() {
+                _prefetcher.reset(); // stop the reader thread before closing the file
             }
 
             bool more() {
@@ -199,63 +363,42 @@ namespace mongo {
             }
 
             void fill() {
-                int32_t rawSize;
-                read(&rawSize, sizeof(rawSize));
-                if (_done) return;
-
-                // negative size means compressed
-                const bool compressed = rawSize < 0;
-                const int32_t blockSize = std::abs(rawSize);
-
-                _buffer.reset(new char[blockSize]);
-                read(_buffer.get(), blockSize);
-                massert(16816, "file too short?", !_done);
+                BlockPrefetcher::Block block;
+                if (!_prefetcher->next(&block)) {
+                    _done = true;
+                    return;
+                }
 
-                if (!compressed) {
-                    _reader.reset(new BufReader(_buffer.get(), blockSize));
+                if (!block.compressed) {
+                    _buffer = block.data;
+                    _reader.reset(new BufReader(_buffer.get(), block.size));
                     return;
                 }
 
-                dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
+                dassert(snappy::IsValidCompressedBuffer(block.data.get(), block.size));
 
                 size_t uncompressedSize;
                 massert(17061, "couldn't get uncompressed length",
-                        snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
+                        snappy::GetUncompressedLength(block.data.get(), block.size,
+                                                      &uncompressedSize));
 
-                boost::scoped_array<char> decompressionBuffer(new char[uncompressedSize]);
+                _buffer.reset(new char[uncompressedSize]);
                 massert(17062, "decompression failed",
-                        snappy::RawUncompress(_buffer.get(),
-                                              blockSize,
-                                              decompressionBuffer.get()));
+                        snappy::RawUncompress(block.data.get(),
+                                              block.size,
+                                              _buffer.get()));
 
-                // hold on to decompressed data and throw out compressed data at block exit
-                _buffer.swap(decompressionBuffer);
                 _reader.reset(new BufReader(_buffer.get(), uncompressedSize));
             }
 
-            // sets _done to true on EOF - asserts on any other error
-            void read(void* out, size_t size) {
-                _file.read(reinterpret_cast<char*>(out), size);
-                if (!_file.good()) {
-                    if (_file.eof()) {
-                        _done = true;
-                        return;
-                    }
-
-                    msgasserted(16817, str::stream() << "error reading file \""
-                                                     << _fileName << "\": "
-                                                     << myErrnoWithDescription());
-                }
-                verify(_file.gcount() == static_cast<std::streamsize>(size));
-            }
-
             const Settings _settings;
             bool _done;
-            boost::scoped_array<char> _buffer;
+            boost::shared_array<char> _buffer;
             boost::scoped_ptr<BufReader> _reader;
             string _fileName;
             boost::shared_ptr<FileDeleter> _fileDeleter; // Must outlive _file
             std::ifstream _file;
+            boost::scoped_ptr<BlockPrefetcher> _prefetcher; // reads ahead in _file
         };
 
         /** Merge-sorts results from 0 or more FileIterators */
@@ -397,6 +540,7 @@ namespace mongo {
                 , _settings(settings)
                 , _opts(opts)
                 , _memUsed(0)
+                , _memCharge(opmem::ClassSort)
             { verify(_opts.limit == 0); }
 
             void add(const Key& key, const Value& val) {
@@ -405,6 +549,9 @@ namespace mongo {
                 _memUsed += key.memUsageForSorter();
                 _memUsed += val.memUsageForSorter();
 
+                // Throws if this pushes the op (or the server) over its memory budget.
+                _memCharge.set(static_cast<long long>(_memUsed));
+
                 if (_memUsed > _opts.maxMemoryUsageBytes)
                     spill();
             }
@@ -464,12 +611,14 @@ namespace mongo {
                 _iters.push_back(boost::shared_ptr<Iterator>(writer.done()));
 
                 _memUsed = 0;
+                _memCharge.set(0);
             }
 
             const Comparator _comp;
             const Settings _settings;
             SortOptions _opts;
             size_t _memUsed;
+            opmem::OpMemoryCharge _memCharge;
             std::deque<Data> _data; // the "current" data
             std::vector<boost::shared_ptr<Iterator> > _iters; // data that has already been spilled
         };
@@ -536,6 +685,7 @@ namespace mongo {
                 , _settings(settings)
                 , _opts(opts)
                 , _memUsed(0)
+                , _memCharge(opmem::ClassSort)
                 , _haveCutoff(false)
                 , _worstCount(0)
                 , _medianCount(0)
@@ -564,6 +714,9 @@ namespace mongo {
                     _memUsed += key.memUsageForSorter();
                     _memUsed += val.memUsageForSorter();
 
+                    // Throws if this pushes the op (or the server) over its memory budget.
+                    _memCharge.set(static_cast<long long>(_memUsed));
+
                     if (_data.size() == _opts.limit)
                         std::make_heap(_data.begin(), _data.end(), less);
 
@@ -586,6 +739,8 @@ namespace mongo {
                 _memUsed -= _data.front().first.memUsageForSorter();
                 _memUsed -= _data.front().second.memUsageForSorter();
 
+                _memCharge.set(static_cast<long long>(_memUsed));
+
                 std::pop_heap(_data.begin(), _data.end(), less);
                 _data.back() = contender;
                 std::push_heap(_data.begin(), _data.end(), less);
@@ -733,12 +888,14 @@ namespace mongo {
                 _iters.push_back(boost::shared_ptr<Iterator>(writer.done()));
 
                 _memUsed = 0;
+                _memCharge.set(0);
             }
 
             const Comparator _comp;
             const Settings _settings;
             SortOptions _opts;
             size_t _memUsed;
+            opmem::OpMemoryCharge _memCharge;
             std::vector<Data> _data; // the "current" data. Organized as max-heap if size == limit.
             std::vector<boost::shared_ptr<Iterator> > _iters; // data that has already been spilled
 
@@ -816,14 +973,21 @@ namespace mongo {
         snappy::Compress(_buffer.buf(), _buffer.len(), &compressed);
         verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
 
+        // Each block is framed as: int32 size (negative if compressed), uint32 checksum of
+        // the on-disk payload, payload bytes.  The checksum lets the reader distinguish
+        // media corruption from our own bugs when a merge goes wrong hours into a build.
         try {
             if (compressed.size() < size_t(_buffer.len()/10*9)) {
                 const int32_t size = -int32_t(compressed.size()); // negative means compressed
+                const uint32_t sum = sorter::blockChecksum(compressed.data(), compressed.size());
                 _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+                _file.write(reinterpret_cast<const char*>(&sum), sizeof(sum));
                 _file.write(compressed.data(), compressed.size());
             } else {
                 const int32_t size = _buffer.len();
+                const uint32_t sum = sorter::blockChecksum(_buffer.buf(), _buffer.len());
                 _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+                _file.write(reinterpret_cast<const char*>(&sum), sizeof(sum));
                 _file.write(_buffer.buf(), _buffer.len());
             }
         } catch (const std::exception&) {
@@ -33,6 +33,7 @@
 
 #include "mongo/db/storage_options.h"
 #include "mongo/util/log.h"
+#include "mongo/util/numa.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/version.h"
 
@@ -87,7 +88,11 @@ namespace mongo {
             warned = true;
         }
 
-        if (boost::filesystem::exists("/sys/devices/system/node/node1")){
+        // If we interleave the datafile mappings ourselves, running under numactl is
+        // no longer called for and the process-wide policy check below would warn
+        // spuriously.
+        if (boost::filesystem::exists("/sys/devices/system/node/node1") &&
+            !numaInterleaveMappedMemory) {
             // We are on a box with a NUMA enabled kernel and more than 1 numa node (they start at
             // node0)
             // Now we look at the first line of /proc/self/numa_maps
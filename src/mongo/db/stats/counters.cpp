@@ -33,10 +33,38 @@
 #include "mongo/db/stats/counters.h"
 
 #include "mongo/db/jsobj.h"
+#include "mongo/util/concurrency/threadlocal.h"
 
 namespace mongo {
+
+    // round-robin assignment of threads to op counter slots, done on a thread's first
+    // counter bump.  the id is shared by all OpCounters instances (global, repl, ...).
+    namespace {
+        AtomicUInt nextOpCounterSlot;
+    }
+
+    struct OpCounterSlotId {
+        OpCounterSlotId() : id( (nextOpCounterSlot++).get() ) {}
+        unsigned id;
+    };
+
+    TSP_DECLARE(OpCounterSlotId, opCounterSlotId)
+    TSP_DEFINE(OpCounterSlotId, opCounterSlotId)
+
     OpCounters::OpCounters() {}
 
+    OpCounters::Slot& OpCounters::_slot() {
+        return _slots[ opCounterSlotId.getMake()->id % NumSlots ];
+    }
+
+    unsigned OpCounters::_sum( AtomicUInt Slot::*counter ) const {
+        unsigned total = 0;
+        for ( unsigned i = 0; i < NumSlots; i++ ) {
+            total += (_slots[i].*counter).get();
+        }
+        return total;
+    }
+
     void OpCounters::gotOp( int op , bool isCommand ) {
         RARELY _checkWrap();
         switch ( op ) {
@@ -61,33 +89,35 @@ namespace mongo {
 
     void OpCounters::_checkWrap() {
         const unsigned MAX = 1 << 30;
-        
+
         bool wrap =
-            _insert.get() > MAX ||
-            _query.get() > MAX ||
-            _update.get() > MAX ||
-            _delete.get() > MAX ||
-            _getmore.get() > MAX ||
-            _command.get() > MAX;
-        
+            getInsert() > MAX ||
+            getQuery() > MAX ||
+            getUpdate() > MAX ||
+            getDelete() > MAX ||
+            getGetMore() > MAX ||
+            getCommand() > MAX;
+
         if ( wrap ) {
-            _insert.zero();
-            _query.zero();
-            _update.zero();
-            _delete.zero();
-            _getmore.zero();
-            _command.zero();
+            for ( unsigned i = 0; i < NumSlots; i++ ) {
+                _slots[i]._insert.zero();
+                _slots[i]._query.zero();
+                _slots[i]._update.zero();
+                _slots[i]._delete.zero();
+                _slots[i]._getmore.zero();
+                _slots[i]._command.zero();
+            }
         }
     }
 
     BSONObj OpCounters::getObj() const {
         BSONObjBuilder b;
-        b.append( "insert" , _insert.get() );
-        b.append( "query" , _query.get() );
-        b.append( "update" , _update.get() );
-        b.append( "delete" , _delete.get() );
-        b.append( "getmore" , _getmore.get() );
-        b.append( "command" , _command.get() );
+        b.append( "insert" , getInsert() );
+        b.append( "query" , getQuery() );
+        b.append( "update" , getUpdate() );
+        b.append( "delete" , getDelete() );
+        b.append( "getmore" , getGetMore() );
+        b.append( "command" , getCommand() );
         return b.obj();
     }
 
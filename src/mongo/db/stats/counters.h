@@ -40,44 +40,60 @@ namespace mongo {
 
     /**
      * for storing operation counters
-     * note: not thread safe.  ok with that for speed
+     *
+     * increments are sharded across per-thread slots, each padded out to its own cache
+     * line, so the per-operation hot path (gotInsert() etc. from every connection thread)
+     * doesn't ping-pong one shared line between cores.  readers aggregate the slots.
      */
     class OpCounters {
+        struct Slot {
+            AtomicUInt _insert;
+            AtomicUInt _query;
+            AtomicUInt _update;
+            AtomicUInt _delete;
+            AtomicUInt _getmore;
+            AtomicUInt _command;
+            // pad the slot out to a cache line so slots don't share one
+            char _pad[64 - 6 * sizeof(AtomicUInt)];
+        };
+
     public:
 
         OpCounters();
-        void incInsertInWriteLock(int n) { _insert.x += n; }
-        void gotInsert() { _insert++; }
-        void gotQuery() { _query++; }
-        void gotUpdate() { _update++; }
-        void gotDelete() { _delete++; }
-        void gotGetMore() { _getmore++; }
-        void gotCommand() { _command++; }
+        void incInsertInWriteLock(int n) { _slot()._insert.x += n; }
+        void gotInsert() { _slot()._insert++; }
+        void gotQuery() { _slot()._query++; }
+        void gotUpdate() { _slot()._update++; }
+        void gotDelete() { _slot()._delete++; }
+        void gotGetMore() { _slot()._getmore++; }
+        void gotCommand() { _slot()._command++; }
 
         void gotOp( int op , bool isCommand );
 
         BSONObj getObj() const;
-        
-        // thse are used by snmp, and other things, do not remove
-        const AtomicUInt * getInsert() const { return &_insert; }
-        const AtomicUInt * getQuery() const { return &_query; }
-        const AtomicUInt * getUpdate() const { return &_update; }
-        const AtomicUInt * getDelete() const { return &_delete; }
-        const AtomicUInt * getGetMore() const { return &_getmore; }
-        const AtomicUInt * getCommand() const { return &_command; }
 
+        // these are used by snmp, and other things, do not remove.
+        // totals aggregated over all slots at call time.
+        unsigned getInsert() const { return _sum( &Slot::_insert ); }
+        unsigned getQuery() const { return _sum( &Slot::_query ); }
+        unsigned getUpdate() const { return _sum( &Slot::_update ); }
+        unsigned getDelete() const { return _sum( &Slot::_delete ); }
+        unsigned getGetMore() const { return _sum( &Slot::_getmore ); }
+        unsigned getCommand() const { return _sum( &Slot::_command ); }
 
     private:
+        // enough slots that concurrently running threads rarely share one; threads are
+        // assigned round-robin on first use
+        static const unsigned NumSlots = 16;
+
+        /** the calling thread's slot */
+        Slot& _slot();
+
+        unsigned _sum( AtomicUInt Slot::*counter ) const;
+
         void _checkWrap();
-        
-        // todo: there will be a lot of cache line contention on these.  need to do something 
-        //       else eventually.
-        AtomicUInt _insert;
-        AtomicUInt _query;
-        AtomicUInt _update;
-        AtomicUInt _delete;
-        AtomicUInt _getmore;
-        AtomicUInt _command;
+
+        Slot _slots[NumSlots];
     };
 
     extern OpCounters globalOpCounters;
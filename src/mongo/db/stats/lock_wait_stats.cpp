@@ -0,0 +1,177 @@
+// lock_wait_stats.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/db/stats/lock_wait_stats.h"
+
+#include <algorithm>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+
+    LockWaitStats LockWaitStats::global;
+
+    const long long LockWaitStats::kMinWaitMicros;
+
+    LockWaitStats::LockWaitStats() { }
+
+    // static
+    unsigned LockWaitStats::_partition( const StringData& ns ) {
+        unsigned h = 0;
+        for ( size_t i = 0; i < ns.size(); i++ )
+            h = h * 131 + static_cast<unsigned char>( ns[i] );
+        return h % NumPartitions;
+    }
+
+    void LockWaitStats::record( const StringData& ns , int op , char lockType ,
+                                long long micros ) {
+        if ( micros <= 0 || ns.size() == 0 )
+            return;
+
+        Partition& p = _partitions[ _partition( ns ) ];
+        SimpleMutex::scoped_lock lk( p.lock );
+
+        WaitData& d = p.map[ns];
+        d.count++;
+        d.totalMicros += micros;
+
+        if ( lockType == 'w' || lockType == 'W' )
+            d.writeMicros += micros;
+        else
+            d.readMicros += micros;
+
+        switch ( op ) {
+        case dbQuery:   d.queryMicros += micros;   break;
+        case dbGetMore: d.getmoreMicros += micros; break;
+        case dbInsert:  d.insertMicros += micros;  break;
+        case dbUpdate:  d.updateMicros += micros;  break;
+        case dbDelete:  d.removeMicros += micros;  break;
+        default:        d.otherMicros += micros;   break;
+        }
+    }
+
+    namespace {
+        typedef std::pair<std::string, LockWaitStats::WaitData> WaitEntry;
+
+        bool waitEntryGreater( const WaitEntry& a , const WaitEntry& b ) {
+            return a.second.totalMicros > b.second.totalMicros;
+        }
+    }
+
+    void LockWaitStats::append( BSONObjBuilder& b , int k ) const {
+        std::vector<WaitEntry> all;
+        for ( int i = 0; i < NumPartitions; i++ ) {
+            Partition& p = _partitions[i];
+            SimpleMutex::scoped_lock lk( p.lock );
+            for ( WaitMap::const_iterator it = p.map.begin(); it != p.map.end(); ++it )
+                all.push_back( WaitEntry( it->first , it->second ) );
+        }
+
+        std::sort( all.begin() , all.end() , waitEntryGreater );
+
+        BSONArrayBuilder arr( b.subarrayStart( "topWaits" ) );
+        for ( size_t i = 0; i < all.size() && i < static_cast<size_t>( k ); i++ ) {
+            const WaitData& d = all[i].second;
+            BSONObjBuilder e( arr.subobjStart() );
+            e.append( "ns" , all[i].first );
+            e.appendNumber( "count" , d.count );
+            e.appendNumber( "totalMicros" , d.totalMicros );
+            {
+                BSONObjBuilder lb( e.subobjStart( "byLock" ) );
+                lb.appendNumber( "readMicros" , d.readMicros );
+                lb.appendNumber( "writeMicros" , d.writeMicros );
+                lb.done();
+            }
+            {
+                BSONObjBuilder ob( e.subobjStart( "byOp" ) );
+                ob.appendNumber( "queryMicros" , d.queryMicros );
+                ob.appendNumber( "getmoreMicros" , d.getmoreMicros );
+                ob.appendNumber( "insertMicros" , d.insertMicros );
+                ob.appendNumber( "updateMicros" , d.updateMicros );
+                ob.appendNumber( "removeMicros" , d.removeMicros );
+                ob.appendNumber( "otherMicros" , d.otherMicros );
+                ob.done();
+            }
+            e.done();
+        }
+        arr.done();
+    }
+
+    void LockWaitStats::reset() {
+        for ( int i = 0; i < NumPartitions; i++ ) {
+            Partition& p = _partitions[i];
+            SimpleMutex::scoped_lock lk( p.lock );
+            p.map = WaitMap();
+        }
+    }
+
+    /**
+     * { lockStats: 1, topK: <n>, reset: <bool> }
+     *
+     * Reports the namespaces that have accumulated the most lock acquisition wait time,
+     * worst first, broken down by lock and op type.  Use this to find the collections
+     * actually causing write-lock convoys rather than eyeballing the per-DB totals.
+     */
+    class LockStatsCmd : public Command {
+    public:
+        LockStatsCmd() : Command( "lockStats" ) {}
+
+        virtual bool slaveOk() const { return true; }
+        virtual bool adminOnly() const { return true; }
+        virtual LockType locktype() const { return NONE; }
+        virtual void help( stringstream& help ) const {
+            help << "{ lockStats: 1, topK: <n>, reset: <bool> }\n"
+                "lock wait time attributed to namespace and op type, in micros; "
+                "only acquisitions that actually waited are counted";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::lockStats);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        virtual bool run(const string& , BSONObj& cmdObj, int, string& errmsg,
+                         BSONObjBuilder& result, bool fromRepl) {
+            int k = 10;
+            if ( cmdObj["topK"].isNumber() ) {
+                k = cmdObj["topK"].numberInt();
+                if ( k < 1 || k > 1000 ) {
+                    errmsg = "topK must be between 1 and 1000";
+                    return false;
+                }
+            }
+
+            result.append( "note" , "all times in microseconds" );
+            LockWaitStats::global.append( result , k );
+
+            if ( cmdObj["reset"].trueValue() )
+                LockWaitStats::global.reset();
+
+            return true;
+        }
+
+    } lockStatsCmd;
+
+}
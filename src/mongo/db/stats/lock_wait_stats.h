@@ -0,0 +1,100 @@
+// lock_wait_stats.h : lock wait attribution by namespace.
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * Attributes lock acquisition wait time to the namespace and op type of the waiting
+     * operation.  The per-lock LockStat totals in serverStatus say how long we waited on a
+     * database's lock; this says which collections and which kinds of operations did the
+     * waiting, so write-lock convoys can be traced to their source.
+     *
+     * Counters are sharded by namespace hash across a fixed set of partitions, each with its
+     * own mutex, so recording waits from many client threads doesn't itself become a point of
+     * contention.  Only acquisitions that actually waited (see kMinWaitMicros) are recorded;
+     * the uncontended fast path never touches this structure.
+     */
+    class LockWaitStats {
+
+    public:
+        LockWaitStats();
+
+        struct WaitData {
+            WaitData() : count(0), totalMicros(0), readMicros(0), writeMicros(0),
+                         queryMicros(0), getmoreMicros(0), insertMicros(0),
+                         updateMicros(0), removeMicros(0), otherMicros(0) { }
+
+            long long count;
+            long long totalMicros;
+
+            // by lock type: 'r'/'R' vs 'w'/'W' acquisitions
+            long long readMicros;
+            long long writeMicros;
+
+            // by op type; commands, killcursors and internal ops land in otherMicros
+            long long queryMicros;
+            long long getmoreMicros;
+            long long insertMicros;
+            long long updateMicros;
+            long long removeMicros;
+            long long otherMicros;
+        };
+
+        // acquisitions that waited less than this are considered uncontended and not recorded
+        static const long long kMinWaitMicros = 1000;
+
+        /**
+         * Attribute 'micros' of acquisition wait to 'ns'.  'op' is the dbQuery..dbDelete
+         * opcode of the waiting operation (0 if unknown) and 'lockType' the ScopedLock type
+         * character ('r','w','R','W').
+         */
+        void record( const StringData& ns , int op , char lockType , long long micros );
+
+        /**
+         * Append a "topWaits" array with the 'k' namespaces that have accumulated the most
+         * wait time, worst offender first.
+         */
+        void append( BSONObjBuilder& b , int k ) const;
+
+        void reset();
+
+        static LockWaitStats global;
+
+    private:
+        enum { NumPartitions = 16 };
+
+        typedef StringMap<WaitData> WaitMap;
+
+        struct Partition {
+            Partition() : lock( "LockWaitStats" ) { }
+            SimpleMutex lock;
+            WaitMap map;
+        };
+
+        static unsigned _partition( const StringData& ns );
+
+        mutable Partition _partitions[NumPartitions];
+    };
+
+}
@@ -44,7 +44,9 @@ namespace mongo {
         _created = curTimeMicros64();
         _globalUsage = Top::global.getGlobalData();
 //        _totalWriteLockedTime = d.dbMutex.info().getTimeLocked();
-        Top::global.cloneMap(_usage);
+        // per-interval deltas, not a copy of the whole usage map: with many namespaces
+        // the full copy under Top's lock dwarfed the activity being measured
+        Top::global.snapshotDirtyUsage(_usage);
     }
 
     SnapshotDelta::SnapshotDelta( const SnapshotData& older , const SnapshotData& newer )
@@ -58,16 +60,10 @@ namespace mongo {
     }
     Top::UsageMap SnapshotDelta::collectionUsageDiff() {
         verify( _newer._created > _older._created );
-        Top::UsageMap u;
-
-        for ( Top::UsageMap::const_iterator i=_newer._usage.begin(); i != _newer._usage.end(); ++i ) {
-            Top::UsageMap::const_iterator j = _older._usage.find(i->first);
-            if (j != _older._usage.end())
-                u[i->first] = Top::CollectionData( j->second , i->second );
-            else
-                u[i->first] = i->second;
-        }
-        return u;
+        // snapshots store collection usage as per-interval deltas (see takeSnapshot),
+        // so for the adjacent snapshots a SnapshotDelta covers this is just the newer
+        // snapshot's map
+        return _newer._usage;
     }
 
     Snapshots::Snapshots(int n)
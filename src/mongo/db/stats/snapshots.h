@@ -43,7 +43,9 @@ namespace mongo {
 
     /**
      * stores a point in time snapshot
-     * i.e. all counters at a given time
+     * i.e. all counters at a given time.  collection usage is stored as the deltas for
+     * the interval ending at _created (only namespaces that were active then), so the
+     * cost of a snapshot scales with activity rather than with the number of namespaces.
      */
     class SnapshotData {
         void takeSnapshot();
@@ -51,7 +53,7 @@ namespace mongo {
         unsigned long long _created;
         Top::CollectionData _globalUsage;
         unsigned long long _totalWriteLockedTime; // micros of total time locked
-        Top::UsageMap _usage;
+        Top::UsageMap _usage; // per-interval usage deltas
 
         friend class SnapshotThread;
         friend class SnapshotDelta;
@@ -59,7 +61,9 @@ namespace mongo {
     };
 
     /**
-     * contains performance information for a time period
+     * contains performance information for a time period.
+     * older and newer must be adjacent snapshots, as collection usage is kept per
+     * interval (see SnapshotData).
      */
     class SnapshotDelta {
     public:
@@ -0,0 +1,150 @@
+// tcmalloc_server_status.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#ifdef MONGO_HAVE_GPERFTOOLS
+
+#include "third_party/gperftools-2.0/src/gperftools/malloc_extension.h"
+
+#include "mongo/base/parse_number.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    namespace {
+
+        void appendNumericProperty( BSONObjBuilder& b, const char* name, const char* property ) {
+            size_t value;
+            if ( MallocExtension::instance()->GetNumericProperty( property, &value ) )
+                b.appendNumber( name, static_cast<long long>( value ) );
+        }
+
+        /**
+         * serverStatus section exposing the embedded tcmalloc's internals:
+         * heap and pageheap occupancy plus the aggregate thread cache bytes.
+         * ask for it with {tcmalloc: 1}; {tcmalloc: 2} adds the allocator's
+         * formatted report, which breaks the central freelists down per size
+         * class.
+         */
+        class TCMallocServerStatusSection : public ServerStatusSection {
+        public:
+            TCMallocServerStatusSection() : ServerStatusSection( "tcmalloc" ) {}
+
+            virtual bool includeByDefault() const { return false; }
+
+            virtual BSONObj generateSection( const BSONElement& configElement ) const {
+                BSONObjBuilder b;
+                {
+                    BSONObjBuilder sub( b.subobjStart( "generic" ) );
+                    appendNumericProperty( sub, "current_allocated_bytes",
+                                           "generic.current_allocated_bytes" );
+                    appendNumericProperty( sub, "heap_size", "generic.heap_size" );
+                    sub.done();
+                }
+                {
+                    BSONObjBuilder sub( b.subobjStart( "tcmalloc" ) );
+                    appendNumericProperty( sub, "pageheap_free_bytes",
+                                           "tcmalloc.pageheap_free_bytes" );
+                    appendNumericProperty( sub, "pageheap_unmapped_bytes",
+                                           "tcmalloc.pageheap_unmapped_bytes" );
+                    appendNumericProperty( sub, "max_total_thread_cache_bytes",
+                                           "tcmalloc.max_total_thread_cache_bytes" );
+                    appendNumericProperty( sub, "current_total_thread_cache_bytes",
+                                           "tcmalloc.current_total_thread_cache_bytes" );
+                    sub.done();
+                }
+                if ( configElement.isNumber() && configElement.numberInt() > 1 ) {
+                    char buffer[4096];
+                    MallocExtension::instance()->GetStats( buffer, sizeof( buffer ) );
+                    b.append( "formattedString", buffer );
+                }
+                return b.obj();
+            }
+        } tcmallocServerStatusSection;
+
+        /* setParameter tunable for the aggregate thread cache budget, e.g.
+           db.adminCommand({setParameter: 1, tcmallocMaxTotalThreadCacheBytes: <bytes>}) */
+        class TCMallocMaxTotalThreadCacheBytesSetting : public ServerParameter {
+        public:
+            TCMallocMaxTotalThreadCacheBytesSetting()
+                : ServerParameter( ServerParameterSet::getGlobal(),
+                                   "tcmallocMaxTotalThreadCacheBytes" ) {}
+
+            virtual void append( BSONObjBuilder& b, const std::string& name ) {
+                size_t value;
+                if ( MallocExtension::instance()->GetNumericProperty(
+                             "tcmalloc.max_total_thread_cache_bytes", &value ) ) {
+                    b.appendNumber( name, static_cast<long long>( value ) );
+                }
+            }
+
+            virtual Status set( const BSONElement& newValueElement ) {
+                long long newValue;
+                if ( !newValueElement.coerce( &newValue ) || newValue <= 0 ) {
+                    return Status( ErrorCodes::BadValue, mongoutils::str::stream() <<
+                                   "Invalid value for tcmallocMaxTotalThreadCacheBytes: " <<
+                                   newValueElement );
+                }
+                return _set( newValue );
+            }
+
+            virtual Status setFromString( const std::string& str ) {
+                long long newValue;
+                Status status = parseNumberFromString( str, &newValue );
+                if ( !status.isOK() )
+                    return status;
+                if ( newValue <= 0 ) {
+                    return Status( ErrorCodes::BadValue, mongoutils::str::stream() <<
+                                   "Invalid value for tcmallocMaxTotalThreadCacheBytes: " <<
+                                   newValue );
+                }
+                return _set( newValue );
+            }
+
+        private:
+            Status _set( long long newValue ) {
+                if ( !MallocExtension::instance()->SetNumericProperty(
+                             "tcmalloc.max_total_thread_cache_bytes",
+                             static_cast<size_t>( newValue ) ) ) {
+                    return Status( ErrorCodes::InternalError,
+                                   "failed to set tcmalloc.max_total_thread_cache_bytes" );
+                }
+                return Status::OK();
+            }
+        } tcmallocMaxTotalThreadCacheBytesSetting;
+
+    }  // namespace
+
+}  // namespace mongo
+
+#endif  // MONGO_HAVE_GPERFTOOLS
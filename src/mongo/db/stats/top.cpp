@@ -36,6 +36,7 @@
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/util/net/message.h"
 #include "mongo/db/commands.h"
 
@@ -47,6 +48,48 @@ namespace mongo {
         count = (newer.count >= older.count) ? (newer.count - older.count) : newer.count;
     }
 
+    Top::LatencyHistogram::LatencyHistogram( const LatencyHistogram& older ,
+                                             const LatencyHistogram& newer ) {
+        // same caveat as UsageData's diff on rollovers and drop()
+        for ( int i = 0; i < NumBuckets; i++ ) {
+            buckets[i] = ( newer.buckets[i] >= older.buckets[i] ) ?
+                ( newer.buckets[i] - older.buckets[i] ) : newer.buckets[i];
+        }
+    }
+
+    long long Top::LatencyHistogram::percentile( double p ) const {
+        long long total = 0;
+        for ( int i = 0; i < NumBuckets; i++ )
+            total += buckets[i];
+        if ( total == 0 )
+            return 0;
+
+        long long target = static_cast<long long>( p * total + 0.5 );
+        if ( target < 1 )
+            target = 1;
+
+        long long seen = 0;
+        for ( int i = 0; i < NumBuckets; i++ ) {
+            seen += buckets[i];
+            if ( seen >= target )
+                return ( 1LL << ( i + 1 ) ) - 1;
+        }
+        return ( 1LL << NumBuckets ) - 1; // not reached
+    }
+
+    void Top::LatencyHistogram::append( BSONObjBuilder& b ) const {
+        BSONArrayBuilder arr( b.subarrayStart( "histogram" ) );
+        for ( int i = 0; i < NumBuckets; i++ ) {
+            if ( !buckets[i] )
+                continue;
+            BSONObjBuilder bb( arr.subobjStart() );
+            bb.appendNumber( "micros" , ( 1LL << ( i + 1 ) ) - 1 );
+            bb.appendNumber( "count" , buckets[i] );
+            bb.done();
+        }
+        arr.done();
+    }
+
     Top::CollectionData::CollectionData( const CollectionData& older , const CollectionData& newer )
         : total( older.total , newer.total ) ,
           readLock( older.readLock , newer.readLock ) ,
@@ -56,7 +99,10 @@ namespace mongo {
           insert( older.insert , newer.insert ) ,
           update( older.update , newer.update ) ,
           remove( older.remove , newer.remove ),
-          commands( older.commands , newer.commands ) {
+          commands( older.commands , newer.commands ),
+          readLatency( older.readLatency , newer.readLatency ),
+          writeLatency( older.writeLatency , newer.writeLatency ),
+          commandLatency( older.commandLatency , newer.commandLatency ) {
 
     }
 
@@ -73,6 +119,8 @@ namespace mongo {
         }
 
         CollectionData& coll = _usage[ns];
+        if ( _dirtySinceSnapshot.find( ns ) == _dirtySinceSnapshot.end() )
+            _dirtySinceSnapshot[ns] = coll; // baseline for the next usage snapshot
         _record( coll , op , lockType , micros , command );
         _record( _global , op , lockType , micros , command );
     }
@@ -91,21 +139,29 @@ namespace mongo {
             break;
         case dbUpdate:
             c.update.inc( micros );
+            c.writeLatency.inc( micros );
             break;
         case dbInsert:
             c.insert.inc( micros );
+            c.writeLatency.inc( micros );
             break;
         case dbQuery:
-            if ( command )
+            if ( command ) {
                 c.commands.inc( micros );
-            else
+                c.commandLatency.inc( micros );
+            }
+            else {
                 c.queries.inc( micros );
+                c.readLatency.inc( micros );
+            }
             break;
         case dbGetMore:
             c.getmore.inc( micros );
+            c.readLatency.inc( micros );
             break;
         case dbDelete:
             c.remove.inc( micros );
+            c.writeLatency.inc( micros );
             break;
         case dbKillCursors:
             break;
@@ -130,6 +186,19 @@ namespace mongo {
         out = _usage;
     }
 
+    void Top::snapshotDirtyUsage( Top::UsageMap& out ) {
+        SimpleMutex::scoped_lock lk(_lock);
+        out = UsageMap();
+        for ( UsageMap::const_iterator i = _dirtySinceSnapshot.begin();
+                i != _dirtySinceSnapshot.end(); ++i ) {
+            UsageMap::const_iterator j = _usage.find( i->first );
+            if ( j == _usage.end() )
+                continue; // dropped since it was touched
+            out[i->first] = CollectionData( i->second , j->second );
+        }
+        _dirtySinceSnapshot = UsageMap();
+    }
+
     void Top::append( BSONObjBuilder& b ) {
         SimpleMutex::scoped_lock lk( _lock );
         _appendToUsageMap( b , _usage );
@@ -162,6 +231,10 @@ namespace mongo {
             _appendStatsEntry( b , "remove" , coll.remove );
             _appendStatsEntry( b , "commands" , coll.commands );
 
+            _appendLatencyEntry( b , "readLatency" , coll.readLatency );
+            _appendLatencyEntry( b , "writeLatency" , coll.writeLatency );
+            _appendLatencyEntry( b , "commandLatency" , coll.commandLatency );
+
             bb.done();
         }
     }
@@ -173,6 +246,16 @@ namespace mongo {
         bb.done();
     }
 
+    void Top::_appendLatencyEntry( BSONObjBuilder& b , const char * statsName ,
+                                   const LatencyHistogram& hist ) const {
+        BSONObjBuilder bb( b.subobjStart( statsName ) );
+        bb.appendNumber( "p50" , hist.percentile( .50 ) );
+        bb.appendNumber( "p99" , hist.percentile( .99 ) );
+        bb.appendNumber( "p999" , hist.percentile( .999 ) );
+        hist.append( bb );
+        bb.done();
+    }
+
     class TopCmd : public Command {
     public:
         TopCmd() : Command( "top", true ) {}
@@ -200,6 +283,37 @@ namespace mongo {
 
     } topCmd;
 
+    /**
+     * serverStatus section with the server-wide per-op-type latency
+     * distributions, so tail percentiles are visible without turning on
+     * profiling or walking the full per-collection top output.
+     */
+    class OpLatenciesSSS : public ServerStatusSection {
+    public:
+        OpLatenciesSSS() : ServerStatusSection( "opLatencies" ) {}
+        virtual bool includeByDefault() const { return true; }
+
+        BSONObj generateSection( const BSONElement& configElement ) const {
+            Top::CollectionData global = Top::global.getGlobalData();
+            BSONObjBuilder b;
+            _appendOne( b , "reads" , global.readLatency );
+            _appendOne( b , "writes" , global.writeLatency );
+            _appendOne( b , "commands" , global.commandLatency );
+            return b.obj();
+        }
+
+    private:
+        void _appendOne( BSONObjBuilder& b , const char * name ,
+                         const Top::LatencyHistogram& hist ) const {
+            BSONObjBuilder bb( b.subobjStart( name ) );
+            bb.appendNumber( "p50" , hist.percentile( .50 ) );
+            bb.appendNumber( "p99" , hist.percentile( .99 ) );
+            bb.appendNumber( "p999" , hist.percentile( .999 ) );
+            hist.append( bb );
+            bb.done();
+        }
+    } opLatenciesSSS;
+
     Top Top::global;
 
 }
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <cstring>
+
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #include "mongo/util/concurrency/mutex.h"
@@ -44,6 +46,49 @@ namespace mongo {
             }
         };
 
+        /**
+         * log-scale latency histogram: bucket n counts operations that took
+         * [2^n .. 2^(n+1)) microseconds, so the whole range up to ~35 minutes
+         * fits in 32 counters and tail percentiles stay visible no matter how
+         * skewed the distribution is.  cheap enough to keep one per namespace
+         * and update under Top's existing lock.
+         */
+        struct LatencyHistogram {
+            enum { NumBuckets = 32 };
+
+            LatencyHistogram() { memset( buckets , 0 , sizeof( buckets ) ); }
+
+            /**
+             * constructs a diff
+             */
+            LatencyHistogram( const LatencyHistogram& older , const LatencyHistogram& newer );
+
+            void inc( long long micros ) {
+                int b = 0;
+                unsigned long long v = static_cast<unsigned long long>( micros > 0 ? micros : 0 );
+                while ( v >>= 1 )
+                    b++;
+                if ( b >= NumBuckets )
+                    b = NumBuckets - 1;
+                buckets[b]++;
+            }
+
+            /**
+             * @param p fraction in (0,1), e.g. .99
+             * @return upper bound in micros of the bucket the p'th percentile
+             *         falls in, or 0 if the histogram is empty
+             */
+            long long percentile( double p ) const;
+
+            /**
+             * appends the non-empty buckets as a "histogram" array of
+             * { micros : <bucket upper bound> , count : n } entries
+             */
+            void append( BSONObjBuilder& b ) const;
+
+            long long buckets[NumBuckets];
+        };
+
         struct CollectionData {
             /**
              * constructs a diff
@@ -62,6 +107,11 @@ namespace mongo {
             UsageData update;
             UsageData remove;
             UsageData commands;
+
+            // op-type latency distributions, in micros
+            LatencyHistogram readLatency;     // queries and getmores
+            LatencyHistogram writeLatency;    // inserts, updates, removes
+            LatencyHistogram commandLatency;
         };
 
         typedef StringMap<CollectionData> UsageMap;
@@ -70,6 +120,14 @@ namespace mongo {
         void record( const StringData& ns , int op , int lockType , long long micros , bool command );
         void append( BSONObjBuilder& b );
         void cloneMap(UsageMap& out) const;
+
+        /**
+         * replaces out with per-interval diffs: one entry per namespace whose counters
+         * changed since the previous call, valued as the change itself.  cost is bounded
+         * by activity since the last call rather than by the total number of namespaces.
+         * intended for the stats snapshot thread, which calls it once per interval.
+         */
+        void snapshotDirtyUsage( UsageMap& out );
         CollectionData getGlobalData() const { return _global; }
         void collectionDropped( const StringData& ns );
 
@@ -79,11 +137,16 @@ namespace mongo {
     private:
         void _appendToUsageMap( BSONObjBuilder& b , const UsageMap& map ) const;
         void _appendStatsEntry( BSONObjBuilder& b , const char * statsName , const UsageData& map ) const;
+        void _appendLatencyEntry( BSONObjBuilder& b , const char * statsName ,
+                                  const LatencyHistogram& hist ) const;
         void _record( CollectionData& c , int op , int lockType , long long micros , bool command );
 
         mutable SimpleMutex _lock;
         CollectionData _global;
         UsageMap _usage;
+        // namespaces touched since the last snapshotDirtyUsage call, mapped to their
+        // counters as of that call (the baseline the next snapshot diffs against)
+        UsageMap _dirtySinceSnapshot;
         string _lastDropped;
     };
 
@@ -47,16 +47,53 @@ using namespace mongoutils;
 
 namespace mongo {
 
-    void DurableMappedFile::remapThePrivateView() {
+    size_t DurableMappedFile::remapThePrivateView() {
         verify(storageGlobalParams.dur);
 
         // todo 1.9 : it turns out we require that we always remap to the same address.
         // so the remove / add isn't necessary and can be removed?
         void *old = _view_private;
-        //privateViews.remove(_view_private);        
+        //privateViews.remove(_view_private);
+        size_t remapped;
+#if defined(_WIN32) || defined(__sunos__)
+        // these platforms can only replace the whole view
         _view_private = remapPrivateView(_view_private);
+        remapped = (size_t) length();
+#else
+        if( _dirtyLow < _dirtyHigh ) {
+            // only throw away the span that PREPLOGBUFFER saw writes to since the last
+            // remap; cost then scales with write traffic rather than with file size
+            _view_private = remapPrivateViewRange(_view_private, _dirtyLow, _dirtyHigh - _dirtyLow);
+            remapped = _dirtyHigh - _dirtyLow;
+        }
+        else {
+            // flagged for remap but no region recorded - be safe and do it all
+            _view_private = remapPrivateView(_view_private);
+            remapped = (size_t) length();
+        }
+#endif
+        _dirtyLow = ~((size_t)0);
+        _dirtyHigh = 0;
         //privateViews.add(_view_private, this);
         fassert( 16112, _view_private == old );
+        return remapped;
+    }
+
+    unsigned long long DurableMappedFile::dirtyEstimateBytes() const {
+        if (!storageGlobalParams.dur) {
+            // no intent tracking without journaling; assume the whole file is dirty
+            return length();
+        }
+        // racy read of a counter written by PREPLOGBUFFER; only used to rank files for
+        // the background flush, so an occasionally stale value is fine
+        return _bytesNotedSinceFlush;
+    }
+
+    MemoryMappedFile::Flushable* DurableMappedFile::prepareFlush() {
+        // writes noted after this point belong to the next flush cycle.  resetting before
+        // the flush (rather than after) can only over-count, never under-count, dirtiness.
+        _bytesNotedSinceFlush = 0;
+        return MemoryMappedFile::prepareFlush();
     }
 
     /** register view. threadsafe */
@@ -138,17 +175,29 @@ namespace mongo {
         _p = RelativePath::fromFullPath(prefix);
     }
 
+    // --ephemeral maps data files copy-on-write: dirty pages become anonymous memory
+    // that is never written back, which with journaling off makes the database purely
+    // in-memory.  incompatible with dur, which needs the write view to reach the file.
+    static int mapOptions(bool sequentialHint) {
+        int options = sequentialHint ? MongoFile::SEQUENTIAL : 0;
+        if (storageGlobalParams.ephemeral) {
+            verify(!storageGlobalParams.dur);
+            options |= MongoFile::PRIVATE;
+        }
+        return options;
+    }
+
     bool DurableMappedFile::open(const std::string& fname, bool sequentialHint) {
         LOG(3) << "mmf open " << fname << endl;
         setPath(fname);
-        _view_write = mapWithOptions(fname.c_str(), sequentialHint ? SEQUENTIAL : 0);
+        _view_write = mapWithOptions(fname.c_str(), mapOptions(sequentialHint));
         return finishOpening();
     }
 
     bool DurableMappedFile::create(const std::string& fname, unsigned long long& len, bool sequentialHint) {
         LOG(3) << "mmf create " << fname << endl;
         setPath(fname);
-        _view_write = map(fname.c_str(), len, sequentialHint ? SEQUENTIAL : 0);
+        _view_write = map(fname.c_str(), len, mapOptions(sequentialHint));
         return finishOpening();
     }
 
@@ -170,7 +219,9 @@ namespace mongo {
         return false;
     }
 
-    DurableMappedFile::DurableMappedFile() : _willNeedRemap(false) {
+    DurableMappedFile::DurableMappedFile()
+        : _willNeedRemap(false), _dirtyLow(~((size_t)0)), _dirtyHigh(0),
+          _bytesNotedSinceFlush(0) {
         _view_write = _view_private = 0;
     }
 
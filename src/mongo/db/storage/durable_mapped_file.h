@@ -95,15 +95,43 @@ namespace mongo {
         */
         bool& willNeedRemap() { return _willNeedRemap; }
 
-        void remapThePrivateView();
+        /** note that [ofs, ofs+len) of the private view was written to.  called from
+            PREPLOGBUFFER (single threaded) so the remap can cover just the dirty span
+            instead of the whole view.
+        */
+        void noteWriteRegion(size_t ofs, unsigned len) {
+            if( ofs < _dirtyLow )
+                _dirtyLow = ofs;
+            if( ofs + len > _dirtyHigh )
+                _dirtyHigh = ofs + len;
+            _bytesNotedSinceFlush += len;
+        }
+
+        /** @return number of bytes of the private view remapped */
+        size_t remapThePrivateView();
 
         virtual bool isDurableMappedFile() { return true; }
 
+    protected:
+        /** journaled write volume since the last flush; lets the background flusher do
+            the dirtiest files first.  an overestimate (intents can overlap), never an
+            underestimate. */
+        virtual unsigned long long dirtyEstimateBytes() const;
+
+        virtual Flushable* prepareFlush();
+
     private:
 
         void *_view_write;
         void *_view_private;
         bool _willNeedRemap;
+
+        // dirty span of the private view since the last remap; maintained by
+        // noteWriteRegion(), reset by remapThePrivateView()
+        size_t _dirtyLow;
+        size_t _dirtyHigh;
+        // bytes noted written since the last prepareFlush(); see dirtyEstimateBytes()
+        unsigned long long _bytesNotedSinceFlush;
         RelativePath _p;   // e.g. "somepath/dbname"
         int _fileSuffixNo;  // e.g. 3.  -1="ns"
 
@@ -39,6 +39,8 @@
 #include "mongo/db/storage/data_file.h"
 #include "mongo/db/storage/extent.h"
 #include "mongo/db/storage/extent_manager.h"
+#include "mongo/db/storage_options.h"
+#include "mongo/util/time_support.h"
 
 #include "mongo/db/pdfile.h"
 
@@ -51,7 +53,11 @@ namespace mongo {
         : _dbname( dbname.toString() ),
           _path( path.toString() ),
           _freeListDetails( freeListDetails ),
-          _directoryPerDB( directoryPerDB ) {
+          _directoryPerDB( directoryPerDB ),
+          _recentGrowthBytes( 0 ),
+          _prevGrowthBytes( 0 ),
+          _growthWindowStart( 0 ),
+          _lazyOpenMutex( "ExtentManager::lazyOpen" ) {
     }
 
     ExtentManager::~ExtentManager() {
@@ -63,6 +69,7 @@ namespace mongo {
             delete _files[i];
         }
         _files.clear();
+        _fileBases.clear();
     }
 
     boost::filesystem::path ExtentManager::fileName( int n ) const {
@@ -79,38 +86,96 @@ namespace mongo {
     Status ExtentManager::init() {
         verify( _files.size() == 0 );
 
+        // discover how many files exist, but map only the first one here; the
+        // rest are opened on first access or by the catalog warmer.  with many
+        // databases, mapping every file up front dominates startup time.
+        int numExisting = 0;
         for ( int n = 0; n < DiskLoc::MaxFiles; n++ ) {
-            boost::filesystem::path fullName = fileName( n );
-            if ( !boost::filesystem::exists( fullName ) )
+            if ( !boost::filesystem::exists( fileName( n ) ) )
                 break;
+            numExisting++;
+        }
 
-            string fullNameString = fullName.string();
-
-            auto_ptr<DataFile> df( new DataFile(n) );
+        if ( numExisting == 0 )
+            return Status::OK();
 
-            Status s = df->openExisting( fullNameString.c_str() );
-            if ( !s.isOK() ) {
-                return s;
-            }
+        auto_ptr<DataFile> df( new DataFile(0) );
 
-            if ( df->getHeader()->uninitialized() ) {
-                // pre-alloc only, so we're done
-                break;
-            }
+        Status s = df->openExisting( fileName( 0 ).string().c_str() );
+        if ( !s.isOK() ) {
+            return s;
+        }
 
-            _files.push_back( df.release() );
+        if ( df->getHeader()->uninitialized() ) {
+            // pre-alloc only, so we're done
+            return Status::OK();
         }
 
+        DataFile* file = df.release();
+        _files.resize( numExisting, NULL );
+        _fileBases.resize( numExisting, NULL );
+        _files[0] = file;
+        _fileBases[0] = file->p();
+
         return Status::OK();
     }
 
+    /**
+     * open a file init() discovered but did not map.  first access can come
+     * from several readers at once, so the open itself is serialized by
+     * _lazyOpenMutex; the db lock (any mode) keeps the vectors sized and
+     * excludes the journal's remap phase.  returns NULL without publishing if
+     * the file turns out to be a pre-allocated, never-initialized tail file --
+     * getFile()'s write-locked path sets those up when they are first used.
+     */
+    DataFile* ExtentManager::_lazyOpenFile( int n ) const {
+        scoped_lock lk( _lazyOpenMutex );
+        if ( _files[n] )
+            return _files[n];
+
+        auto_ptr<DataFile> df( new DataFile(n) );
+        Status s = df->openExisting( fileName( n ).string().c_str() );
+        massert( 17537,
+                 str::stream() << "lazy open failed for " << fileName( n ).string()
+                               << ": " << s.toString(),
+                 s.isOK() );
+
+        if ( df->getHeader()->uninitialized() ) {
+            return NULL;
+        }
+
+        DataFile* file = df.release();
+        // publish the base pointer last: fastRecordFor() readers take the
+        // checked path until it appears
+        _files[n] = file;
+        _fileBases[n] = file->p();
+        return file;
+    }
+
+    void ExtentManager::warmFiles() {
+        for ( size_t n = 0; n < _files.size(); n++ ) {
+            if ( _files[n] )
+                continue;
+            if ( !_lazyOpenFile( static_cast<int>( n ) ) ) {
+                // pre-allocated tail file; nothing beyond it to map
+                break;
+            }
+        }
+    }
+
     const DataFile* ExtentManager::_getOpenFile( int n ) const {
         verify(this);
         DEV Lock::assertAtLeastReadLocked( _dbname );
         if ( n < 0 || n >= static_cast<int>(_files.size()) )
             log() << "uh oh: " << n;
         verify( n >= 0 && n < static_cast<int>(_files.size()) );
-        return _files[n];
+        if ( DataFile* df = _files[n] )
+            return df;
+        // referenced by a DiskLoc, so it must exist and be initialized
+        DataFile* df = _lazyOpenFile( n );
+        massert( 17538, str::stream() << "datafile " << fileName( n ).string()
+                                      << " is not initialized but is referenced", df );
+        return df;
     }
 
 
@@ -139,6 +204,7 @@ namespace mongo {
                     verify(false);
                 }
                 _files.push_back(0);
+                _fileBases.push_back(NULL);
             }
             p = _files[n];
         }
@@ -161,8 +227,10 @@ namespace mongo {
             }
             if ( preallocateOnly )
                 delete p;
-            else
+            else {
                 _files[n] = p;
+                _fileBases[n] = p->p();
+            }
         }
         return preallocateOnly ? 0 : p;
     }
@@ -192,20 +260,29 @@ namespace mongo {
         DEV Lock::assertAtLeastReadLocked( _dbname );
         for( vector<DataFile*>::iterator i = _files.begin(); i != _files.end(); i++ ) {
             DataFile *f = *i;
-            f->flush(sync);
+            if ( f ) // not yet lazily opened, so nothing to flush
+                f->flush(sync);
         }
     }
 
     Record* ExtentManager::recordFor( const DiskLoc& loc ) const {
         loc.assertOk();
-        const DataFile* df = _getOpenFile( loc.a() );
 
-        int ofs = loc.getOfs();
+        const int a = loc.a();
+        const int ofs = loc.getOfs();
         if ( ofs < DataFileHeader::HeaderSize ) {
-            df->badOfs(ofs); // will uassert - external call to keep out of the normal code path
+            // will uassert - external call to keep out of the normal code path
+            _getOpenFile( a )->badOfs( ofs );
+        }
+
+        // this is the path every document touch takes; the base-pointer table keeps it to
+        // two loads and an add
+        if ( Record* r = fastRecordFor( loc ) ) {
+            return r;
         }
 
-        return reinterpret_cast<Record*>( df->p() + ofs );
+        // file not published yet (or bad file number); take the checked path
+        return reinterpret_cast<Record*>( _getOpenFile( a )->p() + ofs );
     }
 
     Extent* ExtentManager::extentFor( const DiskLoc& loc ) const {
@@ -216,7 +293,15 @@ namespace mongo {
 
     Extent* ExtentManager::getExtent( const DiskLoc& loc, bool doSanityCheck ) const {
         loc.assertOk();
-        Extent* e = reinterpret_cast<Extent*>( _getOpenFile( loc.a() )->p() + loc.getOfs() );
+
+        const int a = loc.a();
+        Extent* e;
+        if ( a >= 0 && a < static_cast<int>( _fileBases.size() ) && _fileBases[a] ) {
+            e = reinterpret_cast<Extent*>( _fileBases[a] + loc.getOfs() );
+        }
+        else {
+            e = reinterpret_cast<Extent*>( _getOpenFile( a )->p() + loc.getOfs() );
+        }
         if ( doSanityCheck )
             e->assertOk();
         memconcept::is(e, memconcept::concept::extent);
@@ -349,6 +434,41 @@ namespace mongo {
     }
 
 
+    // Length of the sliding window used to estimate a database's growth rate for
+    // background file preallocation.
+    static const unsigned long long growthWindowMillis = 60 * 1000;
+
+    void ExtentManager::_noteExtentGrowth( int size ) {
+
+        unsigned long long now = curTimeMillis64();
+        if ( now - _growthWindowStart > growthWindowMillis ) {
+            // If the database went quiet for more than a full window, the old rate no
+            // longer predicts anything.
+            _prevGrowthBytes =
+                ( now - _growthWindowStart > 2 * growthWindowMillis ) ? 0 : _recentGrowthBytes;
+            _recentGrowthBytes = 0;
+            _growthWindowStart = now;
+        }
+        _recentGrowthBytes += size;
+
+        if ( !storageGlobalParams.prealloc )
+            return;
+
+        if ( _files.empty() || !_files.back() )
+            return;
+
+        // If the headroom left in the newest file is below what we expect to allocate in
+        // the near term, ask the FileAllocator to zero the next file in the background
+        // now.  requestAllocation() is asynchronous and idempotent, so this just tops up
+        // the preallocated pool and never blocks the insert path.
+        long long headroom = _files.back()->getHeader()->unusedLength;
+        long long expected = std::max( 2 * static_cast<long long>( size ),
+                                       _prevGrowthBytes + _recentGrowthBytes );
+        if ( headroom < expected ) {
+            preallocateAFile();
+        }
+    }
+
     DiskLoc ExtentManager::createExtent( int size, int maxFileNoForQuota ) {
         size = quantizeExtentSize( size );
 
@@ -357,6 +477,8 @@ namespace mongo {
 
         verify( size < DataFile::maxSize() );
 
+        _noteExtentGrowth( size );
+
         for ( int i = numFiles() - 1; i >= 0; i-- ) {
             DataFile* f = getFile( i );
             if ( f->getHeader()->unusedLength >= size ) {
@@ -38,6 +38,7 @@
 #include "mongo/base/status.h"
 #include "mongo/base/string_data.h"
 #include "mongo/db/diskloc.h"
+#include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
@@ -84,10 +85,18 @@ namespace mongo {
         void init( NamespaceDetails* freeListDetails );
 
         /**
-         * opens all current files
+         * discovers the current files and maps the first one.  the rest are
+         * opened on first access (or by the catalog warmer): with many
+         * databases, mapping every file up front dominates startup time.
          */
         Status init();
 
+        /**
+         * opens every file init() discovered but left unmapped.  used by the
+         * catalog warmer; requires at least a read lock like any other access.
+         */
+        void warmFiles();
+
         size_t numFiles() const;
         long long fileSize() const;
 
@@ -124,6 +133,19 @@ namespace mongo {
          */
         Record* recordFor( const DiskLoc& loc ) const;
 
+        /**
+         * inline fast path for recordFor(): resolves loc straight off the
+         * base-pointer table with no function call.  returns NULL when the
+         * file's base isn't published yet; the caller then goes through
+         * recordFor(), which takes the fully checked path.
+         */
+        Record* fastRecordFor( const DiskLoc& loc ) const {
+            const int a = loc.a();
+            if ( a >= 0 && a < static_cast<int>( _fileBases.size() ) && _fileBases[a] )
+                return reinterpret_cast<Record*>( _fileBases[a] + loc.getOfs() );
+            return NULL;
+        }
+
         /**
          * @param loc - has to be for a specific Record (not an Extent)
          */
@@ -160,9 +182,20 @@ namespace mongo {
 
         const DataFile* _getOpenFile( int n ) const;
 
+        DataFile* _lazyOpenFile( int n ) const;
+
         DiskLoc _createExtentInFile( int fileNo, DataFile* f,
                                      int size, int maxFileNoForQuota );
 
+        /**
+         * called on every createExtent().  tracks recent extent allocation in a sliding
+         * window to estimate this database's growth rate, and when the headroom left in
+         * the newest file drops below the expected near-term growth, requests background
+         * zeroing of the next file through the FileAllocator, so addAFile() later finds
+         * it ready instead of stalling an insert on foreground allocation.
+         */
+        void _noteExtentGrowth( int size );
+
         boost::filesystem::path fileName( int n ) const;
 
 // -----
@@ -175,7 +208,24 @@ namespace mongo {
         // must be in the dbLock when touching this (and write locked when writing to of course)
         // however during Database object construction we aren't, which is ok as it isn't yet visible
         //   to others and we are in the dbholder lock then.
-        std::vector<DataFile*> _files;
+        // a NULL entry is a file init() discovered but has not mapped yet; filling
+        // one in under a read lock is allowed (serialized by _lazyOpenMutex, and
+        // benign for racing readers as the slots are single pointer stores).
+        mutable std::vector<DataFile*> _files;
+
+        // flat copy of each open file's mapped base address, same index as _files and the
+        // same locking rules.  lets recordFor()/getExtent() resolve a DiskLoc with two loads
+        // and an add instead of going through DataFile on every document touch.
+        mutable std::vector<char*> _fileBases;
+
+        // serializes lazy opens of discovered-but-unmapped files
+        mutable mongo::mutex _lazyOpenMutex;
+
+        // extent allocation growth tracking, see _noteExtentGrowth().  same locking rules
+        // as _files.
+        long long _recentGrowthBytes; // bytes of extents created in the current window
+        long long _prevGrowthBytes;   // bytes of extents created in the previous window
+        unsigned long long _growthWindowStart; // start of the current window, millis
 
     };
 
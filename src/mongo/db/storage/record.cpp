@@ -276,11 +276,93 @@ namespace mongo {
         };
 
         Rolling* rolling = new Rolling[BigHashSize];
-        
+
         int bigHash( size_t region ) {
             return hash( region ) % BigHashSize;
         }
 
+        /**
+         * per-namespace heat tracking.  when a thread sees a page for the first time
+         * (the thread local PointerTable filter), the page is also credited to the
+         * namespace the thread has open, so we can estimate how much hot data each
+         * collection has, not just the server wide total.
+         *
+         * two page sets are kept per namespace: the current window and the previous
+         * one.  the windows swap every RotateTimeSecs, so heat decays on the same
+         * schedule as the Rolling slices.  each set is capped so a scan of a huge
+         * collection costs bounded memory; a capped namespace reads as "at least
+         * this hot".
+         */
+        class NamespaceHeat {
+        public:
+            enum { MaxPagesPerNamespace = 128 * 1024 }; // 512MB of 4k pages per window
+
+            NamespaceHeat()
+                : _lock( "ps::NamespaceHeat" ) {
+                _lastRotate = Listener::getElapsedTimeMillis();
+            }
+
+            void access( const char* ns , size_t page ) {
+                SimpleMutex::scoped_lock lk( _lock );
+
+                long long now = Listener::getElapsedTimeMillis();
+                if ( now - _lastRotate > ( 1000 * RotateTimeSecs ) )
+                    _rotate( now );
+
+                PageSets& sets = _map[ns];
+                if ( sets.current.size() < MaxPagesPerNamespace )
+                    sets.current.insert( page );
+            }
+
+            void append( BSONObjBuilder& b ) {
+                SimpleMutex::scoped_lock lk( _lock );
+
+                for ( Map::const_iterator i = _map.begin(); i != _map.end(); ++i ) {
+                    const PageSets& sets = i->second;
+
+                    unordered_set<size_t> pages = sets.current;
+                    pages.insert( sets.previous.begin(), sets.previous.end() );
+
+                    BSONObjBuilder ns( b.subobjStart( i->first ) );
+                    ns.appendNumber( "pagesInMemory", (long long)pages.size() );
+                    ns.appendNumber( "estimatedHotBytes", (long long)pages.size() * 4096 );
+                    if ( sets.current.size() >= MaxPagesPerNamespace ||
+                         sets.previous.size() >= MaxPagesPerNamespace ) {
+                        ns.append( "capped", true );
+                    }
+                    ns.done();
+                }
+            }
+
+        private:
+
+            struct PageSets {
+                unordered_set<size_t> current;
+                unordered_set<size_t> previous;
+            };
+            typedef map<string,PageSets> Map;
+
+            void _rotate( long long now ) {
+                for ( Map::iterator i = _map.begin(); i != _map.end(); ) {
+                    PageSets& sets = i->second;
+                    if ( sets.current.empty() && sets.previous.empty() ) {
+                        _map.erase( i++ ); // cold for two windows, forget it
+                        continue;
+                    }
+                    sets.previous.swap( sets.current );
+                    sets.current.clear();
+                    ++i;
+                }
+                _lastRotate = now;
+            }
+
+            SimpleMutex _lock;
+            Map _map;
+            long long _lastRotate;
+        };
+
+        NamespaceHeat namespaceHeat;
+
         namespace PointerTable {
 
             /* A "superpage" is a group of 16 contiguous pages that differ
@@ -388,7 +470,11 @@ namespace mongo {
             b.appendNumber( "pagesInMemory", totalPages.size() );
             b.appendNumber( "computationTimeMicros", static_cast<long long>(t.micros()) );
             b.append( "overSeconds", static_cast<int>( time(0) - timestamp ) );
+            b.appendNumber( "physicalRamMB", static_cast<long long>( ProcessInfo().getMemSizeMB() ) );
 
+            BSONObjBuilder namespaces( b.subobjStart( "namespaces" ) );
+            namespaceHeat.append( namespaces );
+            namespaces.done();
         }
         
     }
@@ -516,8 +602,16 @@ namespace mongo {
         if (!seen){
             const size_t page = (size_t)_data >> 12;
             const size_t region = page >> 6;
-            const size_t offset = page & 0x3f;        
+            const size_t offset = page & 0x3f;
             ps::rolling[ps::bigHash(region)].access( region , offset , true );
+
+            // also credit the page to the namespace this thread has open, so the
+            // workingSet section can break hot data down per collection
+            if ( haveClient() ) {
+                Client::Context* ctx = cc().getContext();
+                if ( ctx )
+                    ps::namespaceHeat.access( ctx->ns() , page );
+            }
         }
 
         return this;
@@ -543,7 +637,7 @@ namespace mongo {
         if ( ! client.allowedToThrowPageFaultException() )
             return;
         
-        if ( client.curop() && client.curop()->elapsedMillis() > 50 ) {
+        if ( client.curop() && client.curop()->approxElapsedMillis() > 50 ) {
             // this means we've been going too long to restart
             // we should track how often this happens
             return;
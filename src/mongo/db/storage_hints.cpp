@@ -0,0 +1,192 @@
+// storage_hints.cpp
+
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/db/storage_hints.h"
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/database.h"
+#include "mongo/db/namespace_details.h"
+#include "mongo/db/pdfile.h"
+#include "mongo/db/storage/extent.h"
+#include "mongo/util/mmap.h"
+
+namespace mongo {
+
+    namespace {
+
+        /** madvise every mapped extent of the namespace. */
+        void adviseExtents( NamespaceDetails* d, MAdvise::Advice advice ) {
+            for ( DiskLoc extLoc = d->firstExtent(); !extLoc.isNull();
+                  extLoc = extLoc.ext()->xnext ) {
+                Extent* e = extLoc.ext();
+                MAdvise::advise( e, e->length, advice );
+            }
+        }
+
+        /** records the policy in the user flags and applies it to the mapped extents. */
+        void setAdvice( NamespaceDetails* d, MAdvise::Advice advice ) {
+            d->clearUserFlag( NamespaceDetails::Flag_AdviseRandom |
+                              NamespaceDetails::Flag_AdviseSequential );
+            if ( advice == MAdvise::Random )
+                d->setUserFlag( NamespaceDetails::Flag_AdviseRandom );
+            else if ( advice == MAdvise::Sequential )
+                d->setUserFlag( NamespaceDetails::Flag_AdviseSequential );
+            adviseExtents( d, advice );
+        }
+
+        bool parseAdvice( const BSONElement& e, MAdvise::Advice* advice, string& errmsg ) {
+            const string s = e.valuestrsafe();
+            if ( s == "random" )
+                *advice = MAdvise::Random;
+            else if ( s == "sequential" )
+                *advice = MAdvise::Sequential;
+            else if ( s == "normal" )
+                *advice = MAdvise::Normal;
+            else {
+                errmsg = str::stream() << "invalid access pattern '" << s
+                                       << "': expected 'random', 'sequential' or 'normal'";
+                return false;
+            }
+            return true;
+        }
+    }
+
+    void applyStorageHints( NamespaceDetails* d ) {
+        if ( d->isUserFlagSet( NamespaceDetails::Flag_AdviseRandom ) )
+            adviseExtents( d, MAdvise::Random );
+        else if ( d->isUserFlagSet( NamespaceDetails::Flag_AdviseSequential ) )
+            adviseExtents( d, MAdvise::Sequential );
+    }
+
+    void applyDatabaseStorageHints( Database* db ) {
+        std::list<std::string> namespaces;
+        db->namespaceIndex().getNamespaces( namespaces, false /* onlyCollections */ );
+        for ( std::list<std::string>::const_iterator it = namespaces.begin();
+              it != namespaces.end(); ++it ) {
+            NamespaceDetails* d = db->namespaceIndex().details( *it );
+            if ( d )
+                applyStorageHints( d );
+        }
+    }
+
+    /**
+     * { storageHints: <collection>,
+     *   hint: 'random'|'sequential'|'normal',       // policy for the data extents
+     *   indexHint: 'random'|'sequential'|'normal',  // policy for all its index extents
+     *   evict: true }                               // release resident pages now
+     *
+     * The policy is recorded in the namespace and reapplied when the database is
+     * opened and after a compact.  It is node-local and not replicated: a
+     * secondary serving a different workload may want different hints.
+     */
+    class StorageHintsCmd : public Command {
+    public:
+        StorageHintsCmd() : Command( "storageHints" ) {}
+        virtual bool slaveOk() const { return true; }
+        virtual LockType locktype() const { return WRITE; }
+        virtual bool logTheOp() { return false; }
+        virtual void help( stringstream& help ) const {
+            help <<
+                "Declares the access pattern of a collection's data and index extents,\n"
+                "applied to the kernel as madvise: btrees usually want 'random' (no\n"
+                "readahead), the oplog 'sequential'.  evict:true releases resident pages.\n"
+                "Example: { storageHints: 'foo', hint: 'random', indexHint: 'random' }";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::collMod);
+            out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+        }
+        bool run(const string& dbname, BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl ) {
+            const string ns = dbname + "." + cmdObj.firstElement().valuestr();
+            Client::Context ctx( ns );
+            NamespaceDetails* nsd = nsdetails( ns );
+            if ( ! nsd ) {
+                errmsg = "ns does not exist";
+                return false;
+            }
+
+            if ( cmdObj["hint"].ok() ) {
+                MAdvise::Advice advice;
+                if ( !parseAdvice( cmdObj["hint"], &advice, errmsg ) )
+                    return false;
+                setAdvice( nsd, advice );
+                nsd->syncUserFlags( ns ); // must keep system.namespaces up-to-date
+                result.append( "hint", cmdObj["hint"].valuestrsafe() );
+            }
+
+            if ( cmdObj["indexHint"].ok() ) {
+                MAdvise::Advice advice;
+                if ( !parseAdvice( cmdObj["indexHint"], &advice, errmsg ) )
+                    return false;
+                int nIndexes = 0;
+                NamespaceDetails::IndexIterator ii = nsd->ii();
+                while ( ii.more() ) {
+                    NamespaceDetails* idxd = nsdetails( ii.next().indexNamespace() );
+                    if ( idxd ) {
+                        // no syncUserFlags: index namespaces aren't recreated from
+                        // system.namespaces options, and the flags themselves persist
+                        setAdvice( idxd, advice );
+                        nIndexes++;
+                    }
+                }
+                result.append( "indexHint", cmdObj["indexHint"].valuestrsafe() );
+                result.append( "nIndexes", nIndexes );
+            }
+
+            if ( cmdObj["evict"].trueValue() ) {
+                adviseExtents( nsd, MAdvise::DontNeed );
+                NamespaceDetails::IndexIterator ii = nsd->ii();
+                while ( ii.more() ) {
+                    NamespaceDetails* idxd = nsdetails( ii.next().indexNamespace() );
+                    if ( idxd )
+                        adviseExtents( idxd, MAdvise::DontNeed );
+                }
+                result.appendBool( "evicted", true );
+            }
+
+            return true;
+        }
+    } storageHintsCmd;
+
+} // namespace mongo
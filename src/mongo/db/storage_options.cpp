@@ -30,6 +30,7 @@
 
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/util/numa.h"
 
 namespace mongo {
 
@@ -59,4 +60,18 @@ namespace mongo {
                                                      true,
                                                      true);
 
+    // NUMA placement (see util/numa.h); fixed at startup since they take effect as
+    // files are mapped and background threads start
+    ExportedServerParameter<bool> NumaInterleaveSetting(ServerParameterSet::getGlobal(),
+                                                        "numaInterleave",
+                                                        &numaInterleaveMappedMemory,
+                                                        true,
+                                                        false);
+
+    ExportedServerParameter<int> NumaDurabilityNodeSetting(ServerParameterSet::getGlobal(),
+                                                           "numaDurabilityNode",
+                                                           &numaDurabilityNode,
+                                                           true,
+                                                           false);
+
 } // namespace mongo
@@ -53,7 +53,8 @@ namespace mongo {
             journalCommitInterval(0), // 0 means use default
             quota(false), quotaFiles(8),
             syncdelay(60),
-            useHints(true)
+            useHints(true),
+            ephemeral(false)
         {
             repairpath = dbpath;
             dur = false;
@@ -102,6 +103,12 @@ namespace mongo {
         double syncdelay;      // seconds between fsyncs
 
         bool useHints;         // only off if --nohints
+
+        // --ephemeral: keep all data in memory only.  Data files are mapped
+        // copy-on-write so dirty pages are anonymous memory and are never written
+        // back, journaling is off, and the background flusher is idle.  The dataset
+        // does not survive a restart; start with an empty dbpath.
+        bool ephemeral;
     };
 
     extern StorageGlobalParams storageGlobalParams;
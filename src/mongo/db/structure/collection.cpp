@@ -67,6 +67,37 @@ namespace mongo {
         return new FlatIterator( this, start, dir );
     }
 
+    void Collection::getManyIterators( size_t numDesired,
+                                       vector<CollectionIterator*>* out ) const {
+        verify( ok() );
+
+        if ( numDesired == 0 )
+            numDesired = 1;
+
+        // Capped collections have ordering semantics tied to a single traversal; hand back
+        // one ordinary iterator for those.
+        if ( _details->isCapped() ) {
+            out->push_back( getIterator( DiskLoc(), false, CollectionScanParams::FORWARD ) );
+            return;
+        }
+
+        // Walk the extent chain once, dealing extents out round-robin so each iterator gets
+        // a similar mix of old and new extents.
+        vector< vector<DiskLoc> > buckets;
+        const ExtentManager* em = getExtentManager();
+        size_t which = 0;
+        for ( DiskLoc eLoc = _details->firstExtent(); !eLoc.isNull();
+              eLoc = em->getExtent( eLoc )->xnext ) {
+            if ( buckets.size() < numDesired )
+                buckets.push_back( vector<DiskLoc>() );
+            buckets[which++ % buckets.size()].push_back( eLoc );
+        }
+
+        for ( size_t i = 0; i < buckets.size(); i++ ) {
+            out->push_back( new ExtentGroupIterator( this, buckets[i] ) );
+        }
+    }
+
     BSONObj Collection::docFor( const DiskLoc& loc ) {
         Record* rec = getExtentManager()->recordFor( loc );
         return BSONObj::make( rec->accessed() );
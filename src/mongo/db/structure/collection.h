@@ -31,6 +31,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/diskloc.h"
@@ -47,6 +48,7 @@ namespace mongo {
     class CollectionIterator;
     class FlatIterator;
     class CappedIterator;
+    class ExtentGroupIterator;
 
     /**
      * this is NOT safe through a yield right now
@@ -72,6 +74,14 @@ namespace mongo {
         CollectionIterator* getIterator( const DiskLoc& start, bool tailable,
                                          const CollectionScanParams::Direction& dir) const;
 
+        /**
+         * Returns up to 'numDesired' iterators that together cover the whole collection,
+         * partitioned by extent, so callers can scan the partitions concurrently.  May
+         * return fewer iterators than requested (e.g. small or capped collections).
+         * Caller owns the returned iterators.
+         */
+        void getManyIterators( size_t numDesired, vector<CollectionIterator*>* out ) const;
+
         void deleteDocument( const DiskLoc& loc,
                              bool cappedOK = false,
                              bool noWarn = false,
@@ -101,6 +111,7 @@ namespace mongo {
         friend class Database;
         friend class FlatIterator;
         friend class CappedIterator;
+        friend class ExtentGroupIterator;
     };
 
 }
@@ -126,6 +126,67 @@ namespace mongo {
         return true;
     }
 
+    //
+    // Extent group traversal (parallel collection scan)
+    //
+
+    ExtentGroupIterator::ExtentGroupIterator(const Collection* collection,
+                                             const vector<DiskLoc>& extents)
+        : _collection(collection), _extents(extents), _extentIndex(0) {
+
+        verify( collection->ok() );
+
+        if (!_extents.empty()) {
+            _curr = _collection->getExtentManager()->getExtent( _extents[0] )->firstRecord;
+        }
+        skipEmptyExtents();
+    }
+
+    void ExtentGroupIterator::skipEmptyExtents() {
+        const ExtentManager* em = _collection->getExtentManager();
+        while (_curr.isNull() && _extentIndex + 1 < _extents.size()) {
+            ++_extentIndex;
+            _curr = em->getExtent( _extents[_extentIndex] )->firstRecord;
+        }
+    }
+
+    bool ExtentGroupIterator::isEOF() {
+        return _curr.isNull();
+    }
+
+    DiskLoc ExtentGroupIterator::getNext() {
+        DiskLoc ret = _curr;
+
+        if (!isEOF()) {
+            // getNextRecordInExtent returns DiskLoc() at the end of an extent; move on to
+            // the next non-empty extent of our group then.
+            _curr = _collection->getExtentManager()->getNextRecordInExtent( _curr );
+            skipEmptyExtents();
+        }
+
+        return ret;
+    }
+
+    void ExtentGroupIterator::invalidate(const DiskLoc& dl) {
+        verify( _collection->ok() );
+
+        // Just move past the thing being deleted.
+        if (dl == _curr) {
+            getNext();
+        }
+    }
+
+    void ExtentGroupIterator::prepareToYield() {
+    }
+
+    bool ExtentGroupIterator::recoverFromYield() {
+        // Our extents cannot move or be freed while the collection exists, and deletions of
+        // the record we point at are handled by invalidate(), so there is nothing to fix up.
+        verify( _collection->ok() );
+
+        return true;
+    }
+
     //
     // Capped collection traversal
     //
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/db/exec/collection_scan_common.h"
 
 namespace mongo {
@@ -90,6 +92,40 @@ namespace mongo {
         CollectionScanParams::Direction _direction;
     };
 
+    /**
+     * This class iterates over the records of a fixed group of extents, in extent chain
+     * order.  Several of these, covering disjoint extent groups, make up a parallel scan of
+     * a collection; each can be driven independently by its own cursor.
+     */
+    class ExtentGroupIterator : public CollectionIterator {
+    public:
+        ExtentGroupIterator(const Collection* collection, const vector<DiskLoc>& extents);
+        virtual ~ExtentGroupIterator() { }
+
+        virtual bool isEOF();
+        virtual DiskLoc getNext();
+
+        virtual void invalidate(const DiskLoc& dl);
+        virtual void prepareToYield();
+        virtual bool recoverFromYield();
+
+    private:
+        // Move _curr to the first record at or after position (_extentIndex, _curr).
+        void skipEmptyExtents();
+
+        const Collection* _collection;
+
+        // The extents we cover, in chain order.  Extents don't move or shrink while the
+        // collection exists, so holding the DiskLocs across yields is safe.
+        vector<DiskLoc> _extents;
+
+        // Index into _extents of the extent containing _curr.
+        size_t _extentIndex;
+
+        // The result returned on the next call to getNext().
+        DiskLoc _curr;
+    };
+
     /**
      * This class iterates over a capped collection identified by 'ns'.
      * The collection must exist when the constructor is called.
@@ -43,28 +43,64 @@
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/background.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
     Counter64 ttlPasses;
     Counter64 ttlDeletedDocuments;
+    Counter64 ttlIncompletePasses;
 
     ServerStatusMetricField<Counter64> ttlPassesDisplay("ttl.passes", &ttlPasses);
     ServerStatusMetricField<Counter64> ttlDeletedDocumentsDisplay("ttl.deletedDocuments", &ttlDeletedDocuments);
+    // passes that hit their time budget with expired documents still remaining;
+    // a steadily increasing value means deletion is not keeping up with expiry
+    ServerStatusMetricField<Counter64> ttlIncompletePassesDisplay("ttl.incompletePasses",
+                                                                 &ttlIncompletePasses);
+
+    // documents per second deleted during the last completed pass
+    AtomicInt64 ttlLastPassDeletedPerSecond;
+
+    class TTLDeleteRateMetric : public ServerStatusMetric {
+    public:
+        TTLDeleteRateMetric() : ServerStatusMetric("ttl.lastPassDeletedPerSecond") {}
+        virtual void appendAtLeaf( BSONObjBuilder& b ) const {
+            b.appendNumber( _leafName, ttlLastPassDeletedPerSecond.load() );
+        }
+    } ttlDeleteRateMetric;
 
     MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorEnabled, bool, true );
-    
+
+    // documents deleted per write lock acquisition
+    MONGO_EXPORT_SERVER_PARAMETER( ttlDeleteBatchSize, int, 1000 );
+
+    // how long a single pass may spend deleting before giving up until the next
+    // pass; keeps an expiry storm from monopolizing the monitor's interval
+    MONGO_EXPORT_SERVER_PARAMETER( ttlPassTimeBudgetSecs, int, 30 );
+
     class TTLMonitor : public BackgroundJob {
     public:
         TTLMonitor(){}
         virtual ~TTLMonitor(){}
 
         virtual string name() const { return "TTLMonitor"; }
+
+        // expiry is housekeeping; yield the cpu/io schedulers to foreground work
+        virtual Priority priority() const { return LOW; }
         
         static string secondsExpireField;
         
-        void doTTLForDB( const string& dbName ) {
+        /**
+         * deletes expired documents for one database in batches of
+         * ttlDeleteBatchSize per write lock acquisition, sleeping between
+         * batches for as long as the previous batch took (so foreground writes
+         * get at least half the lock bandwidth during an expiry storm).
+         *
+         * @return false if the pass's time budget ran out with work remaining
+         */
+        bool doTTLForDB( const string& dbName , const Timer& passTimer ) {
 
             bool isMaster = isMasterNs( dbName.c_str() );
             vector<BSONObj> indexes;
@@ -101,32 +137,55 @@ namespace mongo {
                 }
                 
                 LOG(1) << "TTL: " << key << " \t " << query << endl;
-                
+
                 long long n = 0;
-                {
-                    string ns = idx["ns"].String();
-                    Client::WriteContext ctx( ns );
-                    NamespaceDetails* nsd = nsdetails( ns );
-                    if ( ! nsd ) {
-                        // collection was dropped
-                        continue;
+                string ns = idx["ns"].String();
+
+                while ( true ) {
+                    const int batchSize = std::max( 1 , static_cast<int>( ttlDeleteBatchSize ) );
+                    long long deleted = 0;
+                    Timer batchTimer;
+                    {
+                        Client::WriteContext ctx( ns );
+                        NamespaceDetails* nsd = nsdetails( ns );
+                        if ( ! nsd ) {
+                            // collection was dropped
+                            break;
+                        }
+                        if ( nsd->setUserFlag( NamespaceDetails::Flag_UsePowerOf2Sizes ) ) {
+                            nsd->syncUserFlags( ns );
+                        }
+                        // only do deletes if on master
+                        if ( ! isMaster ) {
+                            break;
+                        }
+
+                        deleted = deleteObjects( ns , query , false , true , false , batchSize );
+                        ttlDeletedDocuments.increment( deleted );
+                        n += deleted;
                     }
-                    if ( nsd->setUserFlag( NamespaceDetails::Flag_UsePowerOf2Sizes ) ) {
-                        nsd->syncUserFlags( ns );
+
+                    if ( deleted < batchSize ) {
+                        // this index is caught up
+                        break;
                     }
-                    // only do deletes if on master
-                    if ( ! isMaster ) {
-                        continue;
+
+                    if ( passTimer.seconds() >= ttlPassTimeBudgetSecs ) {
+                        LOG(1) << "TTL: pass budget exhausted with work remaining on " << ns
+                               << ", will resume next pass" << endl;
+                        ttlIncompletePasses.increment();
+                        return false;
                     }
 
-                    n = deleteObjects( ns , query , false , true );
-                    ttlDeletedDocuments.increment( n );
+                    // pace: give foreground writes at least as much lock time as
+                    // the batch just used
+                    sleepmillis( std::min( batchTimer.millis() , 1000 ) );
                 }
 
                 LOG(1) << "\tTTL deleted: " << n << endl;
             }
-            
-            
+
+            return true;
         }
 
         virtual void run() {
@@ -162,16 +221,25 @@ namespace mongo {
                 
                 ttlPasses.increment();
 
+                Timer passTimer;
+                const long long deletedBefore = ttlDeletedDocuments.get();
+
                 for ( set<string>::const_iterator i=dbs.begin(); i!=dbs.end(); ++i ) {
                     string db = *i;
                     try {
-                        doTTLForDB( db );
+                        if ( ! doTTLForDB( db , passTimer ) ) {
+                            // budget ran out; leave the rest for the next pass
+                            break;
+                        }
                     }
                     catch ( DBException& e ) {
                         error() << "error processing ttl for db: " << db << " " << e << endl;
                     }
                 }
 
+                const long long passSecs = std::max( 1 , passTimer.seconds() );
+                ttlLastPassDeletedPerSecond.store(
+                        ( ttlDeletedDocuments.get() - deletedBefore ) / passSecs );
             }
         }
 
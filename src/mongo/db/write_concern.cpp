@@ -171,7 +171,8 @@ namespace mongo {
                 }
 
 
-                if ( timeout > 0 && gleTimerHolder->millis() >= timeout ) {
+                const long long waited = gleTimerHolder->millis();
+                if ( timeout > 0 && waited >= timeout ) {
                     gleWtimeouts.increment();
                     result->append( "wtimeout" , true );
                     *errmsg = "timed out waiting for slaves";
@@ -183,7 +184,14 @@ namespace mongo {
 
                 verify( sprintf( buf , "w block pass: %lld" , ++passes ) < 30 );
                 c.curop()->setMessage( buf );
-                sleepmillis(1);
+
+                // block until a slave progress report satisfies us, waking
+                // periodically to recheck for stepdown and interrupts; this
+                // tracks true replication lag instead of adding poll latency
+                long long maxWait = 100;
+                if ( timeout > 0 && timeout - waited < maxWait )
+                    maxWait = timeout - waited;
+                awaitReplication( op, e, maxWait );
                 killCurrentOp.checkForInterrupt();
             }
 
@@ -202,6 +202,39 @@ namespace ClientTests {
         }
     };
     
+    class WriteWithConcern : public Base {
+    public:
+        WriteWithConcern() : Base( "writewithconcern" ) {}
+        void run() {
+            vector<BSONObj> docs;
+            docs.push_back( BSON( "_id" << 1 << "x" << 1 ) );
+            docs.push_back( BSON( "_id" << 2 << "x" << 1 ) );
+            BSONObj res = db.insertWithConcern( ns(), docs, BSON( "w" << 1 ) );
+            ASSERT( res["ok"].trueValue() );
+            ASSERT_EQUALS( 2, res["n"].numberInt() );
+            ASSERT_EQUALS( 2ULL, db.count( ns() ) );
+
+            res = db.updateWithConcern( ns(), BSON( "x" << 1 ),
+                                        BSON( "$set" << BSON( "x" << 2 ) ),
+                                        BSON( "w" << 1 ), UpdateOption_Multi );
+            ASSERT( res["ok"].trueValue() );
+            ASSERT_EQUALS( 2, res["n"].numberInt() );
+
+            res = db.removeWithConcern( ns(), BSON( "x" << 2 ), BSON( "w" << 1 ),
+                                        RemoveOption_JustOne );
+            ASSERT( res["ok"].trueValue() );
+            ASSERT_EQUALS( 1, res["n"].numberInt() );
+            ASSERT_EQUALS( 1ULL, db.count( ns() ) );
+
+            // duplicate key: the combined reply carries the error, no getLastError needed
+            docs.clear();
+            docs.push_back( BSON( "_id" << 2 << "x" << 3 ) );
+            docs.push_back( BSON( "_id" << 2 << "x" << 3 ) );
+            res = db.insertWithConcern( ns(), docs, BSON( "w" << 1 ) );
+            ASSERT( !res["ok"].trueValue() );
+        }
+    };
+
     class ConnectionStringTests {
     public:
         void run() {
@@ -231,6 +264,7 @@ namespace ClientTests {
             add<CS_10>();
             add<PushBack>();
             add<Create>();
+            add<WriteWithConcern>();
             add<ConnectionStringTests>();
         }
 
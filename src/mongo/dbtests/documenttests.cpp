@@ -78,6 +78,33 @@ namespace DocumentTests {
             }            
         };
 
+        /** Create a Document that shares string storage with a BSONObj. */
+        class CreateFromSharedBsonObj {
+        public:
+            void run() {
+                const string longStr( 100, 'x' ); // too long for the short-string optimization
+                Document document;
+                {
+                    BSONObj obj = BSON( "a" << 1 << "b" << longStr
+                                            << "sub" << BSON( "c" << longStr ) );
+                    document = Document::fromSharedBson( obj );
+                }
+                // the document's values must outlive the BSONObj handle they came from
+                ASSERT_EQUALS( 3U, document.size() );
+                ASSERT_EQUALS( 1, document["a"].getInt() );
+                ASSERT_EQUALS( longStr, document["b"].getString() );
+                ASSERT_EQUALS( longStr, document["sub"]["c"].getString() );
+                assertRoundTrips( document );
+
+                // unowned input is promoted rather than aliased
+                BSONObj owned = BSON( "b" << longStr );
+                BSONObj unowned( owned.objdata() );
+                document = Document::fromSharedBson( unowned );
+                ASSERT_EQUALS( longStr, document["b"].getString() );
+                assertRoundTrips( document );
+            }
+        };
+
         /** Add Document fields. */
         class AddField {
         public:
@@ -114,6 +141,36 @@ namespace DocumentTests {
             }
         };
 
+        /** Get Document values through a reusable position hint. */
+        class GetValueWithPositionHint {
+        public:
+            void run() {
+                Document first = fromBson( BSON( "a" << 1 << "b" << 2 ) );
+                Document second = fromBson( BSON( "a" << 3 << "b" << 4 ) );
+                Document different = fromBson( BSON( "x" << 5 << "a" << 6 ) );
+
+                PositionHint hint;
+                ASSERT_EQUALS( 2, first.getField( "b", &hint ).getInt() );
+
+                // same storage again: the hint is honored rather than recomputed
+                ASSERT_EQUALS( 2, first.getField( "b", &hint ).getInt() );
+
+                // a clone shares the layout, so the hint still applies there
+                MutableDocument cloned( first );
+                cloned.setField( "a", Value( 7 ) );
+                ASSERT_EQUALS( 2, cloned.peek().getField( "b", &hint ).getInt() );
+
+                // other documents -- same shape or not -- carry a different
+                // layout token, so the hint is ignored and re-resolved
+                ASSERT_EQUALS( 4, second.getField( "b", &hint ).getInt() );
+                ASSERT_EQUALS( 6, different.getField( "a", &hint ).getInt() );
+
+                // missing field leaves the hint usable for later lookups
+                ASSERT( different.getField( "zz", &hint ).missing() );
+                ASSERT_EQUALS( 1, first.getField( "a", &hint ).getInt() );
+            }
+        };
+
         /** Get Document fields. */
         class SetField {
         public:
@@ -242,6 +299,36 @@ namespace DocumentTests {
             }
         };
 
+        /** The cached structural hash does not survive mutation. */
+        class HashCacheInvalidation {
+        public:
+            void run() {
+                MutableDocument md;
+                md.addField( "a", Value( 1 ) );
+                Document document = md.freeze();
+
+                // warm the cache, as a hashed container would
+                size_t hashBefore = hash( document );
+
+                MutableDocument mutation( document );
+                mutation.addField( "b", Value( 2 ) );
+                Document mutated = mutation.freeze();
+
+                // the mutated document hashes like an equivalent fresh document, and
+                // differing documents still compare unequal despite the warm caches
+                ASSERT_EQUALS( hash( mutated ),
+                               hash( fromBson( BSON( "a" << 1 << "b" << 2 ) ) ) );
+                ASSERT_EQUALS( hashBefore, hash( document ) );
+                ASSERT( document != mutated );
+                ASSERT( Value( document ) != Value( mutated ) );
+            }
+            size_t hash( const Document& doc ) {
+                size_t seed = 0x106e1e1;
+                doc.hash_combine( seed );
+                return seed;
+            }
+        };
+
         /** Shallow copy clone of a single field Document. */
         class Clone {
         public:
@@ -1405,11 +1492,14 @@ namespace DocumentTests {
         void setupTests() {
             add<Document::Create>();
             add<Document::CreateFromBsonObj>();
+            add<Document::CreateFromSharedBsonObj>();
             add<Document::AddField>();
             add<Document::GetValue>();
+            add<Document::GetValueWithPositionHint>();
             add<Document::SetField>();
             add<Document::Compare>();
             add<Document::CompareNamedNull>();
+            add<Document::HashCacheInvalidation>();
             add<Document::Clone>();
             add<Document::CloneMultipleFields>();
             add<Document::FieldIteratorEmpty>();
@@ -20,6 +20,7 @@
 
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/expression_bytecode.h"
 #include "mongo/dbtests/dbtests.h"
 
 namespace ExpressionTests {
@@ -3355,6 +3356,60 @@ namespace ExpressionTests {
 
     } // namespace AllAnyElements
 
+    namespace Compiled {
+
+        /** An arithmetic tree compiles and matches the tree walker bit for bit. */
+        class Arithmetic {
+        public:
+            void run() {
+                intrusive_ptr<ExpressionNary> inner = new ExpressionMultiply();
+                inner->addOperand( ExpressionFieldPath::create( "b" ) );
+                inner->addOperand( ExpressionConstant::create( Value( 2 ) ) );
+
+                intrusive_ptr<ExpressionNary> tree = new ExpressionAdd();
+                tree->addOperand( ExpressionFieldPath::create( "a" ) );
+                tree->addOperand( ExpressionConstant::create( Value( 5 ) ) );
+                tree->addOperand( inner );
+
+                intrusive_ptr<Expression> compiled = CompiledExpression::attempt( tree );
+                ASSERT( compiled.get() != tree.get() );
+
+                Document doc = fromBson( BSON( "a" << 1 << "b" << 2.5 ) );
+                assertBinaryEqual( toBson( tree->evaluate( doc ) ),
+                                   toBson( compiled->evaluate( doc ) ) );
+            }
+        };
+
+        /** Exotic runtime values fall back to the tree walker's semantics. */
+        class FallbackOnNull {
+        public:
+            void run() {
+                intrusive_ptr<ExpressionNary> tree = new ExpressionAdd();
+                tree->addOperand( ExpressionFieldPath::create( "a" ) );
+                tree->addOperand( ExpressionConstant::create( Value( 1 ) ) );
+
+                intrusive_ptr<Expression> compiled = CompiledExpression::attempt( tree );
+                ASSERT( compiled.get() != tree.get() );
+
+                Document doc = fromBson( fromjson( "{a:null}" ) );
+                assertBinaryEqual( toBson( tree->evaluate( doc ) ),
+                                   toBson( compiled->evaluate( doc ) ) );
+            }
+        };
+
+        /** Unsupported operators are left as the original tree. */
+        class UnsupportedUnchanged {
+        public:
+            void run() {
+                intrusive_ptr<ExpressionNary> tree = new ExpressionToLower();
+                tree->addOperand( ExpressionConstant::create( Value( "AbC" ) ) );
+                intrusive_ptr<Expression> compiled = CompiledExpression::attempt( tree );
+                ASSERT( compiled.get() == tree.get() );
+            }
+        };
+
+    } // namespace Compiled
+
     class All : public Suite {
     public:
         All() : Suite( "expression" ) {
@@ -3658,6 +3713,10 @@ namespace ExpressionTests {
             add<AllAnyElements::TrueViaInt>();
             add<AllAnyElements::FalseViaInt>();
             add<AllAnyElements::Null>();
+
+            add<Compiled::Arithmetic>();
+            add<Compiled::FallbackOnNull>();
+            add<Compiled::UnsupportedUnchanged>();
         }
     } myall;
 
@@ -105,6 +105,12 @@ namespace mongo {
         if (!ret.isOK()) {
             return ret;
         }
+        ret = options->addOption(OD("perfOut", "perfOut", moe::String,
+                    "append perf suite results to this file, one JSON document per line",
+                    true));
+        if (!ret.isOK()) {
+            return ret;
+        }
 
         ret = options->addOption(OD("suites", "suites", moe::StringVector, "test suites to run",
                     false));
@@ -175,6 +181,10 @@ namespace mongo {
             frameworkGlobalParams.perfHist = params["perfHist"].as<unsigned>();
         }
 
+        if (params.count("perfOut")) {
+            frameworkGlobalParams.perfOut = params["perfOut"].as<string>();
+        }
+
         bool nodur = false;
         if( params.count("nodur") ) {
             nodur = true;
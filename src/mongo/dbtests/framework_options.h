@@ -35,6 +35,7 @@ namespace mongo {
 
     struct FrameworkGlobalParams {
         unsigned perfHist;
+        std::string perfOut;
         unsigned long long seed;
         int runsPerTest;
         std::string dbpathSpec;
@@ -594,6 +594,72 @@ namespace IntervalBtreeCursorTests {
         }
     };
 
+    /** countInterval() sums the keys within the bounds without iterating them. */
+    class CountInterval {
+    public:
+        void run() {
+            Client::WriteContext ctx( _ns );
+            _client.dropCollection( _ns );
+            for( int32_t i = 0; i < 500; ++i ) {
+                _client.insert( _ns, BSON( "a" << i ) );
+            }
+            _client.ensureIndex( _ns, BSON( "a" << 1 ) );
+
+            // Inclusive bounds.
+            scoped_ptr<IntervalBtreeCursor> cursor
+                    ( IntervalBtreeCursor::make( nsdetails( _ns ),
+                                                 nsdetails( _ns )->idx( 1 ),
+                                                 BSON( "" << 100 ),
+                                                 true,
+                                                 BSON( "" << 399 ),
+                                                 true ) );
+            ASSERT_EQUALS( 300, cursor->countInterval() );
+
+            // Exclusive bounds.
+            cursor.reset( IntervalBtreeCursor::make( nsdetails( _ns ),
+                                                     nsdetails( _ns )->idx( 1 ),
+                                                     BSON( "" << 100 ),
+                                                     false,
+                                                     BSON( "" << 399 ),
+                                                     false ) );
+            ASSERT_EQUALS( 298, cursor->countInterval() );
+
+            // An empty interval.
+            cursor.reset( IntervalBtreeCursor::make( nsdetails( _ns ),
+                                                     nsdetails( _ns )->idx( 1 ),
+                                                     BSON( "" << 1000 ),
+                                                     true,
+                                                     BSON( "" << 2000 ),
+                                                     true ) );
+            ASSERT_EQUALS( 0, cursor->countInterval() );
+        }
+    };
+
+    /** countInterval() does not count unused keys. */
+    class CountIntervalUnusedKeys {
+    public:
+        void run() {
+            Client::WriteContext ctx( _ns );
+            _client.dropCollection( _ns );
+            for( int32_t i = 0; i < 10; ++i ) {
+                _client.insert( _ns, BSON( "a" << i ) );
+            }
+            _client.ensureIndex( _ns, BSON( "a" << 1 ) );
+
+            // Mark the key at position 3 as unused.
+            nsdetails( _ns )->idx( 1 ).head.btreemod<V1>()->_k( 3 ).setUnused();
+
+            scoped_ptr<IntervalBtreeCursor> cursor
+                    ( IntervalBtreeCursor::make( nsdetails( _ns ),
+                                                 nsdetails( _ns )->idx( 1 ),
+                                                 BSON( "" << 0 ),
+                                                 true,
+                                                 BSON( "" << 6 ),
+                                                 true ) );
+            ASSERT_EQUALS( 6, cursor->countInterval() );
+        }
+    };
+
     /** Advances past a key that becomes unused during a yield. */
     class KeyBecomesUnusedDuringYield {
     public:
@@ -653,6 +719,8 @@ namespace IntervalBtreeCursorTests {
             add<BecomesMultikeyDuringYield>();
             add<UnusedKeys>();
             add<UnusedEndKey>();
+            add<CountInterval>();
+            add<CountIntervalUnusedKeys>();
             add<KeyBecomesUnusedDuringYield>();
         }
     } myall;
@@ -1915,6 +1915,40 @@ namespace NamespaceTests {
             virtual string spec() const { return ""; }
         };
 
+        /** quantizeFineGrainedAllocationSpace() rounds small sizes up to 16 byte classes. */
+        class QuantizeFineGrained : public Base {
+        public:
+            void run() {
+                create();
+                ASSERT_EQUALS( 16, NamespaceDetails::quantizeFineGrainedAllocationSpace( 1 ) );
+                ASSERT_EQUALS( 160, NamespaceDetails::quantizeFineGrainedAllocationSpace( 150 ) );
+                ASSERT_EQUALS( 160, NamespaceDetails::quantizeFineGrainedAllocationSpace( 160 ) );
+                ASSERT_EQUALS( 176, NamespaceDetails::quantizeFineGrainedAllocationSpace( 161 ) );
+                ASSERT_EQUALS( 1024, NamespaceDetails::quantizeFineGrainedAllocationSpace( 1024 ) );
+            }
+            virtual string spec() const { return ""; }
+        };
+
+        /**
+         * getRecordAllocationSize() quantizes small records to 16 byte classes when
+         * Flag_UseFineGrainedSizes is set, and falls back to the coarse policy above 1kb.
+         */
+        class GetRecordAllocationSizeFineGrained : public Base {
+        public:
+            void run() {
+                create();
+                ASSERT( nsd()->setUserFlag( NamespaceDetails::Flag_UseFineGrainedSizes ) );
+                ASSERT( nsd()->isUserFlagSet( NamespaceDetails::Flag_UseFineGrainedSizes ) );
+                ASSERT_EQUALS( 160, nsd()->getRecordAllocationSize( 150 ) );
+
+                // combined with power of two sizes, only large records use the power of two policy
+                ASSERT( nsd()->setUserFlag( NamespaceDetails::Flag_UsePowerOf2Sizes ) );
+                ASSERT_EQUALS( 160, nsd()->getRecordAllocationSize( 150 ) );
+                ASSERT_EQUALS( 2048, nsd()->getRecordAllocationSize( 1500 ) );
+            }
+            virtual string spec() const { return ""; }
+        };
+
         /** alloc() quantizes the requested size using quantizeAllocationSpace() rules. */
         class AllocQuantized : public Base {
         public:
@@ -2418,6 +2452,8 @@ namespace NamespaceTests {
             add< NamespaceDetailsTests::GetRecordAllocationSizeWithPadding >();
             add< NamespaceDetailsTests::GetRecordAllocationSizePowerOf2 >();
             add< NamespaceDetailsTests::GetRecordAllocationSizePowerOf2PaddingIgnored >();
+            add< NamespaceDetailsTests::QuantizeFineGrained >();
+            add< NamespaceDetailsTests::GetRecordAllocationSizeFineGrained >();
             add< NamespaceDetailsTests::AllocQuantized >();
             add< NamespaceDetailsTests::AllocCappedNotQuantized >();
             add< NamespaceDetailsTests::AllocIndexNamespaceNotQuantized >();
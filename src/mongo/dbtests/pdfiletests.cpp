@@ -21,6 +21,7 @@
 
 #include "mongo/db/db.h"
 #include "mongo/db/json.h"
+#include "mongo/db/ops/delete.h"
 #include "mongo/db/pdfile.h"
 #include "mongo/dbtests/dbtests.h"
 
@@ -311,6 +312,27 @@ namespace PdfileTests {
                 ASSERT( 0 != o.getField( "a" ).date() );
             }
         };
+        /** a frozen collection rejects user writes until thawed; god writes still work. */
+        class FrozenRejectsWrites : public Base {
+        public:
+            void run() {
+                BSONObj x = BSON( "x" << 1 );
+                theDataFileMgr.insertWithObjMod( ns(), x );
+
+                nsd()->setUserFlag( NamespaceDetails::Flag_Frozen );
+                BSONObj y = BSON( "x" << 2 );
+                ASSERT_THROWS( theDataFileMgr.insertWithObjMod( ns(), y ), UserException );
+                ASSERT_THROWS( deleteObjects( ns(), BSONObj(), false ), UserException );
+
+                // internal writes (e.g. a compact draining extents) are exempt
+                BSONObj z = BSON( "_id" << 3 << "x" << 3 );
+                theDataFileMgr.insertWithObjMod( ns(), z, false, true );
+
+                nsd()->clearUserFlag( NamespaceDetails::Flag_Frozen );
+                BSONObj w = BSON( "x" << 4 );
+                theDataFileMgr.insertWithObjMod( ns(), w );
+            }
+        };
     } // namespace Insert
 
     class ExtentSizing {
@@ -388,6 +410,7 @@ namespace PdfileTests {
             add< ScanCapped::LastInExtent >();
             add< Insert::InsertAddId >();
             add< Insert::UpdateDate >();
+            add< Insert::FrozenRejectsWrites >();
             add< ExtentSizing >();
         }
     } myall;
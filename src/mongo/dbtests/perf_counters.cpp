@@ -0,0 +1,105 @@
+/** @file perf_counters.cpp : hardware performance counter capture for the perf suite
+*/
+
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/dbtests/perf_counters.h"
+
+#if defined(__linux__)
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mongo {
+
+#if defined(__linux__)
+
+    namespace {
+        int openCounter( unsigned type, unsigned long long config ) {
+            struct perf_event_attr attr;
+            memset( &attr, 0, sizeof(attr) );
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            // calling thread only, any cpu
+            return syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 );
+        }
+
+        long long readCounter( int fd ) {
+            long long value = 0;
+            if ( read( fd, &value, sizeof(value) ) != (ssize_t)sizeof(value) )
+                return -1;
+            return value;
+        }
+    }
+
+    HardwareCounters::HardwareCounters() : _instructions(0), _llcMisses(0) {
+        _instructionsFd = openCounter( PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS );
+        _llcMissesFd = openCounter( PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES );
+        if ( !available() ) {
+            // all or nothing: half a report is more confusing than none
+            if ( _instructionsFd >= 0 ) { close( _instructionsFd ); _instructionsFd = -1; }
+            if ( _llcMissesFd >= 0 ) { close( _llcMissesFd ); _llcMissesFd = -1; }
+        }
+    }
+
+    HardwareCounters::~HardwareCounters() {
+        if ( _instructionsFd >= 0 )
+            close( _instructionsFd );
+        if ( _llcMissesFd >= 0 )
+            close( _llcMissesFd );
+    }
+
+    void HardwareCounters::start() {
+        if ( !available() )
+            return;
+        ioctl( _instructionsFd, PERF_EVENT_IOC_RESET, 0 );
+        ioctl( _llcMissesFd, PERF_EVENT_IOC_RESET, 0 );
+        ioctl( _instructionsFd, PERF_EVENT_IOC_ENABLE, 0 );
+        ioctl( _llcMissesFd, PERF_EVENT_IOC_ENABLE, 0 );
+    }
+
+    void HardwareCounters::stop() {
+        if ( !available() )
+            return;
+        ioctl( _instructionsFd, PERF_EVENT_IOC_DISABLE, 0 );
+        ioctl( _llcMissesFd, PERF_EVENT_IOC_DISABLE, 0 );
+        _instructions = readCounter( _instructionsFd );
+        _llcMisses = readCounter( _llcMissesFd );
+    }
+
+#else
+
+    HardwareCounters::HardwareCounters()
+        : _instructionsFd(-1), _llcMissesFd(-1), _instructions(0), _llcMisses(0) {
+    }
+    HardwareCounters::~HardwareCounters() { }
+    void HardwareCounters::start() { }
+    void HardwareCounters::stop() { }
+
+#endif
+
+} // namespace mongo
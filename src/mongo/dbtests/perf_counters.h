@@ -0,0 +1,53 @@
+/** @file perf_counters.h : hardware performance counter capture for the perf suite
+*/
+
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+namespace mongo {
+
+    /**
+     * Counts retired instructions and last-level-cache misses for the calling
+     * thread via perf_event_open(2).  available() is false on non-Linux builds
+     * and where the counters can't be opened (no PMU, restrictive
+     * perf_event_paranoid); callers should then just skip the numbers.
+     *
+     * Usage: construct once, then start()/stop() around each measured region;
+     * the counts cover the most recent start/stop interval.
+     */
+    class HardwareCounters {
+    public:
+        HardwareCounters();
+        ~HardwareCounters();
+
+        bool available() const { return _instructionsFd >= 0 && _llcMissesFd >= 0; }
+
+        void start();
+        void stop();
+
+        long long instructions() const { return _instructions; }
+        long long llcMisses() const { return _llcMisses; }
+
+    private:
+        int _instructionsFd;
+        int _llcMissesFd;
+        long long _instructions;
+        long long _llcMisses;
+    };
+
+} // namespace mongo
@@ -26,6 +26,7 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/thread/thread.hpp>
+#include <cmath>
 #include <fstream>
 
 #include "mongo/db/db.h"
@@ -37,6 +38,7 @@
 #include "mongo/db/taskqueue.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
+#include "mongo/dbtests/perf_counters.h"
 #include "mongo/util/checksum.h"
 #include "mongo/util/compress.h"
 #include "mongo/util/concurrency/qlock.h"
@@ -209,6 +211,11 @@ namespace PerfTests {
         /* override if your test output doesn't need that */
         virtual bool showDurStats() { return true; }
 
+        // set for the primary timed phase only (see run()); negative means unknown
+        double _cv;                   // percent variation of throughput across run slices
+        double _instructionsPerOp;    // retired instructions per op, if counters available
+        double _llcMissesPerOp;       // last-level-cache misses per op, ditto
+
     public:
         virtual unsigned batchSize() { return 50; }
 
@@ -217,8 +224,59 @@ namespace PerfTests {
             cout << "stats " << setw(42) << left << s << ' ' << right << setw(9) << rps << ' ' << right << setw(5) << ms << "ms ";
             if( showDurStats() )
                 cout << dur::stats.curr->_asCSV();
+            if( _cv >= 0 )
+                cout << " cv:" << fixed << setprecision(1) << _cv << '%';
+            if( _instructionsPerOp >= 0 )
+                cout << " i/op:" << (long long) _instructionsPerOp
+                     << " llcm/op:" << fixed << setprecision(2) << _llcMissesPerOp;
             cout << endl;
 
+            BSONObj resultDoc;
+            {
+                bob b;
+                b.append("host", _perfhostname);
+                b.appendTimeT("when", time(0));
+                b.append("test", s);
+                b.append("rps", (int) rps);
+                b.append("millis", ms);
+                b.appendBool("dur", storageGlobalParams.dur);
+                if (showDurStats() && storageGlobalParams.dur)
+                    b.append("durStats", dur::stats.curr->_asObj());
+                if( _cv >= 0 )
+                    b.append("cv", _cv);
+                if( _instructionsPerOp >= 0 ) {
+                    b.append("instructionsPerOp", _instructionsPerOp);
+                    b.append("llcMissesPerOp", _llcMissesPerOp);
+                }
+                {
+                    bob inf;
+                    inf.append("version", versionString);
+                    if( sizeof(int*) == 4 ) inf.append("bits", 32);
+                    DEV inf.append("DEBUG", true);
+#if defined(_WIN32)
+                    inf.append("os", "win");
+#endif
+                    inf.append("git", gitVersion());
+#ifdef MONGO_SSL
+                    inf.append("OpenSSL", openSSLVersion());
+#endif
+                    inf.append("boost", BOOST_VERSION);
+                    b.append("info", inf.obj());
+                }
+                resultDoc = b.obj();
+            }
+
+            if( !frameworkGlobalParams.perfOut.empty() ) {
+                // one JSON document per line, appended: greppable, and trivially
+                // ingested by trend-tracking tooling
+                ofstream f(frameworkGlobalParams.perfOut.c_str(), ios::app);
+                if( f.is_open() )
+                    f << resultDoc.jsonString() << '\n';
+                else
+                    warning() << "couldn't open " << frameworkGlobalParams.perfOut
+                              << " to save perf results" << endl;
+            }
+
             if( conn && !conn->isFailed() ) {
                 const char *ns = "perf.pstats";
                 if(frameworkGlobalParams.perfHist) {
@@ -258,39 +316,12 @@ namespace PerfTests {
                     cout.flush();
                     needver = false;
                 }
-                {
-                    bob b;
-                    b.append("host", _perfhostname);
-                    b.appendTimeT("when", time(0));
-                    b.append("test", s);
-                    b.append("rps", (int) rps);
-                    b.append("millis", ms);
-                    b.appendBool("dur", storageGlobalParams.dur);
-                    if (showDurStats() && storageGlobalParams.dur)
-                        b.append("durStats", dur::stats.curr->_asObj());
-                    {
-                        bob inf;
-                        inf.append("version", versionString);
-                        if( sizeof(int*) == 4 ) inf.append("bits", 32);
-                        DEV inf.append("DEBUG", true);
-#if defined(_WIN32)
-                        inf.append("os", "win");
-#endif
-                        inf.append("git", gitVersion());
-#ifdef MONGO_SSL
-                        inf.append("OpenSSL", openSSLVersion());
-#endif
-                        inf.append("boost", BOOST_VERSION);
-                        b.append("info", inf.obj());
-                    }
-                    BSONObj o = b.obj();
-                    //cout << "inserting " << o.toString() << endl;
-                    try {
-                        conn->insert(ns, o);
-                    }
-                    catch ( std::exception& e ) {
-                        warning() << "couldn't save perf results: " << e.what() << endl;
-                    }
+                //cout << "inserting " << resultDoc.toString() << endl;
+                try {
+                    conn->insert(ns, resultDoc);
+                }
+                catch ( std::exception& e ) {
+                    warning() << "couldn't save perf results: " << e.what() << endl;
                 }
             }
         }
@@ -318,7 +349,11 @@ namespace PerfTests {
             int hlm = howLong();
             dur::stats._intervalMicros = 0; // no auto rotate
             dur::stats.curr->reset();
+            _cv = _instructionsPerOp = _llcMissesPerOp = -1;
+            HardwareCounters hw;
+            vector<double> sliceRates;
             mongo::Timer t;
+            hw.start();
             n = 0;
             const unsigned int Batch = batchSize();
 
@@ -327,18 +362,50 @@ namespace PerfTests {
                 timed();
             }
             else {
+                // slice the run into ~10 intervals and keep per-slice throughput;
+                // the spread across slices tells a trend tracker whether the
+                // headline number is steady or noise (cv below)
+                const unsigned long long sliceMicros = (unsigned long long) hlm * 1000 / 10;
+                unsigned long long sliceStart = 0;
+                unsigned long long nSlice = 0;
                 do {
                     unsigned int i;
                     for( i = 0; i < Batch; i++ )
                         timed();
                     n += i;
+                    nSlice += i;
+                    unsigned long long now = t.micros();
+                    if( now - sliceStart >= sliceMicros ) {
+                        sliceRates.push_back( double(nSlice) * 1e6 / double(now - sliceStart) );
+                        sliceStart = now;
+                        nSlice = 0;
+                    }
                 } while( t.micros() < (unsigned) hlm * 1000 );
             }
 
             client().getLastError(); // block until all ops are finished
+            hw.stop();
             int ms = t.millis();
 
+            if( sliceRates.size() >= 3 ) {
+                double sum = 0;
+                for( size_t i = 0; i < sliceRates.size(); i++ )
+                    sum += sliceRates[i];
+                double mean = sum / sliceRates.size();
+                double var = 0;
+                for( size_t i = 0; i < sliceRates.size(); i++ )
+                    var += (sliceRates[i] - mean) * (sliceRates[i] - mean);
+                var /= sliceRates.size();
+                if( mean > 0 )
+                    _cv = 100.0 * sqrt(var) / mean;
+            }
+            if( hw.available() && n > 0 ) {
+                _instructionsPerOp = double(hw.instructions()) / double(n);
+                _llcMissesPerOp = double(hw.llcMisses()) / double(n);
+            }
+
             say(n, ms, name());
+            _cv = _instructionsPerOp = _llcMissesPerOp = -1; // primary phase only
 
             post();
 
@@ -1076,6 +1143,97 @@ namespace PerfTests {
         }
     };
 
+    /** vector insert of 100 small docs per op -- the batched write path */
+    class InsertVector : public B {
+        unsigned long long k;
+    public:
+        InsertVector() : k(0) { }
+        string name() { return "insert-vector-100"; }
+        virtual unsigned batchSize() { return 1; }
+        void timed() {
+            vector<BSONObj> docs;
+            docs.reserve(100);
+            for( int i = 0; i < 100; i++ )
+                docs.push_back( BSON("_id" << (long long) k++ << "x" << 99) );
+            client().insert( ns(), docs );
+        }
+    };
+
+    /** one full collection scan over 10k documents per op */
+    class Scan10k : public B {
+    public:
+        string name() { return "scan-10k"; }
+        virtual unsigned batchSize() { return 1; }
+        virtual bool showDurStats() { return false; }
+        void prep() {
+            for( int i = 0; i < 10000; i++ )
+                client().insert( ns(), BSON("_id" << i << "x" << i % 97) );
+            client().getLastError();
+        }
+        void timed() {
+            // nothing matches, so the cursor walks the whole collection
+            auto_ptr<DBClientCursor> c = client().query( ns(), QUERY("x" << -1) );
+            verify( !c->more() );
+        }
+    };
+
+    /** foreground index build over 10k documents per op */
+    class BuildIndex10k : public B {
+    public:
+        string name() { return "build-index-10k"; }
+        virtual unsigned batchSize() { return 1; }
+        void prep() {
+            for( int i = 0; i < 10000; i++ )
+                client().insert( ns(), BSON("_id" << i << "x" << (i * i) % 9973) );
+            client().getLastError();
+        }
+        void timed() {
+            // not ensureIndex: its client-side cache would make later calls no-ops
+            client().insert( "perftest.system.indexes",
+                             BSON("ns" << ns() << "key" << BSON("x" << 1) << "name" << "x_1") );
+            client().dropIndex( ns(), BSON("x" << 1) );
+        }
+    };
+
+    /** $group pipeline over 10k documents into 97 groups per op */
+    class GroupPipeline : public B {
+    public:
+        string name() { return "pipeline-group-10k"; }
+        virtual unsigned batchSize() { return 1; }
+        virtual bool showDurStats() { return false; }
+        void prep() {
+            for( int i = 0; i < 10000; i++ )
+                client().insert( ns(), BSON("_id" << i << "x" << i % 97) );
+            client().getLastError();
+        }
+        void timed() {
+            BSONObj cmd = BSON( "aggregate" << name() << "pipeline" << BSON_ARRAY(
+                BSON( "$group" << BSON( "_id" << "$x" << "n" << BSON("$sum" << 1) ) ) ) );
+            BSONObj res;
+            verify( client().runCommand( "perftest", cmd, res ) );
+        }
+    };
+
+    /** applyOps batch of 10 insert ops per op -- the secondary's replay path */
+    class ApplyOpsBatch : public B {
+        BSONObj cmd;
+    public:
+        string name() { return "apply-ops-10"; }
+        virtual unsigned batchSize() { return 1; }
+        void prep() {
+            BSONArrayBuilder ops;
+            for( int i = 0; i < 10; i++ )
+                ops.append( BSON( "op" << "i" << "ns" << ns()
+                                       << "o" << BSON("_id" << i << "x" << i) ) );
+            cmd = BSON( "applyOps" << ops.arr() );
+        }
+        void timed() {
+            // replayed inserts are applied as upserts, so the same batch can repeat
+            BSONObj res;
+            verify( client().runCommand( "perftest", cmd, res ) );
+        }
+    };
+
     class InsertRandom : public B {
     public:
         virtual int howLongMillis() { return profiling ? 30000 : 5000; }
@@ -1402,6 +1560,11 @@ namespace PerfTests {
                 add< Update1 >();
                 add< MoreIndexes<Update1> >();
                 add< InsertBig >();
+                add< InsertVector >();
+                add< Scan10k >();
+                add< BuildIndex10k >();
+                add< GroupPipeline >();
+                add< ApplyOpsBatch >();
                 add< FailPointTest<false, false> >();
                 add< FailPointTest<true, false> >();
                 add< FailPointTest<true, true> >();
@@ -0,0 +1,109 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/logger/async_message_appender.h"
+
+#include <boost/bind.hpp>
+#include <sstream>
+
+#include "mongo/util/concurrency/thread_name.h"
+
+namespace mongo {
+namespace logger {
+
+namespace {
+
+    // Maximum number of events held in the queue before new events are dropped.  At typical
+    // log line sizes this bounds buffered log data to a few megabytes.
+    const size_t maxQueueSize = 10000;
+
+}  // namespace
+
+    AsyncMessageAppender::QueuedEvent::QueuedEvent(const Event& event)
+        : date(event.getDate()),
+          severity(event.getSeverity()),
+          contextName(event.getContextName().toString()),
+          message(event.getMessage().toString()) {
+    }
+
+    AsyncMessageAppender::AsyncMessageAppender(TargetAutoPtr target)
+        : _target(target.release()),
+          _numDropped(0),
+          _shutdown(false) {
+
+        _writer = boost::thread(boost::bind(&AsyncMessageAppender::run, this));
+    }
+
+    AsyncMessageAppender::~AsyncMessageAppender() {
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _shutdown = true;
+            _hasEvents.notify_one();
+        }
+        // The writer thread drains the queue before exiting.
+        _writer.join();
+    }
+
+    Status AsyncMessageAppender::append(const Event& event) {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_queue.size() >= maxQueueSize) {
+            // Dropping is preferable to stalling the logging thread behind the writer; the
+            // writer thread reports the gap once it catches up.
+            ++_numDropped;
+            return Status::OK();
+        }
+        _queue.push_back(QueuedEvent(event));
+        _hasEvents.notify_one();
+        return Status::OK();
+    }
+
+    void AsyncMessageAppender::run() {
+        setThreadName("asyncLogWriter");
+        for (;;) {
+            EventQueue batch;
+            long long numDropped;
+            {
+                boost::mutex::scoped_lock lock(_mutex);
+                while (_queue.empty() && !_shutdown) {
+                    _hasEvents.wait(lock);
+                }
+                if (_queue.empty()) {
+                    return;
+                }
+                // Take the whole queue in one swap so logging threads are not blocked while
+                // the batch is written out.
+                batch.swap(_queue);
+                numDropped = _numDropped;
+                _numDropped = 0;
+            }
+            for (EventQueue::const_iterator i = batch.begin(); i != batch.end(); ++i) {
+                _target->append(Event(i->date, i->severity, i->contextName, i->message));
+            }
+            if (numDropped > 0) {
+                std::ostringstream os;
+                os << "log queue full; dropped " << numDropped << " log line(s)";
+                std::string message = os.str();
+                _target->append(Event(curTimeMillis64(),
+                                      LogSeverity::Warning(),
+                                      "asyncLogWriter",
+                                      message));
+            }
+        }
+    }
+
+}  // namespace logger
+}  // namespace mongo
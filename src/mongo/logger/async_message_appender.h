@@ -0,0 +1,93 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/logger/appender.h"
+#include "mongo/logger/log_severity.h"
+#include "mongo/logger/message_event.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace logger {
+
+    /**
+     * Appender decorator that makes an underlying MessageEventEphemeral appender asynchronous.
+     *
+     * append() copies the event into a bounded in-memory queue and returns without performing
+     * any encoding or I/O; a dedicated writer thread drains the queue in batches and replays
+     * the events to the underlying appender, so timestamp formatting and the write system call
+     * happen off the logging thread.  When the queue is full, new events are dropped rather
+     * than blocking the caller, and the writer thread reports the number of dropped events
+     * through the underlying appender once it catches up.
+     *
+     * The destructor drains any queued events to the underlying appender before returning.
+     */
+    class AsyncMessageAppender : public Appender<MessageEventEphemeral> {
+        MONGO_DISALLOW_COPYING(AsyncMessageAppender);
+    public:
+        typedef std::auto_ptr<Appender<MessageEventEphemeral> > TargetAutoPtr;
+
+        /**
+         * Constructs an appender forwarding to "target", taking ownership of it, and starts
+         * the writer thread.
+         */
+        explicit AsyncMessageAppender(TargetAutoPtr target);
+
+        virtual ~AsyncMessageAppender();
+
+        virtual Status append(const Event& event);
+
+    private:
+        /**
+         * Copy of an event that owns its string storage, so it can outlive the logging
+         * statement that produced it.
+         */
+        struct QueuedEvent {
+            explicit QueuedEvent(const Event& event);
+
+            Date_t date;
+            LogSeverity severity;
+            std::string contextName;
+            std::string message;
+        };
+        typedef std::deque<QueuedEvent> EventQueue;
+
+        /** Body of the writer thread. */
+        void run();
+
+        boost::scoped_ptr<Appender<MessageEventEphemeral> > _target;
+
+        boost::mutex _mutex;  // Guards the members below.
+        boost::condition _hasEvents;
+        EventQueue _queue;
+        long long _numDropped;
+        bool _shutdown;
+
+        boost::thread _writer;
+    };
+
+}  // namespace logger
+}  // namespace mongo
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "mongo/logger/appender.h"
+#include "mongo/logger/async_message_appender.h"
 #include "mongo/logger/encoder.h"
 #include "mongo/logger/message_event_utf8_encoder.h"
 #include "mongo/logger/message_log_domain.h"
@@ -118,6 +119,39 @@ namespace {
         ASSERT_EQUALS(1, dynamic_cast<CountAppender*>(countAppender.get())->getCount());
     }
 
+    class VectorAppender : public Appender<MessageEventEphemeral> {
+    public:
+        explicit VectorAppender(std::vector<std::string>* messages) : _messages(messages) {}
+        virtual ~VectorAppender() {}
+
+        virtual Status append(const MessageEventEphemeral& event) {
+            _messages->push_back(event.getMessage().toString());
+            return Status::OK();
+        }
+
+    private:
+        std::vector<std::string>* _messages;
+    };
+
+    /**
+     * Events queued through an AsyncMessageAppender reach the underlying appender in order,
+     * and the destructor drains the queue.
+     */
+    TEST_F(LogTest, AsyncMessageAppender) {
+        std::vector<std::string> messages;
+        {
+            AsyncMessageAppender appender(
+                    AsyncMessageAppender::TargetAutoPtr(new VectorAppender(&messages)));
+            ASSERT_OK(appender.append(MessageEventEphemeral(0ULL, LogSeverity::Log(), "", "1")));
+            ASSERT_OK(appender.append(MessageEventEphemeral(0ULL, LogSeverity::Log(), "", "2")));
+            ASSERT_OK(appender.append(MessageEventEphemeral(0ULL, LogSeverity::Log(), "", "3")));
+        }
+        ASSERT_EQUALS(3U, messages.size());
+        ASSERT_EQUALS(std::string("1"), messages[0]);
+        ASSERT_EQUALS(std::string("2"), messages[1]);
+        ASSERT_EQUALS(std::string("3"), messages[2]);
+    }
+
     class A {
     public:
         std::string toString() const {
@@ -61,9 +61,24 @@ namespace mongo {
     {
         int movedCount = 0;
 
+        // per-shard migration budget for the round: each shard serves at most
+        // one migration (as donor or receiver) per round, so one overloaded
+        // shard can't spend a whole round streaming chunks for every one of
+        // its collections back to back
+        set<string> busyShards;
+
         for ( vector<CandidateChunkPtr>::const_iterator it = candidateChunks->begin(); it != candidateChunks->end(); ++it ) {
             const CandidateChunk& chunkInfo = *it->get();
 
+            if ( busyShards.count( chunkInfo.from ) || busyShards.count( chunkInfo.to ) ) {
+                LOG(1) << "skipping migration of " << chunkInfo.chunk.toString()
+                       << " this round: " << chunkInfo.from << " or " << chunkInfo.to
+                       << " already migrating" << endl;
+                continue;
+            }
+            busyShards.insert( chunkInfo.from );
+            busyShards.insert( chunkInfo.to );
+
             // Changes to metadata, borked metadata, and connectivity problems should cause us to
             // abort this chunk move, but shouldn't cause us to abort the entire round of chunks.
             // TODO: Handle all these things more cleanly, since they're expected problems
@@ -200,6 +215,63 @@ namespace mongo {
         }        
     }
 
+    // per-collection merge of the shards' insert hotspot counters
+    struct CollectionHotspots {
+        CollectionHotspots() : total( 0 ), hottest( 0 ) {}
+        double total;       // decayed inserts across all shards and chunks
+        double hottest;     // decayed inserts charged to the hottest chunk
+        BSONObj hottestMin; // that chunk's min key
+    };
+
+    // a chunk gets pre-split when it's taking this many times its fair share of a
+    // collection's inserts...
+    static const double hotspotSkewFactor = 4.0;
+
+    // ... and the collection has seen at least this many (decayed) inserts, so we
+    // don't bother splitting trickles
+    static const double hotspotMinInserts = 1000.0;
+
+    /**
+     * Asks every shard for its insert hotspot counters (see d_hotspots.cpp) and merges
+     * them per collection.  Shards that can't answer (e.g. older versions) are skipped.
+     */
+    static void getInsertHotspots( const vector<Shard>& shards,
+                                   map<string,CollectionHotspots>* hotspots ) {
+        for ( vector<Shard>::const_iterator it = shards.begin(); it != shards.end(); ++it ) {
+            BSONObj res;
+            try {
+                res = it->runCommand( "admin", BSON( "shardingHotspots" << 1 ) );
+            }
+            catch ( const DBException& e ) {
+                LOG(1) << "could not get insert hotspots from " << it->getName()
+                       << causedBy( e ) << endl;
+                continue;
+            }
+
+            if ( res["collections"].type() != Object )
+                continue;
+
+            BSONObjIterator cols( res["collections"].Obj() );
+            while ( cols.more() ) {
+                BSONElement col = cols.next();
+                BSONObj info = col.Obj();
+
+                CollectionHotspots& h = (*hotspots)[col.fieldName()];
+                h.total += info["total"].numberDouble();
+
+                BSONObjIterator chunks( info["chunks"].Obj() );
+                while ( chunks.more() ) {
+                    BSONObj chunk = chunks.next().Obj();
+                    double inserts = chunk["inserts"].numberDouble();
+                    if ( inserts > h.hottest ) {
+                        h.hottest = inserts;
+                        h.hottestMin = chunk["min"].Obj().getOwned();
+                    }
+                }
+            }
+        }
+    }
+
     void Balancer::_doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks ) {
         verify( candidateChunks );
 
@@ -261,6 +333,12 @@ namespace mongo {
 
         OCCASIONALLY warnOnMultiVersion( shardInfo );
 
+        // Ask the shards where inserts have been landing; a chunk soaking up most of a
+        // collection's inserts (the classic monotonic shard key pattern) gets split below
+        // before it has a chance to go jumbo.
+        map<string,CollectionHotspots> hotspots;
+        getInsertHotspots( allShards, &hotspots );
+
         //
         // 3. For each collection, check if the balancing policy recommends moving anything around.
         //
@@ -367,6 +445,38 @@ namespace mongo {
                 continue;
             }
 
+            // proactively split a range that's absorbing far more than its share of the
+            // collection's inserts, per the shards' hotspot counters
+            map<string,CollectionHotspots>::const_iterator hot = hotspots.find( ns );
+            if ( hot != hotspots.end() &&
+                 hot->second.total >= hotspotMinInserts &&
+                 hot->second.hottest * cm->numChunks() >= hotspotSkewFactor * hot->second.total ) {
+
+                ChunkPtr c = cm->findIntersectingChunk( hot->second.hottestMin );
+
+                log() << "ns: " << ns << " chunk " << c->toString()
+                      << " is taking " << (int)( 100 * hot->second.hottest / hot->second.total )
+                      << "% of recent inserts, trying pre-split" << endl;
+
+                BSONObj res;
+                if ( c->singleSplit( false /* only split if there's enough data */, res ).isEmpty() ) {
+                    LOG(1) << "hotspot pre-split not performed: " << res << endl;
+                }
+                else {
+                    log() << "hotspot pre-split worked: " << res << endl;
+                    // state change, just wait till next round
+                    continue;
+                }
+            }
+
+            // attach this mongos's per-chunk write heuristic so the policy can
+            // prefer migrating cold ranges over ones that are taking traffic
+            {
+                ChunkMap chunkMap = cm->getChunkMap();
+                for ( ChunkMap::const_iterator i = chunkMap.begin(); i != chunkMap.end(); ++i )
+                    status.noteChunkLoad( i->second->getMin(), i->second->getBytesWritten() );
+            }
+
             CandidateChunk* p = _policy->balance( ns, status, _balancedLastTime );
             if ( p ) candidateChunks->push_back( CandidateChunkPtr( p ) );
         }
@@ -459,7 +569,9 @@ namespace mongo {
                 uassert( 13258 , "oids broken after resetting!" , _checkOIDs() );
 
                 {
-                    dist_lock_try lk( &balanceLock , "doing balance round" );
+                    // Hold the lock as a lease between rounds, so consecutive rounds by
+                    // this balancer re-enter it without config server round trips.
+                    dist_lock_try lk( &balanceLock , "doing balance round" , 0.0 , true /*asLease*/ );
                     if ( ! lk.got() ) {
                         LOG(1) << "skipping balancing round because another balancer is active" << endl;
 
@@ -185,6 +185,18 @@ namespace mongo {
         return true;
     }
 
+    void DistributionStatus::noteChunkLoad( const BSONObj& min, long long load ) {
+        _chunkLoad[min.getOwned()] = load;
+    }
+
+    long long DistributionStatus::getChunkLoad( const BSONObj& chunk ) const {
+        map<BSONObj,long long>::const_iterator i =
+            _chunkLoad.find( chunk[ChunkType::min()].Obj() );
+        if ( i == _chunkLoad.end() )
+            return 0;
+        return i->second;
+    }
+
     string DistributionStatus::getTagForChunk( const BSONObj& chunk ) const {
         if ( _tagRanges.size() == 0 )
             return "";
@@ -231,6 +243,21 @@ namespace mongo {
         }
         return false;
     }
+    vector<unsigned> BalancerPolicy::_chunksByLoad( const DistributionStatus& distribution,
+                                                     const vector<BSONObj>& chunks ) {
+        vector< pair<long long,unsigned> > order;
+        order.reserve( chunks.size() );
+        for ( unsigned i = 0; i < chunks.size(); i++ )
+            order.push_back( make_pair( distribution.getChunkLoad( chunks[i] ), i ) );
+        // stable so equally cold chunks keep their shard-key order
+        std::stable_sort( order.begin(), order.end() );
+        vector<unsigned> indices;
+        indices.reserve( order.size() );
+        for ( unsigned i = 0; i < order.size(); i++ )
+            indices.push_back( order[i].second );
+        return indices;
+    }
+
     MigrateInfo* BalancerPolicy::balance( const string& ns,
                                           const DistributionStatus& distribution,
                                           int balancedLastTime ) {
@@ -267,9 +294,11 @@ namespace mongo {
                 const vector<BSONObj>& chunks = distribution.getChunks( shard );
                 unsigned numJumboChunks = 0;
 
-                // since we have to move all chunks, lets just do in order
-                for ( unsigned i=0; i<chunks.size(); i++ ) {
-                    BSONObj chunkToMove = chunks[i];
+                // we have to move all chunks eventually, but shed the cold ones
+                // first so the hot ranges keep serving from here as long as possible
+                vector<unsigned> order = _chunksByLoad( distribution, chunks );
+                for ( unsigned i=0; i<order.size(); i++ ) {
+                    BSONObj chunkToMove = chunks[order[i]];
                     if ( _isJumbo( chunkToMove ) ) {
                         numJumboChunks++;
                         continue;
@@ -384,19 +413,23 @@ namespace mongo {
 
             const vector<BSONObj>& chunks = distribution.getChunks( from );
             unsigned numJumboChunks = 0;
-            for ( unsigned j = 0; j < chunks.size(); j++ ) {
-                if ( distribution.getTagForChunk( chunks[j] ) != tag )
+            // coldest first: migrating a hot chunk stalls its traffic for the
+            // whole copy, so it is the last resort
+            vector<unsigned> order = _chunksByLoad( distribution, chunks );
+            for ( unsigned i = 0; i < order.size(); i++ ) {
+                const BSONObj& chunk = chunks[order[i]];
+                if ( distribution.getTagForChunk( chunk ) != tag )
                     continue;
 
-                if ( _isJumbo( chunks[j] ) ) {
+                if ( _isJumbo( chunk ) ) {
                     numJumboChunks++;
                     continue;
                 }
 
-                log() << " ns: " << ns << " going to move " << chunks[j]
+                log() << " ns: " << ns << " going to move " << chunk
                       << " from: " << from << " to: " << to << " tag [" << tag << "]"
                       << endl;
-                return new MigrateInfo( ns, to, from, chunks[j] );
+                return new MigrateInfo( ns, to, from, chunk );
             }
 
             if ( numJumboChunks ) {
@@ -173,6 +173,16 @@ namespace mongo {
 
         /** @return the right tag for chunk, possibly "" */
         string getTagForChunk( const BSONObj& chunk ) const;
+
+        /**
+         * Record observed load for the chunk starting at 'min'.  The value is a
+         * relative weight (e.g. this mongos's bytes-written heuristic), not an
+         * exact counter; the policy uses it to prefer migrating cold chunks.
+         */
+        void noteChunkLoad( const BSONObj& min, long long load );
+
+        /** @return recorded load for the chunk, 0 if nothing was recorded */
+        long long getChunkLoad( const BSONObj& chunk ) const;
         
         /** @return all shards we know about */
         const set<string>& shards() const { return _shards; }
@@ -187,6 +197,7 @@ namespace mongo {
         const ShardInfoMap& _shardInfo;
         const ShardToChunksMap& _shardChunks;
         map<BSONObj,TagRange> _tagRanges;
+        map<BSONObj,long long> _chunkLoad; // keyed by chunk min
         set<string> _allTags;
         set<string> _shards;
     };
@@ -211,6 +222,14 @@ namespace mongo {
 
     private:
         static bool _isJumbo( const BSONObj& chunk );
+
+        /**
+         * indices of 'chunks' sorted coldest first by the load recorded in
+         * 'distribution', so callers try to move the chunks least likely to be
+         * hot while the migration runs
+         */
+        static vector<unsigned> _chunksByLoad( const DistributionStatus& distribution,
+                                               const vector<BSONObj>& chunks );
     };
 
 
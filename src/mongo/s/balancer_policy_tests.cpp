@@ -229,6 +229,30 @@ namespace mongo {
         }
 
 
+        TEST( BalancerPolicyTests, ColdChunkPreferred ) {
+            ShardToChunksMap chunks;
+            addShard( chunks, 10, true );
+            addShard( chunks, 0, true );
+
+            ShardInfoMap shards;
+            shards["shard0"] = ShardInfo( 0, 10, false, false );
+            shards["shard1"] = ShardInfo( 0, 0, false, false );
+
+            DistributionStatus d( shards, chunks );
+
+            // every chunk is hot except the one starting at x:4
+            const vector<BSONObj>& shard0Chunks = chunks["shard0"];
+            for ( unsigned i = 0; i < shard0Chunks.size(); i++ ) {
+                BSONObj min = shard0Chunks[i].getField(ChunkType::min()).Obj();
+                d.noteChunkLoad( min, min == BSON( "x" << 4 ) ? 1 : 100 );
+            }
+
+            MigrateInfo* m = BalancerPolicy::balance( "ns", d, 0 );
+            ASSERT( m );
+            ASSERT_EQUALS( "shard1", m->to );
+            ASSERT_EQUALS( BSON( "x" << 4 ), m->chunk.min );
+        }
+
         TEST( BalancerPolicyTests, TagsDraining ) {
 
             ShardToChunksMap chunks;
@@ -77,7 +77,19 @@ namespace mongo {
         int numTargetErrors = 0;
         int numStaleBatches = 0;
 
-        for ( int rounds = 0; !batchOp.isFinished(); rounds++ ) {
+        // Batches targeted but not yet sent, because their endpoint already had a batch
+        // outstanding when they were targeted
+        vector<TargetedWriteBatch*> heldBatches;
+
+        // Batches out on the network, mapped by endpoint
+        EndpointBatchMap pendingBatches;
+
+        // Ordered batches execute their writes strictly one-at-a-time, so re-targeting while a
+        // write is in flight would start the next write early.  Unordered batches have no such
+        // constraint and can be re-targeted as soon as any response arrives.
+        const bool canStream = clientRequest.getContinueOnError();
+
+        while ( !batchOp.isFinished() ) {
 
             //
             // Refresh the targeter if we need to (no-op if nothing stale)
@@ -94,136 +106,146 @@ namespace mongo {
             }
 
             //
-            // Get child batches to send
+            // Get child batches to send.  This is re-run after every response received, so a
+            // shard whose response came back (including a stale retry) gets its next child
+            // batch immediately while slower shards are still working - bulk latency tracks
+            // each shard's own queue rather than global rounds.  Writes already in flight stay
+            // in the _Pending state and are not re-targeted.
             //
 
-            vector<TargetedWriteBatch*> childBatches;
+            if ( canStream || pendingBatches.empty() ) {
 
-            //
-            // Targeting errors can be caused by remote metadata changing (the collection could have
-            // been dropped and recreated, for example with a new shard key).  If a remote metadata
-            // change occurs *before* a client sends us a batch, we need to make sure that we don't
-            // error out just because we're staler than the client - otherwise mongos will be have
-            // unpredictable behavior.
-            //
-            // (If a metadata change happens *during* or *after* a client sends us a batch, however,
-            // we make no guarantees about delivery.)
-            //
-            // For this reason, we don't record targeting errors until we've refreshed our targeting
-            // metadata at least once *after* receiving the client batch - at that point, we know:
-            //
-            // 1) our new metadata is the same as the metadata when the client sent a batch, and so
-            //    targeting errors are real.
-            // OR
-            // 2) our new metadata is a newer version than when the client sent a batch, and so
-            //    the metadata must have changed after the client batch was sent.  We don't need to
-            //    deliver in this case, since for all the client knows we may have gotten the batch
-            //    exactly when the metadata changed.
-            //
-            // If we've had a targeting error or stale error, we've refreshed the metadata once and
-            // can record target errors.
-            bool recordTargetErrors = numTargetErrors > 0 || numStaleBatches > 0;
-
-            Status targetStatus = batchOp.targetBatch( *_targeter,
-                                                       recordTargetErrors,
-                                                       &childBatches );
-            if ( !targetStatus.isOK() ) {
-                _targeter->noteCouldNotTarget();
-                ++numTargetErrors;
-                continue;
+                vector<TargetedWriteBatch*> childBatches;
+
+                //
+                // Targeting errors can be caused by remote metadata changing (the collection
+                // could have been dropped and recreated, for example with a new shard key).  If a
+                // remote metadata change occurs *before* a client sends us a batch, we need to
+                // make sure that we don't error out just because we're staler than the client -
+                // otherwise mongos will be have unpredictable behavior.
+                //
+                // (If a metadata change happens *during* or *after* a client sends us a batch,
+                // however, we make no guarantees about delivery.)
+                //
+                // For this reason, we don't record targeting errors until we've refreshed our
+                // targeting metadata at least once *after* receiving the client batch - at that
+                // point, we know:
+                //
+                // 1) our new metadata is the same as the metadata when the client sent a batch,
+                //    and so targeting errors are real.
+                // OR
+                // 2) our new metadata is a newer version than when the client sent a batch, and
+                //    so the metadata must have changed after the client batch was sent.  We don't
+                //    need to deliver in this case, since for all the client knows we may have
+                //    gotten the batch exactly when the metadata changed.
+                //
+                // If we've had a targeting error or stale error, we've refreshed the metadata
+                // once and can record target errors.
+                bool recordTargetErrors = numTargetErrors > 0 || numStaleBatches > 0;
+
+                Status targetStatus = batchOp.targetBatch( *_targeter,
+                                                           recordTargetErrors,
+                                                           &childBatches );
+                if ( !targetStatus.isOK() ) {
+                    _targeter->noteCouldNotTarget();
+                    ++numTargetErrors;
+                    // With nothing on the network we can only retry the refresh/target cycle;
+                    // otherwise fall through and drain a response first.
+                    if ( pendingBatches.empty() ) continue;
+                }
+                else {
+                    heldBatches.insert( heldBatches.end(),
+                                        childBatches.begin(),
+                                        childBatches.end() );
+                }
             }
 
             //
-            // Send all child batches
+            // Send side - push out every held batch whose endpoint has no batch outstanding
+            // (one in-flight batch per endpoint at a time)
             //
 
             size_t numSent = 0;
-            while ( numSent != childBatches.size() ) {
+            for ( vector<TargetedWriteBatch*>::iterator it = heldBatches.begin();
+                it != heldBatches.end(); ) {
 
-                // Collect batches out on the network, mapped by endpoint
-                EndpointBatchMap pendingBatches;
+                TargetedWriteBatch* nextBatch = *it;
+                const ConnectionString& hostEndpoint = nextBatch->getEndpoint().shardHost;
 
-                //
-                // Send side
-                //
-
-                // Get as many batches as we can at once
-                for ( vector<TargetedWriteBatch*>::iterator it = childBatches.begin();
-                    it != childBatches.end(); ++it ) {
-
-                    TargetedWriteBatch* nextBatch = *it;
-                    // If the batch is NULL, we sent it previously, so skip
-                    if ( nextBatch == NULL ) continue;
-                    const ConnectionString& hostEndpoint = nextBatch->getEndpoint().shardHost;
-
-                    EndpointBatchMap::iterator pendingIt = pendingBatches.find( &hostEndpoint );
+                EndpointBatchMap::iterator pendingIt = pendingBatches.find( &hostEndpoint );
 
-                    // If we already have a batch for this endpoint, continue
-                    if ( pendingIt != pendingBatches.end() ) continue;
-
-                    // Otherwise send it out to the endpoint
+                // If we already have a batch out for this endpoint, hold this one back.
+                // We'll only get duplicate hostEndpoints if we have broadcast and non-broadcast
+                // endpoints for the same host.
+                if ( pendingIt != pendingBatches.end() ) {
+                    ++it;
+                    continue;
+                }
 
-                    BatchedCommandRequest request( clientRequest.getBatchType() );
-                    batchOp.buildBatchRequest( *nextBatch, &request );
-                    _dispatcher->addCommand( hostEndpoint, request );
+                // Otherwise send it out to the endpoint
 
-                    // Indicate we're done by setting the batch to NULL
-                    // We'll only get duplicate hostEndpoints if we have broadcast and non-broadcast
-                    // endpoints for the same host, so this should be pretty efficient without
-                    // moving stuff around.
-                    *it = NULL;
+                BatchedCommandRequest request( clientRequest.getBatchType() );
+                batchOp.buildBatchRequest( *nextBatch, &request );
+                _dispatcher->addCommand( hostEndpoint, request );
 
-                    // Recv-side is responsible for cleaning up the nextBatch when used
-                    pendingBatches.insert( make_pair( &hostEndpoint, nextBatch ) );
-                }
+                // Recv-side is responsible for cleaning up the nextBatch when used
+                pendingBatches.insert( make_pair( &hostEndpoint, nextBatch ) );
+                it = heldBatches.erase( it );
+                ++numSent;
+            }
 
+            if ( numSent > 0 ) {
                 // Send them all out
                 _dispatcher->sendAll();
-                numSent += pendingBatches.size();
+            }
 
-                //
-                // Recv side
-                //
+            //
+            // Recv side - take a single response, account for it, and loop back to refill that
+            // endpoint's pipeline while the other responses are still outstanding
+            //
 
-                while ( _dispatcher->numPending() > 0 ) {
+            if ( _dispatcher->numPending() > 0 ) {
 
-                    // Get the response
-                    ConnectionString endpoint;
-                    BatchedCommandResponse response;
-                    Status dispatchStatus = _dispatcher->recvAny( &endpoint, &response );
+                // Get the response
+                ConnectionString endpoint;
+                BatchedCommandResponse response;
+                Status dispatchStatus = _dispatcher->recvAny( &endpoint, &response );
 
-                    // Get the TargetedWriteBatch to find where to put the response
-                    TargetedWriteBatch* batchRaw = pendingBatches.find( &endpoint )->second;
-                    scoped_ptr<TargetedWriteBatch> batch( batchRaw );
+                // Get the TargetedWriteBatch to find where to put the response
+                TargetedWriteBatch* batchRaw = pendingBatches.find( &endpoint )->second;
+                scoped_ptr<TargetedWriteBatch> batch( batchRaw );
+                pendingBatches.erase( &endpoint );
 
-                    if ( dispatchStatus.isOK() ) {
+                if ( dispatchStatus.isOK() ) {
 
-                        TrackedErrors trackedErrors;
-                        trackedErrors.startTracking( ErrorCodes::StaleShardVersion );
+                    TrackedErrors trackedErrors;
+                    trackedErrors.startTracking( ErrorCodes::StaleShardVersion );
 
-                        // Dispatch was ok, note response
-                        batchOp.noteBatchResponse( *batch, response, &trackedErrors );
+                    // Dispatch was ok, note response
+                    batchOp.noteBatchResponse( *batch, response, &trackedErrors );
 
-                        // Note if anything was stale
-                        const vector<ShardError*>& staleErrors =
-                            trackedErrors.getErrors( ErrorCodes::StaleShardVersion );
+                    // Note if anything was stale
+                    const vector<ShardError*>& staleErrors =
+                        trackedErrors.getErrors( ErrorCodes::StaleShardVersion );
 
-                        if ( staleErrors.size() > 0 ) {
-                            noteStaleResponses( staleErrors, _targeter );
-                            ++numStaleBatches;
-                        }
+                    if ( staleErrors.size() > 0 ) {
+                        noteStaleResponses( staleErrors, _targeter );
+                        ++numStaleBatches;
                     }
-                    else {
+                }
+                else {
 
-                        // Error occurred dispatching, note it
-                        BatchedErrorDetail error;
-                        buildErrorFrom( dispatchStatus, &error );
-                        batchOp.noteBatchError( *batch, error );
-                    }
+                    // Error occurred dispatching, note it
+                    BatchedErrorDetail error;
+                    buildErrorFrom( dispatchStatus, &error );
+                    batchOp.noteBatchError( *batch, error );
                 }
             }
         }
 
+        dassert( heldBatches.empty() );
+        dassert( pendingBatches.empty() );
+
         batchOp.buildClientResponse( clientResponse );
     }
 
@@ -0,0 +1,128 @@
+//@file changelog_watcher.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/s/changelog_watcher.h"
+
+#include "mongo/client/connpool.h"
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/s/config.h"
+#include "mongo/s/grid.h"
+#include "mongo/s/type_changelog.h"
+
+namespace mongo {
+
+    ChangelogWatcher changelogWatcher;
+
+    ChangelogWatcher::ChangelogWatcher() {
+    }
+
+    ChangelogWatcher::~ChangelogWatcher() {
+    }
+
+    void ChangelogWatcher::_handleEvent( const BSONObj& entry ) {
+        const string what = entry[ChangelogType::what()].str();
+        const string ns = entry[ChangelogType::ns()].str();
+
+        // We only care about events that change the chunk layout of a collection.
+        // Everything else (drops, shard changes, ...) keeps going through the usual
+        // stale-config reload path.
+        if ( what != "split" && what != "multi-split" && what != "moveChunk.commit" )
+            return;
+
+        if ( ns.empty() )
+            return;
+
+        // Only refresh namespaces this mongos already routes for; don't pull in
+        // databases we've never been asked about.
+        DBConfigPtr config = grid.getDBConfig( nsToDatabase( ns ) , false );
+        if ( !config || !config->isSharded( ns ) )
+            return;
+
+        LOG(1) << "changelog watcher refreshing " << ns << " after " << what << endl;
+
+        // Applies a ChunkDiff against the current manager and swaps in the new
+        // (immutable) ChunkManager; requests keep routing from the old snapshot in
+        // the meantime.  Errors are logged and ignored - this is just a pre-warm.
+        config->getChunkManagerIfExists( ns , true );
+    }
+
+    void ChangelogWatcher::_watch() {
+        ScopedDbConnection conn(configServer.getConnectionString().toString(), 30.0);
+
+        // Start from now; everything earlier is reflected in whatever metadata we
+        // load on first use anyway.
+        const Date_t startTime = jsTime();
+
+        auto_ptr<DBClientCursor> cursor =
+            conn->query( ChangelogType::ConfigNS ,
+                         QUERY( ChangelogType::time() << GTE << startTime ) ,
+                         0 , 0 , 0 ,
+                         QueryOption_CursorTailable | QueryOption_AwaitData );
+
+        uassert( 17527 , "could not tail config.changelog" , cursor.get() );
+
+        while ( ! inShutdown() ) {
+            if ( ! cursor->more() ) {
+                if ( cursor->isDead() ) {
+                    // Capped collection rolled over underneath us (or connection
+                    // trouble); reconnect and resume from now.
+                    break;
+                }
+
+                // AwaitData returned with nothing new.
+                sleepsecs( 1 );
+                continue;
+            }
+
+            _handleEvent( cursor->next() );
+        }
+
+        conn.done();
+    }
+
+    void ChangelogWatcher::run() {
+        // this is the body of a BackgroundJob so we mustn't let exceptions escape
+        while ( ! inShutdown() ) {
+            try {
+                _watch();
+            }
+            catch ( const std::exception& e ) {
+                LOG(1) << "changelog watcher error (will retry): " << e.what() << endl;
+            }
+
+            if ( ! inShutdown() )
+                sleepsecs( 10 );
+        }
+    }
+
+}  // namespace mongo
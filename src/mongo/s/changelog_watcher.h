@@ -0,0 +1,79 @@
+//@file changelog_watcher.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#pragma once
+
+#include "mongo/pch.h"
+
+#include "mongo/util/background.h"
+
+namespace mongo {
+
+    /**
+     * Tails the config.changelog capped collection and refreshes this mongos' routing
+     * metadata in the background when another process splits or migrates chunks.
+     *
+     * Splits and migrations already append entries to the changelog when they commit.
+     * By applying the resulting ChunkDiff off the request path, routing keeps being
+     * served from the current (immutable, atomically swapped) ChunkManager and clients
+     * rarely have to pay for a reload inline after a stale-config response.
+     *
+     * This is best-effort: the stale-config protocol remains the source of truth, the
+     * watcher just makes it very unlikely that a request has to wait on a reload.
+     */
+    class ChangelogWatcher : public BackgroundJob {
+    public:
+        ChangelogWatcher();
+        virtual ~ChangelogWatcher();
+
+        // BackgroundJob methods
+
+        virtual void run();
+
+        virtual string name() const { return "ChangelogWatcher"; }
+
+    private:
+        /**
+         * Tails the changelog until the cursor dies or shutdown, refreshing chunk
+         * managers for the namespaces mentioned by interesting entries.  Throws on
+         * connection problems; the caller retries with a fresh connection.
+         */
+        void _watch();
+
+        /**
+         * Processes one changelog entry, triggering a background metadata refresh if
+         * the event changes the chunk layout of a collection we route for.
+         */
+        void _handleEvent( const BSONObj& entry );
+    };
+
+    extern ChangelogWatcher changelogWatcher;
+
+}  // namespace mongo
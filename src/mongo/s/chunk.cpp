@@ -708,6 +708,87 @@ namespace mongo {
     }
 
 
+    void ChunkManager::serializeSnapshot( BSONObjBuilder& b ) const {
+        b.append( "ns", _ns );
+        b.append( "key", _key.key() );
+        b.appendBool( "unique", _unique );
+        _version.addToBSON( b, "version" );
+
+        BSONArrayBuilder chunks( b.subarrayStart( "chunks" ) );
+        for ( ChunkMap::const_iterator it = _chunkMap.begin(); it != _chunkMap.end(); ++it ) {
+            ChunkPtr c = it->second;
+            BSONObjBuilder cb( chunks.subobjStart() );
+            cb.append( "min", c->getMin() );
+            cb.append( "max", c->getMax() );
+            cb.append( "shard", c->getShard().getName() );
+            c->getLastmod().addToBSON( cb, "lastmod" );
+            cb.done();
+        }
+        chunks.done();
+    }
+
+    ChunkManager* ChunkManager::fromSnapshot( const BSONObj& snapshot ) {
+        if ( snapshot["ns"].type() != String || ! snapshot["key"].isABSONObj() )
+            return NULL;
+
+        bool canParse = false;
+        ChunkVersion version = ChunkVersion::fromBSON( snapshot, "version", &canParse );
+        if ( ! canParse || ! version.isSet() )
+            return NULL;
+
+        auto_ptr<ChunkManager> manager(
+                new ChunkManager( snapshot["ns"].String(),
+                                  ShardKeyPattern( snapshot["key"].Obj().getOwned() ),
+                                  snapshot["unique"].trueValue() ) );
+
+        ChunkMap chunkMap;
+        set<Shard> shards;
+        ShardVersionMap shardVersions;
+
+        try {
+            BSONObjIterator it( snapshot["chunks"].Obj() );
+            while ( it.more() ) {
+                BSONObj chunkDoc = it.next().Obj();
+
+                bool chunkParse = false;
+                ChunkVersion lastmod = ChunkVersion::fromBSON( chunkDoc, "lastmod", &chunkParse );
+                if ( ! chunkParse )
+                    return NULL;
+
+                Shard shard = Shard::make( chunkDoc["shard"].String() );
+                ChunkPtr c( new Chunk( manager.get(),
+                                       chunkDoc["min"].Obj().getOwned(),
+                                       chunkDoc["max"].Obj().getOwned(),
+                                       shard,
+                                       lastmod ) );
+
+                chunkMap.insert( make_pair( c->getMax(), c ) );
+                shards.insert( shard );
+
+                ChunkVersion& maxShardVersion = shardVersions[shard];
+                if ( lastmod > maxShardVersion )
+                    maxShardVersion = lastmod;
+            }
+        }
+        catch ( const DBException& ) {
+            // Malformed document or a shard we no longer know about -- the snapshot is
+            // stale, don't seed from it.
+            return NULL;
+        }
+
+        if ( chunkMap.empty() || ! _isValid( chunkMap ) )
+            return NULL;
+
+        // Const members, but nobody else can have a reference yet (see loadExistingRanges).
+        const_cast<ChunkMap&>( manager->_chunkMap ).swap( chunkMap );
+        const_cast<set<Shard>&>( manager->_shards ).swap( shards );
+        const_cast<ShardVersionMap&>( manager->_shardVersions ).swap( shardVersions );
+        const_cast<ChunkRangeManager&>( manager->_chunkRanges ).reloadAll( manager->_chunkMap );
+        manager->_version = version;
+
+        return manager.release();
+    }
+
     /**
      * This is an adapter so we can use config diffs - mongos and mongod do them slightly
      * differently
@@ -434,6 +434,28 @@ namespace mongo {
 
         string toString() const;
 
+        /**
+         * Append a snapshot of this manager -- ns, shard key, unique flag, version and all
+         * chunks -- in the format understood by fromSnapshot().  Used by the mongos routing
+         * metadata cache to persist routing state across restarts.
+         */
+        void serializeSnapshot( BSONObjBuilder& b ) const;
+
+        /**
+         * Rebuild a manager from a serializeSnapshot() document, or NULL if the document is
+         * not usable (malformed, unknown shard, ...).  The result is only suitable as the
+         * seed of a differential load: pass it to setOldManager() on a fresh manager before
+         * calling loadExistingRanges().
+         */
+        static ChunkManager* fromSnapshot( const BSONObj& snapshot );
+
+        /**
+         * Seed the next loadExistingRanges() so it only fetches chunks newer than 'manager'
+         * instead of the whole collection.  Caller is responsible for only seeding with a
+         * manager from the same collection epoch.
+         */
+        void setOldManager( ChunkManagerPtr manager ) { _oldManager = manager; }
+
         ChunkVersion getVersion( const Shard& shard ) const;
         ChunkVersion getVersion() const;
 
@@ -37,6 +37,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/dbmessage.h"
+#include "mongo/db/server_options.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/s/client_info.h"
@@ -48,6 +49,7 @@
 #include "mongo/s/writeback_listener.h"
 #include "mongo/server.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/sock.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -81,9 +83,17 @@ namespace mongo {
         newRequest();
     }
 
+    // suffix making each request's cluster opid unique; the prefix identifies
+    // this mongos (same idiom as the balancer id)
+    static AtomicUInt clusterOpIdCounter;
+
     void ClientInfo::newRequest() {
         _lastAccess = (int) time(0);
 
+        StringBuilder buf;
+        buf << getHostNameCached() << ':' << serverGlobalParams.port << ':' << clusterOpIdCounter++;
+        _clusterOpId = buf.str();
+
         set<string> * temp = _cur;
         _cur = _prev;
         _prev = temp;
@@ -91,6 +101,19 @@ namespace mongo {
         getAuthorizationSession()->startRequest();
     }
 
+    BSONObj ClientInfo::stampClusterOpId( const BSONObj& query ) const {
+        BSONObjBuilder b( query.objsize() + 64 );
+        // mirror the wrapped query detection in ParsedQuery::init
+        if ( query["query"].isABSONObj() || query["$query"].isABSONObj() ) {
+            b.appendElements( query );
+        }
+        else {
+            b.append( "$query" , query );
+        }
+        b.append( "$clusterOpId" , _clusterOpId );
+        return b.obj();
+    }
+
     ClientInfo* ClientInfo::create(AbstractMessagingPort* messagingPort) {
         ClientInfo * info = _tlInfo.get();
         massert(16472, "A ClientInfo already exists for this thread", !info);
@@ -67,6 +67,20 @@ namespace mongo {
          */
         HostAndPort getRemote() const { return _remote; }
 
+        /**
+         * id of the operation currently being processed for this client,
+         * unique across the cluster ("<mongos host>:<port>:<n>")
+         * reassigned by newRequest()
+         */
+        const string& clusterOpId() const { return _clusterOpId; }
+
+        /**
+         * returns query with this operation's cluster opid added as a top level
+         * $clusterOpId option (wrapping the query if it isn't already), so the
+         * shards' currentOp entries can be joined back to the mongos operation
+         */
+        BSONObj stampClusterOpId( const BSONObj& query ) const;
+
         /**
          * notes that this client use this shard
          * keeps track of all shards accessed this request
@@ -137,6 +151,7 @@ namespace mongo {
 
         int _id; // unique client id
         HostAndPort _remote; // server:port of remote socket end
+        string _clusterOpId; // cluster-wide id of the current operation
 
         // we use _a and _b to store shards we've talked to on the current request and the previous
         // we use 2 so we can flip for getLastError type operations
@@ -39,6 +39,7 @@
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/config.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/routing_cache.h"
 #include "mongo/s/server.h"
 #include "mongo/s/type_changelog.h"
 #include "mongo/s/type_chunk.h"
@@ -63,7 +64,17 @@ namespace mongo {
         _dropped = in[CollectionType::dropped()].trueValue();
 
         if ( in[CollectionType::keyPattern()].isABSONObj() ) {
-            shard( new ChunkManager( in ) );
+            ChunkManager* manager = new ChunkManager( in );
+
+            // If the local routing cache has a snapshot of this collection from the same
+            // epoch (typically from before a restart), seed the load with it so we only
+            // fetch chunks newer than the snapshot instead of the whole collection.
+            ChunkManagerPtr seed = routingMetadataCache.takeSeed(
+                    manager->getns(), manager->getVersion().epoch() );
+            if ( seed )
+                manager->setOldManager( seed );
+
+            shard( manager );
         }
 
         _dirty = false;
@@ -85,6 +96,7 @@ namespace mongo {
             _unqiue = manager->isUnique();
             _dirty = true;
             _dropped = false;
+            routingMetadataCache.noteManager( _cm );
         }
         else{
             warning() << "no chunks found for collection " << manager->getns()
@@ -456,8 +468,9 @@ namespace mongo {
 
         if ( shouldReset ){
             ci.resetCM( temp.release() );
+            routingMetadataCache.noteManager( ci.getCM() );
         }
-        
+
         uassert( 15883 , str::stream() << "not sharded after chunk manager reset : " << ns , ci.isSharded() );
         return ci.getCM();
     }
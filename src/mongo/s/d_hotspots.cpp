@@ -0,0 +1,194 @@
+// @file d_hotspots.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/s/d_hotspots.h"
+
+#include <cmath>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/keypattern.h"
+#include "mongo/s/collection_metadata.h"
+#include "mongo/s/d_logic.h"
+#include "mongo/s/type_chunk.h"
+#include "mongo/util/net/listen.h"
+
+namespace mongo {
+
+    // half-life of the per-chunk insert counters: long enough to ride out short bursts,
+    // short enough that yesterday's load can't mask today's hotspot
+    static const double HotspotHalfLifeMillis = 10 * 60 * 1000;
+
+    // per-collection cap on tracked chunks; when full, counters that have decayed to
+    // noise are reaped and no new counters are created beyond the cap
+    static const size_t MaxTrackedChunks = 4096;
+
+    namespace {
+        double decayedValue( double value , long long lastMillis , long long now ) {
+            if ( now <= lastMillis )
+                return value;
+            return value * std::pow( 0.5 , ( now - lastMillis ) / HotspotHalfLifeMillis );
+        }
+    }
+
+    InsertHotspots insertHotspots;
+
+    InsertHotspots::InsertHotspots() : _mutex( "InsertHotspots" ) {}
+
+    void InsertHotspots::record( const string& ns , const BSONObj& chunkMin ) {
+        long long now = Listener::getElapsedTimeMillis();
+
+        scoped_lock lk( _mutex );
+        ChunkCounters& counters = _collections[ns];
+
+        ChunkCounters::iterator it = counters.find( chunkMin );
+        if ( it != counters.end() ) {
+            Counter& c = it->second;
+            c.value = decayedValue( c.value , c.lastMillis , now ) + 1;
+            c.lastMillis = now;
+            return;
+        }
+
+        if ( counters.size() >= MaxTrackedChunks ) {
+            // reap counters that have decayed to noise before giving up on the new one
+            for ( ChunkCounters::iterator r = counters.begin(); r != counters.end(); ) {
+                if ( decayedValue( r->second.value , r->second.lastMillis , now ) < 1 )
+                    counters.erase( r++ );
+                else
+                    ++r;
+            }
+            if ( counters.size() >= MaxTrackedChunks )
+                return;
+        }
+
+        Counter& c = counters[chunkMin.getOwned()];
+        c.value = 1;
+        c.lastMillis = now;
+    }
+
+    void InsertHotspots::report( BSONObjBuilder& result , int maxChunksPerCollection ) const {
+        long long now = Listener::getElapsedTimeMillis();
+
+        scoped_lock lk( _mutex );
+        BSONObjBuilder collections( result.subobjStart( "collections" ) );
+        for ( CollectionMap::const_iterator i = _collections.begin();
+              i != _collections.end(); ++i ) {
+
+            // hottest first; the min key lives in the counter map, so point at it
+            vector< pair<double,const BSONObj*> > chunks;
+            double total = 0;
+            for ( ChunkCounters::const_iterator c = i->second.begin();
+                  c != i->second.end(); ++c ) {
+                double value = decayedValue( c->second.value , c->second.lastMillis , now );
+                total += value;
+                chunks.push_back( make_pair( value , &c->first ) );
+            }
+
+            if ( total < 1 )
+                continue; // fully decayed, nothing worth reporting
+
+            sort( chunks.rbegin() , chunks.rend() );
+
+            BSONObjBuilder col( collections.subobjStart( i->first ) );
+            col.append( "total" , total );
+            BSONArrayBuilder arr( col.subarrayStart( "chunks" ) );
+            for ( size_t n = 0;
+                  n < chunks.size() && n < static_cast<size_t>( maxChunksPerCollection ); n++ ) {
+                BSONObjBuilder chunk( arr.subobjStart() );
+                chunk.append( "min" , *chunks[n].second );
+                chunk.append( "inserts" , chunks[n].first );
+                chunk.done();
+            }
+            arr.done();
+            col.done();
+        }
+        collections.done();
+    }
+
+    void noteShardedInserts( const char* ns , const vector<BSONObj>& objs ) {
+        if ( ! shardingState.enabled() )
+            return;
+
+        CollectionMetadataPtr metadata = shardingState.getCollectionMetadata( ns );
+        if ( ! metadata || metadata->getKeyPattern().isEmpty() )
+            return;
+
+        KeyPattern kp( metadata->getKeyPattern() );
+        for ( size_t i = 0; i < objs.size(); i++ ) {
+            BSONObj key = kp.extractSingleKey( objs[i] );
+            if ( key.isEmpty() )
+                continue;
+
+            ChunkType chunk;
+            if ( ! metadata->getNextChunk( key , &chunk ) )
+                continue;
+            if ( key.woCompare( chunk.getMin() ) < 0 )
+                continue; // getNextChunk returned the chunk after the key; not ours
+
+            insertHotspots.record( ns , chunk.getMin() );
+        }
+    }
+
+    // ---------- admin command ----------
+
+    class ShardingHotspotsCommand : public Command {
+    public:
+        ShardingHotspotsCommand() : Command( "shardingHotspots" ) {}
+
+        void help( stringstream& h ) const {
+            h << "internal: reports decaying per-chunk insert counters so the balancer "
+              << "can pre-split hot shard key ranges";
+        }
+        virtual bool slaveOk() const { return true; }
+        virtual bool adminOnly() const { return true; }
+        virtual LockType locktype() const { return NONE; }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::serverStatus);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+
+        bool run(const string& , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool) {
+            int maxChunks = 100;
+            if ( cmdObj["maxChunks"].isNumber() )
+                maxChunks = cmdObj["maxChunks"].numberInt();
+            insertHotspots.report( result , maxChunks );
+            return true;
+        }
+
+    } shardingHotspotsCmd;
+
+}  // namespace mongo
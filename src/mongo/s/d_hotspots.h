@@ -0,0 +1,89 @@
+// @file d_hotspots.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#pragma once
+
+#include "mongo/pch.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /*
+     * Shard-side telemetry for spotting hot shard key ranges.
+     *
+     * Every sharded insert is charged to the chunk that owns its shard key in a decaying
+     * counter, so a monotonic shard key funnelling all inserts into one chunk shows up as
+     * a single counter towering over the rest.  The 'shardingHotspots' command reports the
+     * counters and the balancer uses the report to split hot ranges before they go jumbo.
+     *
+     * The class is thread safe.
+     */
+    class InsertHotspots {
+    public:
+        InsertHotspots();
+
+        /**
+         * Charges one insert to the chunk of 'ns' whose min key is 'chunkMin'.
+         */
+        void record( const string& ns , const BSONObj& chunkMin );
+
+        /**
+         * Appends the per-collection counters to 'result', one subobject per collection
+         * under "collections", each of the form
+         *   { total: <decayed inserts>, chunks: [ { min: <key>, inserts: <decayed> }, ... ] }
+         * with at most 'maxChunksPerCollection' chunks listed, hottest first.
+         */
+        void report( BSONObjBuilder& result , int maxChunksPerCollection ) const;
+
+    private:
+        struct Counter {
+            double value;          // decayed insert count
+            long long lastMillis;  // elapsed millis (since startup) of the last decay
+        };
+
+        // both keyed by chunk min key / collection ns
+        typedef map<BSONObj,Counter> ChunkCounters;
+        typedef map<string,ChunkCounters> CollectionMap;
+
+        mutable mongo::mutex _mutex;
+        CollectionMap _collections;
+    };
+
+    extern InsertHotspots insertHotspots;
+
+    /*
+     * Charges a batch of inserted documents to the chunks owning their shard keys.
+     * A no-op unless this mongod is sharded and has metadata for 'ns'.
+     */
+    void noteShardedInserts( const char* ns , const vector<BSONObj>& objs );
+
+}  // namespace mongo
@@ -35,6 +35,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/s/collection_metadata.h"
 #include "mongo/s/chunk_version.h"
+#include "mongo/util/concurrency/spin_lock.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/net/message.h"
 
@@ -272,6 +273,22 @@ namespace mongo {
         // Map from a namespace into the metadata we need for each collection on this shard
         typedef map<string,CollectionMetadataPtr> CollectionMetadataMap;
         CollectionMetadataMap _collMetadata;
+
+        // Immutable published copy of _collMetadata for the per-operation read
+        // paths (version checks, metadata lookups).  Writers rebuild it under
+        // _mutex and swap it in via _publishMetadata(); readers only copy the
+        // shared_ptr under _snapshotLock (a few instructions), so they never
+        // contend with metadata installs, refreshes, or migrations holding
+        // _mutex.  The maps pointed to are never modified once published.
+        typedef shared_ptr<const CollectionMetadataMap> MetadataSnapshot;
+        MetadataSnapshot _snapshot;
+        mutable SpinLock _snapshotLock;
+
+        /** republishes _snapshot from _collMetadata; call with _mutex held */
+        void _publishMetadata();
+
+        /** grab the current published snapshot; no _mutex needed */
+        MetadataSnapshot _getSnapshot() const;
     };
 
     extern ShardingState shardingState;
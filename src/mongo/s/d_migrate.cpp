@@ -38,6 +38,7 @@
 
 #include <algorithm>
 #include <boost/thread/thread.hpp>
+#include <deque>
 #include <map>
 #include <string>
 #include <vector>
@@ -200,6 +201,7 @@ namespace mongo {
             _active = false;
             _inCriticalSection = false;
             _memoryUsed = 0;
+            _cloneNext = 0;
         }
 
         /**
@@ -227,6 +229,7 @@ namespace mongo {
             _shardKeyPattern = shardKeyPattern;
 
             verify( _cloneLocs.size() == 0 );
+            verify( _cloneOrder.size() == 0 );
             verify( _deleted.size() == 0 );
             verify( _reload.size() == 0 );
             verify( _memoryUsed == 0 );
@@ -246,6 +249,8 @@ namespace mongo {
                 _deleted.clear();
                 _reload.clear();
                 _cloneLocs.clear();
+                _cloneOrder.clear();
+                _cloneNext = 0;
             }
             _memoryUsed = 0;
 
@@ -434,6 +439,7 @@ namespace mongo {
                 if ( ! isLargeChunk ) {
                     scoped_spinlock lk( _trackerLocks );
                     _cloneLocs.insert( dl );
+                    _cloneOrder.push_back( dl ); // index scan order == shard key order
                 }
 
                 if ( ++recCount > maxRecsWhenFull ) {
@@ -487,20 +493,27 @@ namespace mongo {
                 {
                     Client::ReadContext ctx( _ns );
                     scoped_spinlock lk( _trackerLocks );
-                    set<DiskLoc>::iterator i = _cloneLocs.begin();
-                    for ( ; i!=_cloneLocs.end(); ++i ) {
+                    // stream in shard key order (see _cloneOrder) so the recipient's
+                    // shard key index sees nearly sequential inserts
+                    while ( _cloneNext < _cloneOrder.size() ) {
                         if (tracker.intervalHasElapsed()) // should I yield?
                             break;
-                        
-                        DiskLoc dl = *i;
-                        
+
+                        DiskLoc dl = _cloneOrder[_cloneNext];
+
+                        if ( _cloneLocs.count( dl ) == 0 ) {
+                            // deleted since the initial scan; aboutToDelete removed it
+                            _cloneNext++;
+                            continue;
+                        }
+
                         Record* r = dl.rec();
                         if ( ! r->likelyInPhysicalMemory() ) {
                             fileLock.reset( new LockMongoFilesShared() );
                             recordToTouch = r;
                             break;
                         }
-                        
+
                         BSONObj o = dl.obj();
 
                         // use the builder size instead of accumulating 'o's size so that we take into consideration
@@ -510,13 +523,13 @@ namespace mongo {
                             filledBuffer = true; // break out of outer while loop
                             break;
                         }
-                        
+
                         a.append( o );
+                        _cloneLocs.erase( dl );
+                        _cloneNext++;
                     }
-                    
-                    _cloneLocs.erase( _cloneLocs.begin() , i );
-                    
-                    if ( _cloneLocs.empty() || filledBuffer )
+
+                    if ( _cloneNext >= _cloneOrder.size() || filledBuffer )
                         break;
                 }
                 
@@ -613,6 +626,13 @@ namespace mongo {
         // updates applied by 1 thread in a write lock
         set<DiskLoc> _cloneLocs;
 
+        // all of the chunk's locs in shard key order (the order storeCurrentLocs scanned
+        // the shard key index).  clone() streams documents in this order so the recipient
+        // inserts into its shard key index nearly sequentially; _cloneLocs above remains
+        // the authority on what still needs to be sent.
+        vector<DiskLoc> _cloneOrder;
+        size_t _cloneNext; // next position in _cloneOrder to consider
+
         list<BSONObj> _reload; // objects that were modified that must be recloned
         list<BSONObj> _deleted; // objects deleted during clone that should be deleted later
         long long _memoryUsed; // bytes in _reload + _deleted
@@ -1472,6 +1492,114 @@ namespace mongo {
        commend to "commit"
     */
 
+    /**
+     * Pulls _migrateClone batches from the donor shard on a dedicated thread and
+     * connection, keeping up to two batches buffered so the next network round
+     * trip (and the donor-side reads behind it) overlap with applying the
+     * current batch locally.  Clone batches are disjoint sets of documents, so
+     * buffering them does not change apply semantics.
+     */
+    class MigrateCloneFetcher : boost::noncopyable {
+        static const size_t MaxBuffered = 2;
+    public:
+        MigrateCloneFetcher( const string& from )
+            : _from( from ),
+              _mutex( "MigrateCloneFetcher" ),
+              _stop( false ),
+              _done( false ),
+              _failed( false ),
+              _thread( boost::bind( &MigrateCloneFetcher::_run , this ) ) {
+        }
+
+        ~MigrateCloneFetcher() {
+            {
+                scoped_lock lk( _mutex );
+                _stop = true;
+                _notFull.notify_one();
+            }
+            _thread.join();
+        }
+
+        /**
+         * blocks for the next _migrateClone result.  as before, a result whose
+         * "objects" array is empty terminates the clone.  returns false if
+         * fetching failed, with the error text in *errmsg.
+         */
+        bool next( BSONObj* res , string* errmsg ) {
+            scoped_lock lk( _mutex );
+            while ( _batches.empty() && ! _done )
+                _notEmpty.wait( lk.boost() );
+            if ( ! _batches.empty() ) {
+                *res = _batches.front();
+                _batches.pop_front();
+                _notFull.notify_one();
+                return true;
+            }
+            verify( _failed );
+            *errmsg = _errmsg;
+            return false;
+        }
+
+    private:
+        void _run() {
+            Client::initThread( "migrateCloneFetcher" );
+            try {
+                ScopedDbConnection conn( _from );
+                while ( true ) {
+                    {
+                        scoped_lock lk( _mutex );
+                        while ( _batches.size() >= MaxBuffered && ! _stop )
+                            _notFull.wait( lk.boost() );
+                        if ( _stop )
+                            break;
+                    }
+
+                    BSONObj res;
+                    bool ok = conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res );
+
+                    scoped_lock lk( _mutex );
+                    if ( _stop )
+                        break;
+                    if ( ! ok ) {
+                        _failed = true;
+                        _errmsg = "_migrateClone failed: " + res.toString();
+                        _done = true;
+                        _notEmpty.notify_one();
+                        break;
+                    }
+                    _batches.push_back( res.getOwned() );
+                    if ( res["objects"].Obj().isEmpty() )
+                        _done = true; // terminating batch queued; nothing more to fetch
+                    _notEmpty.notify_one();
+                    if ( _done )
+                        break;
+                }
+                conn.done();
+            }
+            catch ( std::exception& e ) {
+                scoped_lock lk( _mutex );
+                _failed = true;
+                _errmsg = e.what();
+                _done = true;
+                _notEmpty.notify_one();
+            }
+            cc().shutdown();
+        }
+
+        const string _from;
+
+        mongo::mutex _mutex;
+        boost::condition _notEmpty;
+        boost::condition _notFull;
+        std::deque<BSONObj> _batches;
+        bool _stop;   // destructor wants the thread gone
+        bool _done;   // no more batches coming (terminator queued, or failure)
+        bool _failed;
+        string _errmsg;
+
+        boost::thread _thread; // last member: starts once the state above is ready
+    };
+
     class MigrateStatus {
     public:
         
@@ -1553,20 +1681,38 @@ namespace mongo {
                 }
             }
 
-            {                
+            // secondary indexes whose creation is postponed until after the bulk clone
+            vector<BSONObj> deferredIndexes;
+
+            {
                 // 1. copy indexes
-                
+
                 vector<BSONObj> all;
                 {
                     auto_ptr<DBClientCursor> indexes = conn->getIndexes( ns );
-                    
+
                     while ( indexes->more() ) {
                         all.push_back( indexes->next().getOwned() );
                     }
                 }
 
+                // when the collection is empty here (the common case when a chunk moves
+                // to a shard for the first time) only the _id index is created up front;
+                // the secondary indexes are bulk built after the clone phase instead of
+                // being maintained one random key at a time for every cloned document
+                bool deferSecondaryIndexes;
+                {
+                    Client::ReadContext ctx( ns );
+                    NamespaceDetails* d = nsdetails( ns );
+                    deferSecondaryIndexes = ( d == NULL || d->numRecords() == 0 );
+                }
+
                 for ( unsigned i=0; i<all.size(); i++ ) {
                     BSONObj idx = all[i];
+                    if ( deferSecondaryIndexes && idx["name"].str() != "_id_" ) {
+                        deferredIndexes.push_back( idx );
+                        continue;
+                    }
                     Client::WriteContext ct( ns );
                     string system_indexes = cc().database()->name() + ".system.indexes";
                     theDataFileMgr.insertAndLog( system_indexes.c_str(),
@@ -1624,12 +1770,15 @@ namespace mongo {
                 // 3. initial bulk clone
                 state = CLONE;
 
+                // batches (arrays of objects to copy, in shard key order) come off the
+                // fetcher's own thread and connection, so the next round trip to
+                // the donor overlaps with applying the current batch here
+                MigrateCloneFetcher fetcher( from );
+
                 while ( true ) {
                     BSONObj res;
-                    if ( ! conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res ) ) {  // gets array of objects to copy, in disk order
+                    if ( ! fetcher.next( &res , &errmsg ) ) {
                         state = FAIL;
-                        errmsg = "_migrateClone failed: ";
-                        errmsg += res.toString();
                         error() << errmsg << migrateLog;
                         conn.done();
                         return;
@@ -1684,6 +1833,19 @@ namespace mongo {
                         break;
                 }
 
+                // now that the data is here, create the secondary indexes deferred in
+                // step 1; with the documents in place they get a bottom-up bulk build,
+                // and it happens before we start taking ownership of the chunk
+                for ( unsigned i=0; i<deferredIndexes.size(); i++ ) {
+                    BSONObj idx = deferredIndexes[i];
+                    Client::WriteContext ct( ns );
+                    string system_indexes = cc().database()->name() + ".system.indexes";
+                    theDataFileMgr.insertAndLog( system_indexes.c_str(),
+                                                 idx,
+                                                 true, /* god mode */
+                                                 true /* flag fromMigrate in oplog */ );
+                }
+
                 timing.done(3);
             }
 
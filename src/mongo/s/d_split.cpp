@@ -30,6 +30,7 @@
 
 #include "mongo/pch.h"
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
@@ -41,6 +42,7 @@
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/privilege.h"
 #include "mongo/db/auth/authorization_manager.h"
+#include "mongo/db/btree.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/index_legacy.h"
@@ -200,6 +202,116 @@ namespace mongo {
         return key.replaceFieldNames(keyPattern).clientReadable();
     }
 
+    /**
+     * Appends, in key order, every used key stored in the top 'depth' levels of a v:1
+     * btree.  Buckets at one level are filled to similar occupancy, so for fanout f
+     * these keys land approximately every f^(levels below the cut) entries and can
+     * serve as quantile estimates without visiting the leaves, which hold the
+     * overwhelming majority of the buckets.
+     *
+     * @return false if a leaf is reached within 'depth' levels, i.e. the tree is too
+     * shallow to supply this many internal levels.
+     */
+    static bool collectSeparatorKeys( const DiskLoc& thisLoc, int depth, vector<BSONObj>* keys ) {
+        const BtreeBucket<V1>* bucket = thisLoc.btree<V1>();
+        if ( bucket->getNextChild().isNull() ) {
+            // leaf
+            return false;
+        }
+        const int n = bucket->getN();
+        if ( depth > 1 ) {
+            for ( int i = 0; i <= n; i++ ) {
+                const DiskLoc child = i == n ?
+                    bucket->getNextChild() :
+                    DiskLoc( bucket->keyNode( i ).prevChildBucket );
+                if ( child.isNull() || !collectSeparatorKeys( child, depth - 1, keys ) )
+                    return false;
+                if ( i < n && !bucket->k( i ).isUnused() )
+                    keys->push_back( bucket->keyNode( i ).key.toBson().getOwned() );
+            }
+        }
+        else {
+            for ( int i = 0; i < n; i++ ) {
+                if ( !bucket->k( i ).isUnused() )
+                    keys->push_back( bucket->keyNode( i ).key.toBson().getOwned() );
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Try to pick split points for [min, max) from the keys stored in the internal
+     * levels of the index btree rather than walking every entry.  Levels are added
+     * below the root until consecutive samples are expected to be at most
+     * keyCount / 4 entries apart, so each split point is placed from several nearby
+     * candidates.
+     *
+     * @return false if the tree runs out of internal levels first or the range holds
+     * too few samples; the caller should fall back to the exact scan, which is cheap
+     * in exactly those cases.
+     */
+    static bool pickSampledSplitPoints( const IndexDetails* idx,
+                                        const BSONObj& keyPattern,
+                                        const BSONObj& min,
+                                        const BSONObj& max,
+                                        long long recCount,
+                                        long long keyCount,
+                                        long long maxSplitPoints,
+                                        vector<BSONObj>* splitKeys ) {
+        if ( idx->version() != 1 )
+            return false;
+        if ( recCount <= 0 || keyCount <= 0 )
+            return false;
+
+        const long long kOversample = 4;
+
+        vector<BSONObj> inRange;
+        long long total = 0;
+        for ( int depth = 1; total * keyCount < recCount * kOversample; depth++ ) {
+            vector<BSONObj> samples;
+            if ( !collectSeparatorKeys( idx->head, depth, &samples ) )
+                return false;
+            total = samples.size();
+            inRange.clear();
+            for ( size_t i = 0; i < samples.size(); i++ ) {
+                if ( samples[i].woCompare( min, idx->keyPattern(), false ) >= 0 &&
+                     samples[i].woCompare( max, idx->keyPattern(), false ) < 0 ) {
+                    inRange.push_back( samples[i] );
+                }
+            }
+        }
+
+        if ( (long long)inRange.size() < kOversample ) {
+            // The range covers too little of the tree to estimate from.
+            return false;
+        }
+
+        // Samples sit roughly recCount / total entries apart, so taking every
+        // 'stride'-th one approximates a split point every keyCount entries.
+        const long long stride = std::max( 1LL, ( total * keyCount ) / recCount );
+
+        long long numChunks = 0;
+        for ( long long i = stride - 1; i < (long long)inRange.size(); i += stride ) {
+            BSONObj splitKey =
+                prettyKey( idx->keyPattern(), inRange[i] ).extractFields( keyPattern );
+
+            // Do not use this split key if it is the same used in the previous split point.
+            if ( !splitKeys->empty() && splitKey.woCompare( splitKeys->back() ) == 0 )
+                continue;
+
+            splitKeys->push_back( splitKey.getOwned() );
+            numChunks++;
+            LOG(4) << "picked a sampled split key: " << splitKey << endl;
+
+            if ( maxSplitPoints && ( numChunks >= maxSplitPoints ) ) {
+                log() << "max number of requested split points reached (" << numChunks
+                      << ") before the end of chunk " << min << " -->> " << max << endl;
+                break;
+            }
+        }
+        return true;
+    }
+
     class SplitVector : public Command {
     public:
         SplitVector() : Command( "splitVector" , false ) {}
@@ -351,102 +463,120 @@ namespace mongo {
                 }
                 
                 //
-                // 2. Traverse the index and add the keyCount-th key to the result vector. If that key
-                //    appeared in the vector before, we omit it. The invariant here is that all the
-                //    instances of a given key value live in the same chunk.
+                // 2. Pick the split points.  For a deep enough v:1 index we can sample the
+                //    keys stored in the btree's internal levels instead of walking every
+                //    entry; shallow trees (and forced median splits, which must count the
+                //    keys exactly) traverse the index and take every keyCount-th key.
                 //
-                
+
                 Timer timer;
-                long long currCount = 0;
-                long long numChunks = 0;
-                
-                auto_ptr<Runner> runner(InternalPlanner::indexScan(ns, d, d->idxNo(*idx), min, max,
-                    false, InternalPlanner::FORWARD));
 
-                BSONObj currKey;
-                Runner::RunnerState state = runner->getNext(&currKey, NULL);
-                if (Runner::RUNNER_ADVANCED != state) {
-                    errmsg = "can't open a cursor for splitting (desired range is possibly empty)";
-                    return false;
+                if ( !forceMedianSplit &&
+                     pickSampledSplitPoints( idx, keyPattern, min, max, recCount, keyCount,
+                                             maxSplitPoints, &splitKeys ) ) {
+                    LOG(1) << "split points for chunk " << ns << " " << min << " -->> " << max
+                           << " sampled from the index's internal levels; numSplits: "
+                           << splitKeys.size() << endl;
                 }
-                
-                // Use every 'keyCount'-th key as a split point. We add the initial key as a sentinel, to be removed
-                // at the end. If a key appears more times than entries allowed on a chunk, we issue a warning and
-                // split on the following key.
-                set<BSONObj> tooFrequentKeys;
-                splitKeys.push_back(prettyKey(idx->keyPattern(), currKey.getOwned()).extractFields( keyPattern ) );
-
-                runner->setYieldPolicy(Runner::YIELD_AUTO);
-                while ( 1 ) {
-                    while (Runner::RUNNER_ADVANCED == state) {
-                        currCount++;
-                        
-                        if ( currCount > keyCount && !forceMedianSplit ) {
-                            currKey = prettyKey(idx->keyPattern(), currKey.getOwned()).extractFields(keyPattern);
-                            // Do not use this split key if it is the same used in the previous split point.
-                            if ( currKey.woCompare( splitKeys.back() ) == 0 ) {
-                                tooFrequentKeys.insert( currKey.getOwned() );
+                else {
+                    //
+                    // 2.a Traverse the index and add the keyCount-th key to the result vector.
+                    //     If that key appeared in the vector before, we omit it. The invariant
+                    //     here is that all the instances of a given key value live in the same
+                    //     chunk.
+                    //
+
+                    long long currCount = 0;
+                    long long numChunks = 0;
+
+                    auto_ptr<Runner> runner(InternalPlanner::indexScan(ns, d, d->idxNo(*idx),
+                        min, max, false, InternalPlanner::FORWARD));
+
+                    BSONObj currKey;
+                    Runner::RunnerState state = runner->getNext(&currKey, NULL);
+                    if (Runner::RUNNER_ADVANCED != state) {
+                        errmsg = "can't open a cursor for splitting (desired range is possibly empty)";
+                        return false;
+                    }
+
+                    // Use every 'keyCount'-th key as a split point. We add the initial key as a sentinel, to be removed
+                    // at the end. If a key appears more times than entries allowed on a chunk, we issue a warning and
+                    // split on the following key.
+                    set<BSONObj> tooFrequentKeys;
+                    splitKeys.push_back(prettyKey(idx->keyPattern(), currKey.getOwned()).extractFields( keyPattern ) );
+
+                    runner->setYieldPolicy(Runner::YIELD_AUTO);
+                    while ( 1 ) {
+                        while (Runner::RUNNER_ADVANCED == state) {
+                            currCount++;
+
+                            if ( currCount > keyCount && !forceMedianSplit ) {
+                                currKey = prettyKey(idx->keyPattern(), currKey.getOwned()).extractFields(keyPattern);
+                                // Do not use this split key if it is the same used in the previous split point.
+                                if ( currKey.woCompare( splitKeys.back() ) == 0 ) {
+                                    tooFrequentKeys.insert( currKey.getOwned() );
+                                }
+                                else {
+                                    splitKeys.push_back( currKey.getOwned() );
+                                    currCount = 0;
+                                    numChunks++;
+                                    LOG(4) << "picked a split key: " << currKey << endl;
+                                }
                             }
-                            else {
-                                splitKeys.push_back( currKey.getOwned() );
-                                currCount = 0;
-                                numChunks++;
-                                LOG(4) << "picked a split key: " << currKey << endl;
+
+                            // Stop if we have enough split points.
+                            if ( maxSplitPoints && ( numChunks >= maxSplitPoints ) ) {
+                                log() << "max number of requested split points reached (" << numChunks
+                                      << ") before the end of chunk " << ns << " " << min << " -->> " << max
+                                      << endl;
+                                break;
                             }
+
+                            state = runner->getNext(&currKey, NULL);
                         }
 
-                        // Stop if we have enough split points.
-                        if ( maxSplitPoints && ( numChunks >= maxSplitPoints ) ) {
-                            log() << "max number of requested split points reached (" << numChunks
-                                  << ") before the end of chunk " << ns << " " << min << " -->> " << max
-                                  << endl;
+                        if ( ! forceMedianSplit )
                             break;
-                        }
 
+                        //
+                        // If we're forcing a split at the halfway point, then the first pass was just
+                        // to count the keys, and we still need a second pass.
+                        //
+
+                        forceMedianSplit = false;
+                        keyCount = currCount / 2;
+                        currCount = 0;
+                        log() << "splitVector doing another cycle because of force, keyCount now: " << keyCount << endl;
+
+                        runner.reset(InternalPlanner::indexScan(ns, d, d->idxNo(*idx), min, max,
+                            false, InternalPlanner::FORWARD));
+
+                        runner->setYieldPolicy(Runner::YIELD_AUTO);
                         state = runner->getNext(&currKey, NULL);
                     }
-                    
-                    if ( ! forceMedianSplit )
-                        break;
-                    
+
                     //
-                    // If we're forcing a split at the halfway point, then the first pass was just
-                    // to count the keys, and we still need a second pass.
+                    // 3. Format the result and issue any warnings about the data we gathered while traversing the
+                    //    index
                     //
 
-                    forceMedianSplit = false;
-                    keyCount = currCount / 2;
-                    currCount = 0;
-                    log() << "splitVector doing another cycle because of force, keyCount now: " << keyCount << endl;
-                    
-                    runner.reset(InternalPlanner::indexScan(ns, d, d->idxNo(*idx), min, max,
-                        false, InternalPlanner::FORWARD));
+                    // Warn for keys that are more numerous than maxChunkSize allows.
+                    for ( set<BSONObj>::const_iterator it = tooFrequentKeys.begin(); it != tooFrequentKeys.end(); ++it ) {
+                        warning() << "chunk is larger than " << maxChunkSize
+                                  << " bytes because of key " << prettyKey(idx->keyPattern(), *it ) << endl;
+                    }
 
-                    runner->setYieldPolicy(Runner::YIELD_AUTO);
-                    state = runner->getNext(&currKey, NULL);
-                }
+                    // Remove the sentinel at the beginning before returning
+                    splitKeys.erase( splitKeys.begin() );
 
-                //
-                // 3. Format the result and issue any warnings about the data we gathered while traversing the
-                //    index
-                //
-                
-                // Warn for keys that are more numerous than maxChunkSize allows.
-                for ( set<BSONObj>::const_iterator it = tooFrequentKeys.begin(); it != tooFrequentKeys.end(); ++it ) {
-                    warning() << "chunk is larger than " << maxChunkSize
-                              << " bytes because of key " << prettyKey(idx->keyPattern(), *it ) << endl;
-                }
-                
-                // Remove the sentinel at the beginning before returning
-                splitKeys.erase( splitKeys.begin() );
-                
-                if (timer.millis() > serverGlobalParams.slowMS) {
-                    warning() << "Finding the split vector for " <<  ns << " over "<< keyPattern
-                              << " keyCount: " << keyCount << " numSplits: " << splitKeys.size() 
-                              << " lookedAt: " << currCount << " took " << timer.millis() << "ms"
-                              << endl;
+                    if (timer.millis() > serverGlobalParams.slowMS) {
+                        warning() << "Finding the split vector for " <<  ns << " over "<< keyPattern
+                                  << " keyCount: " << keyCount << " numSplits: " << splitKeys.size()
+                                  << " lookedAt: " << currCount << " took " << timer.millis() << "ms"
+                                  << endl;
+                    }
                 }
-                
+
                 // Warning: we are sending back an array of keys but are currently limited to
                 // 4MB work of 'result' size. This should be okay for now.
 
@@ -586,7 +716,9 @@ namespace mongo {
             dist_lock_try dlk;
 
             try{
-            	dlk = dist_lock_try( &lockSetup, string("split-") + min.toString() );
+            	// Released as a lease, so back-to-back splits of a hot collection by this
+            	// shard re-enter the metadata lock without config server round trips.
+            	dlk = dist_lock_try( &lockSetup, string("split-") + min.toString(), 0.0, true /*asLease*/ );
             }
             catch( LockException& e ){
             	errmsg = str::stream() << "Error locking distributed lock for split." << causedBy( e );
@@ -66,7 +66,20 @@ namespace mongo {
 
     ShardingState::ShardingState()
         : _enabled(false) , _mutex( "ShardingState" ),
-          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ) {
+          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ),
+          _snapshot( new CollectionMetadataMap() ) {
+    }
+
+    void ShardingState::_publishMetadata() {
+        // build outside the spinlock; the published map is never modified again
+        MetadataSnapshot next( new CollectionMetadataMap( _collMetadata ) );
+        scoped_spinlock lk( _snapshotLock );
+        _snapshot.swap( next );
+    }
+
+    ShardingState::MetadataSnapshot ShardingState::_getSnapshot() const {
+        scoped_spinlock lk( _snapshotLock );
+        return _snapshot;
     }
 
     void ShardingState::enable( const string& server ) {
@@ -136,21 +149,22 @@ namespace mongo {
         _shardName.clear();
         _shardHost.clear();
         _collMetadata.clear();
+        _publishMetadata();
     }
 
     // TODO we shouldn't need three ways for checking the version. Fix this.
     bool ShardingState::hasVersion( const string& ns ) {
-        scoped_lock lk(_mutex);
+        MetadataSnapshot snapshot = _getSnapshot();
 
-        CollectionMetadataMap::const_iterator it = _collMetadata.find(ns);
-        return it != _collMetadata.end();
+        CollectionMetadataMap::const_iterator it = snapshot->find(ns);
+        return it != snapshot->end();
     }
 
     bool ShardingState::hasVersion( const string& ns , ChunkVersion& version ) {
-        scoped_lock lk(_mutex);
+        MetadataSnapshot snapshot = _getSnapshot();
 
-        CollectionMetadataMap::const_iterator it = _collMetadata.find(ns);
-        if ( it == _collMetadata.end() )
+        CollectionMetadataMap::const_iterator it = snapshot->find(ns);
+        if ( it == snapshot->end() )
             return false;
 
         CollectionMetadataPtr p = it->second;
@@ -159,10 +173,10 @@ namespace mongo {
     }
 
     const ChunkVersion ShardingState::getVersion( const string& ns ) const {
-        scoped_lock lk(_mutex);
+        MetadataSnapshot snapshot = _getSnapshot();
 
-        CollectionMetadataMap::const_iterator it = _collMetadata.find( ns );
-        if ( it != _collMetadata.end() ) {
+        CollectionMetadataMap::const_iterator it = snapshot->find( ns );
+        if ( it != snapshot->end() ) {
             CollectionMetadataPtr p = it->second;
             return p->getShardVersion();
         }
@@ -195,6 +209,7 @@ namespace mongo {
         // TODO: a bit dangerous to have two different zero-version states - no-metadata and
         // no-version
         _collMetadata[ns] = cloned;
+        _publishMetadata();
     }
 
     void ShardingState::undoDonateChunk( const string& ns, CollectionMetadataPtr prevMetadata ) {
@@ -204,6 +219,7 @@ namespace mongo {
         CollectionMetadataMap::iterator it = _collMetadata.find( ns );
         verify( it != _collMetadata.end() );
         it->second = prevMetadata;
+        _publishMetadata();
     }
 
     bool ShardingState::notePending( const string& ns,
@@ -245,6 +261,7 @@ namespace mongo {
         if ( !cloned ) return false;
 
         _collMetadata[ns] = cloned;
+        _publishMetadata();
         return true;
     }
 
@@ -287,6 +304,7 @@ namespace mongo {
         if ( !cloned ) return false;
 
         _collMetadata[ns] = cloned;
+        _publishMetadata();
         return true;
     }
 
@@ -311,6 +329,7 @@ namespace mongo {
         uassert( 16857, errMsg, NULL != cloned.get() );
 
         _collMetadata[ns] = cloned;
+        _publishMetadata();
     }
 
     void ShardingState::mergeChunks( const string& ns,
@@ -333,6 +352,7 @@ namespace mongo {
         uassert( 17004, errMsg, NULL != cloned.get() );
 
         _collMetadata[ns] = cloned;
+        _publishMetadata();
     }
 
     void ShardingState::resetMetadata( const string& ns ) {
@@ -342,6 +362,7 @@ namespace mongo {
                   << endl;
 
         _collMetadata.erase( ns );
+        _publishMetadata();
     }
 
     Status ShardingState::refreshMetadataIfNeeded( const string& ns,
@@ -586,6 +607,9 @@ namespace mongo {
 
                 *latestShardVersion = remoteShardVersion;
             }
+
+            if ( installType != InstallType_None )
+                _publishMetadata();
         }
         // End _mutex
         // End DBWrite
@@ -676,10 +700,10 @@ namespace mongo {
     }
 
     CollectionMetadataPtr ShardingState::getCollectionMetadata( const string& ns ) {
-        scoped_lock lk( _mutex );
+        MetadataSnapshot snapshot = _getSnapshot();
 
-        CollectionMetadataMap::const_iterator it = _collMetadata.find( ns );
-        if ( it == _collMetadata.end() ) {
+        CollectionMetadataMap::const_iterator it = snapshot->find( ns );
+        if ( it == snapshot->end() ) {
             return CollectionMetadataPtr();
         }
         else {
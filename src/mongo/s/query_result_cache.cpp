@@ -0,0 +1,201 @@
+// query_result_cache.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/s/query_result_cache.h"
+
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    // Comma separated list of full namespaces whose query replies may be cached.
+    // Empty (the default) disables the cache entirely.
+    MONGO_EXPORT_SERVER_PARAMETER( queryResultCacheNamespaces, string, "" );
+
+    // How long a cached reply may be served, in milliseconds.  Writes through other
+    // mongos processes are invisible to this cache, so keep this short.
+    MONGO_EXPORT_SERVER_PARAMETER( queryResultCacheTTLMillis, int, 100 );
+
+    // Total budget for cached reply bytes before the oldest entries are evicted.
+    MONGO_EXPORT_SERVER_PARAMETER( queryResultCacheMaxSizeBytes, long long, 64 * 1024 * 1024 );
+
+    QueryResultCache queryResultCache;
+
+    QueryResultCache::QueryResultCache()
+        : _mutex( "QueryResultCache" ),
+          _totalBytes( 0 ),
+          _hits( 0 ),
+          _misses( 0 ) {
+    }
+
+    bool QueryResultCache::isEnabled( const string& ns ) {
+        scoped_lock lk( _mutex );
+        _refreshNamespaces_inlock();
+        return _namespaces.count( ns ) > 0;
+    }
+
+    void QueryResultCache::_refreshNamespaces_inlock() {
+        string param = queryResultCacheNamespaces;
+        if ( param == _parsedNamespaceParam )
+            return;
+        _namespaces.clear();
+        size_t start = 0;
+        while ( start < param.size() ) {
+            size_t comma = param.find( ',', start );
+            if ( comma == string::npos )
+                comma = param.size();
+            string ns = param.substr( start, comma - start );
+            if ( !ns.empty() )
+                _namespaces.insert( ns );
+            start = comma + 1;
+        }
+        _parsedNamespaceParam = param;
+        // The namespace list changed, so cached replies may be for namespaces that are no
+        // longer opted in.  Start over.
+        _entries.clear();
+        _insertOrder.clear();
+        _totalBytes = 0;
+    }
+
+    string QueryResultCache::makeKey( const QuerySpec& qSpec ) {
+        if ( qSpec.isExplain() )
+            return "";
+        if ( qSpec.ntoskip() != 0 )
+            return "";
+        if ( qSpec.options() & ( QueryOption_CursorTailable | QueryOption_Exhaust |
+                                 QueryOption_OplogReplay ) )
+            return "";
+
+        // The raw query object covers the filter, sort, hint and any $readPreference, so
+        // replies are shared only between byte-identical requests.
+        StringBuilder key;
+        key << qSpec.ns() << '\0' << qSpec.ntoreturn() << '\0' << qSpec.options() << '\0';
+        key.append( StringData( qSpec.query().objdata(), qSpec.query().objsize() ) );
+        key.append( StringData( qSpec.fields().objdata(), qSpec.fields().objsize() ) );
+        return key.str();
+    }
+
+    bool QueryResultCache::get( const string& key, string* dataHolder, int* docCount ) {
+        scoped_lock lk( _mutex );
+
+        map<string,Entry>::iterator it = _entries.find( key );
+        if ( it == _entries.end() ) {
+            _misses++;
+            return false;
+        }
+        if ( it->second.expiresAt <= curTimeMillis64() ) {
+            _erase_inlock( it );
+            _misses++;
+            return false;
+        }
+        *dataHolder = it->second.data;
+        *docCount = it->second.docCount;
+        _hits++;
+        return true;
+    }
+
+    void QueryResultCache::put( const string& key, const string& ns,
+                                const char* data, int dataLen, int docCount ) {
+        scoped_lock lk( _mutex );
+
+        map<string,Entry>::iterator it = _entries.find( key );
+        if ( it != _entries.end() )
+            _erase_inlock( it );
+
+        Entry& entry = _entries[ key ];
+        entry.ns = ns;
+        entry.data.assign( data, dataLen );
+        entry.docCount = docCount;
+        entry.expiresAt = curTimeMillis64() + queryResultCacheTTLMillis;
+        _insertOrder.push_back( key );
+        _totalBytes += dataLen;
+
+        _enforceBudget_inlock();
+    }
+
+    void QueryResultCache::invalidate( const string& ns ) {
+        scoped_lock lk( _mutex );
+        if ( _entries.empty() )
+            return;
+        for ( map<string,Entry>::iterator it = _entries.begin(); it != _entries.end(); ) {
+            if ( it->second.ns == ns ) {
+                map<string,Entry>::iterator toErase = it++;
+                _erase_inlock( toErase );
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    void QueryResultCache::_erase_inlock( map<string,Entry>::iterator it ) {
+        _totalBytes -= it->second.data.size();
+        for ( list<string>::iterator i = _insertOrder.begin(); i != _insertOrder.end(); ++i ) {
+            if ( *i == it->first ) {
+                _insertOrder.erase( i );
+                break;
+            }
+        }
+        _entries.erase( it );
+    }
+
+    void QueryResultCache::_enforceBudget_inlock() {
+        unsigned long long now = curTimeMillis64();
+        while ( _totalBytes > queryResultCacheMaxSizeBytes && !_insertOrder.empty() ) {
+            // Prefer evicting expired entries, then the oldest; with a short TTL the two
+            // orders are nearly the same.
+            map<string,Entry>::iterator it = _entries.find( _insertOrder.front() );
+            if ( it != _entries.end() && it->second.expiresAt > now &&
+                 _insertOrder.size() == 1 ) {
+                // Don't evict the entry we just inserted.
+                break;
+            }
+            if ( it != _entries.end() ) {
+                _totalBytes -= it->second.data.size();
+                _entries.erase( it );
+            }
+            _insertOrder.pop_front();
+        }
+    }
+
+    void QueryResultCache::appendInfo( BSONObjBuilder& result ) const {
+        scoped_lock lk( _mutex );
+        BSONObjBuilder bb( result.subobjStart( "queryResultCache" ) );
+        bb.appendNumber( "entries", (long long) _entries.size() );
+        bb.appendNumber( "totalBytes", _totalBytes );
+        bb.appendNumber( "hits", _hits );
+        bb.appendNumber( "misses", _misses );
+        bb.done();
+    }
+
+}
@@ -0,0 +1,124 @@
+// query_result_cache.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#pragma once
+
+#include "mongo/pch.h"
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+
+namespace mongo {
+
+    class QuerySpec;
+
+    /**
+     * Opt-in read-through cache of complete query replies in mongos, for read mixes that
+     * repeat identical point lookups.  Keyed by the exact query message (ns, query
+     * including any read preference, projection, ntoreturn, wire options), so two queries
+     * share an entry only if every shard-visible detail matches.
+     *
+     * Entries are bounded by a short TTL and a total size budget, and all entries for a
+     * namespace are invalidated when a write to it is routed through this mongos.  Writes
+     * through other mongos processes are only bounded by the TTL, so the cache must stay
+     * opt-in and the TTL short.
+     *
+     * Enabled per namespace via the queryResultCacheNamespaces server parameter (comma
+     * separated full namespaces); tuned by queryResultCacheTTLMillis and
+     * queryResultCacheMaxSizeBytes.
+     */
+    class QueryResultCache {
+    public:
+
+        QueryResultCache();
+
+        /** @return true if caching is enabled for 'ns' */
+        bool isEnabled( const string& ns );
+
+        /**
+         * @return the cache key for 'qSpec', or the empty string if the query is not
+         * cacheable (explains, skips, tailable or exhaust cursors).
+         */
+        static string makeKey( const QuerySpec& qSpec );
+
+        /**
+         * Looks up an unexpired cached reply.
+         * @param data - set to the raw reply documents, valid only for hits
+         * @param dataLen - length of 'data' in bytes
+         * @param docCount - number of documents in 'data'
+         * @return true on a hit; the out parameters are copies owned by the caller's
+         * 'dataHolder'
+         */
+        bool get( const string& key, string* dataHolder, int* docCount );
+
+        /** Caches a complete single-batch reply for 'ns'. */
+        void put( const string& key, const string& ns,
+                  const char* data, int dataLen, int docCount );
+
+        /** Drops all entries for 'ns'.  Called when a write to 'ns' is seen. */
+        void invalidate( const string& ns );
+
+        void appendInfo( BSONObjBuilder& result ) const;
+
+    private:
+
+        struct Entry {
+            string ns;
+            string data; // raw reply documents
+            int docCount;
+            unsigned long long expiresAt; // millis
+        };
+
+        /** Re-parses the namespace list parameter if it changed.  Caller must hold _mutex. */
+        void _refreshNamespaces_inlock();
+
+        /** Removes 'it' from the map and size accounting.  Caller must hold _mutex. */
+        void _erase_inlock( map<string,Entry>::iterator it );
+
+        /** Evicts expired, then oldest, entries until under budget.  Caller must hold _mutex. */
+        void _enforceBudget_inlock();
+
+        mutable mongo::mutex _mutex;
+        map<string,Entry> _entries;
+        list<string> _insertOrder; // keys oldest first, for eviction
+        long long _totalBytes;
+
+        string _parsedNamespaceParam; // value of the parameter _namespaces was parsed from
+        set<string> _namespaces;
+
+        long long _hits;
+        long long _misses;
+    };
+
+    extern QueryResultCache queryResultCache;
+
+}
@@ -0,0 +1,205 @@
+//@file routing_cache.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/s/routing_cache.h"
+
+#include <fstream>
+#include <vector>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    // Path of the local routing metadata snapshot file.  Empty (the default) disables
+    // the cache; each mongos needs its own file.
+    MONGO_EXPORT_SERVER_PARAMETER( routingCacheFile, string, "" );
+
+    RoutingMetadataCache routingMetadataCache;
+
+    namespace {
+        // Registers with PeriodicTask's runner (started in mongos' start()).
+        RoutingMetadataCache::Saver routingCacheSaver;
+    }
+
+    void RoutingMetadataCache::Saver::taskDoWork() {
+        routingMetadataCache.save();
+    }
+
+    RoutingMetadataCache::RoutingMetadataCache()
+        : _mutex( "RoutingMetadataCache" ),
+          _savedSequenceSum( 0 ) {
+    }
+
+    bool RoutingMetadataCache::enabled() const {
+        return ! routingCacheFile.empty();
+    }
+
+    void RoutingMetadataCache::loadAtStartup() {
+        if ( ! enabled() )
+            return;
+
+        const string path = routingCacheFile;
+        Timer t;
+
+        std::ifstream file( path.c_str(), std::ios::in | std::ios::binary );
+        if ( ! file.is_open() ) {
+            log() << "routing cache file " << path << " not found, starting cold" << endl;
+            return;
+        }
+
+        std::vector<char> data( ( std::istreambuf_iterator<char>( file ) ),
+                                std::istreambuf_iterator<char>() );
+        file.close();
+
+        int numSeeds = 0;
+        const char* p = data.empty() ? NULL : &data[0];
+        const char* end = p + data.size();
+
+        while ( p && p + 4 <= end ) {
+            BSONObj doc( p );
+            if ( doc.objsize() < 5 || p + doc.objsize() > end ) {
+                warning() << "routing cache file " << path << " is truncated or corrupt, "
+                          << "ignoring the rest" << endl;
+                break;
+            }
+            p += doc.objsize();
+
+            ChunkManager* seed = NULL;
+            try {
+                seed = ChunkManager::fromSnapshot( doc );
+            }
+            catch ( const std::exception& e ) {
+                warning() << "could not use routing cache snapshot for "
+                          << doc["ns"].toString() << causedBy( e ) << endl;
+            }
+            if ( ! seed )
+                continue;
+
+            scoped_lock lk( _mutex );
+            _seeds[ seed->getns() ] = ChunkManagerPtr( seed );
+            numSeeds++;
+        }
+
+        log() << "loaded " << numSeeds << " routing cache snapshot(s) from " << path
+              << " in " << t.millis() << "ms" << endl;
+    }
+
+    ChunkManagerPtr RoutingMetadataCache::takeSeed( const string& ns, const OID& currentEpoch ) {
+        if ( ! enabled() )
+            return ChunkManagerPtr();
+
+        scoped_lock lk( _mutex );
+
+        map<string, ChunkManagerPtr>::iterator it = _seeds.find( ns );
+        if ( it == _seeds.end() )
+            return ChunkManagerPtr();
+
+        ChunkManagerPtr seed = it->second;
+        _seeds.erase( it );
+
+        if ( ! seed->getVersion().hasCompatibleEpoch( currentEpoch ) ) {
+            LOG(1) << "routing cache snapshot for " << ns << " is from another epoch, "
+                   << "loading cold" << endl;
+            return ChunkManagerPtr();
+        }
+
+        LOG(1) << "seeding load of " << ns << " from routing cache snapshot w/ version "
+               << seed->getVersion() << " and " << seed->numChunks() << " chunks" << endl;
+        return seed;
+    }
+
+    void RoutingMetadataCache::noteManager( ChunkManagerPtr manager ) {
+        if ( ! enabled() )
+            return;
+        scoped_lock lk( _mutex );
+        _current[ manager->getns() ] = manager;
+    }
+
+    void RoutingMetadataCache::save() {
+        if ( ! enabled() )
+            return;
+
+        const string path = routingCacheFile;
+
+        vector<ChunkManagerPtr> managers;
+        {
+            scoped_lock lk( _mutex );
+
+            unsigned long long sequenceSum = 0;
+            for ( map<string, ChunkManagerPtr>::const_iterator it = _current.begin();
+                  it != _current.end(); ++it ) {
+                sequenceSum += it->second->getSequenceNumber();
+                managers.push_back( it->second );
+            }
+
+            if ( sequenceSum == _savedSequenceSum )
+                return; // nothing reloaded since the last save
+            _savedSequenceSum = sequenceSum;
+        }
+
+        try {
+            Timer t;
+            const string tempPath = path + ".tmp";
+
+            {
+                std::ofstream file( tempPath.c_str(),
+                                    std::ios::out | std::ios::binary | std::ios::trunc );
+                uassert( 17547, str::stream() << "could not open routing cache temp file "
+                                              << tempPath, file.is_open() );
+
+                for ( vector<ChunkManagerPtr>::const_iterator it = managers.begin();
+                      it != managers.end(); ++it ) {
+                    BSONObjBuilder b;
+                    (*it)->serializeSnapshot( b );
+                    BSONObj doc = b.obj();
+                    file.write( doc.objdata(), doc.objsize() );
+                }
+
+                file.flush();
+                uassert( 17548, str::stream() << "error writing routing cache temp file "
+                                              << tempPath, file.good() );
+            }
+
+            boost::filesystem::rename( tempPath, path );
+
+            LOG(1) << "saved " << managers.size() << " routing cache snapshot(s) to "
+                   << path << " in " << t.millis() << "ms" << endl;
+        }
+        catch ( const std::exception& e ) {
+            warning() << "could not save routing cache to " << path << causedBy( e ) << endl;
+        }
+    }
+
+}  // namespace mongo
@@ -0,0 +1,108 @@
+//@file routing_cache.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#pragma once
+
+#include "mongo/pch.h"
+
+#include <map>
+#include <string>
+
+#include "mongo/s/chunk.h"
+#include "mongo/util/background.h"
+
+namespace mongo {
+
+    /**
+     * Local disk cache of this mongos' routing metadata, so a restart does not have to
+     * reload every chunk of every collection from the config servers.
+     *
+     * ChunkManager snapshots (shard key, version, all chunks) are written to the file
+     * named by the routingCacheFile server parameter, periodically and at clean shutdown.
+     * At boot the snapshots are read back and each one seeds the first load of its
+     * collection as if it were the previously cached manager, so the existing
+     * differential loader only fetches chunks newer than the snapshot -- one version
+     * check per collection when nothing moved, instead of a full chunk scan.
+     *
+     * Snapshots are advisory only: a seed is dropped unless its collection epoch matches
+     * the config servers' current epoch, and the differential load validates everything
+     * else, so a stale or corrupt file costs us nothing but the cold load we would have
+     * done anyway.  Disabled unless routingCacheFile is set.
+     */
+    class RoutingMetadataCache {
+    public:
+
+        RoutingMetadataCache();
+
+        /** @return true if routingCacheFile is set */
+        bool enabled() const;
+
+        /** Reads the snapshot file, if any.  Called once at startup before routing begins. */
+        void loadAtStartup();
+
+        /**
+         * Hands out (at most once) the boot-time seed manager for 'ns', or an empty
+         * pointer if there is none or its epoch does not match 'currentEpoch'.
+         */
+        ChunkManagerPtr takeSeed( const string& ns, const OID& currentEpoch );
+
+        /** Remembers the latest loaded manager for 'ns' for the next save(). */
+        void noteManager( ChunkManagerPtr manager );
+
+        /**
+         * Writes a snapshot of all remembered managers, temp file + rename.  Cheap no-op
+         * when nothing was reloaded since the last save.  Never throws.
+         */
+        void save();
+
+    private:
+
+        /** Periodically persists the cache in the background. */
+        class Saver : public PeriodicTask {
+        public:
+            virtual void taskDoWork();
+            virtual string taskName() const { return "RoutingMetadataCacheSaver"; }
+        };
+
+        mutable mongo::mutex _mutex;
+
+        // seeds read from disk at startup, consumed on first load of each collection
+        map<string, ChunkManagerPtr> _seeds;
+
+        // latest loaded manager per collection, written out by save()
+        map<string, ChunkManagerPtr> _current;
+
+        // sum of the sequence numbers of _current at the last save, to skip no-op saves
+        unsigned long long _savedSequenceSum;
+    };
+
+    extern RoutingMetadataCache routingMetadataCache;
+
+}  // namespace mongo
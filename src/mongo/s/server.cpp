@@ -48,6 +48,7 @@
 #include "mongo/db/log_process_details.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/s/balance.h"
+#include "mongo/s/changelog_watcher.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/client_info.h"
 #include "mongo/s/config.h"
@@ -57,10 +58,12 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/mongos_options.h"
 #include "mongo/s/request.h"
+#include "mongo/s/routing_cache.h"
 #include "mongo/s/version_mongos.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/util/admin_access.h"
 #include "mongo/util/cmdline_utils/censor_cmdline.h"
+#include "mongo/util/coarse_ticker.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/exception_filter_win32.h"
@@ -246,13 +249,16 @@ namespace mongo {
     }
 
     void start( const MessageServer::Options& opts ) {
+        routingMetadataCache.loadAtStartup();
         balancer.go();
+        changelogWatcher.go();
         cursorCache.startTimeoutThread();
         PeriodicTask::theRunner->go();
 
         ShardedMessageHandler handler;
         MessageServer * server = createServer( opts , &handler );
         server->setAsTimeTracker();
+        startCoarseTicker();
         server->setupSockets();
         server->run();
     }
@@ -505,6 +511,10 @@ void mongo::dbexit( ExitCode rc, const char *why ) {
           << " rc:" << rc
           << " " << ( why ? why : "" )
           << endl;
+
+    // Best-effort persist of routing metadata so the next boot starts warm.
+    routingMetadataCache.save();
+
     flushForGcov();
     ::_exit(rc);
 }
@@ -487,7 +487,12 @@ namespace mongo {
         }
     }
 
-    bool ShardConnection::releaseConnectionsAfterResponse( false );
+    // When true (the default), a mongos worker thread returns its checked-in shard
+    // connections to the shared pool after answering each read, so the number of backend
+    // connections scales with concurrent operations rather than with connected clients
+    // times shards.  Connections pinned by open cursors or pending getLastError are not
+    // affected.  Set to false to restore the old keep-per-thread behavior.
+    bool ShardConnection::releaseConnectionsAfterResponse( true );
 
     ExportedServerParameter<bool> ReleaseConnectionsAfterResponse(
         ServerParameterSet::getGlobal(),
@@ -102,7 +102,8 @@ namespace mongo {
         }
         else {
             BufBuilder buf (obj.objsize());
-            buf.appendNum((unsigned)0); // refcount
+            buf.skip(BSONObj::Holder::HeaderSize); // refcount and field-index slot
+            memset(buf.buf(), 0, BSONObj::Holder::HeaderSize);
             buf.appendNum(obj.objsize());
 
             vector<pair<const char*, size_t> > copies;
@@ -46,6 +46,7 @@
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/cursors.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/query_result_cache.h"
 #include "mongo/s/request.h"
 #include "mongo/s/version_manager.h"
 #include "mongo/util/mongoutils/str.h"
@@ -79,9 +80,7 @@ namespace mongo {
             if ( q.ntoreturn == 1 && strstr(q.ns, ".$cmd") )
                 throw UserException( 8010 , "something is wrong, shouldn't see a command here" );
 
-            QuerySpec qSpec( (string)q.ns, q.query, q.fields, q.ntoskip, q.ntoreturn, q.queryOptions );
-
-            if ( _isSystemIndexes( q.ns ) && q.query["ns"].type() == String && r.getConfig()->isSharded( q.query["ns"].String() ) ) {
+            if ( _isSystemIndexes( q.ns )&& q.query["ns"].type() == String && r.getConfig()->isSharded( q.query["ns"].String() ) ) {
                 // if you are querying on system.indexes, we need to make sure we go to a shard that actually has chunks
                 // this is not a perfect solution (what if you just look at all indexes)
                 // but better than doing nothing
@@ -100,6 +99,35 @@ namespace mongo {
                 return;
             }
             
+            // Read-through result cache for opted-in namespaces: serve byte-identical
+            // repeated queries straight from the routing thread, no backend round trips.
+            string cacheKey;
+            if ( queryResultCache.isEnabled( q.ns ) ) {
+                // key on the query exactly as the client sent it -- the cluster
+                // opid stamped below is unique per operation and would defeat
+                // byte-identical matching
+                cacheKey = QueryResultCache::makeKey( QuerySpec( (string)q.ns, q.query, q.fields,
+                                                                 q.ntoskip, q.ntoreturn,
+                                                                 q.queryOptions ) );
+                if ( !cacheKey.empty() ) {
+                    string cachedData;
+                    int cachedDocCount;
+                    if ( queryResultCache.get( cacheKey, &cachedData, &cachedDocCount ) ) {
+                        replyToQuery( 0, r.p(), r.m(), cachedData.data(), cachedData.size(),
+                                      cachedDocCount, 0, 0 );
+                        return;
+                    }
+                }
+            }
+
+            // Stamp this operation's cluster opid into the forwarded query as a top
+            // level option.  mongod ignores query options it doesn't recognize and
+            // currentOp exposes the raw query, so each shard's inprog entries carry
+            // the id without any shard-side support (see handleSpecialNamespaces).
+            QuerySpec qSpec( (string)q.ns,
+                             ClientInfo::get()->stampClusterOpId( q.query ),
+                             q.fields, q.ntoskip, q.ntoreturn, q.queryOptions );
+
             ParallelSortClusteredCursor * cursor = new ParallelSortClusteredCursor( qSpec, CommandInfo() );
             verify( cursor );
 
@@ -139,6 +167,11 @@ namespace mongo {
                     LOG(5) << "storing cursor : " << cc->getId() << endl;
                     cursorCache.store( cc );
                 }
+                else if ( !cacheKey.empty() && startFrom == 0 ) {
+                    // Complete single batch reply, safe to serve again until invalidated.
+                    queryResultCache.put( cacheKey, q.ns, buffer.buf(), buffer.len(),
+                                          docCount );
+                }
 
                 replyToQuery( 0, r.p(), r.m(), buffer.buf(), buffer.len(), docCount,
                         startFrom, hasMore ? cc->getId() : 0 );
@@ -156,6 +189,19 @@ namespace mongo {
                 // Implicitly stores the cursor in the cache
                 r.reply( *(shardCursor->getMessage()) , shardCursor->originalHost() );
 
+                if ( !cacheKey.empty() ) {
+                    // Cache the raw shard reply if it was a complete single batch.
+                    QueryResult* qr = (QueryResult*) shardCursor->getMessage()->singleData();
+                    const int badFlags = ResultFlag_CursorNotFound | ResultFlag_ErrSet |
+                                         ResultFlag_ShardConfigStale;
+                    if ( qr->cursorId == 0 && qr->startingFrom == 0 &&
+                         ( qr->resultFlags() & badFlags ) == 0 ) {
+                        queryResultCache.put( cacheKey, q.ns, qr->data(),
+                                              qr->len - (int)( qr->data() - (char*)qr ),
+                                              qr->nReturned );
+                    }
+                }
+
                 // We don't want to kill the cursor remotely if there's still data left
                 shardCursor->decouple();
             }
@@ -1308,6 +1354,9 @@ namespace mongo {
 
                 LOG(3) << "write: " << ns << endl;
 
+                // Cached replies for this namespace are stale as soon as a write is routed.
+                queryResultCache.invalidate( ns );
+
                 DbMessage& d = r.d();
 
                 if ( op == dbInsert ) {
@@ -164,7 +164,8 @@ namespace mongo {
                         while ( i.more() ) {
                             BSONObjBuilder x;
 
-                            BSONObjIterator j( i.next().Obj() );
+                            BSONObj entry = i.next().Obj();
+                            BSONObjIterator j( entry );
                             while( j.more() ) {
                                 BSONElement e = j.next();
                                 if ( str::equals( e.fieldName() , "opid" ) ) {
@@ -179,6 +180,15 @@ namespace mongo {
                                     x.append( e );
                                 }
                             }
+
+                            // surface the mongos assigned opid (stamped into the query
+                            // by ShardStrategy::queryOp) as a top level field, so
+                            // entries from different shards that belong to the same
+                            // mongos operation can be joined up
+                            BSONElement cid = entry.getFieldDotted( "query.$clusterOpId" );
+                            if ( cid.type() == String )
+                                x.append( "clusterOpId" , cid.String() );
+
                             arr.append( x.obj() );
                         }
                     }
@@ -208,6 +218,35 @@ namespace mongo {
                     if ( i == string::npos ) {
                         b.append( "err" , "bad opid" );
                     }
+                    else if ( s.rfind( ':' ) != i ) {
+                        // two colons: this is a cluster opid ("<mongos>:<port>:<n>")
+                        // rather than a "<shard>:<opid>" pair.  ask every shard
+                        // which of its current ops carry this id, then kill those.
+                        const string inprogNS = string( r.getns() , ns - r.getns() ) + "inprog";
+                        Shard::getAllShards( shards );
+
+                        BSONArrayBuilder killed( b.subarrayStart( "killed" ) );
+                        for ( unsigned k=0; k<shards.size(); k++ ) {
+                            ScopedDbConnection conn(shards[k].getConnString());
+                            BSONObj temp = conn->findOne( inprogNS ,
+                                                          BSON( "query.$clusterOpId" << s ) );
+                            if ( temp["inprog"].isABSONObj() ) {
+                                BSONObjIterator it( temp["inprog"].Obj() );
+                                while ( it.more() ) {
+                                    int opid = it.next().Obj()["opid"].numberInt();
+                                    log() << "cluster killop " << s << " : killing op "
+                                          << opid << " on " << shards[k].getName() << endl;
+                                    conn->findOne( r.getns() , BSON( "op" << opid ) );
+
+                                    stringstream ss;
+                                    ss << shards[k].getName() << ':' << opid;
+                                    killed.append( ss.str() );
+                                }
+                            }
+                            conn.done();
+                        }
+                        killed.done();
+                    }
                     else {
                         string shard = s.substr( 0 , i );
                         int opid = atoi( s.substr( i + 1 ).c_str() );
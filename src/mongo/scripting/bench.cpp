@@ -56,6 +56,71 @@ namespace {
 
 namespace mongo {
 
+    BenchRunLatencyHistogram::BenchRunLatencyHistogram() {
+        reset();
+    }
+
+    void BenchRunLatencyHistogram::reset() {
+        _numEntries = 0;
+        _maxMicros = 0;
+        memset(_buckets, 0, sizeof(_buckets));
+    }
+
+    int BenchRunLatencyHistogram::bucketFor(unsigned long long timeMicros) {
+        if (timeMicros < kSubBuckets)
+            return static_cast<int>(timeMicros);  // exact below one sub-bucket's worth
+        int log2 = 0;
+        for (unsigned long long v = timeMicros; v > 1; v >>= 1)
+            ++log2;
+        const int shift = log2 - kSubBucketBits;
+        const int block = log2 - kSubBucketBits + 1;
+        return (block << kSubBucketBits) +
+            static_cast<int>((timeMicros >> shift) & (kSubBuckets - 1));
+    }
+
+    unsigned long long BenchRunLatencyHistogram::bucketUpperEdge(int bucket) {
+        if (bucket < kSubBuckets)
+            return bucket;
+        const int block = bucket >> kSubBucketBits;
+        const int sub = bucket & (kSubBuckets - 1);
+        const int shift = block - 1;
+        return (static_cast<unsigned long long>(kSubBuckets + sub) << shift) +
+            ((1ULL << shift) - 1);
+    }
+
+    void BenchRunLatencyHistogram::addEntry(unsigned long long timeMicros) {
+        ++_numEntries;
+        if (timeMicros > _maxMicros)
+            _maxMicros = timeMicros;
+        ++_buckets[bucketFor(timeMicros)];
+    }
+
+    void BenchRunLatencyHistogram::mergeFrom(const BenchRunLatencyHistogram &other) {
+        _numEntries += other._numEntries;
+        if (other._maxMicros > _maxMicros)
+            _maxMicros = other._maxMicros;
+        for (int i = 0; i < kNumBuckets; ++i)
+            _buckets[i] += other._buckets[i];
+    }
+
+    double BenchRunLatencyHistogram::getPercentileMicros(double p) const {
+        if (_numEntries == 0)
+            return 0;
+        unsigned long long target =
+            static_cast<unsigned long long>(p / 100.0 * _numEntries + 0.5);
+        if (target < 1)
+            target = 1;
+        if (target > _numEntries)
+            target = _numEntries;
+        unsigned long long seen = 0;
+        for (int i = 0; i < kNumBuckets; ++i) {
+            seen += _buckets[i];
+            if (seen >= target)
+                return static_cast<double>(std::min(bucketUpperEdge(i), _maxMicros));
+        }
+        return static_cast<double>(_maxMicros);
+    }
+
     BenchRunEventCounter::BenchRunEventCounter() {
         reset();
     }
@@ -65,11 +130,13 @@ namespace mongo {
     void BenchRunEventCounter::reset() {
         _numEvents = 0;
         _totalTimeMicros = 0;
+        _histogram.reset();
     }
 
     void BenchRunEventCounter::updateFrom(const BenchRunEventCounter &other) {
         _numEvents += other._numEvents;
         _totalTimeMicros += other._totalTimeMicros;
+        _histogram.mergeFrom(other._histogram);
     }
 
     BenchRunStats::BenchRunStats() {
@@ -118,6 +185,8 @@ namespace mongo {
 
         parallel = 1;
         seconds = 1;
+        warmupSeconds = 0;
+        opsPerSecPerWorker = 0;
         hideResults = true;
         handleErrors = false;
         hideErrors = false;
@@ -155,6 +224,10 @@ namespace mongo {
             this->parallel = args["parallel"].numberInt();
         if ( args["seconds"].isNumber() )
             this->seconds = args["seconds"].number();
+        if ( args["warmupSeconds"].isNumber() )
+            this->warmupSeconds = args["warmupSeconds"].number();
+        if ( args["opsPerSecPerWorker"].isNumber() )
+            this->opsPerSecPerWorker = args["opsPerSecPerWorker"].number();
         if ( ! args["hideResults"].eoo() )
             this->hideResults = args["hideResults"].trueValue();
         if ( ! args["handleErrors"].eoo() )
@@ -316,6 +389,11 @@ namespace mongo {
         long long count = 0;
         mongo::Timer timer;
 
+        bool warmingUp = _config->warmupSeconds > 0;
+        const long long opPeriodMicros = _config->opsPerSecPerWorker > 0 ?
+            static_cast<long long>( 1000000.0 / _config->opsPerSecPerWorker ) : 0;
+        long long nextOpScheduledMicros = opPeriodMicros;
+
         BsonTemplateEvaluator bsonTemplateEvaluator;
 
         while ( !shouldStop() ) {
@@ -324,6 +402,27 @@ namespace mongo {
 
                 if ( shouldStop() ) break;
 
+                // scheduled-rate load: wait for this op's slot on the fixed cadence.  if we
+                // are running behind, don't wait; instead charge the backlog time against
+                // this op's measured latency, so a slow op can't quietly suppress the issue
+                // rate and hide the delays it caused (coordinated omission).
+                unsigned long long queuedMicros = 0;
+                if ( opPeriodMicros > 0 ) {
+                    long long now = timer.micros();
+                    if ( now < nextOpScheduledMicros )
+                        sleepmicros( nextOpScheduledMicros - now );
+                    else
+                        queuedMicros = static_cast<unsigned long long>( now - nextOpScheduledMicros );
+                    nextOpScheduledMicros += opPeriodMicros;
+                }
+
+                if ( warmingUp && timer.seconds() >= _config->warmupSeconds ) {
+                    // the measurement window starts here; drop everything gathered while
+                    // connections ramped up and caches warmed
+                    _stats.reset();
+                    warmingUp = false;
+                }
+
                 BSONElement e = i.next();
 
                 string ns = e["ns"].String();
@@ -372,7 +471,7 @@ namespace mongo {
 
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&_stats.findOneCounter);
+                            BenchRunEventTrace _bret(&_stats.findOneCounter, queuedMicros);
                             result = conn->findOne( ns , fixQuery( e["query"].Obj(),
                                                                    bsonTemplateEvaluator ) );
                         }
@@ -427,12 +526,12 @@ namespace mongo {
 
                         // use special query function for exhaust query option
                         if (options & QueryOption_Exhaust) {
-                            BenchRunEventTrace _bret(&_stats.queryCounter);
+                            BenchRunEventTrace _bret(&_stats.queryCounter, queuedMicros);
                             boost::function<void (const BSONObj&)> castedDoNothing(doNothing);
                             count =  conn->query(castedDoNothing, ns, fixedQuery, &filter, options);
                         }
                         else {
-                            BenchRunEventTrace _bret(&_stats.queryCounter);
+                            BenchRunEventTrace _bret(&_stats.queryCounter, queuedMicros);
                             cursor = conn->query(ns, fixedQuery, limit, skip, &filter, options,
                                                  batchSize);
                             count = cursor->itcount();
@@ -468,7 +567,7 @@ namespace mongo {
                         bool safe = e["safe"].trueValue();
 
                         {
-                            BenchRunEventTrace _bret(&_stats.updateCounter);
+                            BenchRunEventTrace _bret(&_stats.updateCounter, queuedMicros);
                             conn->update( ns, fixQuery( query, bsonTemplateEvaluator ), update,
                                           upsert , multi );
                             if (safe)
@@ -498,7 +597,7 @@ namespace mongo {
                         bool safe = e["safe"].trueValue();
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&_stats.insertCounter);
+                            BenchRunEventTrace _bret(&_stats.insertCounter, queuedMicros);
                             conn->insert( ns, fixQuery( e["doc"].Obj(), bsonTemplateEvaluator ) );
                             if (safe)
                                 result = conn->getLastErrorDetailed();
@@ -531,7 +630,7 @@ namespace mongo {
                         BSONObj result;
 
                         {
-                            BenchRunEventTrace _bret(&_stats.deleteCounter);
+                            BenchRunEventTrace _bret(&_stats.deleteCounter, queuedMicros);
                             conn->remove( ns, fixQuery( query, bsonTemplateEvaluator ), ! multi );
                             if (safe)
                                 result = conn->getLastErrorDetailed();
@@ -725,6 +824,21 @@ namespace mongo {
          }
      }
 
+     void BenchRunner::resetServerStatsBaseline() {
+         boost::scoped_ptr<DBClientBase> conn( _config->createConnection() );
+         if (_config->username != "") {
+             string errmsg;
+             if (!conn->auth("admin", _config->username, _config->password, errmsg)) {
+                 uasserted(17544,
+                           str::stream() << "User " << _config->username
+                           << " could not authenticate to admin db; admin db access is "
+                           "required to use benchRun with auth enabled");
+             }
+         }
+         conn->simpleCommand( "admin" , &before , "serverStatus" );
+         before = before.getOwned();
+     }
+
      BenchRunner* BenchRunner::createWithConfig( const BSONObj &configArgs ) {
          BenchRunConfig *config = BenchRunConfig::createFromBson( configArgs );
          return new BenchRunner(config);
@@ -761,6 +875,22 @@ namespace mongo {
                         static_cast<double>(counter.getTotalTimeMicros()) / counter.getNumEvents());
      }
 
+     static void appendLatencyPercentilesIfAvailable(
+             BSONObjBuilder &buf, const std::string &name, const BenchRunEventCounter &counter) {
+
+         const BenchRunLatencyHistogram &histogram = counter.getHistogram();
+         if (histogram.getNumEntries() == 0)
+             return;
+         BSONObjBuilder sub(buf.subobjStart(name));
+         sub.append("p50", histogram.getPercentileMicros(50));
+         sub.append("p90", histogram.getPercentileMicros(90));
+         sub.append("p95", histogram.getPercentileMicros(95));
+         sub.append("p99", histogram.getPercentileMicros(99));
+         sub.append("p999", histogram.getPercentileMicros(99.9));
+         sub.append("max", static_cast<double>(histogram.getMaxMicros()));
+         sub.done();
+     }
+
      BSONObj BenchRunner::finish( BenchRunner* runner ) {
 
          runner->stop();
@@ -787,6 +917,11 @@ namespace mongo {
          appendAverageMicrosIfAvailable(buf, "deleteLatencyAverageMicros", stats.deleteCounter);
          appendAverageMicrosIfAvailable(buf, "updateLatencyAverageMicros", stats.updateCounter);
          appendAverageMicrosIfAvailable(buf, "queryLatencyAverageMicros", stats.queryCounter);
+         appendLatencyPercentilesIfAvailable(buf, "findOneLatencyMicros", stats.findOneCounter);
+         appendLatencyPercentilesIfAvailable(buf, "insertLatencyMicros", stats.insertCounter);
+         appendLatencyPercentilesIfAvailable(buf, "deleteLatencyMicros", stats.deleteCounter);
+         appendLatencyPercentilesIfAvailable(buf, "updateLatencyMicros", stats.updateCounter);
+         appendLatencyPercentilesIfAvailable(buf, "queryLatencyMicros", stats.queryCounter);
 
          {
              BSONObjIterator i( after );
@@ -816,6 +951,12 @@ namespace mongo {
 
          OID oid = OID( start.firstElement().String() );
          BenchRunner* runner = BenchRunner::get( oid );
+         if ( runner->config().warmupSeconds > 0 ) {
+             sleepmillis( (int)(1000.0 * runner->config().warmupSeconds) );
+             // restart the server-side opcounter baseline so the per-second numbers describe
+             // the measurement window only; workers discard their own warmup stats themselves
+             runner->resetServerStatsBaseline();
+         }
          sleepmillis( (int)(1000.0 * runner->config().seconds) );
 
          return benchFinish( start, data );
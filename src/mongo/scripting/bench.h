@@ -85,6 +85,27 @@ namespace mongo {
          */
         double seconds;
 
+        /**
+         * Warmup period, in seconds, at the start of the run during which ops are performed
+         * but their statistics are discarded, so reported numbers describe steady state
+         * rather than connection ramp-up and cache warming.  0 disables the split.
+         *
+         * The javascript benchRun() and benchRunSync() functions run for warmupSeconds +
+         * seconds in total.
+         */
+        double warmupSeconds;
+
+        /**
+         * Scheduled op issue rate for each worker thread, in ops per second.
+         *
+         * When nonzero, a worker issues ops on a fixed cadence instead of back to back; if
+         * an op overruns its slot, the backlog time is charged against the latency of the
+         * ops it delayed, so slow ops cannot quietly suppress the issue rate (avoids
+         * coordinated omission in the latency numbers).  0 means issue as fast as possible
+         * (the old behavior).
+         */
+        double opsPerSecPerWorker;
+
         bool hideResults;
         bool handleErrors;
         bool hideErrors;
@@ -115,6 +136,60 @@ namespace mongo {
         void initializeToDefaults();
     };
 
+    /**
+     * A fixed-size logarithmic histogram of event durations, in microseconds.
+     *
+     * Durations are bucketed with 16 sub-buckets per power of two, so percentile estimates
+     * carry at most ~6% relative error while the whole histogram stays a few KB and
+     * recording stays O(1).
+     *
+     * Not thread safe.  Expected use is one instance per thread during parallel execution,
+     * merged with mergeFrom() afterwards, like BenchRunEventCounter.
+     */
+    class BenchRunLatencyHistogram {
+    public:
+        /// Constructs an empty histogram.
+        BenchRunLatencyHistogram();
+
+        /**
+         * Empty out the histogram.
+         */
+        void reset();
+
+        /**
+         * Record one event of duration "timeMicros" microseconds.
+         */
+        void addEntry(unsigned long long timeMicros);
+
+        /**
+         * Conceptually the equivalent of "+=".  Adds "other" into this.
+         */
+        void mergeFrom(const BenchRunLatencyHistogram &other);
+
+        unsigned long long getNumEntries() const { return _numEntries; }
+
+        /// Largest duration recorded, exactly (not bucketed).
+        unsigned long long getMaxMicros() const { return _maxMicros; }
+
+        /**
+         * Duration at or below which "p" percent (0 < p <= 100) of the recorded events
+         * fall.  Returns 0 if the histogram is empty.
+         */
+        double getPercentileMicros(double p) const;
+
+    private:
+        static const int kSubBucketBits = 4;
+        static const int kSubBuckets = 1 << kSubBucketBits;
+        static const int kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+        static int bucketFor(unsigned long long timeMicros);
+        static unsigned long long bucketUpperEdge(int bucket);
+
+        unsigned long long _numEntries;
+        unsigned long long _maxMicros;
+        unsigned long long _buckets[kNumBuckets];
+    };
+
     /**
      * An event counter for events that have an associated duration.
      *
@@ -142,6 +217,7 @@ namespace mongo {
         void countOne(unsigned long long timeMicros) {
             ++_numEvents;
             _totalTimeMicros += timeMicros;
+            _histogram.addEntry(timeMicros);
         }
 
         /**
@@ -154,9 +230,15 @@ namespace mongo {
          */
         unsigned long long getNumEvents() const { return _numEvents; }
 
+        /**
+         * Get the latency histogram of the observed events.
+         */
+        const BenchRunLatencyHistogram &getHistogram() const { return _histogram; }
+
     private:
         unsigned long long _numEvents;
         unsigned long long _totalTimeMicros;
+        BenchRunLatencyHistogram _histogram;
     };
 
     /**
@@ -171,21 +253,27 @@ namespace mongo {
      * event, and otherwise, the succes counter will.
      *
      * In all cases, the counter objects must outlive the trace object.
+     *
+     * "extraTimeMicros" is added to the measured duration.  benchRun uses it to charge the
+     * time an op spent queued behind its scheduled issue time against that op's latency.
      */
     class BenchRunEventTrace : private boost::noncopyable {
     public:
-        explicit BenchRunEventTrace(BenchRunEventCounter *eventCounter) {
-            initialize(eventCounter, eventCounter, false);
+        explicit BenchRunEventTrace(BenchRunEventCounter *eventCounter,
+                                    unsigned long long extraTimeMicros = 0) {
+            initialize(eventCounter, eventCounter, false, extraTimeMicros);
         }
 
         BenchRunEventTrace(BenchRunEventCounter *successCounter,
                            BenchRunEventCounter *failCounter,
-                           bool defaultToFailure=true) {
-            initialize(successCounter, failCounter, defaultToFailure);
+                           bool defaultToFailure=true,
+                           unsigned long long extraTimeMicros = 0) {
+            initialize(successCounter, failCounter, defaultToFailure, extraTimeMicros);
         }
 
         ~BenchRunEventTrace() {
-            (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros());
+            (_succeeded ? _successCounter : _failCounter)->countOne(
+                    _timer.micros() + _extraTimeMicros);
         }
 
         void succeed() { _succeeded = true; }
@@ -194,16 +282,19 @@ namespace mongo {
     private:
         void initialize(BenchRunEventCounter *successCounter,
                         BenchRunEventCounter *failCounter,
-                        bool defaultToFailure) {
+                        bool defaultToFailure,
+                        unsigned long long extraTimeMicros) {
             _successCounter = successCounter;
             _failCounter = failCounter;
             _succeeded = !defaultToFailure;
+            _extraTimeMicros = extraTimeMicros;
         }
 
         Timer _timer;
         BenchRunEventCounter *_successCounter;
         BenchRunEventCounter *_failCounter;
         bool _succeeded;
+        unsigned long long _extraTimeMicros;
     };
 
     /**
@@ -384,6 +475,15 @@ namespace mongo {
          */
         void stop();
 
+        /**
+         * Re-snapshot the server-side stats used as the "before" baseline.
+         *
+         * Called at the end of the warmup period so per-second numbers describe the
+         * measurement window only; workers discard their own warmup stats at the same
+         * boundary.
+         */
+        void resetServerStatsBaseline();
+
         /**
          * Store the collected event data from a completed bench run activity into "stats."
          *
@@ -286,6 +286,9 @@ namespace {
             if (scope->getTimesUsed() > kMaxScopeReuse)
                 return; // used too many times to save
 
+            if (scope->cachedFunctionCount() > kMaxCachedFunctions)
+                return; // accumulated too many distinct compiled functions to keep around
+
             if (!scope->getError().empty())
                 return; // not saving errored scopes
 
@@ -321,8 +324,14 @@ namespace {
         };
 
         // Note: if these numbers change, reconsider choice of datastructure for _pools
-        static const unsigned kMaxPoolSize = 10;
-        static const int kMaxScopeReuse = 10;
+        static const unsigned kMaxPoolSize = 25;
+
+        // Reusing a scope keeps its context and cache of compiled functions, so repeat
+        // $where/map-reduce sources skip compilation entirely.  The reuse and cached
+        // function limits exist only to bound slow per-context heap growth; recycling a
+        // scope means paying full context setup plus recompiles, so recycle rarely.
+        static const int kMaxScopeReuse = 100;
+        static const size_t kMaxCachedFunctions = 500;
 
         typedef deque<ScopeAndPool> Pools; // More-recently used Scopes are kept at the front.
         Pools _pools;    // protected by _mutex
@@ -337,7 +346,7 @@ namespace {
         PooledScope(const std::string& pool, const boost::shared_ptr<Scope>& real)
             : _pool(pool)
             , _real(real) {
-            _real->loadStored(true);
+            // caller (getPooledScope) runs loadStored() once the local db is set
         }
 
         virtual ~PooledScope() {
@@ -140,6 +140,9 @@ namespace mongo {
         /** gets the number of times a scope was used */
         int getTimesUsed() { return _numTimesUsed; }
 
+        /** number of distinct function sources compiled and cached in this scope */
+        size_t cachedFunctionCount() const { return _cachedFunctions.size(); }
+
         /** return true if last invoke() return'd native code */
         virtual bool isLastRetNativeCode() { return _lastRetIsNativeCode; }
 
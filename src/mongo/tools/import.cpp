@@ -18,6 +18,7 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <boost/thread/thread.hpp>
 #include <fstream>
 #include <iostream>
 
@@ -26,6 +27,7 @@
 #include "mongo/tools/mongoimport_options.h"
 #include "mongo/tools/tool.h"
 #include "mongo/util/options_parser/option_section.h"
+#include "mongo/util/queue.h"
 #include "mongo/util/text.h"
 
 using namespace mongo;
@@ -319,6 +321,72 @@ public:
         }
     }
 
+    /**
+     * Work item for the parallel JSON parse pipeline (--parseThreads): a reader thread
+     * queues raw lines, parser threads queue the resulting objects, and run() performs
+     * the inserts so the connection is never shared between threads.
+     */
+    struct ImportJob {
+        std::string line;  // raw input line (reader -> parser)
+        BSONObj obj;       // parsed document (parser -> run())
+        int len;           // bytes consumed from the input stream, for the progress meter
+        bool eof;          // shutdown sentinel
+        ImportJob() : len(0), eof(true) {}
+        ImportJob(const std::string& l, int n) : line(l), len(n), eof(false) {}
+        ImportJob(const BSONObj& o, int n) : obj(o), len(n), eof(false) {}
+    };
+
+    typedef BlockingQueue<ImportJob> ImportJobQueue;
+
+    AtomicUInt parseErrors;
+
+    void readerThread(istream* in, ImportJobQueue* lines, int nParsers) {
+        try {
+            boost::scoped_array<char> buffer(new char[BUF_SIZE+2]);
+            while (in->rdstate() == 0) {
+                if (mongoImportGlobalParams.stopOnError && parseErrors > 0)
+                    break;
+                char* line = buffer.get();
+                int numBytesRead = getLine(in, line);
+                line += numBytesRead;
+                if (line[0] == '\0')
+                    continue;
+                numBytesRead += strlen( line );
+                lines->push(ImportJob(line, numBytesRead));
+            }
+        }
+        catch ( const std::exception& e ) {
+            log() << "exception:" << e.what() << endl;
+            parseErrors++;
+        }
+        // one sentinel per parser so they all shut down
+        for (int i = 0; i < nParsers; i++) {
+            lines->push(ImportJob());
+        }
+    }
+
+    void parserThread(ImportJobQueue* lines, ImportJobQueue* docs) {
+        while (true) {
+            ImportJob job = lines->blockingPop();
+            if (job.eof)
+                break;
+            try {
+                // Strip out trailing whitespace
+                job.line.erase(job.line.find_last_not_of(" \f\n\r\t\v") + 1);
+                try {
+                    docs->push(ImportJob(fromjson(job.line), job.len));
+                } catch ( MsgAssertionException& e ) {
+                    uasserted(13504, string("BSON representation of supplied JSON is too large: ") + e.what());
+                }
+            }
+            catch ( const std::exception& e ) {
+                log() << "exception:" << e.what() << endl;
+                parseErrors++;
+            }
+        }
+        docs->push(ImportJob());
+    }
+
     int run() {
         long long fileSize = 0;
         int headerRows = 0;
@@ -495,6 +563,56 @@ public:
                 }
             }
         }
+        else if (_type == JSON && mongoImportGlobalParams.parseThreads > 1) {
+            // Parse in parallel: one thread reads lines, parseThreads threads turn them
+            // into BSON, and this thread feeds the results to the server, so the parser
+            // keeps up with the write pipeline on wide machines.  Note that documents
+            // may be inserted in a different order than they appear in the file.
+            const int nParsers = mongoImportGlobalParams.parseThreads;
+            ImportJobQueue lines(nParsers * 100);
+            ImportJobQueue docs(nParsers * 100);
+
+            boost::thread reader(boost::bind(&Import::readerThread, this, in, &lines, nParsers));
+            vector< shared_ptr<boost::thread> > parsers;
+            for (int i = 0; i < nParsers; i++) {
+                parsers.push_back(shared_ptr<boost::thread>(
+                        new boost::thread(boost::bind(&Import::parserThread, this,
+                                                      &lines, &docs))));
+            }
+
+            int parsersDone = 0;
+            while (parsersDone < nParsers) {
+                ImportJob job = docs.blockingPop();
+                if (job.eof) {
+                    parsersDone++;
+                    continue;
+                }
+                len = job.len;
+
+                if (mongoImportGlobalParams.doimport) {
+                    importDocument(ns, job.obj);
+
+                    if (num < 10) {
+                        // we absolutely want to check the first and last op of the batch. we do
+                        // a few more as that won't be too time expensive.
+                        checkLastError();
+                        lastNumChecked = num;
+                    }
+                }
+
+                num++;
+
+                if ( pm.hit( len + 1 ) ) {
+                    log() << "\t\t\t" << num << "\t" << ( num / ( time(0) - start ) ) << "/second" << endl;
+                }
+            }
+
+            reader.join();
+            for (int i = 0; i < nParsers; i++) {
+                parsers[i]->join();
+            }
+            errors += parseErrors;
+        }
         else {
             while (in->rdstate() == 0) {
                 try {
@@ -104,6 +104,13 @@ namespace mongo {
             return ret;
         }
 
+        ret = options->addOption(OD("parseThreads", "parseThreads", moe::Int,
+                    "number of threads to use for parsing JSON input. "
+                    "default: 1 (JSON one-item-per-line only)", true));
+        if(!ret.isOK()) {
+            return ret;
+        }
+
         ret = options->addOption(OD("noimport", "noimport", moe::Switch,
                     "don't actually import. useful for benchmarking parser", false));
         if(!ret.isOK()) {
@@ -171,6 +178,7 @@ namespace mongo {
         mongoImportGlobalParams.jsonArray = hasParam("jsonArray");
         mongoImportGlobalParams.headerLine = hasParam("headerline");
         mongoImportGlobalParams.stopOnError = hasParam("stopOnError");
+        mongoImportGlobalParams.parseThreads = getParam("parseThreads", 1);
 
         return Status::OK();
     }
@@ -36,6 +36,7 @@ namespace mongo {
         bool stopOnError;
         bool jsonArray;
         bool doimport;
+        int parseThreads;
     };
 
     extern MongoImportGlobalParams mongoImportGlobalParams;
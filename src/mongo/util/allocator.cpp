@@ -0,0 +1,32 @@
+// allocator.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/util/allocator.h"
+
+#ifdef MONGO_HAVE_GPERFTOOLS
+#include "third_party/gperftools-2.0/src/gperftools/malloc_extension.h"
+#endif
+
+namespace mongo {
+
+    void mallocReleaseFreeMemory() {
+#ifdef MONGO_HAVE_GPERFTOOLS
+        MallocExtension::instance()->ReleaseFreeMemory();
+#endif
+    }
+
+} // namespace mongo
@@ -24,15 +24,35 @@
 
 namespace mongo {
 
+    /**
+     * Return the allocator's free lists and unused heap pages to the operating
+     * system (tcmalloc builds; a no-op with the system allocator).  Called on
+     * memory pressure -- a failed allocation, or after a database close frees
+     * a large amount of heap -- and available anywhere a big working set has
+     * just been torn down.
+     */
+    void mallocReleaseFreeMemory();
+
     inline void * ourmalloc(size_t size) {
         void *x = malloc(size);
-        if ( x == 0 ) printStackAndExit(0);
+        if ( x == 0 ) {
+            // hand cached free memory back and retry before giving up
+            mallocReleaseFreeMemory();
+            x = malloc(size);
+            if ( x == 0 )
+                printStackAndExit(0);
+        }
         return x;
     }
 
     inline void * ourrealloc(void *ptr, size_t size) {
         void *x = realloc(ptr, size);
-        if ( x == 0 ) printStackAndExit(0);
+        if ( x == 0 ) {
+            mallocReleaseFreeMemory();
+            x = realloc(ptr, size);
+            if ( x == 0 )
+                printStackAndExit(0);
+        }
         return x;
     }
 
@@ -22,6 +22,12 @@
 #include <boost/thread/condition.hpp>
 #include <boost/thread/thread.hpp>
 
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/concurrency/spin_lock.h"
 #include "mongo/util/concurrency/thread_name.h"
@@ -33,6 +39,35 @@
 using namespace std;
 namespace mongo {
 
+    namespace {
+
+        /**
+         * Best effort: drop the calling thread's CPU (nice) and IO scheduling
+         * priority so the kernel favors foreground threads when the box is
+         * saturated.  On Linux setpriority() with a thread id affects only that
+         * thread; elsewhere this is a no-op.
+         */
+        void lowerCurrentThreadPriority() {
+#if defined(__linux__)
+            const pid_t tid = (pid_t)syscall( SYS_gettid );
+            if ( setpriority( PRIO_PROCESS, tid, 10 ) != 0 ) {
+                LOG(1) << "couldn't lower background thread cpu priority: "
+                       << errnoWithDescription() << endl;
+            }
+#if defined(SYS_ioprio_set)
+            // best-effort class (2), lowest level (7); glibc has no wrapper and
+            // the constants come from linux/ioprio.h, which not all build hosts
+            // carry, so they are spelled out here
+            const int ioprioWhoProcess = 1;
+            const int ioprioClassShift = 13;
+            const int ioprio = ( 2 << ioprioClassShift ) | 7;
+            syscall( SYS_ioprio_set, ioprioWhoProcess, tid, ioprio );
+#endif
+#endif
+        }
+
+    }
+
     // both the BackgroundJob and the internal thread point to JobStatus
     struct BackgroundJob::JobStatus {
         JobStatus( bool delFlag )
@@ -64,6 +99,9 @@ namespace mongo {
         if( ! threadName.empty() )
             setThreadName( threadName.c_str() );
 
+        if ( priority() == LOW )
+            lowerCurrentThreadPriority();
+
         try {
             run();
         }
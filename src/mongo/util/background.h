@@ -44,6 +44,18 @@ namespace mongo {
      */
 
     class BackgroundJob : boost::noncopyable {
+    public:
+        /**
+         * Scheduling class for the job's thread.  LOW is for housekeeping (TTL
+         * deletes, cursor timeouts, ...): the thread's CPU and IO priority are
+         * lowered at start so the kernel favors foreground threads when the machine
+         * is saturated; when it isn't, LOW jobs run at full speed.
+         */
+        enum Priority {
+            NORMAL = 0,
+            LOW = 1
+        };
+
     protected:
         /**
          * sub-class must instantiate the BackgroundJob
@@ -55,6 +67,9 @@ namespace mongo {
 
         virtual std::string name() const = 0;
 
+        /** override to run the job's thread in a different scheduling class */
+        virtual Priority priority() const { return NORMAL; }
+
         /**
          * define this to do your work.
          * after this returns, state is set to done.
@@ -130,7 +145,9 @@ namespace mongo {
             virtual ~Runner(){}
 
             virtual std::string name() const { return "PeriodicTask::Runner"; }
-            
+
+            virtual Priority priority() const { return LOW; }
+
             virtual void run();
             
             void add( PeriodicTask* task );
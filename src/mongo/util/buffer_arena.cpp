@@ -0,0 +1,120 @@
+// buffer_arena.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/util/buffer_arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <boost/thread/tss.hpp>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+    namespace bufferarena {
+
+        namespace {
+
+            const size_t MinClassBytes = 512;        // class 0; matches StackBufBuilder's inline size
+            const int NumClasses = 8;                // 512B .. 64KB
+            const size_t MaxClassBytes = MinClassBytes << (NumClasses - 1);
+            const int MaxBlocksPerClass = 4;         // bounds a thread's cache at ~510KB
+
+            AtomicInt64 _hits;
+            AtomicInt64 _misses;
+            AtomicInt64 _unpooled;
+
+            /** the per-thread cache: a small LIFO stack of free blocks per size class */
+            struct Cache {
+                void* blocks[NumClasses][MaxBlocksPerClass];
+                int counts[NumClasses];
+                Cache() { memset(this, 0, sizeof(*this)); }
+                ~Cache() {
+                    for( int c = 0; c < NumClasses; c++ )
+                        for( int i = 0; i < counts[c]; i++ )
+                            free(blocks[c][i]);
+                }
+            };
+
+            boost::thread_specific_ptr<Cache> _cache;
+
+            Cache& cache() {
+                Cache *c = _cache.get();
+                if( c == 0 ) {
+                    c = new Cache();
+                    _cache.reset(c);
+                }
+                return *c;
+            }
+
+            /** smallest class whose blocks hold sz bytes, or -1 if sz is too big to pool */
+            int classFor(size_t sz) {
+                size_t b = MinClassBytes;
+                for( int c = 0; c < NumClasses; c++, b <<= 1 )
+                    if( sz <= b )
+                        return c;
+                return -1;
+            }
+
+        }
+
+        void* acquire(size_t sz, size_t* allocatedSize) {
+            int c = classFor(sz);
+            if( c < 0 ) {
+                _unpooled.addAndFetch(1);
+                *allocatedSize = sz;
+                void *p = malloc(sz);
+                if ( p == 0 )
+                    msgasserted( 17524, "out of memory bufferarena::acquire" );
+                return p;
+            }
+            size_t classBytes = MinClassBytes << c;
+            *allocatedSize = classBytes;
+            Cache& ca = cache();
+            if( ca.counts[c] > 0 ) {
+                _hits.addAndFetch(1);
+                return ca.blocks[c][--ca.counts[c]];
+            }
+            _misses.addAndFetch(1);
+            void *p = malloc(classBytes);
+            if ( p == 0 )
+                msgasserted( 17525, "out of memory bufferarena::acquire" );
+            return p;
+        }
+
+        void release(void* p, size_t allocatedSize) {
+            if( p == 0 )
+                return;
+            if( allocatedSize >= MinClassBytes && allocatedSize <= MaxClassBytes &&
+                (allocatedSize & (allocatedSize - 1)) == 0 ) {
+                int c = classFor(allocatedSize);
+                Cache& ca = cache();
+                if( ca.counts[c] < MaxBlocksPerClass ) {
+                    ca.blocks[c][ca.counts[c]++] = p;
+                    return;
+                }
+            }
+            free(p);
+        }
+
+        long long hits()     { return _hits.load(); }
+        long long misses()   { return _misses.load(); }
+        long long unpooled() { return _unpooled.load(); }
+
+    }
+}
@@ -0,0 +1,54 @@
+// buffer_arena.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+namespace mongo {
+
+    /** Thread-local cache of malloc'd buffers, used by BufBuilder so that the
+        builder-per-document pattern (key generation, projections, oplog writing,
+        command replies) doesn't hit malloc/free once the thread is warm.
+
+        Blocks are handed out in power-of-two size classes and cached LIFO per
+        class, which matches builder lifetimes (they nest).  Every block is a plain
+        malloc block: a buffer that is decouple()d from its builder and eventually
+        free()d by its consumer simply bypasses the arena, and a foreign malloc
+        block released here is just cached or freed.  The per-thread cache is
+        bounded and freed on thread exit.
+    */
+    namespace bufferarena {
+
+        /** get a block of at least sz bytes.
+            @param allocatedSize out: the usable size of the returned block (>= sz);
+                                 pass this to release()
+        */
+        void* acquire(size_t sz, size_t* allocatedSize);
+
+        /** return a block obtained from acquire().
+            @param allocatedSize the size acquire() reported for this block
+        */
+        void release(void* p, size_t allocatedSize);
+
+        /* cumulative, process-wide; reported in serverStatus */
+        long long hits();      // acquires served from the cache
+        long long misses();    // poolable acquires that fell through to malloc
+        long long unpooled();  // acquires too large to pool
+    }
+
+}
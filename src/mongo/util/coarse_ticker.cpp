@@ -0,0 +1,93 @@
+// coarse_ticker.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/util/coarse_ticker.h"
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/background.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    int coarseClockIntervalMicros = 1000;
+
+    namespace {
+
+        // only the ticker thread writes these; the padding keeps the constantly
+        // rewritten line away from anything readers park on
+        struct Stamps {
+            char pad0[64];
+            AtomicInt64 wallMillis;
+            AtomicInt64 elapsedMillis;
+            char pad1[64];
+        };
+        Stamps stamps;
+
+        // written once, when the first stamp is in place
+        AtomicUInt32 tickerRunning;
+
+        unsigned long long tickerStart = 0;
+
+        class CoarseTicker : public BackgroundJob {
+        public:
+            CoarseTicker() : BackgroundJob( true /* self delete */ ) {}
+            virtual string name() const { return "CoarseTicker"; }
+            virtual void run() {
+                stamp();
+                tickerRunning.store( 1 );
+                while ( !inShutdown() ) {
+                    sleepmicros( coarseClockIntervalMicros );
+                    stamp();
+                }
+            }
+        private:
+            void stamp() {
+                const unsigned long long now = curTimeMillis64();
+                stamps.wallMillis.store( static_cast<long long>( now ) );
+                stamps.elapsedMillis.store( static_cast<long long>( now - tickerStart ) );
+            }
+        };
+    }
+
+    void startCoarseTicker() {
+        static bool started = false;
+        if ( started )
+            return;
+        started = true;
+        tickerStart = curTimeMillis64();
+        ( new CoarseTicker() )->go();
+    }
+
+    bool coarseTickerRunning() {
+        return tickerRunning.loadRelaxed() != 0;
+    }
+
+    unsigned long long coarseCurTimeMillis() {
+        if ( coarseTickerRunning() )
+            return static_cast<unsigned long long>( stamps.wallMillis.loadRelaxed() );
+        return curTimeMillis64();
+    }
+
+    long long coarseTickerElapsedMillis() {
+        if ( coarseTickerRunning() )
+            return stamps.elapsedMillis.loadRelaxed();
+        return -1;
+    }
+
+}
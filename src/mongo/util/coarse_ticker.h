@@ -0,0 +1,51 @@
+// coarse_ticker.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+namespace mongo {
+
+    /**
+     * Process-wide coarse clock.  A dedicated thread restamps a pair of cache-line
+     * isolated counters every coarseClockIntervalMicros (default 1000): wall clock
+     * millis and millis since the ticker started.  Readers pay one atomic load
+     * instead of a clock syscall, which matters for checks made once per document
+     * or per record access -- CurOp elapsed tests, ElapsedTracker, cursor timeout
+     * sweeps.  Anything whose value is reported to a user (explain, the profiler)
+     * should keep reading the real clock.
+     *
+     * Until startCoarseTicker() runs (early startup, tools) the readers fall
+     * through to the real clock, so values are never stale, just occasionally
+     * expensive.
+     */
+
+    // microseconds between stamps; the coarseClockIntervalMicros server parameter
+    extern int coarseClockIntervalMicros;
+
+    /** spawn the ticker thread.  call once, during startup. */
+    void startCoarseTicker();
+
+    /** @return true once the ticker thread has stamped its first value */
+    bool coarseTickerRunning();
+
+    /** wall clock millis since epoch, at ticker granularity */
+    unsigned long long coarseCurTimeMillis();
+
+    /** millis since startCoarseTicker(); -1 if the ticker isn't running */
+    long long coarseTickerElapsedMillis();
+
+}
@@ -44,6 +44,13 @@ namespace mongo {
         char* compressed,
         size_t* compressed_length);
 
+    bool uncompressedLength(const char* compressed,
+        size_t compressed_length,
+        size_t* result);
+    bool rawUncompress(const char* compressed,
+        size_t compressed_length,
+        char* uncompressed);
+
 }
 
 
@@ -74,29 +74,68 @@ namespace mongo {
         other threads remain blocked in w_to_X() until the thread in the X state calls X_to_w().
     */
     class QLock : boost::noncopyable {
-        struct Z { 
-            Z() : n(0) { }
+        struct Z {
+            Z() : n(0), nWaiting(0), oldestWaitStart(0), waits(0), waitMicros(0) { }
             boost::condition c;
             int n;
+            int nWaiting;        // threads currently blocked entering this state
+            // micros timestamp from which the current starvation age is measured: the time
+            // a waiter last entered an empty queue, or last successfully got through while
+            // others still waited.  0 when nWaiting is 0.
+            unsigned long long oldestWaitStart;
+            long long waits;       // total number of waits since startup
+            long long waitMicros;  // total time spent waiting since startup
         };
         boost::mutex m;
         Z r,w,R,W,U,X;
         int numPendingGlobalWrites;  // >0 if someone wants to acquire a write lock
         long long generationX;
         long long generationXExit;
+        long long starvationThresholdMicros; // see setStarvationThresholdMicros()
         void _lock_W();
         void _unlock_R();
         bool _areQueueJumpingGlobalWritesPending() const {
             return numPendingGlobalWrites > 0;
         }
 
+        // must hold m.  records that the calling thread is about to wait to enter z.
+        unsigned long long _beginWait(Z& z) {
+            unsigned long long now = curTimeMicros64();
+            if( z.nWaiting++ == 0 )
+                z.oldestWaitStart = now;
+            z.waits++;
+            return now;
+        }
+
+        // must hold m.  start is the return value of the matching _beginWait call.
+        void _endWait(Z& z, unsigned long long start) {
+            unsigned long long now = curTimeMicros64();
+            z.waitMicros += now - start;
+            if( --z.nWaiting == 0 )
+                z.oldestWaitStart = 0;
+            else
+                z.oldestWaitStart = now; // remaining waiters' starvation age restarts here
+        }
+
+        // true if a 'w' lock has been waiting longer than the starvation threshold.  new
+        // 'R' admissions are held back until it gets in, bounding writer starvation under
+        // global-read storms the way numPendingGlobalWrites already bounds it for 'W'.
+        bool _starvedWritersPending() const {
+            return starvationThresholdMicros > 0 &&
+                   w.nWaiting > 0 &&
+                   curTimeMicros64() - w.oldestWaitStart >
+                           static_cast<unsigned long long>(starvationThresholdMicros);
+        }
+
         bool W_legal() const { return r.n + w.n + R.n + W.n + X.n == 0; }
         bool R_legal_ignore_greed() const { return w.n + W.n + X.n == 0; }
         bool r_legal_ignore_greed() const { return W.n + X.n == 0; }
         bool w_legal_ignore_greed() const { return R.n + W.n + X.n == 0; }
 
         bool R_legal() const {
-            return !_areQueueJumpingGlobalWritesPending() && R_legal_ignore_greed();
+            return !_areQueueJumpingGlobalWritesPending() &&
+                   !_starvedWritersPending() &&
+                   R_legal_ignore_greed();
         }
 
         bool w_legal() const {
@@ -115,7 +154,28 @@ namespace mongo {
         QLock() :
             numPendingGlobalWrites(0),
             generationX(0),
-            generationXExit(0) {
+            generationXExit(0),
+            starvationThresholdMicros(100 * 1000) {
+        }
+
+        /** per-state queue counters, for diagnostics (see the qlock serverStatus section) */
+        struct StateStats {
+            int threadsHolding;           // threads currently in this state
+            int threadsWaiting;           // threads currently blocked entering this state
+            long long waits;              // total waits since startup
+            long long waitMicros;         // total time spent waiting since startup
+            long long oldestWaitMicros;   // how long waiters have continuously existed; 0 if none
+        };
+        struct Stats {
+            StateStats r, w, R, W;
+        };
+        void getStats(Stats& s);
+
+        /** once a 'w' lock has waited this long, new 'R' admissions are held back until it
+            acquires.  0 disables the escalation.  default 100ms. */
+        void setStarvationThresholdMicros(long long micros) {
+            boost::mutex::scoped_lock lk(m);
+            starvationThresholdMicros = micros;
         }
 
         void lock_r();
@@ -181,18 +241,26 @@ namespace mongo {
     //  granular locks."
     inline void QLock::lock_r() {
         boost::mutex::scoped_lock lk(m);
-        while( !r_legal() ) {
-            r.c.wait(m);
+        if( !r_legal() ) {
+            unsigned long long start = _beginWait(r);
+            while( !r_legal() ) {
+                r.c.wait(m);
+            }
+            _endWait(r, start);
         }
         r.n++;
     }
 
     // "i will be writing. i promise to coordinate my activities with w's and r's as i go with more 
     //  granular locks."
-    inline void QLock::lock_w() { 
+    inline void QLock::lock_w() {
         boost::mutex::scoped_lock lk(m);
-        while( !w_legal() ) {
-            w.c.wait(m);
+        if( !w_legal() ) {
+            unsigned long long start = _beginWait(w);
+            while( !w_legal() ) {
+                w.c.wait(m);
+            }
+            _endWait(w, start);
         }
         w.n++;
     }
@@ -201,8 +269,12 @@ namespace mongo {
     // are writing."
     inline void QLock::lock_R() {
         boost::mutex::scoped_lock lk(m);
-        while( ! R_legal() ) {
-            R.c.wait(m);
+        if( ! R_legal() ) {
+            unsigned long long start = _beginWait(R);
+            while( ! R_legal() ) {
+                R.c.wait(m);
+            }
+            _endWait(R, start);
         }
         R.n++;
     }
@@ -210,8 +282,12 @@ namespace mongo {
     inline bool QLock::lock_R_try(int millis) {
         unsigned long long end = curTimeMillis64() + millis;
         boost::mutex::scoped_lock lk(m);
-        while( !R_legal() && curTimeMillis64() < end ) {
-            R.c.timed_wait(m, boost::posix_time::milliseconds(millis));
+        if( !R_legal() ) {
+            unsigned long long start = _beginWait(R);
+            while( !R_legal() && curTimeMillis64() < end ) {
+                R.c.timed_wait(m, boost::posix_time::milliseconds(millis));
+            }
+            _endWait(R, start);
         }
         if ( R_legal() ) {
             R.n++;
@@ -225,8 +301,12 @@ namespace mongo {
         boost::mutex::scoped_lock lk(m);
 
         ++numPendingGlobalWrites;
-        while (!W_legal() && curTimeMillis64() < end) {
-            W.c.timed_wait(m, boost::posix_time::milliseconds(millis));
+        if (!W_legal()) {
+            unsigned long long start = _beginWait(W);
+            while (!W_legal() && curTimeMillis64() < end) {
+                W.c.timed_wait(m, boost::posix_time::milliseconds(millis));
+            }
+            _endWait(W, start);
         }
         --numPendingGlobalWrites;
 
@@ -331,8 +411,12 @@ namespace mongo {
     // "i will be writing. i will coordinate with no one. you better stop them all"
     inline void QLock::_lock_W() {
         ++numPendingGlobalWrites;
-        while( !W_legal() ) {
-            W.c.wait(m);
+        if( !W_legal() ) {
+            unsigned long long start = _beginWait(W);
+            while( !W_legal() ) {
+                W.c.wait(m);
+            }
+            _endWait(W, start);
         }
         --numPendingGlobalWrites;
         W.n++;
@@ -342,6 +426,21 @@ namespace mongo {
         _lock_W();
     }
 
+    inline void QLock::getStats(Stats& s) {
+        boost::mutex::scoped_lock lk(m);
+        unsigned long long now = curTimeMicros64();
+        StateStats* out[4] = { &s.r, &s.w, &s.R, &s.W };
+        Z* in[4] = { &r, &w, &R, &W };
+        for( int i = 0; i < 4; i++ ) {
+            out[i]->threadsHolding = in[i]->n;
+            out[i]->threadsWaiting = in[i]->nWaiting;
+            out[i]->waits = in[i]->waits;
+            out[i]->waitMicros = in[i]->waitMicros;
+            out[i]->oldestWaitMicros =
+                in[i]->nWaiting ? static_cast<long long>(now - in[i]->oldestWaitStart) : 0;
+        }
+    }
+
     inline void QLock::unlock_r() {
         boost::mutex::scoped_lock lk(m);
         fassert(16137, r.n > 0);
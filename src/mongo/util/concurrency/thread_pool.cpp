@@ -27,6 +27,10 @@
 namespace mongo {
     namespace threadpool {
 
+        // the most tasks a worker takes in one trip to the pool; bounds how uneven the
+        // split can get while still amortizing the mutex when the queue is deep
+        static const size_t kMaxChunk = 8;
+
         // Worker thread
         class Worker : boost::noncopyable {
         public:
@@ -39,44 +43,46 @@ namespace mongo {
             // destructor will block until current operation is completed
             // Acts as a "join" on this thread
             ~Worker() {
-                _task.put(Task());
+                _chunk.put(TaskChunk());
                 _thread.join();
             }
 
-            void set_task(Task& func) {
-                verify(!func.empty());
+            void set_tasks(TaskChunk& chunk) {
+                verify(!chunk.empty());
                 verify(_is_done);
                 _is_done = false;
 
-                _task.put(func);
+                _chunk.put(chunk);
             }
 
         private:
             ThreadPool& _owner;
-            MVar<Task> _task;
+            MVar<TaskChunk> _chunk;
             bool _is_done; // only used for error detection
             boost::thread _thread;
 
             void loop() {
                 while (true) {
-                    Task task = _task.take();
-                    if (task.empty())
+                    TaskChunk chunk = _chunk.take();
+                    if (chunk.empty())
                         break; // ends the thread
 
-                    try {
-                        task();
-                    }
-                    catch (DBException& e) {
-                        log() << "Unhandled DBException: " << e.toString() << endl;
-                    }
-                    catch (std::exception& e) {
-                        log() << "Unhandled std::exception in worker thread: " << e.what() << endl;;
-                    }
-                    catch (...) {
-                        log() << "Unhandled non-exception in worker thread" << endl;
+                    for (TaskChunk::iterator it = chunk.begin(); it != chunk.end(); ++it) {
+                        try {
+                            (*it)();
+                        }
+                        catch (DBException& e) {
+                            log() << "Unhandled DBException: " << e.toString() << endl;
+                        }
+                        catch (std::exception& e) {
+                            log() << "Unhandled std::exception in worker thread: " << e.what() << endl;;
+                        }
+                        catch (...) {
+                            log() << "Unhandled non-exception in worker thread" << endl;
+                        }
                     }
                     _is_done = true;
-                    _owner.task_done(this);
+                    _owner.task_done(this, chunk.size());
                 }
             }
         };
@@ -116,29 +122,61 @@ namespace mongo {
             scoped_lock lock(_mutex);
 
             _tasksRemaining++;
+            _tasks.push_back(task);
 
-            if (!_freeWorkers.empty()) {
-                _freeWorkers.front()->set_task(task);
-                _freeWorkers.pop_front();
+            _dispatchFree_inlock();
+        }
+
+        void ThreadPool::schedule_batch(const std::vector<Task>& tasks) {
+            if (tasks.empty())
+                return;
+
+            scoped_lock lock(_mutex);
+
+            _tasksRemaining += tasks.size();
+            for (size_t i = 0; i < tasks.size(); i++) {
+                verify(!tasks[i].empty());
+                _tasks.push_back(tasks[i]);
             }
-            else {
-                _tasks.push_back(task);
+
+            _dispatchFree_inlock();
+        }
+
+        TaskChunk ThreadPool::_takeChunk_inlock() {
+            // spread tasks out while the queue is shallow, chunk them up once it's deep
+            size_t n = 1 + _tasks.size() / _nThreads;
+            if (n > kMaxChunk)
+                n = kMaxChunk;
+
+            TaskChunk chunk;
+            for (size_t i = 0; i < n && !_tasks.empty(); i++) {
+                chunk.push_back(_tasks.front());
+                _tasks.pop_front();
+            }
+            return chunk;
+        }
+
+        void ThreadPool::_dispatchFree_inlock() {
+            while (!_freeWorkers.empty() && !_tasks.empty()) {
+                TaskChunk chunk = _takeChunk_inlock();
+                _freeWorkers.front()->set_tasks(chunk);
+                _freeWorkers.pop_front();
             }
         }
 
         // should only be called by a worker from the worker thread
-        void ThreadPool::task_done(Worker* worker) {
+        void ThreadPool::task_done(Worker* worker, int nDone) {
             scoped_lock lock(_mutex);
 
             if (!_tasks.empty()) {
-                worker->set_task(_tasks.front());
-                _tasks.pop_front();
+                TaskChunk chunk = _takeChunk_inlock();
+                worker->set_tasks(chunk);
             }
             else {
                 _freeWorkers.push_front(worker);
             }
 
-            _tasksRemaining--;
+            _tasksRemaining -= nDone;
 
             if(_tasksRemaining == 0)
                 _condition.notify_all();
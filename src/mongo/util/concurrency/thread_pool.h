@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include <deque>
 #include <list>
+#include <vector>
 
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
@@ -32,6 +34,10 @@ namespace mongo {
 
         typedef boost::function<void(void)> Task; //nullary function or functor
 
+        // tasks are handed to workers a chunk at a time so that a busy pool takes the
+        // pool-wide mutex once per chunk instead of once per task
+        typedef std::deque<Task> TaskChunk;
+
         // exported to the mongo namespace
         class ThreadPool : boost::noncopyable {
         public:
@@ -49,6 +55,11 @@ namespace mongo {
             // task will be copied a few times so make sure it's relatively cheap
             void schedule(Task task);
 
+            // enqueues a whole vector of tasks with a single synchronization; use this
+            // when fanning a batch out so the producer isn't reacquiring the pool mutex
+            // once per task
+            void schedule_batch(const std::vector<Task>& tasks);
+
             // Helpers that wrap schedule and boost::bind.
             // Functor and args will be copied a few times so make sure it's relatively cheap
             template<typename F, typename A>
@@ -71,10 +82,14 @@ namespace mongo {
             std::list<Worker*> _freeWorkers; //used as LIFO stack (always front)
             std::list<Task> _tasks; //used as FIFO queue (push_back, pop_front)
             int _tasksRemaining; // in queue + currently processing
-            int _nThreads; // only used for sanity checking. could be removed in the future.
+            int _nThreads; // sanity checking and chunk sizing
+
+            // these two expect _mutex to be held
+            TaskChunk _takeChunk_inlock();
+            void _dispatchFree_inlock();
 
             // should only be called by a worker from the worker's thread
-            void task_done(Worker* worker);
+            void task_done(Worker* worker, int nDone);
             friend class Worker;
         };
 
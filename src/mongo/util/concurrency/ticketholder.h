@@ -23,30 +23,55 @@ namespace mongo {
 
     class TicketHolder {
     public:
-        TicketHolder( int num ) : _mutex("TicketHolder") {
+        /** Low-priority acquirers defer to normal ones: they only get a ticket when no
+            normal-priority waiter is queued and more than the reserved number of
+            tickets is still available.  Use PRIORITY_LOW for background work that
+            shouldn't starve interactive traffic when the holder is saturated.
+        */
+        enum Priority {
+            PRIORITY_NORMAL = 0,
+            PRIORITY_LOW = 1
+        };
+
+        TicketHolder( int num, int lowPriorityReserve = 0 ) : _mutex("TicketHolder") {
             _outof = num;
             _num = num;
+            _lowPriorityReserve = lowPriorityReserve;
+            _queuedNormal = 0;
+            _queuedLow = 0;
         }
 
-        bool tryAcquire() {
+        bool tryAcquire( Priority p = PRIORITY_NORMAL ) {
             scoped_lock lk( _mutex );
-            return _tryAcquire();
+            return _tryAcquire( p );
         }
 
-        void waitForTicket() {
+        void waitForTicket( Priority p = PRIORITY_NORMAL ) {
             scoped_lock lk( _mutex );
 
-            while( ! _tryAcquire() ) {
+            int& queued = p == PRIORITY_LOW ? _queuedLow : _queuedNormal;
+            queued++;
+            while( ! _tryAcquire( p ) ) {
                 _newTicket.wait( lk.boost() );
             }
+            queued--;
         }
 
         void release() {
+            bool mixedWaiters;
             {
                 scoped_lock lk( _mutex );
                 _num++;
+                mixedWaiters = _queuedNormal > 0 && _queuedLow > 0;
+            }
+            if ( mixedWaiters ) {
+                // a single notify could land on a low-priority waiter that then defers
+                // to a still-sleeping normal one; wake everyone and let them sort it out
+                _newTicket.notify_all();
+            }
+            else {
+                _newTicket.notify_one();
             }
-            _newTicket.notify_one();
         }
 
         void resize( int newSize ) {
@@ -77,21 +102,38 @@ namespace mongo {
 
         int outof() const { return _outof; }
 
+        /** queue depths; approximate as they are read without the lock */
+        int queuedNormal() const { return _queuedNormal; }
+        int queuedLow() const { return _queuedLow; }
+
+        void setLowPriorityReserve( int n ) {
+            scoped_lock lk( _mutex );
+            _lowPriorityReserve = n;
+        }
+
     private:
 
-        bool _tryAcquire(){
+        bool _tryAcquire( Priority p = PRIORITY_NORMAL ){
             if ( _num <= 0 ) {
                 if ( _num < 0 ) {
                     std::cerr << "DISASTER! in TicketHolder" << std::endl;
                 }
                 return false;
             }
+            if ( p == PRIORITY_LOW ) {
+                // stand aside for queued normal-priority work and keep some headroom
+                if ( _queuedNormal > 0 || _num <= _lowPriorityReserve )
+                    return false;
+            }
             _num--;
             return true;
         }
 
         int _outof;
         int _num;
+        int _lowPriorityReserve;
+        int _queuedNormal;
+        int _queuedLow;
         mongo::mutex _mutex;
         boost::condition_variable_any _newTicket;
     };
@@ -0,0 +1,98 @@
+// crc32c.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/util/crc32c.h"
+
+#include "mongo/base/init.h"
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define MONGO_CRC32C_HAVE_SSE42
+#include <cpuid.h>
+#endif
+
+namespace mongo {
+
+    namespace {
+
+        unsigned crcTable[256];
+        bool useHardwareCrc = false;
+
+        MONGO_INITIALIZER( Crc32cInit )( InitializerContext* context ) {
+            // reflected Castagnoli polynomial
+            for ( unsigned i = 0; i < 256; i++ ) {
+                unsigned crc = i;
+                for ( int k = 0; k < 8; k++ )
+                    crc = ( crc >> 1 ) ^ ( 0x82F63B78U & ( 0U - ( crc & 1 ) ) );
+                crcTable[i] = crc;
+            }
+#if defined(MONGO_CRC32C_HAVE_SSE42)
+            unsigned a, b, c, d;
+            if ( __get_cpuid( 1, &a, &b, &c, &d ) )
+                useHardwareCrc = ( c & ( 1U << 20 ) ) != 0; // SSE4.2 feature bit
+#endif
+            return Status::OK();
+        }
+
+#if defined(MONGO_CRC32C_HAVE_SSE42)
+        unsigned hardwareCrc( unsigned crc, const unsigned char* p, size_t len ) {
+#if defined(__x86_64__)
+            unsigned long long c = crc;
+            while ( len >= 8 ) {
+                __asm__( "crc32q %1, %0" : "+r"(c) : "m"( *(const unsigned long long*)p ) );
+                p += 8;
+                len -= 8;
+            }
+            crc = (unsigned)c;
+#endif
+            while ( len > 0 ) {
+                __asm__( "crc32b %1, %0" : "+r"(crc) : "m"( *p ) );
+                p++;
+                len--;
+            }
+            return crc;
+        }
+#endif
+
+        unsigned softwareCrc( unsigned crc, const unsigned char* p, size_t len ) {
+            while ( len > 0 ) {
+                crc = crcTable[ ( crc ^ *p++ ) & 0xFF ] ^ ( crc >> 8 );
+                len--;
+            }
+            return crc;
+        }
+
+    }
+
+    unsigned crc32c( unsigned crc, const void* data, size_t len ) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>( data );
+        unsigned c = ~crc;
+#if defined(MONGO_CRC32C_HAVE_SSE42)
+        if ( useHardwareCrc )
+            c = hardwareCrc( c, p, len );
+        else
+            c = softwareCrc( c, p, len );
+#else
+        c = softwareCrc( c, p, len );
+#endif
+        return ~c;
+    }
+
+    unsigned crc32c( const void* data, size_t len ) {
+        return crc32c( 0, data, len );
+    }
+
+}
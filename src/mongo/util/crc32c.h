@@ -0,0 +1,33 @@
+// crc32c.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace mongo {
+
+    /**
+     * CRC32C (Castagnoli polynomial).  Uses the SSE4.2 crc32 instruction when the
+     * cpu has it (checked once at startup), a table-driven fallback otherwise.
+     */
+    unsigned crc32c( const void* data, size_t len );
+
+    /** incremental form; feed the previous result back in as 'crc' (start with 0) */
+    unsigned crc32c( unsigned crc, const void* data, size_t len );
+
+}
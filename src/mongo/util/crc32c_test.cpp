@@ -0,0 +1,44 @@
+// crc32c_test.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/unittest/unittest.h"
+
+#include <cstring>
+
+#include "mongo/util/crc32c.h"
+
+namespace {
+
+    using mongo::crc32c;
+
+    TEST( Crc32c, KnownVectors ) {
+        // from rfc 3720 (iSCSI) test patterns
+        ASSERT_EQUALS( 0xE3069283U, crc32c( "123456789", 9 ) );
+        unsigned char zeros[32];
+        memset( zeros, 0, sizeof( zeros ) );
+        ASSERT_EQUALS( 0x8A9136AAU, crc32c( zeros, sizeof( zeros ) ) );
+    }
+
+    TEST( Crc32c, Incremental ) {
+        const char* s = "the quick brown fox jumps over the lazy dog";
+        const size_t n = strlen( s );
+        unsigned whole = crc32c( s, n );
+        unsigned split = crc32c( crc32c( s, 7 ), s + 7, n - 7 );
+        ASSERT_EQUALS( whole, split );
+    }
+
+} // unnamed namespace
@@ -58,6 +58,11 @@ namespace mongo {
         return false;
     }
 
+    bool ElapsedTracker::nearInterval() const {
+        return ( ( _pings + 1 ) % _hitsBetweenMarks ) == 0 ||
+               Listener::getElapsedTimeMillis() - _last > _msBetweenMarks;
+    }
+
     void ElapsedTracker::resetLastTime() {
         _last = Listener::getElapsedTimeMillis();
     }
@@ -45,6 +45,12 @@ namespace mongo {
          */
         bool intervalHasElapsed();
 
+        /**
+         * Non-mutating peek: true if the next intervalHasElapsed() call would trigger.
+         * Doesn't count as an iteration and doesn't advance the marks.
+         */
+        bool nearInterval() const;
+
         void resetLastTime();
         
     private:
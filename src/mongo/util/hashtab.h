@@ -25,6 +25,7 @@
 #include "mongo/pch.h"
 #include <map>
 #include "../db/dur.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
@@ -59,6 +60,30 @@ namespace mongo {
             return nodes[i];
         }
 
+        /* in-memory cache of hash -> bucket index, in front of the mmap'd table.
+           the nodes are large (628 bytes), so a probe chain touches several cold
+           cache lines (or pages); with the cache a repeat lookup verifies a single
+           node.  entries are hints only -- a slot is trusted after re-checking the
+           node's hash and key, so collisions and staleness just fall back to the
+           regular probe.  each entry is one atomic word (hash in the high half,
+           slot in the low), making the cache safe for concurrent readers: get()
+           runs under a shared lock.  zero means empty (Key::hash() is > 0).
+        */
+        enum { CacheSize = 8192 }; // power of two; 64KB
+        AtomicInt64 _cacheEntries[CacheSize];
+
+        static unsigned cacheIndex(int h) { return ((unsigned) h) & (CacheSize-1); }
+        void cacheStore(int h, int slot) {
+            _cacheEntries[cacheIndex(h)].store( (((long long)h) << 32) | (unsigned)slot );
+        }
+        /** @return slot for h, or -1 if not cached */
+        int cacheLookup(int h) {
+            long long e = _cacheEntries[cacheIndex(h)].load();
+            if ( (int)(e >> 32) == h )
+                return (int)(unsigned) e;
+            return -1;
+        }
+
         int _find(const Key& k, bool& found) {
             found = false;
             int h = k.hash();
@@ -111,13 +136,24 @@ namespace mongo {
                 verify( sizeof(Node) == 628 );
             }
 
+            for ( int i = 0; i < CacheSize; i++ )
+                _cacheEntries[i].store(0);
         }
 
         Type* get(const Key& k) {
+            const int h = k.hash();
+            int slot = cacheLookup(h);
+            if ( slot >= 0 && slot < n ) {
+                Node& node = nodes(slot);
+                if ( node.hash == h && node.k == k )
+                    return &node.value;
+            }
             bool found;
             int i = _find(k, found);
-            if ( found )
+            if ( found ) {
+                cacheStore(h, i);
                 return &nodes(i).value;
+            }
             return 0;
         }
 
@@ -125,6 +161,7 @@ namespace mongo {
             bool found;
             int i = _find(k, found);
             if ( i >= 0 && found ) {
+                _cacheEntries[cacheIndex(k.hash())].store(0);
                 Node* n = &nodes(i);
                 n = getDur().writing(n);
                 n->k.kill();
@@ -147,6 +184,7 @@ namespace mongo {
                 verify( n->hash == k.hash() );
             }
             n->value = value;
+            cacheStore(k.hash(), i);
             return true;
         }
 
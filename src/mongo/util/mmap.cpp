@@ -27,6 +27,7 @@
 #include "mongo/util/processinfo.h"
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/startup_test.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -150,6 +151,53 @@ namespace {
         return x;
     }
 
+    /*static*/ int MongoFile::flushAllStaggered( int pauseMillis ) {
+        notifyPreFlush();
+
+        // synchronous flush, one file at a time as in _flushAll(true), but dirtiest file
+        // first and with a pause between files so the writeback is spread over the cycle
+        // instead of saturating the device (which the journal may share) in one burst.
+        //
+        // note we flush every file, even ones that look clean -- journal rotation after
+        // notifyPostFlush assumes everything made it to disk, so skipping a file whose
+        // dirty estimate raced to zero would be unsafe.  we only reorder and pace.
+        set<MongoFile*> seen;
+        while ( true ) {
+            auto_ptr<Flushable> f;
+            {
+                LockMongoFilesShared lk;
+                MongoFile * dirtiest = 0;
+                unsigned long long dirtiestBytes = 0;
+                for ( set<MongoFile*>::iterator i = mmfiles.begin(); i != mmfiles.end(); i++ ) {
+                    MongoFile * mmf = *i;
+                    if ( ! mmf )
+                        continue;
+                    if ( seen.count( mmf ) )
+                        continue;
+                    unsigned long long d = mmf->dirtyEstimateBytes();
+                    if ( dirtiest == 0 || d > dirtiestBytes ) {
+                        dirtiest = mmf;
+                        dirtiestBytes = d;
+                    }
+                }
+                if ( dirtiest ) {
+                    f.reset( dirtiest->prepareFlush() );
+                    seen.insert( dirtiest );
+                }
+            }
+            if ( ! f.get() )
+                break;
+
+            if ( seen.size() > 1 && pauseMillis > 0 )
+                sleepmillis( pauseMillis );
+
+            f->flushPaced( pauseMillis );
+        }
+
+        notifyPostFlush();
+        return seen.size();
+    }
+
     /*static*/ int MongoFile::_flushAll( bool sync ) {
         if ( ! sync ) {
             int num = 0;
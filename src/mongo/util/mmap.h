@@ -24,13 +24,18 @@ namespace mongo {
     extern const size_t g_minOSPageSizeBytes;
     void minOSPageSizeBytesTest(size_t minOSPageSizeBytes);  // lame-o
 
-    class MAdvise { 
+    class MAdvise {
         void *_p;
         unsigned _len;
     public:
-        enum Advice { Sequential=1 , Random=2 };
-        MAdvise(void *p, unsigned len, Advice a); 
+        enum Advice { Sequential=1 , Random=2 , Normal=3 , DontNeed=4 };
+        MAdvise(void *p, unsigned len, Advice a);
         ~MAdvise(); // destructor resets the range to MADV_NORMAL
+
+        /** one-shot, sticky form: applies the advice to the range and leaves it in
+            place (no reset on scope exit).  DontNeed additionally tells the kernel
+            the resident pages can be reclaimed now. */
+        static void advise(void *p, unsigned long long len, Advice a);
     };
 
     // lock order: lock dbMutex before this if you lock both
@@ -70,13 +75,19 @@ namespace mongo {
         public:
             virtual ~Flushable() {}
             virtual void flush() = 0;
+            /** like flush() but, where the platform supports it, flushes in bounded
+                slices with a pause of 'pauseMillis' between them so one big file
+                doesn't saturate the device in a single burst. */
+            virtual void flushPaced( int pauseMillis ) { flush(); }
         };
 
         virtual ~MongoFile() {}
 
         enum Options {
             SEQUENTIAL = 1, // hint - e.g. FILE_FLAG_SEQUENTIAL_SCAN on windows
-            READONLY = 2    // not contractually guaranteed, but if specified the impl has option to fault writes
+            READONLY = 2,   // not contractually guaranteed, but if specified the impl has option to fault writes
+            PRIVATE = 4     // copy-on-write: modified pages become anonymous memory and are
+                            // never written back; the file only supplies initial contents
         };
 
         /** @param fun is called for each MongoFile.
@@ -94,6 +105,10 @@ namespace mongo {
         static void (*notifyPostFlush)();
 
         static int flushAll( bool sync ); // returns n flushed
+        /** synchronous flush of all files like flushAll(true), but dirtiest file first,
+            in paced slices with 'pauseMillis' gaps, so the periodic background flush
+            doesn't monopolize the device the journal also lives on.  @return n flushed */
+        static int flushAllStaggered( int pauseMillis );
         static long long totalMappedLength();
         static void closeAllFiles( stringstream &message );
 
@@ -114,6 +129,13 @@ namespace mongo {
          */
         virtual Flushable * prepareFlush() = 0;
 
+        /**
+         * estimated bytes written to the file since it was last flushed; used to order
+         * background flushes dirtiest-first.  the default pessimistically assumes the
+         * whole file may be dirty.
+         */
+        virtual unsigned long long dirtyEstimateBytes() const { return length(); }
+
         void created(); /* subclass must call after create */
 
         /* subclass must call in destructor (or at close).
@@ -206,6 +228,7 @@ namespace mongo {
         HANDLE maphandle;
         vector<void *> views;
         unsigned long long len;
+        int _options; // Options bits this file was mapped with; flushing is a no-op for PRIVATE
         
 #ifdef _WIN32
         boost::shared_ptr<mutex> _flushMutex;
@@ -221,6 +244,13 @@ namespace mongo {
 
         /** close the current private view and open a new replacement */
         void* remapPrivateView(void *oldPrivateAddr);
+
+        /** as remapPrivateView() but only replaces [offset, offset+length) of the view.
+            offset is rounded down to a page boundary (and length grown to match).
+            POSIX only; Windows and Solaris can only replace the whole view.
+            @return the private view address (unchanged)
+        */
+        void* remapPrivateViewRange(void *oldPrivateAddr, size_t offset, size_t length);
     };
 
     /** p is called from within a mutex that MongoFile uses.  so be careful not to deadlock. */
@@ -27,7 +27,9 @@
 #include "mongo/util/file_allocator.h"
 #include "mongo/util/mmap.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/numa.h"
 #include "mongo/util/processinfo.h"
+#include "mongo/util/time_support.h"
 
 using namespace mongoutils;
 
@@ -43,6 +45,7 @@ namespace mongo {
         fd = 0;
         maphandle = 0;
         len = 0;
+        _options = 0;
         created();
     }
 
@@ -70,6 +73,7 @@ namespace mongo {
 #if defined(__sunos__)
     MAdvise::MAdvise(void *,unsigned, Advice) { }
     MAdvise::~MAdvise() { }
+    void MAdvise::advise(void *, unsigned long long, Advice) { }
 #else
     MAdvise::MAdvise(void *p, unsigned len, Advice a) {
         
@@ -89,9 +93,29 @@ namespace mongo {
         }
         
     }
-    MAdvise::~MAdvise() { 
+    MAdvise::~MAdvise() {
         madvise(_p,_len,MADV_NORMAL);
     }
+
+    void MAdvise::advise(void *p, unsigned long long len, Advice a) {
+
+        void* aligned = (void*)((long)p & ~(g_minOSPageSizeBytes-1));
+
+        len += (unsigned long long)p - (unsigned long long)aligned;
+
+        int advice = 0;
+        switch ( a ) {
+        case Sequential: advice = MADV_SEQUENTIAL; break;
+        case Random:     advice = MADV_RANDOM;     break;
+        case Normal:     advice = MADV_NORMAL;     break;
+        case DontNeed:   advice = MADV_DONTNEED;   break;
+        default: verify(0);
+        }
+
+        if ( madvise(aligned, len, advice) ) {
+            error() << "madvise failed: " << errnoWithDescription() << endl;
+        }
+    }
 #endif
 
     void* MemoryMappedFile::map(const char *filename, unsigned long long &length, int options) {
@@ -113,7 +137,16 @@ namespace mongo {
         uassert(10447,  str::stream() << "map file alloc failed, wanted: " << length << " filelen: " << filelen << ' ' << sizeof(size_t), filelen == length );
         lseek( fd, 0, SEEK_SET );
 
-        void * view = mmap(NULL, length, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+        _options = options;
+
+        int mapFlags = MAP_SHARED;
+        if ( options & PRIVATE ) {
+            // copy-on-write: dirty pages are anonymous memory and are never written
+            // back; the file on disk only supplies the (zeroed) initial contents
+            mapFlags = MAP_PRIVATE | MAP_NORESERVE;
+        }
+
+        void * view = mmap(NULL, length, PROT_READ|PROT_WRITE, mapFlags, fd, 0);
         if ( view == MAP_FAILED ) {
             error() << "  mmap() failed for " << filename << " len:" << length << " " << errnoWithDescription() << endl;
             if ( errno == ENOMEM ) {
@@ -136,6 +169,13 @@ namespace mongo {
         }
 #endif
 
+        // Interleave the datafile's pages across the NUMA nodes before anything
+        // faults them in, so a busy file does not end up entirely on whichever node
+        // first touched it.  The private (journal) views are left on the default
+        // local policy: their copy-on-write pages are written by the faulting
+        // thread and are best kept next to it.
+        numaInterleaveMemory( view, length );
+
         views.push_back( view );
 
         return view;
@@ -195,9 +235,34 @@ namespace mongo {
         return x;
     }
 
+    void* MemoryMappedFile::remapPrivateViewRange(void *oldPrivateAddr, size_t offset, size_t length) {
+        // mmap file offsets must be page aligned
+        const size_t alignedOfs = offset & ~(g_minOSPageSizeBytes - 1);
+        length += offset - alignedOfs;
+        if( alignedOfs + length > (size_t) len )
+            length = len - alignedOfs;
+
+        void *addr = ((char*)oldPrivateAddr) + alignedOfs;
+
+        // don't unmap, just mmap over the old region
+        void * x = mmap( addr, length, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_NORESERVE|MAP_FIXED,
+                         fd, alignedOfs );
+        if( x == MAP_FAILED ) {
+            int err = errno;
+            error()  << "13601 Couldn't remap private view: " << errnoWithDescription(err) << endl;
+            log() << "aborting" << endl;
+            printMemInfo();
+            abort();
+        }
+        verify( x == addr );
+        return oldPrivateAddr;
+    }
+
     void MemoryMappedFile::flush(bool sync) {
         if ( views.empty() || fd == 0 )
             return;
+        if ( _options & PRIVATE )
+            return; // copy-on-write mapping - there is nothing on disk to make durable
         if ( msync(viewForFlushing(), len, sync ? MS_SYNC : MS_ASYNC) )
             problem() << "msync " << errnoWithDescription() << endl;
     }
@@ -215,12 +280,36 @@ namespace mongo {
 
         }
 
+        void flushPaced( int pauseMillis ) {
+            if ( _view == 0 || _fd == 0 )
+                return;
+
+            // slice the msync so a large file doesn't issue all its writeback at once;
+            // a short sleep between slices lets journal and foreground I/O interleave.
+            const long sliceBytes = 256 * 1024 * 1024; // multiple of any page size
+            char * p = static_cast<char*>( _view );
+            long remaining = _len;
+            while ( remaining > 0 ) {
+                long n = remaining < sliceBytes ? remaining : sliceBytes;
+                if ( msync(p, n, MS_SYNC) ) {
+                    problem() << "msync " << errnoWithDescription() << endl;
+                    return;
+                }
+                p += n;
+                remaining -= n;
+                if ( remaining > 0 && pauseMillis > 0 )
+                    sleepmillis( pauseMillis );
+            }
+        }
+
         void * _view;
         HANDLE _fd;
         long _len;
     };
 
     MemoryMappedFile::Flushable * MemoryMappedFile::prepareFlush() {
+        if ( _options & PRIVATE )
+            return new PosixFlushable( 0 , 0 , 0 ); // nothing to flush for copy-on-write mappings
         return new PosixFlushable( viewForFlushing() , fd , len );
     }
 
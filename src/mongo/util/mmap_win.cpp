@@ -42,6 +42,7 @@ namespace mongo {
 
     MAdvise::MAdvise(void *,unsigned, Advice) { }
     MAdvise::~MAdvise() { }
+    void MAdvise::advise(void *, unsigned long long, Advice) { }
 
     static unsigned long long _nextMemoryMappedFileLocation = 256LL * 1024LL * 1024LL * 1024LL;
     static SimpleMutex _nextMemoryMappedFileLocationMutex( "nextMemoryMappedFileLocationMutex" );
@@ -76,6 +77,7 @@ namespace mongo {
         fd = 0;
         maphandle = 0;
         len = 0;
+        _options = 0;
         created();
     }
 
@@ -191,7 +193,10 @@ namespace mongo {
         void *view = 0;
         {
             scoped_lock lk(mapViewMutex);
-            DWORD access = ( options & READONLY ) ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS;
+            _options = options;
+            DWORD access = ( options & READONLY ) ? FILE_MAP_READ :
+                           ( options & PRIVATE ) ? FILE_MAP_COPY : // copy-on-write
+                                                   FILE_MAP_ALL_ACCESS;
             LPVOID thisAddress = getNextMemoryMappedFileLocation( length );
             view = MapViewOfFileEx(
                     maphandle,      // file mapping handle
@@ -394,6 +399,8 @@ namespace mongo {
 
     void MemoryMappedFile::flush(bool sync) {
         uassert(13056, "Async flushing not supported on windows", sync);
+        if ( _options & PRIVATE )
+            return; // copy-on-write mapping - there is nothing on disk to make durable
         if( !views.empty() ) {
             WindowsFlushable f( viewForFlushing() , fd , filename() , _flushMutex);
             f.flush();
@@ -401,7 +408,9 @@ namespace mongo {
     }
 
     MemoryMappedFile::Flushable * MemoryMappedFile::prepareFlush() {
-        return new WindowsFlushable( viewForFlushing() , fd , filename() , _flushMutex );
+        // a null view makes the flush a no-op for copy-on-write mappings
+        void* view = ( _options & PRIVATE ) ? 0 : viewForFlushing();
+        return new WindowsFlushable( view , fd , filename() , _flushMutex );
     }
 
 }
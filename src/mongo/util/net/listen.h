@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "mongo/platform/atomic_word.h"
+#include "mongo/util/coarse_ticker.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/sock.h"
@@ -67,6 +68,9 @@ namespace mongo {
         }
 
         static long long getElapsedTimeMillis() {
+            if ( coarseTickerRunning() )
+                return coarseTickerElapsedMillis();
+
             if ( _timeTracker )
                 return _timeTracker->getMyElapsedTimeMillis();
 
@@ -104,6 +104,21 @@ namespace mongo {
     };
 #pragma pack()
 
+    /* MsgData::_flags bit: a 4 byte CRC32C of the message body (every byte after
+       the header) is appended at the end of the message and included in len.
+       Verified and stripped by MessagingPort::recv(); older peers never set it. */
+    const char MessageFlagCrc32c = 1;
+
+    /* MsgData::_flags bit: the message body is one snappy block; len is the
+       compressed size.  Decompressed and stripped by MessagingPort::recv().
+       Only ever set toward a peer that announced MessageFlagAcceptSnappy. */
+    const char MessageFlagSnappy = 2;
+
+    /* MsgData::_flags bit: the sender can decompress snappy message bodies, so
+       replies to it may set MessageFlagSnappy.  Older peers ignore _flags, so
+       announcing this to them is harmless; they just reply uncompressed. */
+    const char MessageFlagAcceptSnappy = 4;
+
 #pragma pack(1)
     /* todo merge this with MSGHEADER (or inherit from it). */
     struct MsgData {
@@ -121,6 +136,15 @@ namespace mongo {
             _version = 0;
             _operation = o;
         }
+        bool hasCrc32c() const {
+            return ( _flags & MessageFlagCrc32c ) != 0;
+        }
+        bool hasSnappy() const {
+            return ( _flags & MessageFlagSnappy ) != 0;
+        }
+        bool acceptsSnappy() const {
+            return ( _flags & MessageFlagAcceptSnappy ) != 0;
+        }
         char _data[4];
 
         int& dataAsInt() {
@@ -23,6 +23,8 @@
 #include <time.h>
 
 #include "mongo/util/background.h"
+#include "mongo/util/compress.h"
+#include "mongo/util/crc32c.h"
 #include "mongo/util/goodies.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/message.h"
@@ -44,6 +46,9 @@ namespace mongo {
 // if you want trace output:
 #define mmm(x)
 
+    // below this, the bytes saved by compressing a message don't pay for the cpu
+    const int MinMessageBytesToCompress = 1024;
+
     void AbstractMessagingPort::setConnectionId( long long connectionId ) { 
         verify( _connectionId == 0 );
         _connectionId = connectionId; 
@@ -123,19 +128,19 @@ namespace mongo {
         ports.closeAll(mask);
     }
 
-    MessagingPort::MessagingPort(int fd, const SockAddr& remote) 
-        : psock( new Socket( fd , remote ) ) , piggyBackData(0) {
+    MessagingPort::MessagingPort(int fd, const SockAddr& remote)
+        : psock( new Socket( fd , remote ) ) , piggyBackData(0), _sendChecksums(false), _sendCompressed(false) {
         ports.insert(this);
     }
 
-    MessagingPort::MessagingPort( double timeout, logger::LogSeverity ll ) 
-        : psock( new Socket( timeout, ll ) ) {
+    MessagingPort::MessagingPort( double timeout, logger::LogSeverity ll )
+        : psock( new Socket( timeout, ll ) ), _sendChecksums(false), _sendCompressed(false) {
         ports.insert(this);
         piggyBackData = 0;
     }
 
     MessagingPort::MessagingPort( boost::shared_ptr<Socket> sock )
-        : psock( sock ), piggyBackData( 0 ) {
+        : psock( sock ), piggyBackData( 0 ), _sendChecksums(false), _sendCompressed(false) {
         ports.insert(this);
     }
 
@@ -212,6 +217,59 @@ again:
 
             psock->recv( (char *)&md->_data, left );
 
+            if ( md->hasCrc32c() ) {
+                // trailing 4 byte CRC32C over the body; verify, then strip it so
+                // the rest of the server sees an ordinary message
+                if ( left < 4 ) {
+                    LOG(0) << "recv(): checksummed message too short, len " << len << endl;
+                    return false;
+                }
+                unsigned expected;
+                memcpy( &expected, (char *)&md->_data + left - 4, 4 );
+                const unsigned actual = crc32c( &md->_data, left - 4 );
+                if ( actual != expected ) {
+                    error() << "wire checksum mismatch from " << remote()
+                            << ", dropping connection" << endl;
+                    return false;
+                }
+                md->len -= 4;
+                md->_flags &= ~MessageFlagCrc32c;
+                // the peer wants integrity checking; reply in kind
+                _sendChecksums = true;
+            }
+
+            if ( md->acceptsSnappy() ) {
+                // the peer can decompress; start compressing large replies
+                _sendCompressed = true;
+            }
+
+            if ( md->hasSnappy() ) {
+                // body is one snappy block; decompress into a fresh message so
+                // the rest of the server sees an ordinary one
+                const int clen = md->len - MsgDataHeaderSize;
+                size_t ulen;
+                if ( clen <= 0 ||
+                     !uncompressedLength( (const char *)&md->_data, clen, &ulen ) ||
+                     ulen > (size_t)MaxMessageSizeBytes ) {
+                    error() << "bad compressed message from " << remote()
+                            << ", dropping connection" << endl;
+                    return false;
+                }
+                MsgData *umd = (MsgData *) malloc( MsgDataHeaderSize + ulen );
+                verify(umd);
+                memcpy( umd, md, MsgDataHeaderSize );
+                if ( !rawUncompress( (const char *)&md->_data, clen, umd->_data ) ) {
+                    free( umd );
+                    error() << "wire decompression failed from " << remote()
+                            << ", dropping connection" << endl;
+                    return false;
+                }
+                umd->len = MsgDataHeaderSize + (int)ulen;
+                umd->_flags &= ~MessageFlagSnappy;
+                m.setData(umd, true); // md freed by the guard
+                return true;
+            }
+
             guard.Dismiss();
             m.setData(md, true);
             return true;
@@ -271,6 +329,46 @@ again:
         toSend.header()->id = nextMessageId();
         toSend.header()->responseTo = responseTo;
 
+        if ( _sendCompressed ) {
+            // announce that we decompress, so the peer may compress toward us
+            toSend.header()->_flags |= MessageFlagAcceptSnappy;
+            if ( !toSend.header()->hasSnappy() && toSend.doIFreeIt() &&
+                 toSend.header()->len - MsgDataHeaderSize >= MinMessageBytesToCompress ) {
+                toSend.concat();
+                MsgData* md = toSend.singleData();
+                const int bodyLen = md->len - MsgDataHeaderSize;
+                MsgData* cmd = (MsgData*) malloc( MsgDataHeaderSize +
+                                                  maxCompressedLength( bodyLen ) );
+                verify(cmd);
+                memcpy( cmd, md, MsgDataHeaderSize );
+                size_t clen;
+                rawCompress( md->_data, bodyLen, cmd->_data, &clen );
+                if ( clen < (size_t) bodyLen ) {
+                    cmd->len = MsgDataHeaderSize + (int)clen;
+                    cmd->_flags |= MessageFlagSnappy;
+                    toSend.reset(); // frees the uncompressed buffer
+                    toSend.setData( cmd, true );
+                }
+                else {
+                    // incompressible; send as is
+                    free( cmd );
+                }
+            }
+        }
+
+        if ( _sendChecksums && !toSend.header()->hasCrc32c() && toSend.doIFreeIt() ) {
+            // append a CRC32C of the body and flag it; the peer verifies and
+            // strips it in recv().  Measured in the noise next to the send itself
+            // with sse4.2 hardware, so it is fine to leave on everywhere.
+            toSend.concat();
+            MsgData* md = toSend.singleData();
+            const unsigned crc = crc32c( md->_data, md->len - MsgDataHeaderSize );
+            char* trailer = (char*)malloc( 4 );
+            memcpy( trailer, &crc, 4 );
+            toSend.appendData( trailer, 4 ); // adjusts len
+            toSend.header()->_flags |= MessageFlagCrc32c;
+        }
+
         if ( piggyBackData && piggyBackData->len() ) {
             mmm( log() << "*     have piggy back" << endl; )
             if ( ( piggyBackData->len() + toSend.header()->len ) > 1300 ) {
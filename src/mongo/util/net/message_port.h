@@ -104,6 +104,29 @@ namespace mongo {
 
         void piggyBack( Message& toSend , int responseTo = 0 );
 
+        /**
+         * When true, say() appends a CRC32C of each outgoing message's body and
+         * flags it in the header (see MessageFlagCrc32c).  An initiating peer that
+         * wants wire integrity sets this explicitly; recv() turns it on
+         * automatically when a flagged message arrives, so replies echo the mode
+         * the requester chose.  That is the whole per-connection negotiation:
+         * older peers never set the flag and never see one.
+         */
+        void setSendChecksums( bool b ) { _sendChecksums = b; }
+        bool sendChecksums() const { return _sendChecksums; }
+
+        /**
+         * When true, say() announces MessageFlagAcceptSnappy on outgoing messages
+         * and snappy-compresses bodies large enough to be worth it (again flagged
+         * in the header).  Negotiated like checksums: an initiating peer sets this
+         * explicitly, and recv() turns it on when an announcing message arrives,
+         * so replies are compressed only toward peers that can decompress them.
+         * Meant for high-latency, bandwidth-bound links such as cross-datacenter
+         * replication; not worth the cpu on a local network.
+         */
+        void setSendCompressed( bool b ) { _sendCompressed = b; }
+        bool sendCompressed() const { return _sendCompressed; }
+
         unsigned remotePort() const { return psock->remotePort(); }
         virtual HostAndPort remote() const;
         virtual SockAddr remoteAddr() const;
@@ -140,9 +163,13 @@ namespace mongo {
         }
 
     private:
-        
+
         PiggyBackData * piggyBackData;
 
+        // see setSendChecksums()
+        bool _sendChecksums;
+        bool _sendCompressed;
+
         // this is the parsed version of remote
         // mutable because its initialized only on call to remote()
         mutable HostAndPort _remoteParsed; 
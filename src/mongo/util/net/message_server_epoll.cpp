@@ -0,0 +1,271 @@
+// message_server_epoll.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/pch.h"
+
+#ifdef USE_EPOLL_SERVER
+
+#ifndef __linux__
+#error "the epoll message server is linux only"
+#endif
+
+#include <sys/epoll.h>
+
+#include <boost/thread/thread.hpp>
+
+#include "mongo/db/lasterror.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/net/listen.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_port.h"
+#include "mongo/util/net/message_server.h"
+#include "mongo/util/processinfo.h"
+
+namespace mongo {
+
+    /**
+     * Event-driven alternative to PortMessageServer.  One event loop thread watches all
+     * client sockets with epoll; when a socket becomes readable the connection is handed
+     * to a fixed-size worker pool which reads one full message (MessagingPort::recv, so
+     * all the wire protocol handshake/validation logic is shared with the threaded
+     * server), processes it, sends the reply and re-arms the socket.
+     *
+     * An idle connection therefore costs a few hundred bytes of state rather than a
+     * dedicated 1MB-stack thread.  Each socket is registered EPOLLONESHOT so at most one
+     * worker ever touches a connection at a time and no per-connection locking is needed.
+     *
+     * Trade-off: a worker blocks while reading the remainder of a message whose first
+     * bytes have arrived, so a very slow writer can pin a worker for a while.  The pool
+     * is sized generously relative to cores to absorb that.
+     */
+    class EPollMessageServer : public MessageServer , public Listener {
+    public:
+        EPollMessageServer( const MessageServer::Options& opts, MessageHandler * handler ) :
+            Listener( "" , opts.ipList, opts.port ),
+            _handler(handler) {
+
+            _epollFd = epoll_create( 128 );
+            if ( _epollFd < 0 ) {
+                const int e = errno;
+                msgasserted( 17500, str::stream() << "epoll_create failed: "
+                                                  << errnoWithDescription(e) );
+            }
+        }
+
+        virtual ~EPollMessageServer() {
+            close( _epollFd );
+        }
+
+        virtual void acceptedMP(MessagingPort * p) {
+
+            if ( ! Listener::globalTicketHolder.tryAcquire() ) {
+                log() << "connection refused because too many open connections: " << Listener::globalTicketHolder.used() << endl;
+
+                p->shutdown();
+                delete p;
+
+                sleepmillis(2); // otherwise we'll hard loop
+                return;
+            }
+
+            p->psock->setLogLevel(logger::LogSeverity::Debug(1));
+
+            Connection* conn = new Connection( p );
+
+            try {
+                conn->otherSide = p->psock->remoteString();
+                _handler->connected( p );
+
+                struct epoll_event ev;
+                ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+                ev.data.ptr = conn;
+                if ( epoll_ctl( _epollFd, EPOLL_CTL_ADD, p->psock->rawFD(), &ev ) != 0 ) {
+                    const int e = errno;
+                    log() << "epoll_ctl failed adding new connection, closing it: "
+                          << errnoWithDescription(e) << endl;
+                    _handler->disconnected( p );
+                    Listener::globalTicketHolder.release();
+                    p->shutdown();
+                    delete conn;
+                }
+            }
+            catch ( ... ) {
+                Listener::globalTicketHolder.release();
+                log() << "unknown error accepting new socket" << endl;
+
+                p->shutdown();
+                delete conn;
+
+                sleepmillis(2);
+            }
+        }
+
+        virtual void setAsTimeTracker() {
+            Listener::setAsTimeTracker();
+        }
+
+        virtual void setupSockets() {
+            Listener::setupSockets();
+        }
+
+        void run() {
+            int nWorkers = 4 * ProcessInfo().getNumCores();
+            if ( nWorkers < 8 )
+                nWorkers = 8;
+            _workers.reset( new ThreadPool( nWorkers ) );
+
+            boost::thread eventThread( boost::bind( &EPollMessageServer::eventLoop, this ) );
+
+            initAndListen();
+        }
+
+        virtual bool useUnixSockets() const { return true; }
+
+    private:
+        /**
+         * Per-connection state.  Owns the port and the connection's LastError; the
+         * LastError is swapped into thread local storage around each process() call so
+         * getLastError keeps working even though consecutive requests on one connection
+         * may run on different worker threads.
+         */
+        struct Connection {
+            Connection( MessagingPort* p ) : port(p), le(new LastError()) {}
+            ~Connection() {
+                delete port;
+                delete le;
+            }
+
+            MessagingPort* port;
+            LastError* le;
+            string otherSide;
+        };
+
+        void eventLoop() {
+            setThreadName( "connEventLoop" );
+
+            const int MaxEvents = 64;
+            struct epoll_event events[MaxEvents];
+
+            while ( ! inShutdown() ) {
+                const int n = epoll_wait( _epollFd, events, MaxEvents, 500 /*ms*/ );
+                if ( n < 0 ) {
+                    if ( errno == EINTR )
+                        continue;
+                    const int e = errno;
+                    error() << "epoll_wait failed: " << errnoWithDescription(e) << endl;
+                    break;
+                }
+
+                for ( int i = 0; i < n; i++ ) {
+                    // errors and hangups are handled on a worker too: recv() will fail
+                    // there and the normal disconnect path runs
+                    Connection* conn = static_cast<Connection*>( events[i].data.ptr );
+                    _workers->schedule( boost::bind( &EPollMessageServer::processRequest,
+                                                     this, conn ) );
+                }
+            }
+        }
+
+        /** read one message off conn, dispatch it, and re-arm the socket. */
+        void processRequest( Connection* conn ) {
+            lastError.reset( conn->le ); // owned by conn; released below before returning
+
+            try {
+                Message m;
+                conn->port->psock->clearCounters();
+
+                if ( inShutdown() || ! conn->port->recv(m) ) {
+                    lastError.release();
+                    closeConnection( conn );
+                    return;
+                }
+
+                _handler->process( m , conn->port , conn->le );
+                networkCounter.hit( conn->port->psock->getBytesIn(),
+                                    conn->port->psock->getBytesOut() );
+            }
+            catch ( AssertionException& e ) {
+                log() << "AssertionException handling request, closing client connection: " << e << endl;
+                lastError.release();
+                closeConnection( conn );
+                return;
+            }
+            catch ( SocketException& e ) {
+                log() << "SocketException handling request, closing client connection: " << e << endl;
+                lastError.release();
+                closeConnection( conn );
+                return;
+            }
+            catch ( const DBException& e ) { // must be right above std::exception to avoid catching subclasses
+                log() << "DBException handling request, closing client connection: " << e << endl;
+                lastError.release();
+                closeConnection( conn );
+                return;
+            }
+            catch ( std::exception &e ) {
+                error() << "Uncaught std::exception: " << e.what() << ", terminating" << endl;
+                dbexit( EXIT_UNCAUGHT );
+            }
+
+            lastError.release();
+
+            struct epoll_event ev;
+            ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+            ev.data.ptr = conn;
+            if ( epoll_ctl( _epollFd, EPOLL_CTL_MOD, conn->port->psock->rawFD(), &ev ) != 0 ) {
+                const int e = errno;
+                log() << "epoll_ctl failed re-arming connection, closing it: "
+                      << errnoWithDescription(e) << endl;
+                closeConnection( conn );
+            }
+        }
+
+        /**
+         * Normal disconnect path.  Only ever runs on the single worker that holds the
+         * connection (EPOLLONESHOT), so the teardown cannot race a concurrent request.
+         */
+        void closeConnection( Connection* conn ) {
+            epoll_ctl( _epollFd, EPOLL_CTL_DEL, conn->port->psock->rawFD(), NULL );
+
+            if (!serverGlobalParams.quiet) {
+                int conns = Listener::globalTicketHolder.used()-1;
+                const char* word = (conns == 1 ? " connection" : " connections");
+                log() << "end connection " << conn->otherSide << " (" << conns << word << " now open)" << endl;
+            }
+
+            conn->port->shutdown();
+            _handler->disconnected( conn->port );
+            Listener::globalTicketHolder.release();
+            delete conn;
+        }
+
+        MessageHandler* _handler;
+        int _epollFd;
+        scoped_ptr<ThreadPool> _workers;
+    };
+
+
+    MessageServer * createServer( const MessageServer::Options& opts , MessageHandler * handler ) {
+        return new EPollMessageServer( opts , handler );
+    }
+
+}
+
+#endif // USE_EPOLL_SERVER
@@ -19,7 +19,7 @@
 
 #include <boost/thread/thread.hpp>
 
-#ifndef USE_ASIO
+#if !defined(USE_ASIO) && !defined(USE_EPOLL_SERVER)
 
 
 #include "mongo/db/lasterror.h"
@@ -19,6 +19,7 @@
 
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/tss.hpp>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -130,6 +131,11 @@ namespace mongo {
         SSLManagerInterface* theSSLManager = NULL;
         static const int BUFFER_SIZE = 8*1024;
 
+        // bounds for TLS session resumption caching
+        static const size_t MAX_CLIENT_SESSION_CACHE_SIZE = 256;  // one entry per remote host
+        static const long SERVER_SESSION_CACHE_SIZE = 1024;
+        static const long SESSION_CACHE_TIMEOUT_SECONDS = 300;
+
         struct Params {
             Params(const std::string& pemfile,
                    const std::string& pempwd,
@@ -199,6 +205,15 @@ namespace mongo {
         private:
             SSL_CTX* _serverContext;  // SSL context for incoming connections
             SSL_CTX* _clientContext;  // SSL context for outgoing connections
+
+            // Sessions from successful outgoing handshakes, keyed by remote
+            // host:port, so reconnects can resume instead of paying a full
+            // handshake.  The OpenSSL client-side cache stays disabled (it is
+            // not keyed by peer); this one is ours.
+            typedef std::map<std::string, SSL_SESSION*> ClientSessionCache;
+            SimpleMutex _clientSessionMtx;
+            ClientSessionCache _clientSessionCache;
+
             std::string _password;
             bool _validateCertificates;
             bool _weakValidation;
@@ -254,6 +269,19 @@ namespace mongo {
              */
             bool _doneWithSSLOp(SSLConnection* conn, int status);
 
+            /*
+             * Check out a cached session for this remote (if any) and attach it to
+             * the SSL object, so the handshake attempts resumption.  The entry is
+             * removed; a successful handshake puts the (possibly renewed) session
+             * back, a failed one leaves the next attempt with a full handshake.
+             */
+            void _checkOutClientSession(const std::string& remote, SSL* ssl);
+
+            /*
+             * Cache the session negotiated on this SSL object under the remote's key.
+             */
+            void _cacheClientSession(const std::string& remote, SSL* ssl);
+
             /*
              * Send and receive network data
              */
@@ -357,6 +385,7 @@ namespace mongo {
     SSLManagerInterface::~SSLManagerInterface() {}
 
     SSLManager::SSLManager(const Params& params, bool isServer) :
+        _clientSessionMtx("SSL Client Session Cache"),
         _validateCertificates(false),
         _weakValidation(params.weakCertificateValidation) {
 
@@ -416,6 +445,12 @@ namespace mongo {
         ERR_free_strings();
         EVP_cleanup();
 
+        for (ClientSessionCache::iterator it = _clientSessionCache.begin();
+             it != _clientSessionCache.end();
+             ++it) {
+            SSL_SESSION_free(it->second);
+        }
+
         if (NULL != _serverContext) {
             SSL_CTX_free(_serverContext);
         }
@@ -521,9 +556,25 @@ namespace mongo {
         // Note: this is for blocking sockets only.
         SSL_CTX_set_mode(*context, SSL_MODE_AUTO_RETRY);
 
-        // Disable session caching (see SERVER-10261)
-        SSL_CTX_set_session_cache_mode(*context, SSL_SESS_CACHE_OFF);
- 
+        if (context == &_serverContext) {
+            // Cache sessions on the server side so clients can resume instead of
+            // paying a full handshake on every reconnect.  The cache is bounded
+            // and entries expire, so reconnect storms can't grow it without limit.
+            SSL_CTX_set_session_cache_mode(*context, SSL_SESS_CACHE_SERVER);
+            SSL_CTX_sess_set_cache_size(*context, SERVER_SESSION_CACHE_SIZE);
+            SSL_CTX_set_timeout(*context, SESSION_CACHE_TIMEOUT_SECONDS);
+            static const unsigned char sessionIdContext[] = "mongodb";
+            SSL_CTX_set_session_id_context(*context,
+                                           sessionIdContext,
+                                           sizeof(sessionIdContext) - 1);
+        }
+        else {
+            // The internal client-side cache stays disabled (see SERVER-10261);
+            // it isn't keyed by peer anyway.  connect() keeps its own per-remote
+            // session cache for resumption.
+            SSL_CTX_set_session_cache_mode(*context, SSL_SESS_CACHE_OFF);
+        }
+
         // Use the clusterfile for internal outgoing SSL connections if specified 
         if (context == &_clientContext && !params.clusterfile.empty()) {
             EVP_set_pw_prompt("Enter cluster certificate passphrase");
@@ -716,19 +767,63 @@ namespace mongo {
         }
     }
 
+    void SSLManager::_checkOutClientSession(const std::string& remote, SSL* ssl) {
+        SSL_SESSION* session = NULL;
+        {
+            SimpleMutex::scoped_lock lck(_clientSessionMtx);
+            ClientSessionCache::iterator it = _clientSessionCache.find(remote);
+            if (it != _clientSessionCache.end()) {
+                session = it->second;
+                _clientSessionCache.erase(it);
+            }
+        }
+        if (session) {
+            SSL_set_session(ssl, session);  // takes its own reference
+            SSL_SESSION_free(session);
+        }
+    }
+
+    void SSLManager::_cacheClientSession(const std::string& remote, SSL* ssl) {
+        SSL_SESSION* session = SSL_get1_session(ssl);
+        if (NULL == session)
+            return;
+        SimpleMutex::scoped_lock lck(_clientSessionMtx);
+        ClientSessionCache::iterator it = _clientSessionCache.find(remote);
+        if (it != _clientSessionCache.end()) {
+            SSL_SESSION_free(it->second);
+            it->second = session;
+        }
+        else if (_clientSessionCache.size() < MAX_CLIENT_SESSION_CACHE_SIZE) {
+            _clientSessionCache[remote] = session;
+        }
+        else {
+            SSL_SESSION_free(session);
+        }
+    }
+
     SSLConnection* SSLManager::connect(Socket* socket) {
         SSLConnection* sslConn = new SSLConnection(_clientContext, socket, NULL, 0);
         ScopeGuard sslGuard = MakeGuard(::SSL_free, sslConn->ssl);
         ScopeGuard bioGuard = MakeGuard(::BIO_free, sslConn->networkBIO);
- 
+
+        // try to resume a previous session with this remote; a stale or refused
+        // session just falls back to a full handshake
+        const std::string remote = socket->remoteString();
+        _checkOutClientSession(remote, sslConn->ssl);
+
         int ret;
         do {
             ret = ::SSL_connect(sslConn->ssl);
         } while(!_doneWithSSLOp(sslConn, ret));
- 
+
         if (ret != 1)
             _handleSSLError(SSL_get_error(sslConn, ret));
- 
+
+        if (SSL_session_reused(sslConn->ssl)) {
+            LOG(2) << "resumed TLS session with " << remote;
+        }
+        _cacheClientSession(remote, sslConn->ssl);
+
         sslGuard.Dismiss();
         bioGuard.Dismiss();
         return sslConn;
@@ -0,0 +1,158 @@
+// numa.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/util/numa.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/mongoutils/str.h"
+
+using namespace mongoutils;
+
+namespace mongo {
+
+    bool numaInterleaveMappedMemory = true;
+    int numaDurabilityNode = -1;
+
+#if defined(__linux__) && defined(__NR_mbind) && defined(__NR_set_mempolicy)
+
+    namespace {
+        // from <linux/mempolicy.h>; we issue the syscalls ourselves rather than
+        // depend on libnuma
+        const int MPOL_PREFERRED = 1;
+        const int MPOL_INTERLEAVE = 3;
+
+        int computeNodeCount() {
+            int n = 0;
+            while (boost::filesystem::exists(
+                       std::string(str::stream() << "/sys/devices/system/node/node" << n)))
+                n++;
+            return n > 0 ? n : 1;
+        }
+    }
+
+    int numaNodeCount() {
+        // lazily computed; idempotent, so an initialization race is harmless
+        static int count = -1;
+        if (count < 0)
+            count = computeNodeCount();
+        return count;
+    }
+
+    void numaInterleaveMemory(void* p, size_t len) {
+        if (!numaInterleaveMappedMemory)
+            return;
+        const int nodes = numaNodeCount();
+        if (nodes < 2)
+            return;
+
+        unsigned long mask = 0;
+        for (int i = 0; i < nodes && i < (int)(8 * sizeof(mask)); i++)
+            mask |= 1UL << i;
+
+        if (syscall(__NR_mbind, p, len, MPOL_INTERLEAVE,
+                    &mask, 8 * sizeof(mask), 0) != 0) {
+            static bool warned = false;
+            if (!warned) {
+                warned = true;
+                warning() << "mbind(MPOL_INTERLEAVE) failed: " << errnoWithDescription()
+                          << " (only reported once)" << endl;
+            }
+        }
+    }
+
+    bool numaBindThreadToNode(int node) {
+        if (node < 0 || node >= numaNodeCount())
+            return false;
+
+        // the node's cpus, e.g. "0-7,32-39"
+        std::ifstream f(std::string(
+            str::stream() << "/sys/devices/system/node/node" << node << "/cpulist").c_str());
+        std::string cpulist;
+        if (!f.is_open() || !std::getline(f, cpulist) || cpulist.empty())
+            return false;
+
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        int ncpus = 0;
+        std::istringstream ranges(cpulist);
+        std::string range;
+        while (std::getline(ranges, range, ',')) {
+            int lo = -1, hi = -1;
+            if (sscanf(range.c_str(), "%d-%d", &lo, &hi) == 1)
+                hi = lo;
+            for (int c = lo; c >= 0 && c <= hi && c < CPU_SETSIZE; c++) {
+                CPU_SET(c, &cpus);
+                ncpus++;
+            }
+        }
+        if (ncpus == 0)
+            return false;
+
+        if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+            warning() << "sched_setaffinity to node " << node << " failed: "
+                      << errnoWithDescription() << endl;
+            return false;
+        }
+
+        // prefer (not require) the node for this thread's allocations, so we still
+        // run if the node fills up
+        unsigned long mask = 1UL << node;
+        if (syscall(__NR_set_mempolicy, MPOL_PREFERRED, &mask, 8 * sizeof(mask)) != 0) {
+            warning() << "set_mempolicy(MPOL_PREFERRED) for node " << node << " failed: "
+                      << errnoWithDescription() << endl;
+        }
+        return true;
+    }
+
+    void numaAppendStats(BSONObjBuilder& b) {
+        const int nodes = numaNodeCount();
+        for (int i = 0; i < nodes; i++) {
+            std::ifstream f(std::string(
+                str::stream() << "/sys/devices/system/node/node" << i << "/numastat").c_str());
+            if (!f.is_open())
+                continue;
+            BSONObjBuilder node(b.subobjStart(str::stream() << "node" << i));
+            std::string name;
+            long long value;
+            while (f >> name >> value)
+                node.appendNumber(name, value);
+            node.done();
+        }
+    }
+
+#else
+
+    int numaNodeCount() { return 1; }
+    void numaInterleaveMemory(void*, size_t) { }
+    bool numaBindThreadToNode(int) { return false; }
+    void numaAppendStats(BSONObjBuilder&) { }
+
+#endif
+
+}
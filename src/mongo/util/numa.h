@@ -0,0 +1,66 @@
+// numa.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * NUMA placement helpers.  Everything here is best effort: on kernels without
+     * NUMA support, on single node machines, and on non-Linux platforms the calls
+     * quietly do nothing.  We talk to the kernel directly (mbind/set_mempolicy
+     * syscalls and sysfs) so there is no libnuma dependency.
+     */
+
+    /** interleave datafile mappings across nodes; --setParameter numaInterleave */
+    extern bool numaInterleaveMappedMemory;
+
+    /**
+     * node to run the journal and datafile flush threads on, or -1 for no binding;
+     * --setParameter numaDurabilityNode.  Point it at the node closest to the
+     * journal device (see /sys/block/<dev>/device/numa_node).
+     */
+    extern int numaDurabilityNode;
+
+    /** @return the number of NUMA nodes; 1 when not a NUMA machine or unsupported */
+    int numaNodeCount();
+
+    /**
+     * Sets an interleaved-across-all-nodes page allocation policy on [p, p+len),
+     * the same policy numactl --interleave=all would give the whole process, but
+     * scoped to one mapping.  No-op unless numaInterleaveMappedMemory is set and
+     * the machine has more than one node.  Affects only pages not yet faulted in.
+     */
+    void numaInterleaveMemory(void* p, size_t len);
+
+    /**
+     * Restricts the calling thread to the cpus of the given node and prefers that
+     * node for its memory allocations.  @return true if the binding was applied.
+     */
+    bool numaBindThreadToNode(int node);
+
+    /**
+     * Appends one subobject per node with the kernel's allocation counters for it
+     * (numa_hit, numa_miss, numa_foreign, ...), for serverStatus.
+     */
+    void numaAppendStats(BSONObjBuilder& b);
+
+}
@@ -0,0 +1,139 @@
+// sketches.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/util/sketches.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mongo {
+
+    static inline int leadingZeros64( unsigned long long w ) {
+        if ( w == 0 )
+            return 64;
+        int n = 0;
+        while ( !( w & ( 1ULL << 63 ) ) ) {
+            w <<= 1;
+            n++;
+        }
+        return n;
+    }
+
+    HyperLogLog::HyperLogLog( int precision ) : _p( precision ) {
+        verify( precision >= 4 && precision <= 16 );
+        _registers.resize( ( (size_t)1 ) << precision, 0 );
+    }
+
+    void HyperLogLog::addHash( unsigned long long hash ) {
+        // the top p bits pick the register, the rest determine the rank
+        size_t idx = (size_t)( hash >> ( 64 - _p ) );
+        unsigned long long rest = hash << _p;
+        int rank = leadingZeros64( rest ) + 1;
+        if ( rank > 64 - _p + 1 )
+            rank = 64 - _p + 1;
+        if ( _registers[idx] < rank )
+            _registers[idx] = (unsigned char)rank;
+    }
+
+    long long HyperLogLog::estimate() const {
+        const double m = (double)_registers.size();
+
+        double sum = 0;
+        int zeros = 0;
+        for ( size_t i = 0; i < _registers.size(); i++ ) {
+            sum += 1.0 / (double)( 1ULL << _registers[i] );
+            if ( _registers[i] == 0 )
+                zeros++;
+        }
+
+        const double alpha = 0.7213 / ( 1.0 + 1.079 / m );
+        double e = alpha * m * m / sum;
+
+        // small-range correction: fall back on linear counting while many
+        // registers are still untouched.  no large-range correction is needed
+        // with 64 bit hashes.
+        if ( e <= 2.5 * m && zeros > 0 )
+            e = m * log( m / (double)zeros );
+
+        return (long long)( e + 0.5 );
+    }
+
+    double HyperLogLog::standardError() const {
+        return 1.04 / sqrt( (double)_registers.size() );
+    }
+
+    SpaceSaving::SpaceSaving( unsigned capacity ) : _capacity( capacity ), _n( 0 ) {
+        verify( capacity > 0 );
+    }
+
+    SpaceSaving::CounterMap::iterator SpaceSaving::_findMin() {
+        CounterMap::iterator min = _counters.begin();
+        for ( CounterMap::iterator it = _counters.begin(); it != _counters.end(); ++it ) {
+            if ( it->second.count < min->second.count )
+                min = it;
+        }
+        return min;
+    }
+
+    void SpaceSaving::add( unsigned long long hash, const BSONObj& value ) {
+        _n++;
+
+        CounterMap::iterator it = _counters.find( hash );
+        if ( it != _counters.end() ) {
+            it->second.count++;
+            return;
+        }
+
+        if ( _counters.size() < _capacity ) {
+            Counter& c = _counters[hash];
+            c.value = value.getOwned();
+            c.count = 1;
+            c.error = 0;
+            return;
+        }
+
+        // evict the least-frequent candidate; the newcomer inherits its count,
+        // which bounds how much the newcomer may be over-counted
+        CounterMap::iterator min = _findMin();
+        Counter c;
+        c.value = value.getOwned();
+        c.count = min->second.count + 1;
+        c.error = min->second.count;
+        _counters.erase( min );
+        _counters[hash] = c;
+    }
+
+    namespace {
+        bool entryCountDesc( const SpaceSaving::Entry& a, const SpaceSaving::Entry& b ) {
+            return a.count > b.count;
+        }
+    }
+
+    void SpaceSaving::entries( std::vector<Entry>* out ) const {
+        out->clear();
+        out->reserve( _counters.size() );
+        for ( CounterMap::const_iterator it = _counters.begin(); it != _counters.end(); ++it ) {
+            Entry e;
+            e.value = it->second.value;
+            e.count = it->second.count;
+            e.maxError = it->second.error;
+            out->push_back( e );
+        }
+        std::sort( out->begin(), out->end(), entryCountDesc );
+    }
+
+}
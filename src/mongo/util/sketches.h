@@ -0,0 +1,94 @@
+// sketches.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    /**
+     * Streaming cardinality estimator (HyperLogLog, Flajolet et al 2007).
+     * Feed it well-mixed 64 bit hashes of the items; memory is fixed at
+     * 2^precision one-byte registers, independent of cardinality.
+     */
+    class HyperLogLog {
+    public:
+        /** precision p gives 2^p registers and ~1.04/sqrt(2^p) standard error.
+            must be in [4,16]; the default (14) uses 16KB for ~0.8% error. */
+        explicit HyperLogLog( int precision = 14 );
+
+        void addHash( unsigned long long hash );
+
+        /** estimated number of distinct hashes added, with the usual
+            small-range (linear counting) correction */
+        long long estimate() const;
+
+        /** expected relative standard error of estimate() */
+        double standardError() const;
+
+    private:
+        int _p;
+        std::vector<unsigned char> _registers;
+    };
+
+    /**
+     * Streaming heavy hitters (the space-saving algorithm, Metwally et al 2005).
+     * Tracks at most 'capacity' candidates; when full, the least-frequent
+     * candidate is evicted to admit a new item, which inherits its count as
+     * error.  Any item with true frequency above n/capacity is guaranteed to
+     * be tracked, and count - maxError <= true count <= count.
+     *
+     * Items are identified by a 64 bit hash; 'value' is kept (owned) for
+     * reporting and only consulted the first time a hash is seen.
+     */
+    class SpaceSaving {
+    public:
+        explicit SpaceSaving( unsigned capacity );
+
+        void add( unsigned long long hash, const BSONObj& value );
+
+        struct Entry {
+            BSONObj value;
+            long long count;
+            long long maxError;
+        };
+
+        /** tracked candidates, most frequent first */
+        void entries( std::vector<Entry>* out ) const;
+
+        long long totalAdded() const { return _n; }
+
+    private:
+        struct Counter {
+            BSONObj value;
+            long long count;
+            long long error;
+        };
+        typedef std::map<unsigned long long, Counter> CounterMap;
+
+        CounterMap::iterator _findMin();
+
+        unsigned _capacity;
+        long long _n;
+        CounterMap _counters;
+    };
+
+}
@@ -0,0 +1,92 @@
+// sketches_test.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/unittest/unittest.h"
+
+#include "mongo/util/sketches.h"
+
+namespace {
+
+    using namespace mongo;
+
+    // 64 bit finalizer from murmurhash3; the sketches assume well-mixed input
+    static unsigned long long mix( unsigned long long k ) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+
+    TEST( HyperLogLog, SmallExact ) {
+        // linear counting regime: estimates should be essentially exact
+        HyperLogLog hll;
+        for ( int i = 0; i < 100; i++ ) {
+            hll.addHash( mix( i ) );
+            hll.addHash( mix( i ) ); // duplicates must not count
+        }
+        ASSERT_EQUALS( 100, hll.estimate() );
+    }
+
+    TEST( HyperLogLog, LargeWithinError ) {
+        HyperLogLog hll;
+        const long long n = 200 * 1000;
+        for ( long long i = 0; i < n; i++ )
+            hll.addHash( mix( i ) );
+
+        // allow 5x the expected standard error
+        long long e = hll.estimate();
+        double maxOff = 5 * hll.standardError() * n;
+        ASSERT_GREATER_THAN( e, n - (long long)maxOff );
+        ASSERT_LESS_THAN( e, n + (long long)maxOff );
+    }
+
+    TEST( SpaceSaving, ExactWithinCapacity ) {
+        SpaceSaving ss( 10 );
+        BSONObj v = BSON( "" << 1 );
+        for ( int i = 0; i < 5; i++ ) {
+            for ( int j = 0; j <= i; j++ )
+                ss.add( mix( i ), v );
+        }
+        std::vector<SpaceSaving::Entry> top;
+        ss.entries( &top );
+        ASSERT_EQUALS( 5U, top.size() );
+        // nothing was evicted, so counts are exact and ordered
+        ASSERT_EQUALS( 5, top[0].count );
+        ASSERT_EQUALS( 0, top[0].maxError );
+        ASSERT_EQUALS( 1, top[4].count );
+    }
+
+    TEST( SpaceSaving, HeavyHitterSurvivesEviction ) {
+        SpaceSaving ss( 8 );
+        BSONObj heavy = BSON( "" << "heavy" );
+        BSONObj light = BSON( "" << "light" );
+        for ( int i = 0; i < 1000; i++ ) {
+            ss.add( mix( 0 ), heavy );       // one frequent item...
+            ss.add( mix( 1 + i ), light );   // ...among a stream of singletons
+        }
+        std::vector<SpaceSaving::Entry> top;
+        ss.entries( &top );
+        ASSERT_EQUALS( 8U, top.size() );
+        ASSERT_EQUALS( std::string( "heavy" ), top[0].value.firstElement().String() );
+        // count is an overestimate bounded by maxError
+        ASSERT_GREATER_THAN_OR_EQUALS( top[0].count, 1000 );
+        ASSERT_GREATER_THAN_OR_EQUALS( 1000, top[0].count - top[0].maxError );
+    }
+
+} // unnamed namespace
@@ -23,12 +23,20 @@
 #include <list>
 #include <string>
 
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
+#include "mongo/bson/util/atomic_int.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/pdfile.h"
 #include "mongo/db/database.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/mmap.h"
 #include "mongo/util/progress_meter.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
     struct touch_location {
@@ -37,9 +45,47 @@ namespace mongo {
         size_t length;
         Extent *ext;
     };
-        
-    void touchNs( const std::string& ns ) { 
-        std::vector< touch_location > ranges;
+
+    namespace {
+        // large extents are split into chunks of this size so that parallel workers
+        // stay balanced and the rate limiter has a sane granularity to meter at
+        const size_t touchChunkBytes = 64 * 1024 * 1024;
+
+        /** work shared by the threads of one parallel touch.  lives on the caller's
+            stack, so the caller must not return until every worker has finished. */
+        struct TouchWorkSet {
+            TouchWorkSet() : next(0), done(0), maxBytesPerSecPerThread(0) { }
+            std::vector<touch_location> chunks; // read-only once workers start
+            AtomicUInt next;                    // index of the next chunk to claim
+            AtomicUInt done;                    // chunks fully touched so far
+            long long maxBytesPerSecPerThread;  // 0 = unthrottled
+        };
+
+        void touchWorker( TouchWorkSet* work ) {
+            Timer timer;
+            long long bytesTouched = 0;
+            while ( true ) {
+                unsigned i = work->next++; // postfix: claims chunk i
+                if ( i >= work->chunks.size() )
+                    break;
+                const touch_location& tl = work->chunks[i];
+                touch_pages( tl.fd, tl.offset, tl.length, tl.ext );
+                bytesTouched += tl.length;
+                work->done++;
+                if ( work->maxBytesPerSecPerThread ) {
+                    // sleep off however far ahead of this thread's share of the
+                    // aggregate rate limit we have gotten
+                    long long targetMillis = 1000 * bytesTouched / work->maxBytesPerSecPerThread;
+                    long long ahead = targetMillis - timer.millis();
+                    if ( ahead > 0 )
+                        sleepmillis( ahead );
+                }
+            }
+        }
+    }
+
+    void touchNs( const std::string& ns, int numThreads, int rateMBPerSec ) {
+        TouchWorkSet work;
         boost::scoped_ptr<LockMongoFilesShared> mongoFilesLock;
         {
             Client::ReadContext ctx(ns);
@@ -49,36 +95,89 @@ namespace mongo {
             for( DiskLoc L = nsd->firstExtent(); !L.isNull(); L = L.ext()->xnext )  {
                 DataFile* mdf = cc().database()->getFile( L.a() );
                 massert( 16238, "can't fetch extent file structure", mdf );
-                touch_location tl;
-                tl.fd = mdf->getFd();
-                tl.offset = L.getOfs();
-                tl.ext = L.ext();
-                tl.length = tl.ext->length;
+                const size_t extLength = L.ext()->length;
+                for ( size_t delta = 0; delta < extLength; delta += touchChunkBytes ) {
+                    touch_location tl;
+                    tl.fd = mdf->getFd();
+                    tl.offset = L.getOfs() + delta;
+                    tl.ext = reinterpret_cast<Extent*>( reinterpret_cast<char*>( L.ext() ) + delta );
+                    tl.length = std::min( touchChunkBytes, extLength - delta );
 
-                ranges.push_back(tl);
+                    work.chunks.push_back(tl);
+                }
             }
             mongoFilesLock.reset(new LockMongoFilesShared());
         }
-        // DB read lock is dropped; no longer needed after this point.
+        // DB read lock is dropped; the files lock keeps the views mapped while we
+        // (and any worker threads) fault them in.
+
+        if ( rateMBPerSec > 0 )
+            work.maxBytesPerSecPerThread = rateMBPerSec * 1024LL * 1024 / std::max( 1, numThreads );
 
         std::string progress_msg = "touch " + ns + " extents";
         ProgressMeterHolder pm(cc().curop()->setMessage(progress_msg.c_str(),
                                                         "Touch Progress",
-                                                        ranges.size()));
-        for ( std::vector< touch_location >::iterator it = ranges.begin(); it != ranges.end(); ++it ) {
-            touch_pages( it->fd, it->offset, it->length, it->ext );
-            pm.hit();
-            killCurrentOp.checkForInterrupt(false);
+                                                        work.chunks.size()));
+
+        if ( numThreads <= 1 ) {
+            Timer timer;
+            long long bytesTouched = 0;
+            for ( std::vector< touch_location >::iterator it = work.chunks.begin();
+                  it != work.chunks.end();
+                  ++it ) {
+                touch_pages( it->fd, it->offset, it->length, it->ext );
+                pm.hit();
+                killCurrentOp.checkForInterrupt(false);
+                if ( rateMBPerSec > 0 ) {
+                    bytesTouched += it->length;
+                    long long targetMillis = 1000 * bytesTouched / ( rateMBPerSec * 1024LL * 1024 );
+                    long long ahead = targetMillis - timer.millis();
+                    if ( ahead > 0 )
+                        sleepmillis( ahead );
+                }
+            }
+        }
+        else {
+            threadpool::ThreadPool pool( numThreads );
+            for ( int i = 0; i < numThreads; i++ )
+                pool.schedule( &touchWorker, &work );
+
+            // The workers claim chunks until none remain; we just report their
+            // progress and watch for interrupts.  On interrupt we cannot simply
+            // throw -- the workers point into our stack -- so we make the remaining
+            // chunks disappear and let them drain.
+            unsigned reported = 0;
+            bool interrupted = false;
+            while ( pool.tasks_remaining() ) {
+                sleepmillis( 100 );
+                unsigned done = work.done.get();
+                if ( done > reported ) {
+                    pm.hit( done - reported );
+                    reported = done;
+                }
+                if ( !interrupted && *killCurrentOp.checkForInterruptNoAssert() ) {
+                    interrupted = true;
+                    work.next.set( static_cast<unsigned>( work.chunks.size() ) );
+                }
+            }
+            pool.join();
+            uassert( 17512, "touch interrupted", !interrupted );
         }
         pm.finished();
     }
 
     char _touch_pages_char_reader; // goes in .bss
-  
+
     void touch_pages( HANDLE fd, int offset, size_t length, const Extent* ext ) {
-        // read first byte of every page, in order
         const char *p = static_cast<const char *>(static_cast<const void *> (ext));
-        for( size_t i = 0; i < length; i += g_minOSPageSizeBytes ) { 
+#if !defined(_WIN32) && !defined(__sunos__)
+        // announce the whole range up front so the kernel can schedule large
+        // readaheads instead of discovering the access pattern one fault at a time
+        char* aligned = (char*)((size_t)p & ~(g_minOSPageSizeBytes-1));
+        madvise( aligned, length + (p - aligned), MADV_WILLNEED );
+#endif
+        // read first byte of every page, in order
+        for( size_t i = 0; i < length; i += g_minOSPageSizeBytes ) {
             _touch_pages_char_reader += p[i];
         }
     }
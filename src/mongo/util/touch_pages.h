@@ -20,8 +20,11 @@
 namespace mongo {
     class Extent;
 
-    // Given a namespace, page in all pages associated with that namespace
-    void touchNs( const std::string& ns );
+    // Given a namespace, page in all pages associated with that namespace.
+    // numThreads > 1 faults pages in concurrently so warmup is bounded by
+    // aggregate disk bandwidth rather than a single request stream.
+    // rateMBPerSec, if nonzero, caps the aggregate touch rate.
+    void touchNs( const std::string& ns, int numThreads = 1, int rateMBPerSec = 0 );
 
     // Touch a range of pages using an OS-specific method.
     // Takes a file descriptor, offset, and length, for Linux use.
@@ -0,0 +1,144 @@
+/*
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/util/trace_point.h"
+
+#include <boost/thread/tss.hpp>
+#include <vector>
+
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    AtomicUInt32 TraceRecorder::_enabled(0);
+    const unsigned TraceRecorder::Ring::kNumRecords;
+
+    namespace {
+
+        struct ThreadEntry {
+            ThreadEntry() : inUse(false) {}
+            std::string threadName;
+            bool inUse; // false once the owning thread exits; entry may be recycled
+            TraceRecorder::Ring ring;
+        };
+
+        // Guards the registry and entries' inUse/threadName; never held while noting
+        // a record.  Entries are never freed, so the memory bound is the ring size
+        // times the peak concurrent thread count.
+        mongo::mutex registryMutex("TraceRecorder");
+        std::vector<ThreadEntry*>* registry = NULL;
+
+        void releaseEntry(ThreadEntry* entry) {
+            scoped_lock lk(registryMutex);
+            entry->inUse = false;
+        }
+
+        boost::thread_specific_ptr<ThreadEntry> threadEntry(releaseEntry);
+    }
+
+    void TraceRecorder::Ring::note(const char* point, long long a, long long b) {
+        Record& r = _records[_next & (kNumRecords - 1)];
+        r.micros = curTimeMicros64();
+        r.point = point;
+        r.a = a;
+        r.b = b;
+        // bump last so a concurrent dump never sees a half-written newest record
+        _next++;
+    }
+
+    void TraceRecorder::setEnabled(bool on) {
+        _enabled.store(on ? 1 : 0);
+    }
+
+    TraceRecorder::Ring& TraceRecorder::ring() {
+        ThreadEntry* entry = threadEntry.get();
+        if (MONGO_unlikely(entry == NULL)) {
+            scoped_lock lk(registryMutex);
+            if (registry == NULL)
+                registry = new std::vector<ThreadEntry*>();
+            for (size_t i = 0; i < registry->size(); i++) {
+                if (!(*registry)[i]->inUse) {
+                    entry = (*registry)[i];
+                    entry->ring.reset();
+                    break;
+                }
+            }
+            if (entry == NULL) {
+                entry = new ThreadEntry();
+                registry->push_back(entry);
+            }
+            entry->inUse = true;
+            entry->threadName = getThreadName();
+            threadEntry.reset(entry);
+        }
+        return entry->ring;
+    }
+
+    void TraceRecorder::note(const char* point, long long a, long long b) {
+        ring().note(point, a, b);
+    }
+
+    void TraceRecorder::dump(BSONObjBuilder& result, unsigned maxPerThread) {
+        scoped_lock lk(registryMutex);
+
+        BSONArrayBuilder threads(result.subarrayStart("threads"));
+        if (registry != NULL) {
+            for (size_t i = 0; i < registry->size(); i++) {
+                const ThreadEntry* entry = (*registry)[i];
+                const unsigned written = entry->ring.written();
+                if (written == 0)
+                    continue;
+
+                unsigned n = written < Ring::kNumRecords ? written : Ring::kNumRecords;
+                if (n > maxPerThread)
+                    n = maxPerThread;
+
+                BSONObjBuilder t(threads.subobjStart());
+                t.append("thread", entry->threadName);
+                t.appendBool("active", entry->inUse);
+
+                BSONArrayBuilder records(t.subarrayStart("records"));
+                for (unsigned j = written - n; j != written; j++) {
+                    const Record& r = entry->ring.at(j);
+                    BSONObjBuilder rb(records.subobjStart());
+                    rb.appendNumber("t", static_cast<long long>(r.micros));
+                    rb.append("point", r.point);
+                    rb.appendNumber("a", r.a);
+                    rb.appendNumber("b", r.b);
+                    rb.done();
+                }
+                records.done();
+                t.done();
+            }
+        }
+        threads.done();
+    }
+
+}  // namespace mongo
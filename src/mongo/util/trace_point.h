@@ -0,0 +1,119 @@
+/*
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    /**
+     * Flight recorder for hot-path trace points.
+     *
+     * Each thread appends fixed-size records to its own ring buffer, so noting an
+     * event never takes a lock and never allocates after a thread's first record.
+     * When recording is off (the default) a trace point costs a single relaxed
+     * load, the same trick FailPoint uses for its fast path.
+     *
+     * Sample use:
+     *
+     * // Somewhere in the code
+     * MONGO_TRACE_POINT( "dur/preplogbuffer", bufferLen, 0 );
+     *
+     * Dump with the traceDump command: { traceDump: 1 } returns the most recent
+     * records of every thread; { traceDump: 1, enable: <bool> } turns recording on
+     * or off.  The point of the recorder is reconstructing the last moments before
+     * a stall without attaching a debugger, so dumping is best-effort: records of
+     * running threads are read without synchronization and the newest record of a
+     * busy thread may be torn.
+     */
+    class TraceRecorder {
+        MONGO_DISALLOW_COPYING(TraceRecorder);
+
+    public:
+        struct Record {
+            unsigned long long micros; // curTimeMicros64() when the event was noted
+            const char* point;         // string literal identifying the trace point
+            long long a;               // two points' worth of context, meaning varies
+            long long b;               //   by trace point (lengths, counts, ...)
+        };
+
+        /** the most recent records of one thread; a power-of-two ring */
+        class Ring {
+        public:
+            static const unsigned kNumRecords = 2048; // must be a power of two
+
+            Ring() : _next(0) {}
+
+            void note(const char* point, long long a, long long b);
+
+            /** total records ever written; the low bits index the newest record */
+            unsigned written() const { return _next; }
+
+            const Record& at(unsigned i) const { return _records[i & (kNumRecords - 1)]; }
+
+            /** forget all records; used when a ring is recycled to a new thread */
+            void reset() { _next = 0; }
+
+        private:
+            Record _records[kNumRecords];
+            unsigned _next;
+        };
+
+        static bool enabled() { return _enabled.loadRelaxed() != 0; }
+        static void setEnabled(bool on);
+
+        /** Append a record to the calling thread's ring. Prefer MONGO_TRACE_POINT. */
+        static void note(const char* point, long long a, long long b);
+
+        /**
+         * Append a "threads" array to 'result' with the most recent records of every
+         * known thread, oldest first, at most maxPerThread records each.
+         */
+        static void dump(BSONObjBuilder& result, unsigned maxPerThread);
+
+    private:
+        TraceRecorder(); // static use only
+
+        /** the calling thread's ring, created (or recycled) on first use */
+        static Ring& ring();
+
+        static AtomicUInt32 _enabled;
+    };
+
+#define MONGO_TRACE_POINT( point, a, b ) \
+    do { \
+        if (MONGO_unlikely(::mongo::TraceRecorder::enabled())) \
+            ::mongo::TraceRecorder::note(point, \
+                                         static_cast<long long>(a), \
+                                         static_cast<long long>(b)); \
+    } while (false)
+
+}  // namespace mongo
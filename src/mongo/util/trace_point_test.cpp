@@ -0,0 +1,94 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/util/trace_point.h"
+#include "mongo/unittest/unittest.h"
+
+using mongo::BSONObj;
+using mongo::BSONObjBuilder;
+using mongo::BSONObjIterator;
+using mongo::TraceRecorder;
+
+namespace mongo_test {
+    TEST(TraceRecorder, DisabledByDefault) {
+        ASSERT_FALSE(TraceRecorder::enabled());
+        // must be a no-op, not a crash
+        MONGO_TRACE_POINT("test/disabled", 1, 2);
+    }
+
+    TEST(TraceRecorder, RecordAndDump) {
+        TraceRecorder::setEnabled(true);
+        ASSERT_TRUE(TraceRecorder::enabled());
+
+        MONGO_TRACE_POINT("test/alpha", 7, 0);
+        MONGO_TRACE_POINT("test/beta", 11, 13);
+
+        TraceRecorder::setEnabled(false);
+
+        BSONObjBuilder b;
+        TraceRecorder::dump(b, TraceRecorder::Ring::kNumRecords);
+        BSONObj dumped = b.obj();
+
+        bool sawAlpha = false;
+        bool sawBeta = false;
+        BSONObj threads = dumped["threads"].Obj();
+        BSONObjIterator threadIt(threads);
+        while (threadIt.more()) {
+            BSONObj thread = threadIt.next().Obj();
+            BSONObjIterator recordIt(thread["records"].Obj());
+            while (recordIt.more()) {
+                BSONObj record = recordIt.next().Obj();
+                if (record["point"].str() == "test/alpha") {
+                    sawAlpha = true;
+                    ASSERT_EQUALS(7, record["a"].numberLong());
+                }
+                else if (record["point"].str() == "test/beta") {
+                    sawBeta = true;
+                    ASSERT_EQUALS(11, record["a"].numberLong());
+                    ASSERT_EQUALS(13, record["b"].numberLong());
+                }
+            }
+        }
+        ASSERT_TRUE(sawAlpha);
+        ASSERT_TRUE(sawBeta);
+    }
+
+    TEST(TraceRecorder, RingWraps) {
+        TraceRecorder::Ring ring;
+        const unsigned total = TraceRecorder::Ring::kNumRecords + 5;
+        for (unsigned i = 0; i < total; i++) {
+            ring.note("test/wrap", i, 0);
+        }
+        ASSERT_EQUALS(total, ring.written());
+        // the oldest surviving record is total - kNumRecords
+        ASSERT_EQUALS(static_cast<long long>(total - TraceRecorder::Ring::kNumRecords),
+                      ring.at(total - TraceRecorder::Ring::kNumRecords).a);
+        // the newest is total - 1
+        ASSERT_EQUALS(static_cast<long long>(total - 1), ring.at(total - 1).a);
+    }
+}